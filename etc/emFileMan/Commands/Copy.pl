@@ -39,40 +39,6 @@ if (IsFirstPass()) {
 	;
 	Confirm("Copy",$message);
 
-	SecondPassInTerminal("Copy");
+	my @tgt=GetTgt();
+	SendJob("copy", $tgt[0], GetSrc());
 }
-
-my @src=GetSrc();
-my @tgt=GetTgt();
-
-my $e=TermRunAndSync(
-	"cp",
-	($Config{'osname'} eq 'linux' or $Config{'osname'} eq 'cygwin') ? (
-		"-vfdpR"
-	)
-	: (
-		"-fpR"
-	),
-	"--",
-	@src,
-	$tgt[0]
-);
-
-my @newTgt=();
-if (-d $tgt[0]) {
-	for (my $i=0; $i<@src; $i++) {
-		my $f=fileparse($src[$i]);
-		my $p=catfile($tgt[0],$f);
-		if (-e $p) {
-			push(@newTgt,$p);
-		}
-	}
-}
-if (@newTgt > 0) {
-	SendSelectKS(@newTgt);
-}
-else {
-	SendUpdate();
-}
-
-TermEnd($e);
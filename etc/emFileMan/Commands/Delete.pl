@@ -38,21 +38,5 @@ if (IsFirstPass()) {
 	$message.=GetTgtListing();
 	Confirm("Delete",$message);
 
-	SecondPassInTerminal("Delete");
+	SendJob("remove", GetTgt());
 }
-
-my $e=TermRunAndSync(
-	"rm",
-	($Config{'osname'} eq 'linux' or $Config{'osname'} eq 'cygwin') ? (
-		"-vfr"
-	)
-	: (
-		"-fr"
-	),
-	"--",
-	GetTgt()
-);
-
-SendUpdate();
-
-TermEnd($e);
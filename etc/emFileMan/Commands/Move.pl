@@ -40,40 +40,6 @@ if (IsFirstPass()) {
 	;
 	Confirm("Move",$message);
 
-	SecondPassInTerminal("Move");
+	my @tgt=GetTgt();
+	SendJob("move", $tgt[0], GetSrc());
 }
-
-my @src=GetSrc();
-my @tgt=GetTgt();
-
-my $e=TermRunAndSync(
-	"mv",
-	($Config{'osname'} eq 'linux' or $Config{'osname'} eq 'cygwin') ? (
-		"-vf"
-	)
-	: (
-		"-f"
-	),
-	"--",
-	@src,
-	$tgt[0]
-);
-
-my @newTgt=();
-if (-d $tgt[0]) {
-	for (my $i=0; $i<@src; $i++) {
-		my $f=fileparse($src[$i]);
-		my $p=catfile($tgt[0],$f);
-		if (-e $p) {
-			push(@newTgt,$p);
-		}
-	}
-}
-if (@newTgt > 0) {
-	SendSelectKS(@newTgt);
-}
-else {
-	SendUpdate();
-}
-
-TermEnd($e);
@@ -51,36 +51,4 @@ var message=
 ;
 Confirm("Copy",message);
 
-var newTgt=new Array;
-for (var i=0; i<Src.length; i++) {
-	newTgt[i]=GetChildPath(Tgt[0],GetNameInPath(Src[i]));
-}
-
-BatBegin("Copy");
-for (var i=0; i<Src.length; i++) {
-	if (IsDirectory(Src[i])) {
-		if (IsRegularFile(newTgt[i])) {
-			BatWriteCmdEchoed(["del","/F","/Q",newTgt[i]]);
-		}
-		BatWriteCmdEchoed(["xcopy","/F","/H","/K","/Y","/E","/I",Src[i],newTgt[i]]);
-	}
-	else {
-		BatWriteCmdEchoed(["xcopy","/F","/H","/K","/Y",Src[i],Tgt[0]]);
-	}
-	BatWriteLine("if errorlevel 1 (");
-	BatWriteSetErrored();
-	BatWriteLine("goto L_END");
-	BatWriteLine(")");
-}
-BatWriteLine(":L_END");
-if (IsDirectory(Tgt[0])) {
-	BatWriteLine("if exist " + BatQuoteArg(newTgt[0]) + " (");
-	BatWriteSendSelectKS(newTgt);
-	BatWriteLine(") else (");
-	BatWriteSendUpdate();
-	BatWriteLine(")");
-}
-else {
-	BatWriteSendUpdate();
-}
-BatEnd();
+SendJob("copy",[Tgt[0]].concat(Src));
@@ -41,20 +41,4 @@ message+=":\n\n";
 message+=GetTgtListing();
 Confirm("Delete",message);
 
-BatBegin("Delete");
-for (var i=0; i<Tgt.length; i++) {
-	if (IsDirectory(Tgt[i])) {
-		BatWriteCmdEchoed(["rmdir","/S","/Q",Tgt[i]]);
-	}
-	else {
-		BatWriteCmdEchoed(["del","/F","/Q",Tgt[i]]);
-	}
-	// rmdir and del are not always setting the error level on error.
-	BatWriteLine("if exist " + BatQuoteArg(Tgt[i]) + " (");
-	BatWriteSetErrored();
-	BatWriteLine("goto L_END");
-	BatWriteLine(")");
-}
-BatWriteLine(":L_END");
-BatWriteSendUpdate();
-BatEnd();
+SendJob("remove",Tgt);
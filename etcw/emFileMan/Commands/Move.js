@@ -52,28 +52,4 @@ var message=
 ;
 Confirm("Move",message);
 
-var newTgt=new Array;
-for (var i=0; i<Src.length; i++) {
-	newTgt[i]=GetChildPath(Tgt[0],GetNameInPath(Src[i]));
-}
-
-BatBegin("Move");
-for (var i=0; i<Src.length; i++) {
-	BatWriteCmdEchoed(["move","/Y",Src[i],Tgt[0]]); //??? Fails on hidden files.
-	BatWriteLine("if errorlevel 1 (");
-	BatWriteSetErrored();
-	BatWriteLine("goto L_END");
-	BatWriteLine(")");
-}
-BatWriteLine(":L_END");
-if (IsDirectory(Tgt[0])) {
-	BatWriteLine("if exist " + BatQuoteArg(newTgt[0]) + " (");
-	BatWriteSendSelectKS(newTgt);
-	BatWriteLine(") else (");
-	BatWriteSendUpdate();
-	BatWriteLine(")");
-}
-else {
-	BatWriteSendUpdate();
-}
-BatEnd();
+SendJob("move",[Tgt[0]].concat(Src));
@@ -64,6 +64,14 @@ protected:
 	virtual void PropertyChanged(const emString & name, const emString & value) = 0;
 
 	virtual void ShowFrame(const emImage & image, double tallness) = 0;
+		// Show an RGB frame, or an empty image.
+
+	virtual void ShowYuvFrame(
+		const emImage & imageY, const emImage & imageU,
+		const emImage & imageV, double tallness
+	) = 0;
+		// Show a YUV frame as three one-channel planes (see
+		// emImageYuvTexture).
 
 private:
 
@@ -133,6 +133,13 @@ public:
 	const emSignal & GetImageSignal() const;
 
 	const emImage & GetImage() const;
+		// The current frame. If GetImageU() is empty, this is an RGB
+		// image. Otherwise it is the Y plane of a YUV frame, which
+		// should be painted with an emImageYuvTexture.
+
+	const emImage & GetImageU() const;
+	const emImage & GetImageV() const;
+		// The U and V planes of the current frame, or empty images.
 
 	double GetTallness() const;
 
@@ -162,6 +169,10 @@ protected:
 	virtual void StreamStateChanged(StreamStateType streamState);
 	virtual void PropertyChanged(const emString & name, const emString & value);
 	virtual void ShowFrame(const emImage & image, double tallness);
+	virtual void ShowYuvFrame(
+		const emImage & imageY, const emImage & imageU,
+		const emImage & imageV, double tallness
+	);
 
 private:
 
@@ -211,6 +222,8 @@ private:
 
 	emSignal ImageSignal;
 	emImage Image;
+	emImage ImageU;
+	emImage ImageV;
 	double Tallness;
 };
 
@@ -350,6 +363,16 @@ inline const emImage & emAvFileModel::GetImage() const
 	return Image;
 }
 
+inline const emImage & emAvFileModel::GetImageU() const
+{
+	return ImageU;
+}
+
+inline const emImage & emAvFileModel::GetImageV() const
+{
+	return ImageV;
+}
+
 inline double emAvFileModel::GetTallness() const
 {
 	return Tallness;
@@ -29,14 +29,17 @@
 #include <emCore/emRenderThreadPool.h>
 #endif
 
-class emCoreConfig;
-
-
 class emAvImageConverter {
 
 public:
 
-	emAvImageConverter(emContext & context);
+	// Copies a video frame out of the shared memory into emImages. RGB
+	// frames are copied into a three-channel image. YUV frames are not
+	// converted to RGB here, but they are split into three one-channel
+	// planes, which are converted while painting (see
+	// emImageYuvTexture).
+
+	emAvImageConverter();
 	~emAvImageConverter();
 
 	void SetSourceRGB(
@@ -52,7 +55,15 @@ public:
 		int width, int height, int bytesPerLine, const emByte * plane
 	);
 
-	void SetTarget(emImage * image);
+	bool IsSourceYUV() const;
+		// Whether the source has been set with SetSourceI420 or
+		// SetSourceYUY2.
+
+	void SetTarget(emImage * image, emImage * imageU, emImage * imageV);
+		// Set the target images. For an RGB source, the frame goes
+		// to image, and imageU and imageV are cleared. For a YUV
+		// source, image gets the Y plane, and imageU and imageV get
+		// the U and V planes.
 
 	void Convert(emRenderThreadPool * renderThreadPool);
 
@@ -65,11 +76,9 @@ private:
 	void ConvertI420(int y1, int y2);
 	void ConvertYUY2(int y1, int y2);
 
-#	if EM_HAVE_X86_INTRINSICS
-		void ConvertI420_AVX2(int y1, int y2);
-#	endif
+	static void SetupImage(emImage * image, int width, int height,
+	                       int channelCount);
 
-	emRef<emCoreConfig> CoreConfig;
 	int Format;
 	int Width;
 	int Height;
@@ -79,13 +88,17 @@ private:
 	const emByte * Plane2;
 	const emByte * Plane3;
 	emImage * Image;
+	emImage * ImageU;
+	emImage * ImageV;
 	emThreadMiniMutex Mutex;
 	int RowsAtOnce;
 	int PosY;
-#	if EM_HAVE_X86_INTRINSICS
-		bool CanCpuDoAvx2;
-#	endif
 };
 
+inline bool emAvImageConverter::IsSourceYUV() const
+{
+	return Format!=0;
+}
+
 
 #endif
@@ -73,6 +73,17 @@ private:
 		MIN_LIFETIME_MILLISECS  =PROC_HOLD_MILLISECS+NORMAL_PROC_TERM_TIMEOUT+5000
 	};
 
+	enum {
+		SHM_RING_SLOTS          =4,
+		MAX_SHM_RING_SLOTS      =16,
+		SHM_RING_HEADER_SIZE    =256,
+		SHM_RING_SLOT_ALIGN     =64,
+		MAX_FRAME_AHEAD_MILLISECS=1000
+	};
+		// Frame ring in the shared memory segment, if the server supports
+		// it (see emAvServerProcProtocol.README). Frames with a time stamp
+		// further ahead than MAX_FRAME_AHEAD_MILLISECS are shown at once.
+
 	enum ShmAttachStateType {
 		SA_DETACHED,
 		SA_ATTACHING,
@@ -86,7 +97,11 @@ private:
 		emAvClient * Client;
 		ShmAttachStateType ShmAttachState;
 		int MinShmSize;
+		int MaxShmSlots;
 		int ShmSize;
+		int ShmSlotCount;
+		int ShmSlotSize;
+		int ShmReadSlot;
 #if defined(_WIN32) || defined(__CYGWIN__)
 		char ShmId[256];
 		void * ShmHdl;
@@ -95,6 +110,8 @@ private:
 #endif
 		int * ShmAddr;
 		emImage Image;
+		emImage ImageU;
+		emImage ImageV;
 	};
 
 	enum StateType {
@@ -118,12 +135,18 @@ private:
 	void HandleMessage(int instIndex, const char * tag, const char * data);
 
 	void UpdateShm(Instance * inst);
+	static int CalcShmSize(const Instance * inst);
+	static int GetShmFrameCapacity(const Instance * inst);
 
 	void TryCreateShm(Instance * inst);
 	void DeleteShm(Instance * inst);
 
 	void TransferFrames();
-	void TransferFrame(Instance * inst);
+	void TransferRingFrame(Instance * inst);
+	void TransferFrame(Instance * inst, const int * shm, int size);
+	static int * GetShmSlot(const Instance * inst, int slot);
+	static emUInt64 GetShmSlotTime(const Instance * inst, int slot);
+	static emUInt64 GetFrameClock();
 
 	emAvLibDirCfg LibDirCfg;
 	Instance * Instances[MAX_INSTANCES];
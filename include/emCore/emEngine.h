@@ -163,6 +163,12 @@ public:
 		// is called from within Cycle, Cycle will be called again
 		// within the current time slice.
 
+	void ThreadSafeWakeUp();
+		// Like WakeUp, but this may be called by any thread. The engine
+		// is woken up at the beginning of the next time slice. The
+		// caller must make sure that the engine is not destructed
+		// while this is called.
+
 	void AddWakeUpSignal(const emSignal & signal);
 		// Wake up this engine whenever the given signal is signaled.
 		// Waking up through a signal is like calling WakeUp. Adding the
@@ -260,6 +266,11 @@ private:
 
 	emUInt64 Clock;
 		// State of emScheduler::Clock after last call to Cycle().
+
+	emEngine * ThreadWakeUpNext;
+	bool ThreadWakeUpPending;
+		// Node in emScheduler::ThreadWakeUpList, protected by
+		// emScheduler::ThreadWakeUpMutex.
 };
 
 inline emScheduler & emEngine::GetScheduler() const
@@ -271,6 +271,12 @@ protected:
 		// Check whether the loaded file should be reloaded. The default
 		// implementation checks by file times, size and inode.
 
+	emUInt64 GetMemoryLimit() const;
+		// Get the current memory limit, which is the maximum of the
+		// memory limits of all clients. A derived class may use this
+		// for choosing a cheaper way of loading (e.g. a reduced
+		// resolution).
+
 private: friend class emFileModelClient;
 
 	bool StepLoading();
@@ -325,6 +331,11 @@ inline emUInt64 emFileModel::GetMemoryNeed() const
 	return MemoryNeed;
 }
 
+inline emUInt64 emFileModel::GetMemoryLimit() const
+{
+	return MemoryLimit;
+}
+
 inline double emFileModel::GetFileProgress() const
 {
 	return FileProgress;
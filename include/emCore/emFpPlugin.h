@@ -56,7 +56,8 @@ public:
 		// Array of file types the plugin is able to handle. Each entry
 		// must be a file name suffix including the leading dot, or the
 		// special string "file" for accepting all regular files, or the
-		// special string "directory" for accepting directories.
+		// special string "directory" for accepting directories, or the
+		// special string "blockdevice" for accepting block devices.
 
 	emDoubleRec Priority;
 		// Priority of the plugin. If there are two plugins able to
@@ -71,6 +72,12 @@ public:
 		// Name of the plugin function. It must match the interface
 		// defined by emFpPluginFunc.
 
+	emStringRec ModelFunction;
+		// Name of an optional plugin function for acquiring the file
+		// model of a file without creating a panel. It must match the
+		// interface defined by emFpPluginModelFunc. Empty if the plugin
+		// does not provide such a function.
+
 	class PropertyRec : public emStructRec {
 	public:
 		PropertyRec();
@@ -101,6 +108,22 @@ public:
 		// Returns: The created panel.
 		// Throws: An error message on failure.
 
+	emRef<emModel> TryAcquireModel(
+		emContext & context, const emString & className,
+		const emString & name, bool common=true
+	);
+		// Acquire a file model via the model function of this plugin.
+		// Arguments:
+		//   context   - The context of the model.
+		//   className - Name of the requested model class. The
+		//               returned model is of that class or of a
+		//               derived class (e.g. "emImageFileModel").
+		//   name      - Name of the model, which is the path name of
+		//               the file.
+		//   common    - Whether the model is common.
+		// Returns: The model.
+		// Throws: An error message on failure.
+
 	virtual const char * GetFormatName() const;
 		// The file format name of this record file format.
 
@@ -108,6 +131,9 @@ private:
 	void * CachedFunc;
 	emString CachedFuncLib;
 	emString CachedFuncName;
+	void * CachedModelFunc;
+	emString CachedModelFuncLib;
+	emString CachedModelFuncName;
 };
 
 
@@ -135,6 +161,32 @@ extern "C" {
 }
 
 
+//==============================================================================
+//============================ emFpPluginModelFunc =============================
+//==============================================================================
+
+extern "C" {
+	typedef emRef<emModel> (*emFpPluginModelFunc) (
+		emContext & context, const emString & className,
+		const emString & name, bool common, emFpPlugin * plugin,
+		emString * errorBuf
+	);
+		// Type of the model function of an emFpPlugin. Such a function
+		// acquires the file model which would be shown by the panels
+		// of the plugin.
+		// Arguments:
+		//   context   - The context of the model.
+		//   className - Name of the requested model class. The function
+		//               must fail if it cannot provide a model of that
+		//               class or of a derived class.
+		//   name      - Name of the model (path name of the file).
+		//   common    - Whether the model is common.
+		//   plugin    - The plugin record.
+		//   errorBuf  - For returning an error message on failure.
+		// Returns: The model, or NULL on failure.
+}
+
+
 //==============================================================================
 //=============================== emFpPluginList ===============================
 //==============================================================================
@@ -185,6 +237,28 @@ public:
 		//   alternative  - Like with the above method.
 		// Returns: The created panel.
 
+	emRef<emModel> TryAcquireModel(
+		const char * className, const emString & absolutePath,
+		long statMode, bool common=true, int alternative=0
+	);
+		// Acquire the file model for a file through the plugin which
+		// has a model function and would be chosen for the file. The
+		// model is created in the root context.
+		// Arguments:
+		//   className    - Name of the requested model class (see
+		//                  emFpPlugin::TryAcquireModel).
+		//   absolutePath - Absolute path name of the file.
+		//   statMode     - st.st_mode from calling stat on the file.
+		//   common       - Whether the model is common.
+		//   alternative  - Like with CreateFilePanel, but counting
+		//                  only plugins which have a model function.
+		// Returns: The model.
+		// Throws: An error message on failure.
+
+	bool HasModelFor(const emString & absolutePath, long statMode) const;
+		// Whether any plugin with a model function accepts the file
+		// type.
+
 protected:
 
 	emFpPluginList(emContext & context, const emString & name);
@@ -192,6 +266,10 @@ protected:
 
 private:
 
+	static bool IsFileTypeAccepted(
+		const emFpPlugin * plugin, const char * fileName, long statMode
+	);
+
 	static int CmpReversePluginPriorities(
 		const emFpPlugin * obj1, const emFpPlugin * obj2,
 		void * context
@@ -59,6 +59,23 @@ public:
 		// Signaled on every change of the image, the comment or the
 		// file format info.
 
+	int GetOriginalWidth() const;
+	int GetOriginalHeight() const;
+		// Size of the image in the file. This is larger than the size
+		// of GetImage() if the image has been loaded at a reduced
+		// resolution (see SetViewedSize).
+
+	void SetViewedSize(const void * viewer, double width, double height);
+		// Tell the model the size (in pixels) of the area into which the
+		// image is fitted for showing it by the given viewer (e.g. a
+		// panel). A size of zero removes the viewer. Derived classes
+		// which support it load the image at a reduced resolution, as
+		// far as that is still not smaller than required by the largest
+		// viewer, or as far as is required by the memory limit. Without
+		// any viewer, only the memory limit is regarded. If a larger
+		// size is set which requires a higher resolution than the one
+		// loaded or being loaded, the file is loaded again.
+
 protected:
 
 	emImageFileModel(emContext & context, const emString & name);
@@ -68,6 +85,43 @@ protected:
 		// Overloaded from emFileModel. This clears the image, the
 		// comment and the file format info, and it fires the signal.
 
+	int CalcReduction(
+		int originalWidth, int originalHeight, int channelCount,
+		int maxReduction
+	);
+		// To be called by TryStartLoading of a derived class which can
+		// load the image at a reduced resolution. It remembers the
+		// original size and returns the reduction factor to be used.
+		// The factor is a power of two and not greater than
+		// maxReduction. The image should then be loaded with a size of
+		// about originalWidth/factor x originalHeight/factor.
+
+	class RowReducer {
+	public:
+		// Helper for loading an image at a reduced resolution from
+		// rows of full resolution. Each target pixel is the average of
+		// the covered source pixels.
+		RowReducer();
+		~RowReducer();
+		void Setup(
+			emImage & image, int originalWidth, int originalHeight,
+			int channelCount, int reduction
+		);
+			// Set up the image with the reduced size.
+		void PutRow(emImage & image, const emByte * row);
+			// Give the next row of full resolution. The rows must be
+			// given in order from top to bottom.
+		int GetRowCount() const;
+			// Number of rows given so far.
+	private:
+		int OriginalWidth;
+		int OriginalHeight;
+		int ChannelCount;
+		int Reduction;
+		int RowCount;
+		emArray<emUInt32> Sums;
+	};
+
 	emImage Image;
 	emString Comment;
 	emString FileFormatInfo;
@@ -79,6 +133,23 @@ protected:
 	emSignal ChangeSignal;
 		// To be signaled by the implementation of TryStartLoading
 		// and/or TryContinueLoading.
+
+private:
+
+	int CalcReductionFor(double viewedWidth, double viewedHeight) const;
+
+	struct ViewedSizeEntry {
+		const void * Viewer;
+		double Width;
+		double Height;
+	};
+
+	emArray<ViewedSizeEntry> ViewedSizes;
+	int OriginalWidth;
+	int OriginalHeight;
+	int OriginalChannelCount;
+	int MaxReduction;
+	int Reduction;
 };
 
 inline const emImage & emImageFileModel::GetImage() const
@@ -101,6 +172,21 @@ inline const emSignal & emImageFileModel::GetChangeSignal() const
 	return ChangeSignal;
 }
 
+inline int emImageFileModel::GetOriginalWidth() const
+{
+	return OriginalWidth>0 ? OriginalWidth : Image.GetWidth();
+}
+
+inline int emImageFileModel::GetOriginalHeight() const
+{
+	return OriginalHeight>0 ? OriginalHeight : Image.GetHeight();
+}
+
+inline int emImageFileModel::RowReducer::GetRowCount() const
+{
+	return RowCount;
+}
+
 
 //==============================================================================
 //============================== emImageFilePanel ==============================
@@ -116,6 +202,8 @@ public:
 	                 emImageFileModel * fileModel=NULL,
 	                 bool updateFileModel=true);
 
+	virtual ~emImageFilePanel();
+
 	virtual void SetFileModel(emFileModel * fileModel,
 	                          bool updateFileModel=true);
 
@@ -132,8 +220,21 @@ protected:
 
 	virtual void Paint(const emPainter & painter, emColor canvasColor) const;
 
+	virtual void Notice(NoticeFlags flags);
+
 	virtual emPanel * CreateControlPanel(ParentArg parent,
 	                                     const emString & name);
+
+private:
+
+	void UpdateViewedSize();
+
+	emImage Preview;
+		// While the file is loaded again at a higher resolution, the
+		// previous image is shown.
+
+	bool ViewedSizeSet;
+		// Whether a viewed size has been given to the model.
 };
 
 
@@ -163,6 +163,19 @@ public:
 		//               method returns even if no pipe is ready.
 		//               UINT_MAX means infinite.
 
+	static void WaitPipes(
+		emProcess * const * processes, const int * waitFlags, int count,
+		unsigned timeoutMS=UINT_MAX
+	);
+		// Like WaitPipes(waitFlags,timeoutMS), but wait for the pipes of
+		// multiple child processes at once. The method returns when at
+		// least one of the pipes is ready.
+		// Arguments:
+		//   processes - Array of the child processes.
+		//   waitFlags - Array of the wait flags for each process.
+		//   count     - Number of elements in the arrays.
+		//   timeoutMS - As with WaitPipes(waitFlags,timeoutMS).
+
 	void CloseWriting();
 	void CloseReading();
 	void CloseReadingErr();
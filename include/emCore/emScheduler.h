@@ -21,8 +21,8 @@
 #ifndef emScheduler_h
 #define emScheduler_h
 
-#ifndef emStd2_h
-#include <emCore/emStd2.h>
+#ifndef emThread_h
+#include <emCore/emThread.h>
 #endif
 
 class emEngine;
@@ -107,6 +107,11 @@ private:
 
 	void * TimerStuff;
 		// A little hack for the implementation of emTimer.
+
+	emThreadMiniMutex ThreadWakeUpMutex;
+	emEngine * ThreadWakeUpList;
+		// Single-linked list of engines woken up by other threads,
+		// protected by the mutex.
 };
 
 inline emUInt64 emScheduler::GetTimeSliceCounter() const
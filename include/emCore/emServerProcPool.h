@@ -0,0 +1,274 @@
+//------------------------------------------------------------------------------
+// emServerProcPool.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emServerProcPool_h
+#define emServerProcPool_h
+
+#ifndef emCoreConfig_h
+#include <emCore/emCoreConfig.h>
+#endif
+
+#ifndef emProcess_h
+#include <emCore/emProcess.h>
+#endif
+
+
+class emServerProcPool : public emUncopyable {
+
+public:
+
+	// Pool of server processes which render documents for a model (like
+	// emPdfServerProc for emPdfServerModel, and emSvgServerProc for
+	// emSvgServerModel). Commands are written to the standard input of a
+	// process and the answers are read from its standard output, line by
+	// line. Each process has a shared memory segment into which it renders
+	// images, so that the pixels do not have to go through the pipe. The
+	// first command to a process is "attachshm <id>", and it is sent again
+	// whenever the segment is replaced by a larger one.
+	//
+	// The model runs the jobs: it assigns them to processes with
+	// AssignProc(..), writes the commands, reads the answers after
+	// TryIO(..), and tells the pool the load of each process. A document
+	// is opened on further processes when the processes which have it
+	// opened are busy, so that its jobs are spread over the pool. The
+	// number of processes is limited by the number of hardware threads and
+	// by the MaxRenderThreads setting of emCoreConfig. A process is
+	// terminated when it has been idle for IDLE_TIMEOUT milliseconds
+	// without open documents.
+
+	emServerProcPool(emRootContext & rootContext, const emString & procPath,
+	                 const char * name);
+		// Arguments:
+		//   rootContext - For getting emCoreConfig.
+		//   procPath    - Path of the server executable.
+		//   name        - Name of the document type for messages, like
+		//                 "PDF".
+
+	~emServerProcPool();
+
+	class Proc : public emUncopyable {
+	public:
+		void WriteLine(const char * str);
+			// Append a command line to WriteBuf.
+		emString ReadLine();
+			// Take an answer line from ReadBuf, or return an empty
+			// string if there is no complete line.
+		emProcess Process;
+		emUInt64 RunId;
+			// Unique for each start of the process, 0 if not running.
+		int InstanceCount;
+			// Number of documents opened on the process.
+		emUInt64 IdleClock;
+		bool Terminating;
+		int RunningJobs;
+		int CostlyJobs;
+			// Jobs started on the process and not yet finished (see
+			// ClearLoads and AddLoad).
+		emArray<char> ReadBuf;
+		emArray<char> WriteBuf;
+		int ShmSize;
+#if defined(_WIN32) || defined(__CYGWIN__)
+		char ShmId[256];
+		void * ShmHdl;
+#else
+		int ShmId;
+#endif
+		emByte * ShmPtr;
+		int ShmAllocBegin;
+		int ShmAllocEnd;
+			// The range of the shared memory segment which is in use
+			// by running render jobs. It is a ring buffer, so that the
+			// images of several jobs can be rendered in a row.
+	private:
+		friend class emServerProcPool;
+		Proc(emServerProcPool & pool);
+		~Proc();
+		void TryStart(emUInt64 runId);
+		void TryWriteAttachShm();
+		bool TryIO();
+		void TryAllocShm(int size);
+		void FreeShm();
+		emServerProcPool & Pool;
+	};
+
+	int GetProcCount() const;
+	Proc & GetProc(int procIndex) const;
+		// The processes. Entries are never removed, so that indices
+		// stay valid, but the processes are terminated when they have
+		// been idle for a while without open documents.
+
+	enum {
+		INST_NONE    = -1,
+		INST_OPENING = -2,
+		INST_FAILED  = -3
+	};
+		// Special results of GetInstanceId(..).
+
+	struct InstanceMap {
+		InstanceMap();
+		struct Entry {
+			int ProcIndex;
+			emUInt64 ProcRunId;
+			int InstanceId;
+		};
+		emArray<Entry> Entries;
+			// The processes which have a document opened, or which
+			// are opening it or failed to open it (InstanceId is
+			// INST_OPENING or INST_FAILED then). An entry is valid only
+			// as long as ProcRunId matches the RunId of the process, so
+			// a failure does not hold for a new process at the index.
+		int OpenFailures;
+			// Number of failures to open the document on another
+			// process since the last success.
+	};
+		// The instances of a document on the processes. The model
+		// keeps one per document.
+
+	int GetInstanceId(const InstanceMap & map, int procIndex) const;
+		// Get the instance id of a document on a process, or INST_NONE,
+		// INST_OPENING or INST_FAILED.
+
+	void SetInstanceId(InstanceMap & map, int procIndex, int instanceId);
+		// Set the instance id of a document on a process. A valid id
+		// counts in the InstanceCount of the process and resets
+		// OpenFailures.
+
+	void SetOpenFailed(InstanceMap & map, int procIndex);
+		// Like SetInstanceId(map,procIndex,INST_FAILED), but also count
+		// the failure. After MAX_OPEN_FAILURES, the document is not
+		// opened on further processes.
+
+	int AssignProc(const InstanceMap * map, bool costly, int * pOpenProc,
+	               bool * pFailed);
+		// Assign a process to a job.
+		// Arguments:
+		//   map       - The instances of the document of the job, or
+		//               NULL if the job opens a new document.
+		//   costly    - Whether the job is costly. Costly jobs are
+		//               sent ahead to a process only up to
+		//               MAX_COSTLY_JOBS_PER_PROC.
+		//   pOpenProc - For returning the index of a process on which
+		//               the model has to open the document (and to
+		//               call SetInstanceId(..) with INST_OPENING), or
+		//               -1.
+		//   pFailed   - For returning whether the job has to fail,
+		//               because the document cannot be opened on any
+		//               process.
+		// Returns: The index of the process, or -1 if the job has to
+		// wait.
+
+	int TryStartProc();
+		// Start a new process, if the limit allows. Returns its index,
+		// or -1. On error, the error is kept for GetStartError().
+
+	const emString & GetStartError() const;
+	void ClearStartError();
+		// The last error of starting a process. While it is set, no
+		// more processes are started.
+
+	bool IsAnyProcRunning() const;
+
+	void AbandonProc(int procIndex);
+		// Terminate a process after an error. The model must have
+		// failed the jobs running on it before.
+
+	void ClearLoads();
+	void AddLoad(int procIndex, bool costly);
+		// Count the jobs running on each process, for RunningJobs and
+		// CostlyJobs.
+
+	void TerminateIdleProcs();
+		// Terminate processes which have been idle for IDLE_TIMEOUT
+		// milliseconds without open documents, and reap terminated
+		// processes.
+
+	bool TryIO(int procIndex);
+		// Write from WriteBuf and read to ReadBuf without blocking.
+		// Returns true if anything has been written or read. Throws an
+		// emException if the process has died.
+
+	bool WaitForBusyProcs(emUInt64 endClock);
+		// Wait until a process which has running jobs or data to be
+		// written is ready for I/O, but not beyond the given clock (see
+		// emGetClockMS). Returns false without waiting if no process is
+		// busy or if the clock is reached already.
+
+	bool IsBusy() const;
+		// Whether the pool needs further polling even without jobs.
+
+	int TryAllocShmRange(int procIndex, int size);
+		// Reserve a range of the shared memory segment of a process for
+		// rendering an image of the given number of bytes. Returns the
+		// offset, or -1 if the range is not free yet. The segment is
+		// enlarged when the process has no running jobs. Throws an
+		// emException on error.
+
+	void FreeShmRange(int procIndex, int offset, int size);
+		// Release a range, when its job has finished. The ranges must
+		// be released in the order of allocation.
+
+	enum {
+		IDLE_TIMEOUT = 5000,
+		MAX_COSTLY_JOBS_PER_PROC = 2,
+			// Costly jobs are sent ahead to a process up to this
+			// number, so that it does not have to wait for the next
+			// command.
+		MAX_OPEN_FAILURES = 2,
+			// After this number of failed openings of a document on
+			// further processes (error answers or crashes), it is not
+			// opened again, so that a document which crashes the
+			// server cannot restart processes endlessly.
+		MIN_SHM_SIZE = 1000*1000*4
+	};
+
+private:
+
+	int GetMaxProcs() const;
+
+	emRef<emCoreConfig> CoreConfig;
+	emString ProcPath;
+	emString Name;
+	emArray<Proc*> Procs;
+	emUInt64 NextRunId;
+	emString StartError;
+};
+
+inline int emServerProcPool::GetProcCount() const
+{
+	return Procs.GetCount();
+}
+
+inline emServerProcPool::Proc & emServerProcPool::GetProc(int procIndex) const
+{
+	return *Procs[procIndex];
+}
+
+inline const emString & emServerProcPool::GetStartError() const
+{
+	return StartError;
+}
+
+inline void emServerProcPool::ClearStartError()
+{
+	StartError.Clear();
+}
+
+
+#endif
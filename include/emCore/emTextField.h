@@ -274,6 +274,16 @@ private:
 	                        UndoMergeType undoMerge=UM_NO_MERGE);
 	void ModifyText(int pos, int removeLen, emString insertText,
 	                int modifyFlags, UndoMergeType undoMerge=UM_NO_MERGE);
+	void ReplaceText(int pos, int removeLen, const emString & insertText);
+		// Just replace a part of the text and update the row index.
+
+	void RebuildRows();
+	void UpdateRows(int pos, int removeLen, int insertLen);
+		// Build the row index from scratch, or update it after a part
+		// of the text has been replaced. An update rescans only the
+		// modified rows.
+	int GetRowIndex(int index) const;
+		// Get the row containing a text index.
 
 	enum DragModeType {
 		DM_NONE,
@@ -316,6 +326,14 @@ private:
 	bool OverwriteMode;
 	emString Text;
 	int TextLen,CursorIndex,SelectionStartIndex,SelectionEndIndex;
+	emArray<int> RowStarts;
+		// Text index of the beginning of each row. There is at least
+		// one row, and in single-line mode there is exactly one.
+	emArray<emMBState> RowMBStates;
+		// Multi-byte state at the beginning of each row.
+	emArray<int> RowCols;
+		// Number of columns of each row.
+	int MaxRowCols;
 	int MagicCursorColumn;
 	emInt64 SelectionId;
 	emUInt64 CursorBlinkTime;
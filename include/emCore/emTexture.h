@@ -36,15 +36,16 @@ public:
 
 	// Class for a texture. A texture in this sense describes how to fill an
 	// area when painting figures with emPainter. Different types of
-	// textures allow to paint colors, images, colored images, and color
-	// gradients. Those types of textures can be easily constructed using
-	// the following derived classes:
+	// textures allow to paint colors, images, colored images, color
+	// gradients, and YUV images. Those types of textures can be easily
+	// constructed using the following derived classes:
 	//
 	//   emColorTexture
 	//   emImageTexture
 	//   emImageColoredTexture
 	//   emLinearGradientTexture
 	//   emRadialGradientTexture
+	//   emImageYuvTexture
 	//
 	// These texture classes just exist for convenience and define only
 	// constructors. All the attributes (and even the constructors) are
@@ -68,9 +69,12 @@ public:
 			// Linear gradient texture, constructed by
 			// emLinearGradientTexture.
 
-		RADIAL_GRADIENT
+		RADIAL_GRADIENT,
 			// Radial gradient texture, constructed by
 			// emRadialGradientTexture.
+
+		IMAGE_YUV
+			// YUV image texture, constructed by emImageYuvTexture.
 	};
 
 	enum ExtensionType {
@@ -178,6 +182,15 @@ public:
 		// Construct a radial gradient texture. Please see
 		// emRadialGradientTexture for details.
 
+	emTexture(double x, double y, double w, double h,
+	          const emImage & imageY, const emImage & imageU,
+	          const emImage & imageV, int alpha=255,
+	          ExtensionType extension=EXTEND_TILED,
+	          DownscaleQualityType downscaleQuality=DQ_BY_CONFIG,
+	          UpscaleQualityType upscaleQuality=UQ_BY_CONFIG);
+		// Construct a YUV image texture. Please see emImageYuvTexture
+		// for details.
+
 	emTexture(const emTexture& other);
 		// Construct a copied texture.
 
@@ -197,7 +210,7 @@ public:
 	void SetH(double h);
 		// Get or set the position and size of the target rectangle.
 		// This is valid only if the texture type is IMAGE,
-		// IMAGE_COLORED, or RADIAL_GRADIENT.
+		// IMAGE_COLORED, RADIAL_GRADIENT, or IMAGE_YUV.
 
 	double GetX1() const;
 	void SetX1(double x1);
@@ -227,7 +240,15 @@ public:
 	void SetImage(const emImage & image);
 		// Get or set the image. The image reference must be valid for
 		// the life time of the texture. This is valid only if the
-		// texture type is IMAGE or IMAGE_COLORED.
+		// texture type is IMAGE, IMAGE_COLORED, or IMAGE_YUV (Y plane).
+
+	const emImage & GetImageU() const;
+	void SetImageU(const emImage & imageU);
+	const emImage & GetImageV() const;
+	void SetImageV(const emImage & imageV);
+		// Get or set the U and V planes. The image references must be
+		// valid for the life time of the texture. This is valid only if
+		// the texture type is IMAGE_YUV.
 
 	int GetSrcX() const;
 	void SetSrcX(int srcX);
@@ -243,22 +264,24 @@ public:
 	int GetAlpha() const;
 	void SetAlpha(int alpha);
 		// Get or set the alpha value for image blending (0..255). This
-		// is valid only if the texture type is IMAGE.
+		// is valid only if the texture type is IMAGE or IMAGE_YUV.
 
 	ExtensionType GetExtension() const;
 	void SetExtension(ExtensionType extension);
 		// Get or set how to extend the image. This is valid only if the
-		// texture type is IMAGE or IMAGE_COLORED.
+		// texture type is IMAGE, IMAGE_COLORED, or IMAGE_YUV.
 
 	DownscaleQualityType GetDownscaleQuality() const;
 	void SetDownscaleQuality(DownscaleQualityType downscaleQuality);
 		// Get or set the quality of downscaling the image. This is
-		// valid only if the texture type is IMAGE or IMAGE_COLORED.
+		// valid only if the texture type is IMAGE, IMAGE_COLORED, or
+		// IMAGE_YUV.
 
 	UpscaleQualityType GetUpscaleQuality() const;
 	void SetUpscaleQuality(UpscaleQualityType upscaleQuality);
 		// Get or set the quality of upscaling the image. This is valid
-		// only if the texture type is IMAGE or IMAGE_COLORED.
+		// only if the texture type is IMAGE, IMAGE_COLORED, or
+		// IMAGE_YUV.
 
 private:
 
@@ -270,6 +293,8 @@ private:
 	emColor Color1;
 	union { emUInt32 Color2; int Alpha; };
 	const emImage * Image;
+	const emImage * ImageU;
+	const emImage * ImageV;
 	int SrcX,SrcY,SrcW,SrcH;
 	union { double X; double X1; };
 	union { double Y; double Y1; };
@@ -464,6 +489,58 @@ public:
 };
 
 
+//==============================================================================
+//============================= emImageYuvTexture ==============================
+//==============================================================================
+
+class emImageYuvTexture : public emTexture {
+
+public:
+
+	emImageYuvTexture(double x, double y, double w, double h,
+	                  const emImage & imageY, const emImage & imageU,
+	                  const emImage & imageV, int alpha=255,
+	                  ExtensionType extension=EXTEND_TILED,
+	                  DownscaleQualityType downscaleQuality=DQ_BY_CONFIG,
+	                  UpscaleQualityType upscaleQuality=UQ_BY_CONFIG);
+		// Construct a YUV image texture. This paints an image which is
+		// given by three planes with one channel each, like a decoded
+		// video frame. The planes are scaled to the output resolution
+		// separately, and the color conversion happens on the scaled
+		// pixels. Thus, a large frame painted small costs only as much
+		// conversion as the painted pixels need. The conversion is
+		// after ITU-R BT.601 with video range (Y from 16 to 235, U and
+		// V from 16 to 240).
+		// Arguments:
+		//   x,y,w,h             - Upper-left corner and size of the
+		//                         target rectangle. Each plane is
+		//                         fitted into this rectangle, so that
+		//                         the U and V planes may have a lower
+		//                         resolution than the Y plane (e.g.
+		//                         half width and half height for
+		//                         I420).
+		//   imageY              - The Y plane (one channel).
+		//   imageU              - The U plane (one channel).
+		//   imageV              - The V plane (one channel).
+		//                         The image references must be valid
+		//                         for the life time of the texture.
+		//   alpha               - An alpha value for blending (0-255).
+		//   extension             What is painted beyond the target
+		//                         rectangle (x,y,w,h). EXTEND_ZERO and
+		//                         EXTEND_EDGE_OR_ZERO are treated like
+		//                         EXTEND_EDGE, because zero is not
+		//                         black in YUV.
+		//   downscaleQuality    - Quality of downscaling the planes.
+		//                         Please see the comments on
+		//                         emTexture::DownscaleQualityType for
+		//                         details.
+		//   upscaleQuality      - Quality of upscaling the planes.
+		//                         Please see the comments on
+		//                         emTexture::UpscaleQualityType for
+		//                         details.
+};
+
+
 //==============================================================================
 //============================== Implementations ===============================
 //==============================================================================
@@ -544,6 +621,19 @@ inline emTexture::emTexture(
 {
 }
 
+inline emTexture::emTexture(
+	double x, double y, double w, double h, const emImage & imageY,
+	const emImage & imageU, const emImage & imageV, int alpha,
+	ExtensionType extension,
+	DownscaleQualityType downscaleQuality, UpscaleQualityType upscaleQuality
+) :
+	Type(IMAGE_YUV),Extension(extension),DownscaleQuality(downscaleQuality),
+	UpscaleQuality(upscaleQuality),Alpha(alpha),Image(&imageY),
+	ImageU(&imageU),ImageV(&imageV),SrcX(0),SrcY(0),
+	SrcW(imageY.GetWidth()),SrcH(imageY.GetHeight()),X(x),Y(y),W(w),H(h)
+{
+}
+
 inline emTexture::emTexture(const emTexture& other)
 {
 	memcpy((void*)this,(const void*)&other,sizeof(emTexture));
@@ -680,6 +770,26 @@ inline void emTexture::SetImage(const emImage & image)
 	Image=&image;
 }
 
+inline const emImage & emTexture::GetImageU() const
+{
+	return *ImageU;
+}
+
+inline void emTexture::SetImageU(const emImage & imageU)
+{
+	ImageU=&imageU;
+}
+
+inline const emImage & emTexture::GetImageV() const
+{
+	return *ImageV;
+}
+
+inline void emTexture::SetImageV(const emImage & imageV)
+{
+	ImageV=&imageV;
+}
+
 inline int emTexture::GetSrcX() const
 {
 	return SrcX;
@@ -834,4 +944,18 @@ inline emRadialGradientTexture::emRadialGradientTexture(
 {
 }
 
+
+//----------------------------- emImageYuvTexture ------------------------------
+
+inline emImageYuvTexture::emImageYuvTexture(
+	double x, double y, double w, double h, const emImage & imageY,
+	const emImage & imageU, const emImage & imageV, int alpha,
+	ExtensionType extension,
+	DownscaleQualityType downscaleQuality, UpscaleQualityType upscaleQuality
+) :
+	emTexture(x,y,w,h,imageY,imageU,imageV,alpha,extension,downscaleQuality,
+	          upscaleQuality)
+{
+}
+
 #endif
@@ -0,0 +1,206 @@
+//------------------------------------------------------------------------------
+// emTileCache.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emTileCache_h
+#define emTileCache_h
+
+#ifndef emEngine_h
+#include <emCore/emEngine.h>
+#endif
+
+#ifndef emImage_h
+#include <emCore/emImage.h>
+#endif
+
+#ifndef emJob_h
+#include <emCore/emJob.h>
+#endif
+
+
+class emTileCache : public emEngine {
+
+public:
+
+	// Abstract base class for a cache of the rendered contents of the pages
+	// of a document. The pages are rendered in tiles of TILE_SIZE x
+	// TILE_SIZE pixels at zoom levels which are powers of two: At level L,
+	// a page has 2^L pixels per page unit, and tile (X,Y) starts at pixel
+	// (X*TILE_SIZE, Y*TILE_SIZE) of the page. Tiles at the right and bottom
+	// edges of a page are smaller. Derived classes define the pages and
+	// create the jobs which render the tiles.
+	//
+	// Tiles are requested and released by the panels which show them. A
+	// requested tile is rendered if it is not cached, and it is kept in
+	// the cache at least until it is released. The released tiles are
+	// kept as long as the memory of all tiles does not exceed
+	// MAX_MEMORY, and the least recently released ones are removed first.
+
+	emTileCache(emScheduler & scheduler);
+	virtual ~emTileCache();
+
+	virtual void Reset();
+		// Remove all tiles and abort their jobs. Derived classes must
+		// call this in their destructors, because the jobs are aborted
+		// through AbortTileJob(..).
+
+	int GetSetupCount() const;
+		// Incremented by Reset(). Releasing tiles which have been
+		// requested before a Reset() must be avoided (instead the
+		// requests are simply forgotten).
+
+	enum {
+		TILE_SIZE  = 512,
+		MIN_LEVEL  = -20,
+		MAX_LEVEL  = 40,
+		MAX_MEMORY = 64*1024*1024
+	};
+
+	static int GetLevel(double pixelsPerUnit);
+		// Get the lowest zoom level with at least the given number of
+		// pixels per page unit (clipped to MIN_LEVEL and MAX_LEVEL).
+
+	static double GetScale(int level);
+		// Get the number of pixels per page unit at a zoom level.
+
+	emInt64 GetTileCountX(int page, int level) const;
+	emInt64 GetTileCountY(int page, int level) const;
+		// Get the number of tiles of a page at a zoom level.
+
+	void RequestTile(int page, int level, emInt64 x, emInt64 y,
+	                 double priority);
+		// Request a tile. Each call must be balanced by a call to
+		// ReleaseTile.
+
+	void ReleaseTile(int page, int level, emInt64 x, emInt64 y);
+		// Release a tile. When it is released by all requesters and
+		// it is still waiting for being rendered, the job is aborted.
+
+	void SetTilePriority(int page, int level, emInt64 x, emInt64 y,
+	                     double priority);
+		// Set the priority for rendering a requested tile.
+
+	const emImage * GetTileImage(int page, int level, emInt64 x,
+	                             emInt64 y) const;
+		// Get the image of a tile, or NULL if it is not cached. This
+		// does not modify anything, so it can be called by multiple
+		// threads while painting.
+
+	const emString * GetTileError(int page, int level, emInt64 x,
+	                              emInt64 y) const;
+		// Get the error text if rendering a requested tile failed, or
+		// NULL.
+
+	const emJob * GetTileJob(int page, int level, emInt64 x,
+	                         emInt64 y) const;
+		// Get the job which is rendering a tile, or NULL.
+
+	const emSignal & GetTileSignal() const;
+		// Signaled when tiles have been rendered or failed.
+
+protected:
+
+	virtual bool Cycle();
+
+	virtual bool GetPageSize(int page, double * pWidth,
+	                         double * pHeight) const = 0;
+		// Get the size of a page in page units. Returns false if there
+		// is no such page (e.g. not set up).
+
+	virtual emRef<emJob> StartTileJob(
+		int page, double srcX, double srcY, double srcWidth,
+		double srcHeight, int tgtWidth, int tgtHeight, double priority
+	) = 0;
+		// Create and enqueue a job which renders the given rectangle of
+		// a page (in page units) to an image of the given size. Returns
+		// NULL if the job cannot be created.
+
+	virtual void AbortTileJob(emJob & job) = 0;
+		// Abort a job created by StartTileJob(..), if it is not running.
+
+	virtual const emImage & GetTileJobImage(const emJob & job) const = 0;
+		// Get the image of a job created by StartTileJob(..) which has
+		// succeeded.
+
+private:
+
+	struct Tile {
+		int Page;
+		int Level;
+		emInt64 X,Y;
+		emImage Image;
+		emRef<emJob> Job;
+		emString ErrorText;
+		int RequestCount;
+		Tile * LruPrev;
+		Tile * LruNext;
+			// Links in the list of tiles which are not requested and
+			// have an image, or NULL.
+	};
+
+	struct Key {
+		int Page;
+		int Level;
+		emInt64 X,Y;
+	};
+
+	int FindTile(int page, int level, emInt64 x, emInt64 y) const;
+		// Index of the tile in Tiles, or ~index for insertion.
+
+	void RemoveTile(int index);
+	void ShrinkCache();
+
+	void LinkLru(Tile * t);
+	void UnlinkLru(Tile * t);
+
+	static emUInt64 GetImageMemory(const emImage & image);
+
+	static int CompareTileToKey(Tile * const * tile, void * key,
+	                            void * context);
+
+	emArray<Tile*> Tiles;
+		// Sorted by page, level, Y and X.
+	Tile * LruFirst;
+	Tile * LruLast;
+		// The tiles which are not requested and have an image, least
+		// recently released first. These are the candidates for
+		// removal when the memory limit is exceeded.
+	emUInt64 Memory;
+		// Bytes of all images in Tiles.
+	int SetupCount;
+	emSignal TileSignal;
+};
+
+inline int emTileCache::GetSetupCount() const
+{
+	return SetupCount;
+}
+
+inline double emTileCache::GetScale(int level)
+{
+	return ldexp(1.0,level);
+}
+
+inline const emSignal & emTileCache::GetTileSignal() const
+{
+	return TileSignal;
+}
+
+
+#endif
@@ -41,6 +41,10 @@
 #include <emFileMan/emFileManModel.h>
 #endif
 
+#ifndef emFileManThumbnailCache_h
+#include <emFileMan/emFileManThumbnailCache.h>
+#endif
+
 
 class emDirEntryPanel : public emPanel {
 
@@ -88,6 +92,9 @@ private:
 	) const;
 
 	void UpdateContentPanel(bool forceRecreation=false, bool forceRelayout=false);
+	void UpdateThumbnail();
+	void ResetThumbnail();
+	bool IsContentAreaViewed(double minContentVW) const;
 	void UpdateAltPanel(bool forceRecreation=false, bool forceRelayout=false);
 	void UpdateBgColor();
 
@@ -105,6 +112,20 @@ private:
 	emDirEntry DirEntry;
 	emColor BgColor;
 	bool RecursiveCall;
+
+	enum ThumbnailStateEnum {
+		TS_UNKNOWN,
+		TS_UNSUPPORTED,
+		TS_WANTED,
+		TS_LOADING,
+		TS_LOADED,
+		TS_FAILED
+	};
+	ThumbnailStateEnum ThumbnailState;
+	emRef<emFileManThumbnailCache> ThumbnailCache;
+	emRef<emFileManThumbnailCache::LoadJob> ThumbnailJob;
+	emImage Thumbnail;
+	int ThumbnailSize;
 };
 
 inline const emDirEntry & emDirEntryPanel::GetDirEntry() const
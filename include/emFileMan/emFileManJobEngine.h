@@ -0,0 +1,226 @@
+//------------------------------------------------------------------------------
+// emFileManJobEngine.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emFileManJobEngine_h
+#define emFileManJobEngine_h
+
+#ifndef emEngine_h
+#include <emCore/emEngine.h>
+#endif
+
+#ifndef emJob_h
+#include <emCore/emJob.h>
+#endif
+
+#ifndef emOwnPtr_h
+#include <emCore/emOwnPtr.h>
+#endif
+
+#ifndef emThread_h
+#include <emCore/emThread.h>
+#endif
+
+
+//==============================================================================
+//============================= emFileManJobEngine =============================
+//==============================================================================
+
+class emFileManJobEngine : public emEngine {
+
+public:
+
+	// Engine for copying, moving and removing files and directory trees
+	// in-process. Each running job has its own worker thread, so that the
+	// scheduler thread is never blocked by file system operations. On
+	// Linux, regular files are copied by reflink (FICLONE) where the file
+	// system supports it, otherwise by copy_file_range or sendfile, and
+	// finally by read/write.
+
+	emFileManJobEngine(emScheduler & scheduler);
+	virtual ~emFileManJobEngine();
+
+	enum OperationType {
+		OP_COPY,
+			// Copy the sources recursively into the target directory,
+			// or onto the target path if it is not a directory.
+			// Existing files are overwritten, symbolic links are
+			// copied as links, and permissions and modification
+			// times are preserved.
+		OP_MOVE,
+			// Like OP_COPY, but rename the sources. Where the target
+			// is on another file system, the sources are copied and
+			// then removed.
+		OP_REMOVE
+			// Remove the sources recursively. The target path is
+			// ignored.
+	};
+
+	class Job : public emJob {
+	public:
+
+		Job(
+			OperationType operation, const emArray<emString> & sourcePaths,
+			const emString & targetPath, double priority=0.0
+		);
+		virtual ~Job();
+
+		OperationType GetOperation() const;
+		const emArray<emString> & GetSourcePaths() const;
+		const emString & GetTargetPath() const;
+
+		emArray<emString> GetResultPaths() const;
+			// Get the paths of the copied or moved top-level entries
+			// which exist after the job. Empty for OP_REMOVE.
+
+		bool IsTargetDirectory() const;
+			// Whether the sources are copied or moved into the target
+			// path as a directory, rather than onto it. This is
+			// decided once when the job is started, so that the first
+			// source cannot turn a non-existing target into a
+			// directory for the others. A job with several sources
+			// fails if the target is not a directory.
+
+		const emSignal & GetProgressSignal() const;
+			// Signaled when any of the progress values below has
+			// changed.
+
+		emUInt64 GetTotalBytes() const;
+		emUInt64 GetDoneBytes() const;
+		emUInt64 GetTotalEntries() const;
+		emUInt64 GetDoneEntries() const;
+			// Progress in bytes of file content and in number of
+			// file system entries. The totals are known after the
+			// sources have been scanned (IsScanning()==false).
+
+		bool IsScanning() const;
+			// Whether the sources are still being scanned for
+			// calculating the totals.
+
+		const emString & GetCurrentPath() const;
+			// Source path of the entry currently being processed.
+
+		double GetProgress() const;
+			// Overall progress in percent.
+
+	private:
+		friend class emFileManJobEngine;
+		class WorkerThread;
+
+		OperationType Operation;
+		emArray<emString> SourcePaths;
+		emString TargetPath;
+		bool TargetIsDir;
+		emSignal ProgressSignal;
+		emUInt64 TotalBytes;
+		emUInt64 DoneBytes;
+		emUInt64 TotalEntries;
+		emUInt64 DoneEntries;
+		bool Scanning;
+		emString CurrentPath;
+		emOwnPtr<WorkerThread> Worker;
+	};
+
+	void EnqueueJob(Job & job);
+		// Enqueue a job. It is started as soon as fewer than
+		// GetMaxRunningJobs() jobs are running.
+
+	void AbortJob(Job & job);
+		// Abort a job. A running job is stopped after the current
+		// chunk of work, and the files processed so far remain.
+
+	int GetMaxRunningJobs() const;
+	void SetMaxRunningJobs(int maxRunningJobs);
+		// Maximum number of jobs to be run concurrently. The default
+		// is 2.
+
+protected:
+
+	virtual bool Cycle();
+
+private:
+
+	bool PollRunningJob(Job & job);
+
+	emJobQueue JobQueue;
+	int MaxRunningJobs;
+};
+
+inline emFileManJobEngine::OperationType emFileManJobEngine::Job::GetOperation() const
+{
+	return Operation;
+}
+
+inline const emArray<emString> & emFileManJobEngine::Job::GetSourcePaths() const
+{
+	return SourcePaths;
+}
+
+inline const emString & emFileManJobEngine::Job::GetTargetPath() const
+{
+	return TargetPath;
+}
+
+inline const emSignal & emFileManJobEngine::Job::GetProgressSignal() const
+{
+	return ProgressSignal;
+}
+
+inline bool emFileManJobEngine::Job::IsTargetDirectory() const
+{
+	return TargetIsDir;
+}
+
+inline emUInt64 emFileManJobEngine::Job::GetTotalBytes() const
+{
+	return TotalBytes;
+}
+
+inline emUInt64 emFileManJobEngine::Job::GetDoneBytes() const
+{
+	return DoneBytes;
+}
+
+inline emUInt64 emFileManJobEngine::Job::GetTotalEntries() const
+{
+	return TotalEntries;
+}
+
+inline emUInt64 emFileManJobEngine::Job::GetDoneEntries() const
+{
+	return DoneEntries;
+}
+
+inline bool emFileManJobEngine::Job::IsScanning() const
+{
+	return Scanning;
+}
+
+inline const emString & emFileManJobEngine::Job::GetCurrentPath() const
+{
+	return CurrentPath;
+}
+
+inline int emFileManJobEngine::GetMaxRunningJobs() const
+{
+	return MaxRunningJobs;
+}
+
+
+#endif
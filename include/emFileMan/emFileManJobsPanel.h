@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------------
+// emFileManJobsPanel.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emFileManJobsPanel_h
+#define emFileManJobsPanel_h
+
+#ifndef emToolkit_h
+#include <emCore/emToolkit.h>
+#endif
+
+#ifndef emFileManModel_h
+#include <emFileMan/emFileManModel.h>
+#endif
+
+
+class emFileManJobsPanel : public emLinearGroup {
+
+public:
+
+	// Panel showing the copy, move and remove jobs of the emFileManModel
+	// with their progress, and with buttons for aborting them.
+
+	emFileManJobsPanel(ParentArg parent, const emString & name);
+
+	virtual ~emFileManJobsPanel();
+
+protected:
+
+	virtual bool Cycle();
+
+private:
+
+	class JobPanel : public emLinearGroup {
+	public:
+		JobPanel(
+			ParentArg parent, const emString & name,
+			emFileManModel * fmModel, emFileManJobEngine::Job * job
+		);
+		virtual ~JobPanel();
+		emFileManJobEngine::Job * GetJob() const;
+	protected:
+		virtual bool Cycle();
+	private:
+		class ProgressPanel : public emBorder {
+		public:
+			ProgressPanel(ParentArg parent, const emString & name,
+			              emFileManJobEngine::Job * job);
+			virtual ~ProgressPanel();
+			void Update();
+		protected:
+			virtual void PaintContent(
+				const emPainter & painter, double x, double y,
+				double w, double h, emColor canvasColor
+			) const;
+		private:
+			emRef<emFileManJobEngine::Job> Job;
+		};
+		void UpdateControls();
+		static emString GetJobCaption(const emFileManJobEngine::Job & job);
+		emRef<emFileManModel> FMModel;
+		emRef<emFileManJobEngine::Job> Job;
+		ProgressPanel * Progress;
+		emButton * BtAbort;
+	};
+
+	void UpdateJobPanels();
+
+	emRef<emFileManModel> FMModel;
+	emButton * BtClear;
+	emUInt64 JobPanelCounter;
+};
+
+inline emFileManJobEngine::Job * emFileManJobsPanel::JobPanel::GetJob() const
+{
+	return Job;
+}
+
+
+#endif
@@ -37,6 +37,10 @@
 #include <emFileMan/emDirEntry.h>
 #endif
 
+#ifndef emFileManJobEngine_h
+#include <emFileMan/emFileManJobEngine.h>
+#endif
+
 
 class emFileManModel : public emModel {
 
@@ -117,6 +121,29 @@ public:
 	void HotkeyInput(emView & contentView, emInputEvent & event,
 	                 const emInputState & state);
 
+	void StartFileJob(
+		emFileManJobEngine::OperationType operation,
+		const emArray<emString> & sourcePaths, const emString & targetPath,
+		const emString & commandRunId=emString()
+	);
+		// Copy, move or remove files in-process through the job
+		// engine. When the job has finished, file panels are updated,
+		// and if commandRunId still matches, the resulting files are
+		// selected as the target (like with the "selectks" MiniIpc
+		// request).
+
+	const emSignal & GetJobsSignal() const;
+		// Signaled when a file job has been added, removed or has
+		// changed its state.
+
+	int GetJobCount() const;
+	emFileManJobEngine::Job & GetJob(int index) const;
+		// The file jobs, in the order of starting, including finished
+		// ones until RemoveFinishedJobs is called.
+
+	void AbortJob(int index);
+	void RemoveFinishedJobs();
+
 protected:
 
 	emFileManModel(emContext & context, const emString & name);
@@ -135,6 +162,12 @@ private:
 		CommandNode * Node;
 	};
 
+	struct JobEntry {
+		emRef<emFileManJobEngine::Job> Job;
+		emString CommandRunId;
+		bool Completed;
+	};
+
 	class IpcServerClass : public emMiniIpcServer {
 	public:
 		IpcServerClass(emFileManModel & fmModel);
@@ -183,6 +216,8 @@ private:
 	);
 	emString GetCommandRunId() const;
 
+	void UpdateJobs();
+
 
 	emSignal SelectionSignal;
 	emArray<SelEntry> Sel[2];
@@ -197,6 +232,10 @@ private:
 
 	CommandNode * CmdRoot;
 	emArray<CmdEntry> Cmds;
+
+	emFileManJobEngine JobEngine;
+	emSignal JobsSignal;
+	emArray<JobEntry> Jobs;
 };
 
 inline const emSignal & emFileManModel::GetSelectionSignal() const
@@ -268,5 +307,20 @@ inline const emFileManModel::CommandNode * emFileManModel::GetCommandRoot() cons
 	return CmdRoot;
 }
 
+inline const emSignal & emFileManModel::GetJobsSignal() const
+{
+	return JobsSignal;
+}
+
+inline int emFileManModel::GetJobCount() const
+{
+	return Jobs.GetCount();
+}
+
+inline emFileManJobEngine::Job & emFileManModel::GetJob(int index) const
+{
+	return *Jobs[index].Job;
+}
+
 
 #endif
@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------------
+// emFileManThumbnailCache.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emFileManThumbnailCache_h
+#define emFileManThumbnailCache_h
+
+#ifndef emImageFile_h
+#include <emCore/emImageFile.h>
+#endif
+
+#ifndef emFpPlugin_h
+#include <emCore/emFpPlugin.h>
+#endif
+
+#ifndef emJob_h
+#include <emCore/emJob.h>
+#endif
+
+#ifndef emThread_h
+#include <emCore/emThread.h>
+#endif
+
+
+//==============================================================================
+//========================== emFileManThumbnailCache ===========================
+//==============================================================================
+
+class emFileManThumbnailCache : public emModel {
+
+public:
+
+	// Persistent cache of thumbnail images for image files. Thumbnails
+	// are stored in the user configuration directory, in a few fixed
+	// resolutions, and they are keyed by the path, the modification time
+	// and the size of the image file. A missing or outdated thumbnail is
+	// generated by loading the image file through the file panel plugin
+	// (emFpPluginList::TryAcquireModel) and scaling it down in a worker
+	// thread. The cache is limited to MAX_TOTAL_SIZE_MB, by removing the
+	// least recently used thumbnails.
+
+	static emRef<emFileManThumbnailCache> Acquire(emRootContext & rootContext);
+
+	enum {
+		NORMAL_SIZE = 128,
+		LARGE_SIZE  = 256
+		// Supported thumbnail sizes (maximum width and height in
+		// pixels).
+	};
+
+	enum {
+		MAX_TOTAL_SIZE_MB = 512,
+			// Size limit of the whole cache in megabytes.
+		SHRINK_INTERVAL = 64
+			// The cache is shrunk in the background after this
+			// number of new thumbnails (and after the first one).
+	};
+
+	static int GetSizeFor(double viewedWidth);
+		// Get the smallest supported thumbnail size which is good for
+		// showing a thumbnail with the given viewed width.
+
+	bool IsThumbnailable(const emString & filePath, long statMode) const;
+		// Whether a thumbnail could be generated for the given file.
+
+	class LoadJob : public emJob {
+	public:
+		LoadJob(const emString & filePath, int size, double priority=0.0);
+		virtual ~LoadJob();
+		const emString & GetFilePath() const;
+		int GetSize() const;
+		const emImage & GetImage() const;
+	private:
+		friend class emFileManThumbnailCache;
+		class GenerateThread;
+		enum LoadStateEnum {
+			LS_IDLE,
+			LS_START_LOAD_FILE,
+			LS_LOADING_FILE,
+			LS_GENERATING
+		};
+		emString FilePath;
+		int Size;
+		LoadStateEnum LoadState;
+		emString ThumbnailPath;
+		emString Id;
+		long StatMode;
+		emRef<emImageFileModel> FileModel;
+		emOwnPtr<emFileModelClient> FileModelClient;
+		emOwnPtr<GenerateThread> Generator;
+		emImage Image;
+	};
+
+	void EnqueueJob(LoadJob & job);
+	void AbortJob(LoadJob & job);
+
+protected:
+
+	emFileManThumbnailCache(emContext & context, const emString & name);
+	virtual ~emFileManThumbnailCache();
+
+	virtual bool Cycle();
+
+private:
+
+	class MyFileModelClient : public emFileModelClient {
+	public:
+		MyFileModelClient(LoadJob & job);
+		void SetPriorityFromJob();
+		virtual emUInt64 GetMemoryLimit() const;
+		virtual double GetPriority() const;
+		virtual bool IsReloadAnnoying() const;
+	private:
+		LoadJob & Job;
+		double Priority;
+	};
+
+	class ShrinkThread;
+
+	void UpdateLoadJob(LoadJob & job);
+	void CountNewThumbnail();
+
+	static emString GetDirPath();
+
+	static bool TryLoadThumbnail(
+		const emString & path, const emString & id, emImage * image
+	);
+
+	emJobQueue JobQueue;
+	emRef<emFpPluginList> FpPluginList;
+	emOwnPtr<ShrinkThread> Shrinker;
+	int NewThumbnailCount;
+};
+
+
+inline const emString & emFileManThumbnailCache::LoadJob::GetFilePath() const
+{
+	return FilePath;
+}
+
+inline int emFileManThumbnailCache::LoadJob::GetSize() const
+{
+	return Size;
+}
+
+inline const emImage & emFileManThumbnailCache::LoadJob::GetImage() const
+{
+	return Image;
+}
+
+
+#endif
@@ -29,6 +29,8 @@
 #include <emCore/emImage.h>
 #endif
 
+class emGifFrameCache;
+
 
 class emGifFileModel : public emFileModel {
 
@@ -65,6 +67,13 @@ public:
 
 	emImage RenderAll() const;
 
+	emGifFrameCache * GetFrameCache();
+		// Get the playback cache shared by all panels showing this
+		// model. It is created on demand, with a memory bound derived
+		// from the memory limit of the model, and it is deleted when
+		// the model data is reset. Returns NULL if the model is not
+		// loaded or has no frames.
+
 protected:
 
 	emGifFileModel(emContext & context, const emString & name);
@@ -81,6 +90,8 @@ protected:
 
 private:
 
+	friend class emGifFrameCache;
+
 	bool PostProcess();
 	int Read8();
 	int Read16();
@@ -116,6 +127,7 @@ private:
 	bool NextUserInput;
 	int NextDelay;
 	int NextTransparent;
+	emGifFrameCache * FrameCache;
 };
 
 inline int emGifFileModel::GetWidth() const
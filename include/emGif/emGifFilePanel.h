@@ -29,8 +29,8 @@
 #include <emCore/emFilePanel.h>
 #endif
 
-#ifndef emGifFileModel_h
-#include <emGif/emGifFileModel.h>
+#ifndef emGifFrameCache_h
+#include <emGif/emGifFrameCache.h>
 #endif
 
 
@@ -75,11 +75,13 @@ private:
 
 	void CalcImageLayout(double * pX, double * pY, double * pW, double * pH) const;
 	void InvalidatePerImage(int x, int y, int w, int h);
+	void LeaveFrameCache();
 
 	emSignal PlaySignal;
-	emImage Image, UndoImage;
+	emImage Image;
 	int RIndex;
 	bool Playing;
+	bool Waiting;
 	emTimer Timer;
 };
 
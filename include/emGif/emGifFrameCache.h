@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+// emGifFrameCache.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emGifFrameCache_h
+#define emGifFrameCache_h
+
+#ifndef emArray_h
+#include <emCore/emArray.h>
+#endif
+
+#ifndef emThread_h
+#include <emCore/emThread.h>
+#endif
+
+#ifndef emGifFileModel_h
+#include <emGif/emGifFileModel.h>
+#endif
+
+
+//==============================================================================
+//============================== emGifFrameCache ===============================
+//==============================================================================
+
+class emGifFrameCache : private emThread {
+
+public:
+
+	// Playback cache of a loaded emGifFileModel, shared by all panels
+	// showing the model (see emGifFileModel::GetFrameCache). A worker
+	// thread renders the frames ahead of time, in playback order, into a
+	// composited image (with the disposal methods applied), and stores
+	// copies of the composited frames. For each frame it also records the
+	// rectangle which has changed since the previous frame, so that a
+	// reader playing the frames in order has to copy and repaint only
+	// that delta rectangle.
+	//
+	// Each reader (normally a panel) is an engine which is woken up by
+	// the worker thread when a frame it has asked for becomes available.
+	// The worker prefers the frames which are closest ahead of the
+	// readers' playback positions, and it drops the frames which are
+	// farthest away when the memory limit is reached. After the last
+	// frame, playback continues with the first frame, as long as the
+	// model is animated.
+
+	emGifFrameCache(emGifFileModel & model, emUInt64 maxMemory);
+		// Construct and start the worker thread. The model must be in
+		// the loaded state and have at least one frame. The model
+		// deletes the cache before its data is reset.
+		// Arguments:
+		//   model     - The model.
+		//   maxMemory - Maximum memory of the cached frames in bytes.
+		//               At least one frame per reader is cached
+		//               regardless.
+
+	virtual ~emGifFrameCache();
+
+	void AddReader(emEngine & reader);
+	void RemoveReader(emEngine & reader);
+		// Register or unregister a reader. A reader must be removed
+		// before it is destructed. Adding a reader twice or removing
+		// an unknown reader has no effect.
+
+	bool GetFrame(emEngine & reader, int index, int prevIndex,
+	              emImage * image, int * pX, int * pY, int * pW, int * pH);
+		// Copy a frame into an image. If the frame is not yet cached,
+		// false is returned, and the reader is woken up as soon as
+		// the frame is available.
+		// Arguments:
+		//   reader    - The reader (must have been added).
+		//   index     - Index of the frame.
+		//   prevIndex - Index of the frame currently in the image, or
+		//               -1 if the image has no frame. If it is the
+		//               frame before the requested one in playback
+		//               order, only the changed rectangle is copied.
+		//   image     - The image to copy to. It must have the size
+		//               and channel count of the model.
+		//   pX,pY,pW,pH - Pointers for returning the rectangle which
+		//               has been copied. The size is zero if nothing
+		//               has changed.
+		// Returns: true on success.
+
+private:
+
+	virtual int Run(void * arg);
+
+	int GetNextIndex(int index) const;
+	int GetDistance(int index) const;
+	int FindWantedFrame(int * pDistance) const;
+	int FindDroppableFrame(int distance) const;
+	emUInt64 GetMemoryLimit() const;
+	bool RenderTo(int index);
+	void RenderStep(int * pX1, int * pY1, int * pX2, int * pY2);
+
+	struct Frame {
+		emImage Image;
+			// The composited frame. Empty if not cached.
+		int X1,Y1,X2,Y2;
+			// Rectangle which has changed since the previous frame
+			// in playback order (the whole image if not known
+			// better). Kept when the image is dropped.
+	};
+
+	struct Reader {
+		emEngine * Engine;
+		int Position;
+			// Index of the frame the reader plays next, or
+			// RenderCount if the reader is at the end.
+		bool Waiting;
+			// Whether the reader waits for the frame at Position.
+	};
+
+	emGifFileModel & Model;
+	emUInt64 MaxMemory;
+	emUInt64 FrameMemory;
+	emThreadMiniMutex Mutex;
+	emThreadEvent WorkEvent;
+	emArray<Frame> Frames;
+	emArray<Reader> Readers;
+	emUInt64 Memory;
+	bool Quit;
+
+	// Only used by the worker thread:
+	emImage Image,UndoImage,OldImage;
+	int RIndex;
+};
+
+
+#endif
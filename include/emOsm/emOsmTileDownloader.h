@@ -38,6 +38,14 @@ class emOsmTileDownloader : public emEngine {
 
 public:
 
+	// Downloads files through the helper process emOsmDownloadProc, which
+	// keeps its connections alive and reports each file as soon as it is
+	// complete. Only up to MAX_HELPER_JOBS jobs are given to the helper at
+	// a time, so that the waiting jobs can still be reordered by priority
+	// while the view moves. If the helper is not installed (it needs
+	// libcurl) or does not work, the curl program is run for each batch of
+	// files instead.
+
 	emOsmTileDownloader(emScheduler & scheduler);
 	virtual ~emOsmTileDownloader();
 
@@ -52,6 +60,7 @@ public:
 		friend class emOsmTileDownloader;
 		emString Url;
 		emString FilePath;
+		int Id;
 	};
 
 	void EnqueueJob(DownloadJob & job);
@@ -63,12 +72,30 @@ protected:
 
 private:
 
+	bool CycleHelper();
+	bool CycleCurl();
+
+	static emString GetHelperPath();
+	void HandleHelperLine(const emString & line);
+	DownloadJob * FindRunningJob(int id) const;
+	int GetRunningJobCount() const;
+	void ResetProcess();
+
 	void FailAllRunningJobs(emString errorText);
 
+	enum {
+		MAX_HELPER_JOBS = 8
+	};
+
 	emJobQueue JobQueue;
 	emProcess Process;
+	bool UseHelper;
 	bool ProcStarted;
+	bool HelperReplied;
 	emString ProcErr;
+	emArray<char> ReadBuf;
+	emArray<char> WriteBuf;
+	int NextJobId;
 };
 
 
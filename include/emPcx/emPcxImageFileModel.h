@@ -54,13 +54,15 @@ private:
 
 	struct LoadingState {
 		int Width,Height,Channels,PlanePixBits;
-		int PlaneCount,BytesPerLine,RowPlaneSize,NextY;
+		int PlaneCount,BytesPerLine,RowPlaneSize,NextY,Reduction;
 		FILE * File;
 		unsigned char * Palette;
 		unsigned char * RowBuffer;
+		unsigned char * Row;
 	};
 
 	LoadingState * L;
+	RowReducer Reducer;
 };
 
 
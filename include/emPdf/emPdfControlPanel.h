@@ -25,8 +25,8 @@
 #include <emCore/emToolkit.h>
 #endif
 
-#ifndef emPdfSelection_h
-#include <emPdf/emPdfSelection.h>
+#ifndef emPdfSearch_h
+#include <emPdf/emPdfSearch.h>
 #endif
 
 
@@ -36,7 +36,8 @@ public:
 
 	emPdfControlPanel(
 		ParentArg parent, const emString & name,
-		emPdfFileModel * fileModel, emPdfSelection & selection
+		emPdfFileModel * fileModel, emPdfSelection & selection,
+		emPdfSearch & search
 	);
 
 	~emPdfControlPanel();
@@ -51,12 +52,14 @@ protected:
 private:
 
 	void UpdateControls();
+	void UpdateSearchControls();
 
 	emString CalculatePageSizes() const;
 	static emString PageSizeToString(int w, int h);
 
 	emRef<emPdfFileModel> FileModel;
 	emCrossPtr<emPdfSelection> Selection;
+	emCrossPtr<emPdfSearch> Search;
 
 	emTextField * Title;
 	emTextField * Author;
@@ -73,6 +76,11 @@ private:
 	emButton * Copy;
 	emButton * SelectAll;
 	emButton * ClearSelection;
+
+	emTextField * SearchText;
+	emTextField * SearchStatus;
+	emButton * FindNext;
+	emButton * FindPrev;
 };
 
 
@@ -29,6 +29,14 @@
 #include <emPdf/emPdfPageAreasMap.h>
 #endif
 
+#ifndef emPdfTextIndex_h
+#include <emPdf/emPdfTextIndex.h>
+#endif
+
+#ifndef emPdfTileCache_h
+#include <emPdf/emPdfTileCache.h>
+#endif
+
 
 class emPdfFileModel : public emFileModel {
 
@@ -48,6 +56,8 @@ public:
 	const emString & GetPageLabel(int page) const;
 	const emSignal & GetChangeSignal() const;
 	emPdfPageAreasMap & GetPageAreasMap() const;
+	emPdfTileCache & GetTileCache() const;
+	emPdfTextIndex & GetTextIndex() const;
 
 protected:
 
@@ -73,6 +83,8 @@ private:
 	int PageCount;
 	emSignal ChangeSignal;
 	emPdfPageAreasMap PageAreasMap;
+	emPdfTileCache TileCache;
+	emPdfTextIndex TextIndex;
 };
 
 inline emPdfServerModel * emPdfFileModel::GetServerModel() const
@@ -120,5 +132,15 @@ inline emPdfPageAreasMap & emPdfFileModel::GetPageAreasMap() const
 	return (emPdfPageAreasMap&)PageAreasMap;
 }
 
+inline emPdfTileCache & emPdfFileModel::GetTileCache() const
+{
+	return (emPdfTileCache&)TileCache;
+}
+
+inline emPdfTextIndex & emPdfFileModel::GetTextIndex() const
+{
+	return (emPdfTextIndex&)TextIndex;
+}
+
 
 #endif
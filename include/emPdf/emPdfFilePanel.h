@@ -29,6 +29,10 @@
 #include <emPdf/emPdfPagePanel.h>
 #endif
 
+#ifndef emPdfSearch_h
+#include <emPdf/emPdfSearch.h>
+#endif
+
 
 class emPdfFilePanel : public emFilePanel {
 
@@ -90,6 +94,7 @@ private:
 	double ShadowSize;
 	emImage ShadowImage;
 	emPdfSelection Selection;
+	emPdfSearch Search;
 	emArray<emPdfPagePanel*> PagePanels;
 };
 
@@ -57,8 +57,7 @@ private:
 
 	enum LayerType {
 		LT_PREVIEW=0,
-		LT_CONTENT=1,
-		LT_SELECTION=2
+		LT_SELECTION=1
 	};
 
 	struct Layer {
@@ -95,11 +94,19 @@ private:
 		RT_REF
 	};
 
+	struct ContentTile {
+		int Level;
+		emInt64 X,Y;
+	};
+
 	void ResetLayer(Layer & layer, bool clearImage);
 	bool UpdateLayer(Layer & layer);
 	void PaintLayer(
 		const emPainter & painter, const Layer & layer, emColor * canvasColor
 	) const;
+	void ResetContent();
+	bool UpdateContent();
+	void PaintContent(const emPainter & painter, emColor * canvasColor) const;
 	void UpdateIconState();
 	void UpdateCurrentRect();
 	void TriggerCurrectRect();
@@ -112,7 +119,22 @@ private:
 	int PageIndex;
 	emPdfSelection & Selection;
 	emPdfSelection::PageSelection PageSelection;
-	Layer Layers[3];
+	Layer Layers[2];
+	emArray<ContentTile> ContentTiles;
+		// Tiles requested from the tile cache of the file model: The
+		// visible tiles at ContentLevel, plus cached tiles of lower
+		// levels, which are shown while the visible ones are rendered.
+	int ContentTilesSetupCount;
+	int ContentLevel;
+	bool ContentVisible;
+		// Whether the content is shown in tiles, instead of only the
+		// preview.
+	bool ContentUpToDate;
+	bool ContentRendering;
+	int ContentMissing;
+		// Number of visible tiles which are not cached yet.
+	emUInt64 ContentRequestTime;
+	emString ContentErrorText;
 	emImage WaitIcon,RenderIcon;
 	IconStateType IconState;
 	double CurrentMX,CurrentMY;
@@ -123,6 +145,10 @@ private:
 	bool ForceTextCursor;
 	emCrossPtr<emDialog> OpenUrlDialog;
 	emString CurrentUrl;
+
+	enum { MAX_FALLBACK_LEVELS=8 };
+		// How many levels lower the tiles shown in place of missing
+		// tiles may be.
 };
 
 inline emPdfFileModel * emPdfPagePanel::GetFileModel() const
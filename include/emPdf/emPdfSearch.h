@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------
+// emPdfSearch.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emPdfSearch_h
+#define emPdfSearch_h
+
+#ifndef emPanel_h
+#include <emCore/emPanel.h>
+#endif
+
+#ifndef emPdfSelection_h
+#include <emPdf/emPdfSelection.h>
+#endif
+
+
+class emPdfSearch : public emEngine {
+
+public:
+
+	// Search for a text in the document of an emPdfFilePanel, using the
+	// emPdfTextIndex of the file model. The current hit is shown by
+	// selecting it (without publishing the selection), and by visiting
+	// its page.
+
+	emPdfSearch(emPanel & filePanel, emPdfSelection & selection,
+	            emPdfFileModel * fileModel);
+
+	virtual ~emPdfSearch();
+
+	void LinkCrossPtr(emCrossPtrPrivate & crossPtr);
+
+	void SetFileModel(emPdfFileModel * fileModel);
+
+	const emString & GetText() const;
+	void SetText(const emString & text);
+		// Set the text to search for. This starts indexing the
+		// document if not yet done, and the first hit is shown as soon
+		// as it is found. An empty text clears the search.
+
+	int GetHitCount() const;
+		// Number of hits in the pages indexed so far.
+
+	int GetCurrentHit() const;
+		// Index of the hit shown last, or -1.
+
+	void ShowNextHit();
+	void ShowPrevHit();
+		// Show the next or previous hit, cyclically.
+
+	bool IsIndexing() const;
+	double GetIndexProgress() const;
+		// Whether the document is still being indexed, and the progress
+		// in percent.
+
+	const emString & GetErrorText() const;
+		// Error from indexing, or empty.
+
+	const emSignal & GetChangeSignal() const;
+		// Signaled when the text, the hits, the current hit or the
+		// indexing progress have changed.
+
+protected:
+
+	virtual bool Cycle();
+
+private:
+
+	void UpdateHits();
+	void ShowHit(int index);
+
+	emPanel & FilePanel;
+	emPdfSelection & Selection;
+	emRef<emPdfFileModel> FileModel;
+	emCrossPtrList CrossPtrList;
+	emString Text;
+	emArray<emPdfTextIndex::Hit> Hits;
+	int CurrentHit;
+	bool FirstHitPending;
+	emSignal ChangeSignal;
+};
+
+
+inline void emPdfSearch::LinkCrossPtr(emCrossPtrPrivate & crossPtr)
+{
+	CrossPtrList.LinkCrossPtr(crossPtr);
+}
+
+inline const emString & emPdfSearch::GetText() const
+{
+	return Text;
+}
+
+inline int emPdfSearch::GetHitCount() const
+{
+	return Hits.GetCount();
+}
+
+inline int emPdfSearch::GetCurrentHit() const
+{
+	return CurrentHit;
+}
+
+inline const emSignal & emPdfSearch::GetChangeSignal() const
+{
+	return ChangeSignal;
+}
+
+
+#endif
@@ -33,8 +33,8 @@
 #include <emCore/emModel.h>
 #endif
 
-#ifndef emProcess_h
-#include <emCore/emProcess.h>
+#ifndef emServerProcPool_h
+#include <emCore/emServerProcPool.h>
 #endif
 
 
@@ -105,22 +105,28 @@ public:
 		emArray<RefRect> RefRects;
 	};
 
+	struct PageWord {
+		double X1,Y1,X2,Y2;
+		emString Text;
+	};
+
 	class OpenJob;
 
 	class PdfInstance : public emRefTarget, public emUncopyable {
 	public:
 		virtual ~PdfInstance();
-		emUInt64 GetProcRunId() const;
-		int GetInstanceId() const;
 		const DocumentInfo & GetDocumentInfo() const;
 		int GetPageCount() const;
 		const PageInfo & GetPageInfo(int page) const;
 	private:
+		friend class emPdfServerModel;
 		friend class OpenJob;
-		PdfInstance(emPdfServerModel & pdfServerModel);
+		PdfInstance(emPdfServerModel & pdfServerModel,
+		            const emString & filePath);
 		emCrossPtr<emPdfServerModel> PdfServerModel;
-		emUInt64 ProcRunId;
-		int InstanceId;
+		emString FilePath;
+		emServerProcPool::InstanceMap Instances;
+			// The server processes which have the document opened.
 		DocumentInfo Document;
 		emArray<PageInfo> Pages;
 	};
@@ -136,6 +142,11 @@ public:
 		           int classPriority, double priority);
 		void SetPdfInstance(PdfInstance * pdfInstance);
 		void SetClassPriority(int classPriority);
+		virtual bool TryReserve(emPdfServerModel & mdl);
+			// Called before the job is started on the server process
+			// given by ProcIndex. Returns false if the job cannot be
+			// started there yet, because of resources in use by
+			// running jobs.
 		virtual bool Send(emPdfServerModel & mdl, emString & err) = 0;
 		enum RcvRes {
 			RCV_WAIT,
@@ -144,6 +155,9 @@ public:
 			RCV_ERROR
 		};
 		virtual RcvRes TryReceive(emPdfServerModel & mdl, emString & err) = 0;
+		int ProcIndex;
+			// Index of the server process the job is started on, or
+			// -1.
 	private:
 		emRef<PdfInstance> PdfInst;
 		bool Costly;
@@ -193,6 +207,19 @@ public:
 		emString SelectedText;
 	};
 
+	class GetWordsJob : public PdfJobBase {
+	public:
+		GetWordsJob(PdfInstance & pdfInstance, int page, double priority=0.0);
+		virtual ~GetWordsJob();
+		const emArray<PageWord> & GetWords() const;
+	protected:
+		virtual bool Send(emPdfServerModel & mdl, emString & err);
+		virtual RcvRes TryReceive(emPdfServerModel & mdl, emString & err);
+	private:
+		int Page;
+		emArray<PageWord> Words;
+	};
+
 	class RenderJob : public PdfJobBase {
 	public:
 		RenderJob(
@@ -207,14 +234,16 @@ public:
 		double GetSrcHeight() const;
 		const emImage & GetImage() const;
 	protected:
+		virtual bool TryReserve(emPdfServerModel & mdl);
 		virtual bool Send(emPdfServerModel & mdl, emString & err);
 		virtual RcvRes TryReceive(emPdfServerModel & mdl, emString & err);
 		int Page;
 		double SrcX, SrcY, SrcWidth, SrcHeight;
 		int TgtW, TgtH;
 		emImage Image;
-		int ReadStage;
-		int ReadPos;
+		int ShmOffset;
+			// Where the server renders to in the shared memory
+			// segment, or -1.
 		bool IsRenderSelectionJob;
 	};
 
@@ -247,9 +276,17 @@ protected:
 
 private:
 
+	class ReopenJob : public PdfJobBase {
+	public:
+		ReopenJob(PdfInstance & pdfInstance);
+	protected:
+		virtual bool Send(emPdfServerModel & mdl, emString & err);
+		virtual RcvRes TryReceive(emPdfServerModel & mdl, emString & err);
+	};
+
 	class CloseJob : public PdfJobBase {
 	public:
-		CloseJob(emUInt64 procRunId, int instanceId);
+		CloseJob(int procIndex, emUInt64 procRunId, int instanceId);
 	protected:
 		virtual bool Send(emPdfServerModel & mdl, emString & err);
 		virtual RcvRes TryReceive(emPdfServerModel & mdl, emString & err);
@@ -268,32 +305,23 @@ private:
 	friend OpenJob;
 	friend GetAreasJob;
 	friend GetSelectedTextJob;
+	friend GetWordsJob;
 	friend RenderJob;
 	friend RenderSelectionJob;
+	friend ReopenJob;
 	friend CloseJob;
 
 	void TryStartJobs();
-	void TryFinishJobs();
+	int AssignProc(PdfJobBase & job, emString & err);
+	void StartReopenJob(PdfInstance & inst, int procIndex);
+	void TryFinishJobs(int procIndex);
+	void FailProc(int procIndex, const emString & err);
+	void UpdateProcLoads();
 
-	void WriteLineToProc(const char * str);
-	emString ReadLineFromProc();
-	bool TryProcIO();
-
-	static int TryParsePnmHeader(
-		const char * src, int len, int * pType, int * pWidth,
-		int * pHeight, int * pMaxColor
-	);
 	static emString Unquote(const char * str);
 
-	emProcess Process;
-	emUInt64 ProcRunId;
-	emUInt64 ProcPdfInstCount;
-	emUInt64 ProcIdleClock;
-	bool ProcTerminating;
-	emArray<char> ReadBuf;
-	emArray<char> WriteBuf;
-
 	PdfJobQueue JobQueue;
+	emServerProcPool Pool;
 };
 
 inline bool emPdfServerModel::TextRect::Contains(int x, int y) const
@@ -301,16 +329,6 @@ inline bool emPdfServerModel::TextRect::Contains(int x, int y) const
 	return x>=X1 && x<X2 && y>=Y1 && y<Y2;
 }
 
-inline emUInt64 emPdfServerModel::PdfInstance::GetProcRunId() const
-{
-	return ProcRunId;
-}
-
-inline int emPdfServerModel::PdfInstance::GetInstanceId() const
-{
-	return InstanceId;
-}
-
 inline const emPdfServerModel::DocumentInfo &
 	emPdfServerModel::PdfInstance::GetDocumentInfo() const
 {
@@ -351,6 +369,12 @@ inline const emString &
 	return SelectedText;
 }
 
+inline const emArray<emPdfServerModel::PageWord> &
+	emPdfServerModel::GetWordsJob::GetWords() const
+{
+	return Words;
+}
+
 inline double emPdfServerModel::RenderJob::GetSrcX() const
 {
 	return SrcX;
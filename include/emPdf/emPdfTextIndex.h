@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+// emPdfTextIndex.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emPdfTextIndex_h
+#define emPdfTextIndex_h
+
+#ifndef emAvlTreeMap_h
+#include <emCore/emAvlTreeMap.h>
+#endif
+
+#ifndef emPdfServerModel_h
+#include <emPdf/emPdfServerModel.h>
+#endif
+
+
+class emPdfTextIndex : public emEngine {
+
+public:
+
+	// Full-text index of a PDF document. After StartIndexing() has been
+	// called, the words of all pages are fetched from the server process
+	// in the background, with the lowest job priority, and they are added
+	// to an inverted index which maps each word to its occurrences. The
+	// index is case-insensitive, and a word is a sequence of letters and
+	// digits.
+
+	emPdfTextIndex(emScheduler & scheduler);
+	virtual ~emPdfTextIndex();
+
+	void Setup(emPdfServerModel & serverModel,
+	           emPdfServerModel::PdfInstance & pdfInstance);
+
+	void Reset();
+		// Forget the index and abort the jobs.
+
+	void StartIndexing();
+		// Start indexing the pages if not yet done.
+
+	bool IsIndexing() const;
+		// Whether indexing has been started and not all pages are
+		// indexed yet.
+
+	int GetPageCount() const;
+	int GetIndexedPageCount() const;
+		// Get the number of pages of the document, and how many of them
+		// have been indexed so far.
+
+	const emString & GetErrorText() const;
+		// Error of the first page which could not be indexed, or empty.
+		// Such pages are treated as having no words.
+
+	int GetWordCount(int page) const;
+	const emPdfServerModel::PageWord & GetWord(int page, int index) const;
+		// Get the words of an indexed page. The texts are in lower case.
+
+	struct Hit {
+		int Page;
+		int FirstWord;
+		int LastWord;
+	};
+
+	void Search(const char * text, emArray<Hit> & hits) const;
+		// Find the occurrences of the words of a text as a sequence of
+		// words in the indexed pages. The last word of the text may
+		// also match the beginning of a word, so that hits can be
+		// shown while typing. The hits are returned in the order of
+		// pages and words.
+
+	static emString FoldCase(const char * str);
+		// Convert a string to lower case.
+
+	static emArray<emString> SplitWords(const char * str);
+		// Split a string into words.
+
+	const emSignal & GetChangeSignal() const;
+		// Signaled when pages have been indexed.
+
+protected:
+
+	virtual bool Cycle();
+
+private:
+
+	struct Occurrence {
+		int Page;
+		int Word;
+	};
+
+	struct PageEntry {
+		PageEntry();
+		PageEntry(const PageEntry & pageEntry);
+		~PageEntry();
+		PageEntry & operator = (const PageEntry & pageEntry);
+		emRef<emPdfServerModel::GetWordsJob> Job;
+		emArray<emPdfServerModel::PageWord> Words;
+	};
+
+	void StartJobs();
+	void AddPage(int page, const emArray<emPdfServerModel::PageWord> & words);
+
+	bool MatchAt(int page, int word, const emArray<emString> & terms) const;
+
+	static int CompareHits(const Hit * hit1, const Hit * hit2,
+	                       void * context);
+
+	emPdfServerModel * ServerModel;
+	emPdfServerModel::PdfInstance * PdfInstance;
+	emArray<PageEntry> Pages;
+	emAvlTreeMap<emString,emArray<Occurrence> > Index;
+	bool Started;
+	int NextPage;
+	int RunningJobs;
+	int IndexedPageCount;
+	emString ErrorText;
+	emSignal ChangeSignal;
+
+	enum { MAX_RUNNING_JOBS = 4 };
+		// Jobs are enqueued only up to this number at a time, so that
+		// the job queue does not get flooded by huge documents.
+};
+
+inline bool emPdfTextIndex::IsIndexing() const
+{
+	return Started && IndexedPageCount<Pages.GetCount();
+}
+
+inline int emPdfTextIndex::GetPageCount() const
+{
+	return Pages.GetCount();
+}
+
+inline int emPdfTextIndex::GetIndexedPageCount() const
+{
+	return IndexedPageCount;
+}
+
+inline const emString & emPdfTextIndex::GetErrorText() const
+{
+	return ErrorText;
+}
+
+inline int emPdfTextIndex::GetWordCount(int page) const
+{
+	return Pages[page].Words.GetCount();
+}
+
+inline const emPdfServerModel::PageWord & emPdfTextIndex::GetWord(
+	int page, int index
+) const
+{
+	return Pages[page].Words[index];
+}
+
+inline const emSignal & emPdfTextIndex::GetChangeSignal() const
+{
+	return ChangeSignal;
+}
+
+
+#endif
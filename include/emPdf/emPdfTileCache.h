@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+// emPdfTileCache.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emPdfTileCache_h
+#define emPdfTileCache_h
+
+#ifndef emTileCache_h
+#include <emCore/emTileCache.h>
+#endif
+
+#ifndef emPdfServerModel_h
+#include <emPdf/emPdfServerModel.h>
+#endif
+
+
+class emPdfTileCache : public emTileCache {
+
+public:
+
+	// Cache of the rendered contents of the pages of a PDF document (see
+	// emTileCache). A page unit is a unit of the page sizes in
+	// emPdfServerModel::PageInfo.
+
+	emPdfTileCache(emScheduler & scheduler);
+	virtual ~emPdfTileCache();
+
+	void Setup(emPdfServerModel & serverModel,
+	           emPdfServerModel::PdfInstance & pdfInstance);
+
+	virtual void Reset();
+
+protected:
+
+	virtual bool GetPageSize(int page, double * pWidth,
+	                         double * pHeight) const;
+
+	virtual emRef<emJob> StartTileJob(
+		int page, double srcX, double srcY, double srcWidth,
+		double srcHeight, int tgtWidth, int tgtHeight, double priority
+	);
+
+	virtual void AbortTileJob(emJob & job);
+
+	virtual const emImage & GetTileJobImage(const emJob & job) const;
+
+private:
+
+	emPdfServerModel * ServerModel;
+	emPdfServerModel::PdfInstance * PdfInstance;
+};
+
+
+#endif
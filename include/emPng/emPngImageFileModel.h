@@ -54,9 +54,12 @@ private:
 		int width,height,channelCount,passCount;
 		bool imagePrepared;
 		int y,pass;
+		int reduction;
+		emByte * row;
 	};
 
 	LoadingState * L;
+	RowReducer Reducer;
 };
 
 
@@ -58,12 +58,14 @@ private:
 	int ReadVal();
 
 	struct LoadingState {
-		int Format,Width,Height,MaxVal,NextY;
+		int Format,Width,Height,MaxVal,NextY,Reduction;
 		bool ImagePrepared;
 		FILE * File;
+		unsigned char * Row;
 	};
 
 	LoadingState * L;
+	RowReducer Reducer;
 };
 
 
@@ -21,18 +21,14 @@
 #ifndef emPsRenderer_h
 #define emPsRenderer_h
 
-#ifndef emTimer_h
-#include <emCore/emTimer.h>
+#ifndef emCoreConfig_h
+#include <emCore/emCoreConfig.h>
 #endif
 
 #ifndef emProcess_h
 #include <emCore/emProcess.h>
 #endif
 
-#ifndef emPriSchedAgent_h
-#include <emCore/emPriSchedAgent.h>
-#endif
-
 #ifndef emImage_h
 #include <emCore/emImage.h>
 #endif
@@ -50,6 +46,13 @@ class emPsRenderer : public emModel {
 
 public:
 
+	// Renders pages of PostScript documents with a pool of Ghostscript
+	// processes. Each process (interpreter) runs the startup script of one
+	// document and can then render any page of that document. The number
+	// of processes is limited by the number of hardware threads and by
+	// the MaxRenderThreads setting, so that the pages of several documents,
+	// or several pages of one document, are rendered concurrently.
+
 	static emRef<emPsRenderer> Acquire(emRootContext & rootContext);
 
 	class RenderJob : public emJob {
@@ -79,86 +82,120 @@ protected:
 
 private:
 
-	enum MainStateType {
-		COLD_WAIT_JOB,
-		COLD_WAIT_ACCESS,
-		PREPARE_PROCESS,
-		RUN_JOB,
-		HOT_WAIT_JOB,
-		HOT_WAIT_ACCESS,
-		QUIT_PROCESS
-	};
+	class Interpreter : public emUncopyable {
+	public:
 
-	RenderJob * SearchBestJob();
-	RenderJob * SearchBestSameDocJob();
+		Interpreter(emPsRenderer & renderer);
+		~Interpreter();
 
-	void FailDocJobs(emString errorMessage);
-	void FailAllJobs(emString errorMessage);
+		enum StateType {
+			IS_OFF,
+			IS_STARTING,
+			IS_RUNNING,
+			IS_READY,
+			IS_QUITTING
+		};
 
-	void UpdatePSPriority();
+		StateType GetState() const;
+		const emPsDocument & GetDocument() const;
+		RenderJob * GetJob() const;
 
-	void TryStartProcess();
+		void Start(const emPsDocument & document);
+			// Start the process and send the startup script of the
+			// document. Throws an emException on error.
 
-	void PrepareWritingStartup();
-	void PrepareWritingPage();
-	bool TryWrite();
-	bool IsWritingFinished() const;
+		void Run(RenderJob & job);
+			// Render a page. The state must be IS_READY.
 
-	void PrepareReadingStartup();
-	void PrepareReadingPage();
-	bool TryRead();
-	int ParseImageHeader(const char * buf, int len);
-	static int ParseImageDecimal(const char * buf, int len, int * pNumber);
-	int ParseImageData(const char * buf, int len);
-	bool IsReadingFinished() const;
+		void Quit();
+			// Terminate the process.
+
+		void ForgetJob();
+			// Forget the current job without cancelling the rendering.
+
+		bool TryProceed();
+			// Do I/O and state transitions without blocking. Returns
+			// true if something has been done.
+
+		void AddWaitPipes(emArray<emProcess*> & processes,
+		                  emArray<int> & waitFlags);
+			// Add the process and the flags for waiting until
+			// TryProceed() could do I/O (see emProcess::WaitPipes).
 
-	class PSAgentClass : public emPriSchedAgent {
-	public:
-		PSAgentClass(emPsRenderer & interpreter);
-	protected:
-		virtual void GotAccess();
 	private:
+
+		void Fail(const emString & errorMessage);
+
+		void TryStartProcess();
+
+		void PrepareWritingStartup();
+		void PrepareWritingPage();
+		bool TryWrite();
+		bool IsWritingFinished() const;
+
+		void PrepareReadingStartup();
+		void PrepareReadingPage();
+		bool TryRead();
+		int ParseImageHeader(const char * buf, int len);
+		static int ParseImageDecimal(const char * buf, int len, int * pNumber);
+		int ParseImageData(const char * buf, int len);
+		bool IsReadingFinished() const;
+
 		emPsRenderer & Renderer;
+
+		emProcess Process;
+		StateType State;
+		emUInt64 Deadline;
+
+		RenderJob * CurrentJob;
+		emPsDocument CurrentDocument;
+		int CurrentPageIndex;
+
+		enum WriterStateType {
+			WRITING_STARTUP,
+			WRITING_PAGE_SIZE,
+			WRITING_PAGE,
+			WRITING_SYNC,
+			WRITING_FINISHED
+		};
+		WriterStateType WriterState;
+		emString WriteCommand;
+		int WriterPos;
+
+		enum ReaderStateType {
+			READING_IMAGE_HEADER,
+			READING_IMAGE_DATA,
+			READING_SYNC,
+			READING_FINISHED
+		};
+		ReaderStateType ReaderState;
+		char ReadBuffer[131072];
+		int ReadBufferFill;
+		int RdSyncSearchPos;
+		int RdImgFormat,RdImgW,RdImgH,RdImgMaxVal,RdImgX,RdImgY;
+		bool RdImgDone;
 	};
-	friend class PSAgentClass;
+	friend class Interpreter;
 
-	emProcess Process;
-	emTimer Timer;
+	bool StartJobs();
+		// Assign waiting jobs to interpreters, in the order of priority.
+		// Returns true if something has been done.
 
-	PSAgentClass PSAgent;
-	bool PSPriorityValid;
+	bool IsDocumentInUse(const emPsDocument & document) const;
+		// Whether the document is referred by anything other than the
+		// interpreters.
 
-	emJobQueue JobQueue;
+	void FailDocJobs(RenderJob * currentJob, const emPsDocument & document,
+	                 const emString & errorMessage);
+	void FailWaitingJobs(const emString & errorMessage);
 
-	MainStateType MainState;
+	static RenderJob * CastJob(emJob * job);
 
-	RenderJob * CurrentJob;
-	emPsDocument CurrentDocument;
-	int CurrentPageIndex;
+	int GetMaxInterpreters() const;
 
-	enum WriterStateType {
-		WRITING_STARTUP,
-		WRITING_PAGE_SIZE,
-		WRITING_PAGE,
-		WRITING_SYNC,
-		WRITING_FINISHED
-	};
-	WriterStateType WriterState;
-	emString WriteCommand;
-	int WriterPos;
-
-	enum ReaderStateType {
-		READING_IMAGE_HEADER,
-		READING_IMAGE_DATA,
-		READING_SYNC,
-		READING_FINISHED
-	};
-	ReaderStateType ReaderState;
-	char ReadBuffer[131072];
-	int ReadBufferFill;
-	int RdSyncSearchPos;
-	int RdImgFormat,RdImgW,RdImgH,RdImgMaxVal,RdImgX,RdImgY;
-	bool RdImgDone;
+	emRef<emCoreConfig> CoreConfig;
+	emJobQueue JobQueue;
+	emArray<Interpreter*> Interpreters;
 
 	static const char * const SyncString;
 };
@@ -179,12 +216,33 @@ inline const emImage & emPsRenderer::RenderJob::GetImage() const
 	return Image;
 }
 
-inline bool emPsRenderer::IsWritingFinished() const
+inline emPsRenderer::Interpreter::StateType
+	emPsRenderer::Interpreter::GetState() const
+{
+	return State;
+}
+
+inline const emPsDocument & emPsRenderer::Interpreter::GetDocument() const
+{
+	return CurrentDocument;
+}
+
+inline emPsRenderer::RenderJob * emPsRenderer::Interpreter::GetJob() const
+{
+	return CurrentJob;
+}
+
+inline void emPsRenderer::Interpreter::ForgetJob()
+{
+	CurrentJob=NULL;
+}
+
+inline bool emPsRenderer::Interpreter::IsWritingFinished() const
 {
 	return WriterState==WRITING_FINISHED;
 }
 
-inline bool emPsRenderer::IsReadingFinished() const
+inline bool emPsRenderer::Interpreter::IsReadingFinished() const
 {
 	return ReaderState==READING_FINISHED;
 }
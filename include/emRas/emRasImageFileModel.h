@@ -57,13 +57,15 @@ private:
 
 	struct LoadingState {
 		int Width,Height,Depth,PixMapType,ColMapType,ColMapSize;
-		int NextY,RowSize,BufFill;
+		int NextY,RowSize,BufFill,Reduction;
 		FILE * File;
 		unsigned char * ColMap;
 		unsigned char * PixBuf;
+		unsigned char * Row;
 	};
 
 	LoadingState * L;
+	RowReducer Reducer;
 };
 
 
@@ -72,6 +72,7 @@ public:
 	emStringRec ApiScript;
 	emStringRec ApiScriptInterpreter;
 	emStringRec ApiKey;
+	emIntRec ConcurrentFetches;
 	emStringRec WebBrowser;
 	emBoolRec AutoUpdateDates;
 	emBoolRec TriggeringOpensWebPage;
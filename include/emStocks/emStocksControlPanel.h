@@ -142,6 +142,7 @@ private:
 	FileFieldPanel * ApiScript;
 	FileFieldPanel * ApiScriptInterpreter;
 	emTextField * ApiKey;
+	emScalarField * ConcurrentFetches;
 	FileFieldPanel * WebBrowser;
 	emCheckBox * AutoUpdateDates;
 	emCheckBox * TriggeringOpensWebPage;
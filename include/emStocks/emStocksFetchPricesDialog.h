@@ -38,7 +38,7 @@ public:
 		emContext & parentContext, emStocksFileModel & fileModel,
 		const emString & apiScript,
 		const emString & apiScriptInterpreter,
-		const emString & apiKey
+		const emString & apiKey, int maxProcesses=1
 	);
 
 	virtual ~emStocksFetchPricesDialog();
@@ -69,6 +69,7 @@ private:
 	int CalculateDaysPerPrice();
 	void UpdatePrices1();
 	void UpdatePrices2();
+	void UpdatePyramid();
 	void UpdateTransformation();
 
 	void PaintXScaleLines(const emPainter & painter) const;
@@ -84,6 +85,9 @@ private:
 	void PaintDesiredPrice(const emPainter & painter) const;
 	void PaintGraph(const emPainter & painter) const;
 
+	double GetBucketX1(int index) const;
+	double GetBucketX2(int index) const;
+
 	struct Price {
 		void Set(const char * str);
 		operator bool () const;
@@ -91,6 +95,20 @@ private:
 		double Value;
 	};
 
+	struct Bucket {
+		double Avg;
+		double Min;
+		double Max;
+		int Count;
+			// Number of known prices, zero if the others are invalid.
+	};
+
+	static void MergeBucket(Bucket * target, const Bucket & source);
+	void CombineBuckets(int begin, int end, Bucket * pResult) const;
+		// Summarize the days begin to end-1 of the prices record.
+	const Bucket & GetBucket(int index) const;
+		// Get a bucket of the range to be painted.
+
 	emStocksListBox & ListBox;
 	emStocksConfig & Config;
 
@@ -113,7 +131,22 @@ private:
 	emString PriceOnSelectedDateText;
 	Price DesiredPrice;
 	emString DesiredPriceText;
-	emArray<Price> Prices;
+	emArray<emArray<Bucket> > Pyramid;
+		// Prices of the stock record at multiple resolutions. Bucket i
+		// of level k summarizes the days i*2^k to (i+1)*2^k-1 of the
+		// prices record. The levels are built when the record has
+		// changed, so that changing the time range or the zoom just
+		// means to select another range of buckets.
+	bool PyramidUpToDate;
+	int PricesLevel;
+		// Level of the buckets to be painted, or -1.
+	int PricesBegin,PricesEnd;
+		// Range of the buckets to be painted.
+	Bucket EdgeBuckets[2];
+		// The first and the last bucket to be painted, clamped to the
+		// days within the time range.
+	int PricesStartDay,PricesEndDay;
+		// StartDate and EndDate as day indices of the prices record.
 	Price MinPrice;
 	Price MaxPrice;
 
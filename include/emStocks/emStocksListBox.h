@@ -75,6 +75,48 @@ private:
 
 	void UpdateItems();
 
+	struct SortKey {
+		const emStocksRec::StockRec * Stock;
+		int ItemIndex;
+			// Index of the item of the stock, as of the last call to
+			// OrderItems(), or -1. It is just a hint.
+		bool Visible;
+		bool Owning;
+		bool Valid;
+		double Value;
+		emString Name;
+		emString NameKey;
+			// Collation key of Name (strxfrm), so that names can be
+			// compared with strcmp instead of strcoll. It is kept as
+			// long as the name is not modified.
+	};
+
+	void OrderItems();
+		// Bring the items into the order of their sort keys. Usually
+		// only a few items are out of place after an update, and only
+		// those are moved.
+
+	int GetItemIndexOfKey(const SortKey & key) const;
+
+	void UpdateSortKeys();
+		// Calculate the visibility and the sort key of every stock, if
+		// not yet done since the last change of the file model, the
+		// config or the selected date.
+
+	SortKey * GetSortKey(const emStocksRec::StockRec * stockRec);
+
+	static int CompareSortKeysByStock(
+		const int * index1, const int * index2, void * context
+	);
+
+	static int CompareSortKeyToStock(
+		const int * index, void * stockRec, void * context
+	);
+
+	static int CompareSortKeys(
+		SortKey * const * key1, SortKey * const * key2, void * context
+	);
+
 	static int CompareItems(
 		const emString & item1name, const emString & item1text,
 		const emAnything & item1data,
@@ -89,6 +131,20 @@ private:
 	emSignal SelectedDateSignal;
 	emString SelectedDate;
 
+	emArray<SortKey> SortKeys;
+		// One element per stock, in the order of the stocks.
+	emArray<int> SortKeysByStock;
+		// Indices into SortKeys, sorted by the address of the stock
+		// record.
+	bool SortKeysValid;
+	int VisibleCount;
+
+	enum {
+		MAX_ITEM_MOVES = 64
+			// OrderItems() sorts all items if more would have to be
+			// moved.
+	};
+
 	emCrossPtr<emDialog> CutStocksDialog;
 
 	emCrossPtr<emDialog> PasteStocksDialog;
@@ -42,10 +42,23 @@ class emStocksPricesFetcher : public emEngine
 {
 public:
 
+	// Fetches the prices of stocks by running the API script for each
+	// stock. Multiple processes of the script are run concurrently. A
+	// process which takes too long or fails is tried again, unless it
+	// exits with NO_RETRY_EXIT_STATUS (e.g. on an invalid API key or on
+	// an HTTP 4xx response). The output of finished processes is
+	// collected and added to the file model in batches.
+
+	enum {
+		NO_RETRY_EXIT_STATUS = 200
+			// Exit status by which the API script reports a failure
+			// that would not go away by trying again.
+	};
+
 	emStocksPricesFetcher(
 		emStocksFileModel & fileModel, const emString & apiScript,
 		const emString & apiScriptInterpreter,
-		const emString & apiKey
+		const emString & apiKey, int maxProcesses=1
 	);
 
 	virtual ~emStocksPricesFetcher();
@@ -56,6 +69,7 @@ public:
 
 	const emString * GetCurrentStockId() const;
 	emStocksRec::StockRec * GetCurrentStockRec() const;
+		// The first stock whose prices are being fetched.
 
 	double GetProgressInPercent() const;
 
@@ -71,16 +85,50 @@ protected:
 
 private:
 
-	void StartProcess();
-	void PollProcess();
+	struct Job {
+		int Index;
+			// Index in StockIds.
+		emString Symbol;
+		emString StartDate;
+		emProcess Process;
+		bool Running;
+		emUInt64 Clock;
+			// Start time of the process if running, otherwise the
+			// time for starting the next try.
+		int Tries;
+		emArray<char> OutBuffer;
+		emArray<char> ErrBuffer;
+	};
+
+	void StartJobs();
+	void StartProcess(Job * job);
+	bool PollJob(Job * job);
+		// Returns true if the job has finished successfully.
+	void RetryJob(Job * job, const emString & error);
+	void FailJob(Job * job, const emString & error);
+	void CommitJobs();
 	void SetFailed(const emString & error);
 	void Clear();
 	emStocksRec::StockRec * GetStockRec(const emString & stockId) const;
 	void UpdateStockRecsMapValues();
-	void CalculateDate();
-	void ProcessOutBufferLines();
-	void ProcessOutBufferLine(const char * str);
-	void AddPrice(const char * date, const char * price);
+	emString CalculateStartDate(const emStocksRec::StockRec * stockRec) const;
+	int ProcessOutBufferLines(Job * job, emStocksRec::StockRec * stockRec);
+	int ProcessOutBufferLine(Job * job, emStocksRec::StockRec * stockRec,
+	                         const char * str);
+
+	enum {
+		PROCESS_TIMEOUT = 120000,
+			// Milliseconds after which a process is terminated.
+		MAX_TRIES = 3,
+			// Number of tries per stock.
+		RETRY_DELAY = 3000,
+			// Milliseconds between the tries.
+		COMMIT_INTERVAL = 2000,
+			// Milliseconds between adding batches of prices to the
+			// file model while more processes are running.
+		MAX_OUT_SIZE = 16*1024*1024,
+		MAX_ERR_SIZE = 100000
+	};
 
 	emRef<emStocksFileModel> FileModel;
 	emAbsoluteFileModelClient FileModelClient;
@@ -88,16 +136,19 @@ private:
 	emString ApiScript;
 	emString ApiScriptInterpreter;
 	emString ApiKey;
+	int MaxProcesses;
 	emArray<emString> StockIds;
 	emAvlTreeMap<emString,emCrossPtr<emStocksRec::StockRec> > StockRecsMap;
-	int CurrentIndex;
-	emString CurrentSymbol;
-	emString CurrentStartDate;
-	emProcess CurrentProcess;
-	bool CurrentProcessActive;
-	bool CurrentStockUpdated;
-	emArray<char> OutBuffer;
-	emArray<char> ErrBuffer;
+	int NextIndex;
+		// Index in StockIds of the next stock to be started.
+	int DoneCount;
+		// Number of stocks which are done.
+	emArray<Job*> Jobs;
+		// Jobs which are running or waiting for a retry, sorted by
+		// index.
+	emArray<Job*> FinishedJobs;
+		// Jobs whose prices have not yet been added to the file model.
+	emUInt64 LastCommitClock;
 	emString NoDataStocks;
 	emString Error;
 	emSignal ChangeSignal;
@@ -21,6 +21,10 @@
 #ifndef emStocksRec_h
 #define emStocksRec_h
 
+#ifndef emAvlTreeMap_h
+#include <emCore/emAvlTreeMap.h>
+#endif
+
 #ifndef emCrossPtr_h
 #include <emCore/emCrossPtr.h>
 #endif
@@ -57,6 +61,97 @@ public:
 		bool BugInDeprecatedIdentifiers;
 	};
 
+	class PricesRec : public emRec {
+	public:
+		// Record class for the price history of a stock, one price per
+		// day, latest price last. The prices are held column-wise as
+		// values and numbers of decimal places, so that they can be
+		// accessed by index, and added or removed at both ends in
+		// amortized constant time. In the file, the prices are
+		// written as a string with the prices separated by '|' and
+		// unknown prices empty, like it has always been. A price whose
+		// text would not be reproduced exactly from value and decimal
+		// places (e.g. "1e3" or "007") is kept as it is, so that it
+		// survives loading and saving.
+
+		PricesRec(emStructRec * parent, const char * varIdentifier);
+		virtual ~PricesRec();
+
+		int GetCount() const;
+			// Number of days.
+
+		bool IsKnown(int index) const;
+			// Whether the price of a day is known (not empty).
+
+		double GetValue(int index) const;
+			// Value of a known price. For a price which is not a
+			// plain decimal number, this is what atof(..) makes of
+			// it.
+
+		emString GetText(int index) const;
+			// Price as the original string, or an empty string if
+			// unknown.
+
+		bool StartsWithDigit(int index) const;
+			// Whether the price is known and its text starts with a
+			// digit. This is what makes a price valid for
+			// calculations (see StockRec::IsValidPrice).
+
+		void Set(int index, const char * price);
+			// Set the price of a day. An empty string makes it
+			// unknown.
+
+		void Insert(int index, int count);
+			// Insert unknown prices at the beginning or at the end.
+
+		void Remove(int index, int count);
+			// Remove prices from the beginning or from the end.
+
+		void Clear();
+			// Remove all prices.
+
+		virtual void SetToDefault();
+		virtual bool IsSetToDefault() const;
+		virtual void TryStartReading(emRecReader & reader);
+		virtual bool TryContinueReading(emRecReader & reader);
+		virtual void QuitReading();
+		virtual void TryStartWriting(emRecWriter & writer);
+		virtual bool TryContinueWriting(emRecWriter & writer);
+		virtual void QuitWriting();
+		virtual emUInt64 CalcRecMemNeed() const;
+
+	private:
+		static const char * ParsePrice(const char * str, double * pValue,
+		                               int * pDecimals);
+			// Parse a price which is terminated by '|' or by the end
+			// of the string, and return a pointer to the terminator.
+			// *pDecimals is set to UNKNOWN if the price is empty, or
+			// to VERBATIM if it must be kept as text.
+
+		void RemoveVerbatim(int begin, int end);
+		void ShiftVerbatim(int delta);
+			// Remove the verbatim texts of an array index range, or
+			// add a delta to the array indices of all of them.
+
+		enum {
+			MAX_PRICE_LEN = 32,
+			UNKNOWN = -1,
+			VERBATIM = -2
+		};
+
+		emArray<double> Values;
+		emArray<emInt8> Decimals;
+			// Number of decimal places, UNKNOWN, or VERBATIM for a
+			// price whose text is in VerbatimTexts.
+		emAvlTreeMap<int,emString> VerbatimTexts;
+			// Texts of the VERBATIM prices by array index. This is
+			// empty with prices fetched by emStocks.
+		int First;
+			// Index of the first day in the arrays. Removed days
+			// at the beginning are not moved out until they are
+			// the majority.
+	};
+
 	class StockRec : public emStructRec {
 	public:
 		StockRec();
@@ -82,10 +177,9 @@ public:
 			// If OwningShares then purchase price and date else sale price and date.
 
 		enum { MAX_NUM_PRICES = 366*20 };
-		emStringRec Prices;
-			// Prices separated by '|', one price per day, unknown
-			// prices empty, latest price last.
+		PricesRec Prices;
 		emStringRec LastPriceDate;
+			// Date of the latest price in Prices.
 
 		emStringRec DesiredPrice;
 			// If OwningShares then desired sale price else desired purchase price.
@@ -99,7 +193,8 @@ public:
 
 		emTArrayRec<emStringRec> WebPages;
 
-		const char * GetPricePtrOfDate(const char * date) const;
+		int GetPriceIndexOfDate(const char * date) const;
+			// Index in Prices, or -1 if out of range.
 		emString GetPriceOfDate(const char * date) const;
 		emString GetPricesDateBefore(const char * date) const;
 		emString GetPricesDateAfter(const char * date) const;
@@ -114,6 +209,10 @@ public:
 		bool GetRiseUntilDate(double * pResult, const char * date, int days) const;
 
 	private:
+		bool IsValidPrice(int index) const;
+			// Whether index is valid and the price starts with a
+			// digit (so "abc", ".5" and "-1" are not valid).
+
 		emCrossPtrList CrossPtrList;
 	};
 
@@ -145,6 +244,21 @@ public:
 };
 
 
+inline int emStocksRec::PricesRec::GetCount() const
+{
+	return Values.GetCount()-First;
+}
+
+inline bool emStocksRec::PricesRec::IsKnown(int index) const
+{
+	return Decimals[First+index]!=UNKNOWN;
+}
+
+inline double emStocksRec::PricesRec::GetValue(int index) const
+{
+	return Values[First+index];
+}
+
 inline void emStocksRec::StockRec::LinkCrossPtr(
 	emCrossPtrPrivate & crossPtr
 )
@@ -152,5 +266,10 @@ inline void emStocksRec::StockRec::LinkCrossPtr(
 	CrossPtrList.LinkCrossPtr(crossPtr);
 }
 
+inline bool emStocksRec::StockRec::IsValidPrice(int index) const
+{
+	return index>=0 && Prices.StartsWithDigit(index);
+}
+
 
 #endif
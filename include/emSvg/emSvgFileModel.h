@@ -29,6 +29,10 @@
 #include <emSvg/emSvgServerModel.h>
 #endif
 
+#ifndef emSvgTileCache_h
+#include <emSvg/emSvgTileCache.h>
+#endif
+
 
 class emSvgFileModel : public emFileModel {
 
@@ -45,6 +49,7 @@ public:
 
 	emSvgServerModel * GetServerModel() const;
 	emSvgServerModel::SvgInstance & GetSvgInstance() const;
+	emSvgTileCache & GetTileCache() const;
 
 protected:
 
@@ -70,6 +75,7 @@ private:
 	double Height;
 	emString Title;
 	emString Description;
+	emSvgTileCache TileCache;
 };
 
 inline double emSvgFileModel::GetWidth() const
@@ -97,5 +103,10 @@ inline emSvgServerModel * emSvgFileModel::GetServerModel() const
 	return ServerModel;
 }
 
+inline emSvgTileCache & emSvgFileModel::GetTileCache() const
+{
+	return (emSvgTileCache&)TileCache;
+}
+
 
 #endif
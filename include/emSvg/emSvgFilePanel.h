@@ -70,24 +70,35 @@ private:
 	void GetOutputRect(double * pX, double * pY, double * pW,
 	                   double * pH) const;
 
-	void ClearSvgDisplay();
-	void UpdateSvgDisplay(bool viewingChanged);
-
-	emRef<emSvgServerModel> ServerModel;
-
-	emRef<emSvgServerModel::RenderJob> RenderJob;
+	struct ContentTile {
+		int Level;
+		emInt64 X,Y;
+	};
+
+	void ResetContent();
+	void UpdateContent();
+	void PaintContent(const emPainter & painter, double ox, double oy,
+	                  double ow, double oh, emColor canvasColor) const;
+
+	emArray<ContentTile> ContentTiles;
+		// Tiles requested from the tile cache of the file model: The
+		// visible tiles at ContentLevel, plus cached tiles of lower
+		// levels, which are shown while the visible ones are rendered.
+	int ContentTilesSetupCount;
+	int ContentLevel;
+	bool ContentVisible;
+	bool ContentUpToDate;
+	int ContentMissing;
+		// Number of visible tiles which are not cached yet.
 	emString RenderError;
 
-	emImage Img;
-	double SrcX,SrcY,SrcW,SrcH;
-
-	bool JobUpToDate;
-	emUInt64 JobDelayStartTime;
-	emTimer JobDelayTimer;
-
 	emImage RenderIcon;
 	emTimer IconTimer;
 	bool ShowIcon;
+
+	enum { MAX_FALLBACK_LEVELS=8 };
+		// How many levels lower the tiles shown in place of missing
+		// tiles may be.
 };
 
 
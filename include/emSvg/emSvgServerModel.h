@@ -33,8 +33,8 @@
 #include <emCore/emModel.h>
 #endif
 
-#ifndef emProcess_h
-#include <emCore/emProcess.h>
+#ifndef emServerProcPool_h
+#include <emCore/emServerProcPool.h>
 #endif
 
 
@@ -42,6 +42,10 @@ class emSvgServerModel : public emModel {
 
 public:
 
+	// Renders SVG files with a pool of emSvgServerProc processes (see
+	// emServerProcPool), so that the render jobs of a document (e.g. the
+	// tiles of emSvgTileCache) are spread over the processes.
+
 	static emRef<emSvgServerModel> Acquire(emRootContext & rootContext);
 
 	class SvgInstance : public emRefTarget, public emUncopyable {
@@ -53,17 +57,32 @@ public:
 		const emString & GetDescription() const;
 	private:
 		friend class emSvgServerModel;
-		SvgInstance(emSvgServerModel & svgServerModel);
+		SvgInstance(emSvgServerModel & svgServerModel,
+		            const emString & filePath);
 		emCrossPtr<emSvgServerModel> SvgServerModel;
-		emUInt64 ProcRunId;
-		int InstanceId;
+		emString FilePath;
+		emServerProcPool::InstanceMap Instances;
+			// The server processes which have the document opened.
 		double Width;
 		double Height;
 		emString Title;
 		emString Description;
 	};
 
-	class OpenJob : public emJob {
+private:
+
+	class SvgJobBase : public emJob {
+	public:
+		SvgJobBase(double priority);
+	private:
+		friend class emSvgServerModel;
+		int ProcIndex;
+			// The server process on which the job is running, or -1.
+	};
+
+public:
+
+	class OpenJob : public SvgJobBase {
 	public:
 		OpenJob(const emString & filePath, double priority=0.0);
 		const emRef<SvgInstance>& GetSvgInstance() const;
@@ -73,7 +92,7 @@ public:
 		emRef<SvgInstance> SvgInst;
 	};
 
-	class RenderJob : public emJob {
+	class RenderJob : public SvgJobBase {
 	public:
 		RenderJob(
 			SvgInstance & svgInstance, double srcX, double srcY,
@@ -111,9 +130,17 @@ private:
 
 	friend class SvgInstance;
 
-	class CloseJob : public emJob {
+	class ReopenJob : public SvgJobBase {
 	public:
-		CloseJob(emUInt64 procRunId, int instanceId);
+		ReopenJob(SvgInstance & svgInstance);
+	private:
+		friend class emSvgServerModel;
+		emRef<SvgInstance> SvgInst;
+	};
+
+	class CloseJob : public SvgJobBase {
+	public:
+		CloseJob(int procIndex, emUInt64 procRunId, int instanceId);
 	private:
 		friend class emSvgServerModel;
 		emUInt64 ProcRunId;
@@ -121,47 +148,27 @@ private:
 	};
 
 	void TryStartJobs();
-	void TryStartOpenJob(OpenJob & openJob);
-	bool TryStartRenderJob(RenderJob & renderJob);
-	void TryStartCloseJob(CloseJob & closeJob);
+	int AssignProc(SvgJobBase & job, emString & err);
+	void StartOpenJob(OpenJob & openJob, int procIndex);
+	void StartReopenJob(SvgInstance & inst, int procIndex);
+	bool TryStartRenderJob(RenderJob & renderJob, int procIndex);
+	void StartCloseJob(CloseJob & closeJob);
 
-	void TryFinishJobs();
+	void TryFinishJobs(int procIndex);
 	void TryFinishOpenJob(OpenJob & openJob, const char * args);
+	void TryFinishReopenJob(ReopenJob & reopenJob, const char * args);
 	void TryFinishRenderJob(RenderJob & renderJob);
+	static void ParseOpenedArgs(const char * args, int * pInstanceId,
+	                            double * pWidth, double * pHeight,
+	                            emString * pTitle, emString * pDesc);
 
-	void TryWriteAttachShm();
-
-	void WriteLineToProc(const char * str);
-	emString ReadLineFromProc();
-	bool TryProcIO();
-
-	void TryAllocShm(int size);
-	void FreeShm();
-
-	emProcess Process;
-	emUInt64 ProcRunId;
-	emUInt64 ProcSvgInstCount;
-	emUInt64 ProcIdleClock;
-	bool ProcTerminating;
-	emArray<char> ReadBuf;
-	emArray<char> WriteBuf;
+	void FailProc(int procIndex, const emString & err);
+	void UpdateProcLoads();
 
 	emJobQueue JobQueue;
-
-	int ShmSize;
-
-#if defined(_WIN32) || defined(__CYGWIN__)
-	char ShmId[256];
-	void * ShmHdl;
-#else
-	int ShmId;
-#endif
-
-	emByte * ShmPtr;
-	int ShmAllocBegin;
-	int ShmAllocEnd;
-
-	static const int MinShmSize;
+	emServerProcPool Pool;
+		// All jobs of the SVG server are costly (opening and
+		// rendering).
 };
 
 
@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+// emSvgTileCache.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emSvgTileCache_h
+#define emSvgTileCache_h
+
+#ifndef emTileCache_h
+#include <emCore/emTileCache.h>
+#endif
+
+#ifndef emSvgServerModel_h
+#include <emSvg/emSvgServerModel.h>
+#endif
+
+
+class emSvgTileCache : public emTileCache {
+
+public:
+
+	// Cache of the rendered contents of an SVG document (see emTileCache).
+	// The document is page 0, and a page unit is a pixel of its default
+	// size. The document is rendered on a white background.
+
+	emSvgTileCache(emScheduler & scheduler);
+	virtual ~emSvgTileCache();
+
+	void Setup(emSvgServerModel & serverModel,
+	           emSvgServerModel::SvgInstance & svgInstance);
+
+	virtual void Reset();
+
+protected:
+
+	virtual bool GetPageSize(int page, double * pWidth,
+	                         double * pHeight) const;
+
+	virtual emRef<emJob> StartTileJob(
+		int page, double srcX, double srcY, double srcWidth,
+		double srcHeight, int tgtWidth, int tgtHeight, double priority
+	);
+
+	virtual void AbortTileJob(emJob & job);
+
+	virtual const emImage & GetTileJobImage(const emJob & job) const;
+
+private:
+
+	emSvgServerModel * ServerModel;
+	emSvgServerModel::SvgInstance * SvgInstance;
+};
+
+
+#endif
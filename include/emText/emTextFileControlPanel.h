@@ -48,6 +48,7 @@ protected:
 private:
 
 	void UpdateControls();
+	void StartSearch();
 
 	emRef<emTextFileModel> FileModel;
 	emCrossPtr<emTextFilePanel> FilePanel;
@@ -59,6 +60,14 @@ private:
 	emButton * Copy;
 	emButton * SelectAll;
 	emButton * ClearSelection;
+	emCheckBox * Follow;
+	emCheckBox * StayAtEnd;
+	emTextField * SearchPattern;
+	emCheckBox * SearchRegEx;
+	emCheckBox * SearchCaseSensitive;
+	emButton * FindNext;
+	emButton * FindPrev;
+	emTextField * SearchStatus;
 };
 
 
@@ -25,11 +25,38 @@
 #include <emCore/emFileModel.h>
 #endif
 
+#ifndef emRenderThreadPool_h
+#include <emCore/emRenderThreadPool.h>
+#endif
+
+#ifndef emTimer_h
+#include <emCore/emTimer.h>
+#endif
+
 
 class emTextFileModel : public emFileModel {
 
 public:
 
+	// File model for viewing a text file. The file is read into memory,
+	// and for large files the line index is built incrementally: Loading
+	// finishes as soon as the beginning of the file has been indexed, and
+	// the rest is indexed in the background while the model is already in
+	// the loaded state. Thereby the line count grows, and
+	// GetLineIndexSignal() is signaled. Content indices are 64-bit, line
+	// indices are int.
+	//
+	// Regular files which are too large for the memory limit are mapped
+	// read-only instead of being read, so that only the line index is
+	// held in memory. If such a file is truncated meanwhile (e.g. by log
+	// rotation), the vanished part of the mapping reads as zeros instead
+	// of crashing the process with SIGBUS, and the model reloads as soon
+	// as it notices the new file size (it checks periodically).
+	//
+	// Block devices are not loaded at all. Their "windowed" content is
+	// taken as binary, and it is read on demand through a small page
+	// cache (see ReadContent(..)).
+
 	static emRef<emTextFileModel> Acquire(
 		emContext & context, const emString & name, bool common=true
 	);
@@ -37,7 +64,21 @@ public:
 	// All the following getters may be called by multiple threads
 	// concurrently. See emTextFilePanel::Paint(..).
 
-	const emArray<char> & GetContent() const;
+	const char * GetContent() const;
+		// The whole content of the file (a copy in memory, or a
+		// mapping). With windowed content, this is an empty string.
+
+	emInt64 GetContentSize() const;
+		// Number of bytes in the content.
+
+	bool IsContentWindowed() const;
+		// Whether the content is read on demand.
+
+	int ReadContent(emInt64 index, char * buf, int len) const;
+		// Copy bytes of the content to a buffer. This works with any
+		// kind of content, and it is the only way to get at windowed
+		// content. Returns the number of bytes copied, which is less
+		// than len at the end of the content or on a read error.
 
 	enum CEType {
 		CE_BINARY,
@@ -48,10 +89,14 @@ public:
 		CE_UTF16BE
 	};
 	CEType GetCharEncoding() const;
+		// With large content, the character encoding is detected from
+		// the beginning of the file and from samples spread over the
+		// rest of the file (see DETECTION_SIZE). UTF-16 requires a
+		// byte order mark, and it is validated at the beginning only.
 
 	bool IsSameCharEncoding() const;
 
-	int DecodeChar(int * pUcs4, int index, emMBState * mbState) const;
+	int DecodeChar(int * pUcs4, emInt64 index, emMBState * mbState) const;
 
 	int ConvertToCurrentLocale(
 		char * tgt, int tgtSize,
@@ -69,36 +114,66 @@ public:
 		LBE_MIXED
 	};
 	LBEType GetLineBreakEncoding() const;
+		// While indexing, this covers the indexed lines only.
+
+	bool IsIndexing() const;
+		// Whether the line index is still incomplete.
+
+	double GetIndexingProgress() const;
+		// Progress of indexing in percent.
+
+	emInt64 GetIndexedSize() const;
+		// Index to the content: end of the last indexed line. This is
+		// GetContentSize() if not indexing.
 
 	int GetLineCount() const;
+		// Number of indexed lines.
 
 	int GetColumnCount() const;
+		// Maximum width of the indexed lines in columns.
 
-	int GetLineStart(int lineIndex) const;
+	emInt64 GetLineStart(int lineIndex) const;
 		// Index to the content: first character of a line.
 
-	int GetLineEnd(int lineIndex) const;
+	emInt64 GetLineEnd(int lineIndex) const;
 		// Index to the content: one after last character of a line
 		// without line feed.
 
-	int ColRow2Index(double column, double row, bool forCursor) const;
-	int Index2Row(int index) const;
-	void Index2ColRow(int index, int * pColumn, int * pRow) const;
-	int GetNextWordBoundaryIndex(int index) const;
-	int GetPrevWordBoundaryIndex(int index) const;
-	int GetNextRowIndex(int index) const;
-	int GetPrevRowIndex(int index) const;
+	emInt64 ColRow2Index(double column, double row, bool forCursor) const;
+	int Index2Row(emInt64 index) const;
+	void Index2ColRow(emInt64 index, int * pColumn, int * pRow) const;
+	emInt64 GetNextWordBoundaryIndex(emInt64 index) const;
+	emInt64 GetPrevWordBoundaryIndex(emInt64 index) const;
+	emInt64 GetNextRowIndex(emInt64 index) const;
+	emInt64 GetPrevRowIndex(emInt64 index) const;
 
 	emUInt8 GetRelativeLineIndent(int lineIndex) const;
 	emUInt8 GetRelativeLineWidth(int lineIndex) const;
 		// Indent and width of a line in units of ColumnCount/255.
 
 	const emSignal & GetChangeSignal() const;
+		// Signaled when the content has changed (or has been reset).
+
+	const emSignal & GetLineIndexSignal() const;
+		// Signaled when more lines have been indexed in the background,
+		// and when data has been appended to the content (see
+		// AddFollower()).
+
+	void AddFollower();
+	void RemoveFollower();
+	bool IsFollowed() const;
+		// While the model has at least one follower, the file is
+		// checked periodically for appended data, like with "tail -f".
+		// Appended bytes are added to the content, and only they are
+		// indexed (plus the last line if it was not terminated). If
+		// the file has shrunk or has been replaced, it is reloaded
+		// through Update().
 
 protected:
 
 	emTextFileModel(emContext & context, const emString & name);
 	virtual ~emTextFileModel();
+	virtual bool Cycle();
 	virtual void ResetData();
 	virtual void TryStartLoading();
 	virtual bool TryContinueLoading();
@@ -111,16 +186,212 @@ protected:
 
 private:
 
-	emArray<char> Content;
+	struct ByteClassCounts {
+		emInt64 Binary;
+			// Number of bytes 0x00 to 0x05.
+		emInt64 Control;
+			// Number of bytes 0x06, 0x0E to 0x1F, and 0x7F.
+		emInt64 High;
+			// Number of bytes 0x80 to 0xFF.
+		bool Utf8Valid;
+			// Whether the validated range is valid UTF-8.
+	};
+
+	struct LineScan {
+		emInt64 Pos;
+			// Position of the next byte to be scanned.
+		emInt64 End;
+			// Scanning stops as soon as Pos reaches this.
+		int Col,Col1,Col2;
+			// Current column, and first and end column of
+			// non-space characters in the current line.
+		int ColumnCount;
+		bool FoundCR,FoundLF,FoundCRLF;
+		emArray<emInt64> * Starts;
+		emArray<emUInt16> * Indents;
+		emArray<emUInt16> * Widths;
+			// Output: starts of the following lines, and indents
+			// and widths of the finished lines.
+		int MaxLines;
+			// Scanning stops when Indents has this count.
+		void FinishLine(emInt64 nextLineStart, emInt64 contentSize);
+	};
+
+	struct ClassifyChunk {
+		emInt64 Begin,End,ValidateFrom;
+		ByteClassCounts Counts;
+	};
+
+	struct ClassifyThreadData {
+		const emTextFileModel * Model;
+		ClassifyChunk * Chunks;
+	};
+
+	struct ScanChunk {
+		emInt64 Begin,End;
+		bool Valid;
+			// Whether a line start has been found in the chunk.
+		emInt64 FirstStart;
+		LineScan Scan;
+		emArray<emInt64> Starts;
+		emArray<emUInt16> Indents;
+		emArray<emUInt16> Widths;
+	};
+
+	struct ScanLinesThreadData {
+		const emTextFileModel * Model;
+		ScanChunk * Chunks;
+		bool Utf8;
+	};
+
+	struct WindowPage;
+
+	static emInt64 GetOpenFileSize(FILE * file);
+	static bool SeekFile(FILE * file, emInt64 pos);
+	static int ReadFileAt(FILE * file, emInt64 pos, char * buf, int len);
+
+	void OpenWindow(FILE * file, emInt64 size);
+	void CloseWindow();
+	const WindowPage * GetWindowPage(emInt64 index) const;
+
+	bool MapContent(FILE * file, emInt64 size);
+	void UnmapContent();
+
+	bool ResizeContentBuf(emInt64 size);
+	void FreeContentBuf();
+	bool AppendContent(emInt64 newSize);
+
+	void FollowFile();
+
+	void ClassifyBytes(emInt64 begin, emInt64 end, ByteClassCounts * counts);
+
+	void StartIndexing(emInt64 startPos);
+	bool ContinueIndexing(emInt64 endPos);
+	bool CanScanLinesFast() const;
+	void ScanLinesParallel(emInt64 endPos);
+	void ScanLinesSerial(emInt64 endPos);
+
+	static emInt64 ValidateUtf8(const char * content, emInt64 contentSize,
+	                            emInt64 pos, emInt64 end);
+		// Returns the end of the last validated sequence, or -1 if
+		// invalid.
+
+	static void ClassifyBytesThreadFunc(void * data, int index);
+	static void ScanLinesThreadFunc(void * data, int index);
+
+	typedef void (*ClassifyBytesFunc)(
+		const char * content, emInt64 contentSize, emInt64 begin,
+		emInt64 end, emInt64 validateFrom, ByteClassCounts * counts
+	);
+	typedef void (*ScanLinesFunc)(
+		const char * content, emInt64 contentSize, bool utf8,
+		LineScan * scan
+	);
+		// Kernels for the fused passes over single-byte based
+		// encodings. Counting covers [begin,end), UTF-8 validation
+		// [validateFrom,end) (but sequences may extend beyond end).
+
+	static void ClassifyBytesScalar(
+		const char * content, emInt64 contentSize, emInt64 begin,
+		emInt64 end, emInt64 validateFrom, ByteClassCounts * counts
+	);
+	static void ScanLinesScalar(
+		const char * content, emInt64 contentSize, bool utf8,
+		LineScan * scan
+	);
+#	if EM_HAVE_X86_INTRINSICS
+		static void ClassifyBytesAvx2(
+			const char * content, emInt64 contentSize, emInt64 begin,
+			emInt64 end, emInt64 validateFrom, ByteClassCounts * counts
+		);
+		static void ScanLinesAvx2(
+			const char * content, emInt64 contentSize, bool utf8,
+			LineScan * scan
+		);
+#	endif
+
+	enum {
+		LARGE_CONTENT_SIZE = 16*1024*1024,
+			// Smaller contents are checked and indexed completely
+			// while loading.
+		DETECTION_SIZE = 4*1024*1024,
+			// Number of bytes at the beginning of a large content
+			// for detecting the character encoding.
+		DETECTION_SAMPLE_COUNT = 64,
+		DETECTION_SAMPLE_SIZE = 64*1024,
+			// Number and size of additional samples from the rest of
+			// a large content for detecting the character encoding.
+		INITIAL_INDEX_SIZE = 1024*1024,
+			// Number of bytes at the beginning of a large content
+			// which are indexed before loading finishes.
+		READ_SIZE = 1024*1024,
+			// Number of bytes read per loading step.
+		CHUNK_SIZE = 256*1024,
+			// Number of bytes per thread and step of the fused
+			// passes.
+		FOLLOW_INTERVAL = 500,
+			// Milliseconds between checks for appended data, and
+			// for truncation of mapped content.
+		WINDOW_PAGE_SIZE = 64*1024,
+			// Number of bytes per page of windowed content.
+		WINDOW_PAGE_COUNT = 32,
+			// Number of pages cached of windowed content.
+		MAX_LINE_COUNT = 0x3FFFFFFF
+			// Indexing stops at this number of lines.
+	};
+
+	struct WindowPage {
+		emInt64 Pos;
+			// Content index of the page, or -1 if unused.
+		int Size;
+		emUInt64 LastUse;
+		char * Data;
+	};
+
+	struct WindowState {
+		FILE * File;
+		emThreadMutex Mutex;
+		emUInt64 UseClock;
+		WindowPage Pages[WINDOW_PAGE_COUNT];
+	};
+
+	emRef<emRenderThreadPool> ThreadPool;
+	ClassifyBytesFunc ClassifyBytesKernel;
+	ScanLinesFunc ScanLinesKernel;
+
+	const char * Content;
+	emInt64 ContentSize;
+	char * ContentBuf;
+	emInt64 ContentBufSize;
+		// Allocated memory for the content (malloc).
+	void * MappedAddr;
+	emInt64 MappedSize;
+		// Mapping of the file, if the content is mapped.
+	WindowState * W;
 
 	CEType CharEncoding;
 	LBEType LineBreakEncoding;
 	int LineCount;
 	int ColumnCount;
-	int * LineStarts;
-	emUInt8 * RelativeLineIndents;
-	emUInt8 * RelativeLineWidths;
+	emArray<emInt64> LineStarts;
+	emArray<emUInt16> LineIndents;
+	emArray<emUInt16> LineWidths;
+	emInt64 TextStart;
+		// Index of the first character after a byte order mark.
 	emSignal ChangeSignal;
+	emSignal LineIndexSignal;
+
+	emTimer FollowTimer;
+	int FollowerCount;
+	emUInt64 FileINode;
+
+	struct IndexingState {
+		emInt64 StartPos;
+		LineScan Scan;
+		emMBState MBState;
+		emUInt64 LastSignalClock;
+	};
+	IndexingState * I;
 
 	struct LoadingState {
 		int Stage;
@@ -129,19 +400,29 @@ private:
 		emUInt64 FileSize;
 		emUInt64 FileRead;
 		char Buf[4096];
-		int Statistics[256];
-		int StartPos,Pos,Row,Col,Col1,Col2;
-		bool FoundCR,FoundLF,FoundCRLF;
-		emMBState MBState;
+		ByteClassCounts Counts;
+		emInt64 DetectEnd,DetectCount,StartPos,Pos;
+		int Sample;
+		bool BlockDevice;
 	};
 	LoadingState * L;
 };
 
-inline const emArray<char> & emTextFileModel::GetContent() const
+inline const char * emTextFileModel::GetContent() const
 {
 	return Content;
 }
 
+inline emInt64 emTextFileModel::GetContentSize() const
+{
+	return ContentSize;
+}
+
+inline bool emTextFileModel::IsContentWindowed() const
+{
+	return W!=NULL;
+}
+
 inline emTextFileModel::CEType emTextFileModel::GetCharEncoding() const
 {
 	return CharEncoding;
@@ -152,6 +433,11 @@ inline emTextFileModel::LBEType emTextFileModel::GetLineBreakEncoding() const
 	return LineBreakEncoding;
 }
 
+inline bool emTextFileModel::IsIndexing() const
+{
+	return I!=NULL;
+}
+
 inline int emTextFileModel::GetLineCount() const
 {
 	return LineCount;
@@ -162,24 +448,24 @@ inline int emTextFileModel::GetColumnCount() const
 	return ColumnCount;
 }
 
-inline int emTextFileModel::GetLineStart(int lineIndex) const
+inline emInt64 emTextFileModel::GetLineStart(int lineIndex) const
 {
 	return LineStarts[lineIndex];
 }
 
-inline emUInt8 emTextFileModel::GetRelativeLineIndent(int lineIndex) const
+inline const emSignal & emTextFileModel::GetChangeSignal() const
 {
-	return RelativeLineIndents[lineIndex];
+	return ChangeSignal;
 }
 
-inline emUInt8 emTextFileModel::GetRelativeLineWidth(int lineIndex) const
+inline const emSignal & emTextFileModel::GetLineIndexSignal() const
 {
-	return RelativeLineWidths[lineIndex];
+	return LineIndexSignal;
 }
 
-inline const emSignal & emTextFileModel::GetChangeSignal() const
+inline bool emTextFileModel::IsFollowed() const
 {
-	return ChangeSignal;
+	return FollowerCount>0;
 }
 
 
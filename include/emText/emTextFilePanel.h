@@ -33,6 +33,10 @@
 #include <emText/emTextFileModel.h>
 #endif
 
+#ifndef emTextSearch_h
+#include <emText/emTextSearch.h>
+#endif
+
 
 class emTextFilePanel : public emFilePanel {
 
@@ -52,15 +56,42 @@ public:
 	bool IsHexView() const;
 
 	const emSignal & GetSelectionSignal() const;
-	int GetSelectionStartIndex() const;
-	int GetSelectionEndIndex() const;
+	emInt64 GetSelectionStartIndex() const;
+	emInt64 GetSelectionEndIndex() const;
 	bool IsSelectionEmpty() const;
-	void Select(int startIndex, int endIndex, bool publish);
+	void Select(emInt64 startIndex, emInt64 endIndex, bool publish);
 	void SelectAll(bool publish);
 	void EmptySelection();
 	void PublishSelection();
 	void CopySelectedTextToClipboard();
 
+	bool IsFollowing() const;
+	void SetFollowing(bool following);
+		// Whether to follow the file, that is to show data which is
+		// appended to the file while viewing it (see
+		// emTextFileModel::AddFollower()).
+
+	bool IsStayingAtEnd() const;
+	void SetStayingAtEnd(bool stayingAtEnd);
+		// Whether the view shall stay at the end of the text while
+		// following. If the end of the text is in the view when data
+		// is appended, the view is moved and zoomed so that the end
+		// keeps its position and size in the view.
+
+	const emTextSearch & GetSearch() const;
+	void StartSearch(const emString & pattern, bool regEx,
+	                 bool caseSensitive);
+	void ClearSearch();
+		// Search for a pattern in the text. The matches are
+		// highlighted while searching (see emTextSearch). This has no
+		// effect in hex view.
+
+	bool GoToNextMatch();
+	bool GoToPrevMatch();
+		// Select the next or previous match after or before the
+		// selection, or else the view center, and visit it. Returns
+		// false if there is no match.
+
 protected:
 
 	virtual bool Cycle();
@@ -92,10 +123,16 @@ private:
 
 	void UpdateTextLayout();
 
+	bool GetTextEnd(double * pX, double * pY) const;
+
+	emInt64 GetViewCenterIndex() const;
+
+	void GoToMatch(int matchIndex);
+
 	bool CheckMouse(double mx, double my,
 	                double * pCol, double * pRow) const;
 
-	void ModifySelection(int oldIndex, int newIndex, bool publish);
+	void ModifySelection(emInt64 oldIndex, emInt64 newIndex, bool publish);
 
 	emString ConvertSelectedTextToCurrentLocale() const;
 
@@ -117,16 +154,24 @@ private:
 
 	void PaintAsHex(const emPainter & painter, emColor canvasColor) const;
 
+	enum {
+		VISIT_ROWS = 40
+			// Number of rows shown when going to a match.
+	};
+
 	bool AlternativeView;
 	emTextFileModel * Model;
 	emRef<emClipboard> Clipboard;
-	int PageCount,PageRows,PageCols;
+	int PageCount,PageRows,PageCols,HexAddrDigits;
 	double PageWidth,PageGap,CharWidth,CharHeight;
 	emSignal SelectionSignal;
-	int SelectionStartIndex,SelectionEndIndex;
+	emInt64 SelectionStartIndex,SelectionEndIndex;
 	emInt64 SelectionId;
 	DragModeType DragMode;
-	int DragIndex;
+	emInt64 DragIndex;
+	bool Following;
+	bool StayingAtEnd;
+	emTextSearch Search;
 
 	static const emColor TextBgColor;
 	static const emColor TextFgColor;
@@ -134,6 +179,9 @@ private:
 	static const emColor TextSelFgColor;
 	static const emColor TextSelFg96Color;
 	static const emColor TextSelBgColor;
+	static const emColor TextMatchFgColor;
+	static const emColor TextMatchFg96Color;
+	static const emColor TextMatchBgColor;
 	static const emColor HexBgColor;
 	static const emColor HexAddrColor;
 	static const emColor HexDataColor;
@@ -156,12 +204,12 @@ inline const emSignal & emTextFilePanel::GetSelectionSignal() const
 	return SelectionSignal;
 }
 
-inline int emTextFilePanel::GetSelectionStartIndex() const
+inline emInt64 emTextFilePanel::GetSelectionStartIndex() const
 {
 	return SelectionStartIndex;
 }
 
-inline int emTextFilePanel::GetSelectionEndIndex() const
+inline emInt64 emTextFilePanel::GetSelectionEndIndex() const
 {
 	return SelectionEndIndex;
 }
@@ -171,5 +219,20 @@ inline bool emTextFilePanel::IsSelectionEmpty() const
 	return SelectionStartIndex>=SelectionEndIndex;
 }
 
+inline bool emTextFilePanel::IsFollowing() const
+{
+	return Following;
+}
+
+inline bool emTextFilePanel::IsStayingAtEnd() const
+{
+	return StayingAtEnd;
+}
+
+inline const emTextSearch & emTextFilePanel::GetSearch() const
+{
+	return Search;
+}
+
 
 #endif
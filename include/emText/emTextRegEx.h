@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+// emTextRegEx.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emTextRegEx_h
+#define emTextRegEx_h
+
+#ifndef emStd2_h
+#include <emCore/emStd2.h>
+#endif
+
+#ifndef emArray_h
+#include <emCore/emArray.h>
+#endif
+
+
+//==============================================================================
+//================================ emTextRegEx =================================
+//==============================================================================
+
+class emTextRegEx {
+
+public:
+
+	// Regular expression for searching in lines of text. The text is
+	// given as an array of Unicode characters. A compiled expression is
+	// matched by simulating its automaton in a single pass over the text,
+	// so the time is linear in the length of the text, whatever the
+	// expression is. Supported syntax:
+	//   c             - The character c, if it is none of .[]()|*+?{}^$
+	//                   and the backslash.
+	//   \c            - The character c, if it is a punctuation character.
+	//   \t \n \r \f \v \e - Control characters.
+	//   .             - Any character.
+	//   [...] [^...]  - Character class with characters, ranges (a-z) and
+	//                   the classes \d \w \s, or its complement.
+	//   \d \w \s      - Digit, word character, white space.
+	//   \D \W \S      - Complements of the above.
+	//   ^ $           - Beginning and end of the text.
+	//   \b \B         - Word boundary and non-boundary.
+	//   (...) (?:...) - Group.
+	//   a|b           - Alternatives.
+	//   * + ? {n} {n,} {n,m} - Greedy repetition.
+	// Word characters are ASCII letters and digits, the underscore, and
+	// all non-ASCII characters (like with emTextFileModel). Matching
+	// without case sensitivity folds ASCII and Latin-1 letters.
+
+	emTextRegEx();
+		// Construct an expression which matches nothing.
+
+	emTextRegEx(const emTextRegEx & regEx);
+		// Construct a copy.
+
+	~emTextRegEx();
+		// Destructor.
+
+	emTextRegEx & operator = (const emTextRegEx & regEx);
+		// Copy an expression.
+
+	void Compile(const int * pattern, int patternLen, bool caseSensitive,
+	             bool literal=false);
+		// Compile an expression. Throws an emException on a syntax
+		// error.
+		// Arguments:
+		//   pattern       - The expression as Unicode characters.
+		//   patternLen    - Number of characters in pattern.
+		//   caseSensitive - Whether to match case-sensitive.
+		//   literal       - If true, the pattern is taken as a plain
+		//                   string without any special characters.
+
+	bool IsCaseSensitive() const;
+		// Whether matching is case-sensitive.
+
+	const emArray<int> & GetRequiredString() const;
+		// A string which is contained in every match, or an empty
+		// array if there is none (or if it could not be found out). If
+		// not case-sensitive, it consists of characters whose case can
+		// be folded by ASCII rules alone, and it is in lower case. This
+		// is meant for a fast pre-search of candidate lines.
+
+	bool IsRequiredStringExact() const;
+		// Whether every match is exactly the required string, so that
+		// finding the required string is all it takes.
+
+	static int FoldCase(int c);
+		// Convert a character to lower case (ASCII and Latin-1 only).
+
+	class Matcher {
+
+	public:
+
+		// Class for matching a compiled expression against texts.
+		// Each thread must have its own matcher, but they can share
+		// the expression.
+
+		Matcher(const emTextRegEx & regEx);
+			// The expression must not be modified or destructed
+			// while the matcher is in use.
+
+		~Matcher();
+
+		bool Search(const int * text, int textLen, int startIndex,
+		            int * pMatchStart, int * pMatchEnd);
+			// Find the leftmost non-empty match which starts at
+			// or after startIndex. Of the matches starting there,
+			// the one preferred by greedy repetition and by the
+			// order of alternatives is taken. Returns false if
+			// there is no match.
+
+	private:
+
+		struct Thread {
+			int PC;
+			int Start;
+		};
+
+		int AddThread(Thread * list, int count, int pc, int start,
+		              const int * text, int textLen, int index);
+
+		const emTextRegEx & RegEx;
+		emArray<Thread> List1,List2;
+		emArray<int> Marks;
+		emArray<int> Stack;
+		int Generation;
+	};
+
+private:
+
+	enum NodeType {
+		N_EMPTY,
+		N_CHAR,
+		N_ANY,
+		N_CLASS,
+		N_BOL,
+		N_EOL,
+		N_WORD_BOUNDARY,
+		N_NOT_WORD_BOUNDARY,
+		N_CAT,
+		N_ALT,
+		N_REPEAT
+	};
+
+	struct Node {
+		NodeType Type;
+		int Arg;
+			// Character of N_CHAR, or class index of N_CLASS.
+		int Child1,Child2;
+			// Node indices, or -1.
+		int Min,Max;
+			// Bounds of N_REPEAT. Max is -1 for infinite.
+	};
+
+	enum OpType {
+		OP_CHAR,
+		OP_ANY,
+		OP_CLASS,
+		OP_BOL,
+		OP_EOL,
+		OP_WORD_BOUNDARY,
+		OP_NOT_WORD_BOUNDARY,
+		OP_SPLIT,
+		OP_JMP,
+		OP_MATCH
+	};
+
+	struct Instruction {
+		OpType Op;
+		int Arg;
+			// Character of OP_CHAR, or class index of OP_CLASS.
+		int X,Y;
+			// Targets of OP_SPLIT (X preferred), and of OP_JMP (X).
+	};
+
+	struct CharClass {
+		int FirstRange,RangeCount;
+			// Ranges of the class in ClassRanges.
+		bool Negated;
+	};
+
+	struct Parser;
+
+	struct ReqInfo {
+		bool Exact;
+			// Whether the node always matches exactly String.
+		emArray<int> String;
+			// The exact string, or else a required string.
+	};
+
+	int AddNode(NodeType type, int arg=0, int child1=-1, int child2=-1);
+	int ParseAlternatives(Parser & p);
+	int ParseConcatenation(Parser & p);
+	int ParseRepetition(Parser & p);
+	int ParseAtom(Parser & p);
+	int ParseClass(Parser & p);
+	int ParseInt(Parser & p);
+	static int GetEscapedChar(int c);
+	void AddClassEscape(int c);
+
+	void Emit(int node);
+	int AddInstruction(OpType op, int arg=0, int x=0, int y=0);
+
+	void CalcRequired(int node, ReqInfo * info) const;
+
+	bool IsInClass(int classIndex, int c) const;
+	static bool IsWordChar(int c);
+	static int UnfoldCase(int c);
+
+	enum {
+		MAX_PROGRAM_SIZE = 100000,
+		MAX_REPETITION   = 1000,
+		MAX_DEPTH        = 1000,
+		MAX_REQUIRED_LEN = 256
+	};
+
+	bool CaseSensitive;
+	emArray<Node> Nodes;
+	emArray<Instruction> Program;
+	emArray<CharClass> Classes;
+	emArray<int> ClassRanges;
+		// Pairs of first and last character.
+	emArray<int> RequiredString;
+	bool RequiredExact;
+};
+
+inline bool emTextRegEx::IsCaseSensitive() const
+{
+	return CaseSensitive;
+}
+
+inline const emArray<int> & emTextRegEx::GetRequiredString() const
+{
+	return RequiredString;
+}
+
+inline bool emTextRegEx::IsRequiredStringExact() const
+{
+	return RequiredExact;
+}
+
+
+#endif
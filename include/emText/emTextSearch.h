@@ -0,0 +1,275 @@
+//------------------------------------------------------------------------------
+// emTextSearch.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emTextSearch_h
+#define emTextSearch_h
+
+#ifndef emTextFileModel_h
+#include <emText/emTextFileModel.h>
+#endif
+
+#ifndef emTextRegEx_h
+#include <emText/emTextRegEx.h>
+#endif
+
+
+//==============================================================================
+//================================ emTextSearch ================================
+//==============================================================================
+
+class emTextSearch : public emEngine {
+
+public:
+
+	// Search for all matches of a pattern in the content of an
+	// emTextFileModel. The search runs in the background, and the content
+	// is searched in chunks by multiple threads concurrently. The matches
+	// are collected in a sorted index of content positions. Matches never
+	// span line breaks. When the model is reloaded, the search starts
+	// over, and when data is appended to the model (follow mode), only the
+	// new data is searched (plus the last line before).
+	//
+	// The candidates for matches are found by a fast scan for a string
+	// which every match must contain (see
+	// emTextRegEx::GetRequiredString()). If the pattern is just that
+	// string, the scan is all there is. Otherwise the lines containing
+	// candidates are decoded and matched against the regular expression.
+
+	emTextSearch(emContext & context);
+	virtual ~emTextSearch();
+
+	emTextFileModel * GetModel() const;
+	void SetModel(emTextFileModel * model);
+		// The model to be searched, or NULL. Setting a model starts a
+		// new search with the current pattern.
+
+	void Start(const emString & pattern, bool regEx, bool caseSensitive);
+		// Start a new search.
+		// Arguments:
+		//   pattern       - The pattern, encoded in the current locale.
+		//                   An empty pattern is like calling Clear().
+		//   regEx         - Whether the pattern is a regular expression
+		//                   (see emTextRegEx), or a plain string.
+		//   caseSensitive - Whether to search case-sensitive.
+
+	void Clear();
+		// Stop searching and forget the pattern and the matches.
+
+	const emString & GetPattern() const;
+	bool IsRegEx() const;
+	bool IsCaseSensitive() const;
+		// Current search arguments.
+
+	const emSignal & GetChangeSignal() const;
+		// Signaled when the search has been started or cleared, and
+		// while searching, when more matches have been found or the
+		// search has finished. This is throttled to a few times per
+		// second.
+
+	bool IsSearching() const;
+		// Whether the search is still in progress.
+
+	double GetProgress() const;
+		// Progress of searching in percent.
+
+	const emString & GetErrorText() const;
+		// Error message if the pattern is invalid, or empty.
+
+	bool IsTruncated() const;
+		// Whether the search has stopped because there are too many
+		// matches.
+
+	int GetMatchCount() const;
+		// Number of matches found so far.
+
+	emInt64 GetMatchStart(int index) const;
+	emInt64 GetMatchEnd(int index) const;
+		// Content indices of a match. The matches are sorted and do
+		// not overlap.
+
+	int FindMatch(emInt64 contentIndex) const;
+		// Get the index of the first match which ends after the given
+		// content index, or GetMatchCount() if there is none.
+
+	// GetMatchCount(), GetMatchStart(..), GetMatchEnd(..) and
+	// FindMatch(..) may be called by multiple threads concurrently. See
+	// emTextFilePanel::Paint(..).
+
+protected:
+
+	virtual bool Cycle();
+
+private:
+
+	struct Chunk {
+		emInt64 Begin,End;
+		emArray<emInt64> Starts;
+		emArray<emInt64> Ends;
+	};
+
+	struct ThreadData {
+		const emTextSearch * Search;
+		Chunk * Chunks;
+	};
+
+	void Restart();
+	void Prepare();
+	void ContinueSearching();
+	void HandleAppendedContent();
+
+	bool EncodeRequiredString();
+
+	int GetUnitSize() const;
+	int GetUnit(emInt64 index) const;
+	emInt64 FindLineStart(emInt64 index, emInt64 end) const;
+		// Index of the first line start after index, or end.
+	emInt64 FindPrevLineStart(emInt64 index, emInt64 begin) const;
+		// Index of the start of the line containing index, but not
+		// less than begin.
+	emInt64 FindLineEnd(emInt64 index, emInt64 end) const;
+		// Index of the first line break at or after index, or end.
+
+	void SearchChunk(Chunk * chunk) const;
+	void SearchLiteral(Chunk * chunk) const;
+	void SearchRegEx(Chunk * chunk) const;
+
+	static void SearchThreadFunc(void * data, int index);
+
+	typedef emInt64 (*FindFunc)(
+		const char * content, emInt64 begin, emInt64 end,
+		const char * str, int len, bool foldCase
+	);
+		// Kernel for finding the first occurrence of a byte string
+		// which lies completely within [begin,end). Returns -1 if
+		// there is none. If foldCase is true, ASCII letters of the
+		// content are converted to lower case before comparing, and
+		// str must already be in lower case.
+
+	static emInt64 FindScalar(
+		const char * content, emInt64 begin, emInt64 end,
+		const char * str, int len, bool foldCase
+	);
+#	if EM_HAVE_X86_INTRINSICS
+		static emInt64 FindAvx2(
+			const char * content, emInt64 begin, emInt64 end,
+			const char * str, int len, bool foldCase
+		);
+#	endif
+
+	static bool IsEqual(const char * p, const char * str, int len,
+	                    bool foldCase);
+
+	enum {
+		STEP_SIZE = 4*1024*1024,
+			// Number of bytes per thread and step.
+		MAX_LINE_CHARS = 1024*1024,
+			// Lines are matched against regular expressions in
+			// pieces of this number of characters at most.
+		MAX_MATCH_COUNT = 1024*1024,
+			// Searching stops at this number of matches.
+		SIGNAL_INTERVAL = 250
+			// Milliseconds between signals while searching.
+	};
+
+	emRef<emRenderThreadPool> ThreadPool;
+	FindFunc FindKernel;
+	emTextFileModel * Model;
+	emString Pattern;
+	bool RegExMode;
+	bool CaseSensitive;
+	emTextRegEx RegEx;
+	emSignal ChangeSignal;
+	emString ErrorText;
+	bool Searching;
+	bool Prepared;
+	bool Truncated;
+	bool Literal;
+		// Whether the pattern is just the required string.
+	bool FoldCase;
+		// Whether the required string is to be found with folded case.
+	emArray<char> EncodedString;
+		// The required string, encoded like the content, or empty.
+	emTextFileModel::CEType Encoding;
+	emInt64 Pos;
+		// Searching continues here. It is always a line start.
+	emInt64 SearchedSize;
+		// Content size the search has been started or continued with.
+	emUInt64 LastSignalClock;
+	emArray<emInt64> MatchStarts;
+	emArray<emInt64> MatchEnds;
+};
+
+inline emTextFileModel * emTextSearch::GetModel() const
+{
+	return Model;
+}
+
+inline const emString & emTextSearch::GetPattern() const
+{
+	return Pattern;
+}
+
+inline bool emTextSearch::IsRegEx() const
+{
+	return RegExMode;
+}
+
+inline bool emTextSearch::IsCaseSensitive() const
+{
+	return CaseSensitive;
+}
+
+inline const emSignal & emTextSearch::GetChangeSignal() const
+{
+	return ChangeSignal;
+}
+
+inline bool emTextSearch::IsSearching() const
+{
+	return Searching;
+}
+
+inline const emString & emTextSearch::GetErrorText() const
+{
+	return ErrorText;
+}
+
+inline bool emTextSearch::IsTruncated() const
+{
+	return Truncated;
+}
+
+inline int emTextSearch::GetMatchCount() const
+{
+	return MatchStarts.GetCount();
+}
+
+inline emInt64 emTextSearch::GetMatchStart(int index) const
+{
+	return MatchStarts[index];
+}
+
+inline emInt64 emTextSearch::GetMatchEnd(int index) const
+{
+	return MatchEnds[index];
+}
+
+
+#endif
@@ -34,6 +34,16 @@ public:
 		emContext & context, const emString & name, bool common=true
 	);
 
+	static void PrepareTiffCall();
+	static void ThrowTiffError();
+		// Helpers for calling libtiff. PrepareTiffCall() installs the
+		// error handlers and resets the error message of the calling
+		// thread. After a libtiff function has failed, ThrowTiffError()
+		// throws an emException with the recorded error message.
+
+	static emString GetCompressionName(int compression);
+		// Get a human-readable name for a TIFF compression tag value.
+
 protected:
 
 	emTiffImageFileModel(emContext & context, const emString & name);
@@ -49,14 +59,13 @@ protected:
 
 private:
 
-	static void ThrowTiffError();
-
 	struct LoadingState {
 		void * Tif;
 		void * Buffer;
 		bool Tiled;
 		int ImgW,ImgH,PartW,PartH,Channels;
 		int CurrentX,CurrentY,CurrentOp;
+		int Sub;
 	};
 
 	LoadingState * L;
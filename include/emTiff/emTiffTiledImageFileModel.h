@@ -0,0 +1,325 @@
+//------------------------------------------------------------------------------
+// emTiffTiledImageFileModel.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emTiffTiledImageFileModel_h
+#define emTiffTiledImageFileModel_h
+
+#ifndef emAvlTreeMap_h
+#include <emCore/emAvlTreeMap.h>
+#endif
+
+#ifndef emCoreConfig_h
+#include <emCore/emCoreConfig.h>
+#endif
+
+#ifndef emFileModel_h
+#include <emCore/emFileModel.h>
+#endif
+
+#ifndef emImage_h
+#include <emCore/emImage.h>
+#endif
+
+
+//==============================================================================
+//========================= emTiffTiledImageFileModel ==========================
+//==============================================================================
+
+class emTiffTiledImageFileModel : public emFileModel {
+
+public:
+
+	// File model for huge TIFF images, which are never decoded as a whole.
+	// Loading the model reads only the structure of the file: the size of
+	// the image and its resolution levels (reduced-resolution images in
+	// SubIFDs or in the main IFD chain). The pixels are decoded on demand,
+	// tile by tile (or strip by strip), for the tiles wanted by the
+	// panels. Decoded tiles are held in an LRU cache, whose size is
+	// bounded by MaxMegabytesPerView of the core configuration.
+	//
+	// A tile is addressed by a key made of a resolution level, a reduction
+	// factor, a column and a row. With reduction factor r, a tile covers
+	// r*r tiles or strips of the level (the "parts"), box-filtered down to
+	// the size of one part.
+
+	static emRef<emTiffTiledImageFileModel> Acquire(
+		emContext & context, const emString & name, bool common=true
+	);
+
+	static bool IsSuitableFile(const emString & filePath);
+		// Ask whether a file should better be shown through this model
+		// than through emTiffImageFileModel. That is the case for large
+		// TIFF images whose tiles or strips are of moderate size. This
+		// only reads the header and the first directory of the file
+		// (without libtiff), so it is cheap enough for being called
+		// when creating a panel.
+
+	const emString & GetFileFormatInfo() const;
+	const emString & GetComment() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetChannelCount() const;
+		// Information about the image. Valid in the loaded state.
+
+	int GetLevelCount() const;
+	int GetLevelWidth(int level) const;
+	int GetLevelHeight(int level) const;
+	int GetLevelPartWidth(int level) const;
+	int GetLevelPartHeight(int level) const;
+		// Resolution levels, sorted by decreasing size. Level 0 is the
+		// full resolution image. A part is a tile or a strip of the
+		// TIFF file.
+
+	enum {
+		MAX_REDUCTION = 256
+		// Maximum reduction factor of a tile (a power of two).
+	};
+
+	static emUInt64 MakeTileKey(int level, int reduction, int column,
+	                            int row);
+	static int GetTileKeyLevel(emUInt64 tileKey);
+	static int GetTileKeyReduction(emUInt64 tileKey);
+	static int GetTileKeyColumn(emUInt64 tileKey);
+	static int GetTileKeyRow(emUInt64 tileKey);
+		// Make or decompose a tile key.
+
+	int GetTileColumns(int level, int reduction) const;
+	int GetTileRows(int level, int reduction) const;
+		// Number of tiles in a resolution level at a reduction factor.
+
+	void GetTileRect(emUInt64 tileKey, int * pX1, int * pY1, int * pX2,
+	                 int * pY2) const;
+		// Get the area covered by a tile, in pixel coordinates of its
+		// resolution level (x2 and y2 are exclusive).
+
+	const emImage * GetTile(emUInt64 tileKey) const;
+		// Get a decoded tile from the cache, or NULL if it is not
+		// cached. If decoding has failed, the image is empty. This may
+		// be called from the Paint method of a panel.
+
+	void SetWantedTiles(const void * viewer,
+	                    const emArray<emUInt64> & tileKeys);
+		// Set the tiles wanted by a viewer (typically a panel), in the
+		// order of preference. The tiles which are not cached are
+		// decoded in the background, and they are not dropped from the
+		// cache while wanted. Set an empty array for removing the
+		// viewer. Each viewer must do that before it is destructed.
+
+	const emSignal & GetTileSignal() const;
+		// Signaled when tiles have been added to the cache.
+
+protected:
+
+	emTiffTiledImageFileModel(emContext & context, const emString & name);
+	virtual ~emTiffTiledImageFileModel();
+
+	virtual bool Cycle();
+
+	virtual void ResetData();
+	virtual void TryStartLoading();
+	virtual bool TryContinueLoading();
+	virtual void QuitLoading();
+	virtual void TryStartSaving();
+	virtual bool TryContinueSaving();
+	virtual void QuitSaving();
+	virtual emUInt64 CalcMemoryNeed();
+	virtual double CalcFileProgress();
+
+private:
+
+	struct Level {
+		emUInt64 DirOffset;
+		int Width,Height,PartW,PartH;
+		bool Tiled;
+	};
+
+	struct CacheEntry {
+		emImage Image;
+		emUInt64 Prev,Next;
+			// Neighbours in the LRU list (NO_TILE at the ends).
+	};
+
+	struct Viewer {
+		const void * Ptr;
+		emArray<emUInt64> TileKeys;
+	};
+
+	struct LoadingState {
+		void * Tif;
+		emArray<emUInt64> SubIfdOffsets;
+		int NextSubIfd;
+		int NextDir;
+	};
+
+	struct DecodingState {
+		emUInt64 TileKey;
+		int Level,Reduction;
+		int X1,Y1,X2,Y2;
+		int OutW,OutH;
+		int PartX,PartY;
+		emArray<emUInt32> Sums;
+		emArray<emUInt32> Buffer;
+	};
+
+	static bool ReadLevel(void * tif, Level * level);
+	static bool SniffFirstLevel(const emString & filePath, Level * level);
+
+	void LinkLru(emUInt64 tileKey, CacheEntry * e);
+	void UnlinkLru(CacheEntry * e);
+	bool IsTileWanted(emUInt64 tileKey) const;
+	bool FindWantedTile(emUInt64 * pTileKey) const;
+	bool DecodeTiles();
+	void StartDecoding(emUInt64 tileKey);
+	void ContinueDecoding();
+	void FinishDecoding();
+	void AddToCache(emUInt64 tileKey, const emImage & image);
+	static emUInt64 CalcImageSize(const emImage & image);
+	void CloseTileTif();
+
+	static int CmpLevels(const Level * l1, const Level * l2, void * context);
+
+	static const emUInt64 NO_TILE;
+
+	enum {
+		MIN_PIXELS      = 32*1024*1024,
+		MAX_PART_PIXELS = 16*1024*1024,
+		MAX_DIRS        = 256
+	};
+
+	emRef<emCoreConfig> CoreConfig;
+	emSignal TileSignal;
+	emString FileFormatInfo;
+	emString Comment;
+	int Channels;
+	emArray<Level> Levels;
+	emAvlTreeMap<emUInt64,CacheEntry> Cache;
+	emUInt64 CacheSize;
+	emUInt64 LruFirst,LruLast;
+		// Most and least recently used cache entry.
+	emArray<Viewer> Viewers;
+	emArray<emUInt64> WantedSorted;
+		// Tiles wanted by any viewer, sorted by key.
+	bool WantedChanged;
+	LoadingState * L;
+	void * TileTif;
+	int TileTifLevel;
+	DecodingState * D;
+};
+
+inline const emString & emTiffTiledImageFileModel::GetFileFormatInfo() const
+{
+	return FileFormatInfo;
+}
+
+inline const emString & emTiffTiledImageFileModel::GetComment() const
+{
+	return Comment;
+}
+
+inline int emTiffTiledImageFileModel::GetWidth() const
+{
+	return Levels.IsEmpty() ? 0 : Levels[0].Width;
+}
+
+inline int emTiffTiledImageFileModel::GetHeight() const
+{
+	return Levels.IsEmpty() ? 0 : Levels[0].Height;
+}
+
+inline int emTiffTiledImageFileModel::GetChannelCount() const
+{
+	return Channels;
+}
+
+inline int emTiffTiledImageFileModel::GetLevelCount() const
+{
+	return Levels.GetCount();
+}
+
+inline int emTiffTiledImageFileModel::GetLevelWidth(int level) const
+{
+	return Levels[level].Width;
+}
+
+inline int emTiffTiledImageFileModel::GetLevelHeight(int level) const
+{
+	return Levels[level].Height;
+}
+
+inline int emTiffTiledImageFileModel::GetLevelPartWidth(int level) const
+{
+	return Levels[level].PartW;
+}
+
+inline int emTiffTiledImageFileModel::GetLevelPartHeight(int level) const
+{
+	return Levels[level].PartH;
+}
+
+inline emUInt64 emTiffTiledImageFileModel::MakeTileKey(
+	int level, int reduction, int column, int row
+)
+{
+	int r;
+
+	for (r=0; (1<<r)<reduction; r++);
+	return
+		(((emUInt64)level)<<56) | (((emUInt64)r)<<48) |
+		(((emUInt64)row)<<24) | ((emUInt64)column)
+	;
+}
+
+inline int emTiffTiledImageFileModel::GetTileKeyLevel(emUInt64 tileKey)
+{
+	return (int)(tileKey>>56);
+}
+
+inline int emTiffTiledImageFileModel::GetTileKeyReduction(emUInt64 tileKey)
+{
+	return 1<<((int)(tileKey>>48)&0xff);
+}
+
+inline int emTiffTiledImageFileModel::GetTileKeyColumn(emUInt64 tileKey)
+{
+	return (int)(tileKey&0xffffff);
+}
+
+inline int emTiffTiledImageFileModel::GetTileKeyRow(emUInt64 tileKey)
+{
+	return (int)((tileKey>>24)&0xffffff);
+}
+
+inline const emImage * emTiffTiledImageFileModel::GetTile(
+	emUInt64 tileKey
+) const
+{
+	const CacheEntry * e;
+
+	e=Cache.GetValue(tileKey);
+	return e ? &e->Image : NULL;
+}
+
+inline const emSignal & emTiffTiledImageFileModel::GetTileSignal() const
+{
+	return TileSignal;
+}
+
+
+#endif
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+// emTiffTiledImagePanel.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emTiffTiledImagePanel_h
+#define emTiffTiledImagePanel_h
+
+#ifndef emFilePanel_h
+#include <emCore/emFilePanel.h>
+#endif
+
+#ifndef emTiffTiledImageFileModel_h
+#include <emTiff/emTiffTiledImageFileModel.h>
+#endif
+
+
+//==============================================================================
+//=========================== emTiffTiledImagePanel ============================
+//==============================================================================
+
+class emTiffTiledImagePanel : public emFilePanel {
+
+public:
+
+	// Panel for showing an emTiffTiledImageFileModel. Only the tiles
+	// intersecting the clipping rectangle of the panel are wanted from the
+	// model, at the resolution level and reduction factor matching the
+	// viewed size. Tiles which are not yet decoded are substituted by
+	// cached tiles of lower resolution. For having such substitutes soon,
+	// the tiles of a much lower resolution are wanted first.
+
+	emTiffTiledImagePanel(ParentArg parent, const emString & name,
+	                      emTiffTiledImageFileModel * fileModel=NULL,
+	                      bool updateFileModel=true);
+
+	virtual ~emTiffTiledImagePanel();
+
+	virtual void SetFileModel(emFileModel * fileModel,
+	                          bool updateFileModel=true);
+
+	virtual emString GetIconFileName() const;
+
+	virtual void GetEssenceRect(double * pX, double * pY,
+	                            double * pW, double * pH) const;
+
+protected:
+
+	virtual bool Cycle();
+
+	virtual void Notice(NoticeFlags flags);
+
+	virtual bool IsOpaque() const;
+
+	virtual void Paint(const emPainter & painter, emColor canvasColor) const;
+
+	virtual emPanel * CreateControlPanel(ParentArg parent,
+	                                     const emString & name);
+
+private:
+
+	bool GetImageRect(double * pX, double * pY, double * pW,
+	                  double * pH) const;
+
+	void UpdateWantedTiles();
+
+	void PaintTile(const emPainter & painter, emUInt64 tileKey,
+	               const emImage & image, double imgX, double imgY,
+	               double imgW, double imgH, emColor canvasColor) const;
+
+	bool PaintSubstitute(const emPainter & painter, emUInt64 tileKey,
+	                     double imgX, double imgY, double imgW,
+	                     double imgH, emColor canvasColor) const;
+
+	static int CmpTileDistances(const emUInt64 * key1,
+	                            const emUInt64 * key2, void * context);
+
+	emArray<emUInt64> WantedTiles;
+		// Tiles currently shown, in the order of decreasing importance.
+
+	emArray<emUInt64> PreviewTiles;
+		// Tiles of a coarser combination of level and reduction
+		// covering WantedTiles, wanted from the model before these.
+
+	emArray<emUInt64> SubstituteLevels;
+		// Combinations of resolution level and reduction factor (as
+		// tile keys with column and row zero) which are coarser than
+		// the one of WantedTiles, from fine to coarse.
+
+	double CenterX,CenterY;
+		// Center of the clipping rectangle in pixels of the wanted
+		// level (for sorting by distance).
+};
+
+
+#endif
@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+// emTmpConvCache.h
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef emTmpConvCache_h
+#define emTmpConvCache_h
+
+#ifndef emModel_h
+#include <emCore/emModel.h>
+#endif
+
+#ifndef emThread_h
+#include <emCore/emThread.h>
+#endif
+
+
+class emTmpConvCache : public emModel {
+
+public:
+
+	// Persistent cache of the results of emTmpConvModel. The entries are
+	// stored in the user configuration directory, and they are keyed by
+	// the path, the size and the modification time of the input file, the
+	// conversion command and the output file ending. The total size of the
+	// cache is limited, and the least recently used entries are removed
+	// first. Results containing symbolic links are not cached.
+
+	static emRef<emTmpConvCache> Acquire(emRootContext & rootContext);
+
+	static emString MakeKey(
+		const emString & inputFilePath, emUInt64 fileSize, time_t fileTime,
+		const emString & command, const emString & outputFileEnding
+	);
+
+	bool TryFetch(const char * key, const char * targetPath);
+		// If there is an entry for the key, copy it to the given path,
+		// which must not exist, mark the entry as used, and return
+		// true. Otherwise return false. This may be called by any
+		// thread.
+
+	void Store(const char * key, const char * sourcePath);
+		// Copy a conversion result (file or directory tree) into the
+		// cache, and remove old entries as far as the size limit
+		// requires. Errors are ignored, because the cache is just an
+		// optimization. This may be called by any thread.
+		//
+		// The entries are only scanned when the estimated total size
+		// exceeds the limit (and on the first store). The estimate is
+		// the result of the last scan plus the stores of this process.
+
+	class Transfer : public emThread {
+	public:
+		// Calls TryFetch or Store in a separate thread, so that copying
+		// a large result does not block the program. The cache must
+		// live longer than this object. The destructor waits for the
+		// thread.
+		enum TypeEnum {
+			FETCH,
+			STORE
+		};
+		Transfer(emTmpConvCache & cache, TypeEnum type,
+		         const emString & key, const emString & path);
+		virtual ~Transfer();
+		bool IsDone();
+		bool IsFetched() const;
+			// Whether the entry has been fetched. Valid when done.
+	protected:
+		virtual int Run(void * arg);
+	private:
+		emTmpConvCache & Cache;
+		TypeEnum Type;
+		emString Key;
+		emString Path;
+		bool Fetched;
+	};
+
+	enum {
+		MAX_TOTAL_SIZE_MB = 1024,
+			// Size limit of the whole cache in megabytes.
+		MAX_ENTRY_SIZE_MB = 256
+			// Larger results are not cached.
+	};
+
+protected:
+
+	emTmpConvCache(emContext & context, const emString & name);
+	virtual ~emTmpConvCache();
+
+private:
+
+	struct EntryInfo {
+		emString Path;
+		emUInt64 Size;
+		time_t LastUse;
+	};
+
+	emString GetEntryPath(const char * key) const;
+
+	static bool TryLoadInfo(
+		const emString & entryPath, const char * key, EntryInfo * info
+	);
+	static void TrySaveInfo(
+		const emString & entryPath, const char * key, emUInt64 size,
+		time_t lastUse
+	);
+
+	static bool TryCalcSize(const emString & path, emUInt64 * size);
+
+	void Shrink();
+
+	static int CompareLastUse(
+		const EntryInfo * info1, const EntryInfo * info2, void * context
+	);
+
+	emString DirPath;
+	emThreadMiniMutex TotalMutex;
+	emUInt64 Total;
+	bool TotalKnown;
+		// Estimated total size of the entries (see Store).
+};
+
+inline bool emTmpConvCache::Transfer::IsDone()
+{
+	return !IsRunning();
+}
+
+inline bool emTmpConvCache::Transfer::IsFetched() const
+{
+	return Fetched;
+}
+
+
+#endif
@@ -33,6 +33,10 @@
 #include <emFileMan/emFileManModel.h>
 #endif
 
+#ifndef emTmpConvCache_h
+#include <emTmpConv/emTmpConvCache.h>
+#endif
+
 class emTmpConvModelClient;
 
 
@@ -104,6 +108,7 @@ private:
 
 	emRef<emFileManModel> FileManModel;
 	emRef<emSigModel> UpdateSignalModel;
+	emRef<emTmpConvCache> Cache;
 	emString InputFilePath;
 	emString Command;
 	emString OutputFileEnding;
@@ -115,6 +120,8 @@ private:
 	bool TmpSelected;
 	time_t FileTime;
 	emUInt64 FileSize;
+	emString CacheKey;
+	emOwnPtr<emTmpConvCache::Transfer> CacheTransfer;
 	emOwnPtr<PSAgentClass> PSAgent;
 	emProcess Process;
 	emArray<char> ErrPipeBuf;
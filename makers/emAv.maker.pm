@@ -70,7 +70,6 @@ sub Build
 		"src/emAv/emAvFilePanel.cpp",
 		"src/emAv/emAvFpPlugin.cpp",
 		"src/emAv/emAvImageConverter.cpp",
-		"src/emAv/emAvImageConverter_AVX2.cpp",
 		"src/emAv/emAvLibDirCfg.cpp",
 		"src/emAv/emAvServerModel.cpp",
 		"src/emAv/emAvStates.cpp"
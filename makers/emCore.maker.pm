@@ -104,6 +104,8 @@ sub Build
 		"src/emCore/emPainter_ScTlIntGra.cpp",
 		"src/emCore/emPainter_ScTlIntImg.cpp",
 		"src/emCore/emPainter_ScTlIntImg_AVX2.cpp",
+		"src/emCore/emPainter_ScTlIntYuv.cpp",
+		"src/emCore/emPainter_ScTlIntYuv_AVX2.cpp",
 		"src/emCore/emPainter_ScTlPSCol.cpp",
 		"src/emCore/emPainter_ScTlPSCol_AVX2.cpp",
 		"src/emCore/emPainter_ScTlPSInt.cpp",
@@ -123,6 +125,7 @@ sub Build
 		"src/emCore/emScalarField.cpp",
 		"src/emCore/emScheduler.cpp",
 		"src/emCore/emScreen.cpp",
+		"src/emCore/emServerProcPool.cpp",
 		"src/emCore/emSigModel.cpp",
 		"src/emCore/emSignal.cpp",
 		"src/emCore/emSplitter.cpp",
@@ -132,6 +135,7 @@ sub Build
 		"src/emCore/emSubViewPanel.cpp",
 		"src/emCore/emTextField.cpp",
 		"src/emCore/emThread.cpp",
+		"src/emCore/emTileCache.cpp",
 		"src/emCore/emTiling.cpp",
 		"src/emCore/emTimer.cpp",
 		"src/emCore/emTmpFile.cpp",
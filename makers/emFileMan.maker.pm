@@ -62,9 +62,12 @@ sub Build
 		"src/emFileMan/emFileLinkPanel.cpp",
 		"src/emFileMan/emFileManConfig.cpp",
 		"src/emFileMan/emFileManControlPanel.cpp",
+		"src/emFileMan/emFileManJobEngine.cpp",
+		"src/emFileMan/emFileManJobsPanel.cpp",
 		"src/emFileMan/emFileManModel.cpp",
 		"src/emFileMan/emFileManSelInfoPanel.cpp",
 		"src/emFileMan/emFileManTheme.cpp",
+		"src/emFileMan/emFileManThumbnailCache.cpp",
 		"src/emFileMan/emFileManViewConfig.cpp"
 	)==0 or return 0;
 
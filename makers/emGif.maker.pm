@@ -42,6 +42,7 @@ sub Build
 		"--name"          , "emGif",
 		"src/emGif/emGifFileModel.cpp",
 		"src/emGif/emGifFilePanel.cpp",
+		"src/emGif/emGifFrameCache.cpp",
 		"src/emGif/emGifFpPlugin.cpp"
 	)==0 or return 0;
 
@@ -15,12 +15,21 @@ sub IsEssential
 
 sub GetFileHandlingRules
 {
-	return ();
+	return ('+exec:^lib/emOsm/emOsmDownloadProc$');
 }
 
 sub GetExtraBuildOptions
 {
-	return ();
+	return (
+		[
+			"emOsmDownloadProc",
+			"yes",
+			"emOsmDownloadProc=yes|no\n".
+			"  Whether to build the download helper of emOsm, which needs libcurl\n".
+			"  (default: yes). Without it, the curl program is run for each batch\n".
+			"  of tiles."
+		]
+	);
 }
 
 sub Build
@@ -53,5 +62,33 @@ sub Build
 		"src/emOsm/emOsmTilePanel.cpp"
 	)==0 or return 0;
 
+	if ($options{'emOsmDownloadProc'} eq 'yes') {
+		system(
+			'perl', "$options{'utils'}/MakeDirs.pl",
+			"lib/emOsm"
+		)==0 or return 0;
+
+		my @libCurlFlags=split("\n",readpipe(
+			"perl \"".$options{'utils'}."/PkgConfig.pl\" libcurl"
+		));
+		if (!@libCurlFlags) {
+			@libCurlFlags=("--link","curl");
+		}
+		system(
+			@{$options{'unicc_call'}},
+			"--bin-dir"       , "lib/emOsm",
+			"--lib-dir"       , "lib",
+			"--obj-dir"       , "obj",
+			"--inc-search-dir", "include",
+			@libCurlFlags,
+			"--type"          , "cexe",
+			"--name"          , "emOsmDownloadProc",
+			"src/emOsm/emOsmDownloadProc.c"
+		)==0 or return 0;
+	}
+	elsif ($options{'emOsmDownloadProc'} ne 'no') {
+		die("Illegal value for option 'emOsmDownloadProc', stopped");
+	}
+
 	return 1;
 }
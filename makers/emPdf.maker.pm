@@ -47,8 +47,11 @@ sub Build
 		"src/emPdf/emPdfFpPlugin.cpp",
 		"src/emPdf/emPdfPageAreasMap.cpp",
 		"src/emPdf/emPdfPagePanel.cpp",
+		"src/emPdf/emPdfSearch.cpp",
 		"src/emPdf/emPdfSelection.cpp",
-		"src/emPdf/emPdfServerModel.cpp"
+		"src/emPdf/emPdfServerModel.cpp",
+		"src/emPdf/emPdfTextIndex.cpp",
+		"src/emPdf/emPdfTileCache.cpp"
 	)==0 or return 0;
 
 	system(
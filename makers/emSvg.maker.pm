@@ -44,7 +44,8 @@ sub Build
 		"src/emSvg/emSvgFileModel.cpp",
 		"src/emSvg/emSvgFilePanel.cpp",
 		"src/emSvg/emSvgFpPlugin.cpp",
-		"src/emSvg/emSvgServerModel.cpp"
+		"src/emSvg/emSvgServerModel.cpp",
+		"src/emSvg/emSvgTileCache.cpp"
 	)==0 or return 0;
 
 	system(
@@ -2,10 +2,11 @@ package emTest;
 
 use strict;
 use warnings;
+use Config;
 
 sub GetDependencies
 {
-	return ('emCore');
+	return ('emCore','emText','emOsm','emPng','emJpeg');
 }
 
 sub IsEssential
@@ -94,6 +95,70 @@ sub Build
 			"--name"          , "emTestThreads",
 			"src/emTest/emTestThreads.cpp"
 		)==0 or return 0;
+		system(
+			@{$options{'unicc_call'}},
+			"--math",
+			"--rtti",
+			"--exceptions",
+			"--bin-dir"       , "bin",
+			"--lib-dir"       , "lib",
+			"--obj-dir"       , "obj",
+			"--inc-search-dir", "include",
+			"--link"          , "emCore",
+			"--link"          , "emText",
+			"--type"          , "cexe",
+			"--name"          , "emTestTextIndex",
+			"src/emTest/emTestTextIndex.cpp"
+		)==0 or return 0;
+		system(
+			@{$options{'unicc_call'}},
+			"--math",
+			"--rtti",
+			"--exceptions",
+			"--bin-dir"       , "bin",
+			"--lib-dir"       , "lib",
+			"--obj-dir"       , "obj",
+			"--inc-search-dir", "include",
+			"--link"          , "emCore",
+			"--link"          , "emText",
+			"--type"          , "cexe",
+			"--name"          , "emTestTextSearch",
+			"src/emTest/emTestTextSearch.cpp"
+		)==0 or return 0;
+		system(
+			@{$options{'unicc_call'}},
+			"--math",
+			"--rtti",
+			"--exceptions",
+			"--bin-dir"       , "bin",
+			"--lib-dir"       , "lib",
+			"--obj-dir"       , "obj",
+			"--inc-search-dir", "include",
+			"--link"          , "emCore",
+			"--type"          , "cexe",
+			"--name"          , "emTestTextField",
+			"src/emTest/emTestTextField.cpp"
+		)==0 or return 0;
+		system(
+			@{$options{'unicc_call'}},
+			"--math",
+			"--rtti",
+			"--exceptions",
+			"--bin-dir"       , "bin",
+			"--lib-dir"       , "lib",
+			"--obj-dir"       , "obj",
+			"--inc-search-dir", "include",
+			"--link"          , "emCore",
+			"--link"          , "emOsm",
+			"--link"          , "emPng",
+			"--link"          , "emJpeg",
+			$Config{'osname'} eq 'MSWin32' ? (
+				"--link"        , "ws2_32"
+			):(),
+			"--type"          , "cexe",
+			"--name"          , "emTestOsmDownload",
+			"src/emTest/emTestOsmDownload.cpp"
+		)==0 or return 0;
 	}
 	elsif ($options{'all-from-emTest'} ne 'no') {
 		die("Illegal value for option 'all-from-emTest', stopped");
@@ -42,8 +42,12 @@ sub Build
 		"--name"          , "emText",
 		"src/emText/emTextFileControlPanel.cpp",
 		"src/emText/emTextFileModel.cpp",
+		"src/emText/emTextFileModel_AVX2.cpp",
 		"src/emText/emTextFilePanel.cpp",
-		"src/emText/emTextFpPlugin.cpp"
+		"src/emText/emTextFpPlugin.cpp",
+		"src/emText/emTextRegEx.cpp",
+		"src/emText/emTextSearch.cpp",
+		"src/emText/emTextSearch_AVX2.cpp"
 	)==0 or return 0;
 
 	return 1;
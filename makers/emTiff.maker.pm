@@ -71,7 +71,9 @@ sub Build
 		"--type"          , "dynlib",
 		"--name"          , "emTiff",
 		"src/emTiff/emTiffFpPlugin.cpp",
-		"src/emTiff/emTiffImageFileModel.cpp"
+		"src/emTiff/emTiffImageFileModel.cpp",
+		"src/emTiff/emTiffTiledImageFileModel.cpp",
+		"src/emTiff/emTiffTiledImagePanel.cpp"
 	)==0 or return 0;
 
 	return 1;
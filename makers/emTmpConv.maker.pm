@@ -42,6 +42,7 @@ sub Build
 		"--link"          , "emCore",
 		"--type"          , "dynlib",
 		"--name"          , "emTmpConv",
+		"src/emTmpConv/emTmpConvCache.cpp",
 		"src/emTmpConv/emTmpConvFpPlugin.cpp",
 		"src/emTmpConv/emTmpConvFramePanel.cpp",
 		"src/emTmpConv/emTmpConvModel.cpp",
@@ -488,6 +488,32 @@ function SendSelectCS(files)
 }
 
 
+function SendJob(op,files)
+	// Require Eagle Mode to run a file job in-process and in the background,
+	// instead of running a program in a terminal. The progress is shown in
+	// the control panel of the file manager, and the resulting files are
+	// selected when the job has finished.
+	// Arguments: "copy" or "move", [<target>, <source>, <source>...]
+	//       or:  "remove", [<file>, <file>...]
+{
+	var env=WshShell.Environment("PROCESS");
+	var args=new Array;
+	args[0]=env("EM_DIR") + "\\bin\\emSendMiniIpc.exe";
+	args[1]=env("EM_FM_SERVER_NAME");
+	args[2]=op;
+	args[3]=env("EM_COMMAND_RUN_ID");
+	args=args.concat(files);
+	var ret=WshShell.Run(WshShellCmdFromArgs(args),1,true);
+	if (ret != 0) {
+		Error(
+			"Failed to send the job to Eagle Mode with emSendMiniIpc.\n"+
+			"\n"+
+			"Nothing has been done."
+		);
+	}
+}
+
+
 //=============================== Basic dialogs ================================
 
 function StartDlg(argsArray)
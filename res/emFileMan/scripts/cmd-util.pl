@@ -259,6 +259,31 @@ sub SendSelectCS
 }
 
 
+sub SendJob
+	# Require Eagle Mode to run a file job in-process and in the background,
+	# instead of running a program in a terminal. The progress is shown in
+	# the control panel of the file manager, and the resulting files are
+	# selected when the job has finished.
+	# Arguments: "copy" or "move", <target>, <source>, [<source>...]
+	#       or:  "remove", <file>, [<file>...]
+{
+	my $ret=system(
+		catfile($ENV{'EM_DIR'},"bin","emSendMiniIpc"),
+		$ENV{'EM_FM_SERVER_NAME'},
+		$_[0],
+		$ENV{'EM_COMMAND_RUN_ID'},
+		@_[1..$#_]
+	);
+	if ($ret != 0) {
+		Error(
+			"Failed to send the job to Eagle Mode with emSendMiniIpc.\n".
+			"\n".
+			"Nothing has been done."
+		);
+	}
+}
+
+
 #================================ Basic dialogs ================================
 
 sub Dlg
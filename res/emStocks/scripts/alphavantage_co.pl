@@ -17,18 +17,35 @@ use Time::HiRes;
 use Time::Local;
 
 
+#---------------------- Helper for failing without retries ---------------------
+# Exit status 200 tells emStocks that trying again would not help (e.g. invalid
+# API key). Other failures (e.g. network errors, HTTP 5xx) are tried again.
+
+sub dieNoRetry
+{
+	print STDERR $_[0]."\n";
+	exit(200);
+}
+
+sub isPermanentHttpError
+{
+	my $code=$_[0];
+	return $code >= 400 && $code < 500 && $code != 408 && $code != 429;
+}
+
+
 #------------------------------- Parse arguments -------------------------------
 
 if (@ARGV != 3) {
-	die("Three arguments required: symbol, start date, and API key,");
+	dieNoRetry("Three arguments required: symbol, start date, and API key,");
 }
 my $symbol   =$ARGV[0];
 my $startDate=$ARGV[1];
 my $apiKey   =$ARGV[2];
 
-if ($symbol eq "") { die("Symbol is empty,"); }
-if ($startDate eq "") { die("Start date is empty,"); }
-if ($apiKey eq "") { die("API key is empty,"); }
+if ($symbol eq "") { dieNoRetry("Symbol is empty,"); }
+if ($startDate eq "") { dieNoRetry("Start date is empty,"); }
+if ($apiKey eq "") { dieNoRetry("API key is empty,"); }
 
 
 #-------------- Calculate number of days from start date to today --------------
@@ -76,7 +93,12 @@ my $url=
 
 my $ua=LWP::UserAgent->new;
 my $response=$ua->get($url);
-if (!$response->is_success) { die($response->status_line); }
+if (!$response->is_success) {
+	if (isPermanentHttpError($response->code)) {
+		dieNoRetry($response->status_line);
+	}
+	die($response->status_line);
+}
 
 
 #------------------------------- Transform data --------------------------------
@@ -96,6 +118,15 @@ foreach my $line (split(/\n/,$response->content())) {
 }
 
 if (!$anyValidLineFound) {
+	# An invalid API key or symbol is reported with HTTP status 200 and an
+	# "Error Message", while exceeding the rate limit gives a "Note" or an
+	# "Information" and may be tried again.
+	if ($response->content() =~ /"Error Message"/) {
+		dieNoRetry(
+			"Error response from server:\n".
+			substr($response->content(),0,700)."\n,"
+		);
+	}
 	die(
 		"Unexpected response from server:\n".
 		substr($response->content(),0,700)."\n,"
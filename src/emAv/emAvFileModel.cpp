@@ -79,6 +79,8 @@ void emAvFileModel::SetPlayState(PlayStateType playState)
 		PlayPos=0;
 		Signal(PlayPosSignal);
 		Image.Clear();
+		ImageU.Clear();
+		ImageV.Clear();
 		Signal(ImageSignal);
 	}
 	else {
@@ -326,6 +328,8 @@ void emAvFileModel::ResetData()
 	Signal(AdjustmentSignal);
 
 	Image.Clear();
+	ImageU.Clear();
+	ImageV.Clear();
 	Tallness=1.0;
 	Signal(ImageSignal);
 }
@@ -416,6 +420,8 @@ void emAvFileModel::StreamStateChanged(StreamStateType streamState)
 		}
 		if (!Image.IsEmpty()) {
 			Image.Clear();
+			ImageU.Clear();
+			ImageV.Clear();
 			Signal(ImageSignal);
 		}
 		SaveFileState();
@@ -520,6 +526,8 @@ void emAvFileModel::PropertyChanged(const emString & name, const emString & valu
 				PlayPos=0;
 				Signal(PlayPosSignal);
 				Image.Clear();
+				ImageU.Clear();
+				ImageV.Clear();
 				Signal(ImageSignal);
 			}
 		}
@@ -589,6 +597,21 @@ void emAvFileModel::PropertyChanged(const emString & name, const emString & valu
 void emAvFileModel::ShowFrame(const emImage & image, double tallness)
 {
 	Image=image;
+	ImageU.Clear();
+	ImageV.Clear();
+	Tallness=tallness;
+	Signal(ImageSignal);
+}
+
+
+void emAvFileModel::ShowYuvFrame(
+	const emImage & imageY, const emImage & imageU, const emImage & imageV,
+	double tallness
+)
+{
+	Image=imageY;
+	ImageU=imageU;
+	ImageV=imageV;
 	Tallness=tallness;
 	Signal(ImageSignal);
 }
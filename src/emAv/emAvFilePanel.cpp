@@ -698,6 +698,20 @@ void emAvFilePanel::Paint(const emPainter & painter, emColor canvasColor) const
 		painter.PaintRect(EX,EY,EW,EH,c1,canvasColor);
 		canvasColor=c1;
 	}
+	else if (!fm->GetImageU().IsEmpty()) {
+		painter.PaintRect(
+			EX,EY,EW,EH,
+			emImageYuvTexture(
+				EX,EY,EW,EH,
+				*image,fm->GetImageU(),fm->GetImageV(),255,
+				emTexture::EXTEND_EDGE,
+				emTexture::DQ_BY_CONFIG,
+				emTexture::UQ_BY_CONFIG_FOR_VIDEO
+			),
+			canvasColor
+		);
+		canvasColor=0;
+	}
 	else {
 		painter.PaintRect(
 			EX,EY,EW,EH,
@@ -19,12 +19,10 @@
 //------------------------------------------------------------------------------
 
 #include <emAv/emAvImageConverter.h>
-#include <emCore/emCoreConfig.h>
 
 
-emAvImageConverter::emAvImageConverter(emContext & context)
-	: CoreConfig(emCoreConfig::Acquire(context.GetRootContext())),
-	Format(0),
+emAvImageConverter::emAvImageConverter()
+	: Format(0),
 	Width(0),
 	Height(0),
 	BPL(0),
@@ -33,12 +31,11 @@ emAvImageConverter::emAvImageConverter(emContext & context)
 	Plane2(NULL),
 	Plane3(NULL),
 	Image(NULL),
+	ImageU(NULL),
+	ImageV(NULL),
 	RowsAtOnce(0),
 	PosY(0)
 {
-#	if EM_HAVE_X86_INTRINSICS
-		CanCpuDoAvx2=emCanCpuDoAvx2();
-#	endif
 }
 
 
@@ -87,24 +84,39 @@ void emAvImageConverter::SetSourceYUY2(
 }
 
 
-void emAvImageConverter::SetTarget(emImage * image)
+void emAvImageConverter::SetTarget(
+	emImage * image, emImage * imageU, emImage * imageV
+)
 {
 	Image=image;
+	ImageU=imageU;
+	ImageV=imageV;
 }
 
 
 void emAvImageConverter::Convert(emRenderThreadPool * renderThreadPool)
 {
-	if (
-		Image->GetWidth()!=Width|| Image->GetHeight()!=Height ||
-		Image->GetChannelCount()!=3
-	) {
-		Image->Setup(Width,Height,3);
+	switch (Format) {
+	case 0:
+		SetupImage(Image,Width,Height,3);
+		ImageU->Clear();
+		ImageV->Clear();
+		break;
+	case 1:
+		SetupImage(Image,Width,Height,1);
+		SetupImage(ImageU,Width/2,Height/2,1);
+		SetupImage(ImageV,Width/2,Height/2,1);
+		break;
+	default:
+		SetupImage(Image,Width,Height,1);
+		SetupImage(ImageU,Width/2,Height,1);
+		SetupImage(ImageV,Width/2,Height,1);
+		break;
 	}
 
 	PosY=Height;
 
-	if (Format==0 || Height<128) {
+	if (Format!=2 || Height<128) {
 		RowsAtOnce=Height;
 		ThreadRun();
 		return;
@@ -137,12 +149,6 @@ void emAvImageConverter::ThreadRun()
 			ConvertRGB(y1,y2);
 			break;
 		case 1:
-#			if EM_HAVE_X86_INTRINSICS
-				if (CanCpuDoAvx2 && CoreConfig->AllowSIMD.Get()) {
-					ConvertI420_AVX2(y1,y2);
-					break;
-				}
-#			endif
 			ConvertI420(y1,y2);
 			break;
 		default:
@@ -172,66 +178,20 @@ void emAvImageConverter::ConvertRGB(int y1, int y2)
 
 void emAvImageConverter::ConvertI420(int y1, int y2)
 {
-	const emByte * sy, * syBeg, * su, * sv;
-	emByte * t;
-	int duv,cu,cv,cy,cr,cg,cb,cr1,cg1,cb1,c;
+	emByte * mapY, * mapU, * mapV;
+	int w2;
 
+	mapY=Image->GetWritableMap();
+	mapU=ImageU->GetWritableMap();
+	mapV=ImageV->GetWritableMap();
+	w2=Width/2;
 	while (y1<y2) {
 		y2--;
-		t=Image->GetWritableMap()+((y2+1)*Width-2)*3;
-		syBeg=Plane+y2*BPL;
-		sy=syBeg+Width-2;
-		su=Plane2+(y2>>1)*BPL2+((Width-2)>>1);
-		sv=Plane3+(y2>>1)*BPL2+((Width-2)>>1);
-		duv=0;
-		if (y2&1) {
-			if (y2<Height-1) duv=BPL2;
-		}
-		else {
-			if (y2>0) duv=-BPL2;
+		memcpy(mapY+y2*Width,Plane+y2*BPL,Width);
+		if (!(y2&1)) {
+			memcpy(mapU+(y2>>1)*w2,Plane2+(y2>>1)*BPL2,w2);
+			memcpy(mapV+(y2>>1)*w2,Plane3+(y2>>1)*BPL2,w2);
 		}
-		cu=su[0]*3+su[duv];
-		cv=sv[0]*3+sv[duv];
-		cr=409*cv+(128*4-16*298*4-409*512);
-		cg=-100*cu-208*cv+(128*4-16*298*4+100*512+208*512);
-		cb=516*cu+(128*4-16*298*4-516*512);
-		do {
-			cr1=cr;
-			cg1=cg;
-			cb1=cb;
-			cu=su[0]*3+su[duv];
-			cv=sv[0]*3+sv[duv];
-			cr=409*cv+(128*4-16*298*4-409*512);
-			cg=-100*cu-208*cv+(128*4-16*298*4+100*512+208*512);
-			cb=516*cu+(128*4-16*298*4-516*512);
-
-			cy=sy[1]*(298*8);
-			c=(cr+cr1+cy)>>11;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[3]=(emByte)c;
-			c=(cg+cg1+cy)>>11;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[4]=(emByte)c;
-			c=(cb+cb1+cy)>>11;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[5]=(emByte)c;
-
-			cy=sy[0]*(298*4);
-			c=(cr+cy)>>10;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[0]=(emByte)c;
-			c=(cg+cy)>>10;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[1]=(emByte)c;
-			c=(cb+cy)>>10;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[2]=(emByte)c;
-
-			su--;
-			sv--;
-			sy-=2;
-			t-=6;
-		} while (sy>=syBeg);
 	}
 }
 
@@ -239,46 +199,39 @@ void emAvImageConverter::ConvertI420(int y1, int y2)
 void emAvImageConverter::ConvertYUY2(int y1, int y2)
 {
 	const emByte * s;
-	emByte * map, * t, * te;
-	int cy,cu,cv,cr,cg,cb,c;
+	emByte * ty, * tu, * tv, * te;
+	int w2;
 
-	map=Image->GetWritableMap();
+	w2=Width/2;
 	while (y1<y2) {
 		y2--;
 		s=Plane+y2*BPL;
-		t=map+y2*Width*3;
-		te=t+Width*3;
+		ty=Image->GetWritableMap()+y2*Width;
+		tu=ImageU->GetWritableMap()+y2*w2;
+		tv=ImageV->GetWritableMap()+y2*w2;
+		te=tu+w2;
 		do {
-			cu=s[1]-128;
-			cv=s[3]-128;
-			cr=409*cv+(128-16*298);
-			cg=-100*cu-208*cv+(128-16*298);
-			cb=516*cu+(128-16*298);
-
-			cy=s[0]*298;
-			c=(cr+cy)>>8;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[0]=(emByte)c;
-			c=(cg+cy)>>8;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[1]=(emByte)c;
-			c=(cb+cy)>>8;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[2]=(emByte)c;
-
-			cy=s[2]*298;
-			c=(cr+cy)>>8;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[3]=(emByte)c;
-			c=(cg+cy)>>8;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[4]=(emByte)c;
-			c=(cb+cy)>>8;
-			if ((unsigned)c>255) c=(-c)>>16;
-			t[5]=(emByte)c;
-
+			ty[0]=s[0];
+			tu[0]=s[1];
+			ty[1]=s[2];
+			tv[0]=s[3];
 			s+=4;
-			t+=6;
-		} while (t<te);
+			ty+=2;
+			tu++;
+			tv++;
+		} while (tu<te);
+	}
+}
+
+
+void emAvImageConverter::SetupImage(
+	emImage * image, int width, int height, int channelCount
+)
+{
+	if (
+		image->GetWidth()!=width || image->GetHeight()!=height ||
+		image->GetChannelCount()!=channelCount
+	) {
+		image->Setup(width,height,channelCount);
 	}
 }
@@ -25,6 +25,7 @@
 #	include <windows.h>
 #else
 #	include <sys/shm.h>
+#	include <time.h>
 #endif
 
 
@@ -41,8 +42,7 @@ emAvServerModel::emAvServerModel(
 )
 	: emModel(context,serverProcPath),
 	LibDirCfg(serverProcPath),
-	StateTimer(GetScheduler()),
-	ImageConverter(context)
+	StateTimer(GetScheduler())
 {
 	int i;
 
@@ -242,7 +242,11 @@ emAvServerModel::Instance * emAvServerModel::TryOpenInstance(
 	inst->Client=NULL;
 	inst->ShmAttachState=SA_DETACHED;
 	inst->MinShmSize=0;
+	inst->MaxShmSlots=1;
 	inst->ShmSize=0;
+	inst->ShmSlotCount=0;
+	inst->ShmSlotSize=0;
+	inst->ShmReadSlot=0;
 #if defined(_WIN32) || defined(__CYGWIN__)
 	inst->ShmId[0]=0;
 	inst->ShmHdl=NULL;
@@ -456,6 +460,9 @@ void emAvServerModel::HandleMessage(
 		inst->MinShmSize=atoi(data);
 		UpdateShm(inst);
 	}
+	else if (strcmp(tag,"framering")==0) {
+		inst->MaxShmSlots=emMax(1,emMin(atoi(data),(int)MAX_SHM_RING_SLOTS));
+	}
 	else if (strcmp(tag,"error")==0) {
 		if (inst->Client) inst->Client->SetStreamErrored(data);
 	}
@@ -470,10 +477,12 @@ void emAvServerModel::HandleMessage(
 
 void emAvServerModel::UpdateShm(Instance * inst)
 {
+	emString params;
+
 	if (inst->ShmAttachState==SA_DETACHED) {
-		if (inst->ShmSize<inst->MinShmSize) {
+		if (GetShmFrameCapacity(inst)<inst->MinShmSize) {
 			DeleteShm(inst);
-			inst->ShmSize=inst->MinShmSize;
+			inst->ShmSize=CalcShmSize(inst);
 		}
 		if (inst->ShmSize>0 && !inst->ShmAddr && inst->Client) {
 			try {
@@ -483,19 +492,20 @@ void emAvServerModel::UpdateShm(Instance * inst)
 				if (inst->Client) inst->Client->SetStreamErrored(exception.GetText());
 				return;
 			}
-			SendCommand(
-				inst,"attachshm",
 #if defined(_WIN32) || defined(__CYGWIN__)
-				emString::Format("%s:%d",inst->ShmId,inst->ShmSize)
+			params=emString::Format("%s:%d",inst->ShmId,inst->ShmSize);
 #else
-				emString::Format("%d:%d",inst->ShmId,inst->ShmSize)
+			params=emString::Format("%d:%d",inst->ShmId,inst->ShmSize);
 #endif
-			);
+			if (inst->ShmSlotCount>1) {
+				params+=emString::Format(":%d",inst->ShmSlotCount);
+			}
+			SendCommand(inst,"attachshm",params);
 			inst->ShmAttachState=SA_ATTACHING;
 		}
 	}
 	else if (inst->ShmAttachState==SA_ATTACHED) {
-		if (inst->ShmSize<inst->MinShmSize || !inst->Client) {
+		if (GetShmFrameCapacity(inst)<inst->MinShmSize || !inst->Client) {
 			SendCommand(inst,"detachshm","");
 			inst->ShmAttachState=SA_DETACHING;
 		}
@@ -503,6 +513,26 @@ void emAvServerModel::UpdateShm(Instance * inst)
 }
 
 
+int emAvServerModel::CalcShmSize(const Instance * inst)
+{
+	int slots;
+
+	slots=emMin(inst->MaxShmSlots,(int)SHM_RING_SLOTS);
+	if (inst->MinShmSize<=0 || slots<=1) return inst->MinShmSize;
+	return
+		SHM_RING_HEADER_SIZE +
+		slots*((inst->MinShmSize+SHM_RING_SLOT_ALIGN-1)&~(SHM_RING_SLOT_ALIGN-1))
+	;
+}
+
+
+int emAvServerModel::GetShmFrameCapacity(const Instance * inst)
+{
+	if (inst->ShmSlotCount>1) return inst->ShmSlotSize;
+	return inst->ShmSize;
+}
+
+
 void emAvServerModel::TryCreateShm(Instance * inst)
 {
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -510,6 +540,7 @@ void emAvServerModel::TryCreateShm(Instance * inst)
 	static emThreadMiniMutex sharedCounterMutex;
 	static unsigned long sharedCounter=0;
 	unsigned long counter;
+	int i;
 
 	sharedCounterMutex.Lock();
 	counter=sharedCounter++;
@@ -556,6 +587,8 @@ void emAvServerModel::TryCreateShm(Instance * inst)
 
 #else
 
+	int i;
+
 	inst->ShmId=shmget(IPC_PRIVATE,inst->ShmSize,IPC_CREAT|0600);
 	if (inst->ShmId==-1) {
 		throw emException(
@@ -586,7 +619,24 @@ void emAvServerModel::TryCreateShm(Instance * inst)
 
 #endif
 
-	inst->ShmAddr[0]=0;
+	inst->ShmSlotCount=emMin(inst->MaxShmSlots,(int)SHM_RING_SLOTS);
+	if (
+		inst->ShmSlotCount>1 &&
+		inst->ShmSize>=CalcShmSize(inst)
+	) {
+		inst->ShmSlotSize=
+			((inst->ShmSize-SHM_RING_HEADER_SIZE)/inst->ShmSlotCount) &
+			~(SHM_RING_SLOT_ALIGN-1)
+		;
+		memset(inst->ShmAddr,0,SHM_RING_HEADER_SIZE);
+		for (i=0; i<inst->ShmSlotCount; i++) GetShmSlot(inst,i)[0]=0;
+	}
+	else {
+		inst->ShmSlotCount=1;
+		inst->ShmSlotSize=inst->ShmSize;
+		inst->ShmAddr[0]=0;
+	}
+	inst->ShmReadSlot=0;
 }
 
 
@@ -637,6 +687,9 @@ void emAvServerModel::DeleteShm(Instance * inst)
 #endif
 
 	inst->ShmSize=0;
+	inst->ShmSlotCount=0;
+	inst->ShmSlotSize=0;
+	inst->ShmReadSlot=0;
 }
 
 
@@ -648,23 +701,56 @@ void emAvServerModel::TransferFrames()
 	//??? Too much polling - better have a list!
 	for (i=0; i<MAX_INSTANCES; i++) {
 		inst=Instances[i];
-		if (inst && inst->ShmAddr && inst->ShmAddr[0]) {
-			TransferFrame(inst);
+		if (!inst || !inst->ShmAddr) continue;
+		if (inst->ShmSlotCount>1) {
+			TransferRingFrame(inst);
+		}
+		else if (inst->ShmAddr[0]) {
+			TransferFrame(inst,inst->ShmAddr,inst->ShmSize);
 			inst->ShmAddr[0]=0;
 		}
 	}
 }
 
 
-void emAvServerModel::TransferFrame(Instance * inst)
+void emAvServerModel::TransferRingFrame(Instance * inst)
+{
+	emUInt64 now,t;
+	int * slot;
+	int i,n,due;
+
+	// Find the newest frame which is due. Older frames which are due are
+	// late and skipped, and frames which are not yet due are kept in the
+	// ring until a later time slice.
+	n=inst->ShmSlotCount;
+	now=GetFrameClock();
+	due=-1;
+	for (i=0; i<n; i++) {
+		slot=GetShmSlot(inst,(inst->ShmReadSlot+i)%n);
+		if (!slot[0]) break;
+		t=GetShmSlotTime(inst,(inst->ShmReadSlot+i)%n);
+		if (t>now && t-now<=(emUInt64)MAX_FRAME_AHEAD_MILLISECS*1000) break;
+		due=i;
+	}
+	if (due<0) return;
+
+	for (i=0; i<due; i++) {
+		GetShmSlot(inst,inst->ShmReadSlot)[0]=0;
+		inst->ShmReadSlot=(inst->ShmReadSlot+1)%n;
+	}
+	slot=GetShmSlot(inst,inst->ShmReadSlot);
+	TransferFrame(inst,slot,inst->ShmSlotSize);
+	slot[0]=0;
+	inst->ShmReadSlot=(inst->ShmReadSlot+1)%n;
+}
+
+
+void emAvServerModel::TransferFrame(Instance * inst, const int * shm, int size)
 {
-	int * shm;
 	const emByte * src, * src2, * src3;
 	int width,height,aspectRatio,format,bpl,bpl2,width2,height2;
 	int padding1,padding2,padding3;
 
-	shm=inst->ShmAddr;
-
 	width=shm[1];
 	if (width<1 || width>4096) goto L_BAD_DATA;
 
@@ -691,7 +777,7 @@ void emAvServerModel::TransferFrame(Instance * inst)
 		bpl=shm[5];
 		padding1=shm[6];
 		if (bpl<3*width) goto L_BAD_DATA;
-		if ((int)sizeof(int)*7+padding1+bpl*height>inst->ShmSize) goto L_BAD_DATA;
+		if ((int)sizeof(int)*7+padding1+bpl*height>size) goto L_BAD_DATA;
 		src=((emByte*)(shm+7))+padding1;
 		ImageConverter.SetSourceRGB(width,height,bpl,src);
 	}
@@ -708,7 +794,7 @@ void emAvServerModel::TransferFrame(Instance * inst)
 		if (bpl2<width2) goto L_BAD_DATA;
 		if (
 			(int)sizeof(int)*10+padding1+padding2+padding3+bpl*height+2*bpl2*height2 >
-			inst->ShmSize
+			size
 		) goto L_BAD_DATA;
 		src=((emByte*)(shm+10))+padding1;
 		src2=src+bpl*height+padding2;
@@ -720,7 +806,7 @@ void emAvServerModel::TransferFrame(Instance * inst)
 		padding1=shm[6];
 		if (width<2) goto L_BAD_DATA;
 		if (bpl<2*width) goto L_BAD_DATA;
-		if ((int)sizeof(int)*7+padding1+bpl*height>inst->ShmSize) goto L_BAD_DATA;
+		if ((int)sizeof(int)*7+padding1+bpl*height>size) goto L_BAD_DATA;
 		src=((emByte*)(shm+7))+padding1;
 		ImageConverter.SetSourceYUY2(width,height,bpl,src);
 	}
@@ -728,17 +814,63 @@ void emAvServerModel::TransferFrame(Instance * inst)
 		goto L_BAD_DATA;
 	}
 
-	ImageConverter.SetTarget(&inst->Image);
+	ImageConverter.SetTarget(&inst->Image,&inst->ImageU,&inst->ImageV);
 
 	ImageConverter.Convert(ThreadPool);
 
 	if (inst->Client) {
-		inst->Client->ShowFrame(inst->Image,65536.0/aspectRatio);
+		if (ImageConverter.IsSourceYUV()) {
+			inst->Client->ShowYuvFrame(
+				inst->Image,inst->ImageU,inst->ImageV,65536.0/aspectRatio
+			);
+		}
+		else {
+			inst->Client->ShowFrame(inst->Image,65536.0/aspectRatio);
+		}
 	}
 	return;
 
 L_BAD_DATA:
 	emDLog("emAvServerModel::TransferFrame: Bad data!");
 	inst->Image.Clear();
+	inst->ImageU.Clear();
+	inst->ImageV.Clear();
 	if (inst->Client) inst->Client->ShowFrame(inst->Image,3.0/4.0);
 }
+
+
+int * emAvServerModel::GetShmSlot(const Instance * inst, int slot)
+{
+	return (int*)(
+		((char*)inst->ShmAddr) + SHM_RING_HEADER_SIZE + slot*inst->ShmSlotSize
+	);
+}
+
+
+emUInt64 emAvServerModel::GetShmSlotTime(const Instance * inst, int slot)
+{
+	return
+		(((emUInt64)(emUInt32)inst->ShmAddr[4+2*slot])<<32) |
+		(emUInt32)inst->ShmAddr[5+2*slot]
+	;
+}
+
+
+emUInt64 emAvServerModel::GetFrameClock()
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+	LARGE_INTEGER cnt,frq;
+
+	QueryPerformanceCounter(&cnt);
+	QueryPerformanceFrequency(&frq);
+	return
+		((emUInt64)cnt.QuadPart)/frq.QuadPart*1000000 +
+		((emUInt64)cnt.QuadPart)%frq.QuadPart*1000000/frq.QuadPart
+	;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ((emUInt64)ts.tv_sec)*1000000+ts.tv_nsec/1000;
+#endif
+}
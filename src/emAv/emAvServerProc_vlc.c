@@ -28,6 +28,7 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 #include <vlc/libvlc_version.h>
 #include <vlc/vlc.h>
@@ -118,6 +119,10 @@ static void emAvStopTimeoutThread()
 /*============================= emAvVideoAdapter =============================*/
 /*============================================================================*/
 
+#define EM_AV_MAX_RING_SLOTS 16
+#define EM_AV_RING_HEADER_SIZE 256
+#define EM_AV_RING_SLOT_ALIGN 64
+
 typedef struct {
 	pthread_mutex_t Mutex;
 	int MinShmSize;
@@ -126,6 +131,9 @@ typedef struct {
 	HANDLE ShmHdl;
 #endif
 	void * ShmPtr;
+	int ShmSlotCount;
+	int ShmSlotSize;
+	int ShmWriteSlot;
 	int DummyMemSize;
 	char * DummyMem;
 	int OutputEnabled;
@@ -299,6 +307,69 @@ static unsigned emAvVideoFormatCb(
 }
 
 
+static unsigned long long emAvGetFrameClock()
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+	LARGE_INTEGER cnt,frq;
+
+	QueryPerformanceCounter(&cnt);
+	QueryPerformanceFrequency(&frq);
+	return
+		((unsigned long long)cnt.QuadPart)/frq.QuadPart*1000000 +
+		((unsigned long long)cnt.QuadPart)%frq.QuadPart*1000000/frq.QuadPart
+	;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ((unsigned long long)ts.tv_sec)*1000000+ts.tv_nsec/1000;
+#endif
+}
+
+
+static int * emAvGetShmFrame(emAvVideoAdapter * v)
+{
+	int * pi;
+
+	/* Get the frame buffer in the shared memory which is to be written
+	   next, or NULL if there is none free. */
+
+	pi=(int*)v->ShmPtr;
+	if (!pi) return NULL;
+	if (v->ShmSlotCount>1) {
+		if (v->ShmSlotSize<v->MinShmSize) return NULL;
+		pi=(int*)(
+			((char*)pi)+EM_AV_RING_HEADER_SIZE+v->ShmWriteSlot*v->ShmSlotSize
+		);
+	}
+	else {
+		if (v->ShmSize<v->MinShmSize) return NULL;
+	}
+	if (pi[0]) return NULL;
+	return pi;
+}
+
+
+static void emAvPublishShmFrame(emAvVideoAdapter * v, int * pi)
+{
+	unsigned long long t;
+	int * hdr;
+
+	/* Hand a written frame buffer over to the client. In ring mode, the
+	   frame is stamped with the presentation time, which is now because
+	   we are called at display time. */
+
+	if (v->ShmSlotCount>1) {
+		t=emAvGetFrameClock();
+		hdr=(int*)v->ShmPtr;
+		hdr[4+2*v->ShmWriteSlot]=(int)(t>>32);
+		hdr[5+2*v->ShmWriteSlot]=(int)t;
+		v->ShmWriteSlot=(v->ShmWriteSlot+1)%v->ShmSlotCount;
+	}
+	pi[0]=1;
+}
+
+
 static void emAvVideoCleanupCb(void * opaque)
 {
 }
@@ -328,8 +399,8 @@ static void * emAvVideoLockCb(void * opaque, void * * planes)
 		v->PauseCountDown=0;
 	}
 
-	pi=(int*)v->ShmPtr;
-	if (!showFrame || !pi || v->ShmSize<v->MinShmSize || pi[0]) {
+	pi=showFrame ? emAvGetShmFrame(v) : NULL;
+	if (!pi) {
 		EM_AV_LOG("*** Leaving out a frame ***");
 		if (v->DummyMemSize<v->MinShmSize) {
 			v->DummyMemSize=v->MinShmSize;
@@ -380,12 +451,14 @@ static void emAvVideoUnlockCb(void * opaque, void * picture, void * const * plan
 
 	v=(emAvVideoAdapter*)opaque;
 
-	/* It would be more correct to do this in the display callback. But if
-	   there is really a time synchronization behind that call, we would
-	   need some kind of double buffering. Copying from dummy mem to shared
-	   mem would be a bad idea. */
+	/* In single frame mode, it would be more correct to do this in the
+	   display callback. But if there is really a time synchronization
+	   behind that call, we would need some kind of double buffering.
+	   Copying from dummy mem to shared mem would be a bad idea. In ring
+	   mode, we have that buffering, and the frame is handed over by the
+	   display callback. */
 	pi=(int*)picture;
-	pi[0]=1;
+	if (v->ShmSlotCount<=1) pi[0]=1;
 
 	v->FrameCount++;
 
@@ -395,6 +468,17 @@ static void emAvVideoUnlockCb(void * opaque, void * picture, void * const * plan
 
 static void emAvVideoDisplayCb(void * opaque, void * picture)
 {
+	emAvVideoAdapter * v;
+
+	v=(emAvVideoAdapter*)opaque;
+	pthread_mutex_lock(&v->Mutex);
+	if (
+		v->ShmSlotCount>1 && picture &&
+		picture==(void*)emAvGetShmFrame(v)
+	) {
+		emAvPublishShmFrame(v,(int*)picture);
+	}
+	pthread_mutex_unlock(&v->Mutex);
 }
 
 
@@ -436,8 +520,8 @@ static void emAvPerformAudioVisualizationFrame(emAvVideoAdapter * v)
 
 	if (v->AudioVisuType==0) showFrame=0;
 
-	pi=(int*)v->ShmPtr;
-	if (!showFrame || !pi || v->ShmSize<v->MinShmSize || pi[0]) {
+	pi=showFrame ? (int volatile *)emAvGetShmFrame(v) : NULL;
+	if (!pi) {
 		pthread_mutex_unlock(&v->Mutex);
 		return;
 	}
@@ -509,7 +593,7 @@ static void emAvPerformAudioVisualizationFrame(emAvVideoAdapter * v)
 		}
 	}
 
-	pi[0]=1;
+	emAvPublishShmFrame(v,(int*)pi);
 	v->FrameCount++;
 	pthread_mutex_unlock(&v->Mutex);
 }
@@ -1080,6 +1164,11 @@ static void emAvPollProperties(int instIndex, int initialize)
 
 	inst=emAvInstances[instIndex];
 
+	/* framering */
+	if (initialize) {
+		emAvSendMsg(instIndex,"framering","%d",EM_AV_MAX_RING_SLOTS);
+	}
+
 	/* minshmsize */
 	sz=0;
 	pthread_mutex_lock(&inst->VideoAdapter->Mutex);
@@ -1414,6 +1503,9 @@ static void emAvDetachShm(int instIndex)
 		v->ShmPtr=NULL;
 #endif
 		v->ShmSize=0;
+		v->ShmSlotCount=0;
+		v->ShmSlotSize=0;
+		v->ShmWriteSlot=0;
 	}
 
 	pthread_mutex_unlock(&v->Mutex);
@@ -1425,7 +1517,7 @@ static const char * emAvAttachShm(int instIndex, const char * params)
 	emAvInstance * inst;
 	emAvVideoAdapter * v;
 	const char * err;
-	int shmSize;
+	int shmSize,slotCount;
 #if defined(_WIN32) || defined(__CYGWIN__)
 	char shmId[256];
 	const char * p;
@@ -1442,16 +1534,17 @@ static const char * emAvAttachShm(int instIndex, const char * params)
 
 	pthread_mutex_lock(&v->Mutex);
 	err=NULL;
+	slotCount=1;
 
 #if defined(_WIN32) || defined(__CYGWIN__)
 
 	shmId[0]=0;
 	shmSize=0;
-	p=strrchr(params,':');
-	if (p) {
+	p=strchr(params,':');
+	if (p && p-params<(int)sizeof(shmId)) {
 		memcpy(shmId,params,p-params);
 		shmId[p-params]=0;
-		sscanf(p+1,"%d",&shmSize);
+		sscanf(p+1,"%d:%d",&shmSize,&slotCount);
 	}
 	if (shmId[0]==0 || shmSize<=0) {
 		err="Illegal shm parameters.";
@@ -1485,7 +1578,7 @@ static const char * emAvAttachShm(int instIndex, const char * params)
 
 	shmId=-1;
 	shmSize=0;
-	sscanf(params,"%d:%d",&shmId,&shmSize);
+	sscanf(params,"%d:%d:%d",&shmId,&shmSize,&slotCount);
 	if (shmId<0 || shmSize<=0) {
 		err="Illegal shm parameters.";
 	}
@@ -1507,6 +1600,24 @@ static const char * emAvAttachShm(int instIndex, const char * params)
 
 #endif
 
+	if (!err) {
+		if (
+			slotCount>1 && slotCount<=EM_AV_MAX_RING_SLOTS &&
+			shmSize>EM_AV_RING_HEADER_SIZE
+		) {
+			v->ShmSlotCount=slotCount;
+			v->ShmSlotSize=
+				((shmSize-EM_AV_RING_HEADER_SIZE)/slotCount) &
+				~(EM_AV_RING_SLOT_ALIGN-1)
+			;
+		}
+		else {
+			v->ShmSlotCount=1;
+			v->ShmSlotSize=shmSize;
+		}
+		v->ShmWriteSlot=0;
+	}
+
 	pthread_mutex_unlock(&v->Mutex);
 
 	return err;
@@ -27,6 +27,7 @@
 #include <sys/shm.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <xine.h>
@@ -93,12 +94,19 @@ static const char * emAv_get_xine_error(xine_stream_t * stream)
 /*============================= emAv_raw_visual_t ============================*/
 /*============================================================================*/
 
+#define EM_AV_MAX_RING_SLOTS 16
+#define EM_AV_RING_HEADER_SIZE 256
+#define EM_AV_RING_SLOT_ALIGN 64
+
 typedef struct {
 	raw_visual_t base;
 	pthread_mutex_t mutex;
 	int min_shm_size;
 	int shm_size;
 	void * shm_ptr;
+	int shm_slot_count;
+	int shm_slot_size;
+	int shm_write_slot;
 	int crop_left;
 	int crop_right;
 	int crop_top;
@@ -106,6 +114,58 @@ typedef struct {
 } emAv_raw_visual_t;
 
 
+static int volatile * emAv_raw_get_shm_frame(
+	emAv_raw_visual_t * visual, int size
+)
+{
+	int volatile * pi;
+
+	/* Get the frame buffer in the shared memory which is to be written
+	   next, or NULL if there is none free. */
+
+	pi=(int volatile *)visual->shm_ptr;
+	if (!pi) return NULL;
+	if (visual->shm_slot_count>1) {
+		if (visual->shm_slot_size<size) return NULL;
+		pi=(int volatile *)(
+			((char*)pi)+EM_AV_RING_HEADER_SIZE+
+			visual->shm_write_slot*visual->shm_slot_size
+		);
+	}
+	else {
+		if (visual->shm_size<size) return NULL;
+	}
+	if (pi[0]) return NULL;
+	return pi;
+}
+
+
+static void emAv_raw_publish_shm_frame(
+	emAv_raw_visual_t * visual, int volatile * pi
+)
+{
+	struct timespec ts;
+	unsigned long long t;
+	int volatile * hdr;
+
+	/* Hand a written frame buffer over to the client. In ring mode, the
+	   frame is stamped with the presentation time, which is now because
+	   xine calls the raw output at display time. */
+
+	if (visual->shm_slot_count>1) {
+		clock_gettime(CLOCK_MONOTONIC,&ts);
+		t=((unsigned long long)ts.tv_sec)*1000000+ts.tv_nsec/1000;
+		hdr=(int volatile *)visual->shm_ptr;
+		hdr[4+2*visual->shm_write_slot]=(int)(t>>32);
+		hdr[5+2*visual->shm_write_slot]=(int)t;
+		visual->shm_write_slot=
+			(visual->shm_write_slot+1)%visual->shm_slot_count
+		;
+	}
+	pi[0]=1;
+}
+
+
 static void emAv_raw_output_cb(
 	void * user_data, int frame_format, int frame_width, int frame_height,
 	double frame_aspect, void * data0, void * data1, void * data2
@@ -187,8 +247,8 @@ static void emAv_raw_output_cb(
 	sz=headerSize+256+size0+size1+size2;
 
 	if (visual->min_shm_size<sz) visual->min_shm_size=sz;
-	pi=(int volatile *)visual->shm_ptr;
-	if (pi && visual->shm_size>=sz && !pi[0]) {
+	pi=emAv_raw_get_shm_frame(visual,sz);
+	if (pi) {
 		pi[1]=x2-x1;
 		pi[2]=y2-y1;
 		pi[3]=(int)(frame_aspect*65536.0+0.5);
@@ -227,7 +287,7 @@ static void emAv_raw_output_cb(
 		default:
 			break;
 		}
-		pi[0]=1;
+		emAv_raw_publish_shm_frame(visual,pi);
 	}
 
 	pthread_mutex_unlock(&visual->mutex);
@@ -821,6 +881,11 @@ static void emAvPollProperties(int instIndex, int initialize)
 
 	inst=emAvInstances[instIndex];
 
+	/* framering */
+	if (initialize) {
+		emAvSendMsg(instIndex,"framering","%d",EM_AV_MAX_RING_SLOTS);
+	}
+
 	/* minshmsize */
 	if (inst->MyRawVisual) {
 		pthread_mutex_lock(&inst->MyRawVisual->mutex);
@@ -1150,12 +1215,17 @@ static void emAvDetachShm(int instIndex)
 		shmdt((const void*)inst->MyRawVisual->shm_ptr);
 		inst->MyRawVisual->shm_ptr=NULL;
 		inst->MyRawVisual->shm_size=0;
+		inst->MyRawVisual->shm_slot_count=0;
+		inst->MyRawVisual->shm_slot_size=0;
+		inst->MyRawVisual->shm_write_slot=0;
 	}
 	pthread_mutex_unlock(&inst->MyRawVisual->mutex);
 }
 
 
-static const char * emAvAttachShm(int instIndex, int shmId, int shmSize)
+static const char * emAvAttachShm(
+	int instIndex, int shmId, int shmSize, int slotCount
+)
 {
 	emAvInstance * inst;
 	void * shmPtr;
@@ -1174,6 +1244,21 @@ static const char * emAvAttachShm(int instIndex, int shmId, int shmSize)
 	if (inst->MyRawVisual->shm_ptr) shmdt((const void*)inst->MyRawVisual->shm_ptr);
 	inst->MyRawVisual->shm_ptr=shmPtr;
 	inst->MyRawVisual->shm_size=shmSize;
+	if (
+		slotCount>1 && slotCount<=EM_AV_MAX_RING_SLOTS &&
+		shmSize>EM_AV_RING_HEADER_SIZE
+	) {
+		inst->MyRawVisual->shm_slot_count=slotCount;
+		inst->MyRawVisual->shm_slot_size=
+			((shmSize-EM_AV_RING_HEADER_SIZE)/slotCount) &
+			~(EM_AV_RING_SLOT_ALIGN-1)
+		;
+	}
+	else {
+		inst->MyRawVisual->shm_slot_count=1;
+		inst->MyRawVisual->shm_slot_size=shmSize;
+	}
+	inst->MyRawVisual->shm_write_slot=0;
 	pthread_mutex_unlock(&inst->MyRawVisual->mutex);
 
 	return NULL;
@@ -1385,7 +1470,7 @@ static const char * emAvOpenInstance(
 static void emAvHandleMsg(int instIndex, const char * tag, const char * data)
 {
 	const char * err, * p1, * p2, * p3;
-	int shmId,shmSize;
+	int shmId,shmSize,slotCount;
 
 	if (instIndex<0 || instIndex>=EM_AV_MAX_INSTANCES) {
 		emAvSendMsg(instIndex,"error","Instance index out of range.");
@@ -1409,8 +1494,9 @@ static void emAvHandleMsg(int instIndex, const char * tag, const char * data)
 	else if (strcmp(tag,"attachshm")==0) {
 		shmId=-1;
 		shmSize=0;
-		sscanf(data,"%d:%d",&shmId,&shmSize);
-		err=emAvAttachShm(instIndex,shmId,shmSize);
+		slotCount=1;
+		sscanf(data,"%d:%d:%d",&shmId,&shmSize,&slotCount);
+		err=emAvAttachShm(instIndex,shmId,shmSize,slotCount);
 		if (err) emAvSendMsg(instIndex,"error","%s",err);
 		else emAvSendMsg(instIndex,"ok",tag);
 	}
@@ -40,4 +40,23 @@ extern "C" {
 			)
 		);
 	}
+
+
+	emRef<emModel> emBmpFpPluginModelFunc(
+		emContext & context, const emString & className,
+		const emString & name, bool common, emFpPlugin * plugin,
+		emString * errorBuf
+	)
+	{
+		if (
+			className!="emImageFileModel" &&
+			className!="emBmpImageFileModel"
+		) {
+			*errorBuf="emBmpFpPlugin: Unsupported model class.";
+			return NULL;
+		}
+		return emRef<emModel>(
+			emBmpImageFileModel::Acquire(context,name,common)
+		);
+	}
 }
@@ -31,11 +31,21 @@ emEngine::emEngine(emScheduler & scheduler)
 	AwakeState=-1;
 	Priority=DEFAULT_PRIORITY;
 	Clock=Scheduler.Clock;
+	ThreadWakeUpNext=NULL;
+	ThreadWakeUpPending=false;
 }
 
 
 emEngine::~emEngine()
 {
+	emEngine * * pe;
+
+	Scheduler.ThreadWakeUpMutex.Lock();
+	if (ThreadWakeUpPending) {
+		for (pe=&Scheduler.ThreadWakeUpList; *pe!=this; pe=&(*pe)->ThreadWakeUpNext);
+		*pe=ThreadWakeUpNext;
+	}
+	Scheduler.ThreadWakeUpMutex.Unlock();
 	while (SLFirst) RemoveLink(SLFirst);
 	if (Scheduler.CurrentEngine==this) Scheduler.CurrentEngine=NULL;
 	if (AwakeState>=0) {
@@ -46,6 +56,18 @@ emEngine::~emEngine()
 }
 
 
+void emEngine::ThreadSafeWakeUp()
+{
+	Scheduler.ThreadWakeUpMutex.Lock();
+	if (!ThreadWakeUpPending) {
+		ThreadWakeUpPending=true;
+		ThreadWakeUpNext=Scheduler.ThreadWakeUpList;
+		Scheduler.ThreadWakeUpList=this;
+	}
+	Scheduler.ThreadWakeUpMutex.Unlock();
+}
+
+
 void emEngine::AddWakeUpSignal(const emSignal & signal)
 {
 	emSignal * sig;
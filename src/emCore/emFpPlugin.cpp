@@ -33,9 +33,11 @@ emFpPlugin::emFpPlugin()
 	Priority(this,"Priority",1.0),
 	Library(this,"Library","unknown"),
 	Function(this,"Function","unknown"),
+	ModelFunction(this,"ModelFunction"),
 	Properties(this,"Properties")
 {
 	CachedFunc=NULL;
+	CachedModelFunc=NULL;
 }
 
 
@@ -98,6 +100,48 @@ emPanel * emFpPlugin::TryCreateFilePanel(
 }
 
 
+emRef<emModel> emFpPlugin::TryAcquireModel(
+	emContext & context, const emString & className, const emString & name,
+	bool common
+)
+{
+	emString errorBuf;
+	emRef<emModel> model;
+
+	if (ModelFunction.Get().IsEmpty()) {
+		throw emException(
+			"Plugin %s has no model function.",
+			Library.Get().Get()
+		);
+	}
+	if (
+		!CachedModelFunc || CachedModelFuncLib!=Library ||
+		CachedModelFuncName!=ModelFunction
+	) {
+		CachedModelFunc=emTryResolveSymbol(
+			Library.Get(),false,ModelFunction.Get()
+		);
+		CachedModelFuncLib=Library;
+		CachedModelFuncName=ModelFunction;
+	}
+	errorBuf.Clear();
+	model=((emFpPluginModelFunc)CachedModelFunc)(
+		context,className,name,common,this,&errorBuf
+	);
+	if (!model) {
+		if (errorBuf.IsEmpty()) {
+			errorBuf=emString::Format(
+				"Plugin function %s in %s failed.",
+				ModelFunction.Get().Get(),
+				Library.Get().Get()
+			);
+		}
+		throw emException("%s",errorBuf.Get());
+	}
+	return model;
+}
+
+
 const char * emFpPlugin::GetFormatName() const
 {
 	return "emFpPlugin";
@@ -137,8 +181,8 @@ emPanel * emFpPluginList::CreateFilePanel(
 )
 {
 	emFpPlugin * plugin, * found;
-	const char * fn, * type;
-	int i,j,fnLen,typeLen;
+	const char * fn;
+	int i;
 
 	if (statErr) {
 		return new emErrorPanel(parent,name,emGetErrorText(statErr));
@@ -146,28 +190,9 @@ emPanel * emFpPluginList::CreateFilePanel(
 
 	found=NULL;
 	fn=emGetNameInPath(absolutePath);
-	fnLen=strlen(fn);
 	for (i=0; i<Plugins.GetCount(); i++) {
 		plugin=Plugins[i];
-		for (j=0; j<plugin->FileTypes.GetCount(); j++) {
-			type=plugin->FileTypes[j].Get();
-			if (type[0]=='.') {
-				if ((statMode&S_IFMT)==S_IFREG) {
-					typeLen=strlen(type);
-					if (
-						typeLen<fnLen &&
-						strcasecmp(fn+fnLen-typeLen,type)==0
-					) break;
-				}
-			}
-			else if (strcmp(type,"file")==0) {
-				if ((statMode&S_IFMT)==S_IFREG) break;
-			}
-			else if (strcmp(type,"directory")==0) {
-				if ((statMode&S_IFMT)==S_IFDIR) break;
-			}
-		}
-		if (j<plugin->FileTypes.GetCount()) {
+		if (IsFileTypeAccepted(plugin,fn,statMode)) {
 			found=plugin;
 			alternative--;
 			if (alternative<0) break;
@@ -191,6 +216,54 @@ emPanel * emFpPluginList::CreateFilePanel(
 }
 
 
+emRef<emModel> emFpPluginList::TryAcquireModel(
+	const char * className, const emString & absolutePath, long statMode,
+	bool common, int alternative
+)
+{
+	emFpPlugin * plugin;
+	const char * fn;
+	int i;
+
+	fn=emGetNameInPath(absolutePath);
+	for (i=0; i<Plugins.GetCount(); i++) {
+		plugin=Plugins[i];
+		if (
+			!plugin->ModelFunction.Get().IsEmpty() &&
+			IsFileTypeAccepted(plugin,fn,statMode)
+		) {
+			alternative--;
+			if (alternative<0) {
+				return plugin->TryAcquireModel(
+					GetRootContext(),className,absolutePath,common
+				);
+			}
+		}
+	}
+	throw emException("No file model plugin available for this file type.");
+}
+
+
+bool emFpPluginList::HasModelFor(
+	const emString & absolutePath, long statMode
+) const
+{
+	const emFpPlugin * plugin;
+	const char * fn;
+	int i;
+
+	fn=emGetNameInPath(absolutePath);
+	for (i=0; i<Plugins.GetCount(); i++) {
+		plugin=Plugins[i];
+		if (
+			!plugin->ModelFunction.Get().IsEmpty() &&
+			IsFileTypeAccepted(plugin,fn,statMode)
+		) return true;
+	}
+	return false;
+}
+
+
 emFpPluginList::emFpPluginList(emContext & context, const emString & name)
 	: emModel(context,name)
 {
@@ -236,6 +309,41 @@ emFpPluginList::~emFpPluginList()
 }
 
 
+bool emFpPluginList::IsFileTypeAccepted(
+	const emFpPlugin * plugin, const char * fileName, long statMode
+)
+{
+	const char * type;
+	int j,fnLen,typeLen;
+
+	fnLen=strlen(fileName);
+	for (j=0; j<plugin->FileTypes.GetCount(); j++) {
+		type=plugin->FileTypes[j].Get();
+		if (type[0]=='.') {
+			if ((statMode&S_IFMT)==S_IFREG) {
+				typeLen=strlen(type);
+				if (
+					typeLen<fnLen &&
+					strcasecmp(fileName+fnLen-typeLen,type)==0
+				) return true;
+			}
+		}
+		else if (strcmp(type,"file")==0) {
+			if ((statMode&S_IFMT)==S_IFREG) return true;
+		}
+		else if (strcmp(type,"directory")==0) {
+			if ((statMode&S_IFMT)==S_IFDIR) return true;
+		}
+#		if defined(S_IFBLK)
+			else if (strcmp(type,"blockdevice")==0) {
+				if ((statMode&S_IFMT)==S_IFBLK) return true;
+			}
+#		endif
+	}
+	return false;
+}
+
+
 int emFpPluginList::CmpReversePluginPriorities(
 	const emFpPlugin * obj1, const emFpPlugin * obj2, void * context
 )
@@ -56,9 +56,62 @@ void emImageFileModel::SetFileFormatInfo(const emString & fileFormatInfo)
 }
 
 
+void emImageFileModel::SetViewedSize(
+	const void * viewer, double width, double height
+)
+{
+	double maxW,maxH;
+	int i;
+
+	for (i=ViewedSizes.GetCount()-1; i>=0; i--) {
+		if (ViewedSizes[i].Viewer==viewer) break;
+	}
+	if (width<=0.0 || height<=0.0) {
+		if (i>=0) ViewedSizes.Remove(i);
+		return;
+	}
+	if (i<0) {
+		i=ViewedSizes.GetCount();
+		ViewedSizes.AddNew();
+		ViewedSizes.GetWritable(i).Viewer=viewer;
+	}
+	else if (
+		ViewedSizes[i].Width==width &&
+		ViewedSizes[i].Height==height
+	) {
+		return;
+	}
+	ViewedSizes.GetWritable(i).Width=width;
+	ViewedSizes.GetWritable(i).Height=height;
+
+	if (
+		OriginalWidth>0 && Reduction>1 && (
+			GetFileState()==FS_LOADED ||
+			GetFileState()==FS_LOADING
+		)
+	) {
+		maxW=0.0;
+		maxH=0.0;
+		for (i=ViewedSizes.GetCount()-1; i>=0; i--) {
+			if (maxW<ViewedSizes[i].Width) maxW=ViewedSizes[i].Width;
+			if (maxH<ViewedSizes[i].Height) maxH=ViewedSizes[i].Height;
+		}
+		if (CalcReductionFor(maxW,maxH)<Reduction) {
+			HardResetFileState();
+		}
+	}
+}
+
+
 emImageFileModel::emImageFileModel(emContext & context, const emString & name)
 	: emFileModel(context,name)
 {
+	ViewedSizes.SetTuningLevel(4);
+	OriginalWidth=0;
+	OriginalHeight=0;
+	OriginalChannelCount=0;
+	MaxReduction=1;
+	Reduction=1;
 }
 
 
@@ -72,10 +125,158 @@ void emImageFileModel::ResetData()
 	Image.Clear();
 	Comment.Clear();
 	FileFormatInfo.Clear();
+	OriginalWidth=0;
+	OriginalHeight=0;
+	OriginalChannelCount=0;
+	MaxReduction=1;
+	Reduction=1;
 	Signal(ChangeSignal);
 }
 
 
+int emImageFileModel::CalcReduction(
+	int originalWidth, int originalHeight, int channelCount,
+	int maxReduction
+)
+{
+	double maxW,maxH;
+	int i;
+
+	OriginalWidth=originalWidth;
+	OriginalHeight=originalHeight;
+	OriginalChannelCount=channelCount;
+	MaxReduction=1;
+	while (MaxReduction*2<=maxReduction) MaxReduction*=2;
+
+	maxW=0.0;
+	maxH=0.0;
+	for (i=ViewedSizes.GetCount()-1; i>=0; i--) {
+		if (maxW<ViewedSizes[i].Width) maxW=ViewedSizes[i].Width;
+		if (maxH<ViewedSizes[i].Height) maxH=ViewedSizes[i].Height;
+	}
+	Reduction=CalcReductionFor(maxW,maxH);
+	return Reduction;
+}
+
+
+emImageFileModel::RowReducer::RowReducer()
+	: OriginalWidth(0),
+	OriginalHeight(0),
+	ChannelCount(0),
+	Reduction(1),
+	RowCount(0)
+{
+	Sums.SetTuningLevel(4);
+}
+
+
+emImageFileModel::RowReducer::~RowReducer()
+{
+}
+
+
+void emImageFileModel::RowReducer::Setup(
+	emImage & image, int originalWidth, int originalHeight,
+	int channelCount, int reduction
+)
+{
+	OriginalWidth=originalWidth;
+	OriginalHeight=originalHeight;
+	ChannelCount=channelCount;
+	Reduction=emMax(reduction,1);
+	RowCount=0;
+	image.Setup(
+		(OriginalWidth+Reduction-1)/Reduction,
+		(OriginalHeight+Reduction-1)/Reduction,
+		ChannelCount
+	);
+	if (Reduction>1) {
+		Sums.SetCount(image.GetWidth()*ChannelCount,true);
+		memset(Sums.GetWritable(),0,sizeof(emUInt32)*Sums.GetCount());
+	}
+	else {
+		Sums.Clear(true);
+	}
+}
+
+
+void emImageFileModel::RowReducer::PutRow(emImage & image, const emByte * row)
+{
+	emUInt32 * sums, * s;
+	emByte * tgt;
+	int x,c,r,tw,ty,n,m,cnt;
+
+	if (RowCount>=OriginalHeight) return;
+	r=Reduction;
+	tw=image.GetWidth();
+
+	if (r<=1) {
+		memcpy(
+			image.GetWritableMap()+
+				((size_t)RowCount)*OriginalWidth*ChannelCount,
+			row,
+			((size_t)OriginalWidth)*ChannelCount
+		);
+		RowCount++;
+		return;
+	}
+
+	sums=Sums.GetWritable();
+	for (x=0; x<OriginalWidth; x++) {
+		s=sums+(x/r)*ChannelCount;
+		for (c=0; c<ChannelCount; c++) s[c]+=*row++;
+	}
+	RowCount++;
+
+	if (RowCount%r!=0 && RowCount<OriginalHeight) return;
+
+	ty=(RowCount-1)/r;
+	n=RowCount-ty*r;
+	tgt=image.GetWritableMap()+((size_t)ty)*tw*ChannelCount;
+	for (x=0; x<tw; x++) {
+		m=OriginalWidth-x*r;
+		if (m>r) m=r;
+		cnt=n*m;
+		s=sums+x*ChannelCount;
+		for (c=0; c<ChannelCount; c++) {
+			*tgt++=(emByte)((s[c]+cnt/2)/cnt);
+			s[c]=0;
+		}
+	}
+}
+
+
+int emImageFileModel::CalcReductionFor(
+	double viewedWidth, double viewedHeight
+) const
+{
+	emUInt64 lim,w,h;
+	double f;
+	int r;
+
+	r=1;
+	if (OriginalWidth<=0 || OriginalHeight<=0) return r;
+
+	if (viewedWidth>0.0 && viewedHeight>0.0) {
+		f=emMin(
+			viewedWidth/OriginalWidth,
+			viewedHeight/OriginalHeight
+		);
+		while (r<MaxReduction && f*r*2<=1.0) r*=2;
+	}
+
+	lim=GetMemoryLimit();
+	while (r<MaxReduction) {
+		w=(OriginalWidth+r-1)/r;
+		h=(OriginalHeight+r-1)/r;
+		if (w*h*OriginalChannelCount<=lim) break;
+		r*=2;
+	}
+
+	return r;
+}
+
+
 //==============================================================================
 //============================== emImageFilePanel ==============================
 //==============================================================================
@@ -86,11 +287,20 @@ emImageFilePanel::emImageFilePanel(
 )
 	: emFilePanel(parent,name)
 {
+	ViewedSizeSet=false;
 	AddWakeUpSignal(GetVirFileStateSignal());
 	SetFileModel(fileModel,updateFileModel);
 }
 
 
+emImageFilePanel::~emImageFilePanel()
+{
+	if (GetFileModel()) {
+		((emImageFileModel*)GetFileModel())->SetViewedSize(this,0.0,0.0);
+	}
+}
+
+
 void emImageFilePanel::SetFileModel(
 	emFileModel * fileModel, bool updateFileModel
 )
@@ -103,14 +313,19 @@ void emImageFilePanel::SetFileModel(
 		RemoveWakeUpSignal(
 			((const emImageFileModel*)GetFileModel())->GetChangeSignal()
 		);
+		((emImageFileModel*)GetFileModel())->SetViewedSize(this,0.0,0.0);
 	}
 
+	Preview.Clear();
+	ViewedSizeSet=false;
+
 	emFilePanel::SetFileModel(fileModel,updateFileModel);
 
 	if (GetFileModel()) {
 		AddWakeUpSignal(
 			((const emImageFileModel*)GetFileModel())->GetChangeSignal()
 		);
+		UpdateViewedSize();
 	}
 }
 
@@ -172,12 +387,29 @@ bool emImageFilePanel::Cycle()
 		}
 	}
 	if (IsSignaled(GetVirFileStateSignal())) {
+		if (
+			!Preview.IsEmpty() &&
+			GetVirFileState()!=VFS_WAITING &&
+			GetVirFileState()!=VFS_LOADING
+		) {
+			Preview.Clear();
+			InvalidatePainting();
+		}
 		InvalidateControlPanel(); //??? very cheap solution, but okay for now.
 	}
 	return emFilePanel::Cycle();
 }
 
 
+void emImageFilePanel::Notice(NoticeFlags flags)
+{
+	emFilePanel::Notice(flags);
+	if (flags&(NF_VIEWING_CHANGED|NF_LAYOUT_CHANGED)) {
+		UpdateViewedSize();
+	}
+}
+
+
 bool emImageFilePanel::IsOpaque() const
 {
 	if (IsVFSGood()) {
@@ -228,6 +460,25 @@ void emImageFilePanel::Paint(
 			}
 		}
 	}
+	else if (!Preview.IsEmpty()) {
+		x=0;
+		y=0;
+		w=1;
+		h=GetHeight();
+		iw=Preview.GetWidth();
+		ih=Preview.GetHeight();
+		if (iw*h>=ih*w) {
+			d=w*ih/iw;
+			y+=(h-d)/2;
+			h=d;
+		}
+		else {
+			d=h*iw/ih;
+			x+=(w-d)/2;
+			w=d;
+		}
+		painter.PaintImage(x,y,w,h,Preview,255,canvasColor);
+	}
 	else {
 		emFilePanel::Paint(painter,canvasColor);
 	}
@@ -269,10 +520,19 @@ emPanel * emImageFilePanel::CreateControlPanel(
 			"Size",
 			emString(),
 			emImage(),
+			fm->GetImage().GetWidth()==fm->GetOriginalWidth() &&
+			fm->GetImage().GetHeight()==fm->GetOriginalHeight() ?
 			emString::Format(
 				"%dx%d pixels",
 				fm->GetImage().GetWidth(),
 				fm->GetImage().GetHeight()
+			) :
+			emString::Format(
+				"%dx%d pixels (loaded at %dx%d)",
+				fm->GetOriginalWidth(),
+				fm->GetOriginalHeight(),
+				fm->GetImage().GetWidth(),
+				fm->GetImage().GetHeight()
 			)
 		);
 		tf=new emTextField(
@@ -290,3 +550,34 @@ emPanel * emImageFilePanel::CreateControlPanel(
 		return emFilePanel::CreateControlPanel(parent,name);
 	}
 }
+
+
+void emImageFilePanel::UpdateViewedSize()
+{
+	emImageFileModel * fm;
+	emImage img;
+
+	fm=(emImageFileModel*)GetFileModel();
+	if (!fm) return;
+	if (!IsViewed()) {
+		// Not viewed yet, but the file may be loaded already. Until
+		// the real size is known, assume the image is not shown
+		// larger than the view.
+		if (!ViewedSizeSet) {
+			fm->SetViewedSize(
+				this,GetView().GetCurrentWidth(),
+				GetView().GetCurrentHeight()
+			);
+			ViewedSizeSet=true;
+		}
+		return;
+	}
+	if (IsVFSGood()) img=fm->GetImage();
+	fm->SetViewedSize(this,GetViewedWidth(),GetViewedHeight());
+	ViewedSizeSet=true;
+	if (!img.IsEmpty() && !IsVFSGood()) {
+		// Loading again at a higher resolution.
+		Preview=img;
+		InvalidatePainting();
+	}
+}
@@ -22,6 +22,14 @@
 #include <emCore/emCoreConfig.h>
 
 
+emPainter::ScanlineTool::~ScanlineTool()
+{
+	for (int i=0; i<3; i++) {
+		if (YuvTools[i]) delete YuvTools[i];
+	}
+}
+
+
 bool emPainter::ScanlineTool::Init(
 	const emTexture & texture, emColor canvasColor
 )
@@ -221,6 +229,17 @@ bool emPainter::ScanlineTool::Init(
 			Interpolate=InterpolateRadialGradient;
 		}
 		break;
+	case emTexture::IMAGE_YUV:
+		Alpha=texture.GetAlpha();
+		if (Alpha<=0) return false;
+		psFuncPtr+=(3-1)<<3;
+		if (Alpha>=255) {
+			PaintScanline=psFuncPtr[PSF_INT];
+		}
+		else {
+			PaintScanline=psFuncPtr[PSF_INT_A];
+		}
+		return InitYuv(texture);
 	}
 
 	return true;
@@ -381,6 +400,47 @@ L_SET_INTERPOLATE_IMAGE:
 }
 
 
+bool emPainter::ScanlineTool::InitYuv(const emTexture & texture)
+{
+	const emImage * planes[3] = {
+		&texture.GetImage(), &texture.GetImageU(), &texture.GetImageV()
+	};
+
+	// Zero is not black in YUV, so the planes are always extended by their
+	// edges (unless tiled).
+	emTexture::ExtensionType ext=texture.GetExtension();
+	if (ext!=emTexture::EXTEND_TILED) ext=emTexture::EXTEND_EDGE;
+
+	for (int i=0; i<3; i++) {
+		if (planes[i]->GetChannelCount()!=1) return false;
+		if (!YuvTools[i]) YuvTools[i]=new ScanlineTool(Painter);
+		if (!YuvTools[i]->Init(
+			emImageTexture(
+				texture.GetX(),texture.GetY(),texture.GetW(),texture.GetH(),
+				*planes[i],255,ext,texture.GetDownscaleQuality(),
+				texture.GetUpscaleQuality()
+			),
+			0
+		)) return false;
+	}
+
+	Channels=3;
+#	if EM_HAVE_X86_INTRINSICS
+	if (
+		Painter.Model->CanCpuDoAvx2 &&
+		Painter.Model->CoreConfig->AllowSIMD.Get()
+	) {
+		Interpolate=InterpolateImageAvx2Yuv;
+	}
+	else
+#	endif
+	{
+		Interpolate=InterpolateImageYuv;
+	}
+	return true;
+}
+
+
 void emPainter::ScanlineTool::PaintLargeScanlineInt(
 	const ScanlineTool & sct, int x, int y, int w,
 	int opacityBeg, int opacity, int opacityEnd
@@ -31,6 +31,7 @@ class emPainter::ScanlineTool {
 public:
 
 	ScanlineTool(const emPainter & painter);
+	~ScanlineTool();
 
 	bool Init(const emTexture & texture, emColor canvasColor);
 
@@ -46,6 +47,13 @@ private:
 		int opacityBeg, int opacity, int opacityEnd
 	);
 
+	bool InitYuv(const emTexture & texture);
+
+	static void ConvertYuvToRgb(
+		const emByte * srcY, const emByte * srcU, const emByte * srcV,
+		emByte * tgt, int count
+	);
+
 	const emPainter & Painter;
 	int Alpha;
 	emColor CanvasColor,Color1,Color2;
@@ -56,6 +64,9 @@ private:
 	ssize_t ImgSX,ImgSY;
 	emInt64 TX,TY,TDX,TDY;
 	emUInt32 ODX,ODY;
+	ScanlineTool * YuvTools[3];
+		// With a YUV texture: One tool for each plane, which
+		// interpolates the plane like a gray image.
 
 	enum { MaxInterpolationBytesAtOnce=1024 };
 
@@ -80,6 +91,10 @@ private:
 
 	DECLARE_INTERPOLATE(LinearGradient) //  1 InterpolateLinearGradient function
 	DECLARE_INTERPOLATE(RadialGradient) //  1 InterpolateRadialGradient function
+	DECLARE_INTERPOLATE(ImageYuv)       //  1 InterpolateImageYuv function
+#	if EM_HAVE_X86_INTRINSICS
+		DECLARE_INTERPOLATE(ImageAvx2Yuv) // 1 InterpolateImageAvx2Yuv function
+#	endif
 	DECLARE_INTERPOLATE_EXCS(ImageNearest)     // 12 InterpolateImageNear.. functions
 	DECLARE_INTERPOLATE_EXCS(ImageAreaSampled) // 12 InterpolateImageArea.. functions
 	DECLARE_INTERPOLATE_EXCS(ImageBilinear)    // 12 InterpolateImageBili.. functions
@@ -164,6 +179,9 @@ private:
 inline emPainter::ScanlineTool::ScanlineTool(const emPainter & painter)
 	: Painter(painter)
 {
+	YuvTools[0]=NULL;
+	YuvTools[1]=NULL;
+	YuvTools[2]=NULL;
 }
 
 
@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+// emPainter_ScTlIntYuv.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "emPainter_ScTl.h"
+
+
+void emPainter::ScanlineTool::InterpolateImageYuv(
+	const ScanlineTool & sct, int x, int y, int w
+)
+{
+	for (int i=0; i<3; i++) {
+		const ScanlineTool & pt=*sct.YuvTools[i];
+		pt.Interpolate(pt,x,y,w);
+	}
+	ConvertYuvToRgb(
+		(const emByte*)sct.YuvTools[0]->InterpolationBuffer,
+		(const emByte*)sct.YuvTools[1]->InterpolationBuffer,
+		(const emByte*)sct.YuvTools[2]->InterpolationBuffer,
+		(emByte*)sct.InterpolationBuffer,
+		w
+	);
+}
+
+
+void emPainter::ScanlineTool::ConvertYuvToRgb(
+	const emByte * srcY, const emByte * srcU, const emByte * srcV,
+	emByte * tgt, int count
+)
+{
+	const emByte * srcEnd=srcY+count;
+	while (srcY<srcEnd) {
+		int cy=(srcY[0]-16)*298+128;
+		int cu=srcU[0]-128;
+		int cv=srcV[0]-128;
+		int r=(cy+409*cv)>>8;
+		int g=(cy-100*cu-208*cv)>>8;
+		int b=(cy+516*cu)>>8;
+		if ((unsigned)r>255) r=(-r)>>16;
+		if ((unsigned)g>255) g=(-g)>>16;
+		if ((unsigned)b>255) b=(-b)>>16;
+		tgt[0]=(emByte)r;
+		tgt[1]=(emByte)g;
+		tgt[2]=(emByte)b;
+		srcY++;
+		srcU++;
+		srcV++;
+		tgt+=3;
+	}
+}
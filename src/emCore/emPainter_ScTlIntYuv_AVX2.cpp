@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+// emPainter_ScTlIntYuv_AVX2.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "emPainter_ScTl.h"
+
+#if EM_HAVE_X86_INTRINSICS
+#	if defined(_MSC_VER)
+#		include <immintrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+
+
+#if defined(__GNUC__)
+	__attribute__((target("avx2")))
+#endif
+void emPainter::ScanlineTool::InterpolateImageAvx2Yuv(
+	const ScanlineTool & sct, int x, int y, int w
+)
+{
+	for (int i=0; i<3; i++) {
+		const ScanlineTool & pt=*sct.YuvTools[i];
+		pt.Interpolate(pt,x,y,w);
+	}
+
+	const emByte * sY=(const emByte*)sct.YuvTools[0]->InterpolationBuffer;
+	const emByte * sU=(const emByte*)sct.YuvTools[1]->InterpolationBuffer;
+	const emByte * sV=(const emByte*)sct.YuvTools[2]->InterpolationBuffer;
+	emByte * t=(emByte*)sct.InterpolationBuffer;
+
+	// The conversion is like in ConvertYuvToRgb, with 16 pixels at once.
+	// The components are shifted left by 5 bits, so that _mm256_mulhrs_epi16
+	// with a coefficient times 4 gives the product divided by 256 (rounded).
+	const __m256i o16=_mm256_set1_epi16(16);
+	const __m256i o128=_mm256_set1_epi16(128);
+	const __m256i fYR=_mm256_set1_epi16(298*4);
+	const __m256i fVR=_mm256_set1_epi16(409*4);
+	const __m256i fUG=_mm256_set1_epi16(100*4);
+	const __m256i fVG=_mm256_set1_epi16(208*4);
+	const __m256i fUB=_mm256_set1_epi16(516*4);
+
+	// Shuffle masks for interleaving 16 R, 16 G and 16 B bytes into
+	// 48 RGB bytes.
+	const __m128i mR0=_mm_setr_epi8( 0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1, 5);
+	const __m128i mG0=_mm_setr_epi8(-1, 0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1);
+	const __m128i mB0=_mm_setr_epi8(-1,-1, 0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1);
+	const __m128i mR1=_mm_setr_epi8(-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1,10,-1);
+	const __m128i mG1=_mm_setr_epi8( 5,-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1,10);
+	const __m128i mB1=_mm_setr_epi8(-1, 5,-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1);
+	const __m128i mR2=_mm_setr_epi8(-1,11,-1,-1,12,-1,-1,13,-1,-1,14,-1,-1,15,-1,-1);
+	const __m128i mG2=_mm_setr_epi8(-1,-1,11,-1,-1,12,-1,-1,13,-1,-1,14,-1,-1,15,-1);
+	const __m128i mB2=_mm_setr_epi8(10,-1,-1,11,-1,-1,12,-1,-1,13,-1,-1,14,-1,-1,15);
+
+	int n=w&~15;
+	for (int i=0; i<n; i+=16) {
+		__m256i aY=_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(sY+i)));
+		__m256i aU=_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(sU+i)));
+		__m256i aV=_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(sV+i)));
+		aY=_mm256_slli_epi16(_mm256_sub_epi16(aY,o16),5);
+		aU=_mm256_slli_epi16(_mm256_sub_epi16(aU,o128),5);
+		aV=_mm256_slli_epi16(_mm256_sub_epi16(aV,o128),5);
+
+		__m256i cY=_mm256_mulhrs_epi16(aY,fYR);
+		__m256i aR=_mm256_add_epi16(cY,_mm256_mulhrs_epi16(aV,fVR));
+		__m256i aG=_mm256_sub_epi16(cY,_mm256_add_epi16(
+			_mm256_mulhrs_epi16(aU,fUG),
+			_mm256_mulhrs_epi16(aV,fVG)
+		));
+		__m256i aB=_mm256_add_epi16(cY,_mm256_mulhrs_epi16(aU,fUB));
+
+		__m256i aRG=_mm256_permute4x64_epi64(_mm256_packus_epi16(aR,aG),0xD8);
+		__m256i aBB=_mm256_permute4x64_epi64(_mm256_packus_epi16(aB,aB),0xD8);
+		__m128i sR=_mm256_castsi256_si128(aRG);
+		__m128i sG=_mm256_extracti128_si256(aRG,1);
+		__m128i sB=_mm256_castsi256_si128(aBB);
+
+		__m128i * p=(__m128i*)(t+i*3);
+		_mm_storeu_si128(p,_mm_or_si128(
+			_mm_or_si128(_mm_shuffle_epi8(sR,mR0),_mm_shuffle_epi8(sG,mG0)),
+			_mm_shuffle_epi8(sB,mB0)
+		));
+		_mm_storeu_si128(p+1,_mm_or_si128(
+			_mm_or_si128(_mm_shuffle_epi8(sR,mR1),_mm_shuffle_epi8(sG,mG1)),
+			_mm_shuffle_epi8(sB,mB1)
+		));
+		_mm_storeu_si128(p+2,_mm_or_si128(
+			_mm_or_si128(_mm_shuffle_epi8(sR,mR2),_mm_shuffle_epi8(sG,mG2)),
+			_mm_shuffle_epi8(sB,mB2)
+		));
+	}
+
+	ConvertYuvToRgb(sY+n,sU+n,sV+n,t+n*3,w-n);
+}
+
+
+#endif
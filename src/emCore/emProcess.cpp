@@ -374,22 +374,44 @@ int emProcess::TryReadErr(char * buf, int maxLen)
 
 
 void emProcess::WaitPipes(int waitFlags, unsigned timeoutMS)
+{
+	emProcess * process;
+
+	process=this;
+	WaitPipes(&process,&waitFlags,1,timeoutMS);
+}
+
+
+void emProcess::WaitPipes(
+	emProcess * const * processes, const int * waitFlags, int count,
+	unsigned timeoutMS
+)
 {
 	static const int flag[3] = { WF_WAIT_STDIN, WF_WAIT_STDOUT, WF_WAIT_STDERR };
-	HANDLE handles[3];
-	DWORD i,n;
+	HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+	emProcessPrivate * p;
+	DWORD n;
+	int i,j;
 
 	if (timeoutMS==0) return;
 	n=0;
-	for (i=0; i<3; i++) {
-		if ((waitFlags&flag[i])==0) continue;
-		if (P->Pipe[i].Handle==INVALID_HANDLE_VALUE) continue;
-		P->DoPipeIO(i);
-		if (
-			P->Pipe[i].Status!=ERROR_IO_PENDING &&
-			P->Pipe[i].Status!=ERROR_IO_INCOMPLETE
-		) return;
-		handles[n++]=P->Pipe[i].EventHandle;
+	for (j=0; j<count; j++) {
+		p=processes[j]->P;
+		for (i=0; i<3; i++) {
+			if ((waitFlags[j]&flag[i])==0) continue;
+			if (p->Pipe[i].Handle==INVALID_HANDLE_VALUE) continue;
+			p->DoPipeIO(i);
+			if (
+				p->Pipe[i].Status!=ERROR_IO_PENDING &&
+				p->Pipe[i].Status!=ERROR_IO_INCOMPLETE
+			) return;
+			if (n>=MAXIMUM_WAIT_OBJECTS) {
+				// Cannot wait for this one. Do not wait long then.
+				if (timeoutMS>10) timeoutMS=10;
+				continue;
+			}
+			handles[n++]=p->Pipe[i].EventHandle;
+		}
 	}
 	if (n<=0) return;
 	if (WaitForMultipleObjects(
@@ -817,28 +839,44 @@ int emProcess::TryReadErr(char * buf, int maxLen)
 
 
 void emProcess::WaitPipes(int waitFlags, unsigned timeoutMS)
+{
+	emProcess * process;
+
+	process=this;
+	WaitPipes(&process,&waitFlags,1,timeoutMS);
+}
+
+
+void emProcess::WaitPipes(
+	emProcess * const * processes, const int * waitFlags, int count,
+	unsigned timeoutMS
+)
 {
 	timeval tv;
 	timeval * ptv;
 	fd_set rset;
 	fd_set wset;
-	int fdMax;
+	emProcessPrivate * p;
+	int i,fdMax;
 
 	if (timeoutMS==0) return;
 	FD_ZERO(&rset);
 	FD_ZERO(&wset);
 	fdMax=-1;
-	if ((waitFlags&WF_WAIT_STDIN)!=0 && P->FdIn!=-1) {
-		FD_SET(P->FdIn,&wset);
-		if (fdMax<P->FdIn) fdMax=P->FdIn;
-	}
-	if ((waitFlags&WF_WAIT_STDOUT)!=0 && P->FdOut!=-1) {
-		FD_SET(P->FdOut,&rset);
-		if (fdMax<P->FdOut) fdMax=P->FdOut;
-	}
-	if ((waitFlags&WF_WAIT_STDERR)!=0 && P->FdErr!=-1) {
-		FD_SET(P->FdErr,&rset);
-		if (fdMax<P->FdErr) fdMax=P->FdErr;
+	for (i=0; i<count; i++) {
+		p=processes[i]->P;
+		if ((waitFlags[i]&WF_WAIT_STDIN)!=0 && p->FdIn!=-1) {
+			FD_SET(p->FdIn,&wset);
+			if (fdMax<p->FdIn) fdMax=p->FdIn;
+		}
+		if ((waitFlags[i]&WF_WAIT_STDOUT)!=0 && p->FdOut!=-1) {
+			FD_SET(p->FdOut,&rset);
+			if (fdMax<p->FdOut) fdMax=p->FdOut;
+		}
+		if ((waitFlags[i]&WF_WAIT_STDERR)!=0 && p->FdErr!=-1) {
+			FD_SET(p->FdErr,&rset);
+			if (fdMax<p->FdErr) fdMax=p->FdErr;
+		}
 	}
 	if (fdMax==-1) return;
 	if (timeoutMS==UINT_MAX) {
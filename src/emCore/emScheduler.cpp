@@ -41,6 +41,7 @@ emScheduler::emScheduler()
 	Clock=1;
 	TimeSliceCounter=0;
 	TimerStuff=NULL;
+	ThreadWakeUpList=NULL;
 }
 
 
@@ -66,6 +67,14 @@ void emScheduler::DoTimeSlice()
 
 	TimeSliceCounter++;
 	nextTimeSlice=TimeSlice^1;
+	ThreadWakeUpMutex.Lock();
+	while (ThreadWakeUpList) {
+		e=ThreadWakeUpList;
+		ThreadWakeUpList=e->ThreadWakeUpNext;
+		e->ThreadWakeUpPending=false;
+		e->WakeUp();
+	}
+	ThreadWakeUpMutex.Unlock();
 	CurrentAwakeList=AwakeLists+8+TimeSlice;
 	for (;;) {
 		Clock++;
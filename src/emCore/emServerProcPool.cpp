@@ -0,0 +1,654 @@
+//------------------------------------------------------------------------------
+// emServerProcPool.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emCore/emServerProcPool.h>
+#include <emCore/emThread.h>
+#if defined(_WIN32) || defined(__CYGWIN__)
+#	include <windows.h>
+#else
+#	include <sys/shm.h>
+#endif
+
+
+emServerProcPool::emServerProcPool(
+	emRootContext & rootContext, const emString & procPath, const char * name
+)
+	: ProcPath(procPath),
+	Name(name)
+{
+	CoreConfig=emCoreConfig::Acquire(rootContext);
+	Procs.SetTuningLevel(4);
+	NextRunId=1;
+}
+
+
+emServerProcPool::~emServerProcPool()
+{
+	int i;
+
+	for (i=0; i<Procs.GetCount(); i++) {
+		if (Procs[i]->Process.IsRunning()) {
+			Procs[i]->Process.SendTerminationSignal();
+		}
+	}
+	for (i=0; i<Procs.GetCount(); i++) delete Procs[i];
+}
+
+
+void emServerProcPool::Proc::WriteLine(const char * str)
+{
+	emDLog("emServerProcPool: Sending to %s server: %s",Pool.Name.Get(),str);
+	WriteBuf.Add(str,strlen(str));
+	WriteBuf.Add((char)'\n');
+}
+
+
+emString emServerProcPool::Proc::ReadLine()
+{
+	emString res;
+	char * p;
+	int l;
+
+	if (!ReadBuf.IsEmpty()) {
+		p=(char*)memchr(ReadBuf.Get(),'\n',ReadBuf.GetCount());
+		if (p) {
+			l=p-ReadBuf.Get();
+			res=emString(ReadBuf.Get(),l);
+			ReadBuf.Remove(0,l+1);
+		}
+	}
+	if (!res.IsEmpty()) {
+		emDLog(
+			"emServerProcPool: Receiving from %s server: %s",
+			Pool.Name.Get(),res.Get()
+		);
+	}
+	return res;
+}
+
+
+emServerProcPool::Proc::Proc(emServerProcPool & pool)
+	: Pool(pool)
+{
+	RunId=0;
+	InstanceCount=0;
+	IdleClock=0;
+	Terminating=false;
+	RunningJobs=0;
+	CostlyJobs=0;
+	ReadBuf.SetTuningLevel(4);
+	WriteBuf.SetTuningLevel(4);
+	ShmSize=0;
+#if defined(_WIN32) || defined(__CYGWIN__)
+	ShmId[0]=0;
+	ShmHdl=NULL;
+#else
+	ShmId=-1;
+#endif
+	ShmPtr=NULL;
+	ShmAllocBegin=0;
+	ShmAllocEnd=0;
+}
+
+
+emServerProcPool::Proc::~Proc()
+{
+	Process.Terminate();
+	FreeShm();
+}
+
+
+void emServerProcPool::Proc::TryStart(emUInt64 runId)
+{
+	ReadBuf.Clear();
+	WriteBuf.Clear();
+	InstanceCount=0;
+	IdleClock=emGetClockMS();
+	RunningJobs=0;
+	CostlyJobs=0;
+	ShmAllocBegin=0;
+	ShmAllocEnd=0;
+	if (ShmSize<MIN_SHM_SIZE) {
+		TryAllocShm(MIN_SHM_SIZE);
+	}
+	emDLog("emServerProcPool: Starting %s server process",Pool.Name.Get());
+	Process.TryStart(
+		emArray<emString>(Pool.ProcPath),
+		emArray<emString>(),
+		NULL,
+		emProcess::SF_PIPE_STDIN|
+		emProcess::SF_PIPE_STDOUT|
+		emProcess::SF_SHARE_STDERR|
+		emProcess::SF_NO_WINDOW
+	);
+	TryWriteAttachShm();
+	RunId=runId;
+}
+
+
+void emServerProcPool::Proc::TryWriteAttachShm()
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+	WriteLine(emString::Format("attachshm %s",ShmId));
+#else
+	WriteLine(emString::Format("attachshm %d",ShmId));
+#endif
+}
+
+
+bool emServerProcPool::Proc::TryIO()
+{
+	char buf[256];
+	bool progress;
+	int r;
+
+	progress=false;
+
+	if (!WriteBuf.IsEmpty()) {
+		r=Process.TryWrite(WriteBuf.Get(),WriteBuf.GetCount());
+		if (r<0) {
+			throw emException(
+				"%s server process died unexpectedly.",Pool.Name.Get()
+			);
+		}
+		if (r>0) {
+			WriteBuf.Remove(0,r);
+			progress=true;
+		}
+	}
+
+	while (ReadBuf.GetCount()<65536) {
+		r=Process.TryRead(buf,sizeof(buf));
+		if (r<0) {
+			throw emException(
+				"%s server process died unexpectedly.",Pool.Name.Get()
+			);
+		}
+		if (r==0) break;
+		ReadBuf.Add(buf,r);
+		progress=true;
+	}
+
+	return progress;
+}
+
+
+void emServerProcPool::Proc::TryAllocShm(int size)
+{
+	FreeShm();
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+
+	static emThreadMiniMutex sharedCounterMutex;
+	static unsigned long sharedCounter=0;
+	unsigned long counter;
+
+	sharedCounterMutex.Lock();
+	counter=sharedCounter++;
+	sharedCounterMutex.Unlock();
+
+	sprintf(
+		ShmId,
+		"Local\\emServerProcPool.%lX.%lX.%lX.%lX",
+		(unsigned long)GetCurrentProcessId(),
+		counter,
+		(unsigned long)GetTickCount(),
+		(unsigned long)emGetUInt64Random(0,0xffffffff) //???
+	);
+	emDLog("emServerProcPool: ShmId=%s",ShmId);
+
+	SetLastError(ERROR_SUCCESS);
+	ShmHdl=CreateFileMapping(
+		INVALID_HANDLE_VALUE,NULL,PAGE_READWRITE|SEC_COMMIT,
+		0,size,ShmId
+	);
+	if (!ShmHdl || GetLastError()==ERROR_ALREADY_EXISTS) {
+		if (ShmHdl) {
+			CloseHandle(ShmHdl);
+			ShmHdl=NULL;
+		}
+		ShmId[0]=0;
+		throw emException(
+			"Failed to create shared memory segment: CreateFileMapping: %s",
+			emGetErrorText(GetLastError()).Get()
+		);
+	}
+
+	ShmPtr=(emByte*)MapViewOfFile(ShmHdl,FILE_MAP_ALL_ACCESS,0,0,0);
+	if (!ShmPtr) {
+		CloseHandle(ShmHdl);
+		ShmHdl=NULL;
+		ShmId[0]=0;
+		throw emException(
+			"Failed to create shared memory segment: MapViewOfFile: %s",
+			emGetErrorText(GetLastError()).Get()
+		);
+	}
+
+#else
+
+	ShmId=shmget(IPC_PRIVATE,size,IPC_CREAT|0600);
+	if (ShmId==-1) {
+		throw emException(
+			"Failed to create shared memory segment: %s",
+			emGetErrorText(errno).Get()
+		);
+	}
+
+	ShmPtr=(emByte*)shmat(ShmId,NULL,0);
+	if (ShmPtr==(emByte*)-1) {
+		ShmPtr=NULL;
+		shmctl(ShmId,IPC_RMID,NULL);
+		ShmId=-1;
+		throw emException(
+			"Failed to attach shared memory segment: %s",
+			emGetErrorText(errno).Get()
+		);
+	}
+
+#if defined(__linux__)
+	if (shmctl(ShmId,IPC_RMID,NULL)!=0) {
+		emFatalError(
+			"emServerProcPool: shmctl failed: %s",
+			emGetErrorText(errno).Get()
+		);
+	}
+#endif
+
+#endif
+
+	ShmSize=size;
+}
+
+
+void emServerProcPool::Proc::FreeShm()
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+	if (ShmPtr) {
+		UnmapViewOfFile(ShmPtr);
+		ShmPtr=NULL;
+	}
+	if (ShmHdl) {
+		CloseHandle(ShmHdl);
+		ShmHdl=NULL;
+	}
+	ShmId[0]=0;
+#else
+	if (ShmPtr) {
+		shmdt(ShmPtr);
+		ShmPtr=NULL;
+	}
+	if (ShmId!=-1) {
+#if !defined(__linux__)
+		if (shmctl(ShmId,IPC_RMID,NULL)!=0) {
+			emFatalError(
+				"emServerProcPool: shmctl failed: %s",
+				emGetErrorText(errno).Get()
+			);
+		}
+#endif
+		ShmId=-1;
+	}
+#endif
+	ShmSize=0;
+	ShmAllocBegin=0;
+	ShmAllocEnd=0;
+}
+
+
+emServerProcPool::InstanceMap::InstanceMap()
+	: OpenFailures(0)
+{
+	Entries.SetTuningLevel(4);
+}
+
+
+int emServerProcPool::GetInstanceId(
+	const InstanceMap & map, int procIndex
+) const
+{
+	const InstanceMap::Entry * e;
+	int i;
+
+	for (i=map.Entries.GetCount()-1; i>=0; i--) {
+		e=&map.Entries[i];
+		if (e->ProcIndex==procIndex) {
+			if (e->ProcRunId!=Procs[procIndex]->RunId) break;
+			return e->InstanceId;
+		}
+	}
+	return INST_NONE;
+}
+
+
+void emServerProcPool::SetInstanceId(
+	InstanceMap & map, int procIndex, int instanceId
+)
+{
+	InstanceMap::Entry * e;
+	int i;
+
+	for (i=map.Entries.GetCount()-1; i>=0; i--) {
+		if (map.Entries[i].ProcIndex==procIndex) break;
+	}
+	if (i<0) {
+		i=map.Entries.GetCount();
+		map.Entries.AddNew();
+	}
+	e=&map.Entries.GetWritable(i);
+	e->ProcIndex=procIndex;
+	e->ProcRunId=Procs[procIndex]->RunId;
+	e->InstanceId=instanceId;
+	if (instanceId>=0) {
+		Procs[procIndex]->InstanceCount++;
+		map.OpenFailures=0;
+	}
+}
+
+
+void emServerProcPool::SetOpenFailed(InstanceMap & map, int procIndex)
+{
+	SetInstanceId(map,procIndex,INST_FAILED);
+	map.OpenFailures++;
+}
+
+
+int emServerProcPool::AssignProc(
+	const InstanceMap * map, bool costly, int * pOpenProc, bool * pFailed
+)
+{
+	const InstanceMap::Entry * e;
+	const Proc * proc;
+	int i,best;
+	bool opening;
+
+	*pOpenProc=-1;
+	*pFailed=false;
+	best=-1;
+
+	if (!map) {
+		// Opening a new document: on an idle process, or on a new
+		// process, or on the least busy process.
+		for (i=0; i<Procs.GetCount(); i++) {
+			proc=Procs[i];
+			if (!proc->RunId) continue;
+			if (costly && proc->CostlyJobs>=MAX_COSTLY_JOBS_PER_PROC) continue;
+			if (best<0 || proc->RunningJobs<Procs[best]->RunningJobs) best=i;
+		}
+		if (best<0 || Procs[best]->RunningJobs>0) {
+			i=TryStartProc();
+			if (i>=0) best=i;
+		}
+		return best;
+	}
+
+	// The document is affine to the processes which have it opened
+	// already. Take the least busy of them.
+	opening=false;
+	for (i=0; i<map->Entries.GetCount(); i++) {
+		e=&map->Entries[i];
+		proc=Procs[e->ProcIndex];
+		if (e->ProcRunId!=proc->RunId) continue;
+		if (e->InstanceId==INST_FAILED) continue;
+		if (e->InstanceId==INST_OPENING) {
+			opening=true;
+			continue;
+		}
+		if (costly && proc->CostlyJobs>=MAX_COSTLY_JOBS_PER_PROC) continue;
+		if (best<0 || proc->RunningJobs<Procs[best]->RunningJobs) {
+			best=e->ProcIndex;
+		}
+	}
+	if (best>=0) return best;
+
+	// Those processes are busy (or gone). Open the document on an idle
+	// process, or on a new one, so that the jobs are spread over the
+	// pool.
+	if (map->OpenFailures<MAX_OPEN_FAILURES) {
+		for (i=0; i<Procs.GetCount(); i++) {
+			proc=Procs[i];
+			if (!proc->RunId || proc->RunningJobs>0) continue;
+			if (GetInstanceId(*map,i)!=INST_NONE) continue;
+			*pOpenProc=i;
+			return -1;
+		}
+		i=TryStartProc();
+		if (i>=0) *pOpenProc=i;
+	}
+	else if (!opening) {
+		for (i=0; i<map->Entries.GetCount(); i++) {
+			e=&map->Entries[i];
+			if (
+				e->InstanceId>=0 &&
+				e->ProcRunId==Procs[e->ProcIndex]->RunId
+			) break;
+		}
+		if (i>=map->Entries.GetCount()) *pFailed=true;
+	}
+	return -1;
+}
+
+
+int emServerProcPool::TryStartProc()
+{
+	int i,n;
+
+	if (!StartError.IsEmpty()) return -1;
+
+	for (i=0, n=0; i<Procs.GetCount(); i++) {
+		if (Procs[i]->RunId || Procs[i]->Terminating) n++;
+	}
+	if (n>=GetMaxProcs()) return -1;
+
+	for (i=0; i<Procs.GetCount(); i++) {
+		if (!Procs[i]->RunId && !Procs[i]->Terminating) break;
+	}
+	if (i>=Procs.GetCount()) Procs.Add(new Proc(*this));
+
+	try {
+		Procs[i]->TryStart(NextRunId++);
+	}
+	catch (const emException & exception) {
+		StartError=exception.GetText();
+		return -1;
+	}
+	return i;
+}
+
+
+bool emServerProcPool::IsAnyProcRunning() const
+{
+	int i;
+
+	for (i=0; i<Procs.GetCount(); i++) {
+		if (Procs[i]->RunId) return true;
+	}
+	return false;
+}
+
+
+void emServerProcPool::AbandonProc(int procIndex)
+{
+	Proc * proc;
+
+	proc=Procs[procIndex];
+	if (proc->Process.IsRunning()) proc->Process.SendTerminationSignal();
+	proc->Terminating=true;
+	proc->RunId=0;
+	proc->InstanceCount=0;
+	proc->RunningJobs=0;
+	proc->CostlyJobs=0;
+	proc->ReadBuf.Clear();
+	proc->WriteBuf.Clear();
+	proc->ShmAllocBegin=0;
+	proc->ShmAllocEnd=0;
+}
+
+
+void emServerProcPool::ClearLoads()
+{
+	int i;
+
+	for (i=0; i<Procs.GetCount(); i++) {
+		Procs[i]->RunningJobs=0;
+		Procs[i]->CostlyJobs=0;
+	}
+}
+
+
+void emServerProcPool::AddLoad(int procIndex, bool costly)
+{
+	Proc * proc;
+
+	proc=Procs[procIndex];
+	proc->RunningJobs++;
+	if (costly) proc->CostlyJobs++;
+	proc->IdleClock=emGetClockMS();
+}
+
+
+void emServerProcPool::TerminateIdleProcs()
+{
+	Proc * proc;
+	emUInt64 now;
+	int i;
+
+	now=emGetClockMS();
+	for (i=0; i<Procs.GetCount(); i++) {
+		proc=Procs[i];
+		if (proc->Terminating) {
+			if (proc->Process.WaitForTermination(0)) proc->Terminating=false;
+		}
+		else if (
+			proc->RunId &&
+			proc->InstanceCount==0 &&
+			proc->RunningJobs==0 &&
+			proc->WriteBuf.IsEmpty() &&
+			now-proc->IdleClock>=IDLE_TIMEOUT
+		) {
+			emDLog(
+				"emServerProcPool: Terminating %s server process %d",
+				Name.Get(),i
+			);
+			proc->Process.CloseWriting();
+			proc->Terminating=true;
+			proc->RunId=0;
+		}
+	}
+}
+
+
+bool emServerProcPool::TryIO(int procIndex)
+{
+	if (!Procs[procIndex]->RunId) return false;
+	return Procs[procIndex]->TryIO();
+}
+
+
+bool emServerProcPool::WaitForBusyProcs(emUInt64 endClock)
+{
+	emArray<emProcess*> busyProcs;
+	emArray<int> busyFlags;
+	Proc * proc;
+	emUInt64 now;
+	int i;
+
+	for (i=0; i<Procs.GetCount(); i++) {
+		proc=Procs[i];
+		if (proc->RunId && (proc->RunningJobs || !proc->WriteBuf.IsEmpty())) {
+			busyProcs.Add(&proc->Process);
+			busyFlags.Add(
+				proc->WriteBuf.IsEmpty() ?
+				emProcess::WF_WAIT_STDOUT :
+				emProcess::WF_WAIT_STDOUT|emProcess::WF_WAIT_STDIN
+			);
+		}
+	}
+	if (busyProcs.IsEmpty()) return false;
+	now=emGetClockMS();
+	if (now>=endClock) return false;
+	emProcess::WaitPipes(
+		busyProcs.Get(),busyFlags.Get(),busyProcs.GetCount(),
+		(unsigned)(endClock-now)
+	);
+	return true;
+}
+
+
+bool emServerProcPool::IsBusy() const
+{
+	const Proc * proc;
+	int i;
+
+	for (i=0; i<Procs.GetCount(); i++) {
+		proc=Procs[i];
+		if (
+			!proc->WriteBuf.IsEmpty() || proc->Terminating ||
+			(proc->RunId && !proc->InstanceCount)
+		) return true;
+	}
+	return false;
+}
+
+
+int emServerProcPool::TryAllocShmRange(int procIndex, int size)
+{
+	Proc * proc;
+	int offset;
+
+	proc=Procs[procIndex];
+	if (!proc->RunningJobs || proc->ShmAllocBegin==proc->ShmAllocEnd) {
+		if (size>proc->ShmSize) {
+			if (proc->RunningJobs) return -1;
+			proc->TryAllocShm(size);
+			proc->TryWriteAttachShm();
+		}
+		proc->ShmAllocBegin=0;
+		proc->ShmAllocEnd=0;
+	}
+	else if (proc->ShmAllocEnd<proc->ShmAllocBegin) {
+		if (proc->ShmAllocEnd+size>=proc->ShmAllocBegin) return -1;
+	}
+	else if (proc->ShmAllocEnd+size>proc->ShmSize) {
+		if (size>=proc->ShmAllocBegin) return -1;
+		proc->ShmAllocEnd=0;
+	}
+	offset=proc->ShmAllocEnd;
+	proc->ShmAllocEnd+=size;
+	return offset;
+}
+
+
+void emServerProcPool::FreeShmRange(int procIndex, int offset, int size)
+{
+	Procs[procIndex]->ShmAllocBegin=offset+size;
+}
+
+
+int emServerProcPool::GetMaxProcs() const
+{
+	int n;
+
+	n=emMin(
+		emThread::GetHardwareThreadCount(),
+		CoreConfig->MaxRenderThreads.Get()
+	);
+	return emMax(n,1);
+}
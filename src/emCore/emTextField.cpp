@@ -38,6 +38,10 @@ emTextField::emTextField(
 	OverwriteMode=false;
 	Text=text;
 	TextLen=Text.GetLen();
+	RowStarts.SetTuningLevel(4);
+	RowMBStates.SetTuningLevel(4);
+	RowCols.SetTuningLevel(4);
+	RebuildRows();
 	CursorIndex=TextLen;
 	SelectionStartIndex=0;
 	SelectionEndIndex=0;
@@ -90,6 +94,7 @@ void emTextField::SetMultiLineMode(bool multiLineMode)
 {
 	if (MultiLineMode!=multiLineMode) {
 		MultiLineMode=multiLineMode;
+		RebuildRows();
 		InvalidatePainting();
 	}
 }
@@ -121,6 +126,7 @@ void emTextField::SetText(const emString & text)
 	ClearRedo();
 	Text=text;
 	TextLen=Text.GetLen();
+	RebuildRows();
 	CursorIndex=TextLen;
 	MagicCursorColumn=-1;
 	InvalidatePainting();
@@ -529,11 +535,10 @@ void emTextField::Input(
 		i1=SelectionStartIndex;
 		i2=SelectionEndIndex;
 		if (i1<i2 && IsEditable() && IsEnabled()) {
-			str=Text.Extract(i1,i2-i1);
-			TextLen-=i2-i1;
+			str=Text.GetSubString(i1,i2-i1);
+			ReplaceText(i1,i2-i1,emString());
 			i=ColRow2Index(mc-DragPosC,mr-DragPosR+0.5,true);
-			Text.Insert(i1,str);
-			TextLen+=i2-i1;
+			ReplaceText(i1,0,str);
 			if (i!=i1) {
 				if (i1<i) {
 					i+=i2-i1;
@@ -905,7 +910,7 @@ void emTextField::DoTextField(
 	emString txt;
 	double xy[10*2];
 	double x,y,w,h,r,ws,d,d1,d2,cx,cy,cw,ch,dx,dy,tx,ty,tw,th;
-	int i,i0,j,n,c,rows,cols,col,row,col0,row0,selIdx,selEnd;
+	int i,i0,j,n,c,rows,cols,col,row,col0,row0,rowEnd,selIdx,selEnd;
 	bool selected,selected0;
 
 	GetContentRoundRect(&x,&y,&w,&h,&r);
@@ -990,14 +995,23 @@ void emTextField::DoTextField(
 		painter->PaintPolygon(xy,8,selColor,canvasColor);
 	}
 
-	row0=0;
+	// Paint only the rows within the clip rectangle.
+	d=(painter->GetUserClipY1()-ty)/ch;
+	row=0;
+	if (d>=rows) row=rows-1;
+	else if (d>=1.0) row=(int)d;
+	d=(painter->GetUserClipY2()-ty)/ch;
+	rowEnd=rows;
+	if (d<row+1) rowEnd=row+1;
+	else if (d<rows) rowEnd=(int)ceil(d);
+
+	row0=row;
 	col0=0;
-	i0=0;
+	i0=RowStarts[row];
 	selected0=(i0>=selIdx && i0<selEnd);
-	row=0;
 	col=0;
-	emMBState mbState;
-	for (i=0;;) {
+	emMBState mbState=RowMBStates[row];
+	for (i=i0;;) {
 		n=emDecodeChar(&c,Text.Get()+i,INT_MAX,&mbState);
 		selected=(i>=selIdx && i<selEnd);
 		if (
@@ -1045,6 +1059,7 @@ void emTextField::DoTextField(
 				if (c==0x0d && Text[i]==0x0a) i++;
 				col=0;
 				row++;
+				if (row>=rowEnd) break;
 				row0=row;
 				col0=col;
 				i0=i;
@@ -1290,8 +1305,7 @@ void emTextField::ModifyText(
 
 	EmptySelection();
 
-	Text.Replace(pos,removeLen,insertText);
-	TextLen+=insertLen-removeLen;
+	ReplaceText(pos,removeLen,insertText);
 	CursorIndex=pos+insertLen;
 	MagicCursorColumn=-1;
 	InvalidatePainting();
@@ -1304,6 +1318,147 @@ void emTextField::ModifyText(
 }
 
 
+void emTextField::ReplaceText(
+	int pos, int removeLen, const emString & insertText
+)
+{
+	int insertLen;
+
+	insertLen=insertText.GetLen();
+	Text.Replace(pos,removeLen,insertText);
+	TextLen+=insertLen-removeLen;
+	UpdateRows(pos,removeLen,insertLen);
+}
+
+
+void emTextField::RebuildRows()
+{
+	// This is like inserting the whole text into an empty text.
+	RowStarts.Clear();
+	RowMBStates.Clear();
+	RowCols.Clear();
+	RowStarts.Add(0);
+	RowMBStates.Add(emMBState());
+	RowCols.Add(0);
+	MaxRowCols=0;
+	UpdateRows(0,0,TextLen);
+}
+
+
+void emTextField::UpdateRows(int pos, int removeLen, int insertLen)
+{
+	emArray<int> starts,cols;
+	emArray<emMBState> states;
+	const char * p;
+	int * q;
+	int r1,r2,i,j,n,c,col,count,delta,maxCols;
+	bool synced,maxRemoved;
+
+	starts.SetTuningLevel(4);
+	states.SetTuningLevel(4);
+	cols.SetTuningLevel(4);
+
+	// Rescan from the beginning of the row before the modification,
+	// because a CR at the end of that row may have been joined with or
+	// separated from an LF.
+	r1=GetRowIndex(pos);
+	if (r1>0) r1--;
+
+	// Rows from r2 on begin behind the modification. The rescan stops
+	// as soon as it meets the (shifted) beginning of one of them again.
+	count=RowStarts.GetCount();
+	delta=insertLen-removeLen;
+	r2=GetRowIndex(pos+removeLen);
+	if (RowStarts[r2]<pos+removeLen) r2++;
+
+	p=Text.Get();
+	i=RowStarts[r1];
+	emMBState mbState=RowMBStates[r1];
+	starts.Add(i);
+	states.Add(mbState);
+	col=0;
+	synced=false;
+	for (;;) {
+		n=emDecodeChar(&c,p+i,INT_MAX,&mbState);
+		if (c==0) break;
+		i+=n;
+		if (c>0x0d || !MultiLineMode) {
+			col++;
+		}
+		else if (c==0x09) {
+			col=(col+8)&~7;
+		}
+		else if (c==0x0a || c==0x0d) {
+			if (c==0x0d && p[i]==0x0a) i++;
+			cols.Add(col);
+			col=0;
+			while (r2<count && RowStarts[r2]+delta<i) r2++;
+			if (
+				r2<count && RowStarts[r2]+delta==i &&
+				memcmp(&RowMBStates[r2],&mbState,sizeof(emMBState))==0
+			) {
+				synced=true;
+				break;
+			}
+			starts.Add(i);
+			states.Add(mbState);
+		}
+		else {
+			col++;
+		}
+	}
+	if (!synced) {
+		cols.Add(col);
+		r2=count;
+	}
+
+	maxRemoved=false;
+	for (j=r1; j<r2; j++) {
+		if (RowCols[j]>=MaxRowCols) maxRemoved=true;
+	}
+	maxCols=0;
+	for (j=0; j<cols.GetCount(); j++) {
+		if (maxCols<cols[j]) maxCols=cols[j];
+	}
+
+	RowStarts.Replace(r1,r2-r1,starts);
+	RowMBStates.Replace(r1,r2-r1,states);
+	RowCols.Replace(r1,r2-r1,cols);
+	if (delta) {
+		count=RowStarts.GetCount();
+		q=RowStarts.GetWritable();
+		for (j=r1+starts.GetCount(); j<count; j++) q[j]+=delta;
+	}
+
+	if (maxCols>=MaxRowCols) {
+		MaxRowCols=maxCols;
+	}
+	else if (maxRemoved) {
+		count=RowCols.GetCount();
+		MaxRowCols=0;
+		for (j=0; j<count; j++) {
+			if (MaxRowCols<RowCols[j]) MaxRowCols=RowCols[j];
+		}
+	}
+}
+
+
+int emTextField::GetRowIndex(int index) const
+{
+	const int * p;
+	int i1,i2,i;
+
+	p=RowStarts.Get();
+	i1=0;
+	i2=RowStarts.GetCount();
+	while (i2-i1>1) {
+		i=(i1+i2)>>1;
+		if (p[i]<=index) i1=i; else i2=i;
+	}
+	return i1;
+}
+
+
 void emTextField::SetDragMode(DragModeType dragMode)
 {
 	if (DragMode!=dragMode) {
@@ -1368,17 +1523,12 @@ int emTextField::ColRow2Index(double column, double row, bool forCursor) const
 		}
 	}
 	else {
-		emMBState mbState,mbState2;
-		for (j=0, i=0; row>=1.0; ) {
-			j+=emDecodeChar(&c,Text.Get()+j,INT_MAX,&mbState);
-			if (c==0x0a || c==0x0d) {
-				if (c==0x0d && Text[j]==0x0a) j++;
-				mbState2=mbState;
-				i=j;
-				row-=1.0;
-			}
-			if (c==0) break;
-		}
+		n=RowStarts.GetCount()-1;
+		if (row<1.0) k=0;
+		else if (row>=n) k=n;
+		else k=(int)row;
+		i=RowStarts[k];
+		emMBState mbState2=RowMBStates[k];
 		for (j=0; ; i+=n, j=k) {
 			n=emDecodeChar(&c,Text.Get()+i,INT_MAX,&mbState2);
 			if (c==0x0a || c==0x0d || c==0) break;
@@ -1411,10 +1561,10 @@ void emTextField::Index2ColRow(int index, int * pColumn, int * pRow) const
 		row=0;
 	}
 	else {
+		row=GetRowIndex(index);
 		col=0;
-		row=0;
-		emMBState mbState;
-		for (i=0; i<index; i+=n) {
+		emMBState mbState=RowMBStates[row];
+		for (i=RowStarts[row]; i<index; i+=n) {
 			n=emDecodeChar(&c,Text.Get()+i,INT_MAX,&mbState);
 			if (c==0x09) {
 				col=(col+8)&~7;
@@ -1439,38 +1589,10 @@ void emTextField::Index2ColRow(int index, int * pColumn, int * pRow) const
 
 void emTextField::CalcTotalColsRows(int * pCols, int * pRows) const
 {
-	int i,cols,rows,rowcols,n,c;
-
-	if (!MultiLineMode) {
-		cols=emGetDecodedCharCount(Text);
-		rows=1;
-	}
-	else {
-		cols=0;
-		rows=1;
-		rowcols=0;
-		emMBState mbState;
-		for (i=0; ; i+=n) {
-			n=emDecodeChar(&c,Text.Get()+i,INT_MAX,&mbState);
-			if (c==0x09) {
-				rowcols=(rowcols+8)&~7;
-			}
-			else if (c==0x0a || c==0x0d) {
-				if (cols<rowcols) cols=rowcols;
-				if (c==0x0d && Text[i+1]==0x0a) n++;
-				rowcols=0;
-				rows++;
-			}
-			else if (c==0) {
-				break;
-			}
-			else {
-				rowcols++;
-			}
-		}
-		if (cols<rowcols) cols=rowcols;
-	}
+	int cols,rows;
 
+	cols=MaxRowCols;
+	rows=RowStarts.GetCount();
 	if (cols<1) cols=1;
 	if (rows<1) rows=1;
 	*pCols=cols;
@@ -1480,10 +1602,11 @@ void emTextField::CalcTotalColsRows(int * pCols, int * pRows) const
 
 int emTextField::GetNormalizedIndex(int index) const
 {
-	int i,j;
+	int i,j,r;
 
-	emMBState mbState;
-	for (i=0; ; i=j) {
+	r=GetRowIndex(index);
+	emMBState mbState=RowMBStates[r];
+	for (i=RowStarts[r]; ; i=j) {
 		j=GetNextIndex(i,&mbState);
 		if (j>index || j==i) return i;
 	}
@@ -1507,10 +1630,11 @@ void emTextField::ModifySelection(int oldIndex, int newIndex, bool publish)
 
 emMBState emTextField::GetMBStateAtIndex(int index) const
 {
-	int i,j;
+	int i,j,r;
 
-	emMBState mbState;
-	for (i=0; ; i=j) {
+	r=GetRowIndex(index);
+	emMBState mbState=RowMBStates[r];
+	for (i=RowStarts[r]; ; i=j) {
 		j=GetNextIndex(i,&mbState);
 		if (j>index || j==i) return mbState;
 	}
@@ -1535,10 +1659,11 @@ int emTextField::GetNextIndex(int index, emMBState * mbState) const
 
 int emTextField::GetPrevIndex(int index) const
 {
-	int i,j;
+	int i,j,r;
 
-	emMBState mbState;
-	for (i=0; ; i=j) {
+	r=GetRowIndex(index-1);
+	emMBState mbState=RowMBStates[r];
+	for (i=RowStarts[r]; ; i=j) {
 		j=GetNextIndex(i,&mbState);
 		if (j>=index || j==i) return i;
 	}
@@ -1601,12 +1726,18 @@ int emTextField::GetPrevWordBoundaryIndex(
 	int index, bool * pIsDelimiter
 ) const
 {
-	int i,j;
-
-	emMBState mbState;
-	for (i=0; ; i=j) {
-		j=GetNextWordBoundaryIndex(i,pIsDelimiter,&mbState);
-		if (j>=index || j==i) return i;
+	int i,j,r;
+
+	// Search from the beginning of the row. If there is no boundary
+	// between that and the index, the row start may not be a boundary,
+	// and the search is repeated from the row before.
+	for (r=GetRowIndex(index-1); ; r--) {
+		emMBState mbState=RowMBStates[r];
+		for (i=RowStarts[r]; ; i=j) {
+			j=GetNextWordBoundaryIndex(i,pIsDelimiter,&mbState);
+			if (j>=index || j==i) break;
+		}
+		if (i>RowStarts[r] || r<=0) return i;
 	}
 }
 
@@ -1631,28 +1762,24 @@ int emTextField::GetNextWordIndex(int index, emMBState * mbState) const
 
 int emTextField::GetPrevWordIndex(int index) const
 {
-	int i,j;
-
-	emMBState mbState;
-	for (i=0; ; i=j) {
-		j=GetNextWordIndex(i,&mbState);
-		if (j>=index || j==i) return i;
+	int i,j,r;
+
+	// Like with GetPrevWordBoundaryIndex(..).
+	for (r=GetRowIndex(index-1); ; r--) {
+		emMBState mbState=RowMBStates[r];
+		for (i=RowStarts[r]; ; i=j) {
+			j=GetNextWordIndex(i,&mbState);
+			if (j>=index || j==i) break;
+		}
+		if (i>RowStarts[r] || r<=0) return i;
 	}
 }
 
 
 int emTextField::GetRowStartIndex(int index) const
 {
-	int i,j,c;
-
 	if (!MultiLineMode) return 0;
-	emMBState mbState;
-	for (i=0, j=0; ; ) {
-		i+=emDecodeChar(&c,Text.Get()+i,INT_MAX,&mbState);
-		if (c==0x0d && Text[i]==0x0a) i++;
-		if (c==0 || i>index) return j;
-		if (c==0x0a || c==0x0d) j=i;
-	}
+	return RowStarts[GetRowIndex(index)];
 }
 
 
@@ -1692,13 +1819,8 @@ int emTextField::GetNextRowIndex(int index, emMBState * mbState) const
 
 int emTextField::GetPrevRowIndex(int index) const
 {
-	int i,j;
-
-	emMBState mbState;
-	for (i=0; ; i=j) {
-		j=GetNextRowIndex(i,&mbState);
-		if (j>=index || j==i) return i;
-	}
+	if (!MultiLineMode || index<=0) return 0;
+	return RowStarts[GetRowIndex(index-1)];
 }
 
 
@@ -1725,10 +1847,22 @@ int emTextField::GetNextParagraphIndex(int index, emMBState * mbState) const
 
 int emTextField::GetPrevParagraphIndex(int index) const
 {
-	int i,j;
+	const char * p;
+	int i,j,r;
 
-	emMBState mbState;
-	for (i=0; ; i=j) {
+	// Start the search at a row where GetNextParagraphIndex(..) would
+	// stop when coming from the beginning: a non-empty row behind an
+	// empty row, but not behind the first row.
+	p=Text.Get();
+	for (r=GetRowIndex(index-1); r>0; r--) {
+		if (
+			r>=2 &&
+			p[RowStarts[r]]!=0x0a && p[RowStarts[r]]!=0x0d &&
+			(p[RowStarts[r-1]]==0x0a || p[RowStarts[r-1]]==0x0d)
+		) break;
+	}
+	emMBState mbState=RowMBStates[r];
+	for (i=RowStarts[r]; ; i=j) {
 		j=GetNextParagraphIndex(i,&mbState);
 		if (j>=index || j==i) return i;
 	}
@@ -0,0 +1,327 @@
+//------------------------------------------------------------------------------
+// emTileCache.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emCore/emTileCache.h>
+
+
+emTileCache::emTileCache(emScheduler & scheduler)
+	: emEngine(scheduler),
+	LruFirst(NULL),
+	LruLast(NULL),
+	Memory(0),
+	SetupCount(0)
+{
+	Tiles.SetTuningLevel(4);
+}
+
+
+emTileCache::~emTileCache()
+{
+	int i;
+
+	// The derived class has called Reset() already, normally.
+	for (i=0; i<Tiles.GetCount(); i++) delete Tiles[i];
+}
+
+
+void emTileCache::Reset()
+{
+	while (!Tiles.IsEmpty()) RemoveTile(Tiles.GetCount()-1);
+	Memory=0;
+	SetupCount++;
+}
+
+
+int emTileCache::GetLevel(double pixelsPerUnit)
+{
+	int level;
+
+	if (pixelsPerUnit<=GetScale(MIN_LEVEL)) return MIN_LEVEL;
+	if (pixelsPerUnit>=GetScale(MAX_LEVEL)) return MAX_LEVEL;
+	frexp(pixelsPerUnit,&level);
+	if (GetScale(level-1)>=pixelsPerUnit) level--;
+	return level;
+}
+
+
+emInt64 emTileCache::GetTileCountX(int page, int level) const
+{
+	double w,h;
+
+	if (!GetPageSize(page,&w,&h)) return 0;
+	return (emInt64)ceil(w*GetScale(level)/TILE_SIZE);
+}
+
+
+emInt64 emTileCache::GetTileCountY(int page, int level) const
+{
+	double w,h;
+
+	if (!GetPageSize(page,&w,&h)) return 0;
+	return (emInt64)ceil(h*GetScale(level)/TILE_SIZE);
+}
+
+
+void emTileCache::RequestTile(
+	int page, int level, emInt64 x, emInt64 y, double priority
+)
+{
+	Tile * t;
+	double scale,pw,ph,tw,th;
+	int i;
+
+	i=FindTile(page,level,x,y);
+	if (i>=0) {
+		t=Tiles[i];
+		if (t->RequestCount<=0) UnlinkLru(t);
+		t->RequestCount++;
+		return;
+	}
+
+	if (!GetPageSize(page,&pw,&ph)) return;
+	scale=GetScale(level);
+	pw*=scale;
+	ph*=scale;
+	tw=ceil(emMin((double)TILE_SIZE,pw-(double)x*TILE_SIZE));
+	th=ceil(emMin((double)TILE_SIZE,ph-(double)y*TILE_SIZE));
+	if (tw<1.0 || th<1.0) return;
+
+	t=new Tile;
+	t->Page=page;
+	t->Level=level;
+	t->X=x;
+	t->Y=y;
+	t->RequestCount=1;
+	t->LruPrev=NULL;
+	t->LruNext=NULL;
+	t->Job=StartTileJob(
+		page,
+		(double)x*TILE_SIZE/scale,(double)y*TILE_SIZE/scale,
+		tw/scale,th/scale,(int)tw,(int)th,
+		priority
+	);
+	if (!t->Job) {
+		delete t;
+		return;
+	}
+	AddWakeUpSignal(t->Job->GetStateSignal());
+	Tiles.Insert(~i,t);
+}
+
+
+void emTileCache::ReleaseTile(int page, int level, emInt64 x, emInt64 y)
+{
+	Tile * t;
+	int i;
+
+	i=FindTile(page,level,x,y);
+	if (i<0) return;
+	t=Tiles[i];
+	if (t->RequestCount<=0) return;
+	t->RequestCount--;
+	if (t->RequestCount>0) return;
+	if (
+		!t->ErrorText.IsEmpty() ||
+		(t->Job && t->Job->GetState()==emJob::ST_WAITING)
+	) {
+		RemoveTile(i);
+	}
+	else {
+		if (!t->Image.IsEmpty()) LinkLru(t);
+		ShrinkCache();
+	}
+}
+
+
+void emTileCache::SetTilePriority(
+	int page, int level, emInt64 x, emInt64 y, double priority
+)
+{
+	int i;
+
+	i=FindTile(page,level,x,y);
+	if (i>=0 && Tiles[i]->Job) Tiles[i]->Job->SetPriority(priority);
+}
+
+
+const emImage * emTileCache::GetTileImage(
+	int page, int level, emInt64 x, emInt64 y
+) const
+{
+	int i;
+
+	i=FindTile(page,level,x,y);
+	if (i<0 || Tiles[i]->Image.IsEmpty()) return NULL;
+	return &Tiles[i]->Image;
+}
+
+
+const emString * emTileCache::GetTileError(
+	int page, int level, emInt64 x, emInt64 y
+) const
+{
+	int i;
+
+	i=FindTile(page,level,x,y);
+	if (i<0 || Tiles[i]->ErrorText.IsEmpty()) return NULL;
+	return &Tiles[i]->ErrorText;
+}
+
+
+const emJob * emTileCache::GetTileJob(
+	int page, int level, emInt64 x, emInt64 y
+) const
+{
+	int i;
+
+	i=FindTile(page,level,x,y);
+	if (i<0) return NULL;
+	return Tiles[i]->Job;
+}
+
+
+bool emTileCache::Cycle()
+{
+	Tile * t;
+	bool changed;
+	int i;
+
+	changed=false;
+	for (i=Tiles.GetCount()-1; i>=0; i--) {
+		t=Tiles[i];
+		if (!t->Job) continue;
+		switch (t->Job->GetState()) {
+		case emJob::ST_ERROR:
+			t->ErrorText=t->Job->GetErrorText();
+			if (t->ErrorText.IsEmpty()) t->ErrorText="unknown error";
+			t->Job=NULL;
+			if (t->RequestCount<=0) RemoveTile(i);
+			changed=true;
+			break;
+		case emJob::ST_ABORTED:
+			RemoveTile(i);
+			break;
+		case emJob::ST_SUCCESS:
+			t->Image=GetTileJobImage(*t->Job);
+			t->Job=NULL;
+			Memory+=GetImageMemory(t->Image);
+			if (t->RequestCount<=0 && !t->Image.IsEmpty()) LinkLru(t);
+			changed=true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (changed) {
+		ShrinkCache();
+		Signal(TileSignal);
+	}
+
+	return false;
+}
+
+
+int emTileCache::FindTile(
+	int page, int level, emInt64 x, emInt64 y
+) const
+{
+	Key key;
+
+	key.Page=page;
+	key.Level=level;
+	key.X=x;
+	key.Y=y;
+	return Tiles.BinarySearchByKey(&key,CompareTileToKey);
+}
+
+
+void emTileCache::RemoveTile(int index)
+{
+	Tile * t;
+
+	t=Tiles[index];
+	if (t->Job) {
+		AbortTileJob(*t->Job);
+		t->Job=NULL;
+	}
+	UnlinkLru(t);
+	Memory-=GetImageMemory(t->Image);
+	Tiles.Remove(index);
+	delete t;
+}
+
+
+void emTileCache::ShrinkCache()
+{
+	Tile * t;
+
+	while (Memory>MAX_MEMORY && LruFirst) {
+		t=LruFirst;
+		RemoveTile(FindTile(t->Page,t->Level,t->X,t->Y));
+	}
+}
+
+
+void emTileCache::LinkLru(Tile * t)
+{
+	t->LruPrev=LruLast;
+	t->LruNext=NULL;
+	if (LruLast) LruLast->LruNext=t; else LruFirst=t;
+	LruLast=t;
+}
+
+
+void emTileCache::UnlinkLru(Tile * t)
+{
+	if (t->LruPrev) t->LruPrev->LruNext=t->LruNext;
+	else if (LruFirst==t) LruFirst=t->LruNext;
+	else return;
+	if (t->LruNext) t->LruNext->LruPrev=t->LruPrev;
+	else LruLast=t->LruPrev;
+	t->LruPrev=NULL;
+	t->LruNext=NULL;
+}
+
+
+emUInt64 emTileCache::GetImageMemory(const emImage & image)
+{
+	return
+		((emUInt64)image.GetWidth())*image.GetHeight()*
+		image.GetChannelCount()
+	;
+}
+
+
+int emTileCache::CompareTileToKey(
+	Tile * const * tile, void * key, void * context
+)
+{
+	const Tile * t;
+	const Key * k;
+
+	t=*tile;
+	k=(const Key*)key;
+	if (t->Page!=k->Page) return t->Page<k->Page ? -1 : 1;
+	if (t->Level!=k->Level) return t->Level<k->Level ? -1 : 1;
+	if (t->Y!=k->Y) return t->Y<k->Y ? -1 : 1;
+	if (t->X!=k->X) return t->X<k->X ? -1 : 1;
+	return 0;
+}
@@ -51,6 +51,8 @@ emDirEntryPanel::emDirEntryPanel(
 	Config=emFileManViewConfig::Acquire(GetView());
 	BgColor=0;
 	RecursiveCall=false;
+	ThumbnailState=TS_UNKNOWN;
+	ThumbnailSize=0;
 
 	AddWakeUpSignal(FileMan->GetSelectionSignal());
 	AddWakeUpSignal(Config->GetChangeSignal());
@@ -63,6 +65,7 @@ emDirEntryPanel::emDirEntryPanel(
 
 emDirEntryPanel::~emDirEntryPanel()
 {
+	if (ThumbnailJob) ThumbnailCache->AbortJob(*ThumbnailJob);
 }
 
 
@@ -82,6 +85,9 @@ void emDirEntryPanel::UpdateDirEntry(const emDirEntry & dirEntry)
 
 	DirEntry=dirEntry;
 
+	ResetThumbnail();
+	UpdateThumbnail();
+
 	InvalidatePainting();
 
 	if (pathChanged || errOrFmtChanged) UpdateContentPanel(true);
@@ -152,8 +158,13 @@ bool emDirEntryPanel::Cycle()
 	if (IsSignaled(FileMan->GetSelectionSignal())) {
 		UpdateBgColor();
 	}
+	if (ThumbnailJob && IsSignaled(ThumbnailJob->GetStateSignal())) {
+		UpdateThumbnail();
+		UpdateContentPanel(false,true);
+	}
 	if (IsSignaled(Config->GetChangeSignal())) {
 		InvalidatePainting();
+		UpdateThumbnail();
 		UpdateContentPanel(false,true);
 		UpdateAltPanel(false,true);
 		UpdateBgColor();
@@ -165,9 +176,15 @@ bool emDirEntryPanel::Cycle()
 void emDirEntryPanel::Notice(NoticeFlags flags)
 {
 	if ((flags&(NF_VIEWING_CHANGED|NF_SOUGHT_NAME_CHANGED|NF_ACTIVE_CHANGED))!=0) {
+		UpdateThumbnail();
 		UpdateContentPanel();
 		UpdateAltPanel();
 	}
+	if ((flags&NF_UPDATE_PRIORITY_CHANGED)!=0) {
+		if (ThumbnailJob) {
+			ThumbnailJob->SetPriority(GetUpdatePriority());
+		}
+	}
 }
 
 
@@ -285,7 +302,7 @@ void emDirEntryPanel::Paint(const emPainter & painter, emColor canvasColor) cons
 	const emFileManTheme * theme;
 	emColor color;
 	emString str;
-	double t;
+	double t,w,h;
 
 	theme = &Config->GetTheme();
 
@@ -463,6 +480,23 @@ void emDirEntryPanel::Paint(const emPainter & painter, emColor canvasColor) cons
 				theme->FileContentColor.Get(),
 				canvasColor
 			);
+			if (!Thumbnail.IsEmpty()) {
+				w=theme->FileContentW;
+				h=w*Thumbnail.GetHeight()/Thumbnail.GetWidth();
+				if (h>theme->FileContentH) {
+					h=theme->FileContentH;
+					w=h*Thumbnail.GetWidth()/Thumbnail.GetHeight();
+				}
+				painter.PaintImage(
+					theme->FileContentX+(theme->FileContentW-w)*0.5,
+					theme->FileContentY+(theme->FileContentH-h)*0.5,
+					w,
+					h,
+					Thumbnail,
+					255,
+					theme->FileContentColor.Get()
+				);
+			}
 		}
 	}
 }
@@ -731,13 +765,24 @@ void emDirEntryPanel::UpdateContentPanel(bool forceRecreation, bool forceRelayou
 	emRef<emFpPluginList> fppl;
 	emPanel * p;
 	const emFileManTheme * theme;
-	double cx,cy,cw,ch;
+	double cx,cy,cw,ch,minVW;
 	emColor cc;
 
 	theme = &Config->GetTheme();
 	p=GetChild(ContentName);
 	if (forceRecreation && p) { delete p; p=NULL; }
 
+	// While a thumbnail can be shown, the content panel is created not
+	// before the thumbnail resolution is exceeded.
+	minVW=theme->MinContentVW;
+	if (
+		ThumbnailState==TS_WANTED ||
+		ThumbnailState==TS_LOADING ||
+		ThumbnailState==TS_LOADED
+	) {
+		minVW=emMax(minVW,(double)emFileManThumbnailCache::LARGE_SIZE);
+	}
+
 	if (DirEntry.IsDirectory()) {
 		cx=theme->DirContentX;
 		cy=theme->DirContentY;
@@ -751,6 +796,7 @@ void emDirEntryPanel::UpdateContentPanel(bool forceRecreation, bool forceRelayou
 		cw=theme->FileContentW;
 		ch=theme->FileContentH;
 		cc=theme->FileContentColor;
+		if (!Thumbnail.IsEmpty()) cc=0;
 	}
 
 	soughtName=GetSoughtName();
@@ -760,14 +806,7 @@ void emDirEntryPanel::UpdateContentPanel(bool forceRecreation, bool forceRelayou
 			soughtName &&
 			strcmp(soughtName,ContentName)==0
 		) ||
-		(
-			IsViewed() &&
-			GetViewedWidth()*cw>=theme->MinContentVW &&
-			PanelToViewX(cx)<GetClipX2() &&
-			PanelToViewX(cx+cw)>GetClipX1() &&
-			PanelToViewY(cy)<GetClipY2() &&
-			PanelToViewY(cy+ch)>GetClipY1()
-		)
+		IsContentAreaViewed(minVW)
 	) {
 		if (!p) {
 			fppl=emFpPluginList::Acquire(GetRootContext());
@@ -791,6 +830,120 @@ void emDirEntryPanel::UpdateContentPanel(bool forceRecreation, bool forceRelayou
 }
 
 
+void emDirEntryPanel::UpdateThumbnail()
+{
+	const emFileManTheme * theme;
+	int size;
+
+	if (ThumbnailState==TS_UNKNOWN) {
+		ThumbnailState=TS_UNSUPPORTED;
+		if (DirEntry.IsRegularFile() && !DirEntry.GetStatErrNo()) {
+			if (!ThumbnailCache) {
+				ThumbnailCache=emFileManThumbnailCache::Acquire(GetRootContext());
+			}
+			if (ThumbnailCache->IsThumbnailable(
+				DirEntry.GetPath(),DirEntry.GetStat()->st_mode
+			)) {
+				ThumbnailState=TS_WANTED;
+			}
+		}
+	}
+
+	if (ThumbnailState==TS_LOADING) {
+		switch (ThumbnailJob->GetState()) {
+		case emJob::ST_WAITING:
+		case emJob::ST_RUNNING:
+			break;
+		case emJob::ST_SUCCESS:
+			Thumbnail=ThumbnailJob->GetImage();
+			ThumbnailSize=ThumbnailJob->GetSize();
+			RemoveWakeUpSignal(ThumbnailJob->GetStateSignal());
+			ThumbnailJob=NULL;
+			ThumbnailState=TS_LOADED;
+			InvalidatePainting();
+			break;
+		default:
+			RemoveWakeUpSignal(ThumbnailJob->GetStateSignal());
+			ThumbnailJob=NULL;
+			ThumbnailState=TS_FAILED;
+			break;
+		}
+	}
+
+	if (
+		ThumbnailState!=TS_WANTED &&
+		ThumbnailState!=TS_LOADING &&
+		ThumbnailState!=TS_LOADED
+	) return;
+
+	theme = &Config->GetTheme();
+	if (IsContentAreaViewed(theme->MinContentVW)) {
+		size=emFileManThumbnailCache::GetSizeFor(
+			GetViewedWidth()*theme->FileContentW
+		);
+		if (
+			ThumbnailState==TS_WANTED ||
+			(ThumbnailState==TS_LOADED && ThumbnailSize<size)
+		) {
+			ThumbnailJob=new emFileManThumbnailCache::LoadJob(
+				DirEntry.GetPath(),size,GetUpdatePriority()
+			);
+			ThumbnailCache->EnqueueJob(*ThumbnailJob);
+			AddWakeUpSignal(ThumbnailJob->GetStateSignal());
+			ThumbnailState=TS_LOADING;
+		}
+	}
+	else if (ThumbnailState==TS_LOADING && !IsInViewedPath()) {
+		RemoveWakeUpSignal(ThumbnailJob->GetStateSignal());
+		ThumbnailCache->AbortJob(*ThumbnailJob);
+		ThumbnailJob=NULL;
+		ThumbnailState = Thumbnail.IsEmpty() ? TS_WANTED : TS_LOADED;
+	}
+}
+
+
+void emDirEntryPanel::ResetThumbnail()
+{
+	if (ThumbnailJob) {
+		RemoveWakeUpSignal(ThumbnailJob->GetStateSignal());
+		ThumbnailCache->AbortJob(*ThumbnailJob);
+		ThumbnailJob=NULL;
+	}
+	Thumbnail.Clear();
+	ThumbnailSize=0;
+	ThumbnailState=TS_UNKNOWN;
+}
+
+
+bool emDirEntryPanel::IsContentAreaViewed(double minContentVW) const
+{
+	const emFileManTheme * theme;
+	double cx,cy,cw,ch;
+
+	theme = &Config->GetTheme();
+	if (DirEntry.IsDirectory()) {
+		cx=theme->DirContentX;
+		cy=theme->DirContentY;
+		cw=theme->DirContentW;
+		ch=theme->DirContentH;
+	}
+	else {
+		cx=theme->FileContentX;
+		cy=theme->FileContentY;
+		cw=theme->FileContentW;
+		ch=theme->FileContentH;
+	}
+	return
+		IsViewed() &&
+		GetViewedWidth()*cw>=minContentVW &&
+		PanelToViewX(cx)<GetClipX2() &&
+		PanelToViewX(cx+cw)>GetClipX1() &&
+		PanelToViewY(cy)<GetClipY2() &&
+		PanelToViewY(cy+ch)>GetClipY1()
+	;
+}
+
+
 void emDirEntryPanel::UpdateAltPanel(bool forceRecreation, bool forceRelayout)
 {
 	const char * soughtName;
@@ -21,6 +21,7 @@
 #include <emFileMan/emFileManControlPanel.h>
 #include <emCore/emInstallInfo.h>
 #include <emCore/emRes.h>
+#include <emFileMan/emFileManJobsPanel.h>
 #include <emFileMan/emFileManSelInfoPanel.h>
 #include <emFileMan/emDirPanel.h>
 
@@ -53,6 +54,7 @@ emFileManControlPanel::emFileManControlPanel(
 	vsLayout->SetOrientationThresholdTallness(0.8);
 	vsLayout->SetChildWeight(0, 5.0);
 	vsLayout->SetChildWeight(1, 3.0);
+	vsLayout->SetChildWeight(2, 2.0);
 	vsLayout->SetInnerSpace(0.04,0.04);
 
 	GrView=new emPackGroup(vsLayout,"view","File View Settings");
@@ -320,6 +322,8 @@ emFileManControlPanel::emFileManControlPanel(
 		BtNames2Clipboard->SetIconAboveCaption();
 		BtNames2Clipboard->SetBorderScaling(0.5);
 
+	new emFileManJobsPanel(vsLayout,"jobs");
+
 	GrCommand=new Group(this,"commands",contentView,FMModel,FMModel->GetCommandRoot());
 	GrCommand->SetCaption("File Manager Commands");
 
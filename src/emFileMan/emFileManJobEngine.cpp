@@ -0,0 +1,864 @@
+//------------------------------------------------------------------------------
+// emFileManJobEngine.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emFileMan/emFileManJobEngine.h>
+#if defined(_WIN32)
+#	include <sys/utime.h>
+#else
+#	include <fcntl.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	if defined(__linux__)
+#		include <sys/ioctl.h>
+#		include <sys/sendfile.h>
+#		include <linux/fs.h>
+#	endif
+#endif
+
+
+//==============================================================================
+//============== emFileManJobEngine::Job::WorkerThread (private) ===============
+//==============================================================================
+
+class emFileManJobEngine::Job::WorkerThread : public emThread {
+
+public:
+
+	WorkerThread(
+		emEngine & engine, OperationType operation,
+		const emArray<emString> & sourcePaths, const emString & targetPath,
+		bool targetIsDir
+	);
+	virtual ~WorkerThread();
+
+	void RequestAbort();
+
+	bool FetchProgress(Job & job);
+		// Copy the progress into the job. Returns whether anything
+		// has changed. The engine is woken up whenever something
+		// changes.
+
+	bool IsFinished();
+	bool HasBeenAborted();
+	emString GetErrorText();
+
+protected:
+
+	virtual int Run(void * arg);
+
+private:
+
+	emString GetTargetFor(const emString & sourcePath) const;
+	void Scan(const emString & path);
+	void CopyEntry(const emString & tgt, const emString & src);
+	void CopyRegularFile(
+		const emString & tgt, const emString & src, const struct em_stat & st
+	);
+	void CopyFileData(
+		int tfd, int sfd, const emString & tgt, const emString & src,
+		emUInt64 size
+	);
+	void RemoveEntry(const emString & path);
+	void SetCurrentPath(const emString & path);
+	void AddDone(emUInt64 bytes, emUInt64 entries);
+	void CheckAbort();
+	void SetChanged();
+	static void ThrowPerErrno(const char * action, const emString & path);
+
+	enum {
+		CHUNK_SIZE = 8*1024*1024,
+		BUF_SIZE = 256*1024
+	};
+
+	emEngine & Engine;
+	OperationType Operation;
+	emArray<emString> SourcePaths;
+	emString TargetPath;
+	bool TargetIsDir;
+
+	emThreadMiniMutex Mutex;
+	bool AbortRequested;
+	bool Finished;
+	bool Aborted;
+	bool Changed;
+	emString ErrorText;
+	emUInt64 TotalBytes;
+	emUInt64 DoneBytes;
+	emUInt64 TotalEntries;
+	emUInt64 DoneEntries;
+	bool Scanning;
+	emString CurrentPath;
+};
+
+
+emFileManJobEngine::Job::WorkerThread::WorkerThread(
+	emEngine & engine, OperationType operation,
+	const emArray<emString> & sourcePaths, const emString & targetPath,
+	bool targetIsDir
+)
+	: Engine(engine),
+	Operation(operation),
+	TargetPath(targetPath.Get()),
+	TargetIsDir(targetIsDir),
+	AbortRequested(false),
+	Finished(false),
+	Aborted(false),
+	Changed(false),
+	TotalBytes(0),
+	DoneBytes(0),
+	TotalEntries(0),
+	DoneEntries(0),
+	Scanning(true)
+{
+	int i;
+
+	// Deep copies, so that the strings are not shared between threads.
+	SourcePaths.SetTuningLevel(1);
+	for (i=0; i<sourcePaths.GetCount(); i++) {
+		SourcePaths.Add(emString(sourcePaths[i].Get()));
+	}
+	Start(NULL);
+}
+
+
+emFileManJobEngine::Job::WorkerThread::~WorkerThread()
+{
+	RequestAbort();
+	WaitForTermination();
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::RequestAbort()
+{
+	Mutex.Lock();
+	AbortRequested=true;
+	Mutex.Unlock();
+}
+
+
+bool emFileManJobEngine::Job::WorkerThread::FetchProgress(Job & job)
+{
+	bool changed;
+
+	Mutex.Lock();
+	changed=Changed;
+	if (changed) {
+		Changed=false;
+		job.TotalBytes=TotalBytes;
+		job.DoneBytes=DoneBytes;
+		job.TotalEntries=TotalEntries;
+		job.DoneEntries=DoneEntries;
+		job.Scanning=Scanning;
+		if (strcmp(job.CurrentPath.Get(),CurrentPath.Get())!=0) {
+			job.CurrentPath=emString(CurrentPath.Get());
+		}
+	}
+	Mutex.Unlock();
+	return changed;
+}
+
+
+bool emFileManJobEngine::Job::WorkerThread::IsFinished()
+{
+	bool finished;
+
+	Mutex.Lock();
+	finished=Finished;
+	Mutex.Unlock();
+	return finished;
+}
+
+
+bool emFileManJobEngine::Job::WorkerThread::HasBeenAborted()
+{
+	bool aborted;
+
+	Mutex.Lock();
+	aborted=Aborted;
+	Mutex.Unlock();
+	return aborted;
+}
+
+
+emString emFileManJobEngine::Job::WorkerThread::GetErrorText()
+{
+	emString errorText;
+
+	Mutex.Lock();
+	errorText=emString(ErrorText.Get());
+	Mutex.Unlock();
+	return errorText;
+}
+
+
+int emFileManJobEngine::Job::WorkerThread::Run(void * arg)
+{
+	emArray<emString> pending;
+	emString src,tgt;
+	int i;
+
+	pending.SetTuningLevel(1);
+
+	try {
+		if (
+			Operation!=OP_REMOVE && !TargetIsDir &&
+			SourcePaths.GetCount()>1
+		) {
+			throw emException(
+				"Failed to %s %d entries to \"%s\": not a directory",
+				Operation==OP_COPY ? "copy" : "move",
+				SourcePaths.GetCount(),
+				TargetPath.Get()
+			);
+		}
+		if (Operation==OP_MOVE) {
+			// Renaming is cheap, so first try that for every source,
+			// and scan only what has to be copied across file
+			// systems.
+			for (i=0; i<SourcePaths.GetCount(); i++) {
+				CheckAbort();
+				src=SourcePaths[i];
+				tgt=GetTargetFor(src);
+				SetCurrentPath(src);
+				if (rename(src.Get(),tgt.Get())==0) continue;
+				if (errno!=EXDEV) ThrowPerErrno("move",src);
+				pending.Add(src);
+			}
+		}
+		else {
+			pending=SourcePaths;
+		}
+
+		for (i=0; i<pending.GetCount(); i++) {
+			Scan(pending[i]);
+		}
+		Mutex.Lock();
+		Scanning=false;
+		SetChanged();
+		Mutex.Unlock();
+
+		for (i=0; i<pending.GetCount(); i++) {
+			src=pending[i];
+			switch (Operation) {
+			case OP_COPY:
+				CopyEntry(GetTargetFor(src),src);
+				break;
+			case OP_MOVE:
+				CopyEntry(GetTargetFor(src),src);
+				RemoveEntry(src);
+				break;
+			case OP_REMOVE:
+				RemoveEntry(src);
+				break;
+			}
+		}
+		SetCurrentPath(emString());
+	}
+	catch (const emException & exception) {
+		Mutex.Lock();
+		if (AbortRequested) Aborted=true;
+		else ErrorText=emString(exception.GetText().Get());
+		Mutex.Unlock();
+	}
+
+	Mutex.Lock();
+	Finished=true;
+	SetChanged();
+	Mutex.Unlock();
+	return 0;
+}
+
+
+emString emFileManJobEngine::Job::WorkerThread::GetTargetFor(
+	const emString & sourcePath
+) const
+{
+	if (TargetIsDir) {
+		return emGetChildPath(TargetPath,emGetNameInPath(sourcePath));
+	}
+	return TargetPath;
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::Scan(const emString & path)
+{
+	emArray<emString> names;
+	struct em_stat st;
+	int i;
+
+	CheckAbort();
+
+	if (em_lstat(path.Get(),&st)!=0) {
+		ThrowPerErrno("get file information of",path);
+	}
+
+	Mutex.Lock();
+	TotalEntries++;
+	if ((st.st_mode&S_IFMT)==S_IFREG && Operation!=OP_REMOVE) {
+		TotalBytes+=st.st_size;
+	}
+	SetChanged();
+	Mutex.Unlock();
+
+	if ((st.st_mode&S_IFMT)==S_IFDIR) {
+		names=emTryLoadDir(path);
+		for (i=0; i<names.GetCount(); i++) {
+			Scan(emGetChildPath(path,names[i]));
+		}
+	}
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::CopyEntry(
+	const emString & tgt, const emString & src
+)
+{
+	emArray<emString> names;
+	struct em_stat st,tst;
+	bool tgtExists;
+	int i;
+
+	CheckAbort();
+	SetCurrentPath(src);
+
+	if (em_lstat(src.Get(),&st)!=0) {
+		ThrowPerErrno("get file information of",src);
+	}
+	tgtExists=(em_lstat(tgt.Get(),&tst)==0);
+
+	if ((st.st_mode&S_IFMT)==S_IFDIR) {
+		i=strlen(src);
+		if (
+			strncmp(tgt.Get(),src.Get(),i)==0 &&
+			(tgt[i]==0 || tgt[i]=='/' || tgt[i]=='\\')
+		) {
+			throw emException(
+				"Cannot copy directory \"%s\" into itself.",
+				src.Get()
+			);
+		}
+		if (tgtExists && (tst.st_mode&S_IFMT)!=S_IFDIR) {
+			throw emException(
+				"Cannot overwrite non-directory \"%s\" with directory \"%s\".",
+				tgt.Get(),src.Get()
+			);
+		}
+		if (!tgtExists) emTryMakeDirectories(tgt,0700);
+		names=emTryLoadDir(src);
+		AddDone(0,1);
+		for (i=0; i<names.GetCount(); i++) {
+			CopyEntry(emGetChildPath(tgt,names[i]),emGetChildPath(src,names[i]));
+		}
+#if defined(_WIN32)
+		struct _utimbuf ut;
+		ut.actime=st.st_atime;
+		ut.modtime=st.st_mtime;
+		_utime(tgt.Get(),&ut);
+#else
+		struct timespec ts[2];
+		chmod(tgt.Get(),st.st_mode&07777);
+		ts[0].tv_sec=st.st_atime;
+		ts[0].tv_nsec=0;
+		ts[1].tv_sec=st.st_mtime;
+		ts[1].tv_nsec=0;
+		utimensat(AT_FDCWD,tgt.Get(),ts,0);
+#endif
+		return;
+	}
+
+	if (tgtExists) {
+		if ((tst.st_mode&S_IFMT)==S_IFDIR) {
+			throw emException(
+				"Cannot overwrite directory \"%s\" with non-directory \"%s\".",
+				tgt.Get(),src.Get()
+			);
+		}
+		if (st.st_dev==tst.st_dev && st.st_ino==tst.st_ino && st.st_ino!=0) {
+			throw emException(
+				"\"%s\" and \"%s\" are the same file.",
+				src.Get(),tgt.Get()
+			);
+		}
+	}
+
+	if ((st.st_mode&S_IFMT)==S_IFREG) {
+		CopyRegularFile(tgt,src,st);
+		return;
+	}
+
+#if defined(_WIN32)
+	throw emException("Cannot copy special file \"%s\".",src.Get());
+#else
+	if (tgtExists && unlink(tgt.Get())!=0) ThrowPerErrno("remove",tgt);
+	if ((st.st_mode&S_IFMT)==S_IFLNK) {
+		char buf[4096];
+		ssize_t len;
+		len=readlink(src.Get(),buf,sizeof(buf)-1);
+		if (len<0) ThrowPerErrno("read symbolic link",src);
+		buf[len]=0;
+		if (symlink(buf,tgt.Get())!=0) ThrowPerErrno("create symbolic link",tgt);
+	}
+	else {
+		if (mknod(tgt.Get(),st.st_mode,st.st_rdev)!=0) {
+			ThrowPerErrno("create special file",tgt);
+		}
+	}
+	AddDone(0,1);
+#endif
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::CopyRegularFile(
+	const emString & tgt, const emString & src, const struct em_stat & st
+)
+{
+#if defined(_WIN32)
+	FILE * sf, * tf;
+	char * buf;
+	size_t len;
+
+	sf=fopen(src.Get(),"rb");
+	if (!sf) ThrowPerErrno("open",src);
+	tf=fopen(tgt.Get(),"wb");
+	if (!tf) {
+		fclose(sf);
+		ThrowPerErrno("create",tgt);
+	}
+	buf=(char*)malloc(BUF_SIZE);
+	try {
+		for (;;) {
+			CheckAbort();
+			len=fread(buf,1,BUF_SIZE,sf);
+			if (ferror(sf)) ThrowPerErrno("read",src);
+			if (len<=0) break;
+			if (fwrite(buf,1,len,tf)!=len) ThrowPerErrno("write",tgt);
+			AddDone(len,0);
+		}
+		if (fclose(tf)!=0) {
+			tf=NULL;
+			ThrowPerErrno("write",tgt);
+		}
+		tf=NULL;
+	}
+	catch (const emException &) {
+		free(buf);
+		fclose(sf);
+		if (tf) fclose(tf);
+		throw;
+	}
+	free(buf);
+	fclose(sf);
+	struct _utimbuf ut;
+	ut.actime=st.st_atime;
+	ut.modtime=st.st_mtime;
+	_utime(tgt.Get(),&ut);
+	AddDone(0,1);
+#else
+	struct timespec ts[2];
+	int sfd,tfd;
+
+	sfd=open(src.Get(),O_RDONLY);
+	if (sfd<0) ThrowPerErrno("open",src);
+	tfd=open(tgt.Get(),O_WRONLY|O_CREAT|O_TRUNC,0600);
+	if (tfd<0 && errno==EACCES) {
+		// Like "cp -f": remove the file and try again.
+		unlink(tgt.Get());
+		tfd=open(tgt.Get(),O_WRONLY|O_CREAT|O_TRUNC,0600);
+	}
+	if (tfd<0) {
+		close(sfd);
+		ThrowPerErrno("create",tgt);
+	}
+	try {
+		CopyFileData(tfd,sfd,tgt,src,st.st_size);
+	}
+	catch (const emException &) {
+		close(sfd);
+		close(tfd);
+		throw;
+	}
+	close(sfd);
+	if (fchown(tfd,st.st_uid,st.st_gid)!=0) {
+		// Not being allowed to preserve the owner is normal.
+	}
+	fchmod(tfd,st.st_mode&07777);
+	ts[0].tv_sec=st.st_atime;
+	ts[0].tv_nsec=0;
+	ts[1].tv_sec=st.st_mtime;
+	ts[1].tv_nsec=0;
+	futimens(tfd,ts);
+	if (close(tfd)!=0) ThrowPerErrno("write",tgt);
+	AddDone(0,1);
+#endif
+}
+
+
+#if !defined(_WIN32)
+void emFileManJobEngine::Job::WorkerThread::CopyFileData(
+	int tfd, int sfd, const emString & tgt, const emString & src,
+	emUInt64 size
+)
+{
+	emOwnArrayPtr<char> buf;
+	emUInt64 done;
+	ssize_t len,len2,pos;
+
+	done=0;
+
+#if defined(__linux__)
+#	if defined(FICLONE)
+	if (size>0 && ioctl(tfd,FICLONE,sfd)==0) {
+		AddDone(size,0);
+		return;
+	}
+#	endif
+
+	// Let the kernel copy the data (possibly server-side or by sharing
+	// extents). If not supported, try sendfile. Anyway, the remainder is
+	// copied by read/write below, which also handles files with a wrong
+	// size (e.g. in /proc).
+	bool useCopyFileRange=true;
+	while (done<size) {
+		CheckAbort();
+		len=0;
+		if (useCopyFileRange) {
+#			if defined(__GLIBC__) && (__GLIBC__>2 || (__GLIBC__==2 && __GLIBC_MINOR__>=27))
+				len=copy_file_range(sfd,NULL,tfd,NULL,CHUNK_SIZE,0);
+#			else
+				len=-1;
+				errno=ENOSYS;
+#			endif
+			if (len<0 && done==0 && errno!=EINTR && errno!=EIO && errno!=ENOSPC) {
+				useCopyFileRange=false;
+				continue;
+			}
+		}
+		else {
+			len=sendfile(tfd,sfd,NULL,CHUNK_SIZE);
+			if (len<0 && done==0 && errno!=EINTR && errno!=EIO && errno!=ENOSPC) {
+				break;
+			}
+		}
+		if (len<0) {
+			if (errno==EINTR) continue;
+			ThrowPerErrno("copy data to",tgt);
+		}
+		if (len==0) break;
+		done+=len;
+		AddDone(len,0);
+	}
+#endif
+
+	buf=new char[BUF_SIZE];
+	for (;;) {
+		CheckAbort();
+		len=read(sfd,buf.Get(),BUF_SIZE);
+		if (len<0) {
+			if (errno==EINTR) continue;
+			ThrowPerErrno("read",src);
+		}
+		if (len==0) break;
+		for (pos=0; pos<len; pos+=len2) {
+			len2=write(tfd,buf.Get()+pos,len-pos);
+			if (len2<0) {
+				if (errno==EINTR) { len2=0; continue; }
+				ThrowPerErrno("write",tgt);
+			}
+		}
+		AddDone(len,0);
+	}
+}
+#endif
+
+
+void emFileManJobEngine::Job::WorkerThread::RemoveEntry(const emString & path)
+{
+	emArray<emString> names;
+	struct em_stat st;
+	int i;
+
+	CheckAbort();
+	SetCurrentPath(path);
+
+	if (em_lstat(path.Get(),&st)!=0) {
+		ThrowPerErrno("get file information of",path);
+	}
+
+	if ((st.st_mode&S_IFMT)==S_IFDIR) {
+#if !defined(_WIN32)
+		if ((st.st_mode&0700)!=0700) {
+			chmod(path.Get(),(st.st_mode&07777)|0700);
+		}
+#endif
+		names=emTryLoadDir(path);
+		for (i=0; i<names.GetCount(); i++) {
+			RemoveEntry(emGetChildPath(path,names[i]));
+		}
+		emTryRemoveDirectory(path);
+	}
+	else {
+		emTryRemoveFile(path);
+	}
+
+	if (Operation==OP_REMOVE) AddDone(0,1);
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::SetCurrentPath(
+	const emString & path
+)
+{
+	Mutex.Lock();
+	CurrentPath=path;
+	SetChanged();
+	Mutex.Unlock();
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::AddDone(
+	emUInt64 bytes, emUInt64 entries
+)
+{
+	Mutex.Lock();
+	DoneBytes+=bytes;
+	DoneEntries+=entries;
+	SetChanged();
+	Mutex.Unlock();
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::CheckAbort()
+{
+	bool abortRequested;
+
+	Mutex.Lock();
+	abortRequested=AbortRequested;
+	Mutex.Unlock();
+	if (abortRequested) throw emException("Aborted.");
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::SetChanged()
+{
+	// Mutex must be locked.
+	if (!Changed) {
+		Changed=true;
+		Engine.ThreadSafeWakeUp();
+	}
+}
+
+
+void emFileManJobEngine::Job::WorkerThread::ThrowPerErrno(
+	const char * action, const emString & path
+)
+{
+	throw emException(
+		"Failed to %s \"%s\": %s",
+		action,
+		path.Get(),
+		emGetErrorText(errno).Get()
+	);
+}
+
+
+//==============================================================================
+//=========================== emFileManJobEngine::Job ==========================
+//==============================================================================
+
+emFileManJobEngine::Job::Job(
+	OperationType operation, const emArray<emString> & sourcePaths,
+	const emString & targetPath, double priority
+)
+	: emJob(priority),
+	Operation(operation),
+	SourcePaths(sourcePaths),
+	TargetPath(targetPath),
+	TargetIsDir(false),
+	TotalBytes(0),
+	DoneBytes(0),
+	TotalEntries(0),
+	DoneEntries(0),
+	Scanning(true)
+{
+}
+
+
+emFileManJobEngine::Job::~Job()
+{
+	// Worker is deleted here, which waits for the thread.
+}
+
+
+emArray<emString> emFileManJobEngine::Job::GetResultPaths() const
+{
+	emArray<emString> paths;
+	emString path;
+	int i;
+
+	if (Operation==OP_REMOVE) return paths;
+
+	if (!TargetIsDir) {
+		if (emIsExistingPath(TargetPath)) paths.Add(TargetPath);
+		return paths;
+	}
+
+	for (i=0; i<SourcePaths.GetCount(); i++) {
+		path=emGetChildPath(TargetPath,emGetNameInPath(SourcePaths[i]));
+		if (emIsExistingPath(path)) paths.Add(path);
+	}
+	return paths;
+}
+
+
+double emFileManJobEngine::Job::GetProgress() const
+{
+	double p;
+
+	if (GetState()==ST_SUCCESS) return 100.0;
+	if (Scanning) return 0.0;
+	if (TotalBytes>0) {
+		// Weight each entry like 4 KiB of content, so that trees of
+		// many small files do not look stalled.
+		p=(
+			(DoneBytes+DoneEntries*4096.0)/
+			(TotalBytes+TotalEntries*4096.0)
+		)*100.0;
+	}
+	else if (TotalEntries>0) {
+		p=DoneEntries*100.0/TotalEntries;
+	}
+	else {
+		p=0.0;
+	}
+	if (p>100.0) p=100.0;
+	return p;
+}
+
+
+//==============================================================================
+//============================= emFileManJobEngine =============================
+//==============================================================================
+
+emFileManJobEngine::emFileManJobEngine(emScheduler & scheduler)
+	: emEngine(scheduler),
+	JobQueue(scheduler),
+	MaxRunningJobs(2)
+{
+}
+
+
+emFileManJobEngine::~emFileManJobEngine()
+{
+	emJob * job;
+
+	while ((job=JobQueue.GetFirstRunningJob())!=NULL) {
+		((Job*)job)->Worker.Reset();
+		JobQueue.AbortJob(*job);
+	}
+}
+
+
+void emFileManJobEngine::EnqueueJob(Job & job)
+{
+	JobQueue.EnqueueJob(job);
+	WakeUp();
+}
+
+
+void emFileManJobEngine::AbortJob(Job & job)
+{
+	if (job.GetState()==emJob::ST_RUNNING) {
+		// The job remains running until the worker thread has seen
+		// the request.
+		if (job.Worker) job.Worker->RequestAbort();
+		WakeUp();
+	}
+	else if (job.GetState()==emJob::ST_WAITING) {
+		JobQueue.AbortJob(job);
+	}
+}
+
+
+void emFileManJobEngine::SetMaxRunningJobs(int maxRunningJobs)
+{
+	if (maxRunningJobs<1) maxRunningJobs=1;
+	if (MaxRunningJobs!=maxRunningJobs) {
+		MaxRunningJobs=maxRunningJobs;
+		WakeUp();
+	}
+}
+
+
+bool emFileManJobEngine::Cycle()
+{
+	emJob * job, * next;
+	Job * fmJob;
+	int running;
+
+	running=0;
+	for (job=JobQueue.GetFirstRunningJob(); job; job=next) {
+		next=job->GetNext();
+		if (PollRunningJob(*(Job*)job)) running++;
+	}
+
+	while (running<MaxRunningJobs) {
+		job=JobQueue.StartNextJob();
+		if (!job) break;
+		fmJob=(Job*)job;
+		fmJob->TargetIsDir=(
+			fmJob->Operation!=OP_REMOVE && emIsDirectory(fmJob->TargetPath)
+		);
+		fmJob->Worker=new Job::WorkerThread(
+			*this,fmJob->Operation,fmJob->SourcePaths,fmJob->TargetPath,
+			fmJob->TargetIsDir
+		);
+		running++;
+	}
+
+	// The worker threads wake up this engine on any change.
+	return false;
+}
+
+
+bool emFileManJobEngine::PollRunningJob(Job & job)
+{
+	emString errorText;
+
+	if (job.Worker->FetchProgress(job)) {
+		Signal(job.ProgressSignal);
+	}
+
+	if (!job.Worker->IsFinished()) return true;
+
+	errorText=job.Worker->GetErrorText();
+	if (job.Worker->HasBeenAborted()) {
+		job.Worker.Reset();
+		JobQueue.AbortJob(job);
+	}
+	else if (!errorText.IsEmpty()) {
+		job.Worker.Reset();
+		JobQueue.FailJob(job,errorText);
+	}
+	else {
+		job.Worker.Reset();
+		JobQueue.SucceedJob(job);
+	}
+	return false;
+}
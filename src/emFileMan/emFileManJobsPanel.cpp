@@ -0,0 +1,339 @@
+//------------------------------------------------------------------------------
+// emFileManJobsPanel.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emFileMan/emFileManJobsPanel.h>
+
+
+emFileManJobsPanel::emFileManJobsPanel(ParentArg parent, const emString & name)
+	: emLinearGroup(parent,name,"File Jobs"),
+	JobPanelCounter(0)
+{
+	FMModel=emFileManModel::Acquire(GetRootContext());
+
+	SetDescription(
+		"Copy, move and delete operations running in the background.\n"
+		"Progress is shown here while the jobs are running. Failed jobs\n"
+		"keep their error message until they are cleared."
+	);
+	SetVertical();
+	SetMinChildTallness(0.1);
+	SetMaxChildTallness(0.3);
+	SetAlignment(EM_ALIGN_TOP);
+
+	BtClear=new emButton(
+		this,"clear",
+		"Clear Finished Jobs",
+		"Remove all finished, failed and aborted jobs from this list."
+	);
+
+	AddWakeUpSignal(FMModel->GetJobsSignal());
+	AddWakeUpSignal(BtClear->GetClickSignal());
+
+	UpdateJobPanels();
+}
+
+
+emFileManJobsPanel::~emFileManJobsPanel()
+{
+}
+
+
+bool emFileManJobsPanel::Cycle()
+{
+	if (IsSignaled(BtClear->GetClickSignal())) {
+		FMModel->RemoveFinishedJobs();
+	}
+	if (IsSignaled(FMModel->GetJobsSignal())) {
+		UpdateJobPanels();
+	}
+	return emLinearGroup::Cycle();
+}
+
+
+void emFileManJobsPanel::UpdateJobPanels()
+{
+	emPanel * p, * next;
+	JobPanel * jp;
+	int i,n,failed;
+
+	n=FMModel->GetJobCount();
+
+	for (p=BtClear->GetNext(); p; p=next) {
+		next=p->GetNext();
+		jp=(JobPanel*)p;
+		for (i=0; i<n; i++) {
+			if (&FMModel->GetJob(i)==jp->GetJob()) break;
+		}
+		if (i>=n) delete jp;
+	}
+
+	for (i=0; i<n; i++) {
+		for (p=BtClear->GetNext(); p; p=p->GetNext()) {
+			if (((JobPanel*)p)->GetJob()==&FMModel->GetJob(i)) break;
+		}
+		if (!p) {
+			JobPanelCounter++;
+			new JobPanel(
+				this,
+				emString::Format("job%lu",(unsigned long)JobPanelCounter),
+				FMModel,
+				&FMModel->GetJob(i)
+			);
+		}
+	}
+
+	BtClear->SetEnableSwitch(false);
+	failed=0;
+	for (i=0; i<n; i++) {
+		switch (FMModel->GetJob(i).GetState()) {
+		case emJob::ST_ERROR:
+			failed++;
+			BtClear->SetEnableSwitch(true);
+			break;
+		case emJob::ST_SUCCESS:
+		case emJob::ST_ABORTED:
+			BtClear->SetEnableSwitch(true);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (failed>0) {
+		SetCaption(emString::Format("File Jobs (%d failed)",failed));
+	}
+	else {
+		SetCaption("File Jobs");
+	}
+}
+
+
+emFileManJobsPanel::JobPanel::JobPanel(
+	ParentArg parent, const emString & name, emFileManModel * fmModel,
+	emFileManJobEngine::Job * job
+)
+	: emLinearGroup(parent,name,GetJobCaption(*job)),
+	FMModel(fmModel),
+	Job(job)
+{
+	SetHorizontal();
+	SetChildWeight(0,5.0);
+	SetChildWeight(1,1.0);
+	SetBorderScaling(2.0);
+
+	Progress=new ProgressPanel(this,"progress",job);
+	BtAbort=new emButton(this,"abort","Abort","Abort this job.");
+
+	AddWakeUpSignal(Job->GetStateSignal());
+	AddWakeUpSignal(Job->GetProgressSignal());
+	AddWakeUpSignal(BtAbort->GetClickSignal());
+
+	UpdateControls();
+}
+
+
+emFileManJobsPanel::JobPanel::~JobPanel()
+{
+}
+
+
+bool emFileManJobsPanel::JobPanel::Cycle()
+{
+	int i;
+
+	if (IsSignaled(BtAbort->GetClickSignal())) {
+		for (i=FMModel->GetJobCount()-1; i>=0; i--) {
+			if (&FMModel->GetJob(i)==Job.Get()) FMModel->AbortJob(i);
+		}
+	}
+	if (
+		IsSignaled(Job->GetStateSignal()) ||
+		IsSignaled(Job->GetProgressSignal())
+	) {
+		UpdateControls();
+	}
+	return emLinearGroup::Cycle();
+}
+
+
+void emFileManJobsPanel::JobPanel::UpdateControls()
+{
+	switch (Job->GetState()) {
+	case emJob::ST_WAITING:
+	case emJob::ST_RUNNING:
+		BtAbort->SetEnableSwitch(true);
+		break;
+	default:
+		BtAbort->SetEnableSwitch(false);
+		break;
+	}
+	if (Job->GetState()==emJob::ST_ERROR) {
+		SetCaption("Failed: " + GetJobCaption(*Job));
+		SetDescription(Job->GetErrorText());
+		Progress->SetDescription(Job->GetErrorText());
+	}
+	Progress->Update();
+}
+
+
+emString emFileManJobsPanel::JobPanel::GetJobCaption(
+	const emFileManJobEngine::Job & job
+)
+{
+	const emArray<emString> & src=job.GetSourcePaths();
+	emString what;
+
+	if (src.GetCount()==1) {
+		what=emString::Format("\"%s\"",emGetNameInPath(src[0]));
+	}
+	else {
+		what=emString::Format("%d entries",src.GetCount());
+	}
+
+	switch (job.GetOperation()) {
+	case emFileManJobEngine::OP_COPY:
+		return emString::Format(
+			"Copy %s to \"%s\"",what.Get(),job.GetTargetPath().Get()
+		);
+	case emFileManJobEngine::OP_MOVE:
+		return emString::Format(
+			"Move %s to \"%s\"",what.Get(),job.GetTargetPath().Get()
+		);
+	default:
+		return emString::Format("Delete %s",what.Get());
+	}
+}
+
+
+emFileManJobsPanel::JobPanel::ProgressPanel::ProgressPanel(
+	ParentArg parent, const emString & name, emFileManJobEngine::Job * job
+)
+	: emBorder(parent,name),
+	Job(job)
+{
+	SetBorderType(OBT_INSTRUMENT,IBT_OUTPUT_FIELD);
+}
+
+
+emFileManJobsPanel::JobPanel::ProgressPanel::~ProgressPanel()
+{
+}
+
+
+void emFileManJobsPanel::JobPanel::ProgressPanel::Update()
+{
+	InvalidatePainting();
+}
+
+
+static emString emFileManJobsFormatSize(emUInt64 size)
+{
+	if (size>=((emUInt64)1)<<30) {
+		return emString::Format("%.1f GiB",size/(1024.0*1024.0*1024.0));
+	}
+	if (size>=((emUInt64)1)<<20) {
+		return emString::Format("%.1f MiB",size/(1024.0*1024.0));
+	}
+	if (size>=((emUInt64)1)<<10) {
+		return emString::Format("%.1f KiB",size/1024.0);
+	}
+	return emString::Format("%u bytes",(unsigned)size);
+}
+
+
+void emFileManJobsPanel::JobPanel::ProgressPanel::PaintContent(
+	const emPainter & painter, double x, double y, double w, double h,
+	emColor canvasColor
+) const
+{
+	emColor barColor,fgColor;
+	emString line1,line2;
+	double d,p;
+
+	fgColor=GetLook().GetOutputFgColor();
+	barColor=emColor(64,160,64,96);
+
+	switch (Job->GetState()) {
+	case emJob::ST_WAITING:
+		line1="Waiting";
+		break;
+	case emJob::ST_RUNNING:
+		if (Job->IsScanning()) {
+			line1=emString::Format(
+				"Scanning: %s in %lu entries",
+				emFileManJobsFormatSize(Job->GetTotalBytes()).Get(),
+				(unsigned long)Job->GetTotalEntries()
+			);
+		}
+		else if (Job->GetOperation()==emFileManJobEngine::OP_REMOVE) {
+			line1=emString::Format(
+				"%d%% - %lu of %lu entries",
+				(int)Job->GetProgress(),
+				(unsigned long)Job->GetDoneEntries(),
+				(unsigned long)Job->GetTotalEntries()
+			);
+		}
+		else {
+			line1=emString::Format(
+				"%d%% - %s of %s",
+				(int)Job->GetProgress(),
+				emFileManJobsFormatSize(Job->GetDoneBytes()).Get(),
+				emFileManJobsFormatSize(Job->GetTotalBytes()).Get()
+			);
+		}
+		line2=Job->GetCurrentPath();
+		break;
+	case emJob::ST_SUCCESS:
+		line1="Done";
+		break;
+	case emJob::ST_ERROR:
+		line1="Failed";
+		line2=Job->GetErrorText();
+		barColor=emColor(192,64,64,96);
+		fgColor=emColor(255,128,128);
+		break;
+	default:
+		line1="Aborted";
+		barColor=emColor(160,160,64,96);
+		break;
+	}
+
+	p=Job->GetProgress();
+	if (p>0.0) {
+		painter.PaintRect(x,y,w*p/100.0,h,barColor,canvasColor);
+		canvasColor=0;
+	}
+
+	d=h*0.1;
+	painter.PaintTextBoxed(
+		x+d,y+d,w-2*d,(h-2*d)*0.55,
+		line1,h,
+		fgColor,canvasColor,
+		EM_ALIGN_LEFT,EM_ALIGN_LEFT
+	);
+	if (!line2.IsEmpty()) {
+		painter.PaintTextBoxed(
+			x+d,y+d+(h-2*d)*0.6,w-2*d,(h-2*d)*0.4,
+			line2,h,
+			fgColor,canvasColor,
+			EM_ALIGN_LEFT,EM_ALIGN_LEFT
+		);
+	}
+}
@@ -442,8 +442,47 @@ void emFileManModel::HotkeyInput(
 }
 
 
+void emFileManModel::StartFileJob(
+	emFileManJobEngine::OperationType operation,
+	const emArray<emString> & sourcePaths, const emString & targetPath,
+	const emString & commandRunId
+)
+{
+	JobEntry * e;
+
+	Jobs.AddNew();
+	e=&Jobs.GetWritable(Jobs.GetCount()-1);
+	e->Job=new emFileManJobEngine::Job(operation,sourcePaths,targetPath);
+	e->CommandRunId=commandRunId;
+	e->Completed=false;
+	AddWakeUpSignal(e->Job->GetStateSignal());
+	JobEngine.EnqueueJob(*e->Job);
+	Signal(JobsSignal);
+}
+
+
+void emFileManModel::AbortJob(int index)
+{
+	JobEngine.AbortJob(*Jobs[index].Job);
+}
+
+
+void emFileManModel::RemoveFinishedJobs()
+{
+	int i;
+
+	for (i=Jobs.GetCount()-1; i>=0; i--) {
+		if (Jobs[i].Completed) {
+			Jobs.Remove(i);
+			Signal(JobsSignal);
+		}
+	}
+}
+
+
 emFileManModel::emFileManModel(emContext & context, const emString & name)
-	: emModel(context,name)
+	: emModel(context,name),
+	JobEngine(GetScheduler())
 {
 	SetMinCommonLifetime(UINT_MAX);
 	Sel[0].SetTuningLevel(1);
@@ -458,6 +497,9 @@ emFileManModel::emFileManModel(emContext & context, const emString & name)
 
 emFileManModel::~emFileManModel()
 {
+	int i;
+
+	for (i=0; i<Jobs.GetCount(); i++) JobEngine.AbortJob(*Jobs[i].Job);
 	IpcServer.Reset();
 	ClearCommands();
 }
@@ -465,6 +507,7 @@ emFileManModel::~emFileManModel()
 
 bool emFileManModel::Cycle()
 {
+	UpdateJobs();
 	if (IsSignaled(FileUpdateSignalModel->Sig)) {
 		UpdateSelection();
 		UpdateCommands();
@@ -490,6 +533,7 @@ void emFileManModel::IpcServerClass::OnReception(
 
 void emFileManModel::OnIpcReception(int argc, const char * const argv[])
 {
+	emArray<emString> sources;
 	emString str;
 	int i;
 
@@ -517,6 +561,31 @@ void emFileManModel::OnIpcReception(int argc, const char * const argv[])
 		}
 		Signal(FileUpdateSignalModel->Sig);
 	}
+	else if (
+		argc>=3 && (
+			strcmp(argv[0],"copy")==0 ||
+			strcmp(argv[0],"move")==0 ||
+			strcmp(argv[0],"remove")==0
+		)
+	) {
+		// copy|move <run id> <target> <source>...
+		// remove <run id> <path>...
+		if (argv[0][0]=='r') {
+			for (i=2; i<argc; i++) sources.Add(argv[i]);
+			StartFileJob(
+				emFileManJobEngine::OP_REMOVE,sources,emString(),argv[1]
+			);
+		}
+		else if (argc>=4) {
+			for (i=3; i<argc; i++) sources.Add(argv[i]);
+			StartFileJob(
+				argv[0][0]=='c' ?
+					emFileManJobEngine::OP_COPY :
+					emFileManJobEngine::OP_MOVE,
+				sources,argv[2],argv[1]
+			);
+		}
+	}
 	else if (argc>=2 && strcmp(argv[0],"selectcs")==0) {
 		if (GetCommandRunId()==argv[1]) {
 			ClearSourceSelection();
@@ -1197,3 +1266,39 @@ emString emFileManModel::GetCommandRunId() const
 {
 	return emString::Format("%p-%u",(const void*)this,SelCmdCounter);
 }
+
+
+void emFileManModel::UpdateJobs()
+{
+	emArray<emString> paths;
+	JobEntry * e;
+	int i,j;
+
+	for (i=0; i<Jobs.GetCount(); i++) {
+		if (Jobs[i].Completed) continue;
+		if (!IsSignaled(Jobs[i].Job->GetStateSignal())) continue;
+		Signal(JobsSignal);
+		switch (Jobs[i].Job->GetState()) {
+		case emJob::ST_SUCCESS:
+		case emJob::ST_ERROR:
+		case emJob::ST_ABORTED:
+			break;
+		default:
+			continue;
+		}
+		e=&Jobs.GetWritable(i);
+		e->Completed=true;
+		RemoveWakeUpSignal(e->Job->GetStateSignal());
+		// The error text of a failed job stays with the job, and
+		// emFileManJobsPanel shows it until the job is removed.
+		paths=e->Job->GetResultPaths();
+		if (!paths.IsEmpty() && GetCommandRunId()==e->CommandRunId) {
+			ClearTargetSelection();
+			for (j=0; j<paths.GetCount(); j++) {
+				DeselectAsSource(paths[j]);
+				SelectAsTarget(paths[j]);
+			}
+		}
+		Signal(FileUpdateSignalModel->Sig);
+	}
+}
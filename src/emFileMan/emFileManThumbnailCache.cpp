@@ -0,0 +1,694 @@
+//------------------------------------------------------------------------------
+// emFileManThumbnailCache.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emFileMan/emFileManThumbnailCache.h>
+#include <emCore/emInstallInfo.h>
+#include <errno.h>
+#include <stdio.h>
+#if defined(_WIN32)
+#	include <sys/utime.h>
+#else
+#	include <utime.h>
+#endif
+
+
+//==============================================================================
+//========= emFileManThumbnailCache::LoadJob::GenerateThread (private) =========
+//==============================================================================
+
+class emFileManThumbnailCache::LoadJob::GenerateThread : public emThread {
+
+public:
+
+	// Scales down an image and saves the result as a thumbnail file.
+	// The source image must not be modified while the thread is running
+	// (which is guaranteed by the copy-on-write of emImage, as long as
+	// the thread holds a reference).
+
+	GenerateThread(
+		const emImage & source, int size, const emString & thumbnailPath,
+		const emString & id
+	);
+	virtual ~GenerateThread();
+
+	const emImage & GetImage() const;
+		// Valid after the thread has terminated.
+
+protected:
+
+	virtual int Run(void * arg);
+
+private:
+
+	void Downscale();
+	void Save() const;
+
+	emImage Source;
+	int Size;
+	emString ThumbnailPath;
+	emString Id;
+	emImage Image;
+};
+
+
+emFileManThumbnailCache::LoadJob::GenerateThread::GenerateThread(
+	const emImage & source, int size, const emString & thumbnailPath,
+	const emString & id
+)
+	: Source(source),
+	Size(size),
+	ThumbnailPath(thumbnailPath.Get()),
+	Id(id.Get())
+{
+	Start(NULL);
+}
+
+
+emFileManThumbnailCache::LoadJob::GenerateThread::~GenerateThread()
+{
+	WaitForTermination();
+}
+
+
+inline const emImage &
+	emFileManThumbnailCache::LoadJob::GenerateThread::GetImage() const
+{
+	return Image;
+}
+
+
+int emFileManThumbnailCache::LoadJob::GenerateThread::Run(void * arg)
+{
+	Downscale();
+	try {
+		Save();
+	}
+	catch (const emException &) {
+		// The thumbnail is still usable, just not cached.
+	}
+	return 0;
+}
+
+
+void emFileManThumbnailCache::LoadJob::GenerateThread::Downscale()
+{
+	emOwnArrayPtr<emUInt32> sums;
+	emOwnArrayPtr<int> cols;
+	const emByte * src, * s;
+	emByte * tgt;
+	emUInt32 * sum;
+	int sw,sh,cc,tw,th,x,y,y1,y2,ty,c,n,rowSize;
+	double f;
+
+	sw=Source.GetWidth();
+	sh=Source.GetHeight();
+	cc=Source.GetChannelCount();
+	if (sw<=0 || sh<=0) return;
+
+	f=((double)Size)/emMax(sw,sh);
+	if (f>1.0) f=1.0;
+	tw=emMax(1,(int)(sw*f+0.5));
+	th=emMax(1,(int)(sh*f+0.5));
+
+	Image.Setup(tw,th,cc);
+
+	// Box filter: Each target pixel is the average of the source pixels
+	// covered by it.
+	cols=new int[sw];
+	for (x=0; x<sw; x++) cols[x]=(int)(((emInt64)x)*tw/sw);
+	rowSize=tw*cc;
+	sums=new emUInt32[rowSize+tw];
+	src=Source.GetMap();
+	tgt=Image.GetWritableMap();
+	for (ty=0; ty<th; ty++) {
+		y1=(int)(((emInt64)ty)*sh/th);
+		y2=(int)(((emInt64)(ty+1))*sh/th);
+		if (y2<=y1) y2=y1+1;
+		memset(sums.Get(),0,sizeof(emUInt32)*(rowSize+tw));
+		for (y=y1; y<y2; y++) {
+			s=src+((size_t)y)*sw*cc;
+			for (x=0; x<sw; x++) {
+				sum=sums.Get()+cols[x]*cc;
+				for (c=0; c<cc; c++) sum[c]+=*s++;
+				sums[rowSize+cols[x]]++;
+			}
+		}
+		for (x=0; x<tw; x++) {
+			n=sums[rowSize+x];
+			if (n<=0) n=1;
+			for (c=0; c<cc; c++) {
+				*tgt++=(emByte)((sums[x*cc+c]+n/2)/n);
+			}
+		}
+	}
+}
+
+
+void emFileManThumbnailCache::LoadJob::GenerateThread::Save() const
+{
+	emArray<char> buf;
+	emString tmpPath;
+	const emByte * s;
+	char * p;
+	int w,h,cc,idLen,n;
+
+	w=Image.GetWidth();
+	h=Image.GetHeight();
+	cc=Image.GetChannelCount();
+	if (w<=0 || h<=0) return;
+	idLen=Id.GetLen();
+	if (idLen>255) return;
+
+	// Uncompressed true-color or grey TGA with top-left origin, and with
+	// the ID field for validating the thumbnail when loading it.
+	buf.SetTuningLevel(4);
+	buf.SetCount(18+idLen+w*h*cc);
+	p=buf.GetWritable();
+	memset(p,0,18);
+	p[0]=(char)idLen;
+	p[2]=(char)(cc<=2 ? 3 : 2);
+	p[12]=(char)w;
+	p[13]=(char)(w>>8);
+	p[14]=(char)h;
+	p[15]=(char)(h>>8);
+	p[16]=(char)(cc*8);
+	p[17]=(char)(0x20|((cc&1)==0 ? 8 : 0));
+	p+=18;
+	memcpy(p,Id.Get(),idLen);
+	p+=idLen;
+	s=Image.GetMap();
+	for (n=w*h; n>0; n--) {
+		if (cc>=3) {
+			p[0]=(char)s[2];
+			p[1]=(char)s[1];
+			p[2]=(char)s[0];
+			if (cc==4) p[3]=(char)s[3];
+		}
+		else {
+			p[0]=(char)s[0];
+			if (cc==2) p[1]=(char)s[1];
+		}
+		p+=cc;
+		s+=cc;
+	}
+
+	emTryMakeDirectories(emGetParentPath(ThumbnailPath));
+	tmpPath=emString::Format(
+		"%s.%d.tmp",ThumbnailPath.Get(),emGetProcessId()
+	);
+	emTrySaveFile(tmpPath,buf);
+	if (rename(tmpPath.Get(),ThumbnailPath.Get())!=0) {
+		remove(ThumbnailPath.Get());
+		if (rename(tmpPath.Get(),ThumbnailPath.Get())!=0) {
+			remove(tmpPath.Get());
+		}
+	}
+}
+
+
+//==============================================================================
+//============== emFileManThumbnailCache::ShrinkThread (private) ===============
+//==============================================================================
+
+class emFileManThumbnailCache::ShrinkThread : public emThread {
+
+public:
+
+	// Removes the least recently used thumbnails while the cache is
+	// larger than MAX_TOTAL_SIZE_MB. The modification time of a thumbnail
+	// file is its time of last use.
+
+	ShrinkThread(const emString & dirPath);
+	virtual ~ShrinkThread();
+
+protected:
+
+	virtual int Run(void * arg);
+
+private:
+
+	struct EntryInfo {
+		emString Path;
+		emUInt64 Size;
+		time_t LastUse;
+	};
+
+	static int CompareLastUse(
+		const EntryInfo * info1, const EntryInfo * info2, void * context
+	);
+
+	emString DirPath;
+};
+
+
+emFileManThumbnailCache::ShrinkThread::ShrinkThread(const emString & dirPath)
+	: DirPath(dirPath.Get())
+{
+	Start(NULL);
+}
+
+
+emFileManThumbnailCache::ShrinkThread::~ShrinkThread()
+{
+	WaitForTermination();
+}
+
+
+int emFileManThumbnailCache::ShrinkThread::Run(void * arg)
+{
+	static const char * const subDirs[]={ "normal", "large" };
+	emArray<EntryInfo> infos;
+	emArray<emString> names;
+	emString dir;
+	EntryInfo info;
+	emUInt64 total;
+	time_t now;
+	int i,j;
+
+	infos.SetTuningLevel(4);
+	total=0;
+	now=time(NULL);
+	for (i=0; i<(int)(sizeof(subDirs)/sizeof(subDirs[0])); i++) {
+		dir=emGetChildPath(DirPath,subDirs[i]);
+		try {
+			names=emTryLoadDir(dir);
+		}
+		catch (const emException &) {
+			continue;
+		}
+		for (j=0; j<names.GetCount(); j++) {
+			info.Path=emGetChildPath(dir,names[j]);
+			try {
+				info.Size=emTryGetFileSize(info.Path);
+				info.LastUse=emTryGetFileTime(info.Path);
+			}
+			catch (const emException &) {
+				continue;
+			}
+			if (strcmp(emGetExtensionInPath(names[j]),".tga")!=0) {
+				// Leftover of a crash while saving.
+				if (info.LastUse<=now-24*60*60) remove(info.Path.Get());
+				continue;
+			}
+			infos.Add(info);
+			total+=info.Size;
+		}
+	}
+
+	if (total<=((emUInt64)MAX_TOTAL_SIZE_MB)<<20) return 0;
+
+	infos.Sort(CompareLastUse);
+	for (i=0; i<infos.GetCount(); i++) {
+		if (total<=((emUInt64)MAX_TOTAL_SIZE_MB)<<20) break;
+		if (remove(infos[i].Path.Get())!=0) continue;
+		total-=infos[i].Size;
+	}
+	return 0;
+}
+
+
+int emFileManThumbnailCache::ShrinkThread::CompareLastUse(
+	const EntryInfo * info1, const EntryInfo * info2, void * context
+)
+{
+	if (info1->LastUse<info2->LastUse) return -1;
+	if (info1->LastUse>info2->LastUse) return 1;
+	return 0;
+}
+
+
+//==============================================================================
+//========================== emFileManThumbnailCache ===========================
+//==============================================================================
+
+emRef<emFileManThumbnailCache> emFileManThumbnailCache::Acquire(
+	emRootContext & rootContext
+)
+{
+	EM_IMPL_ACQUIRE_COMMON(emFileManThumbnailCache,rootContext,"")
+}
+
+
+int emFileManThumbnailCache::GetSizeFor(double viewedWidth)
+{
+	return viewedWidth<=NORMAL_SIZE ? NORMAL_SIZE : LARGE_SIZE;
+}
+
+
+bool emFileManThumbnailCache::IsThumbnailable(
+	const emString & filePath, long statMode
+) const
+{
+	return FpPluginList->HasModelFor(filePath,statMode);
+}
+
+
+emFileManThumbnailCache::LoadJob::LoadJob(
+	const emString & filePath, int size, double priority
+)
+	: emJob(priority),
+	FilePath(filePath),
+	Size(GetSizeFor(size)),
+	LoadState(LS_IDLE),
+	StatMode(0)
+{
+}
+
+
+emFileManThumbnailCache::LoadJob::~LoadJob()
+{
+}
+
+
+void emFileManThumbnailCache::EnqueueJob(LoadJob & job)
+{
+	JobQueue.EnqueueJob(job);
+	WakeUp();
+}
+
+
+void emFileManThumbnailCache::AbortJob(LoadJob & job)
+{
+	job.Generator=NULL;
+	job.FileModelClient=NULL;
+	if (job.FileModel) {
+		RemoveWakeUpSignal(job.FileModel->GetFileStateSignal());
+		job.FileModel->SetViewedSize(&job,0.0,0.0);
+		job.FileModel=NULL;
+	}
+	if (job.LoadState!=LoadJob::LS_IDLE) {
+		job.Image.Clear();
+		job.LoadState=LoadJob::LS_IDLE;
+	}
+	JobQueue.AbortJob(job);
+}
+
+
+emFileManThumbnailCache::emFileManThumbnailCache(
+	emContext & context, const emString & name
+)
+	: emModel(context,name),
+	JobQueue(GetScheduler()),
+	NewThumbnailCount(SHRINK_INTERVAL-1)
+{
+	FpPluginList=emFpPluginList::Acquire(GetRootContext());
+	SetMinCommonLifetime(10);
+}
+
+
+emFileManThumbnailCache::~emFileManThumbnailCache()
+{
+	emJob * job;
+
+	for (;;) {
+		job=JobQueue.GetFirstWaitingJob();
+		if (!job) job=JobQueue.GetFirstRunningJob();
+		if (!job) break;
+		AbortJob(*(LoadJob*)job);
+	}
+}
+
+
+bool emFileManThumbnailCache::Cycle()
+{
+	emJob * job;
+	LoadJob * loadJob;
+
+	while (JobQueue.StartNextJob()) {}
+
+	for (job=JobQueue.GetFirstRunningJob(); job;) {
+		loadJob=(LoadJob*)job;
+		job=job->GetNext();
+		UpdateLoadJob(*loadJob);
+		if (IsTimeSliceAtEnd()) break;
+	}
+
+	return !JobQueue.IsEmpty();
+}
+
+
+emFileManThumbnailCache::MyFileModelClient::MyFileModelClient(LoadJob & job)
+ :
+	emFileModelClient(job.FileModel),
+	Job(job),
+	Priority(job.GetPriority())
+{
+}
+
+
+void emFileManThumbnailCache::MyFileModelClient::SetPriorityFromJob()
+{
+	if (Priority != Job.GetPriority()) {
+		Priority = Job.GetPriority();
+		InvalidatePriority();
+	}
+}
+
+
+emUInt64 emFileManThumbnailCache::MyFileModelClient::GetMemoryLimit() const
+{
+	// Enough for photos of about 60 megapixels at full resolution.
+	// Larger images get a thumbnail only if their file format supports
+	// loading at a reduced resolution.
+	return 268435456;
+}
+
+
+double emFileManThumbnailCache::MyFileModelClient::GetPriority() const
+{
+	return Priority;
+}
+
+
+bool emFileManThumbnailCache::MyFileModelClient::IsReloadAnnoying() const
+{
+	return true;
+}
+
+
+void emFileManThumbnailCache::UpdateLoadJob(LoadJob & job)
+{
+	struct em_stat st;
+	emRef<emModel> model;
+	emString hash;
+
+	for (;;) {
+		switch (job.LoadState) {
+		case LoadJob::LS_IDLE:
+			if (em_stat(job.FilePath.Get(),&st)!=0) {
+				JobQueue.FailJob(job,emGetErrorText(errno));
+				return;
+			}
+			job.StatMode=(long)st.st_mode;
+			job.Id=emString::Format(
+				"emFileManThumbnail %d %lld %lld",
+				job.Size,(long long)st.st_mtime,(long long)st.st_size
+			);
+			hash=emCalcHashName(job.FilePath.Get(),job.FilePath.GetLen(),32);
+			job.ThumbnailPath=emGetChildPath(
+				GetDirPath(),
+				emString::Format(
+					"%s/%s.tga",
+					job.Size<=NORMAL_SIZE ? "normal" : "large",
+					hash.Get()
+				)
+			);
+			if (TryLoadThumbnail(job.ThumbnailPath,job.Id,&job.Image)) {
+				JobQueue.SucceedJob(job);
+				return;
+			}
+			job.LoadState=LoadJob::LS_START_LOAD_FILE;
+			break;
+		case LoadJob::LS_START_LOAD_FILE:
+			try {
+				model=FpPluginList->TryAcquireModel(
+					"emImageFileModel",job.FilePath,job.StatMode
+				);
+			}
+			catch (const emException & exception) {
+				job.LoadState=LoadJob::LS_IDLE;
+				JobQueue.FailJob(job,exception.GetText());
+				return;
+			}
+			job.FileModel=dynamic_cast<emImageFileModel*>(model.Get());
+			if (!job.FileModel) {
+				job.LoadState=LoadJob::LS_IDLE;
+				JobQueue.FailJob(job,"Not an image file model.");
+				return;
+			}
+			// Let the model load at a reduced resolution, where the
+			// file format supports it.
+			job.FileModel->SetViewedSize(&job,job.Size,job.Size);
+			AddWakeUpSignal(job.FileModel->GetFileStateSignal());
+			job.FileModelClient=new MyFileModelClient(job);
+			job.LoadState=LoadJob::LS_LOADING_FILE;
+			break;
+		case LoadJob::LS_LOADING_FILE:
+			switch (job.FileModel->GetFileState()) {
+			case emFileModel::FS_TOO_COSTLY:
+				if (
+					job.FileModel->GetMemoryNeed() >
+					job.FileModelClient->GetMemoryLimit()
+				) {
+					job.FileModelClient=NULL;
+					RemoveWakeUpSignal(job.FileModel->GetFileStateSignal());
+					job.FileModel->SetViewedSize(&job,0.0,0.0);
+					job.FileModel=NULL;
+					job.LoadState=LoadJob::LS_IDLE;
+					JobQueue.FailJob(job,"Image too large for a thumbnail.");
+					return;
+				}
+				// The memory limit may not yet be updated, so wait.
+				((MyFileModelClient*)job.FileModelClient.Get())->SetPriorityFromJob();
+				return;
+			case emFileModel::FS_WAITING:
+			case emFileModel::FS_LOADING:
+				((MyFileModelClient*)job.FileModelClient.Get())->SetPriorityFromJob();
+				return;
+			case emFileModel::FS_LOADED:
+			case emFileModel::FS_UNSAVED:
+			case emFileModel::FS_SAVING:
+				job.Generator=new LoadJob::GenerateThread(
+					job.FileModel->GetImage(),job.Size,
+					job.ThumbnailPath,job.Id
+				);
+				job.FileModelClient=NULL;
+				RemoveWakeUpSignal(job.FileModel->GetFileStateSignal());
+				job.FileModel->SetViewedSize(&job,0.0,0.0);
+				job.FileModel=NULL;
+				job.LoadState=LoadJob::LS_GENERATING;
+				return;
+			default:
+				job.FileModelClient=NULL;
+				RemoveWakeUpSignal(job.FileModel->GetFileStateSignal());
+				job.FileModel->SetViewedSize(&job,0.0,0.0);
+				job.FileModel=NULL;
+				job.LoadState=LoadJob::LS_IDLE;
+				JobQueue.FailJob(job,"Failed to load image file.");
+				return;
+			}
+		case LoadJob::LS_GENERATING:
+			if (job.Generator->IsRunning()) return;
+			job.Image=job.Generator->GetImage();
+			job.Generator=NULL;
+			job.LoadState=LoadJob::LS_IDLE;
+			CountNewThumbnail();
+			if (job.Image.IsEmpty()) {
+				JobQueue.FailJob(job,"Empty image.");
+			}
+			else {
+				JobQueue.SucceedJob(job);
+			}
+			return;
+		}
+		if (IsTimeSliceAtEnd()) break;
+	}
+}
+
+
+void emFileManThumbnailCache::CountNewThumbnail()
+{
+	NewThumbnailCount++;
+	if (NewThumbnailCount<SHRINK_INTERVAL) return;
+	if (Shrinker && Shrinker->IsRunning()) return;
+	NewThumbnailCount=0;
+	Shrinker=new ShrinkThread(GetDirPath());
+}
+
+
+emString emFileManThumbnailCache::GetDirPath()
+{
+	return emGetInstallPath(EM_IDT_USER_CONFIG,"emFileMan","thumbnails");
+}
+
+
+bool emFileManThumbnailCache::TryLoadThumbnail(
+	const emString & path, const emString & id, emImage * image
+)
+{
+	emArray<char> buf;
+	const emByte * p;
+	emByte * t;
+	int idLen,w,h,cc,n;
+	time_t now;
+
+	try {
+		buf=emTryLoadFile(path);
+	}
+	catch (const emException &) {
+		return false;
+	}
+
+	// Only the format written by GenerateThread::Save is accepted.
+	p=(const emByte*)buf.Get();
+	idLen=id.GetLen();
+	if (
+		buf.GetCount()<18+idLen ||
+		p[0]!=idLen ||
+		memcmp(p+18,id.Get(),idLen)!=0
+	) {
+		return false;
+	}
+	w=p[12]|(p[13]<<8);
+	h=p[14]|(p[15]<<8);
+	cc=p[16]/8;
+	if (
+		w<=0 || h<=0 || cc<1 || cc>4 || p[16]!=cc*8 ||
+		p[2]!=(cc<=2 ? 3 : 2) || (p[17]&0x20)==0 ||
+		buf.GetCount()!=18+idLen+w*h*cc
+	) {
+		return false;
+	}
+	p+=18+idLen;
+	image->Setup(w,h,cc);
+	t=image->GetWritableMap();
+	for (n=w*h; n>0; n--) {
+		if (cc>=3) {
+			t[0]=p[2];
+			t[1]=p[1];
+			t[2]=p[0];
+			if (cc==4) t[3]=p[3];
+		}
+		else {
+			t[0]=p[0];
+			if (cc==2) t[1]=p[1];
+		}
+		p+=cc;
+		t+=cc;
+	}
+
+	// The modification time of the file is its time of last use for the
+	// ShrinkThread. It is updated only once per hour, so that viewing a
+	// directory does not write to the disk every time.
+	now=time(NULL);
+	try {
+		if (emTryGetFileTime(path)<now-60*60) {
+#			if defined(_WIN32)
+				_utime(path.Get(),NULL);
+#			else
+				utime(path.Get(),NULL);
+#			endif
+		}
+	}
+	catch (const emException &) {
+	}
+
+	return true;
+}
@@ -19,6 +19,7 @@
 //------------------------------------------------------------------------------
 
 #include <emGif/emGifFileModel.h>
+#include <emGif/emGifFrameCache.h>
 
 
 emRef<emGifFileModel> emGifFileModel::Acquire(
@@ -243,6 +244,18 @@ emImage emGifFileModel::RenderAll() const
 }
 
 
+emGifFrameCache * emGifFileModel::GetFrameCache()
+{
+	if (
+		!FrameCache && RenderCount>0 &&
+		(GetFileState()==FS_LOADED || GetFileState()==FS_UNSAVED)
+	) {
+		FrameCache=new emGifFrameCache(*this,GetMemoryLimit());
+	}
+	return FrameCache;
+}
+
+
 emGifFileModel::emGifFileModel(emContext & context, const emString & name)
 	: emFileModel(context,name)
 {
@@ -265,6 +278,7 @@ emGifFileModel::emGifFileModel(emContext & context, const emString & name)
 	NextUserInput=false;
 	NextDelay=0;
 	NextTransparent=-1;
+	FrameCache=NULL;
 }
 
 
@@ -280,6 +294,11 @@ void emGifFileModel::ResetData()
 	Render * r;
 	int i;
 
+	if (FrameCache) {
+		delete FrameCache;
+		FrameCache=NULL;
+	}
+
 	if (Colors) {
 		delete [] Colors;
 		Colors=NULL;
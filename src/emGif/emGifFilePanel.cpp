@@ -30,6 +30,7 @@ emGifFilePanel::emGifFilePanel(
 {
 	RIndex=-1;
 	Playing=false;
+	Waiting=false;
 	AddWakeUpSignal(GetVirFileStateSignal());
 	AddWakeUpSignal(Timer.GetSignal());
 	SetFileModel(fileModel,updateFileModel);
@@ -38,6 +39,7 @@ emGifFilePanel::emGifFilePanel(
 
 emGifFilePanel::~emGifFilePanel()
 {
+	LeaveFrameCache();
 }
 
 
@@ -48,6 +50,7 @@ void emGifFilePanel::SetFileModel(
 	if (fileModel && (dynamic_cast<emGifFileModel*>(fileModel))==NULL) {
 		fileModel=NULL;
 	}
+	if (fileModel!=GetFileModel()) LeaveFrameCache();
 	emFilePanel::SetFileModel(fileModel,updateFileModel);
 }
 
@@ -73,7 +76,7 @@ void emGifFilePanel::ContinuePlaying()
 			Timer.Start(0);
 			Signal(PlaySignal);
 		}
-		else if (gfm->GetRenderInput(RIndex)) {
+		else if (RIndex>=0 && gfm->GetRenderInput(RIndex)) {
 			Timer.Start(0);
 		}
 	}
@@ -101,9 +104,10 @@ void emGifFilePanel::GetEssenceRect(
 
 bool emGifFilePanel::Cycle()
 {
+	emGifFrameCache * fc;
 	emGifFileModel * gfm;
+	int index,x,y,w,h;
 	bool oldPlaying,baseBusy,init;
-	int x,y,w,h;
 
 	baseBusy=emFilePanel::Cycle();
 
@@ -114,12 +118,13 @@ bool emGifFilePanel::Cycle()
 	oldPlaying=Playing;
 	if (IsSignaled(GetVirFileStateSignal()) || GetVirFileState()!=VFS_LOADED) {
 		if (!Image.IsEmpty()) {
+			LeaveFrameCache();
 			Image.Clear();
 			InvalidatePainting();
 		}
-		UndoImage.Clear();
 		RIndex=-1;
 		Playing=false;
+		Waiting=false;
 		Timer.Stop(true);
 	}
 	init=false;
@@ -127,66 +132,32 @@ bool emGifFilePanel::Cycle()
 	if (GetVirFileState()==VFS_LOADED && Image.IsEmpty() &&
 	    gfm->GetWidth()>0 && gfm->GetHeight()>0) {
 		Image.Setup(gfm->GetWidth(),gfm->GetHeight(),gfm->GetChannelCount());
+		Image.Fill(gfm->GetBGColor());
+		fc=gfm->GetFrameCache();
+		if (fc) fc->AddReader(*this);
 		RIndex=-1;
 		InvalidatePainting();
 		Playing=true;
 		init=true;
 	}
-	if (Playing && (init || IsSignaled(Timer.GetSignal()))) {
+	if (Playing && (init || Waiting || IsSignaled(Timer.GetSignal()))) {
+		Waiting=false;
+		fc=gfm->GetFrameCache();
 		for (;;) {
-			if (gfm->GetRenderCount()<=0) {
-				Image.Fill(gfm->GetBGColor());
-				InvalidatePerImage(0,0,Image.GetWidth(),Image.GetHeight());
+			if (!fc) {
 				Playing=false;
 				RIndex=-1;
 				break;
 			}
-			if (RIndex<0 || RIndex>=gfm->GetRenderCount()-1) {
-				if (
-					gfm->IsRenderTransparent(0) ||
-					gfm->GetRenderX(0)!=0 ||
-					gfm->GetRenderY(0)!=0 ||
-					gfm->GetRenderWidth(0)!=Image.GetWidth() ||
-					gfm->GetRenderHeight(0)!=Image.GetHeight()
-				) {
-					Image.Fill(gfm->GetBGColor());
-					InvalidatePerImage(0,0,Image.GetWidth(),Image.GetHeight());
-				}
-				RIndex=0;
-			}
-			else {
-				x=gfm->GetRenderX(RIndex);
-				y=gfm->GetRenderY(RIndex);
-				w=gfm->GetRenderWidth(RIndex);
-				h=gfm->GetRenderHeight(RIndex);
-				if (gfm->GetRenderDisposal(RIndex)==2) {
-					Image.Fill(x,y,w,h,gfm->GetBGColor());
-					InvalidatePerImage(x,y,w,h);
-				}
-				else if (gfm->GetRenderDisposal(RIndex)==3) {
-					if (!UndoImage.IsEmpty()) {
-						Image.Copy(x,y,UndoImage,0,0,w,h);
-					}
-					else {
-						Image.Fill(x,y,w,h,gfm->GetBGColor());
-					}
-					InvalidatePerImage(x,y,w,h);
-				}
-				RIndex++;
-			}
-			x=gfm->GetRenderX(RIndex);
-			y=gfm->GetRenderY(RIndex);
-			w=gfm->GetRenderWidth(RIndex);
-			h=gfm->GetRenderHeight(RIndex);
-			if (gfm->GetRenderDisposal(RIndex)==3) {
-				UndoImage.Setup(w,h,Image.GetChannelCount());
-				UndoImage.Copy(-x,-y,Image);
-			}
-			else {
-				UndoImage.Clear();
+			if (RIndex<0 || RIndex>=gfm->GetRenderCount()-1) index=0;
+			else index=RIndex+1;
+			if (!fc->GetFrame(*this,index,RIndex,&Image,&x,&y,&w,&h)) {
+				// The frame cache wakes us up when the frame is ready.
+				Waiting=true;
+				break;
 			}
-			gfm->RenderImage(RIndex,&Image);
-			InvalidatePerImage(x,y,w,h);
+			RIndex=index;
+			if (w>0 && h>0) InvalidatePerImage(x,y,w,h);
 			if (gfm->GetRenderDelay(RIndex)>0) {
 				Timer.Start(gfm->GetRenderDelay(RIndex)*10);
 				break;
@@ -361,3 +332,16 @@ void emGifFilePanel::InvalidatePerImage(int x, int y, int w, int h)
 		InvalidatePainting(lx+x*fx,ly+y*fy,w*fx,h*fy);
 	}
 }
+
+
+void emGifFilePanel::LeaveFrameCache()
+{
+	emGifFileModel * gfm;
+	emGifFrameCache * fc;
+
+	gfm=(emGifFileModel *)GetFileModel();
+	if (gfm && !Image.IsEmpty()) {
+		fc=gfm->GetFrameCache();
+		if (fc) fc->RemoveReader(*this);
+	}
+}
@@ -0,0 +1,414 @@
+//------------------------------------------------------------------------------
+// emGifFrameCache.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emGif/emGifFrameCache.h>
+
+
+emGifFrameCache::emGifFrameCache(emGifFileModel & model, emUInt64 maxMemory)
+	: Model(model)
+{
+	Frame * f;
+	int i;
+
+	MaxMemory=maxMemory;
+	FrameMemory=
+		((emUInt64)Model.Width)*Model.Height*Model.ChannelCount+sizeof(Frame)
+	;
+	Frames.SetCount(Model.RenderCount);
+	for (i=0; i<Frames.GetCount(); i++) {
+		f=&Frames.GetWritable(i);
+		f->X1=0;
+		f->Y1=0;
+		f->X2=Model.Width;
+		f->Y2=Model.Height;
+	}
+	Memory=0;
+	Quit=false;
+	RIndex=-1;
+	Image.Setup(Model.Width,Model.Height,Model.ChannelCount);
+	Start(NULL);
+}
+
+
+emGifFrameCache::~emGifFrameCache()
+{
+	Mutex.Lock();
+	Quit=true;
+	Mutex.Unlock();
+	WorkEvent.Send();
+	WaitForTermination();
+}
+
+
+void emGifFrameCache::AddReader(emEngine & reader)
+{
+	Reader * r;
+	int i;
+
+	Mutex.Lock();
+	for (i=Readers.GetCount()-1; i>=0; i--) {
+		if (Readers[i].Engine==&reader) break;
+	}
+	if (i<0) {
+		Readers.AddNew();
+		r=&Readers.GetWritable(Readers.GetCount()-1);
+		r->Engine=&reader;
+		r->Position=0;
+		r->Waiting=false;
+	}
+	Mutex.Unlock();
+	WorkEvent.Send();
+}
+
+
+void emGifFrameCache::RemoveReader(emEngine & reader)
+{
+	int i;
+
+	Mutex.Lock();
+	for (i=Readers.GetCount()-1; i>=0; i--) {
+		if (Readers[i].Engine==&reader) Readers.Remove(i);
+	}
+	Mutex.Unlock();
+}
+
+
+bool emGifFrameCache::GetFrame(
+	emEngine & reader, int index, int prevIndex,
+	emImage * image, int * pX, int * pY, int * pW, int * pH
+)
+{
+	const Frame * f;
+	Reader * r;
+	int i,x1,y1,x2,y2,n;
+
+	Mutex.Lock();
+	for (i=Readers.GetCount()-1; i>=0; i--) {
+		if (Readers[i].Engine==&reader) break;
+	}
+	if (i<0 || index<0 || index>=Frames.GetCount()) {
+		Mutex.Unlock();
+		return false;
+	}
+	r=&Readers.GetWritable(i);
+	f=&Frames[index];
+	if (f->Image.IsEmpty()) {
+		r->Position=index;
+		r->Waiting=true;
+		Mutex.Unlock();
+		WorkEvent.Send();
+		return false;
+	}
+	if (prevIndex>=0 && GetNextIndex(prevIndex)==index) {
+		x1=f->X1;
+		y1=f->Y1;
+		x2=f->X2;
+		y2=f->Y2;
+	}
+	else {
+		x1=0;
+		y1=0;
+		x2=f->Image.GetWidth();
+		y2=f->Image.GetHeight();
+	}
+	if (x2>x1 && y2>y1) image->Copy(x1,y1,f->Image,x1,y1,x2-x1,y2-y1);
+	n=Frames.GetCount();
+	if (index<n-1) r->Position=index+1;
+	else if (Model.Animated) r->Position=0;
+	else r->Position=n;
+	r->Waiting=false;
+	Mutex.Unlock();
+	WorkEvent.Send();
+
+	*pX=x1;
+	*pY=y1;
+	*pW=x2-x1;
+	*pH=y2-y1;
+	return true;
+}
+
+
+int emGifFrameCache::Run(void * arg)
+{
+	emImage img;
+	Frame * f;
+	int i,index,distance,drop;
+
+	for (;;) {
+		Mutex.Lock();
+		if (Quit) {
+			Mutex.Unlock();
+			break;
+		}
+		index=FindWantedFrame(&distance);
+		while (index>=0 && Memory+FrameMemory>GetMemoryLimit()) {
+			drop=FindDroppableFrame(distance);
+			if (drop<0) {
+				index=-1;
+				break;
+			}
+			Frames.GetWritable(drop).Image.Clear();
+			Memory-=FrameMemory;
+		}
+		Mutex.Unlock();
+
+		if (index<0) {
+			WorkEvent.Receive();
+			continue;
+		}
+
+		if (!RenderTo(index)) break;
+
+		img.Setup(Image.GetWidth(),Image.GetHeight(),Image.GetChannelCount());
+		img.Copy(0,0,Image);
+
+		Mutex.Lock();
+		f=&Frames.GetWritable(index);
+		if (f->Image.IsEmpty()) {
+			f->Image=img;
+			Memory+=FrameMemory;
+		}
+		img.Clear();
+		for (i=Readers.GetCount()-1; i>=0; i--) {
+			if (Readers[i].Waiting && Readers[i].Position==index) {
+				Readers.GetWritable(i).Waiting=false;
+				Readers[i].Engine->ThreadSafeWakeUp();
+			}
+		}
+		Mutex.Unlock();
+	}
+	return 0;
+}
+
+
+int emGifFrameCache::GetNextIndex(int index) const
+{
+	return index<Frames.GetCount()-1 ? index+1 : 0;
+}
+
+
+int emGifFrameCache::GetDistance(int index) const
+{
+	int i,p,d,best;
+
+	best=INT_MAX;
+	for (i=Readers.GetCount()-1; i>=0; i--) {
+		p=Readers[i].Position;
+		if (index>=p) d=index-p;
+		else if (Model.Animated) d=index-p+Frames.GetCount();
+		else continue;
+		if (best>d) best=d;
+	}
+	return best;
+}
+
+
+int emGifFrameCache::FindWantedFrame(int * pDistance) const
+{
+	int i,d,best,bestDistance;
+
+	best=-1;
+	bestDistance=INT_MAX;
+	for (i=0; i<Frames.GetCount(); i++) {
+		if (!Frames[i].Image.IsEmpty()) continue;
+		d=GetDistance(i);
+		if (bestDistance>d) {
+			bestDistance=d;
+			best=i;
+		}
+	}
+	*pDistance=bestDistance;
+	return best;
+}
+
+
+int emGifFrameCache::FindDroppableFrame(int distance) const
+{
+	int i,d,best,bestDistance;
+
+	best=-1;
+	bestDistance=distance;
+	for (i=0; i<Frames.GetCount(); i++) {
+		if (Frames[i].Image.IsEmpty()) continue;
+		d=GetDistance(i);
+		if (bestDistance<d) {
+			bestDistance=d;
+			best=i;
+		}
+	}
+	return best;
+}
+
+
+emUInt64 emGifFrameCache::GetMemoryLimit() const
+{
+	emUInt64 m;
+
+	// At least one frame per reader, so that readers at different
+	// positions cannot block each other.
+	m=FrameMemory*(Readers.GetCount()>1 ? Readers.GetCount() : 1);
+	return MaxMemory>m ? MaxMemory : m;
+}
+
+
+bool emGifFrameCache::RenderTo(int index)
+{
+	Frame * f;
+	int prev,x1,y1,x2,y2;
+
+	while (RIndex!=index) {
+		Mutex.Lock();
+		if (Quit) {
+			Mutex.Unlock();
+			return false;
+		}
+		Mutex.Unlock();
+
+		// Going backwards means rendering from the beginning again.
+		if (RIndex>=index && RIndex<Frames.GetCount()-1) RIndex=-1;
+
+		prev=RIndex;
+		RenderStep(&x1,&y1,&x2,&y2);
+		if (prev>=0) {
+			Mutex.Lock();
+			f=&Frames.GetWritable(RIndex);
+			f->X1=x1;
+			f->Y1=y1;
+			f->X2=x2;
+			f->Y2=y2;
+			Mutex.Unlock();
+		}
+	}
+	return true;
+}
+
+
+void emGifFrameCache::RenderStep(int * pX1, int * pY1, int * pX2, int * pY2)
+{
+	const emGifFileModel::Render * r, * rn;
+	const emByte * p1, * p2;
+	int next,x1,y1,x2,y2,w,h,cc,x,y,l,t,rt,b;
+	bool full;
+
+	cc=Image.GetChannelCount();
+	w=Image.GetWidth();
+	h=Image.GetHeight();
+
+	if (RIndex<0 || RIndex>=Model.RenderCount-1) next=0;
+	else next=RIndex+1;
+	rn=Model.RenderArray[next];
+	r=RIndex>=0 ? Model.RenderArray[RIndex] : NULL;
+
+	// Find the rectangle which may change by this step.
+	full=
+		RIndex<0 || (
+			next==0 && (
+				rn->Transparent>=0 || rn->X!=0 || rn->Y!=0 ||
+				rn->Width!=w || rn->Height!=h
+			)
+		)
+	;
+	if (full) {
+		x1=0;
+		y1=0;
+		x2=w;
+		y2=h;
+	}
+	else {
+		x1=rn->X;
+		y1=rn->Y;
+		x2=rn->X+rn->Width;
+		y2=rn->Y+rn->Height;
+		if (next>0 && (r->Disposal==2 || r->Disposal==3)) {
+			if (x1>r->X) x1=r->X;
+			if (y1>r->Y) y1=r->Y;
+			if (x2<r->X+r->Width) x2=r->X+r->Width;
+			if (y2<r->Y+r->Height) y2=r->Y+r->Height;
+		}
+		if (x1<0) x1=0;
+		if (y1<0) y1=0;
+		if (x2>w) x2=w;
+		if (y2>h) y2=h;
+		if (x2<x1) x2=x1;
+		if (y2<y1) y2=y1;
+		OldImage.Setup(x2-x1,y2-y1,cc);
+		OldImage.Copy(-x1,-y1,Image);
+	}
+
+	// Dispose the previous frame and render the next one.
+	if (next==0) {
+		if (full) Image.Fill(Model.BGColor);
+	}
+	else if (r->Disposal==2) {
+		Image.Fill(r->X,r->Y,r->Width,r->Height,Model.BGColor);
+	}
+	else if (r->Disposal==3) {
+		if (!UndoImage.IsEmpty()) {
+			Image.Copy(r->X,r->Y,UndoImage,0,0,r->Width,r->Height);
+		}
+		else {
+			Image.Fill(r->X,r->Y,r->Width,r->Height,Model.BGColor);
+		}
+	}
+	RIndex=next;
+	if (rn->Disposal==3) {
+		UndoImage.Setup(rn->Width,rn->Height,cc);
+		UndoImage.Copy(-rn->X,-rn->Y,Image);
+	}
+	else {
+		UndoImage.Clear();
+	}
+	Model.RenderImage(RIndex,&Image);
+
+	// Shrink the rectangle to the pixels which have really changed.
+	if (!full && x2>x1) {
+		l=x2-x1;
+		rt=-1;
+		t=-1;
+		b=-1;
+		for (y=0; y<y2-y1; y++) {
+			p1=Image.GetMap()+((y1+y)*(size_t)w+x1)*cc;
+			p2=OldImage.GetMap()+y*(size_t)(x2-x1)*cc;
+			if (memcmp(p1,p2,(x2-x1)*(size_t)cc)==0) continue;
+			if (t<0) t=y;
+			b=y;
+			for (x=0; x<l && memcmp(p1+x*cc,p2+x*cc,cc)==0; x++);
+			l=x;
+			for (x=x2-x1-1; x>rt && memcmp(p1+x*cc,p2+x*cc,cc)==0; x--);
+			rt=x;
+		}
+		if (t<0) {
+			x2=x1;
+			y2=y1;
+		}
+		else {
+			x2=x1+rt+1;
+			y2=y1+b+1;
+			x1+=l;
+			y1+=t;
+		}
+		OldImage.Clear();
+	}
+
+	*pX1=x1;
+	*pY1=y1;
+	*pX2=x2;
+	*pY2=y2;
+}
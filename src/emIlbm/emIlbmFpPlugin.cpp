@@ -40,4 +40,23 @@ extern "C" {
 			)
 		);
 	}
+
+
+	emRef<emModel> emIlbmFpPluginModelFunc(
+		emContext & context, const emString & className,
+		const emString & name, bool common, emFpPlugin * plugin,
+		emString * errorBuf
+	)
+	{
+		if (
+			className!="emImageFileModel" &&
+			className!="emIlbmImageFileModel"
+		) {
+			*errorBuf="emIlbmFpPlugin: Unsupported model class.";
+			return NULL;
+		}
+		return emRef<emModel>(
+			emIlbmImageFileModel::Acquire(context,name,common)
+		);
+	}
 }
@@ -40,4 +40,23 @@ extern "C" {
 			)
 		);
 	}
+
+
+	emRef<emModel> emJpegFpPluginModelFunc(
+		emContext & context, const emString & className,
+		const emString & name, bool common, emFpPlugin * plugin,
+		emString * errorBuf
+	)
+	{
+		if (
+			className!="emImageFileModel" &&
+			className!="emJpegImageFileModel"
+		) {
+			*errorBuf="emJpegFpPlugin: Unsupported model class.";
+			return NULL;
+		}
+		return emRef<emModel>(
+			emJpegImageFileModel::Acquire(context,name,common)
+		);
+	}
 }
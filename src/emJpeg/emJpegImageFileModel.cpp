@@ -151,8 +151,15 @@ void emJpegImageFileModel::TryStartLoading()
 
 	Signal(ChangeSignal);
 
+	// Let libjpeg scale down by the DCT, where a reduced resolution is
+	// sufficient.
 	L->cinfo.scale_num=1;
-	L->cinfo.scale_denom=1;
+	L->cinfo.scale_denom=CalcReduction(
+		L->cinfo.image_width,
+		L->cinfo.image_height,
+		L->cinfo.out_color_space==JCS_GRAYSCALE ? 1 : 3,
+		8
+	);
 	L->cinfo.output_gamma=1.0;
 	L->cinfo.raw_data_out=FALSE;
 	L->cinfo.quantize_colors=FALSE;
@@ -0,0 +1,422 @@
+/*------------------------------------------------------------------------------
+// emOsmDownloadProc.c
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------*/
+
+
+/*
+ * This helper process downloads files for emOsmTileDownloader by using
+ * libcurl. It runs as long as the downloader needs it, so that connections
+ * are kept alive, and that HTTP/2 connections can multiplex the transfers.
+ *
+ * Requests are read from STDIN, one per line, with fields separated by tabs:
+ *
+ *   get <id> <url> <file path>   - Download a URL into a file.
+ *   abort <id>                   - Abort a download and delete the file.
+ *
+ * For each finished download, a line is written to STDOUT:
+ *
+ *   ok <id>
+ *   error <id> <error text>
+ *
+ * On error, the file is deleted. The process exits when STDIN is closed.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <curl/curl.h>
+#if defined(_WIN32)
+#	include <windows.h>
+#else
+#	include <poll.h>
+#	include <unistd.h>
+#endif
+
+
+#define MAX_HOST_CONNECTIONS 4
+
+
+typedef struct Transfer {
+	struct Transfer * Next;
+	char * Id;
+	char * FilePath;
+	FILE * File;
+	CURL * Easy;
+	char ErrorBuf[CURL_ERROR_SIZE];
+} Transfer;
+
+
+static CURLM * Multi=NULL;
+static Transfer * Transfers=NULL;
+static char * LineBuf=NULL;
+static size_t LineBufSize=0;
+static size_t LineBufFill=0;
+
+
+static char * DupString(const char * str)
+{
+	char * p;
+
+	p=(char*)malloc(strlen(str)+1);
+	if (!p) {
+		fprintf(stderr,"emOsmDownloadProc: Out of memory.\n");
+		exit(255);
+	}
+	strcpy(p,str);
+	return p;
+}
+
+
+static void Reply(const char * status, const char * id, const char * text)
+{
+	const char * p;
+
+	printf("%s\t%s",status,id);
+	if (text) {
+		putchar('\t');
+		/* Keep it on one line. */
+		for (p=text; *p; p++) {
+			putchar(*p=='\t' || *p=='\r' || *p=='\n' ? ' ' : *p);
+		}
+	}
+	putchar('\n');
+	fflush(stdout);
+}
+
+
+static void RemoveTransfer(Transfer * t, int deleteFile)
+{
+	Transfer * * pt;
+
+	for (pt=&Transfers; *pt; pt=&(*pt)->Next) {
+		if (*pt==t) {
+			*pt=t->Next;
+			break;
+		}
+	}
+	curl_multi_remove_handle(Multi,t->Easy);
+	curl_easy_cleanup(t->Easy);
+	if (t->File) fclose(t->File);
+	if (deleteFile) remove(t->FilePath);
+	free(t->Id);
+	free(t->FilePath);
+	free(t);
+}
+
+
+static void StartTransfer(const char * id, const char * url, const char * filePath)
+{
+	Transfer * t;
+
+	t=(Transfer*)calloc(1,sizeof(Transfer));
+	if (!t) {
+		fprintf(stderr,"emOsmDownloadProc: Out of memory.\n");
+		exit(255);
+	}
+	t->Id=DupString(id);
+	t->FilePath=DupString(filePath);
+
+	t->File=fopen(filePath,"wb");
+	if (!t->File) {
+		Reply("error",id,strerror(errno));
+		free(t->Id);
+		free(t->FilePath);
+		free(t);
+		return;
+	}
+
+	t->Easy=curl_easy_init();
+	if (!t->Easy) {
+		fclose(t->File);
+		remove(filePath);
+		Reply("error",id,"curl_easy_init failed");
+		free(t->Id);
+		free(t->FilePath);
+		free(t);
+		return;
+	}
+	curl_easy_setopt(t->Easy,CURLOPT_URL,url);
+	curl_easy_setopt(t->Easy,CURLOPT_USERAGENT,"EagleMode");
+	curl_easy_setopt(t->Easy,CURLOPT_WRITEDATA,t->File);
+	curl_easy_setopt(t->Easy,CURLOPT_ERRORBUFFER,t->ErrorBuf);
+	curl_easy_setopt(t->Easy,CURLOPT_FAILONERROR,1L);
+	curl_easy_setopt(t->Easy,CURLOPT_NOSIGNAL,1L);
+	curl_easy_setopt(t->Easy,CURLOPT_TCP_KEEPALIVE,1L);
+	curl_easy_setopt(t->Easy,CURLOPT_PRIVATE,t);
+
+	t->Next=Transfers;
+	Transfers=t;
+	curl_multi_add_handle(Multi,t->Easy);
+}
+
+
+static void AbortTransfer(const char * id)
+{
+	Transfer * t;
+
+	for (t=Transfers; t; t=t->Next) {
+		if (strcmp(t->Id,id)==0) {
+			RemoveTransfer(t,1);
+			return;
+		}
+	}
+}
+
+
+static void FinishTransfers()
+{
+	CURLMsg * msg;
+	Transfer * t;
+	int n;
+
+	while ((msg=curl_multi_info_read(Multi,&n))!=NULL) {
+		if (msg->msg!=CURLMSG_DONE) continue;
+		t=NULL;
+		curl_easy_getinfo(msg->easy_handle,CURLINFO_PRIVATE,(char**)&t);
+		if (!t) continue;
+		if (msg->data.result==CURLE_OK && fclose(t->File)==0) {
+			t->File=NULL;
+			Reply("ok",t->Id,NULL);
+			RemoveTransfer(t,0);
+		}
+		else {
+			Reply(
+				"error",t->Id,
+				t->ErrorBuf[0] ? t->ErrorBuf :
+				msg->data.result!=CURLE_OK ?
+				curl_easy_strerror(msg->data.result) : "write error"
+			);
+			RemoveTransfer(t,1);
+		}
+	}
+}
+
+
+static void ProcessLine(char * line)
+{
+	char * fields[4];
+	int n;
+
+	fields[0]=line;
+	for (n=1; n<4; n++) {
+		fields[n]=strchr(fields[n-1],'\t');
+		if (!fields[n]) break;
+		*fields[n]++=0;
+	}
+	if (n==4 && strcmp(fields[0],"get")==0) {
+		StartTransfer(fields[1],fields[2],fields[3]);
+	}
+	else if (n==2 && strcmp(fields[0],"abort")==0) {
+		AbortTransfer(fields[1]);
+	}
+	else {
+		fprintf(stderr,"emOsmDownloadProc: Invalid request: %s\n",line);
+	}
+}
+
+
+static void AddInput(const char * buf, size_t len)
+{
+	char * p, * e;
+
+	if (LineBufFill+len+1>LineBufSize) {
+		LineBufSize=(LineBufFill+len+1)*2;
+		LineBuf=(char*)realloc(LineBuf,LineBufSize);
+		if (!LineBuf) {
+			fprintf(stderr,"emOsmDownloadProc: Out of memory.\n");
+			exit(255);
+		}
+	}
+	memcpy(LineBuf+LineBufFill,buf,len);
+	LineBufFill+=len;
+	LineBuf[LineBufFill]=0;
+
+	p=LineBuf;
+	while ((e=strchr(p,'\n'))!=NULL) {
+		*e=0;
+		if (e>p && e[-1]=='\r') e[-1]=0;
+		ProcessLine(p);
+		p=e+1;
+	}
+	LineBufFill-=p-LineBuf;
+	memmove(LineBuf,p,LineBufFill);
+}
+
+
+static void Cleanup()
+{
+	while (Transfers) RemoveTransfer(Transfers,1);
+	curl_multi_cleanup(Multi);
+	curl_global_cleanup();
+}
+
+
+#if defined(_WIN32)
+/*------------------------------ Windows variant -----------------------------*/
+
+/* Anonymous pipes cannot be waited for together with the sockets of libcurl.
+   Therefore, a thread reads STDIN and wakes up the main thread. */
+
+static CRITICAL_SECTION InputLock;
+static char * InputBuf=NULL;
+static size_t InputBufSize=0;
+static size_t InputBufFill=0;
+static int InputClosed=0;
+
+
+static DWORD WINAPI ReadingThreadProc(LPVOID data)
+{
+	char buf[4096];
+	HANDLE h;
+	DWORD d;
+
+	h=GetStdHandle(STD_INPUT_HANDLE);
+	for (;;) {
+		if (!ReadFile(h,buf,sizeof(buf),&d,NULL) || d==0) break;
+		EnterCriticalSection(&InputLock);
+		if (InputBufFill+d>InputBufSize) {
+			InputBufSize=(InputBufFill+d)*2;
+			InputBuf=(char*)realloc(InputBuf,InputBufSize);
+			if (!InputBuf) ExitProcess(255);
+		}
+		memcpy(InputBuf+InputBufFill,buf,d);
+		InputBufFill+=d;
+		LeaveCriticalSection(&InputLock);
+		curl_multi_wakeup(Multi);
+	}
+	EnterCriticalSection(&InputLock);
+	InputClosed=1;
+	LeaveCriticalSection(&InputLock);
+	curl_multi_wakeup(Multi);
+	return 0;
+}
+
+
+static int ReadInput()
+{
+	char * buf;
+	size_t len;
+	int closed;
+
+	EnterCriticalSection(&InputLock);
+	buf=InputBuf;
+	len=InputBufFill;
+	closed=InputClosed;
+	InputBuf=NULL;
+	InputBufSize=0;
+	InputBufFill=0;
+	LeaveCriticalSection(&InputLock);
+	if (buf) {
+		AddInput(buf,len);
+		free(buf);
+	}
+	return !closed;
+}
+
+
+static void WaitForEvents()
+{
+	int n;
+
+	curl_multi_poll(Multi,NULL,0,1000,&n);
+}
+
+
+static void InitInput()
+{
+	DWORD d;
+
+	InitializeCriticalSection(&InputLock);
+	CreateThread(NULL,0,ReadingThreadProc,NULL,0,&d);
+}
+
+
+#else
+/*-------------------------------- UNIX variant ------------------------------*/
+
+static int ReadInput()
+{
+	struct pollfd pfd;
+	char buf[4096];
+	ssize_t len;
+
+	for (;;) {
+		pfd.fd=STDIN_FILENO;
+		pfd.events=POLLIN;
+		pfd.revents=0;
+		if (poll(&pfd,1,0)<=0) return 1;
+		len=read(STDIN_FILENO,buf,sizeof(buf));
+		if (len<=0) return 0;
+		AddInput(buf,(size_t)len);
+	}
+}
+
+
+static void WaitForEvents()
+{
+	struct curl_waitfd wfd;
+	int n;
+
+	wfd.fd=STDIN_FILENO;
+	wfd.events=CURL_WAIT_POLLIN;
+	wfd.revents=0;
+	curl_multi_poll(Multi,&wfd,1,1000,&n);
+}
+
+
+static void InitInput()
+{
+}
+
+
+#endif
+/*----------------------------------------------------------------------------*/
+
+
+int main(int argc, char * argv[])
+{
+	int running;
+
+	if (curl_global_init(CURL_GLOBAL_ALL)!=0) {
+		fprintf(stderr,"emOsmDownloadProc: curl_global_init failed.\n");
+		return 255;
+	}
+	Multi=curl_multi_init();
+	if (!Multi) {
+		fprintf(stderr,"emOsmDownloadProc: curl_multi_init failed.\n");
+		return 255;
+	}
+	curl_multi_setopt(Multi,CURLMOPT_PIPELINING,(long)CURLPIPE_MULTIPLEX);
+	curl_multi_setopt(
+		Multi,CURLMOPT_MAX_HOST_CONNECTIONS,(long)MAX_HOST_CONNECTIONS
+	);
+
+	InitInput();
+
+	for (;;) {
+		if (!ReadInput()) break;
+		curl_multi_perform(Multi,&running);
+		FinishTransfers();
+		WaitForEvents();
+	}
+
+	Cleanup();
+	return 0;
+}
@@ -213,6 +213,8 @@ void emOsmTileCache::UpdateLoadJob(LoadJob & job)
 			job.LoadState=LoadJob::LS_DOWNLOADING;
 			break;
 		case LoadJob::LS_DOWNLOADING:
+			// Let the downloader reorder its queue as the view moves.
+			job.DownloadJob->SetPriority(job.GetPriority());
 			switch (job.DownloadJob->GetState()) {
 			case emJob::ST_WAITING:
 			case emJob::ST_RUNNING:
@@ -19,19 +19,28 @@
 //------------------------------------------------------------------------------
 
 #include <emOsm/emOsmTileDownloader.h>
+#include <emCore/emInstallInfo.h>
 
 
 emOsmTileDownloader::emOsmTileDownloader(emScheduler & scheduler)
 	: emEngine(scheduler),
 	JobQueue(scheduler),
-	ProcStarted(false)
+	UseHelper(emIsExistingPath(GetHelperPath())),
+	ProcStarted(false),
+	HelperReplied(false),
+	NextJobId(0)
 {
+	ReadBuf.SetTuningLevel(4);
+	WriteBuf.SetTuningLevel(4);
 	SetEnginePriority(HIGH_PRIORITY);
 }
 
 
 emOsmTileDownloader::~emOsmTileDownloader()
 {
+	// Closing the pipe lets the helper exit (on Windows, it does not
+	// react on the termination signal).
+	Process.CloseWriting();
 	if (Process.IsRunning()) Process.Terminate();
 	FailAllRunningJobs("Downloader destructed.");
 }
@@ -42,7 +51,8 @@ emOsmTileDownloader::DownloadJob::DownloadJob(
 )
 	: emJob(priority),
 	Url(url),
-	FilePath(filePath)
+	FilePath(filePath),
+	Id(-1)
 {
 }
 
@@ -61,13 +71,142 @@ void emOsmTileDownloader::EnqueueJob(DownloadJob & job)
 
 void emOsmTileDownloader::AbortJob(DownloadJob & job)
 {
+	emString str;
+
 	if (job.GetState()!=emJob::ST_RUNNING) {
 		JobQueue.AbortJob(job);
 	}
+	else if (UseHelper && ProcStarted) {
+		// The helper deletes the file.
+		str=emString::Format("abort\t%d\n",job.Id);
+		WriteBuf.Add(str.Get(),str.GetLen());
+		JobQueue.AbortJob(job);
+		WakeUp();
+	}
 }
 
 
 bool emOsmTileDownloader::Cycle()
+{
+	if (UseHelper) return CycleHelper();
+	else return CycleCurl();
+}
+
+
+bool emOsmTileDownloader::CycleHelper()
+{
+	emArray<emString> args;
+	emJob * job;
+	DownloadJob * downloadJob;
+	emString str;
+	char buf[1024];
+	int i,n;
+
+	if (ProcStarted) {
+		do {
+			try {
+				i=Process.TryReadErr(buf,sizeof(buf));
+			}
+			catch (const emException &) {
+				i=0;
+			}
+			if (i>0 && ProcErr.GetCount()<1000) ProcErr.Add(buf,i);
+		} while (i>0);
+
+		do {
+			try {
+				i=Process.TryRead(buf,sizeof(buf));
+			}
+			catch (const emException &) {
+				i=0;
+			}
+			if (i>0) ReadBuf.Add(buf,i);
+		} while (i>0);
+
+		for (;;) {
+			for (i=0; i<ReadBuf.GetCount() && ReadBuf[i]!='\n'; i++);
+			if (i>=ReadBuf.GetCount()) break;
+			str=emString(ReadBuf.Get(),i);
+			ReadBuf.Remove(0,i+1);
+			HandleHelperLine(str);
+		}
+
+		if (!Process.IsRunning()) {
+			if (ProcErr.IsEmpty()) ProcErr="Download helper process failed.";
+			FailAllRunningJobs(ProcErr);
+			if (!HelperReplied) {
+				// The helper does not work at all (e.g. libcurl
+				// missing), so fall back to the curl program.
+				emDLog(
+					"emOsmTileDownloader: Falling back to curl: %s",
+					ProcErr.Get()
+				);
+				UseHelper=false;
+			}
+			ResetProcess();
+			return UseHelper ? CycleHelper() : CycleCurl();
+		}
+	}
+
+	if (!ProcStarted) {
+		if (!JobQueue.GetFirstWaitingJob()) return false;
+		args.Add(GetHelperPath());
+		try {
+			Process.TryStart(
+				args,
+				emArray<emString>(),
+				NULL,
+				emProcess::SF_PIPE_STDIN|
+				emProcess::SF_PIPE_STDOUT|
+				emProcess::SF_PIPE_STDERR|
+				emProcess::SF_NO_WINDOW
+			);
+		}
+		catch (const emException & exception) {
+			emDLog(
+				"emOsmTileDownloader: Falling back to curl: %s",
+				exception.GetText().Get()
+			);
+			UseHelper=false;
+			return CycleCurl();
+		}
+		ProcStarted=true;
+	}
+
+	n=GetRunningJobCount();
+	while (n<MAX_HELPER_JOBS) {
+		job=JobQueue.StartNextJob();
+		if (!job) break;
+		downloadJob=(DownloadJob*)job;
+		downloadJob->Id=NextJobId;
+		NextJobId=(NextJobId+1)&0x7fffffff;
+		str=emString::Format(
+			"get\t%d\t%s\t%s\n",
+			downloadJob->Id,
+			downloadJob->Url.Get(),
+			downloadJob->FilePath.Get()
+		);
+		WriteBuf.Add(str.Get(),str.GetLen());
+		n++;
+		emDLog("emOsmTileDownloader: Downloading %s",downloadJob->Url.Get());
+	}
+
+	while (!WriteBuf.IsEmpty()) {
+		try {
+			i=Process.TryWrite(WriteBuf.Get(),WriteBuf.GetCount());
+		}
+		catch (const emException &) {
+			i=-1;
+		}
+		if (i<=0) break;
+		WriteBuf.Remove(0,i);
+	}
+
+	return n>0 || !WriteBuf.IsEmpty();
+}
+
+
+bool emOsmTileDownloader::CycleCurl()
 {
 	emArray<emString> args;
 	emJob * job;
@@ -143,6 +282,72 @@ bool emOsmTileDownloader::Cycle()
 }
 
 
+emString emOsmTileDownloader::GetHelperPath()
+{
+	return emGetChildPath(
+		emGetInstallPath(EM_IDT_LIB,"emOsm","emOsm"),
+		"emOsmDownloadProc"
+	);
+}
+
+
+void emOsmTileDownloader::HandleHelperLine(const emString & line)
+{
+	DownloadJob * job;
+	const char * p, * e;
+	int id;
+
+	HelperReplied=true;
+
+	p=strchr(line.Get(),'\t');
+	if (!p) return;
+	id=atoi(p+1);
+	job=FindRunningJob(id);
+	if (!job) return; // Aborted meanwhile.
+
+	if (strncmp(line.Get(),"ok\t",3)==0) {
+		JobQueue.SucceedJob(*job);
+	}
+	else {
+		e=strchr(p+1,'\t');
+		JobQueue.FailJob(*job,e ? e+1 : "Download failed.");
+	}
+}
+
+
+emOsmTileDownloader::DownloadJob * emOsmTileDownloader::FindRunningJob(
+	int id
+) const
+{
+	emJob * job;
+
+	for (job=JobQueue.GetFirstRunningJob(); job; job=job->GetNext()) {
+		if (((DownloadJob*)job)->Id==id) return (DownloadJob*)job;
+	}
+	return NULL;
+}
+
+
+int emOsmTileDownloader::GetRunningJobCount() const
+{
+	emJob * job;
+	int n;
+
+	for (n=0, job=JobQueue.GetFirstRunningJob(); job; job=job->GetNext()) n++;
+	return n;
+}
+
+
+void emOsmTileDownloader::ResetProcess()
+{
+	ProcErr.Clear();
+	ReadBuf.Clear();
+	WriteBuf.Clear();
+	ProcStarted=false;
+	HelperReplied=false;
+}
+
+
 void emOsmTileDownloader::FailAllRunningJobs(emString errorText)
 {
 	const emJob * job;
@@ -40,4 +40,23 @@ extern "C" {
 			)
 		);
 	}
+
+
+	emRef<emModel> emPcxFpPluginModelFunc(
+		emContext & context, const emString & className,
+		const emString & name, bool common, emFpPlugin * plugin,
+		emString * errorBuf
+	)
+	{
+		if (
+			className!="emImageFileModel" &&
+			className!="emPcxImageFileModel"
+		) {
+			*errorBuf="emPcxFpPlugin: Unsupported model class.";
+			return NULL;
+		}
+		return emRef<emModel>(
+			emPcxImageFileModel::Acquire(context,name,common)
+		);
+	}
 }
@@ -60,9 +60,11 @@ void emPcxImageFileModel::TryStartLoading()
 	L->BytesPerLine=0;
 	L->RowPlaneSize=0;
 	L->NextY=0;
+	L->Reduction=1;
 	L->File=NULL;
 	L->Palette=NULL;
 	L->RowBuffer=NULL;
+	L->Row=NULL;
 
 	L->File=fopen(GetFilePath(),"rb");
 	if (!L->File) goto Err;
@@ -101,6 +103,8 @@ void emPcxImageFileModel::TryStartLoading()
 	}
 	else goto Err;
 
+	L->Reduction=CalcReduction(L->Width,L->Height,L->Channels,8);
+
 	return;
 
 Err:
@@ -123,7 +127,15 @@ bool emPcxImageFileModel::TryContinueLoading()
 			L->PlanePixBits,
 			L->PlaneCount
 		);
-		Image.Setup(L->Width,L->Height,L->Channels);
+		if (L->Reduction>1) {
+			Reducer.Setup(
+				Image,L->Width,L->Height,L->Channels,L->Reduction
+			);
+			L->Row=new unsigned char[L->Width*(size_t)L->Channels];
+		}
+		else {
+			Image.Setup(L->Width,L->Height,L->Channels);
+		}
 		Signal(ChangeSignal);
 		n=1<<(L->PlanePixBits*L->PlaneCount);
 		if (n<=256) {
@@ -155,7 +167,8 @@ bool emPcxImageFileModel::TryContinueLoading()
 	} while (i<n);
 	if (ferror(L->File)) goto Err;
 
-	map=Image.GetWritableMap()+L->NextY*(size_t)L->Width*L->Channels;
+	if (L->Row) map=L->Row;
+	else map=Image.GetWritableMap()+L->NextY*(size_t)L->Width*L->Channels;
 	for (x=0; x<L->Width; x++) {
 		val=0;
 		switch (L->PlanePixBits) {
@@ -193,6 +206,8 @@ bool emPcxImageFileModel::TryContinueLoading()
 		}
 	}
 
+	if (L->Row) Reducer.PutRow(Image,L->Row);
+
 	Signal(ChangeSignal);
 
 	L->NextY++;
@@ -211,6 +226,7 @@ void emPcxImageFileModel::QuitLoading()
 		if (L->File) fclose(L->File);
 		if (L->Palette) delete [] L->Palette;
 		if (L->RowBuffer) delete [] L->RowBuffer;
+		if (L->Row) delete [] L->Row;
 		delete L;
 		L=NULL;
 	}
@@ -237,7 +253,9 @@ void emPcxImageFileModel::QuitSaving()
 emUInt64 emPcxImageFileModel::CalcMemoryNeed()
 {
 	if (L) {
-		return ((emUInt64)L->Width)*L->Height*L->Channels;
+		return ((emUInt64)(L->Width+L->Reduction-1)/L->Reduction)*
+		       ((L->Height+L->Reduction-1)/L->Reduction)*
+		       L->Channels;
 	}
 	else {
 		return ((emUInt64)Image.GetWidth())*
@@ -23,11 +23,12 @@
 
 emPdfControlPanel::emPdfControlPanel(
 	ParentArg parent, const emString & name, emPdfFileModel * fileModel,
-	emPdfSelection & selection
+	emPdfSelection & selection, emPdfSearch & search
 ) :
 	emLinearGroup(parent,name,"PDF File"),
 	FileModel(fileModel),
 	Selection(&selection),
+	Search(&search),
 	Title(NULL),
 	Author(NULL),
 	Subject(NULL),
@@ -41,13 +42,18 @@ emPdfControlPanel::emPdfControlPanel(
 	PageSize(NULL),
 	Copy(NULL),
 	SelectAll(NULL),
-	ClearSelection(NULL)
+	ClearSelection(NULL),
+	SearchText(NULL),
+	SearchStatus(NULL),
+	FindNext(NULL),
+	FindPrev(NULL)
 {
 	if (FileModel) {
 		AddWakeUpSignal(FileModel->GetFileStateSignal());
 		AddWakeUpSignal(FileModel->GetChangeSignal());
 	}
 	if (Selection) AddWakeUpSignal(Selection->GetSelectionSignal());
+	if (Search) AddWakeUpSignal(Search->GetChangeSignal());
 }
 
 
@@ -86,6 +92,21 @@ bool emPdfControlPanel::Cycle()
 		}
 	}
 
+	if (Search) {
+		if (SearchText && IsSignaled(SearchText->GetTextSignal())) {
+			Search->SetText(SearchText->GetText());
+		}
+		if (FindNext && IsSignaled(FindNext->GetClickSignal())) {
+			Search->ShowNextHit();
+		}
+		if (FindPrev && IsSignaled(FindPrev->GetClickSignal())) {
+			Search->ShowPrevHit();
+		}
+		if (IsSignaled(Search->GetChangeSignal())) {
+			UpdateSearchControls();
+		}
+	}
+
 	return busy;
 }
 
@@ -93,12 +114,13 @@ bool emPdfControlPanel::Cycle()
 void emPdfControlPanel::AutoExpand()
 {
 	emRasterLayout * subjectAndKeywords, * creatorEtc, * versionAndPages;
-	emRasterGroup * infos;
+	emRasterGroup * infos, * search;
 	emLinearGroup * selection;
 
 	emLinearGroup::AutoExpand();
 
 	SetChildWeight(1,0.2);
+	SetChildWeight(2,0.4);
 
 	infos=new emRasterGroup(this,"infos","Infos");
 	infos->SetPrefChildTallness(0.08);
@@ -218,6 +240,49 @@ void emPdfControlPanel::AutoExpand()
 	);
 	AddWakeUpSignal(ClearSelection->GetClickSignal());
 
+	search=new emRasterGroup(this,"search","Search");
+	search->SetPrefChildTallness(0.2);
+	search->SetRowByRow();
+
+	SearchText=new emTextField(
+		search,
+		"text",
+		"Search For",
+		"Words to search for in the document. The case of letters is\n"
+		"ignored, and the last word may be incomplete. The current hit\n"
+		"is selected, and its page is shown. The document is indexed\n"
+		"in the background when searching the first time."
+	);
+	SearchText->SetEditable();
+	if (Search) SearchText->SetText(Search->GetText());
+	AddWakeUpSignal(SearchText->GetTextSignal());
+
+	SearchStatus=new emTextField(
+		search,
+		"status",
+		"Hits"
+	);
+
+	FindNext=new emButton(
+		search,
+		"findNext",
+		"Find Next",
+		"Select and show the next hit.\n"
+		"\n"
+		"Hotkey: F3"
+	);
+	AddWakeUpSignal(FindNext->GetClickSignal());
+
+	FindPrev=new emButton(
+		search,
+		"findPrev",
+		"Find Previous",
+		"Select and show the previous hit.\n"
+		"\n"
+		"Hotkey: Shift+F3"
+	);
+	AddWakeUpSignal(FindPrev->GetClickSignal());
+
 	UpdateControls();
 }
 
@@ -238,6 +303,10 @@ void emPdfControlPanel::AutoShrink()
 	Copy=NULL;
 	SelectAll=NULL;
 	ClearSelection=NULL;
+	SearchText=NULL;
+	SearchStatus=NULL;
+	FindNext=NULL;
+	FindPrev=NULL;
 
 	emLinearGroup::AutoShrink();
 }
@@ -297,6 +366,8 @@ void emPdfControlPanel::UpdateControls()
 
 		ClearSelection->SetEnableSwitch(false);
 
+		UpdateSearchControls();
+
 		return;
 	}
 
@@ -368,6 +439,59 @@ void emPdfControlPanel::UpdateControls()
 	Copy->SetEnableSwitch(!Selection->IsSelectionEmpty());
 	SelectAll->SetEnableSwitch(true);
 	ClearSelection->SetEnableSwitch(!Selection->IsSelectionEmpty());
+
+	UpdateSearchControls();
+}
+
+
+void emPdfControlPanel::UpdateSearchControls()
+{
+	emString str;
+
+	if (!IsAutoExpanded()) return;
+
+	if (
+		!FileModel || !Search || (
+			FileModel->GetFileState() != emFileModel::FS_LOADED &&
+			FileModel->GetFileState() != emFileModel::FS_UNSAVED
+		)
+	) {
+		SearchText->SetEnableSwitch(false);
+		SearchStatus->SetEnableSwitch(false);
+		SearchStatus->SetText(emString());
+		FindNext->SetEnableSwitch(false);
+		FindPrev->SetEnableSwitch(false);
+		return;
+	}
+
+	SearchText->SetEnableSwitch(true);
+	FindNext->SetEnableSwitch(Search->GetHitCount()>0);
+	FindPrev->SetEnableSwitch(Search->GetHitCount()>0);
+	SearchStatus->SetEnableSwitch(!Search->GetText().IsEmpty());
+	if (Search->GetText().IsEmpty()) {
+		str.Clear();
+	}
+	else if (Search->GetCurrentHit()>=0) {
+		str=emString::Format(
+			"%d of %d",
+			Search->GetCurrentHit()+1,
+			Search->GetHitCount()
+		);
+	}
+	else {
+		str=emString::Format("%d",Search->GetHitCount());
+	}
+	if (!Search->GetText().IsEmpty() && Search->IsIndexing()) {
+		str+=emString::Format(
+			" (indexing: %d%%)",
+			(int)Search->GetIndexProgress()
+		);
+	}
+	if (!Search->GetText().IsEmpty() && !Search->GetErrorText().IsEmpty()) {
+		str+="\n";
+		str+=Search->GetErrorText();
+	}
+	SearchStatus->SetText(str);
 }
 
 
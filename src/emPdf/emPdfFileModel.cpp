@@ -38,7 +38,9 @@ emPdfServerModel::PdfInstance & emPdfFileModel::GetPdfInstance() const
 
 emPdfFileModel::emPdfFileModel(emContext & context, const emString & name)
 	: emFileModel(context,name),
-	PageAreasMap(GetScheduler())
+	PageAreasMap(GetScheduler()),
+	TileCache(GetScheduler()),
+	TextIndex(GetScheduler())
 {
 	ServerModel=emPdfServerModel::Acquire(GetRootContext());
 	FileSize=0;
@@ -58,6 +60,8 @@ emPdfFileModel::~emPdfFileModel()
 void emPdfFileModel::ResetData()
 {
 	PageAreasMap.Reset();
+	TileCache.Reset();
+	TextIndex.Reset();
 	if (PdfInstance) {
 		PdfInstance=NULL;
 		Signal(ChangeSignal);
@@ -92,6 +96,8 @@ bool emPdfFileModel::TryContinueLoading()
 		PdfInstance=OpenJob->GetPdfInstance();
 		PageCount=PdfInstance->GetPageCount();
 		PageAreasMap.Setup(*ServerModel,*PdfInstance);
+		TileCache.Setup(*ServerModel,*PdfInstance);
+		TextIndex.Setup(*ServerModel,*PdfInstance);
 		Signal(ChangeSignal);
 		return true;
 	default:
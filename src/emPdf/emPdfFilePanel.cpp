@@ -28,7 +28,8 @@ emPdfFilePanel::emPdfFilePanel(
 	emPdfFileModel * fileModel, bool updateFileModel
 )
 	: emFilePanel(parent,name,fileModel,updateFileModel),
-	Selection(GetView(),fileModel)
+	Selection(GetView(),fileModel),
+	Search(*this,Selection,fileModel)
 {
 	BGColor=emColor(0,0,0,0);
 	FGColor=emColor(0,0,0);
@@ -58,6 +59,7 @@ void emPdfFilePanel::SetFileModel(
 		DestroyPagePanels();
 		emFilePanel::SetFileModel(fileModel,updateFileModel);
 		Selection.SetFileModel(pdfFileModel);
+		Search.SetFileModel(pdfFileModel);
 		CalcLayout();
 		UpdatePagePanels();
 		InvalidateControlPanel();
@@ -132,6 +134,14 @@ void emPdfFilePanel::Input(
 			Selection.CopySelectedTextToClipboard();
 			event.Eat();
 		}
+		if (event.IsKey(EM_KEY_F3) && state.IsNoMod()) {
+			Search.ShowNextHit();
+			event.Eat();
+		}
+		if (event.IsKey(EM_KEY_F3) && state.IsShiftMod()) {
+			Search.ShowPrevHit();
+			event.Eat();
+		}
 	}
 
 	emFilePanel::Input(event,state,mx,my);
@@ -246,7 +256,7 @@ emPanel * emPdfFilePanel::CreateControlPanel(
 )
 {
 	return new emPdfControlPanel(
-		parent,name,(emPdfFileModel*)GetFileModel(),Selection
+		parent,name,(emPdfFileModel*)GetFileModel(),Selection,Search
 	);
 }
 
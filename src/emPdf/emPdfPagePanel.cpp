@@ -45,14 +45,22 @@ emPdfPagePanel::emPdfPagePanel(
 	PageIndex=pageIndex;
 
 	Layers[LT_PREVIEW].Type=LT_PREVIEW;
-	Layers[LT_CONTENT].Type=LT_CONTENT;
 	Layers[LT_SELECTION].Type=LT_SELECTION;
+	ContentTiles.SetTuningLevel(4);
+	ContentTilesSetupCount=FileModel->GetTileCache().GetSetupCount();
+	ContentLevel=0;
+	ContentVisible=false;
+	ContentUpToDate=false;
+	ContentRendering=false;
+	ContentMissing=0;
+	ContentRequestTime=0;
 
 	WaitIcon=emGetInsResImage(GetRootContext(),"emPs","waiting.tga");
 	RenderIcon=emGetInsResImage(GetRootContext(),"emPs","rendering.tga");
 	AddWakeUpSignal(FileModel->GetChangeSignal());
 	AddWakeUpSignal(Selection.GetSelectionSignal());
 	AddWakeUpSignal(FileModel->GetPageAreasMap().GetPageAreasSignal());
+	AddWakeUpSignal(FileModel->GetTileCache().GetTileSignal());
 
 	WakeUp();
 }
@@ -64,9 +72,10 @@ emPdfPagePanel::~emPdfPagePanel()
 
 	if (OpenUrlDialog) OpenUrlDialog->Finish(emDialog::NEGATIVE);
 
-	for (i=0; i<3; i++) {
+	for (i=0; i<2; i++) {
 		ResetLayer(Layers[i], true);
 	}
+	ResetContent();
 }
 
 
@@ -78,9 +87,10 @@ bool emPdfPagePanel::Cycle()
 	busy=emPanel::Cycle();
 
 	if (IsSignaled(FileModel->GetChangeSignal())) {
-		for (i=0; i<3; i++) {
+		for (i=0; i<2; i++) {
 			ResetLayer(Layers[i], true);
 		}
+		ResetContent();
 		if (CurrentRectType!=RT_NONE) {
 			CurrentRectType=RT_NONE;
 			InvalidateCursor();
@@ -108,9 +118,10 @@ bool emPdfPagePanel::Cycle()
 		CurrentUrl.Clear();
 	}
 
-	for (i=0; i<3; i++) {
+	for (i=0; i<2; i++) {
 		if (UpdateLayer(Layers[i])) busy=true;
 	}
+	if (UpdateContent()) busy=true;
 
 	UpdateIconState();
 
@@ -125,18 +136,27 @@ void emPdfPagePanel::Notice(NoticeFlags flags)
 	emPanel::Notice(flags);
 
 	if ((flags&NF_VIEWING_CHANGED)!=0) {
-		Layers[LT_CONTENT].CoordinatesUpToDate=false;
+		ContentUpToDate=false;
 		if (PageSelection.NonEmpty) {
 			Layers[LT_SELECTION].CoordinatesUpToDate=false;
 		}
 		WakeUp();
 	}
 	if ((flags&NF_UPDATE_PRIORITY_CHANGED)!=0) {
-		for (i=0; i<3; i++) {
+		for (i=0; i<2; i++) {
 			if (Layers[i].Job) {
 				Layers[i].Job->SetPriority(GetUpdatePriority());
 			}
 		}
+		if (ContentTilesSetupCount==FileModel->GetTileCache().GetSetupCount()) {
+			for (i=0; i<ContentTiles.GetCount(); i++) {
+				FileModel->GetTileCache().SetTilePriority(
+					PageIndex,ContentTiles[i].Level,
+					ContentTiles[i].X,ContentTiles[i].Y,
+					GetUpdatePriority()
+				);
+			}
+		}
 	}
 }
 
@@ -246,8 +266,10 @@ void emPdfPagePanel::Paint(
 
 	pErrText=FileModel->GetPageAreasMap().GetError(PageIndex);
 	if (pErrText) errText=*pErrText;
-	for (i=0; i<3; i++) {
-		PaintLayer(painter,Layers[i],&canvasColor);
+	PaintContent(painter,&canvasColor);
+	PaintLayer(painter,Layers[LT_SELECTION],&canvasColor);
+	if (!ContentErrorText.IsEmpty()) errText=ContentErrorText;
+	for (i=0; i<2; i++) {
 		if (!Layers[i].JobErrorText.IsEmpty()) errText=Layers[i].JobErrorText;
 	}
 
@@ -384,10 +406,6 @@ bool emPdfPagePanel::UpdateLayer(Layer & layer)
 		return false;
 	}
 
-	if (layer.Type==LT_CONTENT && Layers[LT_PREVIEW].Img.IsEmpty()) {
-		return false;
-	}
-
 	fw=FileModel->GetPageWidth(PageIndex);
 	fh=FileModel->GetPageHeight(PageIndex);
 
@@ -416,10 +434,7 @@ bool emPdfPagePanel::UpdateLayer(Layer & layer)
 		sh=ih*fh/oh;
 	}
 
-	if (
-		iw<1.0 || ih<1.0 ||
-		(layer.Type==LT_CONTENT && iw/sw<=Layers[LT_PREVIEW].Img.GetWidth()/fw)
-	) {
+	if (iw<1.0 || ih<1.0) {
 		ResetLayer(layer, true);
 		layer.CoordinatesUpToDate=true;
 		layer.ContentUpToDate=true;
@@ -501,8 +516,6 @@ void emPdfPagePanel::PaintLayer(
 {
 	static const emColor bgCol=emColor(221,255,255);
 	double fw,fh,ox,oy,ow,oh,sx,sy,sw,sh;
-	double sx1,sy1,sx2,sy2;
-	int pw,ph,px1,py1,px2,py2;
 
 	ox=0.0;
 	oy=0.0;
@@ -522,14 +535,12 @@ void emPdfPagePanel::PaintLayer(
 	}
 
 	if (layer.Type == LT_PREVIEW) {
-		if (Layers[LT_CONTENT].Img.IsEmpty()) {
-			painter.PaintImage(
-				ox,oy,ow,oh,
-				layer.Img,255,
-				*canvasColor
-			);
-			*canvasColor=0;
-		}
+		painter.PaintImage(
+			ox,oy,ow,oh,
+			layer.Img,255,
+			*canvasColor
+		);
+		*canvasColor=0;
 		return;
 	}
 
@@ -540,60 +551,286 @@ void emPdfPagePanel::PaintLayer(
 	sw=layer.SrcW*ow/fw;
 	sh=layer.SrcH*oh/fh;
 
-	if (layer.Type == LT_SELECTION) {
-		painter.PaintImageColored(
-			sx,sy,sw,sh,
-			layer.Img,
-			emColor(16,56,192),
-			emColor(255,255,255),
-			*canvasColor
-		);
-		*canvasColor=0;
-		return;
-	}
-
-	painter.PaintImage(
+	painter.PaintImageColored(
 		sx,sy,sw,sh,
 		layer.Img,
-		255,
+		emColor(16,56,192),
+		emColor(255,255,255),
 		*canvasColor
 	);
+	*canvasColor=0;
+}
 
-	if (!Layers[LT_PREVIEW].Img.IsEmpty()) {
-		sx1=emMax(ox,sx);
-		sy1=emMax(oy,sy);
-		sx2=emMin(ox+ow,sx+sw);
-		sy2=emMin(oy+oh,sy+sh);
-		pw=Layers[LT_PREVIEW].Img.GetWidth();
-		ph=Layers[LT_PREVIEW].Img.GetHeight();
-		px1=(int)((sx1-ox)*pw/ow+0.5);
-		py1=(int)((sy1-oy)*ph/oh+0.5);
-		px2=(int)((sx2-oy)*pw/ow+0.5);
-		py2=(int)((sy2-oy)*ph/oh+0.5);
-		if (sy1>oy) painter.PaintImage(
-			ox,oy,ow,sy1-oy,
-			Layers[LT_PREVIEW].Img,
-			0,0,pw,py1,
-			255,*canvasColor
-		);
-		if (sx1>ox) painter.PaintImage(
-			ox,sy1,sx1-ox,sy2-sy1,
-			Layers[LT_PREVIEW].Img,
-			0,py1,px1,py2-py1,
-			255,*canvasColor
-		);
-		if (sx2<ox+ow) painter.PaintImage(
-			sx2,sy1,ox+ow-sx2,sy2-sy1,
-			Layers[LT_PREVIEW].Img,
-			px2,py1,pw-px2,py2-py1,
-			255,*canvasColor
+
+void emPdfPagePanel::ResetContent()
+{
+	emPdfTileCache & cache=FileModel->GetTileCache();
+	int i;
+
+	if (ContentTilesSetupCount==cache.GetSetupCount()) {
+		for (i=0; i<ContentTiles.GetCount(); i++) {
+			cache.ReleaseTile(
+				PageIndex,ContentTiles[i].Level,
+				ContentTiles[i].X,ContentTiles[i].Y
+			);
+		}
+	}
+	ContentTiles.Clear();
+	ContentTilesSetupCount=cache.GetSetupCount();
+	if (ContentVisible) {
+		ContentVisible=false;
+		InvalidatePainting();
+	}
+	if (!ContentErrorText.IsEmpty()) {
+		ContentErrorText.Clear();
+		InvalidatePainting();
+	}
+	ContentUpToDate=false;
+	ContentRendering=false;
+	ContentMissing=0;
+}
+
+
+bool emPdfPagePanel::UpdateContent()
+{
+	emPdfTileCache & cache=FileModel->GetTileCache();
+	emArray<ContentTile> tiles;
+	ContentTile * ct;
+	const emString * err;
+	const emJob * job;
+	emString errText;
+	double fw,fh,ox,oy,ow,oh,x1,y1,x2,y2,f;
+	emInt64 tx,ty,tx1,ty1,tx2,ty2,cx,cy;
+	int level,minLevel,l,i,j,missing;
+	bool rendering;
+
+	if (
+		PageIndex<0 || PageIndex>=FileModel->GetPageCount() ||
+		!IsViewed() || Layers[LT_PREVIEW].Img.IsEmpty()
+	) {
+		ResetContent();
+		return false;
+	}
+
+	if (!ContentUpToDate) {
+		fw=FileModel->GetPageWidth(PageIndex);
+		fh=FileModel->GetPageHeight(PageIndex);
+		ox=PanelToViewX(0.0);
+		oy=PanelToViewY(0.0);
+		ow=PanelToViewDeltaX(1.0);
+		oh=PanelToViewDeltaY(GetHeight());
+		x1=emMax(GetClipX1(),ox);
+		y1=emMax(GetClipY1(),oy);
+		x2=emMin(GetClipX2(),ox+ow);
+		y2=emMin(GetClipY2(),oy+oh);
+		f=emMax(ow/fw,oh/fh);
+		if (
+			x2-x1<1.0 || y2-y1<1.0 ||
+			f<=Layers[LT_PREVIEW].Img.GetWidth()/fw
+		) {
+			ResetContent();
+			ContentUpToDate=true;
+			return false;
+		}
+
+		level=emPdfTileCache::GetLevel(f);
+		f=emPdfTileCache::GetScale(level)/emPdfTileCache::TILE_SIZE;
+		tx1=(emInt64)floor((x1-ox)*fw/ow*f);
+		ty1=(emInt64)floor((y1-oy)*fh/oh*f);
+		tx2=(emInt64)ceil((x2-ox)*fw/ow*f);
+		ty2=(emInt64)ceil((y2-oy)*fh/oh*f);
+		tx1=emMax(tx1,(emInt64)0);
+		ty1=emMax(ty1,(emInt64)0);
+		tx2=emMin(tx2,cache.GetTileCountX(PageIndex,level));
+		ty2=emMin(ty2,cache.GetTileCountY(PageIndex,level));
+
+		// The visible tiles, and the cached tiles of the nearest lower
+		// level in place of missing ones.
+		tiles.SetTuningLevel(4);
+		minLevel=emMax(
+			level-(int)MAX_FALLBACK_LEVELS,
+			emPdfTileCache::GetLevel(Layers[LT_PREVIEW].Img.GetWidth()/fw)+1
 		);
-		if (sy2<oy+oh) painter.PaintImage(
-			ox,sy2,ow,oy+oh-sy2,
-			Layers[LT_PREVIEW].Img,
-			0,py2,pw,ph-py2,
-			255,*canvasColor
+		for (ty=ty1; ty<ty2; ty++) {
+			for (tx=tx1; tx<tx2; tx++) {
+				tiles.AddNew();
+				ct=&tiles.GetWritable(tiles.GetCount()-1);
+				ct->Level=level;
+				ct->X=tx;
+				ct->Y=ty;
+				if (cache.GetTileImage(PageIndex,level,tx,ty)) continue;
+				for (l=level-1; l>=minLevel; l--) {
+					cx=tx>>(level-l);
+					cy=ty>>(level-l);
+					if (!cache.GetTileImage(PageIndex,l,cx,cy)) continue;
+					for (j=tiles.GetCount()-1; j>=0; j--) {
+						if (
+							tiles[j].Level==l && tiles[j].X==cx &&
+							tiles[j].Y==cy
+						) break;
+					}
+					if (j<0) {
+						tiles.AddNew();
+						ct=&tiles.GetWritable(tiles.GetCount()-1);
+						ct->Level=l;
+						ct->X=cx;
+						ct->Y=cy;
+					}
+					break;
+				}
+			}
+		}
+
+		// Request before releasing, so that tiles which are still
+		// needed are not dropped in between.
+		for (i=0; i<tiles.GetCount(); i++) {
+			cache.RequestTile(
+				PageIndex,tiles[i].Level,tiles[i].X,tiles[i].Y,
+				GetUpdatePriority()
+			);
+		}
+		if (ContentTilesSetupCount==cache.GetSetupCount()) {
+			for (i=0; i<ContentTiles.GetCount(); i++) {
+				cache.ReleaseTile(
+					PageIndex,ContentTiles[i].Level,
+					ContentTiles[i].X,ContentTiles[i].Y
+				);
+			}
+		}
+		ContentTiles=tiles;
+		ContentTilesSetupCount=cache.GetSetupCount();
+		ContentLevel=level;
+		ContentVisible=true;
+		ContentUpToDate=true;
+		ContentMissing=-1;
+		ContentRequestTime=emGetClockMS();
+		InvalidatePainting();
+	}
+
+	if (!ContentVisible) return false;
+
+	missing=0;
+	rendering=false;
+	for (i=0; i<ContentTiles.GetCount(); i++) {
+		ct=&ContentTiles.GetWritable(i);
+		if (ct->Level!=ContentLevel) continue;
+		if (cache.GetTileImage(PageIndex,ct->Level,ct->X,ct->Y)) continue;
+		err=cache.GetTileError(PageIndex,ct->Level,ct->X,ct->Y);
+		if (err) {
+			errText=*err;
+			continue;
+		}
+		missing++;
+		job=cache.GetTileJob(PageIndex,ct->Level,ct->X,ct->Y);
+		if (job && job->GetState()==emJob::ST_RUNNING) rendering=true;
+	}
+	if (ContentMissing!=missing) {
+		ContentMissing=missing;
+		InvalidatePainting();
+	}
+	if (ContentErrorText!=errText) {
+		ContentErrorText=errText;
+		InvalidatePainting();
+	}
+	ContentRendering=rendering;
+
+	return missing>0;
+}
+
+
+void emPdfPagePanel::PaintContent(
+	const emPainter & painter, emColor * canvasColor
+) const
+{
+	const emPdfTileCache & cache=FileModel->GetTileCache();
+	const emImage * img;
+	double fw,fh,sx,sy,tw,th,x1,y1,x2,y2,f,cw,ch;
+	emInt64 tx,ty,tx1,ty1,tx2,ty2,cx,cy;
+	int l,minLevel;
+	bool complete;
+
+	if (
+		!ContentVisible ||
+		ContentTilesSetupCount!=cache.GetSetupCount()
+	) {
+		PaintLayer(painter,Layers[LT_PREVIEW],canvasColor);
+		return;
+	}
+
+	// Panel coordinates per pixel of the tiles, and of a whole tile.
+	fw=FileModel->GetPageWidth(PageIndex);
+	fh=FileModel->GetPageHeight(PageIndex);
+	f=emPdfTileCache::GetScale(ContentLevel);
+	sx=1.0/(fw*f);
+	sy=GetHeight()/(fh*f);
+	tw=sx*emPdfTileCache::TILE_SIZE;
+	th=sy*emPdfTileCache::TILE_SIZE;
+
+	x1=emMax(painter.GetUserClipX1(),0.0);
+	y1=emMax(painter.GetUserClipY1(),0.0);
+	x2=emMin(painter.GetUserClipX2(),1.0);
+	y2=emMin(painter.GetUserClipY2(),GetHeight());
+	if (x1>=x2 || y1>=y2) return;
+	tx1=emMax((emInt64)floor(x1/tw),(emInt64)0);
+	ty1=emMax((emInt64)floor(y1/th),(emInt64)0);
+	tx2=emMin((emInt64)ceil(x2/tw),cache.GetTileCountX(PageIndex,ContentLevel));
+	ty2=emMin((emInt64)ceil(y2/th),cache.GetTileCountY(PageIndex,ContentLevel));
+
+	complete=true;
+	for (ty=ty1; ty<ty2 && complete; ty++) {
+		for (tx=tx1; tx<tx2; tx++) {
+			if (!cache.GetTileImage(PageIndex,ContentLevel,tx,ty)) {
+				complete=false;
+				break;
+			}
+		}
+	}
+
+	if (!complete) {
+		// Paint the preview, and over it the tiles of lower levels in
+		// place of the missing tiles.
+		PaintLayer(painter,Layers[LT_PREVIEW],canvasColor);
+		minLevel=emMax(
+			ContentLevel-(int)MAX_FALLBACK_LEVELS,
+			(int)emPdfTileCache::MIN_LEVEL
 		);
+		for (ty=ty1; ty<ty2; ty++) {
+			for (tx=tx1; tx<tx2; tx++) {
+				if (cache.GetTileImage(PageIndex,ContentLevel,tx,ty)) continue;
+				for (l=ContentLevel-1; l>=minLevel; l--) {
+					cx=tx>>(ContentLevel-l);
+					cy=ty>>(ContentLevel-l);
+					img=cache.GetTileImage(PageIndex,l,cx,cy);
+					if (!img) continue;
+					cw=tw*ldexp(1.0,ContentLevel-l);
+					ch=th*ldexp(1.0,ContentLevel-l);
+					emPainter(
+						painter,
+						painter.GetOriginX()+tx*tw*painter.GetScaleX(),
+						painter.GetOriginY()+ty*th*painter.GetScaleY(),
+						painter.GetOriginX()+(tx+1)*tw*painter.GetScaleX(),
+						painter.GetOriginY()+(ty+1)*th*painter.GetScaleY()
+					).PaintImage(
+						cx*cw,cy*ch,
+						cw*img->GetWidth()/emPdfTileCache::TILE_SIZE,
+						ch*img->GetHeight()/emPdfTileCache::TILE_SIZE,
+						*img,255,*canvasColor
+					);
+					break;
+				}
+			}
+		}
+	}
+
+	for (ty=ty1; ty<ty2; ty++) {
+		for (tx=tx1; tx<tx2; tx++) {
+			img=cache.GetTileImage(PageIndex,ContentLevel,tx,ty);
+			if (!img) continue;
+			painter.PaintImage(
+				tx*tw,ty*th,img->GetWidth()*sx,img->GetHeight()*sy,
+				*img,255,*canvasColor
+			);
+		}
 	}
 
 	*canvasColor=0;
@@ -606,7 +843,13 @@ void emPdfPagePanel::UpdateIconState()
 	int i;
 
 	iconState=IS_NONE;
-	for (i=0; i<3; i++) {
+	if (
+		ContentVisible && ContentMissing>0 && ContentErrorText.IsEmpty() &&
+		emGetClockMS()-ContentRequestTime>=2000
+	) {
+		iconState=ContentRendering ? IS_RENDERING : IS_WAITING;
+	}
+	for (i=0; i<2; i++) {
 		if (!Layers[i].Job) continue;
 		if (emGetClockMS()-Layers[i].JobStartTime<2000) continue;
 		if (
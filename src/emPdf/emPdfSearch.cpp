@@ -0,0 +1,220 @@
+//------------------------------------------------------------------------------
+// emPdfSearch.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emPdf/emPdfSearch.h>
+
+
+emPdfSearch::emPdfSearch(
+	emPanel & filePanel, emPdfSelection & selection,
+	emPdfFileModel * fileModel
+)
+	: emEngine(filePanel.GetScheduler()),
+	FilePanel(filePanel),
+	Selection(selection),
+	FileModel(NULL),
+	CurrentHit(-1),
+	FirstHitPending(false)
+{
+	Hits.SetTuningLevel(4);
+	SetFileModel(fileModel);
+}
+
+
+emPdfSearch::~emPdfSearch()
+{
+}
+
+
+void emPdfSearch::SetFileModel(emPdfFileModel * fileModel)
+{
+	if (FileModel==fileModel) return;
+	if (FileModel) {
+		RemoveWakeUpSignal(FileModel->GetChangeSignal());
+		RemoveWakeUpSignal(FileModel->GetTextIndex().GetChangeSignal());
+	}
+	FileModel=fileModel;
+	if (FileModel) {
+		AddWakeUpSignal(FileModel->GetChangeSignal());
+		AddWakeUpSignal(FileModel->GetTextIndex().GetChangeSignal());
+		if (!Text.IsEmpty()) FileModel->GetTextIndex().StartIndexing();
+	}
+	CurrentHit=-1;
+	FirstHitPending=!Text.IsEmpty();
+	UpdateHits();
+	Signal(ChangeSignal);
+}
+
+
+void emPdfSearch::SetText(const emString & text)
+{
+	if (Text==text) return;
+	Text=text;
+	if (FileModel && !Text.IsEmpty()) FileModel->GetTextIndex().StartIndexing();
+	CurrentHit=-1;
+	FirstHitPending=!Text.IsEmpty();
+	UpdateHits();
+	if (FirstHitPending && !Hits.IsEmpty()) ShowHit(0);
+	Signal(ChangeSignal);
+}
+
+
+void emPdfSearch::ShowNextHit()
+{
+	if (Hits.IsEmpty()) return;
+	ShowHit(CurrentHit+1<Hits.GetCount() ? CurrentHit+1 : 0);
+}
+
+
+void emPdfSearch::ShowPrevHit()
+{
+	if (Hits.IsEmpty()) return;
+	ShowHit(CurrentHit>0 ? CurrentHit-1 : Hits.GetCount()-1);
+}
+
+
+bool emPdfSearch::IsIndexing() const
+{
+	return FileModel && FileModel->GetTextIndex().IsIndexing();
+}
+
+
+double emPdfSearch::GetIndexProgress() const
+{
+	const emPdfTextIndex * index;
+
+	if (!FileModel) return 0.0;
+	index=&FileModel->GetTextIndex();
+	if (index->GetPageCount()<=0) return 100.0;
+	return 100.0*index->GetIndexedPageCount()/index->GetPageCount();
+}
+
+
+const emString & emPdfSearch::GetErrorText() const
+{
+	static const emString empty;
+
+	if (!FileModel) return empty;
+	return FileModel->GetTextIndex().GetErrorText();
+}
+
+
+bool emPdfSearch::Cycle()
+{
+	if (!FileModel) return false;
+
+	if (IsSignaled(FileModel->GetChangeSignal())) {
+		CurrentHit=-1;
+		FirstHitPending=!Text.IsEmpty();
+		if (FirstHitPending) FileModel->GetTextIndex().StartIndexing();
+		UpdateHits();
+		Signal(ChangeSignal);
+	}
+
+	if (IsSignaled(FileModel->GetTextIndex().GetChangeSignal())) {
+		UpdateHits();
+		if (FirstHitPending && !Hits.IsEmpty()) ShowHit(0);
+		Signal(ChangeSignal);
+	}
+
+	return false;
+}
+
+
+void emPdfSearch::UpdateHits()
+{
+	emPdfTextIndex::Hit current;
+	int i;
+
+	if (CurrentHit>=0 && CurrentHit<Hits.GetCount()) {
+		current=Hits[CurrentHit];
+	}
+	else {
+		current.Page=-1;
+		current.FirstWord=-1;
+	}
+
+	if (!FileModel || Text.IsEmpty()) {
+		Hits.Clear();
+	}
+	else {
+		FileModel->GetTextIndex().Search(Text,Hits);
+	}
+
+	CurrentHit=-1;
+	if (current.Page>=0) {
+		for (i=Hits.GetCount()-1; i>=0; i--) {
+			if (
+				Hits[i].Page==current.Page &&
+				Hits[i].FirstWord==current.FirstWord
+			) {
+				CurrentHit=i;
+				break;
+			}
+		}
+	}
+}
+
+
+void emPdfSearch::ShowHit(int index)
+{
+	const emPdfTextIndex * textIndex;
+	const emPdfServerModel::PageWord * w1, * w2;
+	emArray<emString> names;
+	emString identity;
+	double pw,ph,pt,vt,cy,relX,relY,relA;
+	int page;
+
+	if (!FileModel || index<0 || index>=Hits.GetCount()) return;
+
+	CurrentHit=index;
+	FirstHitPending=false;
+	Signal(ChangeSignal);
+
+	textIndex=&FileModel->GetTextIndex();
+	page=Hits[index].Page;
+	w1=&textIndex->GetWord(page,Hits[index].FirstWord);
+	w2=&textIndex->GetWord(page,Hits[index].LastWord);
+
+	Selection.Select(
+		emPdfServerModel::SEL_GLYPHS,
+		page,w1->X1,(w1->Y1+w1->Y2)*0.5,
+		page,w2->X2,(w2->Y1+w2->Y2)*0.5,
+		false
+	);
+
+	names=emPanel::DecodeIdentity(FilePanel.GetIdentity());
+	names.Add(emString::Format("%d",page));
+	identity=emPanel::EncodeIdentity(names);
+
+	pw=FileModel->GetPageWidth(page);
+	ph=FileModel->GetPageHeight(page);
+	pt=ph/pw;
+	vt=FilePanel.GetView().GetCurrentTallness();
+	if (vt>=pt) {
+		FilePanel.GetView().VisitFullsized(identity,true);
+		return;
+	}
+	cy=(w1->Y1+w2->Y2)*0.5/ph;
+	relX=0.0;
+	relY=-(1.0-vt/pt)*0.5;
+	relY+=emMin(1.0-vt/pt,emMax(0.0,cy-vt/pt*0.5));
+	relA=vt/pt;
+	FilePanel.GetView().Visit(identity,relX,relY,relA,true);
+}
@@ -106,22 +106,29 @@ emPdfServerModel::PageAreas & emPdfServerModel::PageAreas::operator = (
 
 emPdfServerModel::PdfInstance::~PdfInstance()
 {
+	const emServerProcPool::InstanceMap::Entry * e;
+	int i;
+
 	if (PdfServerModel) {
-		if (InstanceId!=-1) {
-			emRef<CloseJob> job=new CloseJob(ProcRunId,InstanceId);
-			PdfServerModel->EnqueueJob(*job);
+		for (i=0; i<Instances.Entries.GetCount(); i++) {
+			e=&Instances.Entries[i];
+			if (e->InstanceId>=0) {
+				emRef<CloseJob> job=new CloseJob(
+					e->ProcIndex,e->ProcRunId,e->InstanceId
+				);
+				PdfServerModel->EnqueueJob(*job);
+			}
 		}
-		PdfServerModel->ProcPdfInstCount--;
 	}
 }
 
 
-emPdfServerModel::PdfInstance::PdfInstance(emPdfServerModel & pdfServerModel)
+emPdfServerModel::PdfInstance::PdfInstance(
+	emPdfServerModel & pdfServerModel, const emString & filePath
+)
 	: PdfServerModel(&pdfServerModel),
-	ProcRunId(0),
-	InstanceId(-1)
+	FilePath(filePath)
 {
-	pdfServerModel.ProcPdfInstCount++;
 }
 
 
@@ -134,6 +141,7 @@ emPdfServerModel::PdfJobBase::PdfJobBase(
 	PdfInstance * pdfInstance, bool costly, int classPriority, double priority
 )
 	: emJob(priority),
+	ProcIndex(-1),
 	PdfInst(pdfInstance),
 	Costly(costly),
 	ClassPriority(classPriority)
@@ -141,6 +149,12 @@ emPdfServerModel::PdfJobBase::PdfJobBase(
 }
 
 
+bool emPdfServerModel::PdfJobBase::TryReserve(emPdfServerModel &)
+{
+	return true;
+}
+
+
 void emPdfServerModel::PdfJobBase::SetPdfInstance(PdfInstance * pdfInstance)
 {
 	PdfInst=pdfInstance;
@@ -167,7 +181,7 @@ emPdfServerModel::OpenJob::~OpenJob()
 
 bool emPdfServerModel::OpenJob::Send(emPdfServerModel & mdl, emString & err)
 {
-	mdl.WriteLineToProc(emString::Format("open %s",FilePath.Get()));
+	mdl.Pool.GetProc(ProcIndex).WriteLine(emString::Format("open %s",FilePath.Get()));
 	return true;
 }
 
@@ -182,7 +196,7 @@ emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::OpenJob::TryReceive(
 	double d1,d2;
 	int l,i1,r,pos;
 
-	args=mdl.ReadLineFromProc();
+	args=mdl.Pool.GetProc(ProcIndex).ReadLine();
 	if (args.IsEmpty()) return RCV_WAIT;
 	p=strchr(args.Get(),' ');
 	if (p) {
@@ -197,7 +211,7 @@ emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::OpenJob::TryReceive(
 
 	inst=GetPdfInstance();
 	if (!inst) {
-		inst=new PdfInstance(mdl);
+		inst=new PdfInstance(mdl,FilePath);
 		SetPdfInstance(inst);
 	}
 
@@ -210,8 +224,7 @@ emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::OpenJob::TryReceive(
 		if (r<1) {
 			throw emException("PDF server protocol error (%d)",__LINE__);
 		}
-		inst->ProcRunId=mdl.ProcRunId;
-		inst->InstanceId=i1;
+		mdl.Pool.SetInstanceId(inst->Instances,ProcIndex,i1);
 	}
 	else if (cmd=="title:") {
 		inst->Document.Title=Unquote(args);
@@ -260,7 +273,6 @@ emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::OpenJob::TryReceive(
 		inst->Pages.GetWritable(i1).Label=Unquote(args.Get()+pos);
 	}
 	else if (cmd=="ok") {
-		inst->ProcRunId=mdl.ProcRunId;
 		return RCV_SUCCESS;
 	}
 	else {
@@ -287,13 +299,16 @@ emPdfServerModel::GetAreasJob::~GetAreasJob()
 
 bool emPdfServerModel::GetAreasJob::Send(emPdfServerModel & mdl, emString & err)
 {
-	if (GetPdfInstance()->GetProcRunId()!=mdl.ProcRunId) {
+	int id;
+
+	id=mdl.Pool.GetInstanceId(GetPdfInstance()->Instances,ProcIndex);
+	if (id<0) {
 		err="PDF server process restarted";
 		return false;
 	}
-	mdl.WriteLineToProc(emString::Format(
+	mdl.Pool.GetProc(ProcIndex).WriteLine(emString::Format(
 		"get_areas %d %d",
-		GetPdfInstance()->GetInstanceId(),
+		id,
 		Page
 	));
 	return true;
@@ -308,7 +323,7 @@ emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::GetAreasJob::TryReceive(
 	const char * p;
 	int l,r,x1,y1,x2,y2,type,pos;
 
-	args=mdl.ReadLineFromProc();
+	args=mdl.Pool.GetProc(ProcIndex).ReadLine();
 	if (args.IsEmpty()) return RCV_WAIT;
 	p=strchr(args.Get(),' ');
 	if (p) {
@@ -395,13 +410,16 @@ emPdfServerModel::GetSelectedTextJob::~GetSelectedTextJob()
 
 bool emPdfServerModel::GetSelectedTextJob::Send(emPdfServerModel & mdl, emString & err)
 {
-	if (GetPdfInstance()->GetProcRunId()!=mdl.ProcRunId) {
+	int id;
+
+	id=mdl.Pool.GetInstanceId(GetPdfInstance()->Instances,ProcIndex);
+	if (id<0) {
 		err="PDF server process restarted";
 		return false;
 	}
-	mdl.WriteLineToProc(emString::Format(
+	mdl.Pool.GetProc(ProcIndex).WriteLine(emString::Format(
 		"get_selected_text %d %d %d %.16g %.16g %.16g %.16g",
-		GetPdfInstance()->GetInstanceId(),
+		id,
 		Page,
 		Style,
 		SelX1,
@@ -421,7 +439,7 @@ emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::GetSelectedTextJob::TryRe
 	const char * p;
 	int l;
 
-	args=mdl.ReadLineFromProc();
+	args=mdl.Pool.GetProc(ProcIndex).ReadLine();
 	if (args.IsEmpty()) return RCV_WAIT;
 	p=strchr(args.Get(),' ');
 	if (p) {
@@ -448,6 +466,89 @@ emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::GetSelectedTextJob::TryRe
 }
 
 
+emPdfServerModel::GetWordsJob::GetWordsJob(
+	PdfInstance & pdfInstance, int page, double priority
+)
+	: PdfJobBase(&pdfInstance,true,0,priority),
+	Page(page)
+{
+	Words.SetTuningLevel(1);
+}
+
+
+emPdfServerModel::GetWordsJob::~GetWordsJob()
+{
+}
+
+
+bool emPdfServerModel::GetWordsJob::Send(emPdfServerModel & mdl, emString & err)
+{
+	int id;
+
+	id=mdl.Pool.GetInstanceId(GetPdfInstance()->Instances,ProcIndex);
+	if (id<0) {
+		err="PDF server process restarted";
+		return false;
+	}
+	mdl.Pool.GetProc(ProcIndex).WriteLine(emString::Format(
+		"get_words %d %d",
+		id,
+		Page
+	));
+	return true;
+}
+
+
+emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::GetWordsJob::TryReceive(
+	emPdfServerModel & mdl, emString & err
+)
+{
+	emString cmd,args;
+	const char * p;
+	double x1,y1,x2,y2;
+	int l,r,pos;
+
+	args=mdl.Pool.GetProc(ProcIndex).ReadLine();
+	if (args.IsEmpty()) return RCV_WAIT;
+	p=strchr(args.Get(),' ');
+	if (p) {
+		l=p-args.Get();
+		cmd=args.GetSubString(0,l);
+		args.Remove(0,l+1);
+	}
+	else {
+		cmd=args;
+		args.Clear();
+	}
+
+	if (cmd=="error:") {
+		err=args;
+		return RCV_ERROR;
+	}
+	else if (cmd=="word:") {
+		pos=0;
+		r=sscanf(args,"%lg %lg %lg %lg%n",&x1,&y1,&x2,&y2,&pos);
+		if (r<4 || pos<=0 || args[pos]!=' ') {
+			throw emException("PDF server protocol error (%d)",__LINE__);
+		}
+		Words.AddNew();
+		PageWord & w=Words.GetWritable(Words.GetCount()-1);
+		w.X1=x1;
+		w.Y1=y1;
+		w.X2=x2;
+		w.Y2=y2;
+		w.Text=Unquote(args.Get()+pos+1);
+		return RCV_CONTINUE;
+	}
+	else if (cmd=="ok") {
+		return RCV_SUCCESS;
+	}
+	else {
+		throw emException("PDF server protocol error (%d)",__LINE__);
+	}
+}
+
+
 emPdfServerModel::RenderJob::RenderJob(
 	PdfInstance & pdfInstance, int page, double srcX, double srcY,
 	double srcWidth, double srcHeight, int tgtWidth, int tgtHeight,
@@ -461,8 +562,7 @@ emPdfServerModel::RenderJob::RenderJob(
 	SrcHeight(srcHeight),
 	TgtW(tgtWidth),
 	TgtH(tgtHeight),
-	ReadStage(0),
-	ReadPos(0),
+	ShmOffset(-1),
 	IsRenderSelectionJob(false)
 {
 }
@@ -473,22 +573,32 @@ emPdfServerModel::RenderJob::~RenderJob()
 }
 
 
+bool emPdfServerModel::RenderJob::TryReserve(emPdfServerModel & mdl)
+{
+	ShmOffset=mdl.Pool.TryAllocShmRange(ProcIndex,TgtW*TgtH*4);
+	return ShmOffset>=0;
+}
+
 bool emPdfServerModel::RenderJob::Send(emPdfServerModel & mdl, emString & err)
 {
-	if (GetPdfInstance()->GetProcRunId()!=mdl.ProcRunId) {
+	int id;
+
+	id=mdl.Pool.GetInstanceId(GetPdfInstance()->Instances,ProcIndex);
+	if (id<0) {
 		err="PDF server process restarted";
 		return false;
 	}
-	mdl.WriteLineToProc(emString::Format(
-		"render %d %d %.16g %.16g %.16g %.16g %d %d",
-		GetPdfInstance()->GetInstanceId(),
+	mdl.Pool.GetProc(ProcIndex).WriteLine(emString::Format(
+		"render %d %d %.16g %.16g %.16g %.16g %d %d %d",
+		id,
 		Page,
 		SrcX,
 		SrcY,
 		SrcWidth,
 		SrcHeight,
 		TgtW,
-		TgtH
+		TgtH,
+		ShmOffset
 	));
 	return true;
 }
@@ -498,62 +608,58 @@ emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::RenderJob::TryReceive(
 	emPdfServerModel & mdl, emString & err
 )
 {
-	int len,total,type,channels,width,height,maxColor;
+	const emByte * s, * e;
+	emByte * t;
+	emUInt32 u;
 	emString line;
 	const char * p;
+	int len;
 
-	if (ReadStage==0) {
-		if (mdl.ReadBuf.IsEmpty()) return RCV_WAIT;
-		if (mdl.ReadBuf[0]!='P') {
-			line=mdl.ReadLineFromProc();
-			if (line.IsEmpty()) return RCV_WAIT;
-			p="error: ";
-			len=strlen(p);
-			if (line.GetSubString(0,len)!=p) {
-				throw emException("PDF server protocol error (%d)",__LINE__);
-			}
-			line.Remove(0,len);
-			err=line;
-			return RCV_ERROR;
-		}
-		len=TryParsePnmHeader(
-			mdl.ReadBuf.Get(),mdl.ReadBuf.GetCount(),&type,&width,&height,&maxColor
-		);
-		if (len<=0) return RCV_WAIT;
-		emDLog("emPdfServerModel: Receiving: P%c %d %d %d ...",type,width,height,maxColor);
-		mdl.ReadBuf.Remove(0,len);
-		if (
-			type!=(IsRenderSelectionJob?'X':'6') ||
-			width!=TgtW || height!=TgtH || maxColor!=255
-		) {
+	emServerProcPool::Proc & proc=mdl.Pool.GetProc(ProcIndex);
+	line=proc.ReadLine();
+	if (line.IsEmpty()) return RCV_WAIT;
+
+	mdl.Pool.FreeShmRange(ProcIndex,ShmOffset,TgtW*TgtH*4);
+
+	if (line!="rendered") {
+		p="error: ";
+		len=strlen(p);
+		if (line.GetSubString(0,len)!=p) {
 			throw emException("PDF server protocol error (%d)",__LINE__);
 		}
-		ReadStage=1;
+		line.Remove(0,len);
+		err=line;
+		return RCV_ERROR;
 	}
 
-	if (mdl.ReadBuf.IsEmpty()) return RCV_WAIT;
-	channels=IsRenderSelectionJob?2:3;
-	total=TgtW*TgtH*channels;
-	len=mdl.ReadBuf.GetCount();
-	if (len>total-ReadPos) len=total-ReadPos;
 	if (GetRefCount()>1) {
-		if (
-			Image.GetWidth()!=TgtW ||
-			Image.GetHeight()!=TgtH ||
-			Image.GetChannelCount()!=channels
-		) {
-			Image.Setup(TgtW,TgtH,channels);
+		s=proc.ShmPtr+ShmOffset;
+		e=s+TgtW*TgtH*4;
+		if (IsRenderSelectionJob) {
+			Image.Setup(TgtW,TgtH,2);
+			t=Image.GetWritableMap();
+			while (s<e) {
+				u=*(const emUInt32*)s;
+				t[0]=(emByte)u;
+				t[1]=(emByte)(u>>24);
+				t+=2;
+				s+=4;
+			}
+		}
+		else {
+			Image.Setup(TgtW,TgtH,3);
+			t=Image.GetWritableMap();
+			while (s<e) {
+				u=*(const emUInt32*)s;
+				t[0]=(emByte)(u>>16);
+				t[1]=(emByte)(u>>8);
+				t[2]=(emByte)u;
+				t+=3;
+				s+=4;
+			}
 		}
-		memcpy(
-			Image.GetWritableMap()+ReadPos,
-			mdl.ReadBuf.Get(),
-			len
-		);
 	}
-	mdl.ReadBuf.Remove(0,len);
-	ReadPos+=len;
-	if (ReadPos>=total) return RCV_SUCCESS;
-	return RCV_CONTINUE;
+	return RCV_SUCCESS;
 }
 
 
@@ -580,13 +686,16 @@ emPdfServerModel::RenderSelectionJob::RenderSelectionJob(
 
 bool emPdfServerModel::RenderSelectionJob::Send(emPdfServerModel & mdl, emString & err)
 {
-	if (GetPdfInstance()->GetProcRunId()!=mdl.ProcRunId) {
+	int id;
+
+	id=mdl.Pool.GetInstanceId(GetPdfInstance()->Instances,ProcIndex);
+	if (id<0) {
 		err="PDF server process restarted";
 		return false;
 	}
-	mdl.WriteLineToProc(emString::Format(
-		"render_selection %d %d %.16g %.16g %.16g %.16g %d %d %d %.16g %.16g %.16g %.16g",
-		GetPdfInstance()->GetInstanceId(),
+	mdl.Pool.GetProc(ProcIndex).WriteLine(emString::Format(
+		"render_selection %d %d %.16g %.16g %.16g %.16g %d %d %d %d %.16g %.16g %.16g %.16g",
+		id,
 		Page,
 		SrcX,
 		SrcY,
@@ -594,6 +703,7 @@ bool emPdfServerModel::RenderSelectionJob::Send(emPdfServerModel & mdl, emString
 		SrcHeight,
 		TgtW,
 		TgtH,
+		ShmOffset,
 		Style,
 		SelX1,
 		SelY1,
@@ -621,87 +731,53 @@ void emPdfServerModel::AbortJob(PdfJobBase & job)
 
 void emPdfServerModel::Poll(unsigned maxMillisecs)
 {
-	emUInt64 endTime,now;
-	int flags;
-
-	if (JobQueue.IsEmpty()) {
-		if (
-			ProcPdfInstCount==0 &&
-			Process.IsRunning() &&
-			!ProcTerminating &&
-			emGetClockMS()-ProcIdleClock>=5000
-		) {
-			emDLog("emPdfServerModel: Terminating server process");
-			Process.CloseWriting();
-			ProcTerminating=true;
-		}
-		return;
-	}
+	emUInt64 endTime;
+	int i;
+	bool progress;
 
 	endTime=emGetClockMS()+maxMillisecs;
 
-	if (ProcTerminating) {
-		if (!Process.WaitForTermination(maxMillisecs)) return;
-		ProcTerminating=false;
-	}
-
-	ProcIdleClock=emGetClockMS();
-
-	try {
-		if (!Process.IsRunning()) {
-			ProcRunId++;
-			ProcPdfInstCount=0;
-			ReadBuf.Clear();
-			WriteBuf.Clear();
-			emDLog("emPdfServerModel: Starting server process");
-			Process.TryStart(
-				emArray<emString>(
-					emGetChildPath(
-						emGetInstallPath(EM_IDT_LIB,"emPdf","emPdf"),
-						"emPdfServerProc"
-					)
-				),
-				emArray<emString>(),
-				NULL,
-				emProcess::SF_PIPE_STDIN|
-				emProcess::SF_PIPE_STDOUT|
-				emProcess::SF_SHARE_STDERR|
-				emProcess::SF_NO_WINDOW
-			);
-		}
-		TryStartJobs();
-		for (;;) {
-			while (TryProcIO()) {
-				TryFinishJobs();
-				TryStartJobs();
+	UpdateProcLoads();
+	Pool.TerminateIdleProcs();
+
+	if (JobQueue.IsEmpty()) return;
+
+	TryStartJobs();
+	for (;;) {
+		do {
+			progress=false;
+			for (i=0; i<Pool.GetProcCount(); i++) {
+				try {
+					while (Pool.TryIO(i)) {
+						TryFinishJobs(i);
+						progress=true;
+					}
+				}
+				catch (const emException & exception) {
+					FailProc(i,exception.GetText());
+					progress=true;
+				}
 			}
-			if (!JobQueue.GetFirstRunningJob() && WriteBuf.IsEmpty()) break;
-			now=emGetClockMS();
-			if (now>=endTime) break;
-			flags=emProcess::WF_WAIT_STDOUT;
-			if (!WriteBuf.IsEmpty()) flags|=emProcess::WF_WAIT_STDIN;
-			Process.WaitPipes(flags,(unsigned)(endTime-now));
-		}
-	}
-	catch (const emException & exception) {
-		if (!JobQueue.GetFirstRunningJob()) JobQueue.FailAllJobs(exception.GetText());
-		else JobQueue.FailAllRunningJobs(exception.GetText());
-		Process.SendTerminationSignal();
-		ProcTerminating=true;
+			if (progress) TryStartJobs();
+		} while (progress);
+
+		UpdateProcLoads();
+		if (!Pool.WaitForBusyProcs(endTime)) break;
 	}
 }
 
-
 emPdfServerModel::emPdfServerModel(emContext & context, const emString & name)
 	: emModel(context,name),
-	JobQueue(GetScheduler())
-{
-	ProcRunId=0;
-	ProcPdfInstCount=0;
-	ProcIdleClock=0;
-	ProcTerminating=false;
-	ReadBuf.SetTuningLevel(4);
-	WriteBuf.SetTuningLevel(4);
+	JobQueue(GetScheduler()),
+	Pool(
+		GetRootContext(),
+		emGetChildPath(
+			emGetInstallPath(EM_IDT_LIB,"emPdf","emPdf"),
+			"emPdfServerProc"
+		),
+		"PDF"
+	)
+{
 	SetMinCommonLifetime(10);
 	SetEnginePriority(LOW_PRIORITY);
 }
@@ -709,7 +785,6 @@ emPdfServerModel::emPdfServerModel(emContext & context, const emString & name)
 
 emPdfServerModel::~emPdfServerModel()
 {
-	Process.Terminate();
 }
 
 
@@ -721,30 +796,89 @@ bool emPdfServerModel::Cycle()
 
 	Poll(IsTimeSliceAtEnd()?0:10);
 
-	if (
-		!JobQueue.IsEmpty() || !WriteBuf.IsEmpty() ||
-		(Process.IsRunning() && !ProcPdfInstCount)
-	) busy=true;
+	if (!JobQueue.IsEmpty() || Pool.IsBusy()) busy=true;
 
 	return busy;
 }
 
 
-emPdfServerModel::CloseJob::CloseJob(emUInt64 procRunId, int instanceId)
+emPdfServerModel::ReopenJob::ReopenJob(PdfInstance & pdfInstance)
+	: PdfJobBase(&pdfInstance,true,3,0.0)
+{
+}
+
+
+bool emPdfServerModel::ReopenJob::Send(emPdfServerModel & mdl, emString & err)
+{
+	mdl.Pool.GetProc(ProcIndex).WriteLine(emString::Format(
+		"open %s",GetPdfInstance()->FilePath.Get()
+	));
+	return true;
+}
+
+
+emPdfServerModel::PdfJobBase::RcvRes emPdfServerModel::ReopenJob::TryReceive(
+	emPdfServerModel & mdl, emString & err
+)
+{
+	emString cmd,args;
+	const char * p;
+	int l,r,i1;
+
+	args=mdl.Pool.GetProc(ProcIndex).ReadLine();
+	if (args.IsEmpty()) return RCV_WAIT;
+	p=strchr(args.Get(),' ');
+	if (p) {
+		l=p-args.Get();
+		cmd=args.GetSubString(0,l);
+		args.Remove(0,l+1);
+	}
+	else {
+		cmd=args;
+		args.Clear();
+	}
+
+	if (cmd=="error:") {
+		mdl.Pool.SetOpenFailed(GetPdfInstance()->Instances,ProcIndex);
+		err=args;
+		return RCV_ERROR;
+	}
+	else if (cmd=="instance:") {
+		r=sscanf(args,"%d",&i1);
+		if (r<1) {
+			throw emException("PDF server protocol error (%d)",__LINE__);
+		}
+		mdl.Pool.SetInstanceId(GetPdfInstance()->Instances,ProcIndex,i1);
+	}
+	else if (cmd=="ok") {
+		return RCV_SUCCESS;
+	}
+	// The document information has already been received by the
+	// OpenJob, the rest is ignored.
+	return RCV_CONTINUE;
+}
+
+
+emPdfServerModel::CloseJob::CloseJob(
+	int procIndex, emUInt64 procRunId, int instanceId
+)
 	: PdfJobBase(NULL,false,6,0.0),
 	ProcRunId(procRunId),
 	InstanceId(instanceId)
 {
+	ProcIndex=procIndex;
 }
 
 
 bool emPdfServerModel::CloseJob::Send(emPdfServerModel & mdl, emString & err)
 {
-	if (ProcRunId!=mdl.ProcRunId) {
+	emServerProcPool::Proc & proc=mdl.Pool.GetProc(ProcIndex);
+	if (ProcRunId!=proc.RunId) {
 		err="PDF server process restarted";
 		return false;
 	}
-	mdl.WriteLineToProc(emString::Format("close %d",InstanceId));
+	proc.WriteLine(emString::Format("close %d",InstanceId));
+	proc.InstanceCount--;
 	return true;
 }
 
@@ -778,41 +912,97 @@ int emPdfServerModel::PdfJobQueue::CompareForSortingOfWaitingJobs(
 
 void emPdfServerModel::TryStartJobs()
 {
-	PdfJobBase * job;
-	int costlyJobs;
+	PdfJobBase * job, * next;
 	emString err;
+	bool reserved;
+	int i;
 
-	costlyJobs=0;
-	for (
-		job=(PdfJobBase*)JobQueue.GetFirstRunningJob();
-		job;
-		job=(PdfJobBase*)job->GetNext()
-	) {
-		if (job->Costly) costlyJobs++;
-	}
-
-	while (costlyJobs<4) {
-		job=(PdfJobBase*)JobQueue.StartNextJob();
-		if (!job) break;
+	UpdateProcLoads();
+	JobQueue.UpdateSortingOfWaitingJobs();
+	for (job=(PdfJobBase*)JobQueue.GetFirstWaitingJob(); job; job=next) {
+		next=(PdfJobBase*)job->GetNext();
 		err.Clear();
+		i=AssignProc(*job,err);
+		if (i<0) {
+			if (!err.IsEmpty()) JobQueue.FailJob(*job,err);
+			continue;
+		}
+		job->ProcIndex=i;
+		try {
+			reserved=job->TryReserve(*this);
+		}
+		catch (const emException & exception) {
+			JobQueue.FailJob(*job,exception.GetText());
+			FailProc(i,exception.GetText());
+			continue;
+		}
+		if (!reserved) {
+			job->ProcIndex=-1;
+			continue;
+		}
+		JobQueue.StartJob(*job);
 		if (job->Send(*this,err)) {
-			if (job->Costly) costlyJobs++;
+			Pool.AddLoad(i,job->Costly);
 		}
 		else {
 			JobQueue.FailJob(*job,err);
 		}
 	}
+
+	if (!Pool.GetStartError().IsEmpty()) {
+		// Without any process, the jobs would wait forever.
+		if (!Pool.IsAnyProcRunning()) JobQueue.FailAllJobs(Pool.GetStartError());
+		Pool.ClearStartError();
+	}
 }
 
 
-void emPdfServerModel::TryFinishJobs()
+int emPdfServerModel::AssignProc(PdfJobBase & job, emString & err)
+{
+	PdfInstance * inst;
+	int i,openProc;
+	bool failed;
+
+	// A job which has a process index already is bound to that process
+	// (CloseJob).
+	if (job.ProcIndex>=0) return job.ProcIndex;
+
+	inst=job.GetPdfInstance();
+	i=Pool.AssignProc(
+		inst ? &inst->Instances : NULL,job.Costly,&openProc,&failed
+	);
+	if (openProc>=0) StartReopenJob(*inst,openProc);
+	if (failed) err="Failed to reopen PDF document";
+	return i;
+}
+
+void emPdfServerModel::StartReopenJob(PdfInstance & inst, int procIndex)
+{
+	emRef<PdfJobBase> job;
+	emString err;
+
+	job=new ReopenJob(inst);
+	job->ProcIndex=procIndex;
+	Pool.SetInstanceId(inst.Instances,procIndex,emServerProcPool::INST_OPENING);
+	JobQueue.StartJob(*job);
+	job->Send(*this,err);
+	Pool.AddLoad(procIndex,true);
+}
+
+
+void emPdfServerModel::TryFinishJobs(int procIndex)
 {
 	PdfJobBase * job;
 	PdfJobBase::RcvRes res;
 	emString err;
 
 	for (;;) {
-		job=(PdfJobBase*)JobQueue.GetFirstRunningJob();
+		// The process answers in the order of the commands.
+		for (
+			job=(PdfJobBase*)JobQueue.GetFirstRunningJob();
+			job && job->ProcIndex!=procIndex;
+			job=(PdfJobBase*)job->GetNext()
+		);
 		if (!job) break;
 		err.Clear();
 		res=job->TryReceive(*this,err);
@@ -829,112 +1019,48 @@ void emPdfServerModel::TryFinishJobs()
 }
 
 
-void emPdfServerModel::WriteLineToProc(const char * str)
-{
-	emDLog("emPdfServerModel: Sending: %s",str);
-	WriteBuf.Add(str,strlen(str));
-	WriteBuf.Add((char)'\n');
-}
-
-
-emString emPdfServerModel::ReadLineFromProc()
+void emPdfServerModel::FailProc(int procIndex, const emString & err)
 {
-	emString res;
-	char * p;
-	int l;
+	PdfJobBase * job, * next;
+	PdfInstance * inst;
 
-	if (!ReadBuf.IsEmpty()) {
-		p=(char*)memchr(ReadBuf.Get(),'\n',ReadBuf.GetCount());
-		if (p) {
-			l=p-ReadBuf.Get();
-			res=emString(ReadBuf.Get(),l);
-			ReadBuf.Remove(0,l+1);
+	for (
+		job=(PdfJobBase*)JobQueue.GetFirstRunningJob();
+		job;
+		job=next
+	) {
+		next=(PdfJobBase*)job->GetNext();
+		if (job->ProcIndex!=procIndex) continue;
+		// Count it as a failure to reopen the document, if the
+		// process died while doing so.
+		inst=job->GetPdfInstance();
+		if (
+			inst &&
+			Pool.GetInstanceId(inst->Instances,procIndex)==
+			emServerProcPool::INST_OPENING
+		) {
+			Pool.SetOpenFailed(inst->Instances,procIndex);
 		}
+		JobQueue.FailJob(*job,err);
 	}
-	if (!res.IsEmpty()) emDLog("emPdfServerModel: Receiving: %s",res.Get());
-	return res;
+	Pool.AbandonProc(procIndex);
 }
 
 
-bool emPdfServerModel::TryProcIO()
+void emPdfServerModel::UpdateProcLoads()
 {
-	char buf[256];
-	bool progress;
-	int r;
-
-	progress=false;
-
-	if (!WriteBuf.IsEmpty()) {
-		r=Process.TryWrite(WriteBuf.Get(),WriteBuf.GetCount());
-		if (r<0) throw emException("PDF server process died unexpectedly.");
-		if (r>0) {
-			WriteBuf.Remove(0,r);
-			progress=true;
-		}
-	}
-
-	while (ReadBuf.GetCount()<65536) {
-		r=Process.TryRead(buf,sizeof(buf));
-		if (r<0) throw emException("PDF server process died unexpectedly.");
-		if (r==0) break;
-		ReadBuf.Add(buf,r);
-		progress=true;
-	}
-
-	return progress;
-}
-
+	PdfJobBase * job;
 
-int emPdfServerModel::TryParsePnmHeader(
-	const char * src, int len, int * pType, int * pWidth,
-	int * pHeight, int * pMaxColor
-)
-{
-	int val[3];
-	int pos;
-	int i,c;
-
-	pos=0;
-	*pType=0;
-	*pWidth=0;
-	*pHeight=0;
-	*pMaxColor=0;
-	if (pos>=len) return 0;
-	if (src[pos++]!='P') {
-		throw emException("PDF server protocol error (%d)",__LINE__);
-	}
-	if (pos>=len) return 0;
-	*pType=(unsigned char)src[pos++];
-	for (i=0; i<3; i++) {
-		for (;;) {
-			if (pos>=len) return 0;
-			c=(unsigned char)src[pos++];
-			if (c>='0' && c<='9') break;
-			if (c=='#') {
-				while (pos<len && src[pos++]!='\n');
-			}
-			else if (c>32) {
-				throw emException("PDF server protocol error (%d)",__LINE__);
-			}
-		}
-		val[i]=c-'0';
-		for (;;) {
-			if (pos>=len) return 0;
-			c=(unsigned char)src[pos++];
-			if (c<'0' || c>'9') break;
-			val[i]=val[i]*10+(c-'0');
-		}
-	}
-	if (c>32) {
-		throw emException("PDF server protocol error (%d)",__LINE__);
+	Pool.ClearLoads();
+	for (
+		job=(PdfJobBase*)JobQueue.GetFirstRunningJob();
+		job;
+		job=(PdfJobBase*)job->GetNext()
+	) {
+		Pool.AddLoad(job->ProcIndex,job->Costly);
 	}
-	*pWidth=val[0];
-	*pHeight=val[1];
-	*pMaxColor=val[2];
-	return pos;
 }
 
-
 emString emPdfServerModel::Unquote(const char * str)
 {
 	emString res;
@@ -25,10 +25,14 @@
 #include <locale.h>
 #include <gtk/gtk.h>
 #include <poppler.h>
-#ifdef _WIN32
-#	include <fcntl.h>
-#	include <io.h>
+#if defined(_WIN32) || defined(__CYGWIN__)
+#	if defined(_WIN32)
+#		include <fcntl.h>
+#		include <io.h>
+#	endif
 #	include <windows.h>
+#else
+#	include <sys/shm.h>
 #endif
 
 
@@ -42,6 +46,13 @@ static emPdfInst * * emPdfInstArray=NULL;
 static int emPdfInstArraySize=0;
 
 
+#if defined(_WIN32) || defined(__CYGWIN__)
+static HANDLE emPdfShmHdl=NULL;
+#endif
+static void * emPdfShmPtr=NULL;
+static size_t emPdfShmSize=0;
+
+
 static void emPdfPrintQuoted(const char * str, int maxLen)
 {
 	int i,c;
@@ -149,6 +160,92 @@ static char * emPdfEncodeFileUri(const char * absFilePath)
 }
 
 
+static void emPdfAttachShm(const char * args)
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+	MEMORY_BASIC_INFORMATION mbi;
+
+	emPdfShmSize=0;
+
+	if (emPdfShmPtr) {
+		UnmapViewOfFile(emPdfShmPtr);
+		emPdfShmPtr=NULL;
+	}
+
+	if (emPdfShmHdl) {
+		CloseHandle(emPdfShmHdl);
+		emPdfShmHdl=NULL;
+	}
+
+	if (*args) {
+		emPdfShmHdl=OpenFileMapping(FILE_MAP_ALL_ACCESS,FALSE,args);
+		if (!emPdfShmHdl) {
+			fprintf(
+				stderr,
+				"emPdfServerProc: Failed to attach shared memory (OpenFileMapping: 0x%lX)\n",
+				(long)GetLastError()
+			);
+			exit(1);
+		}
+		emPdfShmPtr=MapViewOfFile(emPdfShmHdl,FILE_MAP_ALL_ACCESS,0,0,0);
+		if (!emPdfShmPtr) {
+			fprintf(
+				stderr,
+				"emPdfServerProc: Failed to attach shared memory (MapViewOfFile: 0x%lX)\n",
+				(long)GetLastError()
+			);
+			exit(1);
+		}
+		if (!VirtualQuery(emPdfShmPtr,&mbi,sizeof(mbi))) {
+			fprintf(
+				stderr,
+				"emPdfServerProc: Failed to attach shared memory (VirtualQuery: 0x%lX)\n",
+				(long)GetLastError()
+			);
+			exit(1);
+		}
+		emPdfShmSize=mbi.RegionSize;
+	}
+#else
+	struct shmid_ds ds;
+	int shmId;
+
+	if (sscanf(args,"%d",&shmId)!=1) {
+		fprintf(stderr,"emPdfServerProc: emPdfAttachShm: illegal arguments.\n");
+		exit(1);
+	}
+
+	if (emPdfShmPtr) {
+		shmdt(emPdfShmPtr);
+		emPdfShmPtr=NULL;
+	}
+	emPdfShmSize=0;
+
+	if (shmId!=-1) {
+		if (shmctl(shmId,IPC_STAT,&ds)!=0) {
+			fprintf(
+				stderr,
+				"emPdfServerProc: Failed to query shared memory segment (%s)\n",
+				strerror(errno)
+			);
+			exit(1);
+		}
+		emPdfShmPtr=shmat(shmId,NULL,0);
+		if (emPdfShmPtr==(void*)-1) {
+			emPdfShmPtr=NULL;
+			fprintf(
+				stderr,
+				"emPdfServerProc: Failed to attach shared memory segment (%s)\n",
+				strerror(errno)
+			);
+			exit(1);
+		}
+		emPdfShmSize=ds.shm_segsz;
+	}
+#endif
+}
+
+
 static void emPdfOpen(const char * args)
 {
 	const char * filePath;
@@ -530,6 +627,77 @@ static void emPdfGetSelectedText(const char * args)
 }
 
 
+static void emPdfGetWords(const char * args)
+{
+	PopplerRectangle * rects;
+	PopplerPage * page;
+	const char * p, * start;
+	char * text;
+	double x1,y1,x2,y2;
+	guint i,n;
+	int instId,pageIndex;
+	gunichar c;
+
+	if (
+		sscanf(args,"%d %d",&instId,&pageIndex)!=2 ||
+		instId<0 || instId>=emPdfInstArraySize ||
+		!emPdfInstArray[instId] ||
+		pageIndex<0 || pageIndex>=emPdfInstArray[instId]->pageCount
+	) {
+		printf("error: emPdfGetWords: illegal arguments.\n");
+		return;
+	}
+
+	page=poppler_document_get_page(emPdfInstArray[instId]->doc,pageIndex);
+	if (!page) {
+		printf("ok\n");
+		return;
+	}
+
+	text=poppler_page_get_text(page);
+	rects=NULL;
+	n=0;
+	if (text && !poppler_page_get_text_layout(page,&rects,&n)) {
+		rects=NULL;
+		n=0;
+	}
+
+	start=NULL;
+	x1=y1=x2=y2=0.0;
+	for (i=0, p=text; ; i++, p=g_utf8_next_char(p)) {
+		c = (i<n && *p) ? g_utf8_get_char(p) : 0;
+		if (c && g_unichar_isalnum(c)) {
+			if (!start) {
+				start=p;
+				x1=rects[i].x1;
+				y1=rects[i].y1;
+				x2=rects[i].x2;
+				y2=rects[i].y2;
+			}
+			else {
+				if (x1>rects[i].x1) x1=rects[i].x1;
+				if (y1>rects[i].y1) y1=rects[i].y1;
+				if (x2<rects[i].x2) x2=rects[i].x2;
+				if (y2<rects[i].y2) y2=rects[i].y2;
+			}
+		}
+		else if (start) {
+			printf("word: %.2f %.2f %.2f %.2f ",x1,y1,x2,y2);
+			emPdfPrintQuotedFromUtf8(start,p-start);
+			putchar('\n');
+			start=NULL;
+		}
+		if (!c) break;
+	}
+
+	if (rects) g_free(rects);
+	if (text) g_free(text);
+	g_object_unref(page);
+
+	printf("ok\n");
+}
+
+
 static void emPdfRender(const char * args, int renderSelection)
 {
 	static const PopplerSelectionStyle styles[]={
@@ -539,23 +707,21 @@ static void emPdfRender(const char * args, int renderSelection)
 	};
 	PopplerRectangle selection;
 	PopplerColor fgColor,bgColor;
-	unsigned char * buf, * ps, * pt, * pe;
+	unsigned char * buf;
 	PopplerPage * page;
 	cairo_surface_t * surface;
 	cairo_t * cr;
 	emPdfInst * inst;
-	FILE * f;
 	double srcX, srcY, srcW, srcH, selX1, selY1, selX2, selY2;
-	int instId, pageIndex, outW, outH, style;
-	unsigned int v;
+	int instId, pageIndex, outW, outH, shmOffset, style;
 
 	if (renderSelection) {
 		if (
 			sscanf(
-				args,"%d %d %lg %lg %lg %lg %d %d %d %lg %lg %lg %lg",
+				args,"%d %d %lg %lg %lg %lg %d %d %d %d %lg %lg %lg %lg",
 				&instId,&pageIndex,&srcX,&srcY,&srcW,&srcH,&outW,&outH,
-				&style,&selX1,&selY1,&selX2,&selY2
-			)!=13
+				&shmOffset,&style,&selX1,&selY1,&selX2,&selY2
+			)!=14
 		) {
 			printf("error: emPdfRender: illegal arguments.\n");
 			return;
@@ -564,9 +730,10 @@ static void emPdfRender(const char * args, int renderSelection)
 	else {
 		if (
 			sscanf(
-				args,"%d %d %lg %lg %lg %lg %d %d",
-				&instId,&pageIndex,&srcX,&srcY,&srcW,&srcH,&outW,&outH
-			)!=8
+				args,"%d %d %lg %lg %lg %lg %d %d %d",
+				&instId,&pageIndex,&srcX,&srcY,&srcW,&srcH,&outW,&outH,
+				&shmOffset
+			)!=9
 		) {
 			printf("error: emPdfRender: illegal arguments.\n");
 			return;
@@ -581,15 +748,27 @@ static void emPdfRender(const char * args, int renderSelection)
 		pageIndex<0 || pageIndex>=emPdfInstArray[instId]->pageCount ||
 		srcW<=0.0 || srcH<=0.0 ||
 		outW<=0 || outH<=0 ||
+		shmOffset<0 ||
 		style<0 || style>2
 	) {
 		printf("error: emPdfRender: illegal arguments.\n");
 		return;
 	}
 
+	if (!emPdfShmPtr) {
+		printf("error: emPdfRender: no shared memory segment attached.\n");
+		return;
+	}
+
+	/* In double, so that the product cannot overflow. */
+	if ((double)shmOffset+(double)outW*outH*4.0>(double)emPdfShmSize) {
+		printf("error: emPdfRender: image exceeds shared memory segment.\n");
+		return;
+	}
+
 	inst=emPdfInstArray[instId];
 
-	buf=(unsigned char*)malloc(outW*outH*4);
+	buf=((unsigned char*)emPdfShmPtr)+shmOffset;
 	memset(buf,renderSelection?0x00:0xff,outW*outH*4);
 
 	surface=cairo_image_surface_create_for_data(
@@ -604,7 +783,6 @@ static void emPdfRender(const char * args, int renderSelection)
 			"error: PDF rendering failed (bad surface status: %d).\n",
 			(int)cairo_surface_status(surface)
 		);
-		free(buf);
 		return;
 	}
 
@@ -615,7 +793,6 @@ static void emPdfRender(const char * args, int renderSelection)
 			(int)cairo_status(cr)
 		);
 		cairo_surface_destroy(surface);
-		free(buf);
 		return;
 	}
 
@@ -648,42 +825,14 @@ static void emPdfRender(const char * args, int renderSelection)
 		memset(buf,0x88,outW*outH*4);
 	}
 
-	cairo_destroy(cr);
-	cairo_surface_destroy(surface);
-
 #if defined(EM_PDF_DEBUG_RENDER_TO_FILE)
-	f=fopen("/tmp/emPdfTest.ppm","wb");
-#else
-	f=stdout;
+	cairo_surface_write_to_png(surface,"/tmp/emPdfTest.png");
 #endif
-	ps=buf;
-	pt=buf;
-	pe=buf+outW*outH*4;
-	if (renderSelection) {
-		fprintf(f,"PX\n%d\n%d\n255\n",outW,outH);
-		while (ps<pe) {
-			v=*(unsigned int*)ps;
-			pt[0]=(unsigned char)v;
-			pt[1]=(unsigned char)(v>>24);
-			ps+=4;
-			pt+=2;
-		}
-	}
-	else {
-		fprintf(f,"P6\n%d\n%d\n255\n",outW,outH);
-		while (ps<pe) {
-			v=*(unsigned int*)ps;
-			pt[0]=(unsigned char)(v>>16);
-			pt[1]=(unsigned char)(v>>8);
-			pt[2]=(unsigned char)v;
-			ps+=4;
-			pt+=3;
-		}
-	}
-	fwrite(buf,pt-buf,1,f);
-	if (f!=stdout) fclose(f);
 
-	free(buf);
+	cairo_destroy(cr);
+	cairo_surface_destroy(surface);
+
+	printf("rendered\n");
 }
 
 
@@ -704,9 +853,11 @@ static int emPdfServe(int argc, char * argv[])
 		args=strchr(buf,' ');
 		if (args) *args++=0;
 		else args=buf+len;
-		if      (strcmp(buf,"open")==0) emPdfOpen(args);
+		if      (strcmp(buf,"attachshm")==0) emPdfAttachShm(args);
+		else if (strcmp(buf,"open")==0) emPdfOpen(args);
 		else if (strcmp(buf,"get_areas")==0) emPdfGetAreas(args);
 		else if (strcmp(buf,"get_selected_text")==0) emPdfGetSelectedText(args);
+		else if (strcmp(buf,"get_words")==0) emPdfGetWords(args);
 		else if (strcmp(buf,"render")==0) emPdfRender(args, 0);
 		else if (strcmp(buf,"render_selection")==0) emPdfRender(args, 1);
 		else if (strcmp(buf,"close")==0) emPdfClose(args);
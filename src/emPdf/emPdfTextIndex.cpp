@@ -0,0 +1,313 @@
+//------------------------------------------------------------------------------
+// emPdfTextIndex.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emPdf/emPdfTextIndex.h>
+#include <wctype.h>
+
+
+emPdfTextIndex::emPdfTextIndex(emScheduler & scheduler)
+	: emEngine(scheduler),
+	ServerModel(NULL),
+	PdfInstance(NULL),
+	Started(false),
+	NextPage(0),
+	RunningJobs(0),
+	IndexedPageCount(0)
+{
+}
+
+
+emPdfTextIndex::~emPdfTextIndex()
+{
+	Reset();
+}
+
+
+void emPdfTextIndex::Setup(
+	emPdfServerModel & serverModel, emPdfServerModel::PdfInstance & pdfInstance
+)
+{
+	Reset();
+	ServerModel=&serverModel;
+	PdfInstance=&pdfInstance;
+	Pages.SetCount(pdfInstance.GetPageCount());
+}
+
+
+void emPdfTextIndex::Reset()
+{
+	int i;
+
+	if (ServerModel) {
+		for (i=Pages.GetCount()-1; i>=0; i--) {
+			if (Pages[i].Job) {
+				ServerModel->AbortJob(*Pages[i].Job);
+			}
+		}
+	}
+	ServerModel=NULL;
+	PdfInstance=NULL;
+	Pages.Clear();
+	Index.Clear();
+	Started=false;
+	NextPage=0;
+	RunningJobs=0;
+	if (IndexedPageCount) {
+		IndexedPageCount=0;
+		Signal(ChangeSignal);
+	}
+	ErrorText.Clear();
+}
+
+
+void emPdfTextIndex::StartIndexing()
+{
+	if (Started || !ServerModel || !PdfInstance) return;
+	Started=true;
+	StartJobs();
+}
+
+
+void emPdfTextIndex::Search(const char * text, emArray<Hit> & hits) const
+{
+	const emAvlTreeMap<emString,emArray<Occurrence> >::Element * e;
+	const Occurrence * o;
+	emArray<emString> terms;
+	Hit hit;
+	int i,n;
+
+	hits.Clear();
+	hits.SetTuningLevel(4);
+	terms=SplitWords(FoldCase(text));
+	n=terms.GetCount();
+	if (n<=0) return;
+
+	if (n==1) e=Index.GetNearestGreaterOrEqual(terms[0]);
+	else e=Index.Get(terms[0]);
+	while (e) {
+		if (
+			n==1 &&
+			strncmp(e->Key.Get(),terms[0].Get(),terms[0].GetLen())!=0
+		) break;
+		for (i=0; i<e->Value.GetCount(); i++) {
+			o=&e->Value[i];
+			if (MatchAt(o->Page,o->Word,terms)) {
+				hit.Page=o->Page;
+				hit.FirstWord=o->Word;
+				hit.LastWord=o->Word+n-1;
+				hits.Add(hit);
+			}
+		}
+		if (n>1) break;
+		e=Index.GetNearestGreater(e->Key);
+	}
+
+	hits.Sort(CompareHits);
+}
+
+
+emString emPdfTextIndex::FoldCase(const char * str)
+{
+	emArray<char> buf;
+	emMBState rdState,wrState;
+	char tmp[EM_MB_LEN_MAX];
+	int c,n;
+
+	buf.SetTuningLevel(4);
+	for (;;) {
+		n=emDecodeChar(&c,str,INT_MAX,&rdState);
+		if (n<=0 || !c) break;
+		str+=n;
+		c=towlower((wint_t)c);
+		buf.Add(tmp,emEncodeChar(tmp,c,&wrState));
+	}
+	return emString(buf.Get(),buf.GetCount());
+}
+
+
+emArray<emString> emPdfTextIndex::SplitWords(const char * str)
+{
+	emArray<emString> words;
+	emMBState state;
+	const char * start;
+	int c,n;
+
+	start=NULL;
+	for (;;) {
+		n=emDecodeChar(&c,str,INT_MAX,&state);
+		if (n>0 && c && iswalnum((wint_t)c)) {
+			if (!start) start=str;
+		}
+		else if (start) {
+			words.Add(emString(start,str-start));
+			start=NULL;
+		}
+		if (n<=0 || !c) break;
+		str+=n;
+	}
+	return words;
+}
+
+
+bool emPdfTextIndex::Cycle()
+{
+	PageEntry * e;
+	bool changed;
+	int i;
+
+	changed=false;
+	for (i=Pages.GetCount()-1; i>=0; i--) {
+		if (!Pages[i].Job) continue;
+		e=&Pages.GetWritable(i);
+		switch (e->Job->GetState()) {
+		case emJob::ST_ERROR:
+		case emJob::ST_ABORTED:
+			if (ErrorText.IsEmpty()) {
+				ErrorText=emString::Format(
+					"Page %d: %s",
+					i+1,
+					e->Job->GetErrorText().Get()
+				);
+			}
+			e->Job=NULL;
+			RunningJobs--;
+			IndexedPageCount++;
+			changed=true;
+			break;
+		case emJob::ST_SUCCESS:
+			AddPage(i,e->Job->GetWords());
+			e=&Pages.GetWritable(i);
+			e->Job=NULL;
+			RunningJobs--;
+			IndexedPageCount++;
+			changed=true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (changed) {
+		StartJobs();
+		Signal(ChangeSignal);
+	}
+
+	return false;
+}
+
+
+void emPdfTextIndex::StartJobs()
+{
+	PageEntry * e;
+
+	while (RunningJobs<MAX_RUNNING_JOBS && NextPage<Pages.GetCount()) {
+		e=&Pages.GetWritable(NextPage);
+		e->Job=new emPdfServerModel::GetWordsJob(*PdfInstance,NextPage);
+		ServerModel->EnqueueJob(*e->Job);
+		AddWakeUpSignal(e->Job->GetStateSignal());
+		RunningJobs++;
+		NextPage++;
+	}
+}
+
+
+void emPdfTextIndex::AddPage(
+	int page, const emArray<emPdfServerModel::PageWord> & words
+)
+{
+	emArray<emPdfServerModel::PageWord> * pageWords;
+	emArray<Occurrence> * occurrences;
+	Occurrence o;
+	int i;
+
+	pageWords=&Pages.GetWritable(page).Words;
+	*pageWords=words;
+	for (i=0; i<pageWords->GetCount(); i++) {
+		emPdfServerModel::PageWord & w=pageWords->GetWritable(i);
+		w.Text=FoldCase(w.Text);
+		occurrences=Index.GetValueWritable(w.Text,true);
+		if (occurrences->IsEmpty()) occurrences->SetTuningLevel(4);
+		o.Page=page;
+		o.Word=i;
+		occurrences->Add(o);
+	}
+}
+
+
+bool emPdfTextIndex::MatchAt(
+	int page, int word, const emArray<emString> & terms
+) const
+{
+	const emArray<emPdfServerModel::PageWord> & words=Pages[page].Words;
+	const emString * t;
+	int i,n;
+
+	n=terms.GetCount();
+	if (word+n>words.GetCount()) return false;
+	for (i=1; i<n; i++) {
+		t=&words[word+i].Text;
+		if (i<n-1) {
+			if (*t!=terms[i]) return false;
+		}
+		else {
+			if (strncmp(t->Get(),terms[i].Get(),terms[i].GetLen())!=0) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+int emPdfTextIndex::CompareHits(
+	const Hit * hit1, const Hit * hit2, void * context
+)
+{
+	if (hit1->Page!=hit2->Page) return hit1->Page-hit2->Page;
+	return hit1->FirstWord-hit2->FirstWord;
+}
+
+
+emPdfTextIndex::PageEntry::PageEntry()
+{
+	Words.SetTuningLevel(1);
+}
+
+
+emPdfTextIndex::PageEntry::PageEntry(const PageEntry & pageEntry)
+	: Job(pageEntry.Job),
+	Words(pageEntry.Words)
+{
+}
+
+
+emPdfTextIndex::PageEntry::~PageEntry()
+{
+}
+
+
+emPdfTextIndex::PageEntry & emPdfTextIndex::PageEntry::operator = (
+	const PageEntry & pageEntry
+)
+{
+	Job=pageEntry.Job;
+	Words=pageEntry.Words;
+	return *this;
+}
@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------
+// emPdfTileCache.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emPdf/emPdfTileCache.h>
+
+
+emPdfTileCache::emPdfTileCache(emScheduler & scheduler)
+	: emTileCache(scheduler),
+	ServerModel(NULL),
+	PdfInstance(NULL)
+{
+}
+
+
+emPdfTileCache::~emPdfTileCache()
+{
+	Reset();
+}
+
+
+void emPdfTileCache::Setup(
+	emPdfServerModel & serverModel, emPdfServerModel::PdfInstance & pdfInstance
+)
+{
+	Reset();
+	ServerModel=&serverModel;
+	PdfInstance=&pdfInstance;
+}
+
+
+void emPdfTileCache::Reset()
+{
+	emTileCache::Reset();
+	ServerModel=NULL;
+	PdfInstance=NULL;
+}
+
+
+bool emPdfTileCache::GetPageSize(
+	int page, double * pWidth, double * pHeight
+) const
+{
+	if (!PdfInstance || page<0 || page>=PdfInstance->GetPageCount()) {
+		return false;
+	}
+	*pWidth=PdfInstance->GetPageInfo(page).Width;
+	*pHeight=PdfInstance->GetPageInfo(page).Height;
+	return true;
+}
+
+
+emRef<emJob> emPdfTileCache::StartTileJob(
+	int page, double srcX, double srcY, double srcWidth, double srcHeight,
+	int tgtWidth, int tgtHeight, double priority
+)
+{
+	emRef<emPdfServerModel::RenderJob> job;
+
+	if (!ServerModel || !PdfInstance) return NULL;
+	job=new emPdfServerModel::RenderJob(
+		*PdfInstance,page,srcX,srcY,srcWidth,srcHeight,
+		tgtWidth,tgtHeight,priority
+	);
+	ServerModel->EnqueueJob(*job);
+	return emRef<emJob>(job.Get());
+}
+
+
+void emPdfTileCache::AbortTileJob(emJob & job)
+{
+	if (ServerModel) {
+		ServerModel->AbortJob((emPdfServerModel::RenderJob&)job);
+	}
+}
+
+
+const emImage & emPdfTileCache::GetTileJobImage(const emJob & job) const
+{
+	return ((const emPdfServerModel::RenderJob&)job).GetImage();
+}
@@ -40,4 +40,23 @@ extern "C" {
 			)
 		);
 	}
+
+
+	emRef<emModel> emPngFpPluginModelFunc(
+		emContext & context, const emString & className,
+		const emString & name, bool common, emFpPlugin * plugin,
+		emString * errorBuf
+	)
+	{
+		if (
+			className!="emImageFileModel" &&
+			className!="emPngImageFileModel"
+		) {
+			*errorBuf="emPngFpPlugin: Unsupported model class.";
+			return NULL;
+		}
+		return emRef<emModel>(
+			emPngImageFileModel::Acquire(context,name,common)
+		);
+	}
 }
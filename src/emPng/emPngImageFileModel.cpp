@@ -53,6 +53,7 @@ void emPngImageFileModel::TryStartLoading()
 
 	L=new LoadingState;
 	memset(L,0,sizeof(LoadingState));
+	L->reduction=1;
 
 	L->file=fopen(GetFilePath(),"rb");
 	if (!L->file) throw emException("%s",emGetErrorText(errno).Get());
@@ -65,6 +66,8 @@ void emPngImageFileModel::TryStartLoading()
 	);
 	if (!L->decodeInstance) throw emException("%s",errorBuf);
 
+	L->reduction=CalcReduction(L->width,L->height,L->channelCount,8);
+
 	FileFormatInfo=infoBuf;
 	Signal(ChangeSignal);
 }
@@ -72,16 +75,45 @@ void emPngImageFileModel::TryStartLoading()
 
 bool emPngImageFileModel::TryContinueLoading()
 {
+	static const emByte adam7Passes[8][8]={
+		{ 0, 5, 3, 5, 1, 5, 3, 5 },
+		{ 6, 6, 6, 6, 6, 6, 6, 6 },
+		{ 4, 5, 4, 5, 4, 5, 4, 5 },
+		{ 6, 6, 6, 6, 6, 6, 6, 6 },
+		{ 2, 5, 3, 5, 2, 5, 3, 5 },
+		{ 6, 6, 6, 6, 6, 6, 6, 6 },
+		{ 4, 5, 4, 5, 4, 5, 4, 5 },
+		{ 6, 6, 6, 6, 6, 6, 6, 6 }
+	};
 	char commentBuf[1024];
 	char errorBuf[256];
-	int r;
+	const emByte * s;
+	emByte * t;
+	int r,x,c,n;
 
 	if (!L->imagePrepared) {
-		Image.Setup(
-			L->width,
-			L->height,
-			L->channelCount
-		);
+		if (L->reduction>1) {
+			if (L->passCount==1) {
+				Reducer.Setup(
+					Image,L->width,L->height,L->channelCount,L->reduction
+				);
+			}
+			else {
+				Image.Setup(
+					(L->width+L->reduction-1)/L->reduction,
+					(L->height+L->reduction-1)/L->reduction,
+					L->channelCount
+				);
+			}
+			L->row=new emByte[L->width*(size_t)L->channelCount];
+		}
+		else {
+			Image.Setup(
+				L->width,
+				L->height,
+				L->channelCount
+			);
+		}
 		Signal(ChangeSignal);
 		L->imagePrepared=true;
 		return false;
@@ -91,10 +123,26 @@ bool emPngImageFileModel::TryContinueLoading()
 	errorBuf[0]=0;
 	r=emPngContinueDecoding(
 		L->decodeInstance,
+		L->row ? L->row :
 		Image.GetWritableMap()+L->y*(size_t)Image.GetWidth()*Image.GetChannelCount(),
 		commentBuf,sizeof(commentBuf),errorBuf,sizeof(errorBuf)
 	);
 	if (r<0) throw emException("%s",errorBuf);
+	if (L->row && L->passCount==1) {
+		Reducer.PutRow(Image,L->row);
+	}
+	else if (L->row && L->y%L->reduction==0) {
+		// Interlaced: Each pass gives only some of the pixels of a
+		// row. Take every reduction'th pixel when its pass comes.
+		n=L->channelCount;
+		s=L->row;
+		t=Image.GetWritableMap()+
+			(L->y/L->reduction)*(size_t)Image.GetWidth()*n;
+		for (x=0; x<L->width; x+=L->reduction, s+=L->reduction*n, t+=n) {
+			if (adam7Passes[L->y&7][x&7]!=L->pass) continue;
+			for (c=0; c<n; c++) t[c]=s[c];
+		}
+	}
 
 	L->y++;
 	if (L->y>=L->height) {
@@ -115,6 +163,7 @@ void emPngImageFileModel::QuitLoading()
 	if (L) {
 		if (L->decodeInstance) emPngQuitDecoding(L->decodeInstance);
 		if (L->file) fclose(L->file);
+		if (L->row) delete [] L->row;
 		delete L;
 		L=NULL;
 	}
@@ -141,8 +190,8 @@ void emPngImageFileModel::QuitSaving()
 emUInt64 emPngImageFileModel::CalcMemoryNeed()
 {
 	if (L) {
-		return ((emUInt64)L->width)*
-		       L->height*
+		return ((emUInt64)(L->width+L->reduction-1)/L->reduction)*
+		       ((L->height+L->reduction-1)/L->reduction)*
 		       L->channelCount;
 	}
 	else {
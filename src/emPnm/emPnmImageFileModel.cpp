@@ -51,6 +51,7 @@ void emPnmImageFileModel::TryStartLoading()
 
 	L=new LoadingState;
 	memset(L,0,sizeof(LoadingState));
+	L->Reduction=1;
 
 	L->File=fopen(GetFilePath(),"rb");
 	if (!L->File) goto Err;
@@ -69,6 +70,10 @@ void emPnmImageFileModel::TryStartLoading()
 		if (L->MaxVal<1 || L->MaxVal>65535) goto Err;
 	}
 
+	L->Reduction=CalcReduction(
+		L->Width,L->Height,L->Format==3 || L->Format==6 ? 3 : 1,8
+	);
+
 	return;
 
 Err:
@@ -87,7 +92,13 @@ bool emPnmImageFileModel::TryContinueLoading()
 	if (L->Format==3 || L->Format==6) n=3; else n=1;
 
 	if (!L->ImagePrepared) {
-		Image.Setup(L->Width,L->Height,n);
+		if (L->Reduction>1) {
+			Reducer.Setup(Image,L->Width,L->Height,n,L->Reduction);
+			L->Row=new unsigned char[L->Width*(size_t)n];
+		}
+		else {
+			Image.Setup(L->Width,L->Height,n);
+		}
 		switch (L->Format) {
 		case 1: FileFormatInfo="PNM P1 (PBM ASCII)"; break;
 		case 2: FileFormatInfo="PNM P2 (PGM ASCII)"; break;
@@ -105,7 +116,8 @@ bool emPnmImageFileModel::TryContinueLoading()
 		return true;
 	}
 
-	map=Image.GetWritableMap()+L->NextY*(size_t)L->Width*n;
+	if (L->Row) map=L->Row;
+	else map=Image.GetWritableMap()+L->NextY*(size_t)L->Width*n;
 	mapEnd=map+n*L->Width;
 
 	if (L->Format==1) {
@@ -145,6 +157,8 @@ bool emPnmImageFileModel::TryContinueLoading()
 		}
 	}
 
+	if (L->Row) Reducer.PutRow(Image,L->Row);
+
 	Signal(ChangeSignal);
 
 	if (ferror(L->File)) goto Err;
@@ -166,6 +180,7 @@ void emPnmImageFileModel::QuitLoading()
 {
 	if (L) {
 		if (L->File) fclose(L->File);
+		if (L->Row) delete [] L->Row;
 		delete L;
 		L=NULL;
 	}
@@ -194,7 +209,8 @@ emUInt64 emPnmImageFileModel::CalcMemoryNeed()
 	emUInt64 m;
 
 	if (L) {
-		m=((emUInt64)L->Width)*L->Height;
+		m=((emUInt64)(L->Width+L->Reduction-1)/L->Reduction)*
+		  ((L->Height+L->Reduction-1)/L->Reduction);
 		if (L->Format==3 || L->Format==6) m*=3;
 		return m;
 	}
@@ -19,6 +19,7 @@
 //------------------------------------------------------------------------------
 
 #include <emPs/emPsRenderer.h>
+#include <emCore/emThread.h>
 
 
 emRef<emPsRenderer> emPsRenderer::Acquire(emRootContext & rootContext)
@@ -42,17 +43,18 @@ emPsRenderer::RenderJob::RenderJob(
 void emPsRenderer::EnqueueJob(RenderJob & renderJob)
 {
 	JobQueue.EnqueueJob(renderJob);
-	PSPriorityValid=false;
 	WakeUp();
 }
 
 
 void emPsRenderer::AbortJob(RenderJob & renderJob)
 {
-	if (CurrentJob==&renderJob) CurrentJob=NULL;
-	if (renderJob.GetState()==emJob::ST_WAITING) {
-		PSPriorityValid=false;
-		WakeUp();
+	int i;
+
+	for (i=Interpreters.GetCount()-1; i>=0; i--) {
+		if (Interpreters[i]->GetJob()==&renderJob) {
+			Interpreters[i]->ForgetJob();
+		}
 	}
 	JobQueue.AbortJob(renderJob);
 }
@@ -60,275 +62,374 @@ void emPsRenderer::AbortJob(RenderJob & renderJob)
 
 emPsRenderer::emPsRenderer(emContext & context, const emString & name)
 	: emModel(context,name),
-	Timer(GetScheduler()),
-	PSAgent(*this),
 	JobQueue(GetScheduler())
 {
 	SetMinCommonLifetime(5);
-	PSPriorityValid=false;
-	MainState=COLD_WAIT_JOB;
-	CurrentJob=NULL;
-	CurrentPageIndex=0;
-	AddWakeUpSignal(Timer.GetSignal());
+	CoreConfig=emCoreConfig::Acquire(GetRootContext());
+	Interpreters.SetTuningLevel(4);
 }
 
 
 emPsRenderer::~emPsRenderer()
 {
-	Process.Terminate();
+	int i;
+
+	for (i=Interpreters.GetCount()-1; i>=0; i--) delete Interpreters[i];
+	Interpreters.Clear();
 }
 
 
 bool emPsRenderer::Cycle()
 {
-	bool busy,readProceeded,writeProceeded;
-	RenderJob * job;
-	int flags;
+	emArray<emProcess*> waitProcs;
+	emArray<int> waitFlags;
+	bool proceeded;
+	int i;
 
-	busy=false;
+	for (;;) {
+		proceeded=false;
+		for (i=0; i<Interpreters.GetCount(); i++) {
+			if (Interpreters[i]->TryProceed()) proceeded=true;
+		}
+		if (StartJobs()) proceeded=true;
+		if (IsTimeSliceAtEnd()) break;
+		if (proceeded) continue;
+		waitProcs.Clear();
+		waitFlags.Clear();
+		for (i=0; i<Interpreters.GetCount(); i++) {
+			switch (Interpreters[i]->GetState()) {
+			case Interpreter::IS_STARTING:
+			case Interpreter::IS_RUNNING:
+				Interpreters[i]->AddWaitPipes(waitProcs,waitFlags);
+				break;
+			default:
+				break;
+			}
+		}
+		if (waitProcs.IsEmpty()) break;
+		emProcess::WaitPipes(
+			waitProcs.Get(),waitFlags.Get(),waitProcs.GetCount(),10
+		);
+	}
 
-	switch (MainState) {
+	for (i=0; i<Interpreters.GetCount(); i++) {
+		if (Interpreters[i]->GetState()!=Interpreter::IS_OFF) return true;
+	}
+	return false;
+}
 
-L_ENTER_COLD_WAIT_JOB:
-		CurrentDocument.Clear();
-		PSAgent.ReleaseAccess();
-		MainState=COLD_WAIT_JOB;
-	case COLD_WAIT_JOB:
-		if (JobQueue.GetFirstWaitingJob()) goto L_ENTER_COLD_WAIT_ACCESS;
-		break;
 
-L_ENTER_COLD_WAIT_ACCESS:
-		UpdatePSPriority();
-		PSAgent.RequestAccess();
-		MainState=COLD_WAIT_ACCESS;
-	case COLD_WAIT_ACCESS:
-		if (!JobQueue.GetFirstWaitingJob()) goto L_ENTER_COLD_WAIT_JOB;
-		if (PSAgent.HasAccess()) goto L_ENTER_PREPARE_PROCESS;
-		UpdatePSPriority();
-		break;
+bool emPsRenderer::StartJobs()
+{
+	emArray<bool> claimed;
+	emJob * job, * nextJob;
+	RenderJob * renderJob;
+	Interpreter * ip;
+	int i,n,maxCount,readyIdx,startingIdx,offIdx,otherIdx;
+	bool proceeded;
 
-L_ENTER_PREPARE_PROCESS:
-		job=SearchBestJob();
-		if (!job) goto L_ENTER_COLD_WAIT_JOB;
-		CurrentDocument=job->Document;
-		try {
-			TryStartProcess();
-		}
-		catch (const emException & exception) {
-			FailAllJobs(exception.GetText());
-			goto L_ENTER_COLD_WAIT_JOB;
-		}
-		PrepareWritingStartup();
-		PrepareReadingStartup();
-		Timer.Start(12000);
-		MainState=PREPARE_PROCESS;
-	case PREPARE_PROCESS:
-		if (!Process.IsRunning()) {
-			FailDocJobs("PostScript interpretation failed: Interpreter exited.");
-			goto L_ENTER_QUIT_PROCESS;
-		}
-		try {
-			TryRead();
-			TryWrite();
-		}
-		catch (const emException & exception) {
-			FailDocJobs(exception.GetText());
-			goto L_ENTER_QUIT_PROCESS;
+	proceeded=false;
+	n=Interpreters.GetCount();
+	maxCount=GetMaxInterpreters();
+	claimed.SetCount(n);
+	for (i=0; i<n; i++) claimed.Set(i,false);
+
+	JobQueue.UpdateSortingOfWaitingJobs();
+	for (job=JobQueue.GetFirstWaitingJob(); job; job=nextJob) {
+		nextJob=job->GetNext();
+		renderJob=CastJob(job);
+
+		readyIdx=-1;
+		startingIdx=-1;
+		offIdx=-1;
+		otherIdx=-1;
+		for (i=0; i<n; i++) {
+			if (claimed[i]) continue;
+			ip=Interpreters[i];
+			switch (ip->GetState()) {
+			case Interpreter::IS_READY:
+				if (ip->GetDocument()==renderJob->Document) {
+					if (readyIdx<0) readyIdx=i;
+				}
+				else {
+					if (otherIdx<0) otherIdx=i;
+				}
+				break;
+			case Interpreter::IS_STARTING:
+				if (
+					startingIdx<0 &&
+					ip->GetDocument()==renderJob->Document
+				) startingIdx=i;
+				break;
+			case Interpreter::IS_OFF:
+				if (offIdx<0 && i<maxCount) offIdx=i;
+				break;
+			default:
+				break;
+			}
 		}
-		if (IsReadingFinished()) goto L_ENTER_RUN_JOB;
-		if (!Timer.IsRunning()) {
-			FailDocJobs("PostScript interpretation failed: Start-up timed out.");
-			goto L_ENTER_QUIT_PROCESS;
+		if (offIdx<0 && n<maxCount) {
+			Interpreters.Add(new Interpreter(*this));
+			claimed.Add(false);
+			offIdx=n;
+			n++;
 		}
-		busy=true;
-		break;
 
-L_ENTER_RUN_JOB:
-		if (CurrentDocument.GetDataRefCount()<=1) goto L_ENTER_QUIT_PROCESS;
-		job=SearchBestSameDocJob();
-		if (!job) goto L_ENTER_QUIT_PROCESS;
-		JobQueue.StartJob(*job);
-		CurrentJob=job;
-		CurrentPageIndex=CurrentJob->PageIndex;
-		PSPriorityValid=false;
-		WakeUp();
-		PrepareWritingPage();
-		PrepareReadingPage();
-		Timer.Start(8000);
-		MainState=RUN_JOB;
-	case RUN_JOB:
-		if (!Process.IsRunning()) {
-			FailDocJobs("PostScript interpretation failed: Interpreter exited.");
-			goto L_ENTER_QUIT_PROCESS;
+		if (readyIdx>=0) {
+			// An interpreter has the document loaded.
+			JobQueue.StartJob(*renderJob);
+			Interpreters[readyIdx]->Run(*renderJob);
+			claimed.Set(readyIdx,true);
+			proceeded=true;
 		}
-		if (!Timer.IsRunning()) {
-			FailDocJobs("PostScript interpretation failed: Page timed out.");
-			goto L_ENTER_QUIT_PROCESS;
+		else if (startingIdx>=0) {
+			// An interpreter is loading the document. Let the job wait
+			// for it.
+			claimed.Set(startingIdx,true);
 		}
-		for (;;) {
+		else if (offIdx>=0) {
 			try {
-				readProceeded=TryRead();
-				writeProceeded=TryWrite();
+				Interpreters[offIdx]->Start(renderJob->Document);
 			}
 			catch (const emException & exception) {
-				FailDocJobs(exception.GetText());
-				goto L_ENTER_QUIT_PROCESS;
-			}
-			if (IsReadingFinished()) {
-				if (CurrentJob) {
-					JobQueue.SucceedJob(*CurrentJob);
-					CurrentJob=NULL;
-				}
-				goto L_ENTER_HOT_WAIT_JOB;
-			}
-			if (IsTimeSliceAtEnd()) break;
-			if (!readProceeded && !writeProceeded) {
-				flags=emProcess::WF_WAIT_STDOUT;
-				if (!IsWritingFinished()) flags|=emProcess::WF_WAIT_STDIN;
-				Process.WaitPipes(flags,10);
+				FailWaitingJobs(exception.GetText());
+				return true;
 			}
+			claimed.Set(offIdx,true);
+			proceeded=true;
 		}
-		busy=true;
-		break;
+		else if (otherIdx>=0) {
+			// Free an interpreter which has another document loaded
+			// but is not needed by a job of higher priority.
+			Interpreters[otherIdx]->Quit();
+			claimed.Set(otherIdx,true);
+			proceeded=true;
+		}
+		else {
+			// All interpreters are busy or claimed.
+			break;
+		}
+	}
 
-L_ENTER_HOT_WAIT_JOB:
-		PSAgent.ReleaseAccess();
-		Timer.Start(3000);
-		MainState=HOT_WAIT_JOB;
-	case HOT_WAIT_JOB:
-		if (CurrentDocument.GetDataRefCount()<=1) goto L_ENTER_QUIT_PROCESS;
-		if (JobQueue.GetFirstWaitingJob()) goto L_ENTER_HOT_WAIT_ACCESS;
-		if (!Timer.IsRunning()) goto L_ENTER_QUIT_PROCESS;
-		busy=true;
-		break;
+	return proceeded;
+}
 
-L_ENTER_HOT_WAIT_ACCESS:
-		UpdatePSPriority();
-		PSAgent.RequestAccess();
-		MainState=HOT_WAIT_ACCESS;
-	case HOT_WAIT_ACCESS:
-		if (CurrentDocument.GetDataRefCount()<=1) goto L_ENTER_QUIT_PROCESS;
-		if (!JobQueue.GetFirstWaitingJob()) goto L_ENTER_QUIT_PROCESS;
-		if (PSAgent.HasAccess()) goto L_ENTER_RUN_JOB;
-		UpdatePSPriority();
-		busy=true;
-		break;
 
-L_ENTER_QUIT_PROCESS:
-		CurrentDocument.Clear();
-		PSAgent.ReleaseAccess();
-		Process.CloseWriting();
-		Process.CloseReading();
-		Process.SendTerminationSignal();
-		Timer.Start(10000);
-		MainState=QUIT_PROCESS;
-	case QUIT_PROCESS:
-		if (!Process.IsRunning()) goto L_ENTER_COLD_WAIT_JOB;
-		if (!Timer.IsRunning()) {
-			FailAllJobs(
-				"Failed to terminate PostScript interpreter after previous job."
-			);
-			Timer.Start(10000);
-		}
-		busy=true;
-		break;
+bool emPsRenderer::IsDocumentInUse(const emPsDocument & document) const
+{
+	unsigned n;
+	int i;
+
+	n=0;
+	for (i=Interpreters.GetCount()-1; i>=0; i--) {
+		if (
+			Interpreters[i]->GetState()!=Interpreter::IS_OFF &&
+			Interpreters[i]->GetDocument()==document
+		) n++;
 	}
-
-	return busy;
+	return document.GetDataRefCount()>n;
 }
 
 
-emPsRenderer::RenderJob * emPsRenderer::SearchBestJob()
+void emPsRenderer::FailDocJobs(
+	RenderJob * currentJob, const emPsDocument & document,
+	const emString & errorMessage
+)
 {
-	emJob * job, * bestJob;
+	emJob * job, * nextJob;
 	RenderJob * renderJob;
-	double bestPri;
-
-	bestJob=JobQueue.GetFirstWaitingJob();
-	if (bestJob) {
-		bestPri=bestJob->GetPriority();
-		for (job=bestJob->GetNext(); job; job=job->GetNext()) {
-			if (bestPri<job->GetPriority()) {
-				bestPri=job->GetPriority();
-				bestJob=job;
-			}
+
+	if (currentJob) JobQueue.FailJob(*currentJob,errorMessage);
+
+	for (job=JobQueue.GetFirstWaitingJob(); job; job=nextJob) {
+		nextJob=job->GetNext();
+		renderJob=CastJob(job);
+		if (renderJob->Document==document) {
+			JobQueue.FailJob(*renderJob,errorMessage);
 		}
 	}
-	renderJob=dynamic_cast<RenderJob*>(bestJob);
-	if (!renderJob) emFatalError("emPsRenderer: Illegal job class");
-	return renderJob;
 }
 
 
-emPsRenderer::RenderJob * emPsRenderer::SearchBestSameDocJob()
+void emPsRenderer::FailWaitingJobs(const emString & errorMessage)
 {
-	RenderJob * renderJob, * bestJob;
-	emJob * job;
-
-	bestJob=NULL;
-	for (job=JobQueue.GetFirstWaitingJob(); job; job=job->GetNext()) {
-		if (!bestJob || bestJob->GetPriority()<job->GetPriority()) {
-			renderJob=dynamic_cast<RenderJob*>(job);
-			if (!renderJob) emFatalError("emPsRenderer: Illegal job class");
-			if (CurrentDocument==renderJob->Document) {
-				bestJob=renderJob;
-			}
-		}
+	emJob * job, * nextJob;
+
+	for (job=JobQueue.GetFirstWaitingJob(); job; job=nextJob) {
+		nextJob=job->GetNext();
+		JobQueue.FailJob(*job,errorMessage);
 	}
-	return bestJob;
 }
 
 
-void emPsRenderer::FailDocJobs(emString errorMessage)
+emPsRenderer::RenderJob * emPsRenderer::CastJob(emJob * job)
 {
-	emJob * job, * nextJob;
 	RenderJob * renderJob;
 
-	if (CurrentJob) {
-		JobQueue.FailJob(*CurrentJob,errorMessage);
-		CurrentJob=NULL;
-	}
+	renderJob=dynamic_cast<RenderJob*>(job);
+	if (!renderJob) emFatalError("emPsRenderer: Illegal job class");
+	return renderJob;
+}
 
-	for (job=JobQueue.GetFirstWaitingJob(); job; job=nextJob) {
-		nextJob=job->GetNext();
-		renderJob=dynamic_cast<RenderJob*>(job);
-		if (!renderJob) emFatalError("emPsRenderer: Illegal job class");
-		if (renderJob->Document==CurrentDocument) {
-			JobQueue.FailJob(*renderJob,errorMessage);
-			PSPriorityValid=false;
-			WakeUp();
-		}
-	}
+
+int emPsRenderer::GetMaxInterpreters() const
+{
+	int n;
+
+	n=emMin(
+		emThread::GetHardwareThreadCount(),
+		CoreConfig->MaxRenderThreads.Get()
+	);
+	return emMax(n,1);
+}
+
+
+emPsRenderer::Interpreter::Interpreter(emPsRenderer & renderer)
+	: Renderer(renderer)
+{
+	State=IS_OFF;
+	Deadline=0;
+	CurrentJob=NULL;
+	CurrentPageIndex=0;
+	WriterState=WRITING_FINISHED;
+	WriterPos=0;
+	ReaderState=READING_FINISHED;
+	ReadBufferFill=0;
+	RdSyncSearchPos=0;
+}
+
+
+emPsRenderer::Interpreter::~Interpreter()
+{
+	Process.Terminate();
 }
 
 
-void emPsRenderer::FailAllJobs(emString errorMessage)
+void emPsRenderer::Interpreter::Start(const emPsDocument & document)
 {
-	if (JobQueue.GetFirstWaitingJob()) {
-		PSPriorityValid=false;
-		WakeUp();
+	CurrentDocument=document;
+	try {
+		TryStartProcess();
+	}
+	catch (const emException &) {
+		CurrentDocument.Clear();
+		throw;
 	}
-	JobQueue.FailAllJobs(errorMessage);
+	PrepareWritingStartup();
+	PrepareReadingStartup();
+	Deadline=emGetClockMS()+12000;
+	State=IS_STARTING;
+}
+
+
+void emPsRenderer::Interpreter::Run(RenderJob & job)
+{
+	CurrentJob=&job;
+	CurrentPageIndex=job.PageIndex;
+	PrepareWritingPage();
+	PrepareReadingPage();
+	Deadline=emGetClockMS()+8000;
+	State=IS_RUNNING;
+}
+
+
+void emPsRenderer::Interpreter::Quit()
+{
 	CurrentJob=NULL;
+	CurrentDocument.Clear();
+	Process.CloseWriting();
+	Process.CloseReading();
+	Process.SendTerminationSignal();
+	Deadline=emGetClockMS()+10000;
+	State=IS_QUITTING;
 }
 
 
-void emPsRenderer::UpdatePSPriority()
+bool emPsRenderer::Interpreter::TryProceed()
 {
-	RenderJob * job;
-	double pri;
-
-	if (!PSPriorityValid) {
-		job=SearchBestJob();
-		if (job) pri=job->GetPriority();
-		else pri=0.0;
-		PSAgent.SetAccessPriority(pri);
-		PSPriorityValid=true;
+	bool proceeded;
+
+	switch (State) {
+	case IS_STARTING:
+	case IS_RUNNING:
+		if (!Process.IsRunning()) {
+			Fail("PostScript interpretation failed: Interpreter exited.");
+			return true;
+		}
+		try {
+			proceeded=TryRead();
+			if (TryWrite()) proceeded=true;
+		}
+		catch (const emException & exception) {
+			Fail(exception.GetText());
+			return true;
+		}
+		if (IsReadingFinished()) {
+			if (CurrentJob) {
+				Renderer.JobQueue.SucceedJob(*CurrentJob);
+				CurrentJob=NULL;
+			}
+			Deadline=emGetClockMS()+3000;
+			State=IS_READY;
+			return true;
+		}
+		if (emGetClockMS()>=Deadline) {
+			if (State==IS_STARTING) {
+				Fail("PostScript interpretation failed: Start-up timed out.");
+			}
+			else {
+				Fail("PostScript interpretation failed: Page timed out.");
+			}
+			return true;
+		}
+		return proceeded;
+	case IS_READY:
+		if (
+			!Renderer.IsDocumentInUse(CurrentDocument) ||
+			emGetClockMS()>=Deadline
+		) {
+			Quit();
+			return true;
+		}
+		return false;
+	case IS_QUITTING:
+		if (!Process.IsRunning()) {
+			State=IS_OFF;
+			return true;
+		}
+		if (emGetClockMS()>=Deadline) {
+			Process.SendKillSignal();
+			Deadline=emGetClockMS()+10000;
+		}
+		return false;
+	default:
+		return false;
 	}
 }
 
 
-void emPsRenderer::TryStartProcess()
+void emPsRenderer::Interpreter::AddWaitPipes(
+	emArray<emProcess*> & processes, emArray<int> & waitFlags
+)
+{
+	int flags;
+
+	flags=emProcess::WF_WAIT_STDOUT;
+	if (!IsWritingFinished()) flags|=emProcess::WF_WAIT_STDIN;
+	processes.Add(&Process);
+	waitFlags.Add(flags);
+}
+
+
+void emPsRenderer::Interpreter::Fail(const emString & errorMessage)
+{
+	Renderer.FailDocJobs(CurrentJob,CurrentDocument,errorMessage);
+	CurrentJob=NULL;
+	Quit();
+}
+
+
+void emPsRenderer::Interpreter::TryStartProcess()
 {
 	emArray<emString> args;
 
@@ -370,7 +471,7 @@ void emPsRenderer::TryStartProcess()
 }
 
 
-void emPsRenderer::PrepareWritingStartup()
+void emPsRenderer::Interpreter::PrepareWritingStartup()
 {
 	WriterState=WRITING_STARTUP;
 	WriterPos=0;
@@ -378,7 +479,7 @@ void emPsRenderer::PrepareWritingStartup()
 }
 
 
-void emPsRenderer::PrepareWritingPage()
+void emPsRenderer::Interpreter::PrepareWritingPage()
 {
 	double rx,ry,rt;
 	int w,h,t;
@@ -407,7 +508,7 @@ void emPsRenderer::PrepareWritingPage()
 }
 
 
-bool emPsRenderer::TryWrite()
+bool emPsRenderer::Interpreter::TryWrite()
 {
 	const char * buf;
 	int len;
@@ -464,7 +565,7 @@ L_ENTER_WRITING_SYNC:
 }
 
 
-void emPsRenderer::PrepareReadingStartup()
+void emPsRenderer::Interpreter::PrepareReadingStartup()
 {
 	ReaderState=READING_SYNC;
 	ReadBufferFill=0;
@@ -472,7 +573,7 @@ void emPsRenderer::PrepareReadingStartup()
 }
 
 
-void emPsRenderer::PrepareReadingPage()
+void emPsRenderer::Interpreter::PrepareReadingPage()
 {
 	ReaderState=READING_IMAGE_HEADER;
 	ReadBufferFill=0;
@@ -480,7 +581,7 @@ void emPsRenderer::PrepareReadingPage()
 }
 
 
-bool emPsRenderer::TryRead()
+bool emPsRenderer::Interpreter::TryRead()
 {
 	int len,syncLen,eat,r;
 	bool syncFound;
@@ -609,7 +710,7 @@ L_ENTER_READING_SYNC:
 }
 
 
-int emPsRenderer::ParseImageHeader(const char * buf, int len)
+int emPsRenderer::Interpreter::ParseImageHeader(const char * buf, int len)
 {
 	int i,r;
 
@@ -648,7 +749,7 @@ int emPsRenderer::ParseImageHeader(const char * buf, int len)
 }
 
 
-int emPsRenderer::ParseImageDecimal(
+int emPsRenderer::Interpreter::ParseImageDecimal(
 	const char * buf, int len, int * pNumber
 )
 {
@@ -681,7 +782,7 @@ int emPsRenderer::ParseImageDecimal(
 }
 
 
-int emPsRenderer::ParseImageData(const char * buf, int len)
+int emPsRenderer::Interpreter::ParseImageData(const char * buf, int len)
 {
 	emImage * img;
 	int eat,w,d;
@@ -752,20 +853,6 @@ int emPsRenderer::ParseImageData(const char * buf, int len)
 }
 
 
-emPsRenderer::PSAgentClass::PSAgentClass(emPsRenderer & interpreter)
-	: emPriSchedAgent(interpreter.GetRootContext(),"cpu"),
-	Renderer(interpreter)
-
-{
-}
-
-
-void emPsRenderer::PSAgentClass::GotAccess()
-{
-	Renderer.WakeUp();
-}
-
-
 const char * const emPsRenderer::SyncString=
 	"SYNC823JVG73LS0GJ7B2TX2M49GZWK2D" // Just random
 ;
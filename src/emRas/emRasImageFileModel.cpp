@@ -59,9 +59,11 @@ void emRasImageFileModel::TryStartLoading()
 	L->NextY=0;
 	L->RowSize=0;
 	L->BufFill=0;
+	L->Reduction=1;
 	L->File=NULL;
 	L->ColMap=NULL;
 	L->PixBuf=NULL;
+	L->Row=NULL;
 
 	L->File=fopen(GetFilePath(),"rb");
 	if (!L->File) goto Err;
@@ -88,6 +90,7 @@ void emRasImageFileModel::TryStartLoading()
 		(L->ColMapSize<=0 || L->ColMapSize>(3<<L->Depth))
 	) goto Err;
 	L->RowSize=((L->Width*L->Depth+7)/8+1)&~1;
+	L->Reduction=CalcReduction(L->Width,L->Height,3,8);
 
 	return;
 Err:
@@ -109,7 +112,13 @@ bool emRasImageFileModel::TryContinueLoading()
 			L->Depth,
 			L->PixMapType==2 ? "RLE-compressed" : "uncompressed"
 		);
-		Image.Setup(L->Width,L->Height,3);
+		if (L->Reduction>1) {
+			Reducer.Setup(Image,L->Width,L->Height,3,L->Reduction);
+			L->Row=new unsigned char[L->Width*(size_t)3];
+		}
+		else {
+			Image.Setup(L->Width,L->Height,3);
+		}
 		Signal(ChangeSignal);
 		if (L->Depth<24) {
 			L->ColMap=new unsigned char[3<<L->Depth];
@@ -120,7 +129,8 @@ bool emRasImageFileModel::TryContinueLoading()
 		return false;
 	}
 
-	map=Image.GetWritableMap()+(L->NextY*(size_t)L->Width)*3;
+	if (L->Row) map=L->Row;
+	else map=Image.GetWritableMap()+(L->NextY*(size_t)L->Width)*3;
 
 	if (L->PixMapType==2) {
 		while (L->BufFill<L->RowSize) {
@@ -183,6 +193,8 @@ bool emRasImageFileModel::TryContinueLoading()
 	L->BufFill-=L->RowSize;
 	if (L->BufFill>0) memmove(L->PixBuf,L->PixBuf+L->RowSize,L->BufFill);
 
+	if (L->Row) Reducer.PutRow(Image,L->Row);
+
 	Signal(ChangeSignal);
 
 	if (ferror(L->File)) goto Err;
@@ -204,6 +216,7 @@ void emRasImageFileModel::QuitLoading()
 		if (L->PixBuf) delete [] L->PixBuf;
 		if (L->File) fclose(L->File);
 		if (L->ColMap) delete [] L->ColMap;
+		if (L->Row) delete [] L->Row;
 		delete L;
 		L=NULL;
 	}
@@ -230,7 +243,8 @@ void emRasImageFileModel::QuitSaving()
 emUInt64 emRasImageFileModel::CalcMemoryNeed()
 {
 	if (L) {
-		return ((emUInt64)L->Width)*L->Height*3;
+		return ((emUInt64)(L->Width+L->Reduction-1)/L->Reduction)*
+		       ((L->Height+L->Reduction-1)/L->Reduction)*3;
 	}
 	else {
 		return ((emUInt64)Image.GetWidth())*
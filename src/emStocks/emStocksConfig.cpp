@@ -114,6 +114,7 @@ emStocksConfig::emStocksConfig(emContext & context, const emString & name)
 	ApiScript(this,"ApiScript"),
 	ApiScriptInterpreter(this,"ApiScriptInterpreter","perl"),
 	ApiKey(this,"ApiKey"),
+	ConcurrentFetches(this,"ConcurrentFetches",4,1,16),
 	WebBrowser(this,"WebBrowser",
 #		if defined(_WIN32)
 			"C:\\Program Files (x86)\\Microsoft\\Edge\\Application\\msedge.exe"
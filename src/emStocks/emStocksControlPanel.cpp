@@ -36,6 +36,7 @@ emStocksControlPanel::emStocksControlPanel(
 	ApiScript(NULL),
 	ApiScriptInterpreter(NULL),
 	ApiKey(NULL),
+	ConcurrentFetches(NULL),
 	WebBrowser(NULL),
 	AutoUpdateDates(NULL),
 	TriggeringOpensWebPage(NULL),
@@ -114,6 +115,10 @@ bool emStocksControlPanel::Cycle()
 		Config->ApiKey=ApiKey->GetText();
 	}
 
+	if (IsSignaled(ConcurrentFetches->GetValueSignal())) {
+		Config->ConcurrentFetches=ConcurrentFetches->GetValue();
+	}
+
 	if (IsSignaled(AutoUpdateDates->GetCheckSignal())) {
 		Config->AutoUpdateDates=AutoUpdateDates->IsChecked();
 	}
@@ -325,6 +330,11 @@ void emStocksControlPanel::AutoExpand()
 		"  2022-12-16 22.77\n"
 		"  2022-12-19 24.14\n"
 		"\n"
+		"On failure, the API script must print an error message to stderr and exit with\n"
+		"a non-zero status. emStocks then tries it again a few times, unless the exit\n"
+		"status is 200, which means that trying again would not help (e.g. invalid API\n"
+		"key or HTTP status 4xx).\n"
+		"\n"
 		"3.) Now go to the emStocks Preferences (in the control panel) and enter the path\n"
 		"to the API script, the API script interpreter, and the API key. On Windows you\n"
 		"will probably have to install the interpreter (e.g. install Strawberry Perl for\n"
@@ -389,7 +399,10 @@ void emStocksControlPanel::AutoExpand()
 		"\n"
 		"  2022-12-15 23.45\n"
 		"  2022-12-16 22.77\n"
-		"  2022-12-19 24.14"
+		"  2022-12-19 24.14\n"
+		"\n"
+		"On failure, the API script must print an error message to stderr and exit with a non-zero status. It\n"
+		"is tried again a few times, unless the exit status is 200, which means that trying again would not help."
 	);
 
 	ApiScriptInterpreter=new FileFieldPanel(
@@ -412,6 +425,18 @@ void emStocksControlPanel::AutoExpand()
 	ApiKey->SetEditable();
 	AddWakeUpSignal(ApiKey->GetTextSignal());
 
+	ConcurrentFetches=new emScalarField(
+		prefs1,"ConcurrentFetches","Concurrent Fetches",
+		"Maximum number of API script processes to be run at the same\n"
+		"time when fetching the prices of multiple stocks."
+	);
+	ConcurrentFetches->SetEditable();
+	ConcurrentFetches->SetMinMaxValues(
+		Config->ConcurrentFetches.GetMinValue(),
+		Config->ConcurrentFetches.GetMaxValue()
+	);
+	AddWakeUpSignal(ConcurrentFetches->GetValueSignal());
+
 	WebBrowser=new FileFieldPanel(
 		prefs1,"WebBrowser",*this,FT_BROWSER,"Web Browser",
 		"Executable of the preferred web browser"
@@ -781,6 +806,7 @@ void emStocksControlPanel::AutoShrink()
 	ApiScript=NULL;
 	ApiScriptInterpreter=NULL;
 	ApiKey=NULL;
+	ConcurrentFetches=NULL;
 	WebBrowser=NULL;
 	AutoUpdateDates=NULL;
 	TriggeringOpensWebPage=NULL;
@@ -832,6 +858,8 @@ void emStocksControlPanel::UpdateControls()
 
 	ApiKey->SetText(Config->ApiKey);
 
+	ConcurrentFetches->SetValue(Config->ConcurrentFetches);
+
 	AutoUpdateDates->SetChecked(Config->AutoUpdateDates);
 
 	TriggeringOpensWebPage->SetChecked(Config->TriggeringOpensWebPage);
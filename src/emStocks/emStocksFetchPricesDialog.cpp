@@ -24,10 +24,10 @@
 emStocksFetchPricesDialog::emStocksFetchPricesDialog(
 	emContext & parentContext, emStocksFileModel & fileModel,
 	const emString & apiScript, const emString & apiScriptInterpreter,
-	const emString & apiKey
+	const emString & apiKey, int maxProcesses
 )
 	: emDialog(parentContext),
-	Fetcher(fileModel,apiScript,apiScriptInterpreter,apiKey)
+	Fetcher(fileModel,apiScript,apiScriptInterpreter,apiKey,maxProcesses)
 {
 	double minW,minH,w,h;
 	emContext * context;
@@ -37,6 +37,12 @@ emStocksItemChart::emStocksItemChart(
 	DaysPerPrice(1),
 	OwningShares(false),
 	TradeOffsetDays(INT_MIN),
+	PyramidUpToDate(false),
+	PricesLevel(-1),
+	PricesBegin(0),
+	PricesEnd(0),
+	PricesStartDay(0),
+	PricesEndDay(0),
 	XOffset(0.0),
 	XFactor(1.0),
 	YOffset(0.0),
@@ -49,7 +55,6 @@ emStocksItemChart::emStocksItemChart(
 	TradePrice.Valid=false;
 	PriceOnSelectedDate.Valid=false;
 	DesiredPrice.Valid=false;
-	Prices.SetTuningLevel(4);
 	MinPrice.Valid=false;
 	MaxPrice.Valid=false;
 
@@ -78,6 +83,7 @@ void emStocksItemChart::SetStockRec(
 {
 	if (GetStockRec()!=stockRec) {
 		SetListenedRec(stockRec);
+		PyramidUpToDate=false;
 		InvalidateData();
 	}
 }
@@ -142,6 +148,7 @@ void emStocksItemChart::PaintContent(
 
 void emStocksItemChart::OnRecChanged()
 {
+	PyramidUpToDate=false;
 	InvalidateData();
 }
 
@@ -275,103 +282,151 @@ void emStocksItemChart::UpdatePrices1()
 void emStocksItemChart::UpdatePrices2()
 {
 	const emStocksRec::StockRec * stockRec;
-	const char * s1, * s2;
-	Price * t1, * t2;
-	double sv,tv,minv,maxv;
-	int diffDays,remainingDays,n;
+	Bucket b;
+	int n,l,i1,i2;
+
+	PricesLevel=-1;
+	PricesBegin=0;
+	PricesEnd=0;
 
 	stockRec=GetStockRec();
 	if (
 		!stockRec || !IsViewed() ||
-		stockRec->Prices.Get().IsEmpty() ||
+		stockRec->Prices.GetCount()<=0 ||
 		stockRec->LastPriceDate.Get().IsEmpty()
 	) {
-		Prices.Clear(true);
+		Pyramid.Clear(true);
+		PyramidUpToDate=false;
 		return;
 	}
 
-	s1=stockRec->Prices.Get().Get();
-	s2=s1+strlen(s1);
-
-	Prices.SetCount((TotalDays+DaysPerPrice-1)/DaysPerPrice,true);
-	t1=Prices.GetWritable();
-	t2=t1+Prices.GetCount();
-	memset(t1,0,(char*)t2-(char*)t1);
+	UpdatePyramid();
 
-	remainingDays=(TotalDays-1)%DaysPerPrice+1;
-
-	diffDays=emStocksFileModel::GetDateDifference(
+	n=Pyramid[0].GetCount();
+	PricesStartDay=n-1+emStocksFileModel::GetDateDifference(
 		stockRec->LastPriceDate.Get(),
-		EndDate
+		StartDate
 	);
-	diffDays--;
-	if (diffDays<0) {
-		while (s1<s2) {
-			s2--;
-			if (*s2=='|') {
-				diffDays++;
-				if (diffDays>=0) break;
-			}
+	PricesEndDay=PricesStartDay+TotalDays;
+	i1=emMax(PricesStartDay,0);
+	i2=emMin(PricesEndDay,n);
+	if (i1>=i2) return;
+
+	for (l=0; l<Pyramid.GetCount()-1 && (2<<l)<=DaysPerPrice; l++);
+	PricesLevel=l;
+	PricesBegin=i1>>l;
+	PricesEnd=((i2-1)>>l)+1;
+	CombineBuckets(i1,emMin((PricesBegin+1)<<l,i2),EdgeBuckets);
+	CombineBuckets(emMax((PricesEnd-1)<<l,i1),i2,EdgeBuckets+1);
+
+	CombineBuckets(i1,i2,&b);
+	if (b.Count) {
+		if (!MinPrice || MinPrice.Value>b.Min) {
+			MinPrice.Valid=true;
+			MinPrice.Value=b.Min;
 		}
-	}
-	else if (diffDays>0) {
-		t2-=diffDays/DaysPerPrice;
-		remainingDays-=diffDays%DaysPerPrice;
-		if (remainingDays<=0) {
-			t2--;
-			remainingDays+=DaysPerPrice;
+		if (!MaxPrice || MaxPrice.Value<b.Max) {
+			MaxPrice.Valid=true;
+			MaxPrice.Value=b.Max;
 		}
 	}
+}
 
-	if (s1>=s2 || t1>=t2) return;
 
-	minv=1E100;
-	maxv=-1E100;
-	tv=0.0;
-	n=0;
-	do {
-		s2--;
-		if (*s2!='|') {
-			do { s2--; } while (s1<=s2 && *s2!='|');
-			sv=atof(s2+1);
-			tv+=sv;
-			n++;
-			if (minv>sv) minv=sv;
-			if (maxv<sv) maxv=sv;
+void emStocksItemChart::UpdatePyramid()
+{
+	const emStocksRec::StockRec * stockRec;
+	const emStocksRec::PricesRec * prices;
+	const Bucket * s, * e;
+	Bucket * t;
+	int i,n;
+
+	if (PyramidUpToDate) return;
+	PyramidUpToDate=true;
+
+	Pyramid.Clear(true);
+	stockRec=GetStockRec();
+	if (!stockRec) return;
+	prices=&stockRec->Prices;
+	n=prices->GetCount();
+	if (n<=0) return;
+
+	Pyramid.SetCount(1);
+	Pyramid.GetWritable(0).SetCount(n,true);
+	t=Pyramid.GetWritable(0).GetWritable();
+	for (i=0; i<n; i++, t++) {
+		if (prices->IsKnown(i)) {
+			t->Avg=prices->GetValue(i);
+			t->Min=t->Max=t->Avg;
+			t->Count=1;
 		}
-		remainingDays--;
-		if (remainingDays<=0) {
-			t2--;
-			if (n>0) {
-				t2->Valid=true;
-				t2->Value=tv/n;
-			}
-			if (t1>=t2) break;
-			remainingDays=DaysPerPrice;
-			tv=0.0;
-			n=0;
+		else {
+			t->Avg=0.0;
+			t->Min=t->Max=0.0;
+			t->Count=0;
 		}
-	} while (s1<s2);
-
-	if (t1<t2 && n>0) {
-		t2--;
-		t2->Valid=true;
-		t2->Value=tv/n;
 	}
 
-	if (minv<=maxv) {
-		if (!MinPrice || MinPrice.Value>minv) {
-			MinPrice.Valid=true;
-			MinPrice.Value=minv;
-		}
-		if (!MaxPrice || MaxPrice.Value<maxv) {
-			MaxPrice.Valid=true;
-			MaxPrice.Value=maxv;
+	while (n>1) {
+		Pyramid.AddNew();
+		Pyramid.GetWritable(Pyramid.GetCount()-1).SetCount((n+1)/2,true);
+		t=Pyramid.GetWritable(Pyramid.GetCount()-1).GetWritable();
+		s=Pyramid[Pyramid.GetCount()-2].Get();
+		for (e=s+n; s<e; s+=2, t++) {
+			*t=s[0];
+			if (s+1<e) MergeBucket(t,s[1]);
 		}
+		n=(n+1)/2;
+	}
+}
+
+
+void emStocksItemChart::MergeBucket(Bucket * target, const Bucket & source)
+{
+	if (!source.Count) return;
+	if (!target->Count) {
+		*target=source;
+		return;
+	}
+	target->Min=emMin(target->Min,source.Min);
+	target->Max=emMax(target->Max,source.Max);
+	target->Avg=(
+		target->Avg*target->Count+source.Avg*source.Count
+	)/(target->Count+source.Count);
+	target->Count+=source.Count;
+}
+
+
+void emStocksItemChart::CombineBuckets(
+	int begin, int end, Bucket * pResult
+) const
+{
+	const Bucket * b;
+	int l;
+
+	pResult->Avg=0.0;
+	pResult->Min=0.0;
+	pResult->Max=0.0;
+	pResult->Count=0;
+
+	// Combine the fewest buckets covering the range, by going up the
+	// levels.
+	for (l=0; begin<end; begin>>=1, end>>=1, l++) {
+		b=Pyramid[l].Get();
+		if (begin&1) MergeBucket(pResult,b[begin++]);
+		if (end&1) MergeBucket(pResult,b[--end]);
 	}
 }
 
 
+const emStocksItemChart::Bucket & emStocksItemChart::GetBucket(int index) const
+{
+	if (index==PricesBegin) return EdgeBuckets[0];
+	if (index==PricesEnd-1) return EdgeBuckets[1];
+	return Pyramid[PricesLevel][index];
+}
+
+
 void emStocksItemChart::UpdateTransformation()
 {
 	double x,y,w,h,c,d,p1,p2;
@@ -893,44 +948,57 @@ void emStocksItemChart::PaintDesiredPrice(const emPainter & painter) const
 void emStocksItemChart::PaintGraph(const emPainter & painter) const
 {
 	char tmp[64];
-	double xOff,xFac,x1,y1,x2,y2,thickness,f,r;
+	const Bucket * b;
+	double x1,y1,x2,y2,thickness,f,r;
 	int i0,i1,i2,i3,i,n,year,month,mday,day;
 	bool havePoints,haveTexts;
-	emColor c1,c2;
+	emColor c1,c2,c3;
 
-	if (Prices.GetCount()<2) return;
+	if (PricesLevel<0 || PricesBegin>=PricesEnd) return;
 
-	xOff=XOffset+XFactor*0.5;
-	xFac=XFactor*(TotalDays-1)/(Prices.GetCount()-1);
-
-	f=(painter.GetUserClipX1()-xOff)/xFac-0.5;
-	if (f>=Prices.GetCount()) return;
-	if (f<1.0) i1=0; else i1=(int)f;
-	f=(painter.GetUserClipX2()-xOff)/xFac+0.5;
-	if (f<=0.0) return;
-	if (f>Prices.GetCount()-2) i2=Prices.GetCount()-1; else i2=(int)ceil(f);
-	if (i1>=i2) return;
+	f=(painter.GetUserClipX1()-XOffset)/XFactor+PricesStartDay;
+	if (f>=PricesEnd<<PricesLevel) return;
+	i1=PricesBegin;
+	if (f>i1<<PricesLevel) i1=emMax(((int)f>>PricesLevel)-1,i1);
+	f=(painter.GetUserClipX2()-XOffset)/XFactor+PricesStartDay;
+	if (f<=PricesBegin<<PricesLevel) return;
+	i2=PricesEnd-1;
+	if (f<i2<<PricesLevel) i2=emMin(((int)f>>PricesLevel)+1,i2);
+	if (i1>i2) return;
 
 	thickness=emMax(
 		ViewToPanelDeltaY(1.5),
 		emMin((LowerPrice-UpperPrice)*YFactor*0.002,XFactor*0.1)
 	);
 	r=emMin(0.002,XFactor*0.1)*3.0;
-	havePoints=(DaysPerPrice==1 && r>ViewToPanelDeltaY(1.2));
+	havePoints=(PricesLevel==0 && r>ViewToPanelDeltaY(1.2));
 	haveTexts=(havePoints && r>ViewToPanelDeltaY(5.0));
 
 	c1=emColor(255,255,255);
 	c2=emColor(64,64,64);
+	c3=emColor(255,255,255,64);
+
+	if (PricesLevel>0) {
+		for (i=i1; i<=i2; i++) {
+			b=&GetBucket(i);
+			if (!b->Count || b->Max<=b->Min) continue;
+			x1=GetBucketX1(i);
+			x2=GetBucketX2(i);
+			y1=YOffset+YFactor*b->Max;
+			y2=YOffset+YFactor*b->Min;
+			painter.PaintRect(x1,y1,x2-x1,y2-y1,c3);
+		}
+	}
 
-	for (i0=i1; i0>0 && !Prices[i0].Valid; i0--);
-	for (i3=i2; i3<Prices.GetCount()-1 && !Prices[i3].Valid; i3++);
+	for (i0=i1; i0>PricesBegin && !GetBucket(i0).Count; i0--);
+	for (i3=i2; i3<PricesEnd-1 && !GetBucket(i3).Count; i3++);
 	x1=0.0;
 	y1=0.0;
 	n=0;
 	for (i=i0; i<=i3; i++) {
-		if (!Prices[i].Valid) continue;
-		x2=xOff+xFac*i;
-		y2=YOffset+YFactor*Prices[i].Value;
+		if (!GetBucket(i).Count) continue;
+		x2=(GetBucketX1(i)+GetBucketX2(i))*0.5;
+		y2=YOffset+YFactor*GetBucket(i).Avg;
 		if (n) {
 			painter.PaintLine(
 				x1,y1,x2,y2,thickness,
@@ -947,9 +1015,9 @@ void emStocksItemChart::PaintGraph(const emPainter & painter) const
 	if (!havePoints) return;
 
 	for (i=i1; i<=i2; i++) {
-		if (!Prices[i].Valid) continue;
-		x1=xOff+xFac*i;
-		y1=YOffset+YFactor*Prices[i].Value;
+		if (!GetBucket(i).Count) continue;
+		x1=(GetBucketX1(i)+GetBucketX2(i))*0.5;
+		y1=YOffset+YFactor*GetBucket(i).Avg;
 		painter.PaintEllipse(x1-r,y1-r,r*2,r*2,c1);
 	}
 
@@ -958,11 +1026,11 @@ void emStocksItemChart::PaintGraph(const emPainter & painter) const
 	year=StartYear;
 	month=StartMonth;
 	mday=StartDay;
-	day=0;
+	day=PricesStartDay;
 	for (i=i1; i<=i2; i++) {
-		if (!Prices[i].Valid) continue;
-		x1=xOff+xFac*i;
-		y1=YOffset+YFactor*Prices[i].Value;
+		if (!GetBucket(i).Count) continue;
+		x1=(GetBucketX1(i)+GetBucketX2(i))*0.5;
+		y1=YOffset+YFactor*GetBucket(i).Avg;
 		emStocksFileModel::AddDaysToDate(i-day,&year,&month,&mday);
 		day=i;
 		snprintf(tmp,sizeof(tmp),"%04d-%02d-%02d",year,month,mday);
@@ -972,7 +1040,7 @@ void emStocksItemChart::PaintGraph(const emPainter & painter) const
 			EM_ALIGN_CENTER,EM_ALIGN_CENTER
 		);
 		emStocksFileModel::SharePriceToString(
-			Prices[i].Value,tmp,sizeof(tmp)
+			GetBucket(i).Avg,tmp,sizeof(tmp)
 		);
 		painter.PaintTextBoxed(
 			x1-r*0.8,y1-r*0.2,r*0.8*2,r*0.9,tmp,r,c2,0,
@@ -982,6 +1050,25 @@ void emStocksItemChart::PaintGraph(const emPainter & painter) const
 }
 
 
+double emStocksItemChart::GetBucketX1(int index) const
+{
+	return XOffset+XFactor*(
+		emMax(index<<PricesLevel,PricesStartDay)-PricesStartDay
+	);
+}
+
+
+double emStocksItemChart::GetBucketX2(int index) const
+{
+	return XOffset+XFactor*(
+		emMin(
+			(index+1)<<PricesLevel,
+			emMin(PricesEndDay,Pyramid[0].GetCount())
+		)-PricesStartDay
+	);
+}
+
+
 void emStocksItemChart::Price::Set(const char * str)
 {
 	const char * p;
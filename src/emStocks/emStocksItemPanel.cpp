@@ -133,7 +133,7 @@ bool emStocksItemPanel::Cycle()
 	if (IsSignaled(Symbol->GetTextSignal())) {
 		if (stockRec->Symbol.Get()!=Symbol->GetText()) {
 			stockRec->Symbol=Symbol->GetText();
-			stockRec->Prices=emString();
+			stockRec->Prices.Clear();
 			stockRec->LastPriceDate=emString();
 		}
 	}
@@ -30,6 +30,8 @@ emStocksListBox::emStocksListBox(
 	: emListBox(parent,name),
 	FileModel(fileModel),
 	Config(config),
+	SortKeysValid(false),
+	VisibleCount(0),
 	InterestToSet(emStocksFileModel::MEDIUM_INTEREST)
 {
 	emLook look;
@@ -100,6 +102,7 @@ void emStocksListBox::SetSelectedDate(const emString & selectedDate)
 	if (SelectedDate!=selectedDate) {
 		SelectedDate=selectedDate;
 		Signal(SelectedDateSignal);
+		SortKeysValid=false;
 		UpdateItems();
 	}
 }
@@ -146,6 +149,7 @@ void emStocksListBox::NewStock()
 		stockRec->Collection.Set(Config.VisibleCollections[0].Get());
 	}
 
+	SortKeysValid=false;
 	UpdateItems();
 	j=GetItemIndexByStock(stockRec);
 	SetSelectedIndex(j);
@@ -301,6 +305,7 @@ void emStocksListBox::PasteStocks(bool ask)
 		}
 	}
 
+	SortKeysValid=false;
 	UpdateItems();
 	ClearSelection();
 	for (i=n; i<n+m; i++) {
@@ -392,7 +397,8 @@ void emStocksListBox::StartToFetchSharePrices(
 	if (!FileModel.PricesFetchingDialog) {
 		FileModel.PricesFetchingDialog=new emStocksFetchPricesDialog(
 			GetView(),FileModel,Config.ApiScript,
-			Config.ApiScriptInterpreter,Config.ApiKey
+			Config.ApiScriptInterpreter,Config.ApiKey,
+			Config.ConcurrentFetches
 		);
 	}
 	else {
@@ -416,7 +422,7 @@ void emStocksListBox::DeleteSharePrices()
 	for (i=0; i<GetItemCount(); i++) {
 		stockRec=GetStockByItemIndex(i);
 		if (!stockRec) continue;
-		stockRec->Prices.Set("");
+		stockRec->Prices.Clear();
 		stockRec->LastPriceDate.Set("");
 	}
 }
@@ -633,10 +639,12 @@ bool emStocksListBox::Cycle()
 	busy=emListBox::Cycle();
 
 	if (IsSignaled(FileModel.GetChangeSignal())) {
+		SortKeysValid=false;
 		UpdateItems();
 	}
 
 	if (IsSignaled(Config.GetChangeSignal())) {
+		SortKeysValid=false;
 		UpdateItems();
 	}
 
@@ -708,23 +716,34 @@ void emStocksListBox::CreateItemPanel(const emString & name, int itemIndex)
 void emStocksListBox::UpdateItems()
 {
 	emStocksRec::StockRec * stockRec;
-	int i,oldCount,visibleCount;
+	SortKey * key;
+	int i,oldCount,foundCount;
+
+	UpdateSortKeys();
 
 	oldCount=GetItemCount();
 
-	for (i=0; i<GetItemCount(); ) {
-		stockRec = GetStockByItemIndex(i);
-		if (stockRec && IsVisibleStock(*stockRec)) i++;
-		else RemoveItem(i);
+	for (foundCount=0, i=0; i<SortKeys.GetCount(); i++) {
+		key=&SortKeys.GetWritable(i);
+		if (key->Visible) {
+			key->ItemIndex=GetItemIndexOfKey(*key);
+			if (key->ItemIndex>=0) foundCount++;
+		}
 	}
 
-	for (visibleCount=0, i=0; i<FileModel.Stocks.GetCount(); i++) {
-		if (IsVisibleStock(FileModel.Stocks[i])) visibleCount++;
+	if (foundCount<GetItemCount()) {
+		for (i=0; i<GetItemCount(); ) {
+			key=GetSortKey(GetStockByItemIndex(i));
+			if (key && key->Visible) i++;
+			else RemoveItem(i);
+		}
 	}
-	if (visibleCount>GetItemCount()) {
-		for (i=0; i<FileModel.Stocks.GetCount(); i++) {
-			stockRec=&FileModel.Stocks[i];
-			if (IsVisibleStock(*stockRec) && GetItemIndex(stockRec->Id.Get())<0) {
+
+	if (VisibleCount>GetItemCount()) {
+		for (i=0; i<SortKeys.GetCount(); i++) {
+			key=&SortKeys.GetWritable(i);
+			if (key->Visible && GetItemIndex(key->Stock->Id.Get())<0) {
+				stockRec=&FileModel.Stocks[i];
 				AddItem(
 					stockRec->Id.Get(),
 					stockRec->Name.Get(),
@@ -736,110 +755,296 @@ void emStocksListBox::UpdateItems()
 		}
 	}
 
-	SortItems(CompareItems,this);
+	OrderItems();
 
 	if (oldCount!=GetItemCount()) InvalidatePainting();
 }
 
 
-int emStocksListBox::CompareItems(
-	const emString &, const emString &, const emAnything & item1data,
-	const emString &, const emString &, const emAnything & item2data,
-	void * context
+void emStocksListBox::OrderItems()
+{
+	emArray<SortKey*> order;
+	emArray<int> ranks,tails,prevs;
+	emArray<bool> inPlace;
+	SortKey * key;
+	int i,j,k,l,n,c,p,moves;
+
+	n=GetItemCount();
+	if (n<1) return;
+
+	order.SetTuningLevel(4);
+	for (i=0; i<SortKeys.GetCount(); i++) {
+		key=&SortKeys.GetWritable(i);
+		if (key->Visible) order.Add(key);
+	}
+	if (order.GetCount()!=n) {
+		SortItems(CompareItems,this);
+		return;
+	}
+	emSortArray(order.GetWritable(),n,CompareSortKeys,this);
+
+	ranks.SetTuningLevel(4);
+	ranks.SetCount(n,true);
+	for (i=0; i<n; i++) {
+		c=GetItemIndexOfKey(*order[i]);
+		if (c<0) {
+			SortItems(CompareItems,this);
+			return;
+		}
+		ranks.Set(c,i);
+	}
+
+	// Find a longest subsequence of items which are already in the right
+	// order. All other items have to be moved.
+	tails.SetTuningLevel(4);
+	prevs.SetTuningLevel(4);
+	prevs.SetCount(n,true);
+	for (i=0; i<n; i++) {
+		j=0;
+		k=tails.GetCount();
+		while (j<k) {
+			l=(j+k)/2;
+			if (ranks[tails[l]]<ranks[i]) j=l+1; else k=l;
+		}
+		prevs.Set(i,j>0?tails[j-1]:-1);
+		if (j<tails.GetCount()) tails.Set(j,i); else tails.Add(i);
+	}
+	moves=n-tails.GetCount();
+
+	if (moves>MAX_ITEM_MOVES) {
+		SortItems(CompareItems,this);
+	}
+	else if (moves>0) {
+		inPlace.SetTuningLevel(4);
+		inPlace.SetCount(n,true);
+		for (i=0; i<n; i++) inPlace.Set(i,false);
+		for (i=tails[tails.GetCount()-1]; i>=0; i=prevs[i]) {
+			inPlace.Set(ranks[i],true);
+		}
+		// Move each other item behind its predecessor in the right
+		// order, with increasing rank, so that the predecessor is
+		// always in place already.
+		for (i=0; i<n; i++) {
+			if (inPlace[i]) continue;
+			c=GetItemIndexByStock(order[i]->Stock);
+			p=i>0?GetItemIndexByStock(order[i-1]->Stock):-1;
+			MoveItem(c,c<p?p:p+1);
+			inPlace.Set(i,true);
+		}
+	}
+
+	for (i=0; i<n; i++) order[i]->ItemIndex=i;
+}
+
+
+int emStocksListBox::GetItemIndexOfKey(const SortKey & key) const
+{
+	int i;
+
+	i=key.ItemIndex;
+	if (i<0 || i>=GetItemCount() || GetStockByItemIndex(i)!=key.Stock) {
+		i=GetItemIndex(key.Stock->Id.Get());
+		if (i>=0 && GetStockByItemIndex(i)!=key.Stock) i=-1;
+	}
+	return i;
+}
+
+
+void emStocksListBox::UpdateSortKeys()
+{
+	emArray<SortKey> oldKeys;
+	const emStocksRec::StockRec * stockRec;
+	const SortKey * oldKey;
+	SortKey * key;
+	const char * name;
+	int i,n,sorting,y,m,d;
+	size_t len;
+
+	if (SortKeysValid) return;
+
+	oldKeys=SortKeys;
+	n=FileModel.Stocks.GetCount();
+	SortKeys.Clear(true);
+	SortKeys.SetCount(n,true);
+	sorting=Config.Sorting.Get();
+	VisibleCount=0;
+
+	for (i=0; i<n; i++) {
+		stockRec=&FileModel.Stocks[i];
+		oldKey=NULL;
+		if (i<oldKeys.GetCount() && oldKeys[i].Stock==stockRec) {
+			oldKey=&oldKeys[i];
+		}
+		key=&SortKeys.GetWritable(i);
+		key->Stock=stockRec;
+		key->ItemIndex=oldKey?oldKey->ItemIndex:-1;
+		key->Visible=IsVisibleStock(*stockRec);
+		key->Owning=stockRec->OwningShares.Get();
+		key->Valid=false;
+		key->Value=0.0;
+		if (!key->Visible) continue;
+		VisibleCount++;
+
+		switch (sorting) {
+			case emStocksConfig::SORT_BY_TRADE_DATE:
+				emStocksRec::ParseDate(stockRec->TradeDate.Get(),&y,&m,&d);
+				key->Value=(y*16.0+m)*32.0+d;
+				key->Valid=true;
+				break;
+			case emStocksConfig::SORT_BY_INQUIRY_DATE:
+				emStocksRec::ParseDate(stockRec->InquiryDate.Get(),&y,&m,&d);
+				key->Value=(y*16.0+m)*32.0+d;
+				key->Valid=true;
+				break;
+			case emStocksConfig::SORT_BY_ACHIEVEMENT:
+				key->Valid=stockRec->GetAchievementOfDate(&key->Value,SelectedDate);
+				break;
+			case emStocksConfig::SORT_BY_ONE_WEEK_RISE:
+				key->Valid=stockRec->GetRiseUntilDate(&key->Value,SelectedDate,7);
+				break;
+			case emStocksConfig::SORT_BY_THREE_WEEK_RISE:
+				key->Valid=stockRec->GetRiseUntilDate(&key->Value,SelectedDate,7*3);
+				break;
+			case emStocksConfig::SORT_BY_NINE_WEEK_RISE:
+				key->Valid=stockRec->GetRiseUntilDate(&key->Value,SelectedDate,7*9);
+				break;
+			case emStocksConfig::SORT_BY_DIVIDEND:
+				key->Valid=!stockRec->ExpectedDividend.Get().IsEmpty();
+				if (key->Valid) key->Value=atof(stockRec->ExpectedDividend.Get().Get());
+				break;
+			case emStocksConfig::SORT_BY_PURCHASE_VALUE:
+				key->Valid=stockRec->GetTradeValue(&key->Value);
+				break;
+			case emStocksConfig::SORT_BY_VALUE:
+				key->Valid=stockRec->GetValueOfDate(&key->Value,SelectedDate);
+				break;
+			case emStocksConfig::SORT_BY_DIFFERENCE:
+				key->Valid=stockRec->GetDifferenceValueOfDate(&key->Value,SelectedDate);
+				break;
+			default:
+				break;
+		}
+		if (!key->Valid) key->Value=0.0;
+
+		// emString is shared on copy, so an unmodified name has still
+		// the same buffer.
+		key->Name=stockRec->Name.Get();
+		if (oldKey && oldKey->Name.Get()==key->Name.Get()) {
+			key->NameKey=oldKey->NameKey;
+		}
+		else {
+			name=key->Name.Get();
+			len=strxfrm(NULL,name,0);
+			if (len<0x10000000) {
+				strxfrm(key->NameKey.SetLenGetWritable((int)len),name,len+1);
+			}
+		}
+	}
+
+	SortKeysByStock.SetTuningLevel(4);
+	SortKeysByStock.SetCount(n,true);
+	for (i=0; i<n; i++) SortKeysByStock.Set(i,i);
+	SortKeysByStock.Sort(CompareSortKeysByStock,this);
+
+	SortKeysValid=true;
+}
+
+
+emStocksListBox::SortKey * emStocksListBox::GetSortKey(
+	const emStocksRec::StockRec * stockRec
+)
+{
+	int i;
+
+	if (!stockRec) return NULL;
+	i=SortKeysByStock.BinarySearchByKey(
+		(void*)stockRec,CompareSortKeyToStock,this
+	);
+	return i>=0 ? &SortKeys.GetWritable(SortKeysByStock[i]) : NULL;
+}
+
+
+int emStocksListBox::CompareSortKeysByStock(
+	const int * index1, const int * index2, void * context
 )
 {
-	const emCrossPtr<emStocksRec::StockRec> * crossPtr;
 	const emStocksRec::StockRec * s1, * s2;
 	emStocksListBox * lb;
-	double f,f1,f2;
-	int d,i1,i2;
-	bool b1,b2;
 
 	lb=(emStocksListBox*)context;
+	s1=lb->SortKeys[*index1].Stock;
+	s2=lb->SortKeys[*index2].Stock;
+	return s1<s2 ? -1 : s1>s2 ? 1 : 0;
+}
 
-	crossPtr=emCastAnything<emCrossPtr<emStocksRec::StockRec>>(item1data);
-	if (!crossPtr) return 1;
-	s1=*crossPtr;
 
-	crossPtr=emCastAnything<emCrossPtr<emStocksRec::StockRec>>(item2data);
-	if (!crossPtr) return -1;
-	s2=*crossPtr;
+int emStocksListBox::CompareSortKeyToStock(
+	const int * index, void * stockRec, void * context
+)
+{
+	const emStocksRec::StockRec * s1, * s2;
+	emStocksListBox * lb;
 
-	if (lb->Config.OwnedSharesFirst.Get()) {
-		if (s1->OwningShares.Get() != s2->OwningShares.Get()) {
-			return s1->OwningShares.Get() ? -1 : 1;
-		}
-	}
+	lb=(emStocksListBox*)context;
+	s1=lb->SortKeys[*index].Stock;
+	s2=(const emStocksRec::StockRec*)stockRec;
+	return s1<s2 ? -1 : s1>s2 ? 1 : 0;
+}
 
-	switch (lb->Config.Sorting.Get()) {
-		case emStocksConfig::SORT_BY_TRADE_DATE:
-			f1=emStocksFileModel::CompareDates(s1->TradeDate.Get(),s2->TradeDate.Get());
-			f2=0.0;
-			b1=b2=true;
-			break;
-		case emStocksConfig::SORT_BY_INQUIRY_DATE:
-			f1=emStocksFileModel::CompareDates(s1->InquiryDate.Get(),s2->InquiryDate.Get());
-			f2=0.0;
-			b1=b2=true;
-			break;
-		case emStocksConfig::SORT_BY_ACHIEVEMENT:
-			b1=s1->GetAchievementOfDate(&f1,lb->GetSelectedDate());
-			b2=s2->GetAchievementOfDate(&f2,lb->GetSelectedDate());
-			break;
-		case emStocksConfig::SORT_BY_ONE_WEEK_RISE:
-			b1=s1->GetRiseUntilDate(&f1,lb->GetSelectedDate(),7);
-			b2=s2->GetRiseUntilDate(&f2,lb->GetSelectedDate(),7);
-			break;
-		case emStocksConfig::SORT_BY_THREE_WEEK_RISE:
-			b1=s1->GetRiseUntilDate(&f1,lb->GetSelectedDate(),7*3);
-			b2=s2->GetRiseUntilDate(&f2,lb->GetSelectedDate(),7*3);
-			break;
-		case emStocksConfig::SORT_BY_NINE_WEEK_RISE:
-			b1=s1->GetRiseUntilDate(&f1,lb->GetSelectedDate(),7*9);
-			b2=s2->GetRiseUntilDate(&f2,lb->GetSelectedDate(),7*9);
-			break;
-		case emStocksConfig::SORT_BY_DIVIDEND:
-			b1=!s1->ExpectedDividend.Get().IsEmpty();
-			f1=b1?atof(s1->ExpectedDividend.Get().Get()):0.0;
-			b2=!s2->ExpectedDividend.Get().IsEmpty();
-			f2=b2?atof(s2->ExpectedDividend.Get().Get()):0.0;
-			break;
-		case emStocksConfig::SORT_BY_PURCHASE_VALUE:
-			b1=s1->GetTradeValue(&f1);
-			b2=s2->GetTradeValue(&f2);
-			break;
-		case emStocksConfig::SORT_BY_VALUE:
-			b1=s1->GetValueOfDate(&f1,lb->GetSelectedDate());
-			b2=s2->GetValueOfDate(&f2,lb->GetSelectedDate());
-			break;
-		case emStocksConfig::SORT_BY_DIFFERENCE:
-			b1=s1->GetDifferenceValueOfDate(&f1,lb->GetSelectedDate());
-			b2=s2->GetDifferenceValueOfDate(&f2,lb->GetSelectedDate());
-			break;
-		default:
-			f1=f2=0.0;
-			b1=b2=false;
-			break;
-	}
 
-	if (b1 != b2) return b1 ? 1 : -1;
-	if (b1) {
-		f=f1-f2;
-		d=f<0.0?-1:f>0.0?1:0;
-	}
-	else {
-		d=0;
+int emStocksListBox::CompareSortKeys(
+	SortKey * const * key1, SortKey * const * key2, void * context
+)
+{
+	const SortKey * k1, * k2;
+	emStocksListBox * lb;
+	int d,i1,i2;
+
+	lb=(emStocksListBox*)context;
+	k1=*key1;
+	k2=*key2;
+
+	if (lb->Config.OwnedSharesFirst.Get()) {
+		if (k1->Owning != k2->Owning) return k1->Owning ? -1 : 1;
 	}
 
-	if (!d) d=strcoll(s1->Name.Get(),s2->Name.Get());
+	if (k1->Valid != k2->Valid) return k1->Valid ? 1 : -1;
+	d=k1->Value<k2->Value?-1:k1->Value>k2->Value?1:0;
+
+	if (!d) d=strcmp(k1->NameKey.Get(),k2->NameKey.Get());
 	if (!d) {
-		d=strcmp(s1->Name.Get(),s2->Name.Get());
+		d=strcmp(k1->Name.Get(),k2->Name.Get());
 		if (!d) {
-			i1=atoi(s1->Id.Get());
-			i2=atoi(s2->Id.Get());
+			i1=atoi(k1->Stock->Id.Get());
+			i2=atoi(k2->Stock->Id.Get());
 			d=i1>i2?1:i1<i2?-1:0;
-			if (!d) d=strcmp(s1->Id.Get(),s2->Id.Get());
+			if (!d) d=strcmp(k1->Stock->Id.Get(),k2->Stock->Id.Get());
 		}
 	}
 	return d;
 }
+
+
+int emStocksListBox::CompareItems(
+	const emString &, const emString &, const emAnything & item1data,
+	const emString &, const emString &, const emAnything & item2data,
+	void * context
+)
+{
+	const emCrossPtr<emStocksRec::StockRec> * crossPtr;
+	SortKey * k1, * k2;
+	emStocksListBox * lb;
+
+	lb=(emStocksListBox*)context;
+
+	crossPtr=emCastAnything<emCrossPtr<emStocksRec::StockRec>>(item1data);
+	if (!crossPtr) return 1;
+	k1=lb->GetSortKey(*crossPtr);
+
+	crossPtr=emCastAnything<emCrossPtr<emStocksRec::StockRec>>(item2data);
+	if (!crossPtr) return -1;
+	k2=lb->GetSortKey(*crossPtr);
+
+	if (!k1 || !k2) return k1 ? -1 : k2 ? 1 : 0;
+	return CompareSortKeys(&k1,&k2,context);
+}
@@ -23,7 +23,8 @@
 
 emStocksPricesFetcher::emStocksPricesFetcher(
 	emStocksFileModel & fileModel, const emString & apiScript,
-	const emString & apiScriptInterpreter, const emString & apiKey
+	const emString & apiScriptInterpreter, const emString & apiKey,
+	int maxProcesses
 )
 	: emEngine(fileModel.GetScheduler()),
 	FileModel(&fileModel),
@@ -31,9 +32,10 @@ emStocksPricesFetcher::emStocksPricesFetcher(
 	ApiScript(apiScript),
 	ApiScriptInterpreter(apiScriptInterpreter),
 	ApiKey(apiKey),
-	CurrentIndex(0),
-	CurrentProcessActive(false),
-	CurrentStockUpdated(false)
+	MaxProcesses(emMax(maxProcesses,1)),
+	NextIndex(0),
+	DoneCount(0),
+	LastCommitClock(0)
 {
 	AddWakeUpSignal(FileModel->GetChangeSignal());
 	AddWakeUpSignal(FileModel->GetFileStateSignal());
@@ -42,6 +44,7 @@ emStocksPricesFetcher::emStocksPricesFetcher(
 
 emStocksPricesFetcher::~emStocksPricesFetcher()
 {
+	Clear();
 }
 
 
@@ -74,33 +77,40 @@ void emStocksPricesFetcher::AddStockIds(const emArray<emString> & stockIds)
 
 const emString * emStocksPricesFetcher::GetCurrentStockId() const
 {
-	if (CurrentIndex<0 || CurrentIndex>=StockIds.GetCount()) return NULL;
-	return &StockIds[CurrentIndex];
+	if (Jobs.IsEmpty()) return NULL;
+	return &StockIds[Jobs[0]->Index];
 }
 
 
 emStocksRec::StockRec * emStocksPricesFetcher::GetCurrentStockRec() const
 {
-	if (CurrentIndex<0 || CurrentIndex>=StockIds.GetCount()) return NULL;
-	return GetStockRec(StockIds[CurrentIndex]);
+	if (Jobs.IsEmpty()) return NULL;
+	return GetStockRec(StockIds[Jobs[0]->Index]);
 }
 
 
 double emStocksPricesFetcher::GetProgressInPercent() const
 {
-	if (CurrentIndex<0 || CurrentIndex>=StockIds.GetCount()) return 100.0;
-	return (CurrentIndex + 0.5) * 100.0 / StockIds.GetCount();
+	if (HasFinished()) return 100.0;
+	return
+		(DoneCount + FinishedJobs.GetCount() + Jobs.GetCount() * 0.5) *
+		100.0 / StockIds.GetCount()
+	;
 }
 
 
 bool emStocksPricesFetcher::HasFinished() const
 {
-	return CurrentIndex<0 || CurrentIndex>=StockIds.GetCount();
+	return DoneCount>=StockIds.GetCount();
 }
 
 
 bool emStocksPricesFetcher::Cycle()
 {
+	emUInt64 clk;
+	Job * job;
+	int i;
+
 	switch (FileModel->GetFileState()) {
 		case emFileModel::FS_LOADED:
 		case emFileModel::FS_UNSAVED:
@@ -109,54 +119,97 @@ bool emStocksPricesFetcher::Cycle()
 			return false;
 	}
 
-	if (CurrentProcessActive) PollProcess();
-	if (!CurrentProcessActive) StartProcess();
+	StartJobs();
+
+	for (i=0; i<Jobs.GetCount(); ) {
+		if (IsTimeSliceAtEnd()) return true;
+		job=Jobs[i];
+		if (PollJob(job)) {
+			Jobs.Remove(i);
+			FinishedJobs.Add(job);
+			Signal(ChangeSignal);
+		}
+		else {
+			i++;
+		}
+	}
+
+	if (!FinishedJobs.IsEmpty()) {
+		clk=emGetClockMS();
+		if (Jobs.IsEmpty() || clk-LastCommitClock>=COMMIT_INTERVAL) {
+			CommitJobs();
+			LastCommitClock=clk;
+		}
+	}
+
+	if (HasFinished() && !StockIds.IsEmpty()) {
+		if (!NoDataStocks.IsEmpty()) {
+			SetFailed(
+				"Could not fetch any new data for:\n"+
+				NoDataStocks
+			);
+		}
+		else {
+			Clear();
+			Signal(ChangeSignal);
+		}
+	}
 
-	return CurrentProcessActive;
+	return !Jobs.IsEmpty() || !FinishedJobs.IsEmpty();
 }
 
 
-void emStocksPricesFetcher::StartProcess()
+void emStocksPricesFetcher::StartJobs()
 {
 	emStocksRec::StockRec * stockRec;
-	emArray<emString> args;
-
-	if (CurrentProcessActive) return;
+	Job * job;
 
-	for (;;) {
-		if (CurrentIndex>=StockIds.GetCount()) {
-			return;
-		}
-
-		stockRec=GetCurrentStockRec();
+	while (Jobs.GetCount()<MaxProcesses && NextIndex<StockIds.GetCount()) {
+		stockRec=GetStockRec(StockIds[NextIndex]);
 		if (!stockRec || stockRec->Symbol.Get().IsEmpty()) {
-			CurrentIndex++;
+			NextIndex++;
+			DoneCount++;
 			Signal(ChangeSignal);
 			continue;
 		}
 
-		break;
+		if (ApiScript.IsEmpty()) {
+			SetFailed("API script is not set.");
+			return;
+		}
+
+		job=new Job;
+		job->Index=NextIndex++;
+		job->Symbol=stockRec->Symbol.Get();
+		job->StartDate=CalculateStartDate(stockRec);
+		job->Running=false;
+		job->Clock=0;
+		job->Tries=0;
+		Jobs.Add(job);
+
+		StartProcess(job);
+		if (Jobs.IsEmpty()) return;
 	}
+}
 
-	CurrentSymbol=stockRec->Symbol.Get();
-	OutBuffer.Clear();
-	ErrBuffer.Clear();
-	CurrentProcessActive=true;
 
-	CalculateDate();
+void emStocksPricesFetcher::StartProcess(Job * job)
+{
+	emArray<emString> args;
 
-	if (ApiScript.IsEmpty()) {
-		SetFailed("API script is not set.");
-		return;
-	}
+	job->OutBuffer.Clear();
+	job->ErrBuffer.Clear();
+	job->Running=true;
+	job->Clock=emGetClockMS();
+	job->Tries++;
 
 	if (!ApiScriptInterpreter.IsEmpty()) args.Add(ApiScriptInterpreter);
 	args.Add(ApiScript);
-	args.Add(CurrentSymbol);
-	args.Add(CurrentStartDate);
+	args.Add(job->Symbol);
+	args.Add(job->StartDate);
 	args.Add(ApiKey);
 	try {
-		CurrentProcess.TryStart(
+		job->Process.TryStart(
 			args,
 			emArray<emString>(),
 			NULL,
@@ -172,95 +225,142 @@ void emStocksPricesFetcher::StartProcess()
 }
 
 
-void emStocksPricesFetcher::PollProcess()
+bool emStocksPricesFetcher::PollJob(Job * job)
 {
-	char tmp[128]; // Don't make too large, otherwise too many AddPrice calls in a time slice.
-	emStocksRec::StockRec * stockRec;
+	char tmp[4096];
 	int lenOut,lenErr;
 
-	if (!CurrentProcessActive) return;
+	if (!job->Running) {
+		if (emGetClockMS()>=job->Clock) StartProcess(job);
+		return false;
+	}
 
 	for (;;) {
-		if (IsTimeSliceAtEnd()) return;
-
 		try {
-			lenOut=CurrentProcess.TryRead(tmp,sizeof(tmp));
+			lenOut=job->Process.TryRead(tmp,sizeof(tmp));
 		}
 		catch (const emException & exception) {
 			SetFailed(exception.GetText());
-			return;
+			return false;
 		}
 
 		if (lenOut<=0) break;
 
-		OutBuffer.Add(tmp,lenOut);
-		ProcessOutBufferLines();
-		if (OutBuffer.GetCount()>100000) {
-			SetFailed("API script printed a too long line.");
-			return;
+		job->OutBuffer.Add(tmp,lenOut);
+		if (job->OutBuffer.GetCount()>MAX_OUT_SIZE) {
+			SetFailed("API script printed too much data.");
+			return false;
 		}
 	}
 
 	for (;;) {
 		try {
-			lenErr=CurrentProcess.TryReadErr(tmp,sizeof(tmp));
+			lenErr=job->Process.TryReadErr(tmp,sizeof(tmp));
 		}
 		catch (const emException & exception) {
 			SetFailed(exception.GetText());
-			return;
+			return false;
 		}
 
 		if (lenErr<=0) break;
 
-		ErrBuffer.Add(tmp,lenErr);
-		if (ErrBuffer.GetCount()>100000) {
+		job->ErrBuffer.Add(tmp,lenErr);
+		if (job->ErrBuffer.GetCount()>MAX_ERR_SIZE) {
 			SetFailed("API script printed too much data on stderr.");
-			return;
+			return false;
+		}
+	}
+
+	if (lenOut>=0 || lenErr>=0 || job->Process.IsRunning()) {
+		if (emGetClockMS()-job->Clock>PROCESS_TIMEOUT) {
+			job->Process.Terminate();
+			RetryJob(job,"Timed out.");
 		}
+		return false;
 	}
 
-	if (lenOut>=0 || lenErr>=0) return;
+	if (job->Process.GetExitStatus()!=0) {
+		job->ErrBuffer.Add('\0');
+		if (job->Process.GetExitStatus()==NO_RETRY_EXIT_STATUS) {
+			FailJob(job,job->ErrBuffer.Get());
+		}
+		else {
+			RetryJob(job,job->ErrBuffer.Get());
+		}
+		return false;
+	}
 
-	if (CurrentProcess.IsRunning()) return;
+	job->Running=false;
+	job->ErrBuffer.Clear(true);
+	return true;
+}
 
-	ErrBuffer.Add('\0');
 
-	if (CurrentProcess.GetExitStatus()!=0) {
-		SetFailed(emString::Format(
-			"API script failed for \"%s\":\n%s",
-			CurrentSymbol.Get(),
-			ErrBuffer.Get()
-		));
+void emStocksPricesFetcher::RetryJob(Job * job, const emString & error)
+{
+	if (job->Tries>=MAX_TRIES) {
+		FailJob(job,error);
 		return;
 	}
+	job->Running=false;
+	job->Clock=emGetClockMS()+RETRY_DELAY;
+	job->OutBuffer.Clear(true);
+	job->ErrBuffer.Clear(true);
+}
+
+
+void emStocksPricesFetcher::FailJob(Job * job, const emString & error)
+{
+	SetFailed(emString::Format(
+		"API script failed for \"%s\":\n%s",
+		job->Symbol.Get(),
+		error.Get()
+	));
+}
+
 
-	if (!CurrentStockUpdated) {
-		stockRec=GetCurrentStockRec();
-		if (stockRec) {
+void emStocksPricesFetcher::CommitJobs()
+{
+	emStocksRec::StockRec * stockRec;
+	emStocksListBox * listBox;
+	const emCrossPtr<emStocksListBox> * c;
+	emString latestBefore,latestAfter;
+	Job * job;
+	int i;
+
+	// Listeners of the file model get all the changes in one time
+	// slice, and the list boxes which show the latest date are moved
+	// to the new latest date only once.
+	latestBefore=FileModel->GetLatestPricesDate();
+
+	for (i=0; i<FinishedJobs.GetCount(); i++) {
+		job=FinishedJobs[i];
+		stockRec=GetStockRec(StockIds[job->Index]);
+		if (stockRec && ProcessOutBufferLines(job,stockRec)<=0) {
 			NoDataStocks+=emString::Format(
 				"  %s - %s\n",
 				stockRec->Symbol.Get().Get(),
 				stockRec->Name.Get().Get()
 			);
 		}
+		delete job;
+		DoneCount++;
 	}
-
-	if (!NoDataStocks.IsEmpty() && CurrentIndex+1>=StockIds.GetCount()) {
-		SetFailed(
-			"Could not fetch any new data for:\n"+
-			NoDataStocks
-		);
-		return;
+	FinishedJobs.Clear();
+
+	latestAfter=FileModel->GetLatestPricesDate();
+	if (emStocksFileModel::CompareDates(latestAfter, latestBefore) > 0) {
+		for (c=ListBoxes.GetFirst(); c; c=ListBoxes.GetNext(c)) {
+			listBox=c->Get();
+			if (!listBox) continue;
+			if (emStocksFileModel::CompareDates(
+				latestBefore, listBox->GetSelectedDate()) <= 0
+			) {
+				listBox->SetSelectedDate(latestAfter);
+			}
+		}
 	}
 
-	CurrentIndex++;
-	CurrentSymbol.Clear();
-	CurrentStartDate.Clear();
-	CurrentProcessActive=false;
-	CurrentStockUpdated=false;
-	OutBuffer.Clear();
-	ErrBuffer.Clear();
-	if (CurrentIndex>=StockIds.GetCount()) Clear();
 	Signal(ChangeSignal);
 }
 
@@ -275,16 +375,16 @@ void emStocksPricesFetcher::SetFailed(const emString & error)
 
 void emStocksPricesFetcher::Clear()
 {
+	int i;
+
+	for (i=0; i<Jobs.GetCount(); i++) delete Jobs[i];
+	Jobs.Clear();
+	for (i=0; i<FinishedJobs.GetCount(); i++) delete FinishedJobs[i];
+	FinishedJobs.Clear();
 	StockIds.Clear();
 	StockRecsMap.Clear();
-	CurrentIndex=0;
-	CurrentSymbol.Clear();
-	CurrentStartDate.Clear();
-	CurrentProcess.Terminate();
-	CurrentProcessActive=false;
-	CurrentStockUpdated=false;
-	OutBuffer.Clear();
-	ErrBuffer.Clear();
+	NextIndex=0;
+	DoneCount=0;
 	NoDataStocks.Clear();
 	Error.Clear();
 }
@@ -323,16 +423,16 @@ void emStocksPricesFetcher::UpdateStockRecsMapValues()
 }
 
 
-void emStocksPricesFetcher::CalculateDate()
+emString emStocksPricesFetcher::CalculateStartDate(
+	const emStocksRec::StockRec * stockRec
+) const
 {
-	emStocksRec::StockRec * stockRec;
 	emString currentDate;
 	int d;
 
 	currentDate=emStocksFileModel::GetCurrentDate();
 
-	stockRec=GetCurrentStockRec();
-	if (!stockRec || stockRec->LastPriceDate.Get().IsEmpty()) {
+	if (stockRec->LastPriceDate.Get().IsEmpty()) {
 		d=emStocksRec::StockRec::MAX_NUM_PRICES;
 	}
 	else {
@@ -344,32 +444,38 @@ void emStocksPricesFetcher::CalculateDate()
 		d=emMax(d,1);
 	}
 
-	CurrentStartDate=emStocksFileModel::AddDaysToDate(1-d,currentDate);
+	return emStocksFileModel::AddDaysToDate(1-d,currentDate);
 }
 
 
-void emStocksPricesFetcher::ProcessOutBufferLines()
+int emStocksPricesFetcher::ProcessOutBufferLines(
+	Job * job, emStocksRec::StockRec * stockRec
+)
 {
-	char * beg, * pos, * end, * brk;
+	char * pos, * end, * brk;
+	int n;
 
-	beg=OutBuffer.GetWritable();
-	end=beg+OutBuffer.GetCount();
-	pos=beg;
+	job->OutBuffer.Add('\n');
+	pos=job->OutBuffer.GetWritable();
+	end=pos+job->OutBuffer.GetCount();
+	n=0;
 
 	for (;;) {
 		for (brk=pos; brk<end && *brk!=0x0d && *brk!=0x0a; brk++);
 		if (brk>=end) break;
 		*brk=0;
-		ProcessOutBufferLine(pos);
+		n+=ProcessOutBufferLine(job,stockRec,pos);
 		do { brk++; } while (brk<end && (*brk==0x0d || *brk==0x0a));
 		pos=brk;
 	}
 
-	if (pos>beg) OutBuffer.Remove(0,pos-beg);
+	return n;
 }
 
 
-void emStocksPricesFetcher::ProcessOutBufferLine(const char * str)
+int emStocksPricesFetcher::ProcessOutBufferLine(
+	Job * job, emStocksRec::StockRec * stockRec, const char * str
+)
 {
 	emString date;
 	emString price;
@@ -379,56 +485,24 @@ void emStocksPricesFetcher::ProcessOutBufferLine(const char * str)
 	while (*str && (unsigned char)*str<=0x20) str++;
 
 	for (i=0; ; i++) {
-		if (*str<'0' || *str>'9') return;
+		if (*str<'0' || *str>'9') return 0;
 		d=*str++ - '0';
 		while (*str>='0' && *str<='9') d=d*10+(*str++ - '0');
 		ymd[i]=d;
 		if (i>=2) break;
-		if (*str!='-') return;
+		if (*str!='-') return 0;
 		str++;
 	}
 	date=emString::Format("%04d-%02d-%02d",ymd[0],ymd[1],ymd[2]);
 
-	if (emStocksFileModel::CompareDates(date, CurrentStartDate) < 0) {
-		return;
+	if (emStocksFileModel::CompareDates(date, job->StartDate) < 0) {
+		return 0;
 	}
 
 	while (*str && (*str<'0' || *str>'9') && *str!='-' && *str!='.') str++;
-	if (!*str) return;
+	if (!*str) return 0;
 	price=emStocksFileModel::SharePriceToString(atof(str));
 
-	AddPrice(date,price);
-}
-
-
-void emStocksPricesFetcher::AddPrice(const char * date, const char * price)
-{
-	emStocksRec::StockRec * stockRec;
-	emStocksListBox * listBox;
-	const emCrossPtr<emStocksListBox> * c;
-	emString latestBefore;
-
-	stockRec=GetCurrentStockRec();
-	if (!stockRec) return;
-
-	if (
-		stockRec->LastPriceDate.Get().IsEmpty() ||
-		emStocksFileModel::CompareDates(date, stockRec->LastPriceDate.Get()) > 0
-	) {
-		latestBefore=FileModel->GetLatestPricesDate();
-		if (emStocksFileModel::CompareDates(date, latestBefore) > 0) {
-			for (c=ListBoxes.GetFirst(); c; c=ListBoxes.GetNext(c)) {
-				listBox=c->Get();
-				if (!listBox) continue;
-				if (emStocksFileModel::CompareDates(
-					latestBefore, listBox->GetSelectedDate()) <= 0
-				) {
-					listBox->SetSelectedDate(date);
-				}
-			}
-		}
-	}
-
 	stockRec->AddPrice(date,price);
-	CurrentStockUpdated=true;
+	return 1;
 }
@@ -78,6 +78,313 @@ void emStocksRec::InterestRec::TryStartReading(emRecReader & reader)
 }
 
 
+emStocksRec::PricesRec::PricesRec(
+	emStructRec * parent, const char * varIdentifier
+) :
+	emRec(parent,varIdentifier),
+	First(0)
+{
+	Values.SetTuningLevel(4);
+	Decimals.SetTuningLevel(4);
+}
+
+
+emStocksRec::PricesRec::~PricesRec()
+{
+}
+
+
+emString emStocksRec::PricesRec::GetText(int index) const
+{
+	char tmp[MAX_PRICE_LEN+32];
+	int d;
+
+	d=Decimals[First+index];
+	if (d==UNKNOWN) return emString();
+	if (d==VERBATIM) return *VerbatimTexts.GetValue(First+index);
+	snprintf(tmp,sizeof(tmp),"%.*f",d,Values[First+index]);
+	tmp[sizeof(tmp)-1]=0;
+	return emString(tmp);
+}
+
+
+bool emStocksRec::PricesRec::StartsWithDigit(int index) const
+{
+	const emString * text;
+	int d;
+
+	d=Decimals[First+index];
+	if (d==UNKNOWN) return false;
+	if (d==VERBATIM) {
+		text=VerbatimTexts.GetValue(First+index);
+		return text && (*text)[0]>='0' && (*text)[0]<='9';
+	}
+	// The text is the value formatted with "%.*f", so only a sign
+	// (even of -0) comes before the digits.
+	return copysign(1.0,Values[First+index])>0.0;
+}
+
+
+void emStocksRec::PricesRec::Set(int index, const char * price)
+{
+	const char * p;
+	emString text;
+	double v;
+	int d;
+
+	p=ParsePrice(price,&v,&d);
+	index+=First;
+	if (d==VERBATIM) {
+		text=emString(price,p-price);
+		if (Decimals[index]!=VERBATIM || *VerbatimTexts.GetValue(index)!=text) {
+			Values.Set(index,v);
+			Decimals.Set(index,(emInt8)d);
+			VerbatimTexts.SetValue(index,text,true);
+			Changed();
+		}
+	}
+	else if (Decimals[index]!=d || Values[index]!=v) {
+		if (Decimals[index]==VERBATIM) VerbatimTexts.Remove(index);
+		Values.Set(index,v);
+		Decimals.Set(index,(emInt8)d);
+		Changed();
+	}
+}
+
+
+void emStocksRec::PricesRec::Insert(int index, int count)
+{
+	if (count<=0) return;
+	if (index>0) {
+		Values.Add(0.0,count);
+		Decimals.Add((emInt8)UNKNOWN,count);
+	}
+	else if (First>=count) {
+		First-=count;
+		memset(Decimals.GetWritable()+First,UNKNOWN,count);
+	}
+	else {
+		Values.Insert(First,0.0,count);
+		Decimals.Insert(First,(emInt8)UNKNOWN,count);
+		ShiftVerbatim(count);
+	}
+	Changed();
+}
+
+
+void emStocksRec::PricesRec::Remove(int index, int count)
+{
+	if (count<=0) return;
+	if (count>=GetCount()) {
+		Clear();
+		return;
+	}
+	if (index>0) {
+		RemoveVerbatim(Values.GetCount()-count,Values.GetCount());
+		Values.SetCount(Values.GetCount()-count);
+		Decimals.SetCount(Decimals.GetCount()-count);
+	}
+	else {
+		RemoveVerbatim(First,First+count);
+		First+=count;
+		if (First>Values.GetCount()-First) {
+			Values.Remove(0,First);
+			Decimals.Remove(0,First);
+			ShiftVerbatim(-First);
+			First=0;
+		}
+	}
+	Changed();
+}
+
+
+void emStocksRec::PricesRec::Clear()
+{
+	if (GetCount()>0) {
+		Values.Clear(true);
+		Decimals.Clear(true);
+		VerbatimTexts.Clear();
+		First=0;
+		Changed();
+	}
+}
+
+
+void emStocksRec::PricesRec::SetToDefault()
+{
+	Clear();
+}
+
+
+bool emStocksRec::PricesRec::IsSetToDefault() const
+{
+	return GetCount()<=0;
+}
+
+
+void emStocksRec::PricesRec::TryStartReading(emRecReader & reader)
+{
+	const char * p, * q;
+	double * v;
+	emInt8 * t;
+	int i,n,d;
+
+	p=reader.TryReadQuoted();
+	n=0;
+	if (*p) {
+		n=1;
+		for (q=p; *q; q++) if (*q=='|') n++;
+	}
+	Values.SetCount(n,true);
+	Decimals.SetCount(n,true);
+	VerbatimTexts.Clear();
+	First=0;
+	v=Values.GetWritable();
+	t=Decimals.GetWritable();
+	for (i=0; i<n; i++) {
+		q=p;
+		p=ParsePrice(q,v+i,&d);
+		t[i]=(emInt8)d;
+		if (d==VERBATIM) VerbatimTexts.Insert(i,emString(q,p-q));
+		if (*p) p++;
+	}
+	Changed();
+}
+
+
+bool emStocksRec::PricesRec::TryContinueReading(emRecReader & reader)
+{
+	return true;
+}
+
+
+void emStocksRec::PricesRec::QuitReading()
+{
+}
+
+
+void emStocksRec::PricesRec::TryStartWriting(emRecWriter & writer)
+{
+	emArray<char> buf;
+	char tmp[MAX_PRICE_LEN+32];
+	int i,n,d;
+
+	n=GetCount();
+	buf.SetTuningLevel(4);
+	for (i=0; i<n; i++) {
+		if (i>0) buf.Add('|');
+		d=Decimals[First+i];
+		if (d==UNKNOWN) continue;
+		if (d==VERBATIM) {
+			const emString & text=*VerbatimTexts.GetValue(First+i);
+			buf.Add(text.Get(),text.GetLen());
+			continue;
+		}
+		snprintf(tmp,sizeof(tmp),"%.*f",d,Values[First+i]);
+		tmp[sizeof(tmp)-1]=0;
+		buf.Add(tmp,strlen(tmp));
+	}
+	buf.Add('\0');
+	writer.TryWriteQuoted(buf.Get());
+}
+
+
+bool emStocksRec::PricesRec::TryContinueWriting(emRecWriter & writer)
+{
+	return true;
+}
+
+
+void emStocksRec::PricesRec::QuitWriting()
+{
+}
+
+
+emUInt64 emStocksRec::PricesRec::CalcRecMemNeed() const
+{
+	emAvlTreeMap<int,emString>::Iterator it;
+	emUInt64 m;
+
+	m=
+		sizeof(PricesRec) +
+		((emUInt64)Values.GetCount())*(sizeof(double)+sizeof(emInt8)) +
+		64
+	;
+	for (it.SetFirst(VerbatimTexts); it; ++it) {
+		m+=it->Value.GetLen()+64;
+	}
+	return m;
+}
+
+
+const char * emStocksRec::PricesRec::ParsePrice(
+	const char * str, double * pValue, int * pDecimals
+)
+{
+	char tmp[MAX_PRICE_LEN+32];
+	const char * p, * q;
+	double v;
+	int d;
+
+	p=str;
+	if (*p=='-') p++;
+	for (q=p; *p>='0' && *p<='9'; p++);
+	if (p>q) {
+		d=0;
+		if (*p=='.') {
+			for (q=++p; *p>='0' && *p<='9'; p++);
+			d=p-q;
+		}
+		if ((!*p || *p=='|') && p-str<=MAX_PRICE_LEN) {
+			// Only if the text is reproduced exactly.
+			v=atof(str);
+			snprintf(tmp,sizeof(tmp),"%.*f",d,v);
+			tmp[sizeof(tmp)-1]=0;
+			if (strlen(tmp)==(size_t)(p-str) && memcmp(tmp,str,p-str)==0) {
+				*pValue=v;
+				*pDecimals=d;
+				return p;
+			}
+		}
+	}
+	while (*p && *p!='|') p++;
+	if (p>str) {
+		*pValue=atof(str);
+		*pDecimals=VERBATIM;
+	}
+	else {
+		*pValue=0.0;
+		*pDecimals=UNKNOWN;
+	}
+	return p;
+}
+
+
+void emStocksRec::PricesRec::RemoveVerbatim(int begin, int end)
+{
+	const emAvlTreeMap<int,emString>::Element * e;
+
+	for (;;) {
+		e=VerbatimTexts.GetNearestGreaterOrEqual(begin);
+		if (!e || e->Key>=end) break;
+		VerbatimTexts.Remove(e);
+	}
+}
+
+
+void emStocksRec::PricesRec::ShiftVerbatim(int delta)
+{
+	emAvlTreeMap<int,emString>::Iterator it;
+	emAvlTreeMap<int,emString> map;
+
+	if (VerbatimTexts.IsEmpty()) return;
+	for (it.SetFirst(VerbatimTexts); it; ++it) {
+		map.Insert(it->Key+delta,it->Value);
+	}
+	VerbatimTexts=map;
+}
+
+
 emStocksRec::StockRec::StockRec()
 	: emStructRec(),
 	Id(this,"Id"),
@@ -113,23 +420,17 @@ emStocksRec::StockRec::~StockRec()
 }
 
 
-const char * emStocksRec::StockRec::GetPricePtrOfDate(
+int emStocksRec::StockRec::GetPriceIndexOfDate(
 	const char * date
 ) const
 {
-	const char * p, * q;
-	int d;
+	int d,n;
 	bool datesValid;
 
 	d=GetDateDifference(date,LastPriceDate.Get(),&datesValid);
-	if (!datesValid || d<0) return "";
-	p=Prices.Get().Get();
-	for (q=p+strlen(p); q>p; q--) {
-		while (q>p && q[-1]!='|') q--;
-		d--;
-		if (d<0) return q;
-	}
-	return "";
+	n=Prices.GetCount();
+	if (!datesValid || d<0 || d>=n) return -1;
+	return n-1-d;
 }
 
 
@@ -137,12 +438,11 @@ emString emStocksRec::StockRec::GetPriceOfDate(
 	const char * date
 ) const
 {
-	const char * p, * q;
+	int i;
 
-	p=GetPricePtrOfDate(date);
-	q=p;
-	while (*q && *q!='|') q++;
-	return emString(p,q-p);
+	i=GetPriceIndexOfDate(date);
+	if (i<0) return emString();
+	return Prices.GetText(i);
 }
 
 
@@ -150,14 +450,14 @@ emString emStocksRec::StockRec::GetPricesDateBefore(
 	const char * date
 ) const
 {
-	const char * p, * q;
-	int d,n;
+	int d,n,i;
 
 	d=GetDateDifference(date,LastPriceDate.Get());
-	p=Prices.Get().Get();
-	for (q=p+strlen(p), n=0; q>p; q--, n++) {
-		while (q>p && q[-1]!='|') q--;
-		if (n>d && *q && *q!='|') return AddDaysToDate(-n,LastPriceDate.Get());
+	n=Prices.GetCount();
+	for (i=emMin(n-2-d,n-1); i>=0; i--) {
+		if (Prices.IsKnown(i)) {
+			return AddDaysToDate(i-(n-1),LastPriceDate.Get());
+		}
 	}
 	return emString();
 }
@@ -167,18 +467,16 @@ emString emStocksRec::StockRec::GetPricesDateAfter(
 	const char * date
 ) const
 {
-	const char * p, * q;
-	int d,n,m;
+	int d,n,i;
 
 	d=GetDateDifference(date,LastPriceDate.Get());
 	if (d<=0) return emString();
-	p=Prices.Get().Get();
-	for (q=p+strlen(p), n=0, m=-1; q>p; q--, n++) {
-		while (q>p && q[-1]!='|') q--;
-		if (*q && *q!='|') m=n;
-		if (n+1>=d) break;
+	n=Prices.GetCount();
+	for (i=emMax(n-d,0); i<n; i++) {
+		if (Prices.IsKnown(i)) {
+			return AddDaysToDate(i-(n-1),LastPriceDate.Get());
+		}
 	}
-	if (m>=0) return  AddDaysToDate(-m,LastPriceDate.Get());
 	return emString();
 }
 
@@ -187,83 +485,52 @@ void emStocksRec::StockRec::AddPrice(
 	const char * date, const char * price
 )
 {
-	emString prices;
-	const char * p, * q, * e;
 	int n,i,j;
 
-	prices=Prices.Get();
-
-	n=0;
-	p=prices.Get();
-	if (*p) {
-		n=1;
-		do {
-			if (*p=='|') n++;
-			p++;
-		} while (*p);
-	}
-
-	if (n<=0) {
-		Prices=price;
-		LastPriceDate=date;
-		return;
-	}
-
-	i=n-1+GetDateDifference(LastPriceDate.Get(),date);
-
-	if (i>=n) {
-		p=prices.Get();
-		while (*p && (i+1>MAX_NUM_PRICES || *p=='|')) {
-			do { p++; } while (*p && p[-1]!='|');
-			n--;
-			i--;
+	n=Prices.GetCount();
+	i=0;
+
+	if (n>0) {
+		i=n-1+GetDateDifference(LastPriceDate.Get(),date);
+		if (i>=n) {
+			for (
+				j=0;
+				j<n && (i-j+1>MAX_NUM_PRICES || !Prices.IsKnown(j));
+				j++
+			);
+			Prices.Remove(0,j);
+			n-=j;
+			i-=j;
 		}
-		if (n<=0) {
-			Prices=price;
-			LastPriceDate=date;
-			return;
+		else if (i<0) {
+			for (
+				j=0;
+				j<n && (-i+n-j>MAX_NUM_PRICES || !Prices.IsKnown(n-1-j));
+				j++
+			);
+			if (j>0) {
+				Prices.Remove(n-j,j);
+				n-=j;
+				LastPriceDate=AddDaysToDate(-j,LastPriceDate.Get());
+			}
 		}
-		if (p>prices.Get()) prices.Remove(0,p-prices.Get());
 	}
 
-	if (i<0) {
-		p=prices.Get();
-		e=p+strlen(p);
-		q=e;
-		while (q>p && (-i+n>MAX_NUM_PRICES || q[-1]=='|')) {
-			do { q--; } while (q>p && *q!='|');
-			n--;
-			LastPriceDate=AddDaysToDate(-1,LastPriceDate.Get());
-		}
-		if (n<=0) {
-			Prices=price;
-			LastPriceDate=date;
-			return;
-		}
-		if (q<e) prices.Remove(q-prices.Get(),e-q);
+	if (n<=0) {
+		Prices.Insert(0,1);
+		i=0;
+		LastPriceDate=date;
 	}
-
-	if (i>=n) {
-		prices.Add('|',i+1-n);
-		n=i+1;
+	else if (i>=n) {
+		Prices.Insert(n,i+1-n);
 		LastPriceDate=date;
 	}
-
-	if (i<0) {
-		prices.Insert(0,'|',-i);
-		n+=-i;
+	else if (i<0) {
+		Prices.Insert(0,-i);
 		i=0;
 	}
 
-	p=prices.Get();
-	e=p+strlen(p);
-	for (j=n-1; ; j--) {
-		for (q=e; q>p && q[-1]!='|'; q--);
-		if (j<=i) break;
-		e=q-1;
-	}
-	prices.Replace(q-p,e-q,price);
-	Prices=prices;
+	Prices.Set(i,price);
 }
 
 
@@ -326,7 +593,7 @@ bool emStocksRec::StockRec::GetValueOfDate(
 	double * pResult, const char * date
 ) const
 {
-	const char * price;
+	int i;
 
 	if (
 		!OwningShares.Get() ||
@@ -335,13 +602,13 @@ bool emStocksRec::StockRec::GetValueOfDate(
 		*pResult=0.0;
 		return false;
 	}
-	price = GetPricePtrOfDate(date);
-	if (*price<'0' || *price>'9') {
+	i=GetPriceIndexOfDate(date);
+	if (!IsValidPrice(i)) {
 		*pResult=0.0;
 		return false;
 	}
 
-	*pResult=atof(price)*atof(OwnShares.Get());
+	*pResult=Prices.GetValue(i)*atof(OwnShares.Get());
 	return true;
 }
 
@@ -365,8 +632,8 @@ bool emStocksRec::StockRec::GetAchievementOfDate(
 	double * pResult, const char * date, bool relative
 ) const
 {
-	const char * price;
 	double d,p,t;
+	int i;
 
 	if (DesiredPrice.Get().IsEmpty()) {
 		*pResult=0.0;
@@ -378,12 +645,12 @@ bool emStocksRec::StockRec::GetAchievementOfDate(
 		return false;
 	}
 
-	price = GetPricePtrOfDate(date);
-	if (*price<'0' || *price>'9') {
+	i=GetPriceIndexOfDate(date);
+	if (!IsValidPrice(i)) {
 		*pResult=0.0;
 		return false;
 	}
-	p=atof(price);
+	p=Prices.GetValue(i);
 	if (p<1E-10) {
 		*pResult=0.0;
 		return false;
@@ -416,37 +683,34 @@ bool emStocksRec::StockRec::GetRiseUntilDate(
 	double * pResult, const char * date, int days
 ) const
 {
-	const char * p, * q, * r;
 	double m,c;
-	int d,d1,d2,n;
+	int i,r,d,d1,d2,n;
 
-	q=GetPricePtrOfDate(date);
-	if (*q<'0' || *q>'9') {
+	i=GetPriceIndexOfDate(date);
+	if (!IsValidPrice(i)) {
 		*pResult=0.0;
 		return false;
 	}
-	c=atof(q);
+	c=Prices.GetValue(i);
 	if (c<1E-10) {
 		*pResult=0.0;
 		return false;
 	}
 
-	p=Prices.Get().Get();
-	r=q;
+	r=i;
 	d1=days-days/6;
 	d2=days+days/6;
 	m=0.0;
 	n=0;
-	for (d=1; q>p && d<=d2; q--, d++) {
-		while (q>p && q[-1]!='|') q--;
-		if (*q<'0' || *q>'9') continue;
-		r=q;
+	for (d=1; i>=0 && d<=d2; i--, d++) {
+		if (!IsValidPrice(i)) continue;
+		r=i;
 		if (d<d1) continue;
-		m+=atof(q);
+		m+=Prices.GetValue(i);
 		n++;
 	}
 
-	if (n==0) m=atof(r);
+	if (n==0) m=Prices.GetValue(r);
 	else m/=n;
 	if (m<1E-10) {
 		*pResult=0.0;
@@ -37,7 +37,8 @@ emSvgServerModel::SvgInstance & emSvgFileModel::GetSvgInstance() const
 
 
 emSvgFileModel::emSvgFileModel(emContext & context, const emString & name)
-	: emFileModel(context,name)
+	: emFileModel(context,name),
+	TileCache(GetScheduler())
 {
 	ServerModel=emSvgServerModel::Acquire(GetRootContext());
 	FileSize=0;
@@ -56,6 +57,7 @@ emSvgFileModel::~emSvgFileModel()
 
 void emSvgFileModel::ResetData()
 {
+	TileCache.Reset();
 	SvgInstance=NULL;
 	FileSize=0;
 	Width=0.0;
@@ -90,6 +92,7 @@ bool emSvgFileModel::TryContinueLoading()
 		Height=SvgInstance->GetHeight();
 		Title=SvgInstance->GetTitle();
 		Description=SvgInstance->GetDescription();
+		TileCache.Setup(*ServerModel,*SvgInstance);
 		return true;
 	default:
 		break;
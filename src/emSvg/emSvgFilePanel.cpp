@@ -28,16 +28,17 @@ emSvgFilePanel::emSvgFilePanel(
 	bool updateFileModel
 )
 	: emFilePanel(parent,name),
-	JobDelayTimer(GetScheduler()),
 	IconTimer(GetScheduler())
 {
-	ServerModel=emSvgServerModel::Acquire(GetRootContext());
-	JobUpToDate=false;
-	JobDelayStartTime=emGetClockMS();
+	ContentTiles.SetTuningLevel(4);
+	ContentTilesSetupCount=0;
+	ContentLevel=0;
+	ContentVisible=false;
+	ContentUpToDate=false;
+	ContentMissing=0;
 	RenderIcon=emGetInsResImage(GetRootContext(),"emPs","rendering.tga");
 	ShowIcon=false;
 	AddWakeUpSignal(GetVirFileStateSignal());
-	AddWakeUpSignal(JobDelayTimer.GetSignal());
 	AddWakeUpSignal(IconTimer.GetSignal());
 	SetFileModel(fileModel,updateFileModel);
 }
@@ -45,7 +46,7 @@ emSvgFilePanel::emSvgFilePanel(
 
 emSvgFilePanel::~emSvgFilePanel()
 {
-	ClearSvgDisplay();
+	ResetContent();
 }
 
 
@@ -53,9 +54,23 @@ void emSvgFilePanel::SetFileModel(
 	emFileModel * fileModel, bool updateFileModel
 )
 {
+	emSvgFileModel * fm;
+
 	if (fileModel && (dynamic_cast<emSvgFileModel*>(fileModel))==NULL) {
 		fileModel=NULL;
 	}
+	fm=(emSvgFileModel*)GetFileModel();
+	if (fm!=fileModel) {
+		if (fm) {
+			ResetContent();
+			RemoveWakeUpSignal(fm->GetTileCache().GetTileSignal());
+		}
+		fm=(emSvgFileModel*)fileModel;
+		if (fm) {
+			ContentTilesSetupCount=fm->GetTileCache().GetSetupCount();
+			AddWakeUpSignal(fm->GetTileCache().GetTileSignal());
+		}
+	}
 	emFilePanel::SetFileModel(fileModel,updateFileModel);
 }
 
@@ -83,10 +98,15 @@ bool emSvgFilePanel::Cycle()
 {
 	if (IsSignaled(GetVirFileStateSignal())) {
 		InvalidateControlPanel(); //??? very cheap solution, but okay for now.
-		ClearSvgDisplay();
+		ResetContent();
 	}
 
-	UpdateSvgDisplay(false);
+	UpdateContent();
+
+	if (IsSignaled(IconTimer.GetSignal()) && ContentMissing>0 && !ShowIcon) {
+		ShowIcon=true;
+		InvalidatePainting();
+	}
 
 	return emFilePanel::Cycle();
 }
@@ -94,12 +114,26 @@ bool emSvgFilePanel::Cycle()
 
 void emSvgFilePanel::Notice(NoticeFlags flags)
 {
+	emSvgFileModel * fm;
+	int i;
+
 	if (flags&NF_VIEWING_CHANGED) {
-		UpdateSvgDisplay(true);
+		ContentUpToDate=false;
+		UpdateContent();
 	}
 	if (flags&NF_UPDATE_PRIORITY_CHANGED) {
-		if (RenderJob) {
-			RenderJob->SetPriority(GetUpdatePriority());
+		fm=(emSvgFileModel*)GetFileModel();
+		if (
+			fm &&
+			ContentTilesSetupCount==fm->GetTileCache().GetSetupCount()
+		) {
+			for (i=0; i<ContentTiles.GetCount(); i++) {
+				fm->GetTileCache().SetTilePriority(
+					0,ContentTiles[i].Level,
+					ContentTiles[i].X,ContentTiles[i].Y,
+					GetUpdatePriority()
+				);
+			}
 		}
 	}
 	emFilePanel::Notice(flags);
@@ -122,9 +156,7 @@ bool emSvgFilePanel::IsOpaque() const
 
 void emSvgFilePanel::Paint(const emPainter & painter, emColor canvasColor) const
 {
-	static const emColor RENDER_COLOR=emColor(0xEEEEFFFF);
-	emSvgFileModel * fm;
-	double fw,fh,ox,oy,ow,oh,sx,sy,sw,sh,ix,iy,iw,ih,t;
+	double ox,oy,ow,oh,ix,iy,iw,ih,t;
 	emColor c;
 
 	if (!IsVFSGood()) {
@@ -166,56 +198,8 @@ void emSvgFilePanel::Paint(const emPainter & painter, emColor canvasColor) const
 
 	GetOutputRect(&ox,&oy,&ow,&oh);
 
-	if (Img.IsEmpty()) {
-		painter.PaintRect(
-			ox,oy,ow,oh,
-			RENDER_COLOR,
-			canvasColor
-		);
-		canvasColor=RENDER_COLOR;
-	}
-	else {
-		fm=(emSvgFileModel*)GetFileModel();
-		fw=fm->GetWidth();
-		fh=fm->GetHeight();
-		sx=ox+SrcX*ow/fw;
-		sy=oy+SrcY*oh/fh;
-		sw=SrcW*ow/fw;
-		sh=SrcH*oh/fh;
-		emPainter(
-			painter,
-			painter.GetOriginX()+ox*painter.GetScaleX(),
-			painter.GetOriginY()+oy*painter.GetScaleY(),
-			painter.GetOriginX()+(ox+ow)*painter.GetScaleX(),
-			painter.GetOriginY()+(oy+oh)*painter.GetScaleY()
-		).PaintImage(
-			sx,sy,sw,sh,
-			Img,
-			255,
-			canvasColor
-		);
-		if (sy>oy) painter.PaintRect(
-			ox,oy,ow,sy-oy,
-			RENDER_COLOR,
-			canvasColor
-		);
-		if (sx>ox) painter.PaintRect(
-			ox,emMax(sy,oy),sx-ox,emMin(sy+sh,oy+oh)-emMax(sy,oy),
-			RENDER_COLOR,
-			canvasColor
-		);
-		if (sx+sw<ox+ow) painter.PaintRect(
-			sx+sw,emMax(sy,oy),ox+ow-sx-sw,emMin(sy+sh,oy+oh)-emMax(sy,oy),
-			RENDER_COLOR,
-			canvasColor
-		);
-		if (sy+sh<oy+oh) painter.PaintRect(
-			ox,sy+sh,ow,oy+oh-sy-sh,
-			RENDER_COLOR,
-			canvasColor
-		);
-		canvasColor=0;
-	}
+	PaintContent(painter,ox,oy,ow,oh,canvasColor);
+	canvasColor=0;
 
 	if (ShowIcon) {
 		iw=ViewToPanelDeltaX(RenderIcon.GetWidth());
@@ -331,141 +315,300 @@ void emSvgFilePanel::GetOutputRect(
 }
 
 
-void emSvgFilePanel::ClearSvgDisplay()
+
+
+void emSvgFilePanel::ResetContent()
 {
-	if (RenderJob) {
-		ServerModel->AbortJob(*RenderJob);
-		RenderJob=NULL;
+	emSvgFileModel * fm;
+	int i;
+
+	fm=(emSvgFileModel*)GetFileModel();
+	if (fm && ContentTilesSetupCount==fm->GetTileCache().GetSetupCount()) {
+		for (i=0; i<ContentTiles.GetCount(); i++) {
+			fm->GetTileCache().ReleaseTile(
+				0,ContentTiles[i].Level,
+				ContentTiles[i].X,ContentTiles[i].Y
+			);
+		}
 	}
-	if (!Img.IsEmpty()) {
-		Img.Clear();
+	ContentTiles.Clear();
+	if (fm) ContentTilesSetupCount=fm->GetTileCache().GetSetupCount();
+	if (ContentVisible) {
+		ContentVisible=false;
 		InvalidatePainting();
 	}
 	if (!RenderError.IsEmpty()) {
 		RenderError.Clear();
 		InvalidatePainting();
 	}
-	JobUpToDate=false;
+	ContentUpToDate=false;
+	ContentMissing=0;
 	IconTimer.Stop(true);
-	ShowIcon=false;
+	if (ShowIcon) {
+		ShowIcon=false;
+		InvalidatePainting();
+	}
 }
 
 
-void emSvgFilePanel::UpdateSvgDisplay(bool viewingChanged)
+void emSvgFilePanel::UpdateContent()
 {
 	emSvgFileModel * fm;
-	double fw,fh,ox,oy,ow,oh,ix,iy,iw,ih,sx,sy,sw,sh,qx1,qx2,qy1,qy2,q;
-	emUInt64 tm,dt;
-
-	if (!IsVFSGood()) return;
-	if (!RenderError.IsEmpty()) return;
-	if (!IsViewed()) return;
-
-	if (JobUpToDate) JobDelayStartTime=emGetClockMS();
-	if (viewingChanged) JobUpToDate=false;
-
-	if (RenderJob) {
-		switch (RenderJob->GetState()) {
-		case emJob::ST_WAITING:
-		case emJob::ST_RUNNING:
-			if (!ShowIcon && !IconTimer.IsRunning()) {
-				ShowIcon=true;
-				InvalidatePainting();
-			}
+	emArray<ContentTile> tiles;
+	ContentTile * ct;
+	const emString * err;
+	emString errText;
+	double fw,fh,ox,oy,ow,oh,x1,y1,x2,y2,f;
+	emInt64 tx,ty,tx1,ty1,tx2,ty2,cx,cy;
+	int level,minLevel,l,i,j,missing;
+
+	if (!IsVFSGood() || !IsViewed()) {
+		ResetContent();
+		return;
+	}
+
+	fm=(emSvgFileModel*)GetFileModel();
+	emSvgTileCache & cache=fm->GetTileCache();
+
+	if (!ContentUpToDate) {
+		fw=fm->GetWidth();
+		fh=fm->GetHeight();
+		GetOutputRect(&ox,&oy,&ow,&oh);
+		ox=PanelToViewX(ox);
+		oy=PanelToViewY(oy);
+		ow=PanelToViewDeltaX(ow);
+		oh=PanelToViewDeltaY(oh);
+		x1=emMax(GetClipX1(),ox);
+		y1=emMax(GetClipY1(),oy);
+		x2=emMin(GetClipX2(),ox+ow);
+		y2=emMin(GetClipY2(),oy+oh);
+		if (x2-x1<1.0 || y2-y1<1.0 || fw<=0.0 || fh<=0.0) {
+			ResetContent();
+			ContentUpToDate=true;
 			return;
-		case emJob::ST_SUCCESS:
-			SrcX=RenderJob->GetSrcX();
-			SrcY=RenderJob->GetSrcY();
-			SrcW=RenderJob->GetSrcWidth();
-			SrcH=RenderJob->GetSrcHeight();
-			Img=RenderJob->GetImage();
-			RenderJob=NULL;
-			if (JobUpToDate) {
-				IconTimer.Stop(true);
-				ShowIcon=false;
-			}
-			JobDelayStartTime=emGetClockMS();
-			InvalidatePainting();
-			break;
-		default:
-			if (RenderJob->GetState()==emJob::ST_ERROR) {
-				RenderError=RenderJob->GetErrorText();
-				if (RenderError.IsEmpty()) RenderError="unknown error";
+		}
+
+		level=emSvgTileCache::GetLevel(emMax(ow/fw,oh/fh));
+		f=emSvgTileCache::GetScale(level)/emSvgTileCache::TILE_SIZE;
+		tx1=(emInt64)floor((x1-ox)*fw/ow*f);
+		ty1=(emInt64)floor((y1-oy)*fh/oh*f);
+		tx2=(emInt64)ceil((x2-ox)*fw/ow*f);
+		ty2=(emInt64)ceil((y2-oy)*fh/oh*f);
+		tx1=emMax(tx1,(emInt64)0);
+		ty1=emMax(ty1,(emInt64)0);
+		tx2=emMin(tx2,cache.GetTileCountX(0,level));
+		ty2=emMin(ty2,cache.GetTileCountY(0,level));
+
+		// The visible tiles, and the cached tiles of the nearest lower
+		// level in place of missing ones.
+		tiles.SetTuningLevel(4);
+		minLevel=emMax(
+			level-(int)MAX_FALLBACK_LEVELS,
+			(int)emSvgTileCache::MIN_LEVEL
+		);
+		for (ty=ty1; ty<ty2; ty++) {
+			for (tx=tx1; tx<tx2; tx++) {
+				tiles.AddNew();
+				ct=&tiles.GetWritable(tiles.GetCount()-1);
+				ct->Level=level;
+				ct->X=tx;
+				ct->Y=ty;
+				if (cache.GetTileImage(0,level,tx,ty)) continue;
+				for (l=level-1; l>=minLevel; l--) {
+					cx=tx>>(level-l);
+					cy=ty>>(level-l);
+					if (!cache.GetTileImage(0,l,cx,cy)) continue;
+					for (j=tiles.GetCount()-1; j>=0; j--) {
+						if (
+							tiles[j].Level==l && tiles[j].X==cx &&
+							tiles[j].Y==cy
+						) break;
+					}
+					if (j<0) {
+						tiles.AddNew();
+						ct=&tiles.GetWritable(tiles.GetCount()-1);
+						ct->Level=l;
+						ct->X=cx;
+						ct->Y=cy;
+					}
+					break;
+				}
 			}
-			else {
-				RenderError="Aborted";
+		}
+
+		// Request before releasing, so that tiles which are still
+		// needed are not dropped in between.
+		for (i=0; i<tiles.GetCount(); i++) {
+			cache.RequestTile(
+				0,tiles[i].Level,tiles[i].X,tiles[i].Y,
+				GetUpdatePriority()
+			);
+		}
+		if (ContentTilesSetupCount==cache.GetSetupCount()) {
+			for (i=0; i<ContentTiles.GetCount(); i++) {
+				cache.ReleaseTile(
+					0,ContentTiles[i].Level,
+					ContentTiles[i].X,ContentTiles[i].Y
+				);
 			}
-			RenderJob=NULL;
-			Img.Clear();
-			JobUpToDate=false;
-			IconTimer.Stop(true);
+		}
+		ContentTiles=tiles;
+		ContentTilesSetupCount=cache.GetSetupCount();
+		ContentLevel=level;
+		ContentVisible=true;
+		ContentUpToDate=true;
+		ContentMissing=-1;
+		InvalidatePainting();
+	}
+
+	if (!ContentVisible) return;
+
+	missing=0;
+	for (i=0; i<ContentTiles.GetCount(); i++) {
+		ct=&ContentTiles.GetWritable(i);
+		if (ct->Level!=ContentLevel) continue;
+		if (cache.GetTileImage(0,ct->Level,ct->X,ct->Y)) continue;
+		err=cache.GetTileError(0,ct->Level,ct->X,ct->Y);
+		if (err) {
+			if (errText.IsEmpty()) errText=*err;
+			continue;
+		}
+		missing++;
+	}
+	if (ContentMissing!=missing) {
+		if (missing>0 && ContentMissing<=0 && !ShowIcon) {
+			IconTimer.Start(500);
+		}
+		ContentMissing=missing;
+		InvalidatePainting();
+	}
+	if (missing<=0) {
+		IconTimer.Stop(true);
+		if (ShowIcon) {
 			ShowIcon=false;
 			InvalidatePainting();
-			return;
 		}
 	}
+	if (RenderError!=errText) {
+		RenderError=errText;
+		InvalidatePainting();
+	}
+}
 
-	if (JobUpToDate) return;
 
-	fm=(emSvgFileModel*)GetFileModel();
+void emSvgFilePanel::PaintContent(
+	const emPainter & painter, double ox, double oy, double ow, double oh,
+	emColor canvasColor
+) const
+{
+	static const emColor RENDER_COLOR=emColor(0xEEEEFFFF);
+	const emSvgTileCache * cache;
+	const emSvgFileModel * fm;
+	const emImage * img;
+	double fw,fh,sx,sy,tw,th,x1,y1,x2,y2,f,cw,ch;
+	emInt64 tx,ty,tx1,ty1,tx2,ty2,cx,cy;
+	int l,minLevel;
+	bool complete;
+
+	fm=(const emSvgFileModel*)GetFileModel();
+	cache=&fm->GetTileCache();
+
+	if (
+		!ContentVisible ||
+		ContentTilesSetupCount!=cache->GetSetupCount()
+	) {
+		painter.PaintRect(ox,oy,ow,oh,RENDER_COLOR,canvasColor);
+		return;
+	}
+
+	// The tiles are painted with a painter which is clipped to the output
+	// rectangle, and which has its origin at the top-left corner of it.
+	emPainter p(
+		painter,
+		painter.GetOriginX()+ox*painter.GetScaleX(),
+		painter.GetOriginY()+oy*painter.GetScaleY(),
+		painter.GetOriginX()+(ox+ow)*painter.GetScaleX(),
+		painter.GetOriginY()+(oy+oh)*painter.GetScaleY(),
+		painter.GetOriginX()+ox*painter.GetScaleX(),
+		painter.GetOriginY()+oy*painter.GetScaleY(),
+		painter.GetScaleX(),
+		painter.GetScaleY()
+	);
+
+	// Output coordinates per pixel of the tiles, and of a whole tile.
 	fw=fm->GetWidth();
 	fh=fm->GetHeight();
-
-	GetOutputRect(&ox,&oy,&ow,&oh);
-	ox=PanelToViewX(ox);
-	oy=PanelToViewY(oy);
-	ow=PanelToViewDeltaX(ow);
-	oh=PanelToViewDeltaY(oh);
-
-	ix=floor(emMax(GetClipX1(),ox));
-	iy=floor(emMax(GetClipY1(),oy));
-	iw=ceil(emMin(GetClipX2(),ox+ow))-ix;
-	ih=ceil(emMin(GetClipY2(),oy+oh))-iy;
-
-	sx=(ix-ox)*fw/ow;
-	sy=(iy-oy)*fh/oh;
-	sw=iw*fw/ow;
-	sh=ih*fh/oh;
-
-	if (iw<1.0 || ih<1.0) {
-		Img.Clear();
-		SrcX=sx;
-		SrcY=sy;
-		SrcW=sw;
-		SrcH=sh;
-		InvalidatePainting();
-		JobUpToDate=true;
-		return;
+	f=emSvgTileCache::GetScale(ContentLevel);
+	sx=ow/(fw*f);
+	sy=oh/(fh*f);
+	tw=sx*emSvgTileCache::TILE_SIZE;
+	th=sy*emSvgTileCache::TILE_SIZE;
+
+	x1=emMax(p.GetUserClipX1(),0.0);
+	y1=emMax(p.GetUserClipY1(),0.0);
+	x2=emMin(p.GetUserClipX2(),ow);
+	y2=emMin(p.GetUserClipY2(),oh);
+	if (x1>=x2 || y1>=y2) return;
+	tx1=emMax((emInt64)floor(x1/tw),(emInt64)0);
+	ty1=emMax((emInt64)floor(y1/th),(emInt64)0);
+	tx2=emMin((emInt64)ceil(x2/tw),cache->GetTileCountX(0,ContentLevel));
+	ty2=emMin((emInt64)ceil(y2/th),cache->GetTileCountY(0,ContentLevel));
+
+	complete=true;
+	for (ty=ty1; ty<ty2 && complete; ty++) {
+		for (tx=tx1; tx<tx2; tx++) {
+			if (!cache->GetTileImage(0,ContentLevel,tx,ty)) {
+				complete=false;
+				break;
+			}
+		}
 	}
 
-	if (!Img.IsEmpty()) {
-		qx1=emMax(SrcX,sx);
-		qx2=emMin(SrcX+SrcW,sx+sw);
-		qy1=emMax(SrcY,sy);
-		qy2=emMin(SrcY+SrcH,sy+sh);
-		if (qx2<qx1) qx2=qx1;
-		if (qy2<qy1) qy2=qy1;
-		q=(qx2-qx1)*(qy2-qy1)/(sw*sh);
-		q=(q-0.9)*10.0;
-		if (q>0.0 && Img.GetWidth()/SrcW>0.9*iw/sw) {
-			dt=(emUInt64)(q*q*500.0+0.5);
-			tm=emGetClockMS();
-			if (JobDelayStartTime+dt>tm) {
-				JobDelayTimer.Start(JobDelayStartTime+dt-tm);
-				return;
+	if (!complete) {
+		// Paint the background, and over it the tiles of lower levels
+		// in place of the missing tiles.
+		p.PaintRect(0.0,0.0,ow,oh,RENDER_COLOR,canvasColor);
+		canvasColor=RENDER_COLOR;
+		minLevel=emMax(
+			ContentLevel-(int)MAX_FALLBACK_LEVELS,
+			(int)emSvgTileCache::MIN_LEVEL
+		);
+		for (ty=ty1; ty<ty2; ty++) {
+			for (tx=tx1; tx<tx2; tx++) {
+				if (cache->GetTileImage(0,ContentLevel,tx,ty)) continue;
+				for (l=ContentLevel-1; l>=minLevel; l--) {
+					cx=tx>>(ContentLevel-l);
+					cy=ty>>(ContentLevel-l);
+					img=cache->GetTileImage(0,l,cx,cy);
+					if (!img) continue;
+					cw=tw*ldexp(1.0,ContentLevel-l);
+					ch=th*ldexp(1.0,ContentLevel-l);
+					emPainter(
+						p,
+						p.GetOriginX()+tx*tw*p.GetScaleX(),
+						p.GetOriginY()+ty*th*p.GetScaleY(),
+						p.GetOriginX()+(tx+1)*tw*p.GetScaleX(),
+						p.GetOriginY()+(ty+1)*th*p.GetScaleY()
+					).PaintImage(
+						cx*cw,cy*ch,
+						cw*img->GetWidth()/emSvgTileCache::TILE_SIZE,
+						ch*img->GetHeight()/emSvgTileCache::TILE_SIZE,
+						*img,255,canvasColor
+					);
+					break;
+				}
 			}
 		}
 	}
 
-	RenderJob=new emSvgServerModel::RenderJob(
-		fm->GetSvgInstance(),
-		sx,sy,sw,sh,
-		emColor(0xffffffff),
-		(int)(iw+0.5),(int)(ih+0.5),
-		GetUpdatePriority()
-	);
-	ServerModel->EnqueueJob(*RenderJob);
-	AddWakeUpSignal(RenderJob->GetStateSignal());
-	if (!ShowIcon) IconTimer.Start(500);
-	JobUpToDate=true;
+	for (ty=ty1; ty<ty2; ty++) {
+		for (tx=tx1; tx<tx2; tx++) {
+			img=cache->GetTileImage(0,ContentLevel,tx,ty);
+			if (!img) continue;
+			p.PaintImage(
+				tx*tw,ty*th,img->GetWidth()*sx,img->GetHeight()*sy,
+				*img,255,canvasColor
+			);
+		}
+	}
 }
@@ -20,12 +20,6 @@
 
 #include <emSvg/emSvgServerModel.h>
 #include <emCore/emInstallInfo.h>
-#if defined(_WIN32) || defined(__CYGWIN__)
-#	include <emCore/emThread.h>
-#	include <windows.h>
-#else
-#	include <sys/shm.h>
-#endif
 
 
 emRef<emSvgServerModel> emSvgServerModel::Acquire(emRootContext & rootContext)
@@ -36,25 +30,43 @@ emRef<emSvgServerModel> emSvgServerModel::Acquire(emRootContext & rootContext)
 
 emSvgServerModel::SvgInstance::~SvgInstance()
 {
-	if (InstanceId!=-1 && SvgServerModel) {
-		emRef<CloseJob> job=new CloseJob(ProcRunId,InstanceId);
-		SvgServerModel->EnqueueJob(*job);
+	const emServerProcPool::InstanceMap::Entry * e;
+	int i;
+
+	if (SvgServerModel) {
+		for (i=0; i<Instances.Entries.GetCount(); i++) {
+			e=&Instances.Entries[i];
+			if (e->InstanceId>=0) {
+				emRef<CloseJob> job=new CloseJob(
+					e->ProcIndex,e->ProcRunId,e->InstanceId
+				);
+				SvgServerModel->EnqueueJob(*job);
+			}
+		}
 	}
 }
 
 
-emSvgServerModel::SvgInstance::SvgInstance(emSvgServerModel & svgServerModel)
+emSvgServerModel::SvgInstance::SvgInstance(
+	emSvgServerModel & svgServerModel, const emString & filePath
+)
 	: SvgServerModel(&svgServerModel),
-	ProcRunId(0),
-	InstanceId(-1),
+	FilePath(filePath),
 	Width(0.0),
 	Height(0.0)
 {
 }
 
 
-emSvgServerModel::OpenJob::OpenJob(const emString & filePath, double priority)
+emSvgServerModel::SvgJobBase::SvgJobBase(double priority)
 	: emJob(priority),
+	ProcIndex(-1)
+{
+}
+
+
+emSvgServerModel::OpenJob::OpenJob(const emString & filePath, double priority)
+	: SvgJobBase(priority),
 	FilePath(filePath)
 {
 }
@@ -65,7 +77,7 @@ emSvgServerModel::RenderJob::RenderJob(
 	double srcWidth, double srcHeight, emColor bgColor,
 	int tgtWidth, int tgtHeight, double priority
 )
-	: emJob(priority),
+	: SvgJobBase(priority),
 	SvgInst(&svgInstance),
 	SrcX(srcX),
 	SrcY(srcY),
@@ -96,101 +108,53 @@ void emSvgServerModel::AbortJob(emJob & job)
 
 void emSvgServerModel::Poll(unsigned maxMillisecs)
 {
-	emUInt64 endTime,now;
-	int flags;
+	emUInt64 endTime;
+	int i;
+	bool progress;
 
 	endTime=emGetClockMS()+maxMillisecs;
 
-	if (
-		JobQueue.IsEmpty() &&
-		ProcSvgInstCount==0 &&
-		Process.IsRunning() &&
-		!ProcTerminating &&
-		emGetClockMS()-ProcIdleClock>=5000
-	) {
-		emDLog("emSvgServerModel: Terminating server process");
-		Process.CloseWriting();
-		ProcTerminating=true;
-	}
-
-	if (ProcTerminating) {
-		if (!Process.WaitForTermination(maxMillisecs)) return;
-		ProcTerminating=false;
-	}
+	UpdateProcLoads();
+	Pool.TerminateIdleProcs();
 
 	if (JobQueue.IsEmpty()) return;
 
-	ProcIdleClock=emGetClockMS();
-
-	try {
-		if (!Process.IsRunning()) {
-			ProcRunId++;
-			ProcSvgInstCount=0;
-			ReadBuf.Clear();
-			WriteBuf.Clear();
-			emDLog("emSvgServerModel: Starting server process");
-			Process.TryStart(
-				emArray<emString>(
-					emGetChildPath(
-						emGetInstallPath(EM_IDT_LIB,"emSvg","emSvg"),
-						"emSvgServerProc"
-					)
-				),
-				emArray<emString>(),
-				NULL,
-				emProcess::SF_PIPE_STDIN|
-				emProcess::SF_PIPE_STDOUT|
-				emProcess::SF_SHARE_STDERR|
-				emProcess::SF_NO_WINDOW
-			);
-			if (ShmSize<MinShmSize) {
-				TryAllocShm(MinShmSize);
-			}
-			TryWriteAttachShm();
-		}
-		TryStartJobs();
-		for (;;) {
-			while (TryProcIO()) {
-				TryFinishJobs();
-				TryStartJobs();
+	TryStartJobs();
+	for (;;) {
+		do {
+			progress=false;
+			for (i=0; i<Pool.GetProcCount(); i++) {
+				try {
+					while (Pool.TryIO(i)) {
+						TryFinishJobs(i);
+						progress=true;
+					}
+				}
+				catch (const emException & exception) {
+					FailProc(i,exception.GetText());
+					progress=true;
+				}
 			}
-			if (!JobQueue.GetFirstRunningJob() && WriteBuf.IsEmpty()) break;
-			now=emGetClockMS();
-			if (now>=endTime) break;
-			flags=emProcess::WF_WAIT_STDOUT;
-			if (!WriteBuf.IsEmpty()) flags|=emProcess::WF_WAIT_STDIN;
-			Process.WaitPipes(flags,(unsigned)(endTime-now));
-		}
-	}
-	catch (const emException & exception) {
-		if (!JobQueue.GetFirstRunningJob()) JobQueue.FailAllJobs(exception.GetText());
-		else JobQueue.FailAllRunningJobs(exception.GetText());
-		Process.SendTerminationSignal();
-		ProcTerminating=true;
+			if (progress) TryStartJobs();
+		} while (progress);
+
+		UpdateProcLoads();
+		if (!Pool.WaitForBusyProcs(endTime)) break;
 	}
 }
 
-
 emSvgServerModel::emSvgServerModel(emContext & context, const emString & name)
 	: emModel(context,name),
-	JobQueue(GetScheduler())
+	JobQueue(GetScheduler()),
+	Pool(
+		GetRootContext(),
+		emGetChildPath(
+			emGetInstallPath(EM_IDT_LIB,"emSvg","emSvg"),
+			"emSvgServerProc"
+		),
+		"SVG"
+	)
 {
-	ProcRunId=0;
-	ProcSvgInstCount=0;
-	ProcIdleClock=0;
-	ProcTerminating=false;
-	ReadBuf.SetTuningLevel(4);
-	WriteBuf.SetTuningLevel(4);
-	ShmSize=0;
-#if defined(_WIN32) || defined(__CYGWIN__)
-	ShmId[0]=0;
-	ShmHdl=NULL;
-#else
-	ShmId=-1;
-#endif
-	ShmPtr=NULL;
-	ShmAllocBegin=0;
-	ShmAllocEnd=0;
 	SetMinCommonLifetime(10);
 	SetEnginePriority(LOW_PRIORITY);
 }
@@ -198,8 +162,6 @@ emSvgServerModel::emSvgServerModel(emContext & context, const emString & name)
 
 emSvgServerModel::~emSvgServerModel()
 {
-	Process.Terminate();
-	FreeShm();
 }
 
 
@@ -211,49 +173,98 @@ bool emSvgServerModel::Cycle()
 
 	Poll(IsTimeSliceAtEnd()?0:10);
 
-	if (
-		!JobQueue.IsEmpty() || !WriteBuf.IsEmpty() ||
-		(Process.IsRunning() && !ProcSvgInstCount)
-	) busy=true;
+	if (!JobQueue.IsEmpty() || Pool.IsBusy()) busy=true;
 
 	return busy;
 }
 
 
-emSvgServerModel::CloseJob::CloseJob(emUInt64 procRunId, int instanceId)
-	: emJob(1E200),
+emSvgServerModel::ReopenJob::ReopenJob(SvgInstance & svgInstance)
+	: SvgJobBase(0.0),
+	SvgInst(&svgInstance)
+{
+}
+
+
+emSvgServerModel::CloseJob::CloseJob(
+	int procIndex, emUInt64 procRunId, int instanceId
+)
+	: SvgJobBase(1E200),
 	ProcRunId(procRunId),
 	InstanceId(instanceId)
 {
+	ProcIndex=procIndex;
 }
 
 
 void emSvgServerModel::TryStartJobs()
 {
-	emJob * job;
+	SvgJobBase * job, * next;
+	emString err;
+	int i;
 
+	UpdateProcLoads();
 	JobQueue.UpdateSortingOfWaitingJobs();
-
-	while ((job=JobQueue.GetFirstWaitingJob())!=NULL) {
+	for (job=(SvgJobBase*)JobQueue.GetFirstWaitingJob(); job; job=next) {
+		next=(SvgJobBase*)job->GetNext();
+		if (CloseJob * closeJob=dynamic_cast<CloseJob*>(job)) {
+			StartCloseJob(*closeJob);
+			continue;
+		}
+		err.Clear();
+		i=AssignProc(*job,err);
+		if (i<0) {
+			if (!err.IsEmpty()) JobQueue.FailJob(*job,err);
+			continue;
+		}
 		if (OpenJob * openJob=dynamic_cast<OpenJob*>(job)) {
-			TryStartOpenJob(*openJob);
+			StartOpenJob(*openJob,i);
 		}
 		else if (RenderJob * renderJob=dynamic_cast<RenderJob*>(job)) {
-			if (!TryStartRenderJob(*renderJob)) break;
-		}
-		else if (CloseJob * closeJob=dynamic_cast<CloseJob*>(job)) {
-			TryStartCloseJob(*closeJob);
+			try {
+				if (!TryStartRenderJob(*renderJob,i)) continue;
+			}
+			catch (const emException & exception) {
+				JobQueue.FailJob(*job,exception.GetText());
+				FailProc(i,exception.GetText());
+				continue;
+			}
 		}
 		else {
 			JobQueue.FailJob(*job,"Unsupported job class");
+			continue;
 		}
+		Pool.AddLoad(i,true);
+	}
+
+	if (!Pool.GetStartError().IsEmpty()) {
+		// Without any process, the jobs would wait forever.
+		if (!Pool.IsAnyProcRunning()) JobQueue.FailAllJobs(Pool.GetStartError());
+		Pool.ClearStartError();
 	}
 }
 
 
-void emSvgServerModel::TryStartOpenJob(OpenJob & openJob)
+int emSvgServerModel::AssignProc(SvgJobBase & job, emString & err)
 {
-	WriteLineToProc(
+	RenderJob * renderJob;
+	int i,openProc;
+	bool failed;
+
+	renderJob=dynamic_cast<RenderJob*>(&job);
+	i=Pool.AssignProc(
+		renderJob ? &renderJob->SvgInst->Instances : NULL,true,
+		&openProc,&failed
+	);
+	if (openProc>=0) StartReopenJob(*renderJob->SvgInst,openProc);
+	if (failed) err="Failed to reopen SVG document";
+	return i;
+}
+
+void emSvgServerModel::StartOpenJob(OpenJob & openJob, int procIndex)
+{
+	openJob.ProcIndex=procIndex;
+	Pool.GetProc(procIndex).WriteLine(
 		emString::Format(
 			"open %s",
 			openJob.FilePath.Get()
@@ -263,38 +274,37 @@ void emSvgServerModel::TryStartOpenJob(OpenJob & openJob)
 }
 
 
-bool emSvgServerModel::TryStartRenderJob(RenderJob & renderJob)
+void emSvgServerModel::StartReopenJob(SvgInstance & inst, int procIndex)
+{
+	emRef<ReopenJob> job;
+
+	job=new ReopenJob(inst);
+	job->ProcIndex=procIndex;
+	Pool.SetInstanceId(inst.Instances,procIndex,emServerProcPool::INST_OPENING);
+	JobQueue.StartJob(*job);
+	Pool.GetProc(procIndex).WriteLine(
+		emString::Format(
+			"open %s",
+			inst.FilePath.Get()
+		)
+	);
+	Pool.AddLoad(procIndex,true);
+}
+
+
+bool emSvgServerModel::TryStartRenderJob(RenderJob & renderJob, int procIndex)
 {
 	emByte * t, * e;
 	emUInt32 u;
-	int size;
-
-	if (renderJob.SvgInst->ProcRunId!=ProcRunId) {
-		JobQueue.FailJob(renderJob,"SVG server process restarted");
-		return true;
-	}
+	int size,offset;
 
 	size=renderJob.TgtW*renderJob.TgtH*4;
-	if (!JobQueue.GetFirstRunningJob() || ShmAllocBegin==ShmAllocEnd) {
-		if (size>ShmSize) {
-			if (JobQueue.GetFirstRunningJob()) return false;
-			TryAllocShm(size);
-			TryWriteAttachShm();
-		}
-		ShmAllocBegin=0;
-		ShmAllocEnd=0;
-	}
-	else if (ShmAllocEnd<ShmAllocBegin) {
-		if (ShmAllocEnd+size>=ShmAllocBegin) return false;
-	}
-	else if (ShmAllocEnd+size>ShmSize) {
-		if (size>=ShmAllocBegin) return false;
-		ShmAllocEnd=0;
-	}
-	renderJob.ShmOffset=ShmAllocEnd;
-	ShmAllocEnd+=size;
+	offset=Pool.TryAllocShmRange(procIndex,size);
+	if (offset<0) return false;
+	renderJob.ShmOffset=offset;
 
-	t=ShmPtr+renderJob.ShmOffset;
+	emServerProcPool::Proc & proc=Pool.GetProc(procIndex);
+	t=proc.ShmPtr+offset;
 	e=t+size;
 	u=renderJob.BgColor.Get()>>8;
 	while (t<e) {
@@ -302,9 +312,9 @@ bool emSvgServerModel::TryStartRenderJob(RenderJob & renderJob)
 		t+=4;
 	}
 
-	WriteLineToProc(emString::Format(
+	proc.WriteLine(emString::Format(
 		"render %d %.16g %.16g %.16g %.16g %d %d %d",
-		renderJob.SvgInst->InstanceId,
+		Pool.GetInstanceId(renderJob.SvgInst->Instances,procIndex),
 		renderJob.SrcX,
 		renderJob.SrcY,
 		renderJob.SrcWidth,
@@ -313,35 +323,38 @@ bool emSvgServerModel::TryStartRenderJob(RenderJob & renderJob)
 		renderJob.TgtW,
 		renderJob.TgtH
 	));
+	renderJob.ProcIndex=procIndex;
 	JobQueue.StartJob(renderJob);
 	return true;
 }
 
 
-void emSvgServerModel::TryStartCloseJob(CloseJob & closeJob)
+void emSvgServerModel::StartCloseJob(CloseJob & closeJob)
 {
-	if (closeJob.ProcRunId==ProcRunId) {
-		WriteLineToProc(emString::Format(
+	emServerProcPool::Proc & proc=Pool.GetProc(closeJob.ProcIndex);
+	if (closeJob.ProcRunId==proc.RunId) {
+		proc.WriteLine(emString::Format(
 			"close %d",
 			closeJob.InstanceId
 		));
-		ProcSvgInstCount--;
+		proc.InstanceCount--;
 	}
 	JobQueue.SucceedJob(closeJob);
 }
 
 
-void emSvgServerModel::TryFinishJobs()
+void emSvgServerModel::TryFinishJobs(int procIndex)
 {
 	emString cmd,args;
 	const char * p;
-	emJob * job;
+	SvgJobBase * job;
 	OpenJob * openJob;
+	ReopenJob * reopenJob;
 	RenderJob * renderJob;
 	int l;
 
 	for (;;) {
-		args=ReadLineFromProc();
+		args=Pool.GetProc(procIndex).ReadLine();
 		if (args.IsEmpty()) break;
 		p=strchr(args.Get(),' ');
 		if (p) {
@@ -354,9 +367,18 @@ void emSvgServerModel::TryFinishJobs()
 			args.Clear();
 		}
 
-		job=JobQueue.GetFirstRunningJob();
+		// The process answers in the order of the commands.
+		for (
+			job=(SvgJobBase*)JobQueue.GetFirstRunningJob();
+			job && job->ProcIndex!=procIndex;
+			job=(SvgJobBase*)job->GetNext()
+		);
 		if (job) {
 			if (cmd=="error:") {
+				reopenJob=dynamic_cast<ReopenJob*>(job);
+				if (reopenJob) {
+					Pool.SetOpenFailed(reopenJob->SvgInst->Instances,procIndex);
+				}
 				JobQueue.FailJob(*job,args);
 				continue;
 			}
@@ -366,6 +388,11 @@ void emSvgServerModel::TryFinishJobs()
 					TryFinishOpenJob(*openJob,args);
 					continue;
 				}
+				reopenJob=dynamic_cast<ReopenJob*>(job);
+				if (reopenJob) {
+					TryFinishReopenJob(*reopenJob,args);
+					continue;
+				}
 			}
 			if (cmd=="rendered") {
 				renderJob=dynamic_cast<RenderJob*>(job);
@@ -383,51 +410,33 @@ void emSvgServerModel::TryFinishJobs()
 
 void emSvgServerModel::TryFinishOpenJob(OpenJob & openJob, const char * args)
 {
-	int instId,pos,r;
-	double width,height;
-	emString title,desc,str;
 	emRef<SvgInstance> inst;
-	char c;
+	int instId;
 
-	pos=-1;
-	r=sscanf(args,"%d %lf %lf %n",&instId,&width,&height,&pos);
-	if (r<3 || pos<=0) {
-		throw emException("SVG server protocol error");
-	}
+	inst=new SvgInstance(*this,openJob.FilePath);
+	ParseOpenedArgs(
+		args,&instId,&inst->Width,&inst->Height,
+		&inst->Title,&inst->Description
+	);
+	Pool.SetInstanceId(inst->Instances,openJob.ProcIndex,instId);
 
-	args+=pos;
-	for (r=0; ; r++) {
-		do { c=*args++; } while (c && c!='"');
-		if (!c) break;
-		str.Clear();
-		for (;;) {
-			c=*args++;
-			if (!c || c=='"') break;
-			if (c=='\\') {
-				c=*args++;
-				if (!c) break;
-				if (c=='n') c='\n';
-				else if (c=='r') c='\r';
-				else if (c=='t') c='\t';
-			}
-			str+=c;
-		}
-		if (!r) title=str; else desc=str;
-		if (!c) break;
-	}
+	openJob.SvgInst=inst;
+	JobQueue.SucceedJob(openJob);
+}
 
-	ProcSvgInstCount++;
 
-	inst=new SvgInstance(*this);
-	inst->ProcRunId=ProcRunId;
-	inst->InstanceId=instId;
-	inst->Width=width;
-	inst->Height=height;
-	inst->Title=title;
-	inst->Description=desc;
+void emSvgServerModel::TryFinishReopenJob(
+	ReopenJob & reopenJob, const char * args
+)
+{
+	emString title,desc;
+	double width,height;
+	int instId;
 
-	openJob.SvgInst=inst;
-	JobQueue.SucceedJob(openJob);
+	// The document info has already been received by the OpenJob.
+	ParseOpenedArgs(args,&instId,&width,&height,&title,&desc);
+	Pool.SetInstanceId(reopenJob.SvgInst->Instances,reopenJob.ProcIndex,instId);
+	JobQueue.SucceedJob(reopenJob);
 }
 
 
@@ -438,10 +447,10 @@ void emSvgServerModel::TryFinishRenderJob(RenderJob & renderJob)
 	int size;
 
 	size=renderJob.TgtW*renderJob.TgtH*4;
-	ShmAllocBegin=renderJob.ShmOffset+size;
+	Pool.FreeShmRange(renderJob.ProcIndex,renderJob.ShmOffset,size);
 	if (renderJob.GetRefCount() > 1) {
 		renderJob.Image.Setup(renderJob.TgtW,renderJob.TgtH,3);
-		s=ShmPtr+renderJob.ShmOffset;
+		s=Pool.GetProc(renderJob.ProcIndex).ShmPtr+renderJob.ShmOffset;
 		e=s+size;
 		t=renderJob.Image.GetWritableMap();
 		while (s<e) {
@@ -457,193 +466,80 @@ void emSvgServerModel::TryFinishRenderJob(RenderJob & renderJob)
 }
 
 
-void emSvgServerModel::TryWriteAttachShm()
-{
-#if defined(_WIN32) || defined(__CYGWIN__)
-	WriteLineToProc(emString::Format("attachshm %s",ShmId));
-#else
-	WriteLineToProc(emString::Format("attachshm %d",ShmId));
-#endif
-}
-
-
-void emSvgServerModel::WriteLineToProc(const char * str)
-{
-	emDLog("emSvgServerModel: Sending: %s",str);
-	WriteBuf.Add(str,strlen(str));
-	WriteBuf.Add((char)'\n');
-}
-
-
-emString emSvgServerModel::ReadLineFromProc()
+void emSvgServerModel::ParseOpenedArgs(
+	const char * args, int * pInstanceId, double * pWidth, double * pHeight,
+	emString * pTitle, emString * pDesc
+)
 {
-	emString res;
-	char * p;
-	int l;
+	emString str;
+	int pos,r;
+	char c;
 
-	if (!ReadBuf.IsEmpty()) {
-		p=(char*)memchr(ReadBuf.Get(),'\n',ReadBuf.GetCount());
-		if (p) {
-			l=p-ReadBuf.Get();
-			res=emString(ReadBuf.Get(),l);
-			ReadBuf.Remove(0,l+1);
-		}
+	pos=-1;
+	r=sscanf(args,"%d %lf %lf %n",pInstanceId,pWidth,pHeight,&pos);
+	if (r<3 || pos<=0) {
+		throw emException("SVG server protocol error");
 	}
-	if (!res.IsEmpty()) emDLog("emSvgServerModel: Receiving: %s",res.Get());
-	return res;
-}
-
-
-bool emSvgServerModel::TryProcIO()
-{
-	char buf[256];
-	bool progress;
-	int r;
 
-	progress=false;
-
-	if (!WriteBuf.IsEmpty()) {
-		r=Process.TryWrite(WriteBuf.Get(),WriteBuf.GetCount());
-		if (r<0) throw emException("SVG server process died unexpectedly.");
-		if (r>0) {
-			WriteBuf.Remove(0,r);
-			progress=true;
+	pTitle->Clear();
+	pDesc->Clear();
+	args+=pos;
+	for (r=0; ; r++) {
+		do { c=*args++; } while (c && c!='"');
+		if (!c) break;
+		str.Clear();
+		for (;;) {
+			c=*args++;
+			if (!c || c=='"') break;
+			if (c=='\\') {
+				c=*args++;
+				if (!c) break;
+				if (c=='n') c='\n';
+				else if (c=='r') c='\r';
+				else if (c=='t') c='\t';
+			}
+			str+=c;
 		}
+		if (!r) *pTitle=str; else *pDesc=str;
+		if (!c) break;
 	}
-
-	for (;;) {
-		r=Process.TryRead(buf,sizeof(buf));
-		if (r<0) throw emException("SVG server process died unexpectedly.");
-		if (r==0) break;
-		ReadBuf.Add(buf,r);
-		progress=true;
-	}
-
-	return progress;
 }
 
 
-void emSvgServerModel::TryAllocShm(int size)
+void emSvgServerModel::FailProc(int procIndex, const emString & err)
 {
-	FreeShm();
-
-#if defined(_WIN32) || defined(__CYGWIN__)
-
-	static emThreadMiniMutex sharedCounterMutex;
-	static unsigned long sharedCounter=0;
-	unsigned long counter;
-
-	sharedCounterMutex.Lock();
-	counter=sharedCounter++;
-	sharedCounterMutex.Unlock();
-
-	sprintf(
-		ShmId,
-		"Local\\emSvg.%lX.%lX.%lX.%lX",
-		(unsigned long)GetCurrentProcessId(),
-		counter,
-		(unsigned long)GetTickCount(),
-		(unsigned long)emGetUInt64Random(0,0xffffffff) //???
-	);
-	emDLog("emSvgServerModel: ShmId=%s",ShmId);
+	SvgJobBase * job, * next;
+	ReopenJob * reopenJob;
 
-	SetLastError(ERROR_SUCCESS);
-	ShmHdl=CreateFileMapping(
-		INVALID_HANDLE_VALUE,NULL,PAGE_READWRITE|SEC_COMMIT,
-		0,size,ShmId
-	);
-	if (!ShmHdl || GetLastError()==ERROR_ALREADY_EXISTS) {
-		if (ShmHdl) {
-			CloseHandle(ShmHdl);
-			ShmHdl=NULL;
+	for (
+		job=(SvgJobBase*)JobQueue.GetFirstRunningJob();
+		job;
+		job=next
+	) {
+		next=(SvgJobBase*)job->GetNext();
+		if (job->ProcIndex!=procIndex) continue;
+		// Count it as a failure to reopen the document, if the
+		// process died while doing so.
+		reopenJob=dynamic_cast<ReopenJob*>(job);
+		if (reopenJob) {
+			Pool.SetOpenFailed(reopenJob->SvgInst->Instances,procIndex);
 		}
-		ShmId[0]=0;
-		throw emException(
-			"Failed to create shared memory segment: CreateFileMapping: %s",
-			emGetErrorText(GetLastError()).Get()
-		);
+		JobQueue.FailJob(*job,err);
 	}
-
-	ShmPtr=(emByte*)MapViewOfFile(ShmHdl,FILE_MAP_ALL_ACCESS,0,0,0);
-	if (!ShmPtr) {
-		CloseHandle(ShmHdl);
-		ShmHdl=NULL;
-		ShmId[0]=0;
-		throw emException(
-			"Failed to create shared memory segment: MapViewOfFile: %s",
-			emGetErrorText(GetLastError()).Get()
-		);
-	}
-
-#else
-
-	ShmId=shmget(IPC_PRIVATE,size,IPC_CREAT|0600);
-	if (ShmId==-1) {
-		throw emException(
-			"Failed to create shared memory segment: %s",
-			emGetErrorText(errno).Get()
-		);
-	}
-
-	ShmPtr=(emByte*)shmat(ShmId,NULL,0);
-	if (ShmPtr==(emByte*)-1) {
-		ShmPtr=NULL;
-		shmctl(ShmId,IPC_RMID,NULL);
-		ShmId=-1;
-		throw emException(
-			"Failed to attach shared memory segment: %s",
-			emGetErrorText(errno).Get()
-		);
-	}
-
-#if defined(__linux__)
-	if (shmctl(ShmId,IPC_RMID,NULL)!=0) {
-		emFatalError(
-			"emSvgServerModel: shmctl failed: %s",
-			emGetErrorText(errno).Get()
-		);
-	}
-#endif
-
-#endif
-
-	ShmSize=size;
+	Pool.AbandonProc(procIndex);
 }
 
 
-void emSvgServerModel::FreeShm()
+void emSvgServerModel::UpdateProcLoads()
 {
-#if defined(_WIN32) || defined(__CYGWIN__)
-	if (ShmPtr) {
-		UnmapViewOfFile(ShmPtr);
-		ShmPtr=NULL;
-	}
-	if (ShmHdl) {
-		CloseHandle(ShmHdl);
-		ShmHdl=NULL;
-	}
-	ShmId[0]=0;
-#else
-	if (ShmPtr) {
-		shmdt(ShmPtr);
-		ShmPtr=NULL;
-	}
-	if (ShmId!=-1) {
-#if !defined(__linux__)
-		if (shmctl(ShmId,IPC_RMID,NULL)!=0) {
-			emFatalError(
-				"emSvgServerModel: shmctl failed: %s",
-				emGetErrorText(errno).Get()
-			);
-		}
-#endif
-		ShmId=-1;
+	SvgJobBase * job;
+
+	Pool.ClearLoads();
+	for (
+		job=(SvgJobBase*)JobQueue.GetFirstRunningJob();
+		job;
+		job=(SvgJobBase*)job->GetNext()
+	) {
+		Pool.AddLoad(job->ProcIndex,true);
 	}
-#endif
-	ShmSize=0;
-	ShmAllocBegin=0;
-	ShmAllocEnd=0;
 }
-
-
-const int emSvgServerModel::MinShmSize=1000*1000*4;
@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+// emSvgTileCache.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emSvg/emSvgTileCache.h>
+
+
+emSvgTileCache::emSvgTileCache(emScheduler & scheduler)
+	: emTileCache(scheduler),
+	ServerModel(NULL),
+	SvgInstance(NULL)
+{
+}
+
+
+emSvgTileCache::~emSvgTileCache()
+{
+	Reset();
+}
+
+
+void emSvgTileCache::Setup(
+	emSvgServerModel & serverModel, emSvgServerModel::SvgInstance & svgInstance
+)
+{
+	Reset();
+	ServerModel=&serverModel;
+	SvgInstance=&svgInstance;
+}
+
+
+void emSvgTileCache::Reset()
+{
+	emTileCache::Reset();
+	ServerModel=NULL;
+	SvgInstance=NULL;
+}
+
+
+bool emSvgTileCache::GetPageSize(
+	int page, double * pWidth, double * pHeight
+) const
+{
+	if (!SvgInstance || page!=0) return false;
+	*pWidth=SvgInstance->GetWidth();
+	*pHeight=SvgInstance->GetHeight();
+	return true;
+}
+
+
+emRef<emJob> emSvgTileCache::StartTileJob(
+	int page, double srcX, double srcY, double srcWidth, double srcHeight,
+	int tgtWidth, int tgtHeight, double priority
+)
+{
+	emRef<emSvgServerModel::RenderJob> job;
+
+	if (!ServerModel || !SvgInstance) return NULL;
+	job=new emSvgServerModel::RenderJob(
+		*SvgInstance,srcX,srcY,srcWidth,srcHeight,
+		emColor(0xffffffff),tgtWidth,tgtHeight,priority
+	);
+	ServerModel->EnqueueJob(*job);
+	return emRef<emJob>(job.Get());
+}
+
+
+void emSvgTileCache::AbortTileJob(emJob & job)
+{
+	if (ServerModel) ServerModel->AbortJob(job);
+}
+
+
+const emImage & emSvgTileCache::GetTileJobImage(const emJob & job) const
+{
+	return ((const emSvgServerModel::RenderJob&)job).GetImage();
+}
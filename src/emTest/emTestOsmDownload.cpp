@@ -0,0 +1,510 @@
+//------------------------------------------------------------------------------
+// emTestOsmDownload.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+// Test for emOsmTileDownloader and its download helper process
+// emOsmDownloadProc, against a local HTTP/1.1 stand-in server which runs in a
+// thread of this program. The server serves "/tiles/<n>.png" with the body
+// "Tile <n>", holds back "/slow/..." until released, and answers anything else
+// with 404. It counts the connections and records the order of the tile
+// requests. The test checks that the tiles are downloaded over few kept-alive
+// connections and that the waiting jobs are started by priority. If the
+// helper is installed, it also checks that a failed download fails only its
+// own job and leaves no file, and that aborting a running download deletes
+// the partial file. Otherwise, the curl program is used, which has no such
+// per-file results.
+//------------------------------------------------------------------------------
+
+#include <emCore/emInstallInfo.h>
+#include <emCore/emScheduler.h>
+#include <emCore/emThread.h>
+#include <emCore/emTmpFile.h>
+#include <emOsm/emOsmTileDownloader.h>
+#if defined(_WIN32)
+#	include <winsock2.h>
+	typedef int socklen_t;
+#else
+#	include <arpa/inet.h>
+#	include <netinet/in.h>
+#	include <sys/select.h>
+#	include <sys/socket.h>
+#	include <unistd.h>
+#	define closesocket close
+	typedef int SOCKET;
+#	define INVALID_SOCKET (-1)
+#endif
+
+#define MY_ASSERT(c) \
+	if (!(c)) emFatalError("%s, %d: assertion failed: %s",__FILE__,__LINE__,#c)
+
+
+//------------------------------ HTTP stand-in server --------------------------
+
+class TestServer : public emThread {
+public:
+	TestServer();
+	virtual ~TestServer();
+	int GetPort() const;
+	int GetConnectionCount();
+	int GetTileRequestCount();
+	int GetTileRequest(int index);
+	int GetSlowRequestCount();
+	void ReleaseSlowRequests();
+protected:
+	virtual int Run(void * arg);
+private:
+	struct Client {
+		SOCKET Socket;
+		emArray<char> InBuf;
+		bool Holding;
+	};
+	void HandleRequests(Client & client);
+	static void Respond(Client & client, int status, const char * body);
+	emThreadMiniMutex Mutex;
+	SOCKET Listener;
+	int Port;
+	bool Quit;
+	bool SlowReleased;
+	int ConnectionCount;
+	int TileRequests[256];
+	int TileRequestCount;
+	int SlowRequestCount;
+};
+
+
+TestServer::TestServer()
+{
+	struct sockaddr_in addr;
+	socklen_t len;
+
+	Quit=false;
+	SlowReleased=false;
+	ConnectionCount=0;
+	TileRequestCount=0;
+	SlowRequestCount=0;
+
+	Listener=socket(AF_INET,SOCK_STREAM,0);
+	MY_ASSERT(Listener!=INVALID_SOCKET);
+	memset(&addr,0,sizeof(addr));
+	addr.sin_family=AF_INET;
+	addr.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+	addr.sin_port=0;
+	MY_ASSERT(bind(Listener,(struct sockaddr*)&addr,sizeof(addr))==0);
+	MY_ASSERT(listen(Listener,16)==0);
+	len=sizeof(addr);
+	MY_ASSERT(getsockname(Listener,(struct sockaddr*)&addr,&len)==0);
+	Port=ntohs(addr.sin_port);
+
+	Start(NULL);
+}
+
+
+TestServer::~TestServer()
+{
+	Mutex.Lock();
+	Quit=true;
+	Mutex.Unlock();
+	WaitForTermination();
+	closesocket(Listener);
+}
+
+
+int TestServer::GetPort() const
+{
+	return Port;
+}
+
+
+int TestServer::GetConnectionCount()
+{
+	int n;
+
+	Mutex.Lock();
+	n=ConnectionCount;
+	Mutex.Unlock();
+	return n;
+}
+
+
+int TestServer::GetTileRequestCount()
+{
+	int n;
+
+	Mutex.Lock();
+	n=TileRequestCount;
+	Mutex.Unlock();
+	return n;
+}
+
+
+int TestServer::GetTileRequest(int index)
+{
+	int n;
+
+	Mutex.Lock();
+	n=TileRequests[index];
+	Mutex.Unlock();
+	return n;
+}
+
+
+int TestServer::GetSlowRequestCount()
+{
+	int n;
+
+	Mutex.Lock();
+	n=SlowRequestCount;
+	Mutex.Unlock();
+	return n;
+}
+
+
+void TestServer::ReleaseSlowRequests()
+{
+	Mutex.Lock();
+	SlowReleased=true;
+	Mutex.Unlock();
+}
+
+
+int TestServer::Run(void * arg)
+{
+	emArray<Client> clients;
+	struct timeval tv;
+	fd_set readFds;
+	char buf[4096];
+	SOCKET s,maxS;
+	int i,r;
+
+	for (;;) {
+		Mutex.Lock();
+		r=Quit;
+		Mutex.Unlock();
+		if (r) break;
+
+		FD_ZERO(&readFds);
+		FD_SET(Listener,&readFds);
+		maxS=Listener;
+		for (i=0; i<clients.GetCount(); i++) {
+			FD_SET(clients[i].Socket,&readFds);
+			if (maxS<clients[i].Socket) maxS=clients[i].Socket;
+		}
+		tv.tv_sec=0;
+		tv.tv_usec=20000;
+		r=select((int)maxS+1,&readFds,NULL,NULL,&tv);
+		if (r<0) emFatalError("TestServer: select failed");
+
+		if (FD_ISSET(Listener,&readFds)) {
+			s=accept(Listener,NULL,NULL);
+			if (s!=INVALID_SOCKET) {
+				clients.AddNew();
+				clients.GetWritable(clients.GetCount()-1).Socket=s;
+				clients.GetWritable(clients.GetCount()-1).Holding=false;
+				Mutex.Lock();
+				ConnectionCount++;
+				Mutex.Unlock();
+			}
+		}
+
+		for (i=clients.GetCount()-1; i>=0; i--) {
+			Client & c=clients.GetWritable(i);
+			if (FD_ISSET(c.Socket,&readFds)) {
+				r=recv(c.Socket,buf,sizeof(buf),0);
+				if (r<=0) {
+					closesocket(c.Socket);
+					clients.Remove(i);
+					continue;
+				}
+				c.InBuf.Add(buf,r);
+			}
+			HandleRequests(c);
+		}
+	}
+
+	for (i=0; i<clients.GetCount(); i++) closesocket(clients[i].Socket);
+	return 0;
+}
+
+
+void TestServer::HandleRequests(Client & client)
+{
+	emString path;
+	const char * p;
+	int i,n;
+
+	// Requests on a connection are answered in order, so a held back
+	// request blocks the following ones.
+	while (!client.InBuf.IsEmpty()) {
+		for (i=0; i+3<client.InBuf.GetCount(); i++) {
+			if (memcmp(client.InBuf.Get()+i,"\r\n\r\n",4)==0) break;
+		}
+		if (i+3>=client.InBuf.GetCount()) return;
+		p=client.InBuf.Get();
+		if (memcmp(p,"GET ",4)!=0) {
+			emFatalError("TestServer: Unexpected request.");
+		}
+		for (n=4; n<i && p[n]!=' '; n++);
+		path=emString(p+4,n-4);
+
+		if (strncmp(path,"/slow/",6)==0) {
+			Mutex.Lock();
+			if (!client.Holding) SlowRequestCount++;
+			client.Holding=true;
+			n=SlowReleased;
+			Mutex.Unlock();
+			if (!n) return;
+			client.Holding=false;
+			Respond(client,200,"Slow");
+		}
+		else if (sscanf(path,"/tiles/%d.png",&n)==1) {
+			Mutex.Lock();
+			if (TileRequestCount<(int)(sizeof(TileRequests)/sizeof(int))) {
+				TileRequests[TileRequestCount++]=n;
+			}
+			Mutex.Unlock();
+			Respond(client,200,emString::Format("Tile %d",n));
+		}
+		else {
+			Respond(client,404,"Not found");
+		}
+		client.InBuf.Remove(0,i+4);
+	}
+}
+
+
+void TestServer::Respond(Client & client, int status, const char * body)
+{
+	emString str;
+
+	str=emString::Format(
+		"HTTP/1.1 %d %s\r\n"
+		"Content-Type: application/octet-stream\r\n"
+		"Content-Length: %d\r\n"
+		"\r\n"
+		"%s",
+		status,
+		status==200 ? "OK" : "Not Found",
+		(int)strlen(body),
+		body
+	);
+	send(client.Socket,str.Get(),str.GetLen(),0);
+}
+
+
+//--------------------------------- Test engine --------------------------------
+
+class TestEngine : public emEngine {
+public:
+	TestEngine(emRootContext & rootContext, TestServer & server);
+protected:
+	virtual bool Cycle();
+private:
+	emRef<emOsmTileDownloader::DownloadJob> AddJob(
+		const char * path, double priority
+	);
+	bool AreJobsDone() const;
+	emString GetFilePath(const char * path) const;
+	TestServer & Server;
+	emOsmTileDownloader Downloader;
+	emTmpFile TmpDir;
+	bool HelperInstalled;
+	emArray<emRef<emOsmTileDownloader::DownloadJob> > Jobs;
+	int Phase;
+	emUInt64 PhaseClock;
+};
+
+
+TestEngine::TestEngine(emRootContext & rootContext, TestServer & server)
+	: emEngine(rootContext.GetScheduler()),
+	Server(server),
+	Downloader(rootContext.GetScheduler()),
+	TmpDir(rootContext)
+{
+	emTryMakeDirectories(TmpDir.GetPath());
+	HelperInstalled=emIsExistingPath(emGetChildPath(
+		emGetInstallPath(EM_IDT_LIB,"emOsm","emOsm"),
+		"emOsmDownloadProc"
+	));
+	printf(
+		"Downloading with %s\n",
+		HelperInstalled ? "emOsmDownloadProc" : "the curl program"
+	);
+	Phase=0;
+	PhaseClock=emGetClockMS();
+	WakeUp();
+}
+
+
+bool TestEngine::Cycle()
+{
+	emArray<char> buf;
+	emString str;
+	int i,n;
+	bool first[32];
+
+	if (emGetClockMS()-PhaseClock>20000) {
+		emFatalError("Time-out in phase %d",Phase);
+	}
+
+	switch (Phase) {
+	case 0:
+		printf("Downloading 12 tiles...\n");
+		for (i=0; i<12; i++) {
+			AddJob(emString::Format("/tiles/%d.png",i),i);
+		}
+		// Like the view moving to the tiles 0 and 1.
+		Jobs[0]->SetPriority(100.0);
+		Jobs[1]->SetPriority(50.0);
+		break;
+	case 1:
+		if (!AreJobsDone()) return true;
+		for (i=0; i<12; i++) {
+			MY_ASSERT(Jobs[i]->GetState()==emJob::ST_SUCCESS);
+			buf=emTryLoadFile(GetFilePath(emString::Format("/tiles/%d.png",i)));
+			str=emString(buf.Get(),buf.GetCount());
+			MY_ASSERT(str==emString::Format("Tile %d",i));
+		}
+		n=Server.GetConnectionCount();
+		printf("Connections: %d\n",n);
+		MY_ASSERT(n<12);
+		if (HelperInstalled) MY_ASSERT(n<=4);
+		// The first eight requests must have been the eight jobs with
+		// the highest priorities: 0, 1 and 11 down to 6.
+		MY_ASSERT(Server.GetTileRequestCount()==12);
+		memset(first,0,sizeof(first));
+		for (i=0; i<8; i++) first[Server.GetTileRequest(i)]=true;
+		MY_ASSERT(first[0] && first[1]);
+		for (i=6; i<12; i++) MY_ASSERT(first[i]);
+		Jobs.Clear();
+		if (!HelperInstalled) {
+			Phase=100;
+			return true;
+		}
+		printf("Downloading a missing file...\n");
+		AddJob("/tiles/20.png",0.0);
+		AddJob("/missing/21.png",0.0);
+		AddJob("/tiles/22.png",0.0);
+		break;
+	case 2:
+		if (!AreJobsDone()) return true;
+		MY_ASSERT(Jobs[0]->GetState()==emJob::ST_SUCCESS);
+		MY_ASSERT(Jobs[1]->GetState()==emJob::ST_ERROR);
+		MY_ASSERT(Jobs[2]->GetState()==emJob::ST_SUCCESS);
+		MY_ASSERT(!emIsExistingPath(GetFilePath("/missing/21.png")));
+		printf("Error text: %s\n",Jobs[1]->GetErrorText().Get());
+		Jobs.Clear();
+		printf("Aborting a running download...\n");
+		AddJob("/slow/30.png",0.0);
+		break;
+	case 3:
+		if (Server.GetSlowRequestCount()<1) return true;
+		MY_ASSERT(Jobs[0]->GetState()==emJob::ST_RUNNING);
+		Downloader.AbortJob(*Jobs[0]);
+		MY_ASSERT(Jobs[0]->GetState()==emJob::ST_ABORTED);
+		break;
+	case 4:
+		// The helper deletes the partial file.
+		if (emIsExistingPath(GetFilePath("/slow/30.png"))) return true;
+		Server.ReleaseSlowRequests();
+		Jobs.Clear();
+		printf("Downloading after the abort...\n");
+		AddJob("/tiles/31.png",0.0);
+		break;
+	case 5:
+		if (!AreJobsDone()) return true;
+		MY_ASSERT(Jobs[0]->GetState()==emJob::ST_SUCCESS);
+		Phase=100;
+		return true;
+	default:
+		GetScheduler().InitiateTermination(0);
+		return false;
+	}
+	Phase++;
+	PhaseClock=emGetClockMS();
+	return true;
+}
+
+
+emRef<emOsmTileDownloader::DownloadJob> TestEngine::AddJob(
+	const char * path, double priority
+)
+{
+	emRef<emOsmTileDownloader::DownloadJob> job;
+
+	job=new emOsmTileDownloader::DownloadJob(
+		emString::Format("http://127.0.0.1:%d%s",Server.GetPort(),path),
+		GetFilePath(path),
+		priority
+	);
+	Jobs.Add(job);
+	Downloader.EnqueueJob(*job);
+	return job;
+}
+
+
+bool TestEngine::AreJobsDone() const
+{
+	int i;
+
+	for (i=0; i<Jobs.GetCount(); i++) {
+		if (
+			Jobs[i]->GetState()==emJob::ST_WAITING ||
+			Jobs[i]->GetState()==emJob::ST_RUNNING
+		) return false;
+	}
+	return true;
+}
+
+
+emString TestEngine::GetFilePath(const char * path) const
+{
+	emString name;
+	const char * p;
+
+	name=path+1;
+	p=strchr(name.Get(),'/');
+	if (p) name.Replace(p-name.Get(),1,'_');
+	return emGetChildPath(TmpDir.GetPath(),name);
+}
+
+
+//------------------------------------ main ------------------------------------
+
+int main(int argc, char * argv[])
+{
+#if defined(_WIN32)
+	WSADATA wsaData;
+#endif
+
+	emInitLocale();
+
+#if defined(_WIN32)
+	WSAStartup(MAKEWORD(2,2),&wsaData);
+#endif
+
+	emStandardScheduler scheduler;
+	emRootContext rootContext(scheduler);
+	TestServer server;
+	{
+		TestEngine engine(rootContext,server);
+		scheduler.Run();
+	}
+
+	printf("Success\n");
+	return 0;
+}
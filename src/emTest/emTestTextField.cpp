@@ -0,0 +1,368 @@
+//------------------------------------------------------------------------------
+// emTestTextField.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+// Randomized test for the row index of emTextField (RowStarts, RowMBStates,
+// RowCols and MaxRowCols). One text field is edited by random key presses,
+// pastes, deletions, undos and redos, so that its row index is updated
+// incrementally. After each edit, a second text field gets the same text by
+// SetText(..), which builds the row index from scratch. Both fields must then
+// behave the same on row-related cursor movements (up, down, home, end,
+// paragraphs, words) and on mapping mouse positions to columns and rows. This
+// is done in multi-line mode and in single-line mode. Optional arguments are
+// the number of edits per mode (default: 20000) and the random seed.
+//------------------------------------------------------------------------------
+
+#include <emCore/emClipboard.h>
+#include <emCore/emScheduler.h>
+#include <emCore/emTextField.h>
+#include <emCore/emView.h>
+
+#define MY_ASSERT(c) \
+	if (!(c)) emFatalError("%s, %d: assertion failed: %s",__FILE__,__LINE__,#c)
+
+
+//-------------------------------- Test classes --------------------------------
+
+class TestViewPort : public emViewPort {
+public:
+	TestViewPort(emView & view);
+};
+
+
+TestViewPort::TestViewPort(emView & view)
+	: emViewPort(view)
+{
+	SetViewGeometry(0.0,0.0,1000.0,1000.0,1.0);
+	SetViewFocused(true);
+}
+
+
+class TestTextField : public emTextField {
+public:
+	TestTextField(ParentArg parent, const emString & name);
+	void PressKey(emInputKey key, const char * chars="",
+	              bool shift=false, bool ctrl=false);
+	bool GetColRow(double mx, double my, double * pCol,
+	               double * pRow) const;
+};
+
+
+TestTextField::TestTextField(ParentArg parent, const emString & name)
+	: emTextField(parent,name)
+{
+	SetEditable();
+	SetMultiLineMode();
+}
+
+
+void TestTextField::PressKey(
+	emInputKey key, const char * chars, bool shift, bool ctrl
+)
+{
+	emInputEvent event;
+	emInputState state;
+
+	event.Setup(key,chars,0,0);
+	state.Set(EM_KEY_SHIFT,shift);
+	state.Set(EM_KEY_CTRL,ctrl);
+	Input(event,state,-1.0,-1.0);
+}
+
+
+bool TestTextField::GetColRow(
+	double mx, double my, double * pCol, double * pRow
+) const
+{
+	return CheckMouse(mx,my,pCol,pRow);
+}
+
+
+//-------------------------------- Random edits --------------------------------
+
+static emUInt32 Rnd;
+
+
+static int GetRandom(int n)
+{
+	Rnd=Rnd*1103515245+12345;
+	return (int)(((Rnd>>16)*(emUInt32)n)>>16);
+}
+
+
+static emString GetRandomString(int maxLen)
+{
+	static const char * const pieces[]={
+		"\n","\r","\r\n","\n\n","\t","a","bc ","def ","Xy.","  ",
+		"\xC3\xA4","\xE2\x82\xAC","wwwwwwwwwwwwwwwwwwwwwwwwwwwwww"
+	};
+	emString str;
+	int n;
+
+	for (n=GetRandom(maxLen+1); n>0; n--) {
+		str+=pieces[GetRandom(sizeof(pieces)/sizeof(const char*))];
+	}
+	return str;
+}
+
+
+static void SelectRandomRange(TestTextField & f)
+{
+	int i,j;
+
+	i=GetRandom(f.GetTextLen()+1);
+	j=i+GetRandom(emMin(f.GetTextLen()-i,64)+1);
+	f.Select(i,j,false);
+}
+
+
+static void EditRandomly(TestTextField & f)
+{
+	static const emInputKey navKeys[]={
+		EM_KEY_CURSOR_LEFT,EM_KEY_CURSOR_RIGHT,EM_KEY_CURSOR_UP,
+		EM_KEY_CURSOR_DOWN,EM_KEY_HOME,EM_KEY_END
+	};
+	static const char * const chars[]={
+		"a","Z","1"," ",".","\t","\xC3\xA4","\xE2\x82\xAC"
+	};
+	int i;
+
+	// Keep the text short enough for checking all positions now and
+	// then.
+	if (f.GetTextLen()>3000) {
+		i=GetRandom(f.GetTextLen()-1000);
+		f.Select(i,i+1000+GetRandom(500),false);
+		f.DeleteSelectedText();
+	}
+
+	switch (GetRandom(16)) {
+	case 0: case 1: case 2: case 3:
+		f.PressKey(EM_KEY_NONE,chars[GetRandom(sizeof(chars)/sizeof(const char*))]);
+		break;
+	case 4:
+		f.PressKey(EM_KEY_ENTER);
+		break;
+	case 5:
+		i=GetRandom(3);
+		f.PressKey(EM_KEY_BACKSPACE,"",i==2,i>=1);
+		break;
+	case 6:
+		i=GetRandom(3);
+		f.PressKey(EM_KEY_DELETE,"",i==2,i>=1);
+		break;
+	case 7: case 8:
+		SelectRandomRange(f);
+		f.PasteSelectedText(GetRandomString(8));
+		break;
+	case 9:
+		SelectRandomRange(f);
+		f.DeleteSelectedText();
+		break;
+	case 10:
+		f.Undo();
+		break;
+	case 11:
+		f.Redo();
+		break;
+	case 12:
+		f.SetCursorIndex(GetRandom(f.GetTextLen()+1));
+		break;
+	case 13: case 14:
+		f.PressKey(
+			navKeys[GetRandom(sizeof(navKeys)/sizeof(emInputKey))],"",
+			GetRandom(4)==0,GetRandom(4)==0
+		);
+		break;
+	default:
+		f.SetOverwriteMode(!f.GetOverwriteMode());
+		break;
+	}
+}
+
+
+//--------------------------------- Comparison ---------------------------------
+
+static void CompareAtIndex(
+	TestTextField & f, TestTextField & r, int index, int edit
+)
+{
+	static const struct {
+		emInputKey Key;
+		bool Ctrl;
+	} keys[]={
+		{ EM_KEY_CURSOR_LEFT , false },
+		{ EM_KEY_CURSOR_UP   , false },
+		{ EM_KEY_CURSOR_DOWN , false },
+		{ EM_KEY_CURSOR_DOWN , false },
+		{ EM_KEY_END         , false },
+		{ EM_KEY_CURSOR_UP   , false },
+		{ EM_KEY_HOME        , false },
+		{ EM_KEY_CURSOR_UP   , true  },
+		{ EM_KEY_CURSOR_DOWN , true  },
+		{ EM_KEY_CURSOR_LEFT , true  },
+		{ EM_KEY_CURSOR_RIGHT, true  },
+		{ EM_KEY_CURSOR_UP   , true  }
+	};
+	int i;
+
+	// SetCursorIndex(..) does not normalize the index if the cursor is
+	// already there, which may be between CR and LF after an edit.
+	f.SetCursorIndex(0);
+	f.SetCursorIndex(index);
+	r.SetCursorIndex(0);
+	r.SetCursorIndex(index);
+	for (i=0; i<(int)(sizeof(keys)/sizeof(keys[0])); i++) {
+		f.PressKey(keys[i].Key,"",false,keys[i].Ctrl);
+		r.PressKey(keys[i].Key,"",false,keys[i].Ctrl);
+		if (f.GetCursorIndex()!=r.GetCursorIndex()) {
+			emFatalError(
+				"Edit %d, index %d, key %d: cursor at %d instead of %d",
+				edit,index,i,f.GetCursorIndex(),r.GetCursorIndex()
+			);
+		}
+	}
+}
+
+
+static void CompareFields(
+	TestTextField & f, TestTextField & r, bool allIndices, int edit
+)
+{
+	double fc,fr,rc,rr,mx,my;
+	int i,cursor,selStart,selEnd;
+
+	r.SetText(f.GetText());
+	MY_ASSERT(r.GetMultiLineMode()==f.GetMultiLineMode());
+
+	for (i=0; i<=64; i++) {
+		mx=GetRandom(1001)*0.001;
+		my=GetRandom(1001)*0.001*f.GetHeight();
+		if (
+			f.GetColRow(mx,my,&fc,&fr)!=r.GetColRow(mx,my,&rc,&rr) ||
+			fc!=rc || fr!=rr
+		) {
+			emFatalError(
+				"Edit %d: mouse at %g,%g is column/row %g,%g instead of %g,%g",
+				edit,mx,my,fc,fr,rc,rr
+			);
+		}
+	}
+
+	cursor=f.GetCursorIndex();
+	selStart=f.GetSelectionStartIndex();
+	selEnd=f.GetSelectionEndIndex();
+	if (allIndices) {
+		for (i=0; i<=f.GetTextLen(); i++) CompareAtIndex(f,r,i,edit);
+	}
+	else {
+		CompareAtIndex(f,r,cursor,edit);
+		for (i=0; i<4; i++) {
+			CompareAtIndex(f,r,GetRandom(f.GetTextLen()+1),edit);
+		}
+	}
+	f.Select(selStart,selEnd,false);
+	f.SetCursorIndex(cursor);
+}
+
+
+//------------------------------------ main ------------------------------------
+
+class TestEngine : public emEngine {
+public:
+	TestEngine(emView & view, int editCount);
+protected:
+	virtual bool Cycle();
+private:
+	emView & View;
+	int EditCount;
+	int CycleCount;
+};
+
+
+TestEngine::TestEngine(emView & view, int editCount)
+	: emEngine(view.GetScheduler()), View(view)
+{
+	EditCount=editCount;
+	CycleCount=0;
+	WakeUp();
+}
+
+
+bool TestEngine::Cycle()
+{
+	emPanel * root;
+	int pass,edit;
+
+	// Give the view some time slices for updating the viewing states.
+	if (++CycleCount<10) return true;
+
+	root=View.GetRootPanel();
+	TestTextField & f=*(TestTextField*)root->GetChild("f");
+	TestTextField & r=*(TestTextField*)root->GetChild("r");
+	MY_ASSERT(f.IsViewed() && r.IsViewed());
+
+	for (pass=0; pass<2; pass++) {
+		f.SetMultiLineMode(pass==0);
+		r.SetMultiLineMode(pass==0);
+		f.SetText(GetRandomString(40));
+		printf(
+			"%s mode, %d edits...\n",
+			pass==0 ? "Multi-line" : "Single-line",EditCount
+		);
+		for (edit=0; edit<EditCount; edit++) {
+			EditRandomly(f);
+			CompareFields(f,r,edit%500==0,edit);
+		}
+		CompareFields(f,r,true,edit);
+	}
+
+	GetScheduler().InitiateTermination(0);
+	return false;
+}
+
+
+int main(int argc, char * argv[])
+{
+	emPanel * root;
+	emPanel * p;
+	int editCount;
+
+	emInitLocale();
+
+	editCount=20000;
+	if (argc>=2) editCount=atoi(argv[1]);
+	Rnd=4711;
+	if (argc>=3) Rnd=(emUInt32)atoi(argv[2]);
+
+	emStandardScheduler scheduler;
+	emRootContext rootContext(scheduler);
+	emPrivateClipboard::Install(rootContext);
+	emView view(rootContext,emView::VF_NO_ZOOM|emView::VF_ROOT_SAME_TALLNESS);
+	TestViewPort viewPort(view);
+	root=new emPanel(view,"root");
+	p=new TestTextField(root,"f");
+	p->Layout(0.0,0.0,0.5,1.0);
+	p=new TestTextField(root,"r");
+	p->Layout(0.5,0.0,0.5,1.0);
+	TestEngine engine(view,editCount);
+	scheduler.Run();
+	delete root;
+
+	printf("Success\n");
+	return 0;
+}
@@ -0,0 +1,400 @@
+//------------------------------------------------------------------------------
+// emTestTextIndex.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+// Benchmark for the encoding detection and line indexing of emTextFileModel.
+// A text file of the given size (default: 1024 MB) is generated, and it is
+// indexed by the byte-by-byte loops of the former loading stages and by
+// emTextFileModel, once read into memory and once mapped (by a memory limit
+// which is too small for reading). The results are compared. Finally, the
+// mapped file is truncated, and the vanished part of the content must read
+// as zeros until the model has reloaded.
+//------------------------------------------------------------------------------
+
+#include <emCore/emScheduler.h>
+#include <emCore/emTmpFile.h>
+#include <emText/emTextFileModel.h>
+
+#define MY_ASSERT(c) \
+	if (!(c)) emFatalError("%s, %d: assertion failed: %s",__FILE__,__LINE__,#c)
+
+
+//-------------------------------- Generation ----------------------------------
+
+static void GenerateFile(const char * path, emInt64 size)
+{
+	static const char * const words[]={
+		"lorem","ipsum","dolor","sit","amet,","consectetur","adipiscing",
+		"elit.","Stra\xC3\x9F" "e","\xE2\x82\xAC" "42","=","{","}","(i);"
+	};
+	char buf[65536];
+	emUInt32 rnd;
+	emInt64 written;
+	int len,i,n;
+	FILE * f;
+
+	f=fopen(path,"wb");
+	MY_ASSERT(f);
+	rnd=4711;
+	written=0;
+	len=0;
+	while (written<size) {
+		rnd=rnd*1103515245+12345;
+		for (i=(rnd>>16)%4; i>0; i--) buf[len++]='\t';
+		rnd=rnd*1103515245+12345;
+		for (n=(rnd>>16)%14; n>0; n--) {
+			rnd=rnd*1103515245+12345;
+			i=(rnd>>16)%(sizeof(words)/sizeof(words[0]));
+			strcpy(buf+len,words[i]);
+			len+=strlen(words[i]);
+			buf[len++]=' ';
+		}
+		buf[len++]='\n';
+		if (len>(int)sizeof(buf)-1024) {
+			MY_ASSERT(fwrite(buf,1,len,f)==(size_t)len);
+			written+=len;
+			len=0;
+		}
+	}
+	MY_ASSERT(fclose(f)==0);
+}
+
+
+//------------------------------- Staged loops ---------------------------------
+
+struct StagedResult {
+	emArray<int> LineStarts;
+	emArray<emUInt8> RelativeLineIndents;
+	emArray<emUInt8> RelativeLineWidths;
+	int ColumnCount;
+	bool Utf8;
+};
+
+
+static void RunStagedLoops(const char * p, int cnt, StagedResult * r)
+{
+	int s[256];
+	int i,n,c,col,col1,col2,row,lineCount,startPos,sa;
+
+	// Character code statistics.
+	memset(s,0,sizeof(s));
+	for (i=0; i<cnt; i++) s[(emByte)p[i]]++;
+	MY_ASSERT(s[0]+s[1]+s[2]+s[3]+s[4]+s[5]==0);
+	for (sa=0, i=128; i<256; i++) sa+=s[i];
+
+	// UTF-8 detection.
+	r->Utf8=false;
+	if (sa>0) {
+		for (i=0; i<cnt; i++) {
+			if (((signed char)p[i])<0) {
+				n=emDecodeUtf8Char(&c,p+i,cnt-i);
+				n--;
+				if (n<0) break;
+				i+=n;
+			}
+		}
+		r->Utf8=(i>=cnt);
+	}
+	startPos=0;
+
+	// Line breaks.
+	lineCount=0;
+	for (i=startPos; i<cnt; i++) {
+		c=(emByte)p[i];
+		if (c==0x0d) {
+			if (i+1<cnt && p[i+1]==0x0a) i++;
+			lineCount++;
+		}
+		else if (c==0x0a) lineCount++;
+	}
+	if (cnt>0 && p[cnt-1]!=0x0a && p[cnt-1]!=0x0d) lineCount++;
+
+	// Line starts and column count.
+	r->LineStarts.SetCount(lineCount,true);
+	if (lineCount>0) r->LineStarts.GetWritable(0)=startPos;
+	r->ColumnCount=0;
+	col=0;
+	row=1;
+	for (i=startPos; i<cnt; ) {
+		c=(emByte)p[i++];
+		if (c<=0x0d) {
+			if (c==0x09) col=(col+8)&~7;
+			else if (c==0x0a || c==0x0d) {
+				if (c==0x0d && i<cnt && p[i]==0x0a) i++;
+				if (r->ColumnCount<col) r->ColumnCount=col;
+				col=0;
+				if (row<lineCount) r->LineStarts.GetWritable(row++)=i;
+			}
+			else col++;
+		}
+		else {
+			col++;
+			if (c>=128 && r->Utf8) {
+				n=emDecodeUtf8Char(&c,p+i-1,cnt-i+1);
+				if (n>1) i+=n-1;
+			}
+		}
+	}
+	if (r->ColumnCount<col) r->ColumnCount=col;
+
+	// Relative line indents and widths.
+	r->RelativeLineIndents.SetCount(lineCount,true);
+	r->RelativeLineWidths.SetCount(lineCount,true);
+	row=0;
+	col=0;
+	col1=r->ColumnCount;
+	col2=0;
+	for (i=startPos; i<cnt; ) {
+		c=(emByte)p[i++];
+		if (c<=0x20) {
+			if (c==0x09) col=(col+8)&~7;
+			else if (c==0x0a || c==0x0d) {
+				if (c==0x0d && i<cnt && p[i]==0x0a) i++;
+				if (row<lineCount) {
+					if (col1>col) col1=col;
+					if (col2<col1) col2=col1;
+					r->RelativeLineIndents.GetWritable(row)=
+						(emUInt8)(col1*256/(r->ColumnCount+1));
+					r->RelativeLineWidths.GetWritable(row)=
+						(emUInt8)((col2-col1)*256/(r->ColumnCount+1));
+					row++;
+				}
+				col=0;
+				col1=r->ColumnCount;
+				col2=0;
+			}
+			else col++;
+		}
+		else {
+			if (col1>col) col1=col;
+			col++;
+			col2=col;
+			if (c>=128 && r->Utf8) {
+				n=emDecodeUtf8Char(&c,p+i-1,cnt-i+1);
+				if (n>1) i+=n-1;
+			}
+		}
+	}
+	if (row<lineCount) {
+		if (col1>col) col1=col;
+		if (col2<col1) col2=col1;
+		r->RelativeLineIndents.GetWritable(row)=
+			(emUInt8)(col1*256/(r->ColumnCount+1));
+		r->RelativeLineWidths.GetWritable(row)=
+			(emUInt8)((col2-col1)*256/(r->ColumnCount+1));
+	}
+}
+
+
+//------------------------------ emTextFileModel -------------------------------
+
+class BenchClient : public emEngine, private emFileModelClient {
+public:
+	BenchClient(emScheduler & scheduler, emTextFileModel * model,
+	            emUInt64 memoryLimit);
+	emUInt64 LoadedMS, IndexedMS;
+	emInt64 ExpectedSize;
+		// Terminate the scheduler when the model is loaded with this
+		// content size, or with any size if negative.
+protected:
+	virtual bool Cycle();
+private:
+	virtual emUInt64 GetMemoryLimit() const;
+	virtual double GetPriority() const;
+	virtual bool IsReloadAnnoying() const;
+	emTextFileModel * Model;
+	emUInt64 MemoryLimit;
+	emUInt64 StartMS;
+};
+
+
+BenchClient::BenchClient(
+	emScheduler & scheduler, emTextFileModel * model, emUInt64 memoryLimit
+)
+	: emEngine(scheduler), emFileModelClient(model), Model(model)
+{
+	MemoryLimit=memoryLimit;
+	ExpectedSize=-1;
+	LoadedMS=0;
+	IndexedMS=0;
+	StartMS=emGetClockMS();
+	AddWakeUpSignal(Model->GetFileStateSignal());
+	AddWakeUpSignal(Model->GetLineIndexSignal());
+}
+
+
+bool BenchClient::Cycle()
+{
+	switch (Model->GetFileState()) {
+	case emFileModel::FS_LOADED:
+		if (!LoadedMS) LoadedMS=emGetClockMS()-StartMS;
+		if (
+			!Model->IsIndexing() &&
+			(ExpectedSize<0 || Model->GetContentSize()==ExpectedSize)
+		) {
+			IndexedMS=emGetClockMS()-StartMS;
+			GetScheduler().InitiateTermination(0);
+		}
+		break;
+	case emFileModel::FS_LOAD_ERROR:
+		emFatalError("%s",Model->GetErrorText().Get());
+	case emFileModel::FS_TOO_COSTLY:
+		emFatalError("Too costly.");
+	default:
+		break;
+	}
+	return false;
+}
+
+
+emUInt64 BenchClient::GetMemoryLimit() const
+{
+	return MemoryLimit;
+}
+
+
+double BenchClient::GetPriority() const
+{
+	return 1.0;
+}
+
+
+bool BenchClient::IsReloadAnnoying() const
+{
+	return false;
+}
+
+
+static void CompareModel(const emTextFileModel * model, const StagedResult & r)
+{
+	int i;
+
+	MY_ASSERT(model->GetCharEncoding()==(
+		r.Utf8 ? emTextFileModel::CE_UTF8 : emTextFileModel::CE_7BIT
+	));
+	MY_ASSERT(model->GetLineCount()==r.LineStarts.GetCount());
+	MY_ASSERT(model->GetColumnCount()==r.ColumnCount);
+	for (i=0; i<r.LineStarts.GetCount(); i++) {
+		MY_ASSERT(model->GetLineStart(i)==r.LineStarts[i]);
+		MY_ASSERT(model->GetRelativeLineIndent(i)==r.RelativeLineIndents[i]);
+		MY_ASSERT(model->GetRelativeLineWidth(i)==r.RelativeLineWidths[i]);
+	}
+}
+
+
+//------------------------------------ main ------------------------------------
+
+int main(int argc, char * argv[])
+{
+	StagedResult r;
+	emUInt64 clk,ms;
+	emInt64 size;
+	char * buf;
+	FILE * f;
+
+	emInitLocale();
+	emEnableDLog();
+
+	size=1024;
+	if (argc>=2) size=atoi(argv[1]);
+	size*=1024*1024;
+	MY_ASSERT(size>0 && size<INT_MAX);
+
+	emStandardScheduler scheduler;
+	emRootContext rootContext(scheduler);
+	emTmpFile tmpFile(rootContext,".txt");
+
+	printf("Generating %d MB...\n",(int)(size>>20));
+	GenerateFile(tmpFile.GetPath(),size);
+
+	// The file is read into memory beforehand, so that the staged loops
+	// are measured without I/O, and so that it is in the page cache for
+	// the model.
+	f=fopen(tmpFile.GetPath(),"rb");
+	MY_ASSERT(f);
+	MY_ASSERT(fseek(f,0,SEEK_END)==0);
+	size=ftell(f);
+	MY_ASSERT(fseek(f,0,SEEK_SET)==0);
+	buf=(char*)malloc((size_t)size);
+	MY_ASSERT(buf && fread(buf,1,(size_t)size,f)==(size_t)size);
+	fclose(f);
+
+	printf("Staged loops...\n");
+	clk=emGetClockMS();
+	RunStagedLoops(buf,(int)size,&r);
+	ms=emGetClockMS()-clk;
+	printf(
+		"  %d ms (%.0f MB/s), %d lines\n",
+		(int)ms,size/1048576.0/emMax(ms,(emUInt64)1)*1000.0,
+		r.LineStarts.GetCount()
+	);
+	free(buf);
+
+	printf("emTextFileModel (%s, %d threads)...\n",
+		emCanCpuDoAvx2() ? "AVX2" : "scalar",
+		emRenderThreadPool::Acquire(rootContext)->GetThreadCount()
+	);
+	emRef<emTextFileModel> model=emTextFileModel::Acquire(
+		rootContext,tmpFile.GetPath()
+	);
+	{
+		BenchClient client(scheduler,model,((emUInt64)1)<<40);
+		scheduler.Run();
+		ms=client.IndexedMS;
+		printf(
+			"  %d ms (%.0f MB/s), loaded after %d ms, %d lines\n",
+			(int)ms,size/1048576.0/emMax(ms,(emUInt64)1)*1000.0,
+			(int)client.LoadedMS,model->GetLineCount()
+		);
+		printf("Comparing...\n");
+		CompareModel(model,r);
+	}
+	model=NULL;
+
+	printf("emTextFileModel (mapped)...\n");
+	model=emTextFileModel::Acquire(rootContext,tmpFile.GetPath(),false);
+	BenchClient mappedClient(scheduler,model,(emUInt64)size/2);
+	scheduler.Run();
+	ms=mappedClient.IndexedMS;
+	printf(
+		"  %d ms (%.0f MB/s), loaded after %d ms, %d lines, %d MB needed\n",
+		(int)ms,size/1048576.0/emMax(ms,(emUInt64)1)*1000.0,
+		(int)mappedClient.LoadedMS,model->GetLineCount(),
+		(int)(model->GetMemoryNeed()>>20)
+	);
+	MY_ASSERT(model->GetMemoryNeed()<(emUInt64)size/2);
+
+	printf("Comparing...\n");
+	CompareModel(model,r);
+
+#	if !defined(_WIN32)
+		// (Windows does not allow to truncate a mapped file.)
+		printf("Truncating the mapped file...\n");
+		f=fopen(tmpFile.GetPath(),"wb");
+		MY_ASSERT(f);
+		fclose(f);
+		MY_ASSERT(model->GetContent()[0]==0);
+		MY_ASSERT(model->GetContent()[size-1]==0);
+		mappedClient.ExpectedSize=0;
+		scheduler.Run();
+		MY_ASSERT(model->GetLineCount()==0);
+#	endif
+
+	printf("Success\n");
+	return 0;
+}
@@ -0,0 +1,610 @@
+//------------------------------------------------------------------------------
+// emTestTextSearch.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+// Test and benchmark for emTextRegEx and emTextSearch. First, the syntax,
+// the leftmost-first priority and the case folding of emTextRegEx are tested
+// on short strings, and the line anchors of emTextSearch are tested on a small
+// file with mixed line breaks. Then a text file of the given size (default:
+// 16 MB) is generated, with lines containing matches around all the positions
+// where emTextSearch cuts the content into chunks. It is searched with one
+// thread and with up to 8 threads, and the results are compared with a serial
+// line-by-line search. The times are printed as a benchmark.
+//------------------------------------------------------------------------------
+
+#include <emCore/emCoreConfig.h>
+#include <emCore/emRenderThreadPool.h>
+#include <emCore/emScheduler.h>
+#include <emCore/emTmpFile.h>
+#include <emText/emTextSearch.h>
+
+#define MY_ASSERT(c) \
+	if (!(c)) emFatalError("%s, %d: assertion failed: %s",__FILE__,__LINE__,#c)
+
+
+//--------------------------------- emTextRegEx --------------------------------
+
+static void ToChars(const char * str, emArray<int> * chars)
+{
+	// Latin-1 to Unicode.
+	chars->Clear();
+	while (*str) chars->Add((emByte)*str++);
+}
+
+
+static void TestMatch(
+	const char * pattern, const char * text, bool caseSensitive,
+	int expectedStart, int expectedEnd
+)
+{
+	emArray<int> p,t;
+	emTextRegEx regEx;
+	bool found;
+	int s,e;
+
+	ToChars(pattern,&p);
+	ToChars(text,&t);
+	try {
+		regEx.Compile(p.Get(),p.GetCount(),caseSensitive);
+	}
+	catch (const emException & exception) {
+		emFatalError(
+			"Pattern \"%s\" not compiled: %s",pattern,exception.GetText().Get()
+		);
+	}
+	emTextRegEx::Matcher matcher(regEx);
+	found=matcher.Search(t.Get(),t.GetCount(),0,&s,&e);
+	if (!found) s=e=-1;
+	if (s!=expectedStart || e!=expectedEnd) {
+		emFatalError(
+			"Pattern \"%s\" on \"%s\": matched %d..%d instead of %d..%d",
+			pattern,text,s,e,expectedStart,expectedEnd
+		);
+	}
+}
+
+
+static void TestSyntaxError(const char * pattern)
+{
+	emArray<int> p;
+	emTextRegEx regEx;
+
+	ToChars(pattern,&p);
+	try {
+		regEx.Compile(p.Get(),p.GetCount(),true);
+	}
+	catch (const emException &) {
+		return;
+	}
+	emFatalError("Pattern \"%s\" compiled despite syntax error",pattern);
+}
+
+
+static void TestRegEx()
+{
+	emArray<int> p;
+	emTextRegEx regEx;
+
+	// Supported syntax.
+	TestMatch("abc","xxabcxx",true,2,5);
+	TestMatch("a.c","xabc",true,1,4);
+	TestMatch("a\\.c","abc a.c",true,4,7);
+	TestMatch("a\\*","aa*",true,1,3);
+	TestMatch("\\(\\)","f()",true,1,3);
+	TestMatch("\\t","a\tb",true,1,2);
+	TestMatch("\\e","a\x1b",true,1,2);
+	TestMatch("[b-d]+","axbcdz",true,2,5);
+	TestMatch("[^a-c]","abcd",true,3,4);
+	TestMatch("[\\d_]+","ab12_3x",true,2,6);
+	TestMatch("[\\]]","a]",true,1,2);
+	TestMatch("\\d+","ab123",true,2,5);
+	TestMatch("\\w+","  foo_1 ",true,2,7);
+	TestMatch("\\w+","-\xE4\xF6x-",true,1,4);
+	TestMatch("\\s+","a \t b",true,1,4);
+	TestMatch("\\D+","12ab3",true,2,4);
+	TestMatch("\\W+","ab, cd",true,2,4);
+	TestMatch("\\S+","  xy ",true,2,4);
+	TestMatch("^ab","abab",true,0,2);
+	TestMatch("^b","ab",true,-1,-1);
+	TestMatch("b$","abab",true,3,4);
+	TestMatch("a$","ab",true,-1,-1);
+	TestMatch("\\bfoo\\b","afoo foo",true,5,8);
+	TestMatch("\\Boo","foo",true,1,3);
+	TestMatch("(ab)+","xababx",true,1,5);
+	TestMatch("(?:ab)+c","abababc",true,0,7);
+	TestMatch("cat|dog","a dog",true,2,5);
+	TestMatch("ab*","abbb",true,0,4);
+	TestMatch("ab+","a ab",true,2,4);
+	TestMatch("ab?c","ac abc",true,0,2);
+	TestMatch("a{3}","aaaa",true,0,3);
+	TestMatch("a{2,}","a aaaa",true,2,6);
+	TestMatch("a{1,2}","aaa",true,0,2);
+	TestMatch("x{0}y","xy",true,1,2);
+	TestSyntaxError("(ab");
+	TestSyntaxError("ab)");
+	TestSyntaxError("[ab");
+	TestSyntaxError("*a");
+	TestSyntaxError("a{3,2}");
+	TestSyntaxError("ab\\");
+
+	// Leftmost-first priority: the leftmost match wins, and of the
+	// matches starting there, the one preferred by the order of the
+	// alternatives and by greedy repetition.
+	TestMatch("b|ab","xab",true,1,3);
+	TestMatch("a|ab","ab",true,0,1);
+	TestMatch("ab|a","ab",true,0,2);
+	TestMatch("(a|ab)(c|bcd)","abcd",true,0,4);
+	TestMatch("a.*b","aXbYb",true,0,5);
+	TestMatch("a*","baaa",true,1,4);
+	TestMatch("x*","abc",true,-1,-1);
+
+	// Case folding.
+	TestMatch("ABC","xabc",false,1,4);
+	TestMatch("abc","xABC",false,1,4);
+	TestMatch("abc","xABC",true,-1,-1);
+	TestMatch("[a-c]+","xABC",false,1,4);
+	TestMatch("[^a-c]","ABCd",false,3,4);
+	TestMatch("\xC9t\xE9","\xE9T\xC9",false,0,3);
+	TestMatch("\xC9t\xE9","\xE9T\xC9",true,-1,-1);
+	TestMatch("stra\xDF" "e","STRA\xDF" "E",false,0,6);
+	MY_ASSERT(emTextRegEx::FoldCase('A')=='a');
+	MY_ASSERT(emTextRegEx::FoldCase('z')=='z');
+	MY_ASSERT(emTextRegEx::FoldCase(0xC0)==0xE0);
+	MY_ASSERT(emTextRegEx::FoldCase(0xDE)==0xFE);
+	MY_ASSERT(emTextRegEx::FoldCase(0xD7)==0xD7);
+	MY_ASSERT(emTextRegEx::FoldCase(0x100)==0x100);
+
+	// Required string.
+	ToChars("ab.c",&p);
+	regEx.Compile(p.Get(),p.GetCount(),true,true);
+	MY_ASSERT(regEx.GetRequiredString().GetCount()==4);
+	MY_ASSERT(regEx.GetRequiredString()[2]=='.');
+	MY_ASSERT(regEx.IsRequiredStringExact());
+	ToChars("XyZ\\d+",&p);
+	regEx.Compile(p.Get(),p.GetCount(),false);
+	MY_ASSERT(regEx.GetRequiredString().GetCount()==3);
+	MY_ASSERT(regEx.GetRequiredString()[0]=='x');
+	MY_ASSERT(regEx.GetRequiredString()[2]=='z');
+	MY_ASSERT(!regEx.IsRequiredStringExact());
+}
+
+
+//------------------------------- Serial search --------------------------------
+
+static void SearchSerially(
+	const char * content, emInt64 size, bool utf8, const char * pattern,
+	bool regEx, bool caseSensitive, emArray<emInt64> * starts,
+	emArray<emInt64> * ends
+)
+{
+	emTextRegEx re;
+	emArray<int> chars;
+	emArray<int> offsets;
+	emInt64 lineStart,lineEnd,next,p;
+	int c,n,i,s,e;
+
+	ToChars(pattern,&chars);
+	re.Compile(chars.Get(),chars.GetCount(),caseSensitive,!regEx);
+	emTextRegEx::Matcher matcher(re);
+
+	chars.SetTuningLevel(4);
+	offsets.SetTuningLevel(4);
+	starts->SetTuningLevel(4);
+	ends->SetTuningLevel(4);
+	starts->Clear();
+	ends->Clear();
+	for (lineStart=0; lineStart<size; lineStart=next) {
+		for (
+			lineEnd=lineStart;
+			lineEnd<size && content[lineEnd]!=0x0a && content[lineEnd]!=0x0d;
+			lineEnd++
+		);
+		next=lineEnd;
+		if (next<size) {
+			if (content[next]==0x0d && next+1<size && content[next+1]==0x0a) {
+				next+=2;
+			}
+			else next++;
+		}
+		chars.Clear();
+		offsets.Clear();
+		for (p=lineStart; p<lineEnd; p+=n) {
+			c=(emByte)content[p];
+			n=1;
+			if (c>=128 && utf8) {
+				n=emDecodeUtf8Char(&c,content+p,(int)(lineEnd-p));
+				if (n<=0) {
+					c=(emByte)content[p];
+					n=1;
+				}
+			}
+			chars.Add(c);
+			offsets.Add((int)(p-lineStart));
+		}
+		offsets.Add((int)(lineEnd-lineStart));
+		for (i=0; matcher.Search(chars.Get(),chars.GetCount(),i,&s,&e); i=e) {
+			starts->Add(lineStart+offsets[s]);
+			ends->Add(lineStart+offsets[e]);
+		}
+	}
+}
+
+
+//-------------------------------- emTextSearch --------------------------------
+
+class SearchClient : public emEngine, private emFileModelClient {
+public:
+	SearchClient(emRootContext & rootContext, emTextFileModel * model);
+	void Run(const char * pattern, bool regEx, bool caseSensitive,
+	         int maxThreads);
+	emTextSearch Search;
+	int ThreadCount;
+	emUInt64 SearchMS;
+protected:
+	virtual bool Cycle();
+private:
+	virtual emUInt64 GetMemoryLimit() const;
+	virtual double GetPriority() const;
+	virtual bool IsReloadAnnoying() const;
+	emRef<emCoreConfig> CoreConfig;
+	emRef<emRenderThreadPool> ThreadPool;
+	emTextFileModel * Model;
+	const char * Pattern;
+	bool RegEx;
+	bool CaseSensitive;
+	int MaxThreads;
+	int State;
+	emUInt64 StartMS;
+};
+
+
+SearchClient::SearchClient(emRootContext & rootContext, emTextFileModel * model)
+	: emEngine(rootContext.GetScheduler()), emFileModelClient(model),
+	Search(rootContext), Model(model)
+{
+	CoreConfig=emCoreConfig::Acquire(rootContext);
+	ThreadPool=emRenderThreadPool::Acquire(rootContext);
+	Search.SetModel(Model);
+	ThreadCount=0;
+	SearchMS=0;
+	Pattern="";
+	RegEx=false;
+	CaseSensitive=true;
+	MaxThreads=1;
+	State=0;
+	StartMS=0;
+	AddWakeUpSignal(Model->GetFileStateSignal());
+	AddWakeUpSignal(Model->GetLineIndexSignal());
+	AddWakeUpSignal(Search.GetChangeSignal());
+}
+
+
+void SearchClient::Run(
+	const char * pattern, bool regEx, bool caseSensitive, int maxThreads
+)
+{
+	Pattern=pattern;
+	RegEx=regEx;
+	CaseSensitive=caseSensitive;
+	MaxThreads=maxThreads;
+	State=0;
+	WakeUp();
+	GetScheduler().Run();
+}
+
+
+bool SearchClient::Cycle()
+{
+	switch (State) {
+	case 0:
+		switch (Model->GetFileState()) {
+		case emFileModel::FS_LOADED:
+			if (Model->IsIndexing()) return false;
+			CoreConfig->MaxRenderThreads.Set(MaxThreads);
+			State=1;
+			return true;
+		case emFileModel::FS_LOAD_ERROR:
+			emFatalError("%s",Model->GetErrorText().Get());
+		case emFileModel::FS_TOO_COSTLY:
+			emFatalError("Too costly.");
+		default:
+			return false;
+		}
+	case 1:
+		// Give the thread pool a time slice for reacting on the
+		// config change.
+		State=2;
+		return true;
+	case 2:
+		ThreadCount=ThreadPool->GetThreadCount();
+		MY_ASSERT(ThreadCount==emMin(
+			emThread::GetHardwareThreadCount(),MaxThreads
+		));
+		StartMS=emGetClockMS();
+		Search.Start(Pattern,RegEx,CaseSensitive);
+		State=3;
+		return true;
+	case 3:
+		if (Search.IsSearching()) return true;
+		SearchMS=emGetClockMS()-StartMS;
+		MY_ASSERT(Search.GetErrorText().IsEmpty());
+		MY_ASSERT(!Search.IsTruncated());
+		State=4;
+		GetScheduler().InitiateTermination(0);
+		return false;
+	default:
+		return false;
+	}
+}
+
+
+emUInt64 SearchClient::GetMemoryLimit() const
+{
+	return ((emUInt64)1)<<40;
+}
+
+
+double SearchClient::GetPriority() const
+{
+	return 1.0;
+}
+
+
+bool SearchClient::IsReloadAnnoying() const
+{
+	return false;
+}
+
+
+static void CompareMatches(
+	const SearchClient & client, const char * pattern,
+	const emArray<emInt64> & starts, const emArray<emInt64> & ends
+)
+{
+	const emTextSearch & search=client.Search;
+	int i,n;
+
+	n=emMin(search.GetMatchCount(),starts.GetCount());
+	for (i=0; i<n; i++) {
+		if (
+			search.GetMatchStart(i)!=starts[i] ||
+			search.GetMatchEnd(i)!=ends[i]
+		) {
+			emFatalError(
+				"Pattern \"%s\", %d threads: match %d is %d..%d instead of %d..%d",
+				pattern,client.ThreadCount,i,
+				(int)search.GetMatchStart(i),(int)search.GetMatchEnd(i),
+				(int)starts[i],(int)ends[i]
+			);
+		}
+	}
+	if (search.GetMatchCount()!=starts.GetCount()) {
+		emFatalError(
+			"Pattern \"%s\", %d threads: %d matches instead of %d",
+			pattern,client.ThreadCount,search.GetMatchCount(),starts.GetCount()
+		);
+	}
+}
+
+
+static void TestAnchors(emRootContext & rootContext)
+{
+	static const char content[]=
+		"foo bar\nbar foo\r\nfoo\rxfoo\n\r\nfoo foo\rfoo"
+	;
+	static const emInt64 begins[]={ 0, 17, 28, 36 };
+	static const emInt64 ends[]={ 15, 20, 25, 35, 39 };
+	emArray<emInt64> expected;
+	int i;
+	FILE * f;
+
+	emTmpFile tmpFile(rootContext,".txt");
+	f=fopen(tmpFile.GetPath(),"wb");
+	MY_ASSERT(f);
+	MY_ASSERT(fwrite(content,1,strlen(content),f)==strlen(content));
+	MY_ASSERT(fclose(f)==0);
+
+	emRef<emTextFileModel> model=emTextFileModel::Acquire(
+		rootContext,tmpFile.GetPath()
+	);
+	SearchClient client(rootContext,model);
+
+	client.Run("^foo",true,true,1);
+	MY_ASSERT(client.Search.GetMatchCount()==4);
+	for (i=0; i<4; i++) {
+		MY_ASSERT(client.Search.GetMatchStart(i)==begins[i]);
+		MY_ASSERT(client.Search.GetMatchEnd(i)==begins[i]+3);
+	}
+
+	client.Run("FOO$",true,false,1);
+	MY_ASSERT(client.Search.GetMatchCount()==5);
+	for (i=0; i<5; i++) {
+		MY_ASSERT(client.Search.GetMatchStart(i)==ends[i]-3);
+		MY_ASSERT(client.Search.GetMatchEnd(i)==ends[i]);
+	}
+
+	client.Run("^$",true,true,1);
+	MY_ASSERT(client.Search.GetMatchCount()==0);
+}
+
+
+//-------------------------------- Generation ----------------------------------
+
+static void GenerateFile(const char * path, emInt64 size)
+{
+	static const char * const words[]={
+		"lorem","ipsum","dolor","sit","amet,","consectetur","adipiscing",
+		"elit.","Stra\xC3\x9F" "e","\xE2\x82\xAC" "42","=","{","}","(i);"
+	};
+	static const char * const lineBreaks[]={
+		"\n","\n","\n","\n","\n","\n","\r\n","\r"
+	};
+	enum {
+		// Like emTextSearch::STEP_SIZE: the content is cut into
+		// chunks at the line starts after multiples of this.
+		STEP_SIZE = 4*1024*1024,
+		// Distance from a multiple of STEP_SIZE within which every
+		// line has matches. This covers the drift of the chunk
+		// boundaries by the line lengths.
+		NEEDLE_RANGE = 64*1024
+	};
+	char buf[65536];
+	emUInt32 rnd;
+	emInt64 written,d;
+	int len,i,n;
+	FILE * f;
+
+	f=fopen(path,"wb");
+	MY_ASSERT(f);
+	rnd=4711;
+	written=0;
+	len=0;
+	while (written+len<size) {
+		d=(written+len+NEEDLE_RANGE)%STEP_SIZE;
+		rnd=rnd*1103515245+12345;
+		if (written+len==0 || d<2*NEEDLE_RANGE || (rnd>>16)%1000==0) {
+			len+=sprintf(
+				buf+len,"%sneedle %d NEEDLE needlework %d",
+				(rnd>>16)%2 ? "\t" : "",(int)(rnd>>20),(int)(rnd&0xffff)
+			);
+		}
+		else {
+			for (i=(rnd>>16)%4; i>0; i--) buf[len++]='\t';
+			rnd=rnd*1103515245+12345;
+			for (n=(rnd>>16)%14; n>0; n--) {
+				rnd=rnd*1103515245+12345;
+				i=(rnd>>16)%(sizeof(words)/sizeof(const char*));
+				strcpy(buf+len,words[i]);
+				len+=strlen(words[i]);
+				buf[len++]=' ';
+			}
+		}
+		rnd=rnd*1103515245+12345;
+		strcpy(buf+len,lineBreaks[(rnd>>16)%8]);
+		len+=strlen(buf+len);
+		if (len>(int)sizeof(buf)-1024) {
+			MY_ASSERT(fwrite(buf,1,len,f)==(size_t)len);
+			written+=len;
+			len=0;
+		}
+	}
+	// Last line without line break.
+	len+=sprintf(buf+len,"needle 42");
+	MY_ASSERT(fwrite(buf,1,len,f)==(size_t)len);
+	MY_ASSERT(fclose(f)==0);
+}
+
+
+//------------------------------------ main ------------------------------------
+
+int main(int argc, char * argv[])
+{
+	static const struct {
+		const char * Pattern;
+		bool RegEx;
+		bool CaseSensitive;
+	} searches[]={
+		{ "needle"            , false, true  },
+		{ "needle"            , false, false },
+		{ "^\\s*needle \\d+"  , true , true  },
+		{ "\\bneedle\\b"      , true , false },
+		{ "Stra.e"            , true , true  },
+		{ "\\d+$"             , true , true  }
+	};
+	static const int maxThreads[]={ 1, 8 };
+	emArray<emInt64> starts,ends;
+	emUInt64 ms;
+	emInt64 size;
+	char * buf;
+	FILE * f;
+	int i,j;
+
+	emInitLocale();
+	emEnableDLog();
+
+	size=16;
+	if (argc>=2) size=atoi(argv[1]);
+	size*=1024*1024;
+	MY_ASSERT(size>0 && size<INT_MAX);
+
+	emStandardScheduler scheduler;
+	emRootContext rootContext(scheduler);
+
+	printf("Testing emTextRegEx...\n");
+	TestRegEx();
+
+	printf("Testing anchors...\n");
+	TestAnchors(rootContext);
+
+	emTmpFile tmpFile(rootContext,".txt");
+	printf("Generating %d MB...\n",(int)(size>>20));
+	GenerateFile(tmpFile.GetPath(),size);
+
+	f=fopen(tmpFile.GetPath(),"rb");
+	MY_ASSERT(f);
+	MY_ASSERT(fseek(f,0,SEEK_END)==0);
+	size=ftell(f);
+	MY_ASSERT(fseek(f,0,SEEK_SET)==0);
+	buf=(char*)malloc((size_t)size);
+	MY_ASSERT(buf && fread(buf,1,(size_t)size,f)==(size_t)size);
+	fclose(f);
+
+	emRef<emTextFileModel> model=emTextFileModel::Acquire(
+		rootContext,tmpFile.GetPath()
+	);
+	SearchClient client(rootContext,model);
+
+	printf("Searching (%s)...\n",emCanCpuDoAvx2() ? "AVX2" : "scalar");
+	for (i=0; i<(int)(sizeof(searches)/sizeof(searches[0])); i++) {
+		ms=emGetClockMS();
+		SearchSerially(
+			buf,size,
+			model->GetCharEncoding()==emTextFileModel::CE_UTF8,
+			searches[i].Pattern,searches[i].RegEx,
+			searches[i].CaseSensitive,&starts,&ends
+		);
+		ms=emGetClockMS()-ms;
+		printf(
+			"  %-20s %-5s %-16s serial:  %6d ms (%5.0f MB/s), %d matches\n",
+			searches[i].Pattern,
+			searches[i].RegEx ? "regex" : "plain",
+			searches[i].CaseSensitive ? "case-sensitive" : "case-insensitive",
+			(int)ms,size/1048576.0/emMax(ms,(emUInt64)1)*1000.0,
+			starts.GetCount()
+		);
+		MY_ASSERT(starts.GetCount()>(int)(size/(4*1024*1024)));
+		for (j=0; j<(int)(sizeof(maxThreads)/sizeof(int)); j++) {
+			client.Run(
+				searches[i].Pattern,searches[i].RegEx,
+				searches[i].CaseSensitive,maxThreads[j]
+			);
+			ms=client.SearchMS;
+			printf(
+				"  %-20s %-5s %-16s %d threads: %6d ms (%5.0f MB/s)\n",
+				"","","",client.ThreadCount,
+				(int)ms,size/1048576.0/emMax(ms,(emUInt64)1)*1000.0
+			);
+			CompareMatches(client,searches[i].Pattern,starts,ends);
+		}
+	}
+	MY_ASSERT(model->GetCharEncoding()==emTextFileModel::CE_UTF8);
+	free(buf);
+
+	printf("Success\n");
+	return 0;
+}
@@ -33,13 +33,25 @@ emTextFileControlPanel::emTextFileControlPanel(
 	NumberOfColumns(NULL),
 	Copy(NULL),
 	SelectAll(NULL),
-	ClearSelection(NULL)
+	ClearSelection(NULL),
+	Follow(NULL),
+	StayAtEnd(NULL),
+	SearchPattern(NULL),
+	SearchRegEx(NULL),
+	SearchCaseSensitive(NULL),
+	FindNext(NULL),
+	FindPrev(NULL),
+	SearchStatus(NULL)
 {
 	if (FileModel) {
 		AddWakeUpSignal(FileModel->GetFileStateSignal());
 		AddWakeUpSignal(FileModel->GetChangeSignal());
+		AddWakeUpSignal(FileModel->GetLineIndexSignal());
+	}
+	if (FilePanel) {
+		AddWakeUpSignal(FilePanel->GetSelectionSignal());
+		AddWakeUpSignal(FilePanel->GetSearch().GetChangeSignal());
 	}
-	if (FilePanel) AddWakeUpSignal(FilePanel->GetSelectionSignal());
 }
 
 
@@ -57,7 +69,8 @@ bool emTextFileControlPanel::Cycle()
 	if (
 		FileModel && (
 			IsSignaled(FileModel->GetFileStateSignal()) ||
-			IsSignaled(FileModel->GetChangeSignal())
+			IsSignaled(FileModel->GetChangeSignal()) ||
+			IsSignaled(FileModel->GetLineIndexSignal())
 		)
 	) {
 		UpdateControls();
@@ -76,6 +89,32 @@ bool emTextFileControlPanel::Cycle()
 		if (ClearSelection && IsSignaled(ClearSelection->GetClickSignal())) {
 			FilePanel->EmptySelection();
 		}
+		if (Follow && IsSignaled(Follow->GetCheckSignal())) {
+			FilePanel->SetFollowing(Follow->IsChecked());
+			UpdateControls();
+		}
+		if (StayAtEnd && IsSignaled(StayAtEnd->GetCheckSignal())) {
+			FilePanel->SetStayingAtEnd(StayAtEnd->IsChecked());
+		}
+		if (
+			(SearchPattern && IsSignaled(SearchPattern->GetTextSignal())) ||
+			(SearchRegEx && IsSignaled(SearchRegEx->GetCheckSignal())) ||
+			(
+				SearchCaseSensitive &&
+				IsSignaled(SearchCaseSensitive->GetCheckSignal())
+			)
+		) {
+			StartSearch();
+		}
+		if (FindNext && IsSignaled(FindNext->GetClickSignal())) {
+			FilePanel->GoToNextMatch();
+		}
+		if (FindPrev && IsSignaled(FindPrev->GetClickSignal())) {
+			FilePanel->GoToPrevMatch();
+		}
+		if (IsSignaled(FilePanel->GetSearch().GetChangeSignal())) {
+			UpdateControls();
+		}
 	}
 
 	return busy;
@@ -84,12 +123,14 @@ bool emTextFileControlPanel::Cycle()
 
 void emTextFileControlPanel::AutoExpand()
 {
-	emRasterGroup * infos;
-	emLinearGroup * selection;
+	emRasterGroup * infos, * search;
+	emLinearGroup * selection, * follow;
 
 	emLinearGroup::AutoExpand();
 
 	SetChildWeight(1,0.2);
+	SetChildWeight(2,0.2);
+	SetChildWeight(3,0.6);
 
 	infos=new emRasterGroup(this,"infos","Infos");
 	infos->SetPrefChildTallness(0.1);
@@ -151,6 +192,94 @@ void emTextFileControlPanel::AutoExpand()
 	);
 	AddWakeUpSignal(ClearSelection->GetClickSignal());
 
+	follow=new emLinearGroup(this,"follow","Follow");
+
+	Follow=new emCheckBox(
+		follow,
+		"follow",
+		"Follow File",
+		"Check the file periodically for appended data and show it,\n"
+		"like \"tail -f\". Only the appended data is read and indexed.\n"
+		"If the file shrinks or is replaced, it is reloaded."
+	);
+	AddWakeUpSignal(Follow->GetCheckSignal());
+
+	StayAtEnd=new emCheckBox(
+		follow,
+		"stayAtEnd",
+		"Stay at End",
+		"While following, keep the end of the text in the view when\n"
+		"data is appended, provided it was in the view before."
+	);
+	AddWakeUpSignal(StayAtEnd->GetCheckSignal());
+
+	search=new emRasterGroup(this,"search","Search");
+	search->SetPrefChildTallness(0.2);
+	search->SetRowByRow();
+
+	SearchPattern=new emTextField(
+		search,
+		"pattern",
+		"Search For",
+		"Text to search for. All matches are highlighted. Matches\n"
+		"never span line breaks."
+	);
+	SearchPattern->SetEditable();
+	if (FilePanel) SearchPattern->SetText(FilePanel->GetSearch().GetPattern());
+	AddWakeUpSignal(SearchPattern->GetTextSignal());
+
+	SearchStatus=new emTextField(
+		search,
+		"status",
+		"Matches"
+	);
+
+	SearchRegEx=new emCheckBox(
+		search,
+		"regEx",
+		"Regular Expression",
+		"Whether the text to search for is a regular expression.\n"
+		"Supported are . [] [^] \\d \\w \\s \\D \\W \\S ^ $ \\b \\B () (?:) |\n"
+		"* + ? {n} {n,} {n,m} and escaping by backslash."
+	);
+	if (FilePanel) SearchRegEx->SetChecked(FilePanel->GetSearch().IsRegEx());
+	AddWakeUpSignal(SearchRegEx->GetCheckSignal());
+
+	SearchCaseSensitive=new emCheckBox(
+		search,
+		"caseSensitive",
+		"Case Sensitive",
+		"Whether to distinguish upper and lower case letters."
+	);
+	if (FilePanel) {
+		SearchCaseSensitive->SetChecked(
+			FilePanel->GetSearch().IsCaseSensitive()
+		);
+	}
+	AddWakeUpSignal(SearchCaseSensitive->GetCheckSignal());
+
+	FindNext=new emButton(
+		search,
+		"findNext",
+		"Find Next",
+		"Select and show the next match after the selection, or after\n"
+		"the center of the view.\n"
+		"\n"
+		"Hotkey: F3"
+	);
+	AddWakeUpSignal(FindNext->GetClickSignal());
+
+	FindPrev=new emButton(
+		search,
+		"findPrev",
+		"Find Previous",
+		"Select and show the previous match before the selection, or\n"
+		"before the center of the view.\n"
+		"\n"
+		"Hotkey: Shift+F3"
+	);
+	AddWakeUpSignal(FindPrev->GetClickSignal());
+
 	UpdateControls();
 }
 
@@ -164,6 +293,14 @@ void emTextFileControlPanel::AutoShrink()
 	Copy=NULL;
 	SelectAll=NULL;
 	ClearSelection=NULL;
+	Follow=NULL;
+	StayAtEnd=NULL;
+	SearchPattern=NULL;
+	SearchRegEx=NULL;
+	SearchCaseSensitive=NULL;
+	FindNext=NULL;
+	FindPrev=NULL;
+	SearchStatus=NULL;
 
 	emLinearGroup::AutoShrink();
 }
@@ -171,10 +308,16 @@ void emTextFileControlPanel::AutoShrink()
 
 void emTextFileControlPanel::UpdateControls()
 {
+	const emTextSearch * search;
 	const char * p;
 
 	if (!IsAutoExpanded()) return;
 
+	Follow->SetEnableSwitch(FileModel && FilePanel);
+	Follow->SetChecked(FilePanel && FilePanel->IsFollowing());
+	StayAtEnd->SetEnableSwitch(FilePanel && FilePanel->IsFollowing());
+	StayAtEnd->SetChecked(FilePanel && FilePanel->IsStayingAtEnd());
+
 	if (
 		!FileModel || !FilePanel ||
 		!FilePanel->IsVFSGood() ||
@@ -191,6 +334,13 @@ void emTextFileControlPanel::UpdateControls()
 		Copy->SetEnableSwitch(false);
 		SelectAll->SetEnableSwitch(false);
 		ClearSelection->SetEnableSwitch(false);
+		SearchPattern->SetEnableSwitch(false);
+		SearchRegEx->SetEnableSwitch(false);
+		SearchCaseSensitive->SetEnableSwitch(false);
+		FindNext->SetEnableSwitch(false);
+		FindPrev->SetEnableSwitch(false);
+		SearchStatus->SetEnableSwitch(false);
+		SearchStatus->SetText(emString());
 		return;
 	}
 
@@ -216,7 +366,16 @@ void emTextFileControlPanel::UpdateControls()
 	LineBreakEncoding->SetText(p);
 
 	NumberOfLines->SetEnableSwitch(true);
-	NumberOfLines->SetText(emString::Format("%d",FileModel->GetLineCount()));
+	if (FileModel->IsIndexing()) {
+		NumberOfLines->SetText(emString::Format(
+			"%d (indexing: %d%%)",
+			FileModel->GetLineCount(),
+			(int)FileModel->GetIndexingProgress()
+		));
+	}
+	else {
+		NumberOfLines->SetText(emString::Format("%d",FileModel->GetLineCount()));
+	}
 
 	NumberOfColumns->SetEnableSwitch(true);
 	NumberOfColumns->SetText(emString::Format("%d",FileModel->GetColumnCount()));
@@ -225,8 +384,58 @@ void emTextFileControlPanel::UpdateControls()
 
 	SelectAll->SetEnableSwitch(
 		FilePanel->GetSelectionStartIndex()!=0 ||
-		FilePanel->GetSelectionEndIndex()!=FileModel->GetContent().GetCount()
+		FilePanel->GetSelectionEndIndex()!=FileModel->GetIndexedSize()
 	);
 
 	ClearSelection->SetEnableSwitch(!FilePanel->IsSelectionEmpty());
+
+	search=&FilePanel->GetSearch();
+	SearchPattern->SetEnableSwitch(true);
+	SearchRegEx->SetEnableSwitch(true);
+	SearchCaseSensitive->SetEnableSwitch(true);
+	FindNext->SetEnableSwitch(search->GetMatchCount()>0);
+	FindPrev->SetEnableSwitch(search->GetMatchCount()>0);
+	SearchStatus->SetEnableSwitch(!search->GetPattern().IsEmpty());
+	if (search->GetPattern().IsEmpty()) {
+		SearchStatus->SetText(emString());
+	}
+	else if (!search->GetErrorText().IsEmpty()) {
+		SearchStatus->SetText(search->GetErrorText());
+	}
+	else if (search->IsSearching()) {
+		SearchStatus->SetText(emString::Format(
+			"%d (searching: %d%%)",
+			search->GetMatchCount(),
+			(int)search->GetProgress()
+		));
+	}
+	else if (search->IsTruncated()) {
+		SearchStatus->SetText(emString::Format(
+			"%d (too many, search stopped)",
+			search->GetMatchCount()
+		));
+	}
+	else {
+		SearchStatus->SetText(emString::Format("%d",search->GetMatchCount()));
+	}
+}
+
+
+void emTextFileControlPanel::StartSearch()
+{
+	const emTextSearch * search;
+
+	if (!FilePanel || !SearchPattern) return;
+	search=&FilePanel->GetSearch();
+	if (
+		search->GetPattern()!=SearchPattern->GetText() ||
+		search->IsRegEx()!=SearchRegEx->IsChecked() ||
+		search->IsCaseSensitive()!=SearchCaseSensitive->IsChecked()
+	) {
+		FilePanel->StartSearch(
+			SearchPattern->GetText(),
+			SearchRegEx->IsChecked(),
+			SearchCaseSensitive->IsChecked()
+		);
+	}
 }
@@ -19,6 +19,119 @@
 //------------------------------------------------------------------------------
 
 #include <emText/emTextFileModel.h>
+#if defined(_WIN32)
+#	include <windows.h>
+#	include <io.h>
+#else
+#	include <signal.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
+
+
+#if !defined(_WIN32)
+
+//==============================================================================
+//============================ Guard of the mappings ===========================
+//==============================================================================
+
+// Accessing a mapping of a file beyond the current end of the file raises
+// SIGBUS. This happens when a mapped file is truncated by someone else. The
+// handler below replaces the affected page of a registered mapping by a page
+// of zeros, and the access is repeated successfully. Other SIGBUS signals are
+// passed on to the previous handler. (Windows does not allow to truncate a
+// mapped file.)
+
+static const int emTextFileModel_MaxMappings=256;
+
+static struct {
+	char * volatile Addr;
+	volatile size_t Size;
+} emTextFileModel_Mappings[emTextFileModel_MaxMappings];
+
+static struct sigaction emTextFileModel_OldSigBusAction;
+static size_t emTextFileModel_PageSize;
+
+
+static void emTextFileModel_SigBusHandler(int sig, siginfo_t * info, void * ctx)
+{
+	char * addr, * page;
+	int i;
+
+	addr=(char*)info->si_addr;
+	for (i=0; i<emTextFileModel_MaxMappings; i++) {
+		page=emTextFileModel_Mappings[i].Addr;
+		if (page && addr>=page && addr<page+emTextFileModel_Mappings[i].Size) {
+			page=addr-((size_t)addr)%emTextFileModel_PageSize;
+			if (mmap(
+				page,emTextFileModel_PageSize,PROT_READ,
+				MAP_PRIVATE|MAP_ANONYMOUS|MAP_FIXED,-1,0
+			)!=MAP_FAILED) return;
+			break;
+		}
+	}
+	if (emTextFileModel_OldSigBusAction.sa_flags&SA_SIGINFO) {
+		if (emTextFileModel_OldSigBusAction.sa_sigaction) {
+			emTextFileModel_OldSigBusAction.sa_sigaction(sig,info,ctx);
+			return;
+		}
+	}
+	else if (
+		emTextFileModel_OldSigBusAction.sa_handler!=SIG_DFL &&
+		emTextFileModel_OldSigBusAction.sa_handler!=SIG_IGN
+	) {
+		emTextFileModel_OldSigBusAction.sa_handler(sig);
+		return;
+	}
+	// Repeating the access raises SIGBUS with the default action.
+	signal(SIGBUS,SIG_DFL);
+}
+
+
+static bool emTextFileModel_GuardMapping(void * addr, size_t size)
+{
+	int i;
+
+	static const struct SigBusHandlerInstaller {
+		SigBusHandlerInstaller() {
+			struct sigaction sa;
+			emTextFileModel_PageSize=(size_t)sysconf(_SC_PAGESIZE);
+			memset(&sa,0,sizeof(sa));
+			sa.sa_sigaction=emTextFileModel_SigBusHandler;
+			sa.sa_flags=SA_SIGINFO;
+			if (sigaction(SIGBUS,&sa,&emTextFileModel_OldSigBusAction)) {
+				emFatalError(
+					"emTextFileModel: Failed to install handler for SIGBUS: %s",
+					emGetErrorText(errno).Get()
+				);
+			}
+		}
+	} sigBusHandlerInstaller;
+
+	for (i=0; i<emTextFileModel_MaxMappings; i++) {
+		if (!emTextFileModel_Mappings[i].Addr) {
+			emTextFileModel_Mappings[i].Size=size;
+			emTextFileModel_Mappings[i].Addr=(char*)addr;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+static void emTextFileModel_UnguardMapping(void * addr)
+{
+	int i;
+
+	for (i=0; i<emTextFileModel_MaxMappings; i++) {
+		if (emTextFileModel_Mappings[i].Addr==(char*)addr) {
+			emTextFileModel_Mappings[i].Addr=NULL;
+			emTextFileModel_Mappings[i].Size=0;
+		}
+	}
+}
+
+#endif
 
 
 emRef<emTextFileModel> emTextFileModel::Acquire(
@@ -29,6 +142,33 @@ emRef<emTextFileModel> emTextFileModel::Acquire(
 }
 
 
+int emTextFileModel::ReadContent(emInt64 index, char * buf, int len) const
+{
+	const WindowPage * page;
+	int n,k,o;
+
+	if (index<0 || index>=ContentSize || len<=0) return 0;
+	if (len>ContentSize-index) len=(int)(ContentSize-index);
+
+	if (!W) {
+		memcpy(buf,Content+index,len);
+		return len;
+	}
+
+	W->Mutex.Lock();
+	for (n=0; n<len; n+=k) {
+		page=GetWindowPage(index+n);
+		if (!page) break;
+		o=(int)(index+n-page->Pos);
+		k=emMin(page->Size-o,len-n);
+		if (k<=0) break;
+		memcpy(buf+n,page->Data+o,k);
+	}
+	W->Mutex.Unlock();
+	return n;
+}
+
+
 bool emTextFileModel::IsSameCharEncoding() const
 {
 	switch (CharEncoding) {
@@ -45,18 +185,20 @@ bool emTextFileModel::IsSameCharEncoding() const
 }
 
 
-int emTextFileModel::DecodeChar(int * pUcs4, int index, emMBState * mbState) const
+int emTextFileModel::DecodeChar(
+	int * pUcs4, emInt64 index, emMBState * mbState
+) const
 {
 	const char * src;
 	int srcLen,c,c2,sh1,sh2,n;
 
-	if ((unsigned int)index>=(unsigned int)Content.GetCount()) {
+	if ((emUInt64)index>=(emUInt64)ContentSize) {
 		*pUcs4=0;
 		return 0;
 	}
 
-	src=Content.Get()+index;
-	srcLen=Content.GetCount()-index;
+	src=Content+index;
+	srcLen=(int)emMin(ContentSize-index,(emInt64)4096);
 
 	switch (CharEncoding) {
 	case CE_BINARY:
@@ -234,21 +376,36 @@ emString emTextFileModel::ConvertToCurrentLocale(
 }
 
 
-int emTextFileModel::GetLineEnd(int lineIndex) const
+double emTextFileModel::GetIndexingProgress() const
 {
-	int i, c;
+	if (!I || ContentSize<=I->StartPos) return 100.0;
+	return 100.0*(I->Scan.Pos-I->StartPos)/(ContentSize-I->StartPos);
+}
+
+
+emInt64 emTextFileModel::GetIndexedSize() const
+{
+	if (I && LineCount<LineStarts.GetCount()) return LineStarts[LineCount];
+	return ContentSize;
+}
+
+
+emInt64 emTextFileModel::GetLineEnd(int lineIndex) const
+{
+	emInt64 i;
+	int c;
 
 	if (CharEncoding==CE_UTF16LE || CharEncoding==CE_UTF16BE) {
-		if (lineIndex+1<LineCount) i=LineStarts[lineIndex+1];
-		else i=Content.GetCount();
-		if (i>0) {
+		if (lineIndex+1<LineStarts.GetCount()) i=LineStarts[lineIndex+1];
+		else i=ContentSize;
+		if (i>=2) {
 			c=(emByte)Content[i-2];
 			if (CharEncoding==CE_UTF16LE) c|=((emByte)Content[i-1])<<8;
 			else c=(c<<8)|(emByte)Content[i-1];
 			if (c==0x0d) i-=2;
 			else if (c==0x0a) {
 				i-=2;
-				if (i>0) {
+				if (i>=2) {
 					c=(emByte)Content[i-2];
 					if (CharEncoding==CE_UTF16LE) c|=((emByte)Content[i-1])<<8;
 					else c=(c<<8)|(emByte)Content[i-1];
@@ -258,12 +415,12 @@ int emTextFileModel::GetLineEnd(int lineIndex) const
 		}
 	}
 	else {
-		if (lineIndex+1<LineCount) {
+		if (lineIndex+1<LineStarts.GetCount()) {
 			i=LineStarts[lineIndex+1]-1;
 			if (Content[i]==0x0a && i>0 && Content[i-1]==0x0d) i--;
 		}
 		else {
-			i=Content.GetCount();
+			i=ContentSize;
 			if (i>0) {
 				c=Content[i-1];
 				if (c==0x0d) i--;
@@ -278,15 +435,16 @@ int emTextFileModel::GetLineEnd(int lineIndex) const
 }
 
 
-int emTextFileModel::ColRow2Index(
+emInt64 emTextFileModel::ColRow2Index(
 	double column, double row, bool forCursor
 ) const
 {
-	int i,j,k,n,c;
+	emInt64 i;
+	int j,k,n,c;
 
 	if (LineCount<=0) return 0;
 	if (row<0.0) row=0.0;
-	if (row>=LineCount) return Content.GetCount();
+	if (row>=LineCount) return GetIndexedSize();
 	i=GetLineStart(emMin(LineCount-1,emMax(0,(int)row)));
 	emMBState mbState;
 	for (j=0; ; i+=n, j=k) {
@@ -311,7 +469,7 @@ int emTextFileModel::ColRow2Index(
 }
 
 
-int emTextFileModel::Index2Row(int index) const
+int emTextFileModel::Index2Row(emInt64 index) const
 {
 	int r1,r2,r;
 
@@ -325,9 +483,12 @@ int emTextFileModel::Index2Row(int index) const
 }
 
 
-void emTextFileModel::Index2ColRow(int index, int * pColumn, int * pRow) const
+void emTextFileModel::Index2ColRow(
+	emInt64 index, int * pColumn, int * pRow
+) const
 {
-	int i,col,row,n,c;
+	emInt64 i;
+	int col,row,n,c;
 
 	row=Index2Row(index);
 	i=GetLineStart(row);
@@ -339,16 +500,17 @@ void emTextFileModel::Index2ColRow(int index, int * pColumn, int * pRow) const
 		i+=n;
 		if (i>index) break;
 		col++;
-		if (c==0x09) col=(col+7)&~7;
+		if (c==0x09) col=(col+8)&~7;
 	}
 	*pColumn=col;
 	*pRow=row;
 }
 
 
-int emTextFileModel::GetNextWordBoundaryIndex(int index) const
+emInt64 emTextFileModel::GetNextWordBoundaryIndex(emInt64 index) const
 {
-	int i,n,c;
+	emInt64 i;
+	int n,c;
 	bool prevDelim,delim,first;
 
 	i=GetLineStart(Index2Row(index));
@@ -379,9 +541,10 @@ int emTextFileModel::GetNextWordBoundaryIndex(int index) const
 }
 
 
-int emTextFileModel::GetPrevWordBoundaryIndex(int index) const
+emInt64 emTextFileModel::GetPrevWordBoundaryIndex(emInt64 index) const
 {
-	int row,dr,i,j;
+	emInt64 i,j;
+	int row,dr;
 
 	row=Index2Row(index);
 	dr=1;
@@ -404,39 +567,91 @@ int emTextFileModel::GetPrevWordBoundaryIndex(int index) const
 }
 
 
-int emTextFileModel::GetNextRowIndex(int index) const
+emInt64 emTextFileModel::GetNextRowIndex(emInt64 index) const
 {
 	int row;
 
 	row=Index2Row(index)+1;
-	if (row>=LineCount) return Content.GetCount();
+	if (row>=LineCount) return GetIndexedSize();
 	return GetLineStart(row);
 }
 
 
-int emTextFileModel::GetPrevRowIndex(int index) const
+emInt64 emTextFileModel::GetPrevRowIndex(emInt64 index) const
 {
 	int row;
 
-	if (index>=Content.GetCount()) row=LineCount-1;
+	if (LineCount<=0) return 0;
+	if (index>=GetIndexedSize()) row=LineCount-1;
 	else row=Index2Row(index)-1;
 	if (row<0) row=0;
 	return GetLineStart(row);
 }
 
 
+emUInt8 emTextFileModel::GetRelativeLineIndent(int lineIndex) const
+{
+	return (emUInt8)(
+		LineIndents[lineIndex]*256/(emMin(ColumnCount,65535)+1)
+	);
+}
+
+
+emUInt8 emTextFileModel::GetRelativeLineWidth(int lineIndex) const
+{
+	return (emUInt8)(
+		LineWidths[lineIndex]*256/(emMin(ColumnCount,65535)+1)
+	);
+}
+
+
+void emTextFileModel::AddFollower()
+{
+	FollowerCount++;
+	if (FollowerCount==1) FollowTimer.Start(FOLLOW_INTERVAL,true);
+}
+
+
+void emTextFileModel::RemoveFollower()
+{
+	FollowerCount--;
+	if (FollowerCount==0 && !MappedAddr) FollowTimer.Stop(true);
+}
+
+
 emTextFileModel::emTextFileModel(emContext & context, const emString & name)
-	: emFileModel(context,name)
+	: emFileModel(context,name),
+	FollowTimer(GetScheduler())
 {
-	Content.SetTuningLevel(4);
+	ThreadPool=emRenderThreadPool::Acquire(GetRootContext());
+	ClassifyBytesKernel=ClassifyBytesScalar;
+	ScanLinesKernel=ScanLinesScalar;
+#	if EM_HAVE_X86_INTRINSICS
+		if (emCanCpuDoAvx2()) {
+			ClassifyBytesKernel=ClassifyBytesAvx2;
+			ScanLinesKernel=ScanLinesAvx2;
+		}
+#	endif
+	Content="";
+	ContentSize=0;
+	ContentBuf=NULL;
+	ContentBufSize=0;
+	MappedAddr=NULL;
+	MappedSize=0;
+	W=NULL;
 	CharEncoding=CE_BINARY;
 	LineBreakEncoding=LBE_NONE;
 	LineCount=0;
 	ColumnCount=0;
-	LineStarts=NULL;
-	RelativeLineIndents=NULL;
-	RelativeLineWidths=NULL;
+	LineStarts.SetTuningLevel(4);
+	LineIndents.SetTuningLevel(4);
+	LineWidths.SetTuningLevel(4);
+	TextStart=0;
+	FollowerCount=0;
+	FileINode=0;
+	I=NULL;
 	L=NULL;
+	AddWakeUpSignal(FollowTimer.GetSignal());
 }
 
 
@@ -447,32 +662,70 @@ emTextFileModel::~emTextFileModel()
 }
 
 
+bool emTextFileModel::Cycle()
+{
+	emUInt64 clk;
+	bool busy;
+
+	busy=emFileModel::Cycle();
+
+	if (IsSignaled(FollowTimer.GetSignal())) FollowFile();
+
+	if (I && GetFileState()==FS_LOADED) {
+		// Continue indexing in the background.
+		do {
+			ContinueIndexing(I->Scan.Pos+CHUNK_SIZE*ThreadPool->GetThreadCount());
+		} while (I && !IsTimeSliceAtEnd());
+		if (!I) {
+			// Do not compact the arrays while more lines are to be
+			// appended, because that would copy them every time.
+			if (FollowerCount<=0) {
+				LineStarts.Compact();
+				LineIndents.Compact();
+				LineWidths.Compact();
+			}
+			Signal(LineIndexSignal);
+		}
+		else {
+			clk=emGetClockMS();
+			if (clk-I->LastSignalClock>=250) {
+				I->LastSignalClock=clk;
+				Signal(LineIndexSignal);
+			}
+			busy=true;
+		}
+	}
+
+	return busy;
+}
+
+
 void emTextFileModel::ResetData()
 {
-	if (!Content.IsEmpty()) Signal(ChangeSignal);
-	Content.Clear(true);
+	if (ContentSize>0) Signal(ChangeSignal);
+	if (I) {
+		delete I;
+		I=NULL;
+	}
+	CloseWindow();
+	UnmapContent();
+	FreeContentBuf();
+	Content="";
+	ContentSize=0;
 	CharEncoding=CE_BINARY;
 	LineBreakEncoding=LBE_NONE;
 	LineCount=0;
 	ColumnCount=0;
-	if (LineStarts) {
-		delete [] LineStarts;
-		LineStarts=NULL;
-	}
-	if (RelativeLineIndents) {
-		delete [] RelativeLineIndents;
-		RelativeLineIndents=NULL;
-	}
-	if (RelativeLineWidths) {
-		delete [] RelativeLineWidths;
-		RelativeLineWidths=NULL;
-	}
+	LineStarts.Clear(true);
+	LineIndents.Clear(true);
+	LineWidths.Clear(true);
+	TextStart=0;
 }
 
 
 void emTextFileModel::TryStartLoading()
 {
-	emInt64 l;
+	struct em_stat st;
 
 	L=new LoadingState;
 	L->Stage=0;
@@ -480,16 +733,19 @@ void emTextFileModel::TryStartLoading()
 	L->File=NULL;
 	L->FileSize=0;
 	L->FileRead=0;
+	L->BlockDevice=false;
 
 	L->File=fopen(GetFilePath(),"rb");
 	if (!L->File) goto Err;
-	l=fseek(L->File,0,SEEK_END);
-	if (l) goto Err;
-	l=ftell(L->File);
-	if (l<0) goto Err;
-	L->FileSize=l;
-	l=fseek(L->File,0,SEEK_SET);
-	if (l) goto Err;
+	if (em_stat(GetFilePath(),&st)!=0) goto Err;
+	L->FileSize=st.st_size;
+#	if defined(S_IFBLK)
+		if ((st.st_mode&S_IFMT)==S_IFBLK) {
+			L->BlockDevice=true;
+			L->FileSize=(emUInt64)emMax(GetOpenFileSize(L->File),(emInt64)0);
+		}
+#	endif
+	FileINode=st.st_ino;
 	return;
 
 Err:
@@ -500,31 +756,47 @@ Err:
 bool emTextFileModel::TryContinueLoading()
 {
 	const char * p;
-	int * s;
-	int i,j,end,cnt,len,sa,sb,n,c,c2,row,col,col1,col2;
+	emInt64 i,end,cnt,sa,sb,indexEnd;
+	int len,c,c2;
 	struct em_stat st;
 
 	switch (L->Stage) {
 	case 0:
-		// Set size of Content.
-		if (L->FileSize>(emUInt64)INT_MAX) throw emException("File too large.");
-		Content.SetCount((int)L->FileSize,true);
+		// Allocate ContentBuf. Block devices are windowed: nothing is
+		// loaded, and the content is binary. Files which are too large
+		// for the memory limit (with room for the line index) are
+		// mapped instead of being read.
+		if (L->BlockDevice) {
+			OpenWindow(L->File,(emInt64)L->FileSize);
+			L->File=NULL;
+			L->Stage=16;
+			break;
+		}
+		if (
+			L->FileSize>GetMemoryLimit()/4*3 ||
+			!ResizeContentBuf((emInt64)L->FileSize)
+		) {
+			if (!MapContent(L->File,(emInt64)L->FileSize)) {
+				throw emException("file too large");
+			}
+			L->FileRead=L->FileSize;
+			L->Stage=4;
+			break;
+		}
 		L->Stage=1;
 		break;
 	case 1:
 		// Load up to FileSize bytes.
-		len=(int)(L->FileSize-L->FileRead);
-		if (len>4096) len=4096;
-		len=(int)fread(Content.GetWritable()+(size_t)L->FileRead,1,len,L->File);
+		len=(int)emMin(L->FileSize-L->FileRead,(emUInt64)READ_SIZE);
+		len=(int)fread(ContentBuf+(size_t)L->FileRead,1,len,L->File);
 		if (len>0) {
 			L->FileRead+=len;
 		}
 		else {
 			L->FileSize=L->FileRead;
-			Content.SetCount((int)L->FileRead,true);
 			L->Stage=2;
 		}
-		L->Progress=75.0*L->FileRead/L->FileSize;
+		if (L->FileSize>0) L->Progress=75.0*L->FileRead/L->FileSize;
 		break;
 	case 2:
 		// ??? hack/bug/workaround...
@@ -554,10 +826,13 @@ bool emTextFileModel::TryContinueLoading()
 		// Read beyond the end of the file.
 		len=fread(L->Buf,1,sizeof(L->Buf),L->File);
 		if (len>0) {
-			if (((emUInt64)Content.GetCount())+((emUInt64)len)>(emUInt64)INT_MAX) {
+			if (
+				L->FileRead+len>GetMemoryLimit() ||
+				!ResizeContentBuf((emInt64)(L->FileRead+len))
+			) {
 				throw emException("file too large");
 			}
-			Content.Add(L->Buf,len,true);
+			memcpy(ContentBuf+(size_t)L->FileRead,L->Buf,len);
 			L->FileRead+=len;
 			L->FileSize=L->FileRead;
 		}
@@ -567,8 +842,16 @@ bool emTextFileModel::TryContinueLoading()
 		break;
 	case 4:
 		// Start of UTF-16 detection
+		if (ContentBuf) Content=ContentBuf;
+		ContentSize=(emInt64)L->FileRead;
+		if (ContentSize>=LARGE_CONTENT_SIZE) {
+			L->DetectEnd=emMin(ContentSize,(emInt64)DETECTION_SIZE);
+		}
+		else {
+			L->DetectEnd=ContentSize;
+		}
 		L->Stage=6;
-		if ((Content.GetCount()&1)==0 && Content.GetCount()>=2) {
+		if ((ContentSize&1)==0 && ContentSize>=2) {
 			c=(emByte)Content[0];
 			c2=(emByte)Content[1];
 			if (c==0xFF && c2==0xFE) {
@@ -588,10 +871,10 @@ bool emTextFileModel::TryContinueLoading()
 	case 5:
 		// Rest of UTF-16 detection
 		i=L->Pos;
-		cnt=Content.GetCount();
-		if (i<cnt) {
-			p=Content.Get();
-			end=i+emMin(cnt-i,65536);
+		cnt=ContentSize;
+		if (i<(L->DetectEnd&~(emInt64)1)) {
+			p=Content;
+			end=i+emMin((L->DetectEnd&~(emInt64)1)-i,(emInt64)65536);
 			for (; i<end; i+=2) {
 				c=(emByte)p[i];
 				c2=(emByte)p[i+1];
@@ -625,76 +908,64 @@ bool emTextFileModel::TryContinueLoading()
 		}
 		break;
 	case 6:
-		// Prepare for character code statistics.
-		memset(L->Statistics,0,sizeof(L->Statistics));
+		// Prepare for the fused pass of character code classification
+		// and UTF-8 validation.
+		memset(&L->Counts,0,sizeof(L->Counts));
+		L->Counts.Utf8Valid=true;
+		L->DetectCount=0;
 		L->StartPos=0;
 		L->Pos=0;
+		L->Sample=0;
 		L->Stage=7;
 		break;
 	case 7:
-		// Create character code statistics.
+		// Classify character codes and validate UTF-8, at the beginning
+		// and then in samples from the rest.
 		i=L->Pos;
-		cnt=Content.GetCount();
-		if (i<cnt) {
-			s=L->Statistics;
-			p=Content.Get();
-			end=i+emMin(cnt-i,65536);
-			for (; i<end; i++) s[(emByte)p[i]]++;
-			L->Pos=i;
+		if (i<L->DetectEnd) {
+			end=i+emMin(
+				L->DetectEnd-i,
+				(emInt64)CHUNK_SIZE*ThreadPool->GetThreadCount()
+			);
+			ClassifyBytes(i,end,&L->Counts);
+			L->DetectCount+=end-i;
+			L->Pos=end;
+			L->Progress=75.0+10.0*L->Pos/L->DetectEnd;
+		}
+		else if (
+			L->DetectEnd<ContentSize &&
+			L->Sample<DETECTION_SAMPLE_COUNT
+		) {
+			i=L->DetectEnd+
+				(ContentSize-L->DetectEnd)*L->Sample/DETECTION_SAMPLE_COUNT;
+			end=emMin(i+(emInt64)DETECTION_SAMPLE_SIZE,ContentSize);
+			ClassifyBytes(i,end,&L->Counts);
+			L->DetectCount+=end-i;
+			L->Sample++;
 		}
 		else {
 			L->Stage=8;
 		}
-		L->Progress=75.0+5.0*L->Pos/Content.GetCount();
 		break;
 	case 8:
-		// Test if binary or 7-bit. Otherwise prepare for UTF-8 detection.
-		s=L->Statistics;
-		sa=s[0]+s[1]+s[2]+s[3]+s[4]+s[5];
-		sb=
-			s[6]+s[14]+s[15]+s[16]+s[17]+s[18]+s[19]+s[20]+s[21]+s[22]+
-			s[23]+s[24]+s[25]+s[26]+s[27]+s[28]+s[29]+s[30]+s[31]+s[127]
-		;
-		if (sa>0 || sb>Content.GetCount()/1000) {
+		// Decide about the character encoding.
+		sa=L->Counts.Binary;
+		sb=L->Counts.Control;
+		if (sa>0 || sb>L->DetectCount/1000) {
 			CharEncoding=CE_BINARY;
 			L->Stage=16;
 		}
-		else {
-			for (sa=0, i=128; i<256; i++) sa+=s[i];
-			if (sa==0) {
-				CharEncoding=CE_7BIT;
-				L->Stage=10;
-			}
-			else {
-				L->Stage=9;
-				L->Pos=0;
-			}
+		else if (L->Counts.High==0) {
+			CharEncoding=CE_7BIT;
+			L->Stage=10;
 		}
-		break;
-	case 9:
-		// UTF-8 detection.
-		i=L->Pos;
-		cnt=Content.GetCount();
-		if (i<cnt) {
-			p=Content.Get();
-			end=i+emMin(cnt-i,65536);
-			for (; i<end; i++) {
-				if (((signed char)p[i])<0) {
-					n=emDecodeUtf8Char(&c,p+i,cnt-i);
-					n--;
-					if (n<0) break;
-					i+=n;
-				}
-			}
-			if (i<end) {
-				CharEncoding=CE_8BIT;
-				L->Stage=10;
-			}
-			L->Pos=i;
+		else if (!L->Counts.Utf8Valid) {
+			CharEncoding=CE_8BIT;
+			L->Stage=10;
 		}
 		else {
 			if (
-				cnt>=3 &&
+				ContentSize>=3 &&
 				(emByte)Content[0]==0xEF &&
 				(emByte)Content[1]==0xBB &&
 				(emByte)Content[2]==0xBF
@@ -702,243 +973,32 @@ bool emTextFileModel::TryContinueLoading()
 			CharEncoding=CE_UTF8;
 			L->Stage=10;
 		}
-		L->Progress=80.0+5.0*L->Pos/Content.GetCount();
 		break;
 	case 10:
-		// Prepare for detecting line breaks.
-		LineCount=0;
-		L->FoundCR=false;
-		L->FoundLF=false;
-		L->FoundCRLF=false;
-		L->Pos=L->StartPos;
+		// Prepare for building the line index.
+		TextStart=L->StartPos;
+		StartIndexing(TextStart);
+		if (ContentSize>0) LineStarts.Add(TextStart);
 		L->Stage=11;
 		break;
 	case 11:
-		// Detect line breaks.
-		i=L->Pos;
-		p=Content.Get();
-		cnt=Content.GetCount();
-		if (i<cnt) {
-			end=i+emMin(cnt-i,65536);
-			while (i<end) {
-				c=(emByte)p[i++];
-				if (CharEncoding==CE_UTF16LE) c|=((emByte)p[i++])<<8;
-				else if (CharEncoding==CE_UTF16BE) c=(c<<8)|(emByte)p[i++];
-				if (c<=0x0d) {
-					if (c==0x0d) {
-						if (i<cnt) {
-							j=i;
-							c=(emByte)p[j++];
-							if (CharEncoding==CE_UTF16LE) c|=((emByte)p[j++])<<8;
-							else if (CharEncoding==CE_UTF16BE) c=(c<<8)|(emByte)p[j++];
-							if (c==0x0a) {
-								L->FoundCRLF=true;
-								i=j;
-							}
-							else {
-								L->FoundCR=true;
-							}
-						}
-						else {
-							L->FoundCR=true;
-						}
-						LineCount++;
-					}
-					else if (c==0x0a) {
-						L->FoundLF=true;
-						LineCount++;
-					}
-				}
-			}
-			L->Pos=i;
-		}
-		else {
-			if (cnt>0) {
-				c=(emByte)p[cnt-1];
-				if (CharEncoding==CE_UTF16LE) c=(c<<8)|(emByte)p[cnt-2];
-				else if (CharEncoding==CE_UTF16BE) c|=((emByte)p[cnt-2])<<8;
-				if (c!=0x0d && c!=0x0a) LineCount++;
-			}
-			if (!L->FoundCR && !L->FoundLF && !L->FoundCRLF) LineBreakEncoding=LBE_NONE;
-			else if (L->FoundCR && !L->FoundLF && !L->FoundCRLF) LineBreakEncoding=LBE_MAC;
-			else if (!L->FoundCR && L->FoundLF && !L->FoundCRLF) LineBreakEncoding=LBE_UNIX;
-			else if (!L->FoundCR && !L->FoundLF && L->FoundCRLF) LineBreakEncoding=LBE_DOS;
-			else LineBreakEncoding=LBE_MIXED;
-			L->Stage=12;
-		}
-		L->Progress=85.0+5.0*L->Pos/Content.GetCount();
-		break;
-	case 12:
-		// Prepare for detecting line starts and column count.
-		LineStarts=new int[LineCount];
-		if (LineCount>0) LineStarts[0]=L->StartPos;
-		L->Pos=L->StartPos;
-		L->Col=0;
-		L->Row=1;
-		L->MBState.Clear();
-		L->Stage=13;
-		break;
-	case 13:
-		// Detect line starts and column count.
-		i=L->Pos;
-		cnt=Content.GetCount();
-		col=L->Col;
-		row=L->Row;
-		if (i<cnt) {
-			p=Content.Get();
-			end=i+emMin(cnt-i,65536);
-			while (i<end) {
-				c=(emByte)p[i++];
-				if (CharEncoding==CE_UTF16LE) c|=((emByte)p[i++])<<8;
-				else if (CharEncoding==CE_UTF16BE) c=(c<<8)|(emByte)p[i++];
-				if (c<=0x0d) {
-					if (c==0x09) {
-						col=(col+8)&~7;
-					}
-					else if (c==0x0a || c==0x0d) {
-						if (c==0x0d && i<cnt) {
-							j=i;
-							c=(emByte)p[j++];
-							if (CharEncoding==CE_UTF16LE) c|=((emByte)p[j++])<<8;
-							else if (CharEncoding==CE_UTF16BE) c=(c<<8)|(emByte)p[j++];
-							if (c==0x0a) i=j;
-						}
-						if (ColumnCount<col) ColumnCount=col;
-						col=0;
-						if (row<LineCount) LineStarts[row++]=i;
-					}
-					else {
-						col++;
-					}
-				}
-				else {
-					col++;
-					if (c>=128) {
-						if (CharEncoding==CE_UTF8) {
-							n=emDecodeUtf8Char(&c,p+i-1,cnt-i+1);
-							if (n>1) i+=n-1;
-						}
-						else if (CharEncoding==CE_8BIT && !emIsUtf8System()) {
-							n=emDecodeChar(&c,p+i-1,cnt-i+1,&L->MBState);
-							if (n>1) i+=n-1;
-						}
-						else if (
-							c>=0xD800 && c<=0xDBFF && i<cnt &&
-							(CharEncoding==CE_UTF16LE || CharEncoding==CE_UTF16BE)
-						) {
-							c=(emByte)p[i];
-							if (CharEncoding==CE_UTF16LE) c|=((emByte)p[i+1])<<8;
-							else c=(c<<8)|(emByte)p[i+1];
-							if (c>=0xDC00 && c<=0xDFFF) i+=2;
-						}
-					}
-				}
-			}
-			L->Pos=i;
+		// Build the line index. With large content, only the beginning
+		// is indexed here, and the rest is indexed by Cycle().
+		indexEnd=ContentSize;
+		if (ContentSize>=LARGE_CONTENT_SIZE) {
+			indexEnd=emMin(indexEnd,I->StartPos+INITIAL_INDEX_SIZE);
 		}
-		else {
-			if (ColumnCount<col) ColumnCount=col;
-			L->Stage=14;
-		}
-		L->Col=col;
-		L->Row=row;
-		L->Progress=90.0+5.0*L->Pos/Content.GetCount();
-		break;
-	case 14:
-		// Prepare for calculating relative line indents and widths.
-		RelativeLineIndents=new emUInt8[LineCount];
-		RelativeLineWidths=new emUInt8[LineCount];
-		L->Pos=L->StartPos;
-		L->Row=0;
-		L->Col=0;
-		L->Col1=ColumnCount;
-		L->Col2=0;
-		L->MBState.Clear();
-		L->Stage=15;
-		break;
-	case 15:
-		// Calculate relative line indents and widths.
-		i=L->Pos;
-		cnt=Content.GetCount();
-		row=L->Row;
-		col=L->Col;
-		col1=L->Col1;
-		col2=L->Col2;
-		if (i<cnt) {
-			p=Content.Get();
-			end=i+emMin(cnt-i,65536);
-			while (i<end) {
-				c=(emByte)p[i++];
-				if (CharEncoding==CE_UTF16LE) c|=((emByte)p[i++])<<8;
-				else if (CharEncoding==CE_UTF16BE) c=(c<<8)|(emByte)p[i++];
-				if (c<=0x20) {
-					if (c==0x09) {
-						col=(col+8)&~7;
-					}
-					else if (c==0x0a || c==0x0d) {
-						if (c==0x0d && i<cnt) {
-							j=i;
-							c=(emByte)p[j++];
-							if (CharEncoding==CE_UTF16LE) c|=((emByte)p[j++])<<8;
-							else if (CharEncoding==CE_UTF16BE) c=(c<<8)|(emByte)p[j++];
-							if (c==0x0a) i=j;
-						}
-						if (row<LineCount) {
-							if (col1>col) col1=col;
-							if (col2<col1) col2=col1;
-							RelativeLineIndents[row]=(emUInt8)(col1*256/(ColumnCount+1));
-							RelativeLineWidths[row]=(emUInt8)((col2-col1)*256/(ColumnCount+1));
-							row++;
-						}
-						col=0;
-						col1=ColumnCount;
-						col2=0;
-					}
-					else {
-						col++;
-					}
-				}
-				else {
-					if (col1>col) col1=col;
-					col++;
-					col2=col;
-					if (c>=128) {
-						if (CharEncoding==CE_UTF8) {
-							n=emDecodeUtf8Char(&c,p+i-1,cnt-i+1);
-							if (n>1) i+=n-1;
-						}
-						else if (CharEncoding==CE_8BIT && !emIsUtf8System()) {
-							n=emDecodeChar(&c,p+i-1,cnt-i+1,&L->MBState);
-							if (n>1) i+=n-1;
-						}
-						else if (
-							c>=0xD800 && c<=0xDBFF && i<cnt &&
-							(CharEncoding==CE_UTF16LE || CharEncoding==CE_UTF16BE)
-						) {
-							c=(emByte)p[i];
-							if (CharEncoding==CE_UTF16LE) c|=((emByte)p[i+1])<<8;
-							else c=(c<<8)|(emByte)p[i+1];
-							if (c>=0xDC00 && c<=0xDFFF) i+=2;
-						}
-					}
-				}
-			}
-			L->Pos=i;
+		ContinueIndexing(emMin(
+			I->Scan.Pos+CHUNK_SIZE*ThreadPool->GetThreadCount(),
+			indexEnd
+		));
+		if (!I || I->Scan.Pos>=indexEnd) {
+			L->Stage=16;
+			L->Progress=100.0;
 		}
 		else {
-			if (row<LineCount) {
-				if (col1>col) col1=col;
-				if (col2<col1) col2=col1;
-				RelativeLineIndents[row]=(emUInt8)(col1*256/(ColumnCount+1));
-				RelativeLineWidths[row]=(emUInt8)((col2-col1)*256/(ColumnCount+1));
-			}
-			L->Stage=16;
+			L->Progress=85.0+15.0*(I->Scan.Pos-I->StartPos)/(indexEnd-I->StartPos);
 		}
-		L->Row=row;
-		L->Col=col;
-		L->Col1=col1;
-		L->Col2=col2;
-		L->Progress=95.0+5.0*L->Pos/Content.GetCount();
 		break;
 	case 16:
 		// Finished.
@@ -979,12 +1039,22 @@ void emTextFileModel::QuitSaving()
 
 emUInt64 emTextFileModel::CalcMemoryNeed()
 {
-	emUInt64 m;
+	emUInt64 m,n;
 
-	if (L) m=L->FileSize; else m=Content.GetCount();
+	if (W) m=WINDOW_PAGE_COUNT*WINDOW_PAGE_SIZE;
+	else if (MappedAddr) m=0;
+	else if (L && L->Stage>0) m=emMax(L->FileSize,(emUInt64)ContentBufSize);
+	else m=ContentBufSize;
 
 	if (CharEncoding!=CE_BINARY) {
-		m+=6*LineCount;
+		// While indexing, extrapolate the size of the line index.
+		n=LineStarts.GetCount();
+		if (I && I->Scan.Pos>I->StartPos) {
+			n=(emUInt64)(
+				((double)n)*(ContentSize-I->StartPos)/(I->Scan.Pos-I->StartPos)
+			);
+		}
+		m+=n*(sizeof(emInt64)+2*sizeof(emUInt16));
 	}
 
 	return m;
@@ -995,3 +1065,845 @@ double emTextFileModel::CalcFileProgress()
 {
 	return L ? L->Progress : 0.0;
 }
+
+
+emInt64 emTextFileModel::GetOpenFileSize(FILE * file)
+{
+	// This works with block devices too, where stat reports zero size.
+#if defined(_WIN32)
+	return _lseeki64(fileno(file),0,SEEK_END);
+#elif defined(__linux__)
+	return lseek64(fileno(file),0,SEEK_END);
+#else
+	return lseek(fileno(file),0,SEEK_END);
+#endif
+}
+
+
+bool emTextFileModel::SeekFile(FILE * file, emInt64 pos)
+{
+#if defined(_WIN32)
+	return _fseeki64(file,pos,SEEK_SET)==0;
+#elif defined(__linux__)
+	return fseeko64(file,pos,SEEK_SET)==0;
+#else
+	return fseeko(file,(off_t)pos,SEEK_SET)==0;
+#endif
+}
+
+
+int emTextFileModel::ReadFileAt(
+	FILE * file, emInt64 pos, char * buf, int len
+)
+{
+	int n,r;
+
+	for (n=0; n<len; n+=r) {
+#		if defined(_WIN32)
+			// No pread here, but the caller holds the window mutex.
+			if (_lseeki64(fileno(file),pos+n,SEEK_SET)<0) break;
+			r=_read(fileno(file),buf+n,len-n);
+#		elif defined(__linux__)
+			r=(int)pread64(fileno(file),buf+n,len-n,pos+n);
+#		else
+			r=(int)pread(fileno(file),buf+n,len-n,(off_t)(pos+n));
+#		endif
+		if (r<=0) break;
+	}
+	return n;
+}
+
+
+void emTextFileModel::OpenWindow(FILE * file, emInt64 size)
+{
+	int i;
+
+	CloseWindow();
+	W=new WindowState;
+	W->File=file;
+	W->UseClock=0;
+	for (i=0; i<WINDOW_PAGE_COUNT; i++) {
+		W->Pages[i].Pos=-1;
+		W->Pages[i].Size=0;
+		W->Pages[i].LastUse=0;
+		W->Pages[i].Data=NULL;
+	}
+	Content="";
+	ContentSize=size;
+	CharEncoding=CE_BINARY;
+}
+
+
+void emTextFileModel::CloseWindow()
+{
+	int i;
+
+	if (W) {
+		for (i=0; i<WINDOW_PAGE_COUNT; i++) {
+			if (W->Pages[i].Data) delete [] W->Pages[i].Data;
+		}
+		fclose(W->File);
+		delete W;
+		W=NULL;
+		Content="";
+		ContentSize=0;
+	}
+}
+
+
+const emTextFileModel::WindowPage * emTextFileModel::GetWindowPage(
+	emInt64 index
+) const
+{
+	WindowPage * page;
+	emInt64 pos;
+	int i,len;
+
+	// The window mutex must be locked by the caller.
+	pos=index-index%WINDOW_PAGE_SIZE;
+	W->UseClock++;
+	page=W->Pages;
+	for (i=0; i<WINDOW_PAGE_COUNT; i++) {
+		if (W->Pages[i].Pos==pos) {
+			W->Pages[i].LastUse=W->UseClock;
+			return W->Pages+i;
+		}
+		if (W->Pages[i].LastUse<page->LastUse) page=W->Pages+i;
+	}
+
+	if (!page->Data) page->Data=new char[WINDOW_PAGE_SIZE];
+	len=(int)emMin(ContentSize-pos,(emInt64)WINDOW_PAGE_SIZE);
+	page->Size=ReadFileAt(W->File,pos,page->Data,len);
+	if (page->Size<=0) {
+		page->Pos=-1;
+		page->LastUse=0;
+		return NULL;
+	}
+	page->Pos=pos;
+	page->LastUse=W->UseClock;
+	return page;
+}
+
+
+bool emTextFileModel::MapContent(FILE * file, emInt64 size)
+{
+	void * addr;
+
+	// Maps size bytes of the file, replacing any former mapping.
+	if (size<=0 || (emUInt64)(size_t)size!=(emUInt64)size) return false;
+
+#if defined(_WIN32)
+	HANDLE fh,mh;
+
+	fh=(HANDLE)_get_osfhandle(fileno(file));
+	if (fh==INVALID_HANDLE_VALUE) return false;
+	mh=CreateFileMapping(fh,NULL,PAGE_READONLY,0,0,NULL);
+	if (!mh) return false;
+	addr=MapViewOfFile(mh,FILE_MAP_READ,0,0,(SIZE_T)size);
+	CloseHandle(mh);
+	if (!addr) return false;
+#else
+	addr=mmap(NULL,(size_t)size,PROT_READ,MAP_PRIVATE,fileno(file),0);
+	if (addr==MAP_FAILED) return false;
+	if (!emTextFileModel_GuardMapping(addr,(size_t)size)) {
+		munmap(addr,(size_t)size);
+		return false;
+	}
+#endif
+
+	UnmapContent();
+	MappedAddr=addr;
+	MappedSize=size;
+	Content=(const char*)addr;
+	ContentSize=size;
+	if (!FollowTimer.IsRunning()) FollowTimer.Start(FOLLOW_INTERVAL,true);
+	return true;
+}
+
+
+void emTextFileModel::UnmapContent()
+{
+	if (MappedAddr) {
+#if defined(_WIN32)
+		UnmapViewOfFile(MappedAddr);
+#else
+		emTextFileModel_UnguardMapping(MappedAddr);
+		munmap(MappedAddr,(size_t)MappedSize);
+#endif
+		MappedAddr=NULL;
+		MappedSize=0;
+		Content="";
+		ContentSize=0;
+		if (FollowerCount<=0) FollowTimer.Stop(true);
+	}
+}
+
+
+bool emTextFileModel::ResizeContentBuf(emInt64 size)
+{
+	char * p;
+
+	if (size<=ContentBufSize) return true;
+	if ((emUInt64)(size_t)size!=(emUInt64)size) return false;
+	p=(char*)realloc(ContentBuf,(size_t)size);
+	if (!p) return false;
+	ContentBuf=p;
+	ContentBufSize=size;
+	return true;
+}
+
+
+void emTextFileModel::FreeContentBuf()
+{
+	if (ContentBuf) {
+		free(ContentBuf);
+		ContentBuf=NULL;
+		ContentBufSize=0;
+	}
+}
+
+
+bool emTextFileModel::AppendContent(emInt64 newSize)
+{
+	FILE * file;
+	emInt64 oldSize;
+	size_t len;
+	bool ok;
+
+	if (MappedAddr) {
+		file=fopen(GetFilePath(),"rb");
+		if (!file) return false;
+		ok=MapContent(file,newSize);
+		fclose(file);
+		return ok;
+	}
+
+	if (!ResizeContentBuf(newSize)) return false;
+
+	file=fopen(GetFilePath(),"rb");
+	if (!file) return false;
+
+	oldSize=ContentSize;
+	len=0;
+	if (SeekFile(file,oldSize)) {
+		len=fread(ContentBuf+(size_t)oldSize,1,(size_t)(newSize-oldSize),file);
+	}
+	Content=ContentBuf;
+	ContentSize=oldSize+(emInt64)len;
+
+	fclose(file);
+	return len>0;
+}
+
+
+void emTextFileModel::FollowFile()
+{
+	ByteClassCounts counts;
+	struct em_stat st;
+	emInt64 oldSize,newSize,pos,end;
+	int n,c;
+
+	if (GetFileState()==FS_LOAD_ERROR) {
+		// The file may have been deleted and is to be created anew.
+		Update();
+		return;
+	}
+	if (GetFileState()!=FS_LOADED) return;
+
+	if (em_stat(GetFilePath(),&st)!=0 || (emUInt64)st.st_ino!=FileINode) {
+		// Deleted or replaced. (A mapping of the old file stays valid.)
+		if (FollowerCount>0) Update();
+		return;
+	}
+
+	if (W) newSize=GetOpenFileSize(W->File);
+	else newSize=st.st_size;
+	if (newSize<ContentSize) {
+		// Truncated.
+		Update();
+		return;
+	}
+
+	// Without followers, mapped content is only checked for truncation.
+	if (FollowerCount<=0) return;
+
+	if (W) {
+		// Windowed content has no line index, so just take the new
+		// size and forget the incomplete last page.
+		if (newSize>ContentSize) {
+			W->Mutex.Lock();
+			for (n=0; n<WINDOW_PAGE_COUNT; n++) {
+				if (W->Pages[n].Size<WINDOW_PAGE_SIZE) W->Pages[n].Pos=-1;
+			}
+			ContentSize=newSize;
+			W->Mutex.Unlock();
+			try {
+				TryFetchDate();
+			}
+			catch (const emException &) {
+			}
+			Signal(LineIndexSignal);
+		}
+		return;
+	}
+
+	if (CharEncoding==CE_UTF16LE || CharEncoding==CE_UTF16BE) {
+		newSize&=~(emInt64)1;
+	}
+	if (newSize<=ContentSize) return;
+
+	oldSize=ContentSize;
+	if (!AppendContent(newSize)) return;
+	try {
+		TryFetchDate();
+	}
+	catch (const emException &) {
+	}
+
+	if (!I && CharEncoding!=CE_BINARY && LineCount<MAX_LINE_COUNT) {
+		// Continue indexing at the last line, unless it is terminated
+		// by a line feed, because it may be continued by the appended
+		// data (even a CR may be continued to a CRLF).
+		n=LineIndents.GetCount();
+		if (n<=0) {
+			pos=TextStart;
+		}
+		else {
+			if (CharEncoding==CE_UTF16LE) {
+				c=((emByte)Content[oldSize-2])|(((emByte)Content[oldSize-1])<<8);
+			}
+			else if (CharEncoding==CE_UTF16BE) {
+				c=(((emByte)Content[oldSize-2])<<8)|((emByte)Content[oldSize-1]);
+			}
+			else {
+				c=(emByte)Content[oldSize-1];
+			}
+			if (c==0x0a) {
+				pos=oldSize;
+			}
+			else {
+				n--;
+				pos=LineStarts[n];
+				LineIndents.SetCount(n);
+				LineWidths.SetCount(n);
+			}
+		}
+		LineStarts.SetCount(n);
+		LineStarts.Add(pos);
+		LineCount=n;
+
+		// A 7-bit text may become UTF-8 or 8-bit. Only complete lines
+		// are checked, because a multi-byte character may be written
+		// partly yet.
+		if (CharEncoding==CE_7BIT) {
+			for (
+				end=ContentSize;
+				end>pos && Content[end-1]!=0x0a && Content[end-1]!=0x0d;
+				end--
+			);
+			if (end>pos) {
+				memset(&counts,0,sizeof(counts));
+				counts.Utf8Valid=true;
+				ClassifyBytes(pos,end,&counts);
+				if (counts.High>0) {
+					CharEncoding=counts.Utf8Valid ? CE_UTF8 : CE_8BIT;
+				}
+			}
+		}
+
+		StartIndexing(pos);
+	}
+
+	Signal(LineIndexSignal);
+}
+
+
+void emTextFileModel::ClassifyBytes(
+	emInt64 begin, emInt64 end, ByteClassCounts * counts
+)
+{
+	ClassifyChunk * chunks;
+	ClassifyThreadData data;
+	emInt64 v;
+	int i,n;
+
+	n=ThreadPool->GetThreadCount();
+	if (n>(end-begin)/CHUNK_SIZE) n=(int)((end-begin)/CHUNK_SIZE);
+	if (n<1) n=1;
+
+	chunks=new ClassifyChunk[n];
+	for (i=0; i<n; i++) {
+		chunks[i].Begin=begin+(end-begin)*i/n;
+		chunks[i].End=begin+(end-begin)*(i+1)/n;
+		if (!counts->Utf8Valid) {
+			v=chunks[i].End;
+		}
+		else {
+			// Start validation at the beginning of the UTF-8 sequence
+			// which contains the first byte. Validating a sequence
+			// twice does not hurt.
+			v=chunks[i].Begin;
+			while (
+				v>0 && v>chunks[i].Begin-3 &&
+				(((emByte)Content[v])&0xC0)==0x80
+			) v--;
+		}
+		chunks[i].ValidateFrom=v;
+	}
+
+	data.Model=this;
+	data.Chunks=chunks;
+	if (n>1) ThreadPool->CallParallel(ClassifyBytesThreadFunc,&data,n);
+	else ClassifyBytesThreadFunc(&data,0);
+
+	for (i=0; i<n; i++) {
+		counts->Binary+=chunks[i].Counts.Binary;
+		counts->Control+=chunks[i].Counts.Control;
+		counts->High+=chunks[i].Counts.High;
+		if (!chunks[i].Counts.Utf8Valid) counts->Utf8Valid=false;
+	}
+	delete [] chunks;
+}
+
+
+void emTextFileModel::StartIndexing(emInt64 startPos)
+{
+	I=new IndexingState;
+	I->StartPos=startPos;
+	I->Scan.Pos=startPos;
+	I->Scan.End=startPos;
+	I->Scan.Col=0;
+	I->Scan.Col1=INT_MAX;
+	I->Scan.Col2=0;
+	I->Scan.ColumnCount=ColumnCount;
+	I->Scan.FoundCR=(
+		LineBreakEncoding==LBE_MAC || LineBreakEncoding==LBE_MIXED
+	);
+	I->Scan.FoundLF=(
+		LineBreakEncoding==LBE_UNIX || LineBreakEncoding==LBE_MIXED
+	);
+	I->Scan.FoundCRLF=(LineBreakEncoding==LBE_DOS);
+	I->Scan.Starts=&LineStarts;
+	I->Scan.Indents=&LineIndents;
+	I->Scan.Widths=&LineWidths;
+	I->Scan.MaxLines=MAX_LINE_COUNT;
+	I->LastSignalClock=emGetClockMS();
+}
+
+
+bool emTextFileModel::ContinueIndexing(emInt64 endPos)
+{
+	LineScan * scan;
+	emInt64 size;
+	int oldLineCount;
+
+	scan=&I->Scan;
+	oldLineCount=LineCount;
+	size=ContentSize;
+	if (CharEncoding==CE_UTF16LE || CharEncoding==CE_UTF16BE) {
+		// An odd last byte is ignored.
+		size&=~(emInt64)1;
+	}
+	if (endPos>size) endPos=size;
+
+	if (CanScanLinesFast()) ScanLinesParallel(endPos);
+	else ScanLinesSerial(endPos);
+
+	if (
+		scan->Pos>=size &&
+		LineStarts.GetCount()>LineIndents.GetCount() &&
+		LineIndents.GetCount()<MAX_LINE_COUNT
+	) {
+		// Finish the last line, which has no line break.
+		scan->FinishLine(ContentSize,ContentSize);
+	}
+
+	LineCount=LineIndents.GetCount();
+	ColumnCount=scan->ColumnCount;
+
+	if (!scan->FoundCR && !scan->FoundLF && !scan->FoundCRLF) LineBreakEncoding=LBE_NONE;
+	else if (scan->FoundCR && !scan->FoundLF && !scan->FoundCRLF) LineBreakEncoding=LBE_MAC;
+	else if (!scan->FoundCR && scan->FoundLF && !scan->FoundCRLF) LineBreakEncoding=LBE_UNIX;
+	else if (!scan->FoundCR && !scan->FoundLF && scan->FoundCRLF) LineBreakEncoding=LBE_DOS;
+	else LineBreakEncoding=LBE_MIXED;
+
+	if (scan->Pos>=size || LineCount>=MAX_LINE_COUNT) {
+		delete I;
+		I=NULL;
+	}
+
+	return LineCount!=oldLineCount;
+}
+
+
+bool emTextFileModel::CanScanLinesFast() const
+{
+	// The fast kernels only handle encodings where a line break is a
+	// single byte which cannot be part of a multi-byte character, and
+	// which need no decoding state.
+	switch (CharEncoding) {
+	case CE_7BIT:
+	case CE_UTF8:
+		return true;
+	case CE_8BIT:
+		return emIsUtf8System();
+	default:
+		return false;
+	}
+}
+
+
+void emTextFileModel::ScanLinesParallel(emInt64 endPos)
+{
+	ScanChunk * chunks, * c;
+	ScanLinesThreadData data;
+	LineScan * scan;
+	emInt64 begin;
+	bool utf8;
+	int i,n;
+
+	scan=&I->Scan;
+	utf8=(CharEncoding==CE_UTF8);
+	begin=scan->Pos;
+
+	n=ThreadPool->GetThreadCount();
+	if (n>(endPos-begin)/CHUNK_SIZE) n=(int)((endPos-begin)/CHUNK_SIZE);
+	if (n<2) {
+		scan->End=endPos;
+		ScanLinesKernel(Content,ContentSize,utf8,scan);
+		return;
+	}
+
+	// Each chunk but the first is scanned from its first line start by
+	// another thread, into separate arrays. The first chunk continues
+	// the current state.
+	chunks=new ScanChunk[n];
+	for (i=0; i<n; i++) {
+		c=chunks+i;
+		c->Begin=begin+(endPos-begin)*i/n;
+		c->End=begin+(endPos-begin)*(i+1)/n;
+		c->Valid=(i==0);
+		c->FirstStart=c->Begin;
+		if (i==0) {
+			c->Scan=*scan;
+		}
+		else {
+			c->Scan.Col=0;
+			c->Scan.Col1=INT_MAX;
+			c->Scan.Col2=0;
+			c->Scan.ColumnCount=0;
+			c->Scan.FoundCR=false;
+			c->Scan.FoundLF=false;
+			c->Scan.FoundCRLF=false;
+			c->Scan.Starts=&c->Starts;
+			c->Scan.Indents=&c->Indents;
+			c->Scan.Widths=&c->Widths;
+			c->Scan.MaxLines=MAX_LINE_COUNT;
+		}
+		c->Scan.Pos=c->Begin;
+		c->Scan.End=c->End;
+	}
+
+	data.Model=this;
+	data.Chunks=chunks;
+	data.Utf8=utf8;
+	ThreadPool->CallParallel(ScanLinesThreadFunc,&data,n);
+
+	// Join the results in order. The part of a chunk before its first
+	// line start continues the line of the previous chunk and is
+	// scanned here.
+	*scan=chunks[0].Scan;
+	for (i=1; i<n; i++) {
+		c=chunks+i;
+		if (c->Valid) {
+			scan->End=c->FirstStart;
+			ScanLinesKernel(Content,ContentSize,utf8,scan);
+			if (
+				scan->Pos==c->FirstStart &&
+				LineStarts.GetCount()==LineIndents.GetCount()+1 &&
+				LineStarts[LineStarts.GetCount()-1]==c->FirstStart
+			) {
+				LineStarts.Add(c->Starts);
+				LineIndents.Add(c->Indents);
+				LineWidths.Add(c->Widths);
+				scan->Pos=c->Scan.Pos;
+				scan->Col=c->Scan.Col;
+				scan->Col1=c->Scan.Col1;
+				scan->Col2=c->Scan.Col2;
+				if (scan->ColumnCount<c->Scan.ColumnCount) {
+					scan->ColumnCount=c->Scan.ColumnCount;
+				}
+				if (c->Scan.FoundCR) scan->FoundCR=true;
+				if (c->Scan.FoundLF) scan->FoundLF=true;
+				if (c->Scan.FoundCRLF) scan->FoundCRLF=true;
+				continue;
+			}
+		}
+		scan->End=c->End;
+		ScanLinesKernel(Content,ContentSize,utf8,scan);
+	}
+	delete [] chunks;
+
+	if (LineIndents.GetCount()>MAX_LINE_COUNT) {
+		LineIndents.SetCount(MAX_LINE_COUNT);
+		LineWidths.SetCount(MAX_LINE_COUNT);
+		LineStarts.SetCount(MAX_LINE_COUNT+1);
+	}
+}
+
+
+void emTextFileModel::ScanLinesSerial(emInt64 endPos)
+{
+	const char * p;
+	LineScan * scan;
+	emInt64 i,j,cnt;
+	int n,c,col,col1,col2;
+
+	scan=&I->Scan;
+	p=Content;
+	cnt=ContentSize;
+	if (CharEncoding==CE_UTF16LE || CharEncoding==CE_UTF16BE) {
+		// Never read a half character at the end.
+		cnt&=~(emInt64)1;
+		if (endPos>cnt) endPos=cnt;
+	}
+	i=scan->Pos;
+	col=scan->Col;
+	col1=scan->Col1;
+	col2=scan->Col2;
+	while (i<endPos && LineIndents.GetCount()<scan->MaxLines) {
+		c=(emByte)p[i++];
+		if (CharEncoding==CE_UTF16LE) c|=((emByte)p[i++])<<8;
+		else if (CharEncoding==CE_UTF16BE) c=(c<<8)|(emByte)p[i++];
+		if (c<=0x20) {
+			if (c==0x09) {
+				col=(col+8)&~7;
+			}
+			else if (c==0x0a || c==0x0d) {
+				if (c==0x0d) {
+					c=0;
+					if (i<cnt) {
+						j=i;
+						c=(emByte)p[j++];
+						if (CharEncoding==CE_UTF16LE) c|=((emByte)p[j++])<<8;
+						else if (CharEncoding==CE_UTF16BE) c=(c<<8)|(emByte)p[j++];
+						if (c==0x0a) i=j;
+					}
+					if (c==0x0a) scan->FoundCRLF=true; else scan->FoundCR=true;
+				}
+				else {
+					scan->FoundLF=true;
+				}
+				scan->Col=col;
+				scan->Col1=col1;
+				scan->Col2=col2;
+				scan->FinishLine(i,cnt);
+				col=0;
+				col1=INT_MAX;
+				col2=0;
+			}
+			else {
+				col++;
+			}
+		}
+		else {
+			if (col1>col) col1=col;
+			col++;
+			col2=col;
+			if (c>=128) {
+				if (CharEncoding==CE_UTF8) {
+					n=emDecodeUtf8Char(&c,p+i-1,(int)emMin(cnt-i+1,(emInt64)16));
+					if (n>1) i+=n-1;
+				}
+				else if (CharEncoding==CE_8BIT && !emIsUtf8System()) {
+					n=emDecodeChar(
+						&c,p+i-1,(int)emMin(cnt-i+1,(emInt64)16),&I->MBState
+					);
+					if (n>1) i+=n-1;
+				}
+				else if (
+					c>=0xD800 && c<=0xDBFF && i<cnt &&
+					(CharEncoding==CE_UTF16LE || CharEncoding==CE_UTF16BE)
+				) {
+					c=(emByte)p[i];
+					if (CharEncoding==CE_UTF16LE) c|=((emByte)p[i+1])<<8;
+					else c=(c<<8)|(emByte)p[i+1];
+					if (c>=0xDC00 && c<=0xDFFF) i+=2;
+				}
+			}
+		}
+	}
+	scan->Pos=i;
+	scan->Col=col;
+	scan->Col1=col1;
+	scan->Col2=col2;
+}
+
+
+void emTextFileModel::ClassifyBytesThreadFunc(void * data, int index)
+{
+	const ClassifyThreadData * d;
+	ClassifyChunk * c;
+
+	d=(const ClassifyThreadData*)data;
+	c=d->Chunks+index;
+	d->Model->ClassifyBytesKernel(
+		d->Model->Content,d->Model->ContentSize,c->Begin,c->End,
+		c->ValidateFrom,&c->Counts
+	);
+}
+
+
+void emTextFileModel::ScanLinesThreadFunc(void * data, int index)
+{
+	const ScanLinesThreadData * d;
+	const char * p;
+	ScanChunk * c;
+	emInt64 i,cnt;
+
+	d=(const ScanLinesThreadData*)data;
+	c=d->Chunks+index;
+	p=d->Model->Content;
+	cnt=d->Model->ContentSize;
+
+	if (index>0) {
+		// Find the first line start.
+		for (i=c->Begin; i<c->End && p[i]!=0x0a && p[i]!=0x0d; i++);
+		if (i>=c->End) return;
+		if (p[i]==0x0d && i+1<cnt && p[i+1]==0x0a) i++;
+		i++;
+		if (i>=cnt) return;
+		c->FirstStart=i;
+		c->Scan.Pos=i;
+		c->Valid=true;
+	}
+
+	d->Model->ScanLinesKernel(p,cnt,d->Utf8,&c->Scan);
+}
+
+
+void emTextFileModel::LineScan::FinishLine(
+	emInt64 nextLineStart, emInt64 contentSize
+)
+{
+	if (Col1>Col) Col1=Col;
+	if (Col2<Col1) Col2=Col1;
+	if (ColumnCount<Col) ColumnCount=Col;
+	Indents->Add((emUInt16)emMin(Col1,65535));
+	Widths->Add((emUInt16)emMin(Col2-Col1,65535));
+	if (nextLineStart<contentSize) Starts->Add(nextLineStart);
+	Col=0;
+	Col1=INT_MAX;
+	Col2=0;
+}
+
+
+emInt64 emTextFileModel::ValidateUtf8(
+	const char * content, emInt64 contentSize, emInt64 pos, emInt64 end
+)
+{
+	int c,n;
+
+	while (pos<end) {
+		if (((signed char)content[pos])>=0) {
+			pos++;
+		}
+		else {
+			n=emDecodeUtf8Char(
+				&c,content+pos,(int)emMin(contentSize-pos,(emInt64)16)
+			);
+			if (n<1) return -1;
+			pos+=n;
+		}
+	}
+	return pos;
+}
+
+
+void emTextFileModel::ClassifyBytesScalar(
+	const char * content, emInt64 contentSize, emInt64 begin, emInt64 end,
+	emInt64 validateFrom, ByteClassCounts * counts
+)
+{
+	emInt64 i,binary,control,high;
+	int c;
+
+	binary=0;
+	control=0;
+	high=0;
+	for (i=begin; i<end; i++) {
+		c=(emByte)content[i];
+		if (c<0x20) {
+			if (c<=0x05) binary++;
+			else if (c==0x06 || c>=0x0E) control++;
+		}
+		else if (c>=0x7F) {
+			if (c==0x7F) control++;
+			else high++;
+		}
+	}
+	counts->Binary=binary;
+	counts->Control=control;
+	counts->High=high;
+	counts->Utf8Valid=ValidateUtf8(content,contentSize,validateFrom,end)>=0;
+}
+
+
+void emTextFileModel::ScanLinesScalar(
+	const char * content, emInt64 contentSize, bool utf8, LineScan * scan
+)
+{
+	emInt64 i,end;
+	int n,c,col,col1,col2;
+
+	if (scan->Indents->GetCount()>=scan->MaxLines) return;
+	i=scan->Pos;
+	end=emMin(scan->End,contentSize);
+	col=scan->Col;
+	col1=scan->Col1;
+	col2=scan->Col2;
+	while (i<end) {
+		c=(emByte)content[i++];
+		if (c>0x20) {
+			if (col1>col) col1=col;
+			col++;
+			col2=col;
+			if (c>=0x80 && utf8) {
+				n=emDecodeUtf8Char(
+					&c,content+i-1,(int)emMin(contentSize-i+1,(emInt64)16)
+				);
+				if (n>1) i+=n-1;
+			}
+		}
+		else if (c==0x09) {
+			col=(col+8)&~7;
+		}
+		else if (c==0x0a || c==0x0d) {
+			if (c==0x0a) {
+				scan->FoundLF=true;
+			}
+			else if (i<contentSize && content[i]==0x0a) {
+				scan->FoundCRLF=true;
+				i++;
+			}
+			else {
+				scan->FoundCR=true;
+			}
+			scan->Col=col;
+			scan->Col1=col1;
+			scan->Col2=col2;
+			scan->FinishLine(i,contentSize);
+			col=0;
+			col1=INT_MAX;
+			col2=0;
+			if (scan->Indents->GetCount()>=scan->MaxLines) break;
+		}
+		else {
+			col++;
+		}
+	}
+	scan->Pos=i;
+	scan->Col=col;
+	scan->Col1=col1;
+	scan->Col2=col2;
+}
@@ -0,0 +1,223 @@
+//------------------------------------------------------------------------------
+// emTextFileModel_AVX2.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emText/emTextFileModel.h>
+
+#if EM_HAVE_X86_INTRINSICS
+#	if defined(_MSC_VER)
+#		include <immintrin.h>
+#		include <intrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+
+
+static inline int emTextFileModel_Ctz(unsigned int m)
+{
+#	if defined(_MSC_VER)
+		unsigned long r;
+		_BitScanForward(&r,m);
+		return (int)r;
+#	else
+		return __builtin_ctz(m);
+#	endif
+}
+
+
+#if defined(__GNUC__)
+	__attribute__((target("avx2")))
+#endif
+static inline emInt64 emTextFileModel_Sum(__m256i v)
+{
+	emUInt64 t[4];
+
+	_mm256_storeu_si256((__m256i*)t,v);
+	return (emInt64)(t[0]+t[1]+t[2]+t[3]);
+}
+
+
+#if defined(__GNUC__)
+	__attribute__((target("avx2")))
+#endif
+void emTextFileModel::ClassifyBytesAvx2(
+	const char * content, emInt64 contentSize, emInt64 begin, emInt64 end,
+	emInt64 validateFrom, ByteClassCounts * counts
+)
+{
+	__m256i v,accBin,accCtl,accHigh,sumBin,sumCtl,sumHigh;
+	emInt64 i,n,vpos;
+	int k;
+
+	const __m256i zero=_mm256_setzero_si256();
+	const __m256i c05=_mm256_set1_epi8(0x05);
+	const __m256i c06=_mm256_set1_epi8(0x06);
+	const __m256i c0E=_mm256_set1_epi8(0x0E);
+	const __m256i c1F=_mm256_set1_epi8(0x1F);
+	const __m256i c7F=_mm256_set1_epi8(0x7F);
+
+	sumBin=zero;
+	sumCtl=zero;
+	sumHigh=zero;
+	vpos=validateFrom;
+	i=begin;
+	n=(end-begin)/32;
+	while (n>0) {
+		// The byte counters are subtracted by -1 per match, and they
+		// are summed up before they could overflow.
+		k=(int)emMin(n,(emInt64)255);
+		n-=k;
+		accBin=zero;
+		accCtl=zero;
+		accHigh=zero;
+		for (; k>0; k--, i+=32) {
+			v=_mm256_loadu_si256((const __m256i*)(content+i));
+			accBin=_mm256_sub_epi8(
+				accBin,
+				_mm256_cmpeq_epi8(_mm256_min_epu8(v,c05),v)
+			);
+			accCtl=_mm256_sub_epi8(
+				accCtl,
+				_mm256_or_si256(
+					_mm256_or_si256(
+						_mm256_cmpeq_epi8(v,c06),
+						_mm256_cmpeq_epi8(v,c7F)
+					),
+					_mm256_cmpeq_epi8(
+						_mm256_min_epu8(_mm256_max_epu8(v,c0E),c1F),
+						v
+					)
+				)
+			);
+			accHigh=_mm256_sub_epi8(accHigh,_mm256_cmpgt_epi8(zero,v));
+			if (vpos>=0 && vpos<i+32) {
+				if (vpos<=i && _mm256_movemask_epi8(v)==0) vpos=i+32;
+				else vpos=ValidateUtf8(content,contentSize,vpos,i+32);
+			}
+		}
+		sumBin=_mm256_add_epi64(sumBin,_mm256_sad_epu8(accBin,zero));
+		sumCtl=_mm256_add_epi64(sumCtl,_mm256_sad_epu8(accCtl,zero));
+		sumHigh=_mm256_add_epi64(sumHigh,_mm256_sad_epu8(accHigh,zero));
+	}
+
+	ClassifyBytesScalar(content,contentSize,i,end,vpos>=0?vpos:end,counts);
+	if (vpos<0) counts->Utf8Valid=false;
+	counts->Binary+=emTextFileModel_Sum(sumBin);
+	counts->Control+=emTextFileModel_Sum(sumCtl);
+	counts->High+=emTextFileModel_Sum(sumHigh);
+}
+
+
+#if defined(__GNUC__)
+	__attribute__((target("avx2")))
+#endif
+void emTextFileModel::ScanLinesAvx2(
+	const char * content, emInt64 contentSize, bool utf8, LineScan * scan
+)
+{
+	emInt64 i,b,k,end;
+	unsigned int m;
+	int n,c,col,col1,col2;
+
+	// Bytes greater than 0x20 and less than 0x80 are the common case.
+	// Each of them is one column of a non-space character, so that runs
+	// of them are handled at once. The other bytes are handled one by
+	// one, as found through a bit mask per 32 bytes.
+	const __m256i limit=_mm256_set1_epi8(0x21);
+
+	if (scan->Indents->GetCount()>=scan->MaxLines) return;
+	i=scan->Pos;
+	end=emMin(scan->End,contentSize);
+	col=scan->Col;
+	col1=scan->Col1;
+	col2=scan->Col2;
+	while (end-i>=32) {
+		b=i;
+		m=(unsigned int)_mm256_movemask_epi8(_mm256_cmpgt_epi8(
+			limit,
+			_mm256_loadu_si256((const __m256i*)(content+b))
+		));
+		while (m) {
+			k=b+emTextFileModel_Ctz(m);
+			m&=m-1;
+			if (k<i) continue;
+			if (k>i) {
+				if (col1>col) col1=col;
+				col+=(int)(k-i);
+				col2=col;
+				i=k;
+			}
+			c=(emByte)content[i++];
+			if (c>=0x80) {
+				if (col1>col) col1=col;
+				col++;
+				col2=col;
+				if (utf8) {
+					n=emDecodeUtf8Char(
+						&c,content+i-1,(int)emMin(contentSize-i+1,(emInt64)16)
+					);
+					if (n>1) i+=n-1;
+				}
+			}
+			else if (c==0x09) {
+				col=(col+8)&~7;
+			}
+			else if (c==0x0a || c==0x0d) {
+				if (c==0x0a) {
+					scan->FoundLF=true;
+				}
+				else if (i<contentSize && content[i]==0x0a) {
+					scan->FoundCRLF=true;
+					i++;
+				}
+				else {
+					scan->FoundCR=true;
+				}
+				scan->Col=col;
+				scan->Col1=col1;
+				scan->Col2=col2;
+				scan->FinishLine(i,contentSize);
+				col=0;
+				col1=INT_MAX;
+				col2=0;
+				if (scan->Indents->GetCount()>=scan->MaxLines) {
+					scan->Pos=i;
+					return;
+				}
+			}
+			else {
+				col++;
+			}
+		}
+		if (i<b+32) {
+			if (col1>col) col1=col;
+			col+=(int)(b+32-i);
+			col2=col;
+			i=b+32;
+		}
+	}
+	scan->Pos=i;
+	scan->Col=col;
+	scan->Col1=col1;
+	scan->Col2=col2;
+	ScanLinesScalar(content,contentSize,utf8,scan);
+}
+
+
+#endif
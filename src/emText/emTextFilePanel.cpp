@@ -26,7 +26,8 @@ emTextFilePanel::emTextFilePanel(
 	ParentArg parent, const emString & name, emTextFileModel * fileModel,
 	bool updateFileModel, bool alternativeView
 )
-	: emFilePanel(parent,name)
+	: emFilePanel(parent,name),
+	Search(GetView())
 {
 	AlternativeView=alternativeView;
 	Model=NULL;
@@ -39,7 +40,11 @@ emTextFilePanel::emTextFilePanel(
 	SelectionId=-1;
 	DragMode=DM_NONE;
 	DragIndex=0;
+	Following=false;
+	StayingAtEnd=false;
 	AddWakeUpSignal(GetVirFileStateSignal());
+	AddWakeUpSignal(Search.GetChangeSignal());
+	HexAddrDigits=8;
 	SetFileModel(fileModel,updateFileModel);
 	UpdateTextLayout();
 }
@@ -47,6 +52,7 @@ emTextFilePanel::emTextFilePanel(
 
 emTextFilePanel::~emTextFilePanel()
 {
+	if (Model && Following) Model->RemoveFollower();
 }
 
 
@@ -54,12 +60,21 @@ void emTextFilePanel::SetFileModel(
 	emFileModel * fileModel, bool updateFileModel
 )
 {
-	if (Model) RemoveWakeUpSignal(Model->GetChangeSignal());
+	if (Model) {
+		RemoveWakeUpSignal(Model->GetChangeSignal());
+		RemoveWakeUpSignal(Model->GetLineIndexSignal());
+		if (Following) Model->RemoveFollower();
+	}
 	SelectionId=-1;
 	EmptySelection();
 	Model=dynamic_cast<emTextFileModel*>(fileModel);
 	emFilePanel::SetFileModel(Model,updateFileModel);
-	if (Model) AddWakeUpSignal(Model->GetChangeSignal());
+	if (Model) {
+		AddWakeUpSignal(Model->GetChangeSignal());
+		AddWakeUpSignal(Model->GetLineIndexSignal());
+		if (Following) Model->AddFollower();
+	}
+	Search.SetModel(Model);
 	InvalidateControlPanel();
 }
 
@@ -81,12 +96,14 @@ bool emTextFilePanel::IsHexView() const
 }
 
 
-void emTextFilePanel::Select(int startIndex, int endIndex, bool publish)
+void emTextFilePanel::Select(
+	emInt64 startIndex, emInt64 endIndex, bool publish
+)
 {
-	int textLen;
+	emInt64 textLen;
 
 	textLen=0;
-	if (IsVFSGood() && !IsHexView()) textLen=Model->GetContent().GetCount();
+	if (IsVFSGood() && !IsHexView()) textLen=Model->GetIndexedSize();
 	if (startIndex<0) startIndex=0;
 	if (endIndex>textLen) endIndex=textLen;
 	if (startIndex>=endIndex) {
@@ -113,7 +130,7 @@ void emTextFilePanel::Select(int startIndex, int endIndex, bool publish)
 void emTextFilePanel::SelectAll(bool publish)
 {
 	if (IsVFSGood() && !IsHexView()) {
-		Select(0,Model->GetContent().GetCount(),publish);
+		Select(0,Model->GetIndexedSize(),publish);
 	}
 }
 
@@ -144,9 +161,82 @@ void emTextFilePanel::CopySelectedTextToClipboard()
 }
 
 
+void emTextFilePanel::SetFollowing(bool following)
+{
+	if (Following!=following) {
+		Following=following;
+		if (Model) {
+			if (Following) Model->AddFollower();
+			else Model->RemoveFollower();
+		}
+	}
+}
+
+
+void emTextFilePanel::SetStayingAtEnd(bool stayingAtEnd)
+{
+	StayingAtEnd=stayingAtEnd;
+}
+
+
+void emTextFilePanel::StartSearch(
+	const emString & pattern, bool regEx, bool caseSensitive
+)
+{
+	Search.Start(pattern,regEx,caseSensitive);
+}
+
+
+void emTextFilePanel::ClearSearch()
+{
+	Search.Clear();
+}
+
+
+bool emTextFilePanel::GoToNextMatch()
+{
+	emInt64 index;
+	int i,n;
+
+	if (!IsVFSGood() || IsHexView()) return false;
+	n=Search.FindMatch(Model->GetIndexedSize());
+	if (n<=0) return false;
+	if (!IsSelectionEmpty()) {
+		index=SelectionStartIndex;
+		i=Search.FindMatch(index);
+		if (i<n && Search.GetMatchStart(i)<=index) i++;
+	}
+	else {
+		i=Search.FindMatch(GetViewCenterIndex());
+	}
+	if (i>=n) i=0;
+	GoToMatch(i);
+	return true;
+}
+
+
+bool emTextFilePanel::GoToPrevMatch()
+{
+	emInt64 index;
+	int i,n;
+
+	if (!IsVFSGood() || IsHexView()) return false;
+	n=Search.FindMatch(Model->GetIndexedSize());
+	if (n<=0) return false;
+	if (!IsSelectionEmpty()) index=SelectionStartIndex;
+	else index=GetViewCenterIndex();
+	i=Search.FindMatch(index)-1;
+	if (i<0 || i>=n) i=n-1;
+	GoToMatch(i);
+	return true;
+}
+
+
 bool emTextFilePanel::Cycle()
 {
 	static const char * const ALT_ERROR="Hex display is not an alternative.";
+	double x,y,vx,vy,h;
+	bool atEnd;
 
 	if (IsSignaled(GetVirFileStateSignal())) {
 		UpdateTextLayout();
@@ -177,6 +267,36 @@ bool emTextFilePanel::Cycle()
 		SelectionId=-1;
 		EmptySelection();
 	}
+	if (Model && IsSignaled(Model->GetLineIndexSignal())) {
+		// When staying at the end, remember where the end of the text
+		// is shown, if it is in the view.
+		atEnd=false;
+		if (Following && StayingAtEnd && IsViewed() && GetTextEnd(&x,&y)) {
+			vx=PanelToViewX(x);
+			vy=PanelToViewY(y);
+			h=CharHeight;
+			atEnd=(
+				vx>=GetView().GetCurrentX() &&
+				vx<=GetView().GetCurrentX()+GetView().GetCurrentWidth() &&
+				vy>=GetView().GetCurrentY() &&
+				vy<=GetView().GetCurrentY()+GetView().GetCurrentHeight()
+			);
+		}
+		UpdateTextLayout();
+		if (
+			atEnd && GetTextEnd(&x,&y) && (
+				GetViewedWidth()>GetView().GetCurrentWidth() ||
+				GetViewedHeight()>GetView().GetCurrentHeight()
+			)
+		) {
+			GetView().Scroll(PanelToViewX(x)-vx,PanelToViewY(y)-vy);
+			if (CharHeight<h) GetView().Zoom(vx,vy,h/CharHeight);
+		}
+		InvalidatePainting();
+	}
+	if (IsSignaled(Search.GetChangeSignal())) {
+		InvalidatePainting();
+	}
 
 	return emFilePanel::Cycle();
 }
@@ -197,7 +317,7 @@ void emTextFilePanel::Input(
 )
 {
 	double mc,mr;
-	int i,i1,i2,j1,j2;
+	emInt64 i,i1,i2,j1,j2;
 	bool inArea;
 	emString str;
 
@@ -262,7 +382,7 @@ void emTextFilePanel::Input(
 			}
 			else {
 				SelectAll(true);
-				DragIndex=Model->GetContent().GetCount();
+				DragIndex=Model->GetIndexedSize();
 			}
 			Focus();
 			event.Eat();
@@ -352,6 +472,14 @@ void emTextFilePanel::Input(
 			CopySelectedTextToClipboard();
 			event.Eat();
 		}
+		if (event.IsKey(EM_KEY_F3) && state.IsNoMod()) {
+			GoToNextMatch();
+			event.Eat();
+		}
+		if (event.IsKey(EM_KEY_F3) && state.IsShiftMod()) {
+			GoToPrevMatch();
+			event.Eat();
+		}
 	}
 
 	emFilePanel::Input(event,state,mx,my);
@@ -414,31 +542,38 @@ void emTextFilePanel::SetDragMode(DragModeType dragMode)
 
 void emTextFilePanel::UpdateTextLayout()
 {
-	int count,rows;
+	emInt64 count,rows;
 	double h,f,t;
 
 	if (!IsVFSGood()) {
 		PageCount=PageRows=PageCols=0;
+		HexAddrDigits=8;
 		PageWidth=PageGap=CharWidth=CharHeight=0.0;
 	}
 	else if (IsHexView()) {
 		h=GetHeight();
-		count=Model->GetContent().GetCount();
-		rows=(int)(((unsigned)count+15)/16);
-		PageCols=73;
+		count=Model->GetContentSize();
+		rows=(count+15)/16;
+		HexAddrDigits=count>(((emInt64)1)<<32) ? 12 : 8;
+		PageCols=65+HexAddrDigits;
 		f=emPainter::GetTextSize("X",1.0,false);
 		PageGap=2.0;
 		t=0.5*PageGap/(PageCols+PageGap);
-		PageCount=(int)floor(t+sqrt((2*rows/(h*f*PageGap)+t)*t));
+		t=floor(t+sqrt((2*rows/(h*f*PageGap)+t)*t));
 		// PageCount*h/rows*f*(PageCols*PageCount+PageGap*(PageCount-1)) <= 1.0
+		PageCount=(int)emMin(t,(double)INT_MAX);
+		// The row count of a huge windowed file may exceed the int
+		// range, so it is clamped before the cast.
 		if (PageCount<1) {
 			PageCount=1;
-			PageRows=rows;
+			PageRows=(int)emMin(rows,(emInt64)INT_MAX);
 			CharWidth=1.0/PageCols;
 			CharHeight=CharWidth/f;
 		}
 		else {
-			PageRows=(rows+PageCount-1)/PageCount;
+			PageRows=(int)emMin(
+				(rows+PageCount-1)/PageCount,(emInt64)INT_MAX
+			);
 			CharHeight=h/PageRows;
 			CharWidth=CharHeight*f;
 		}
@@ -457,14 +592,14 @@ void emTextFilePanel::UpdateTextLayout()
 		// PageCount*h/rows*f*(PageCols*PageCount+PageGap*(PageCount-1)) <= 1.0
 		if (PageCount<1) {
 			PageCount=1;
-			PageRows=rows;
+			PageRows=(int)rows;
 			CharWidth=1.0/PageCols;
 			CharHeight=CharWidth/f;
 			PageWidth=1.0;
 			PageGap*=CharWidth;
 		}
 		else {
-			PageRows=(rows+PageCount-1)/PageCount;
+			PageRows=(int)((rows+PageCount-1)/PageCount);
 			CharHeight=h/PageRows;
 			CharWidth=CharHeight*f;
 			PageGap*=CharWidth;
@@ -474,6 +609,56 @@ void emTextFilePanel::UpdateTextLayout()
 }
 
 
+bool emTextFilePanel::GetTextEnd(double * pX, double * pY) const
+{
+	emInt64 rows;
+
+	if (!IsVFSGood() || PageRows<=0) return false;
+	if (IsHexView()) rows=(Model->GetContentSize()+15)/16;
+	else rows=Model->GetLineCount();
+	if (rows<=0) return false;
+	*pX=((rows-1)/PageRows)*(PageWidth+PageGap);
+	*pY=((rows-1)%PageRows+1)*CharHeight;
+	return true;
+}
+
+
+emInt64 emTextFilePanel::GetViewCenterIndex() const
+{
+	double mc,mr;
+
+	if (!IsVFSGood() || IsHexView() || !IsViewed()) return 0;
+	CheckMouse(
+		ViewToPanelX(GetView().GetCurrentX()+GetView().GetCurrentWidth()*0.5),
+		ViewToPanelY(GetView().GetCurrentY()+GetView().GetCurrentHeight()*0.5),
+		&mc,&mr
+	);
+	return Model->ColRow2Index(mc,mr,true);
+}
+
+
+void emTextFilePanel::GoToMatch(int matchIndex)
+{
+	double x,y,vh,pw,relA;
+	int col,row;
+
+	Select(
+		Search.GetMatchStart(matchIndex),Search.GetMatchEnd(matchIndex),false
+	);
+	if (PageRows<=0) return;
+	Model->Index2ColRow(Search.GetMatchStart(matchIndex),&col,&row);
+	x=(row/PageRows)*(PageWidth+PageGap)+(col+0.5)*CharWidth;
+	y=(row%PageRows+0.5)*CharHeight;
+
+	// Visit the panel so that the match is in the center of the view,
+	// and so that the view shows some rows of text.
+	vh=emMin(CharHeight*VISIT_ROWS,GetHeight());
+	pw=GetView().GetHomeHeight()*GetView().GetHomePixelTallness()/vh;
+	relA=GetView().GetHomeWidth()/pw*vh/GetHeight();
+	GetView().Visit(this,x-0.5,y/GetHeight()-0.5,relA,true);
+}
+
+
 bool emTextFilePanel::CheckMouse(
 	double mx, double my, double * pCol, double * pRow
 ) const
@@ -532,9 +717,11 @@ bool emTextFilePanel::CheckMouse(
 }
 
 
-void emTextFilePanel::ModifySelection(int oldIndex, int newIndex, bool publish)
+void emTextFilePanel::ModifySelection(
+	emInt64 oldIndex, emInt64 newIndex, bool publish
+)
 {
-	int d1,d2;
+	emInt64 d1,d2;
 
 	if (SelectionStartIndex<SelectionEndIndex) {
 		d1=oldIndex-SelectionStartIndex; if (d1<0) d1=-d1;
@@ -550,16 +737,18 @@ void emTextFilePanel::ModifySelection(int oldIndex, int newIndex, bool publish)
 emString emTextFilePanel::ConvertSelectedTextToCurrentLocale() const
 {
 	const char * data;
-	int len,i1,i2;
+	emInt64 len,i1,i2;
 
 	if (!IsVFSGood() || IsHexView()) return emString();
-	data=Model->GetContent().Get();
-	len=Model->GetContent().GetCount();
+	data=Model->GetContent();
+	len=Model->GetContentSize();
 	i1=SelectionStartIndex;
 	i2=SelectionEndIndex;
 	if (i2>len) i2=len;
 	if (i1<0) i1=0;
 	if (i1>=i2) return emString();
+	// Refuse to copy what would not fit into a string.
+	if (i2-i1>INT_MAX/4) return emString();
 	return Model->ConvertToCurrentLocale(data+i1,data+i2);
 }
 
@@ -618,8 +807,9 @@ void emTextFilePanel::PaintTextRowsSilhouette(
 ) const
 {
 	emColor fg,bg;
+	emInt64 nextStart;
 	double xfac;
-	int step,selRow1,selRow2;
+	int step,selRow1,selRow2,rows,i;
 
 	step=(int)(0.5/(CharHeight*GetViewedWidth()));
 	if (step<1) step=1;
@@ -637,8 +827,16 @@ void emTextFilePanel::PaintTextRowsSilhouette(
 		}
 	}
 
+	rows=Model->GetLineCount();
 	xfac=PageCols*CharWidth/255.0;
 	while (row<endRow) {
+		// Whether the rows contain a match.
+		i=Search.FindMatch(Model->GetLineStart(row));
+		if (i<Search.GetMatchCount()) {
+			if (row+step<rows) nextStart=Model->GetLineStart(row+step);
+			else nextStart=Model->GetIndexedSize();
+			if (Search.GetMatchStart(i)>=nextStart) i=Search.GetMatchCount();
+		}
 		if (row<selRow2 && row>=selRow1) {
 			painter.PaintRect(
 				x,
@@ -651,6 +849,18 @@ void emTextFilePanel::PaintTextRowsSilhouette(
 			fg=TextSelFg96Color;
 			bg=TextSelBgColor;
 		}
+		else if (i<Search.GetMatchCount()) {
+			painter.PaintRect(
+				x,
+				y,
+				PageWidth,
+				CharHeight*step,
+				TextMatchBgColor,
+				TextBgColor
+			);
+			fg=TextMatchFg96Color;
+			bg=TextMatchBgColor;
+		}
 		else {
 			fg=TextFg96Color;
 			bg=TextBgColor;
@@ -674,58 +884,64 @@ void emTextFilePanel::PaintTextRows(
 ) const
 {
 	const char * pContent;
-	int i1,i2,i3,col;
+	emColor fg,bg;
+	emInt64 i1,i2,i3;
+	int col,m,mCount;
 
 	pContent=Model->GetContent();
+	mCount=Search.GetMatchCount();
 	for (; row<endRow; row++, y+=CharHeight) {
 		i1=Model->GetLineStart(row);
 		i2=Model->GetLineEnd(row);
 		emMBState mbState;
-		if (
-			SelectionStartIndex>=SelectionEndIndex ||
-			SelectionStartIndex>=i2 ||
-			SelectionEndIndex<=i1
-		) {
-			if (i1<i2) {
-				PaintTextRowPart(
-					painter,x,y,0,pContent+i1,pContent+i2,&mbState,
-					TextFgColor,TextBgColor,TextBgColor
-				);
+		// Paint the row in parts, split at the boundaries of the
+		// selection and of the matches. The selection is painted over
+		// the matches.
+		m=Search.FindMatch(i1);
+		col=0;
+		while (i1<i2) {
+			i3=i2;
+			if (i1>=SelectionStartIndex && i1<SelectionEndIndex) {
+				if (i3>SelectionEndIndex) i3=SelectionEndIndex;
+				fg=TextSelFgColor;
+				bg=TextSelBgColor;
 			}
-		}
-		else {
-			col=0;
-			if (i1<SelectionStartIndex) {
-				col=PaintTextRowPart(
-					painter,x,y,col,pContent+i1,pContent+SelectionStartIndex,
-					&mbState,TextFgColor,TextBgColor,TextBgColor
-				);
-				i1=SelectionStartIndex;
-			}
-			if (i1<SelectionEndIndex) {
-				i3=emMin(SelectionEndIndex,i2);
-				col=PaintTextRowPart(
-					painter,x,y,col,pContent+i1,pContent+i3,
-					&mbState,TextSelFgColor,TextSelBgColor,TextBgColor
-				);
-				i1=i3;
-			}
-			if (i1<i2) {
-				col=PaintTextRowPart(
-					painter,x,y,col,pContent+i1,pContent+i2,
-					&mbState,TextFgColor,TextBgColor,TextBgColor
-				);
-			}
-			if (i2<SelectionEndIndex) {
-				painter.PaintRect(
-					x+col*CharWidth,
-					y,
-					PageWidth-col*CharWidth,
-					CharHeight,
-					TextSelBgColor,
-					TextBgColor
-				);
+			else {
+				if (i1<SelectionStartIndex && i3>SelectionStartIndex) {
+					i3=SelectionStartIndex;
+				}
+				while (m<mCount && Search.GetMatchEnd(m)<=i1) m++;
+				if (m<mCount && Search.GetMatchStart(m)<=i1) {
+					if (i3>Search.GetMatchEnd(m)) i3=Search.GetMatchEnd(m);
+					fg=TextMatchFgColor;
+					bg=TextMatchBgColor;
+				}
+				else {
+					if (m<mCount && i3>Search.GetMatchStart(m)) {
+						i3=Search.GetMatchStart(m);
+					}
+					fg=TextFgColor;
+					bg=TextBgColor;
+				}
 			}
+			col=PaintTextRowPart(
+				painter,x,y,col,pContent+i1,pContent+i3,&mbState,
+				fg,bg,TextBgColor
+			);
+			i1=i3;
+		}
+		if (
+			SelectionStartIndex<SelectionEndIndex &&
+			SelectionStartIndex<i2 && i2<SelectionEndIndex
+		) {
+			painter.PaintRect(
+				x+col*CharWidth,
+				y,
+				PageWidth-col*CharWidth,
+				CharHeight,
+				TextSelBgColor,
+				TextBgColor
+			);
 		}
 	}
 }
@@ -801,12 +1017,15 @@ void emTextFilePanel::PaintAsHex(
 {
 	char buf[256];
 	char buf2[32];
-	const char * pStart, * pEnd, * p;
-	int i,j,k,row,page;
+	char data[16];
+	emInt64 pos,end;
+	emUInt64 a;
+	int i,j,k,n,row,page;
 	double h,f,pagex,bx,rowy,clipx1,clipy1,clipx2,clipy2;
 
-	pStart=Model->GetContent();
-	pEnd=pStart+Model->GetContent().GetCount();
+	// The content is read row by row, and only where painted, so that
+	// windowed content is read on demand (see emTextFileModel).
+	end=Model->GetContentSize();
 
 	h=GetHeight();
 	clipx1=painter.GetUserClipX1();
@@ -816,28 +1035,28 @@ void emTextFilePanel::PaintAsHex(
 
 	painter.PaintRect(0,0,1,h,HexBgColor,canvasColor);
 
-	p=pStart;
+	pos=0;
 	page=0;
 	pagex=0;
 	if (pagex+PageWidth+PageGap<=clipx1) {
 		page=(int)((clipx1-pagex)/(PageWidth+PageGap));
 		pagex+=page*(PageWidth+PageGap);
-		p+=page*PageRows*16;
+		pos+=((emInt64)page)*PageRows*16;
 	}
 	if (CharHeight*GetViewedWidth()<1.0) {
 		for (; page<PageCount && pagex<clipx2; page++, pagex+=PageWidth+PageGap) {
-			f=(pEnd-p+15)/16*CharHeight;
+			f=(end-pos+15)/16*CharHeight;
 			if (f>h) f=h;
 			painter.PaintRect(
 				pagex,
 				0,
-				CharWidth*8,
+				CharWidth*HexAddrDigits,
 				f,
 				HexAddr64Color,
 				HexBgColor
 			);
 			painter.PaintRect(
-				pagex+CharWidth*9,
+				pagex+CharWidth*(HexAddrDigits+1),
 				0,
 				CharWidth*47,
 				f,
@@ -845,14 +1064,14 @@ void emTextFilePanel::PaintAsHex(
 				HexBgColor
 			);
 			painter.PaintRect(
-				pagex+CharWidth*(9+48),
+				pagex+CharWidth*(HexAddrDigits+1+48),
 				0,
 				CharWidth*16,
 				f,
 				HexAsc64Color,
 				HexBgColor
 			);
-			p+=16*PageRows;
+			pos+=((emInt64)PageRows)*16;
 		}
 	}
 	else if (CharHeight*GetViewedWidth()<3.0) {
@@ -862,21 +1081,22 @@ void emTextFilePanel::PaintAsHex(
 			if (rowy+CharHeight<=clipy1) {
 				row=(int)((clipy1-rowy)/CharHeight);
 				rowy+=row*CharHeight;
-				p+=row*16;
+				pos+=((emInt64)row)*16;
 			}
-			while (row<PageRows && rowy<clipy2 && p<pEnd) {
+			while (row<PageRows && rowy<clipy2 && pos<end) {
+				n=Model->ReadContent(pos,data,16);
 				bx=pagex;
 				painter.PaintRect(
 					bx,
 					rowy+CharHeight*0.1,
-					CharWidth*8,
+					CharWidth*HexAddrDigits,
 					CharHeight*0.8,
 					HexAddr96Color,
 					HexBgColor
 				);
-				bx+=9*CharWidth;
-				for (i=0, j=0; i<16 && p<pEnd; i++, p++) {
-					k=(unsigned char)*p;
+				bx+=(HexAddrDigits+1)*CharWidth;
+				for (i=0, j=0; i<n; i++) {
+					k=(unsigned char)data[i];
 					if (((unsigned)(k-0x20))<0x60) j++;
 					painter.PaintRect(
 						bx+3*i*CharWidth,
@@ -892,13 +1112,14 @@ void emTextFilePanel::PaintAsHex(
 					rowy+CharHeight*0.1,
 					i*CharWidth,
 					CharHeight*0.8,
-					emColor(HexAscColor,(emByte)(32+j*64/i)),
+					emColor(HexAscColor,(emByte)(32+j*64/emMax(i,1))),
 					HexBgColor
 				);
+				pos+=16;
 				row++;
 				rowy+=CharHeight;
 			}
-			p+=16*(PageRows-row);
+			pos+=((emInt64)(PageRows-row))*16;
 		}
 	}
 	else {
@@ -908,17 +1129,22 @@ void emTextFilePanel::PaintAsHex(
 			if (rowy+CharHeight<=clipy1) {
 				row=(int)((clipy1-rowy)/CharHeight);
 				rowy+=row*CharHeight;
-				p+=row*16;
+				pos+=((emInt64)row)*16;
 			}
-			while (row<PageRows && rowy<clipy2 && p<pEnd) {
-				sprintf(buf,"%08X",(unsigned int)(p-pStart));
+			while (row<PageRows && rowy<clipy2 && pos<end) {
+				n=Model->ReadContent(pos,data,16);
+				a=(emUInt64)pos;
+				for (i=HexAddrDigits-1; i>=0; i--, a>>=4) {
+					buf[i]="0123456789ABCDEF"[a&15];
+				}
+				buf[HexAddrDigits]=0;
 				bx=pagex;
 				painter.PaintText(
 					bx,rowy,buf,CharHeight,1.0,HexAddrColor,HexBgColor
 				);
-				bx+=9*CharWidth;
-				for (i=0; i<16 && p<pEnd; i++, p++) {
-					k=(unsigned char)*p;
+				bx+=(HexAddrDigits+1)*CharWidth;
+				for (i=0; i<n; i++) {
+					k=(unsigned char)data[i];
 					j=(k>>4)+'0';
 					if (j>'9') j+='A'-'9'-1;
 					buf[0]=(char)j;
@@ -936,10 +1162,11 @@ void emTextFilePanel::PaintAsHex(
 					bx+48*CharWidth,rowy,buf2,CharHeight,1.0,
 					HexAscColor,HexBgColor,i
 				);
+				pos+=16;
 				row++;
 				rowy+=CharHeight;
 			}
-			p+=16*(PageRows-row);
+			pos+=((emInt64)(PageRows-row))*16;
 		}
 	}
 }
@@ -951,6 +1178,9 @@ const emColor emTextFilePanel::TextFg96Color(TextFgColor,96);
 const emColor emTextFilePanel::TextSelFgColor(TextBgColor);
 const emColor emTextFilePanel::TextSelFg96Color(TextSelFgColor,96);
 const emColor emTextFilePanel::TextSelBgColor(16,56,192);
+const emColor emTextFilePanel::TextMatchFgColor(TextFgColor);
+const emColor emTextFilePanel::TextMatchFg96Color(TextMatchFgColor,96);
+const emColor emTextFilePanel::TextMatchBgColor(255,208,64);
 const emColor emTextFilePanel::HexBgColor(0,0,0);
 const emColor emTextFilePanel::HexAddrColor(64,128,64);
 const emColor emTextFilePanel::HexDataColor(128,128,64);
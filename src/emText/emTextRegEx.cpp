@@ -0,0 +1,798 @@
+//------------------------------------------------------------------------------
+// emTextRegEx.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emText/emTextRegEx.h>
+
+
+//==============================================================================
+//================================ emTextRegEx =================================
+//==============================================================================
+
+struct emTextRegEx::Parser {
+	const int * P;
+	int Len;
+	int Pos;
+	int Depth;
+};
+
+
+emTextRegEx::emTextRegEx()
+{
+	CaseSensitive=true;
+	RequiredExact=false;
+	Nodes.SetTuningLevel(4);
+	Program.SetTuningLevel(4);
+	Classes.SetTuningLevel(4);
+	ClassRanges.SetTuningLevel(4);
+	RequiredString.SetTuningLevel(4);
+}
+
+
+emTextRegEx::emTextRegEx(const emTextRegEx & regEx)
+	: CaseSensitive(regEx.CaseSensitive),
+	Nodes(regEx.Nodes),
+	Program(regEx.Program),
+	Classes(regEx.Classes),
+	ClassRanges(regEx.ClassRanges),
+	RequiredString(regEx.RequiredString),
+	RequiredExact(regEx.RequiredExact)
+{
+}
+
+
+emTextRegEx::~emTextRegEx()
+{
+}
+
+
+emTextRegEx & emTextRegEx::operator = (const emTextRegEx & regEx)
+{
+	CaseSensitive=regEx.CaseSensitive;
+	Nodes=regEx.Nodes;
+	Program=regEx.Program;
+	Classes=regEx.Classes;
+	ClassRanges=regEx.ClassRanges;
+	RequiredString=regEx.RequiredString;
+	RequiredExact=regEx.RequiredExact;
+	return *this;
+}
+
+
+void emTextRegEx::Compile(
+	const int * pattern, int patternLen, bool caseSensitive, bool literal
+)
+{
+	Parser p;
+	ReqInfo req;
+	int i,n;
+
+	CaseSensitive=caseSensitive;
+	Nodes.Clear();
+	Program.Clear();
+	Classes.Clear();
+	ClassRanges.Clear();
+	RequiredString.Clear();
+	RequiredExact=false;
+
+	try {
+		if (literal) {
+			n=AddNode(N_EMPTY);
+			for (i=0; i<patternLen; i++) {
+				n=AddNode(N_CAT,0,n,AddNode(N_CHAR,pattern[i]));
+			}
+		}
+		else {
+			p.P=pattern;
+			p.Len=patternLen;
+			p.Pos=0;
+			p.Depth=0;
+			n=ParseAlternatives(p);
+			if (p.Pos<p.Len) throw emException("Unmatched ')'.");
+		}
+		Emit(n);
+		AddInstruction(OP_MATCH);
+		CalcRequired(n,&req);
+	}
+	catch (const emException &) {
+		Nodes.Clear(true);
+		Program.Clear(true);
+		Classes.Clear(true);
+		ClassRanges.Clear(true);
+		throw;
+	}
+
+	RequiredString=req.String;
+	RequiredExact=req.Exact;
+	Nodes.Clear(true);
+	Program.Compact();
+}
+
+
+int emTextRegEx::FoldCase(int c)
+{
+	if (c>='A' && c<='Z') return c+32;
+	if (c>=0xC0 && c<=0xDE && c!=0xD7) return c+32;
+	return c;
+}
+
+
+emTextRegEx::Matcher::Matcher(const emTextRegEx & regEx)
+	: RegEx(regEx)
+{
+	int n;
+
+	n=RegEx.Program.GetCount();
+	List1.SetTuningLevel(4);
+	List2.SetTuningLevel(4);
+	Marks.SetTuningLevel(4);
+	Stack.SetTuningLevel(4);
+	List1.SetCount(n);
+	List2.SetCount(n);
+	Marks.SetCount(n);
+	Stack.SetCount(2*n+1);
+	memset(Marks.GetWritable(),0,n*sizeof(int));
+	Generation=0;
+}
+
+
+emTextRegEx::Matcher::~Matcher()
+{
+}
+
+
+bool emTextRegEx::Matcher::Search(
+	const int * text, int textLen, int startIndex,
+	int * pMatchStart, int * pMatchEnd
+)
+{
+	const Instruction * prog, * ins;
+	Thread * clist, * nlist, * t;
+	int i,j,c,ccount,ncount;
+	bool found;
+
+	if (RegEx.Program.GetCount()<=0) return false;
+
+	// Each thread is a state of the automaton together with the start
+	// of its match. The threads are ordered by priority. Of all threads
+	// which are in the same state, only the first one is kept.
+	prog=RegEx.Program.Get();
+	clist=List1.GetWritable();
+	nlist=List2.GetWritable();
+	ccount=0;
+	found=false;
+	if (Generation>INT_MAX-4) {
+		memset(Marks.GetWritable(),0,Marks.GetCount()*sizeof(int));
+		Generation=0;
+	}
+	Generation++;
+	for (i=startIndex; i<=textLen; i++) {
+		if (!found) {
+			// A new match may start here, with least priority.
+			ccount=AddThread(clist,ccount,0,i,text,textLen,i);
+		}
+		if (Generation>INT_MAX-4) {
+			memset(Marks.GetWritable(),0,Marks.GetCount()*sizeof(int));
+			Generation=0;
+		}
+		Generation++;
+		if (ccount<=0) {
+			if (found) break;
+			continue;
+		}
+		ncount=0;
+		c=-1;
+		if (i<textLen) {
+			c=text[i];
+			if (!RegEx.CaseSensitive) c=FoldCase(c);
+		}
+		for (j=0; j<ccount; j++) {
+			t=clist+j;
+			ins=prog+t->PC;
+			switch (ins->Op) {
+			case OP_MATCH:
+				if (i>t->Start) {
+					// Threads of less priority are cut off.
+					found=true;
+					*pMatchStart=t->Start;
+					*pMatchEnd=i;
+					j=ccount;
+				}
+				break;
+			case OP_CHAR:
+				if (c==ins->Arg) {
+					ncount=AddThread(
+						nlist,ncount,t->PC+1,t->Start,text,textLen,i+1
+					);
+				}
+				break;
+			case OP_ANY:
+				if (c>=0) {
+					ncount=AddThread(
+						nlist,ncount,t->PC+1,t->Start,text,textLen,i+1
+					);
+				}
+				break;
+			case OP_CLASS:
+				if (c>=0 && RegEx.IsInClass(ins->Arg,text[i])) {
+					ncount=AddThread(
+						nlist,ncount,t->PC+1,t->Start,text,textLen,i+1
+					);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+		t=clist;
+		clist=nlist;
+		nlist=t;
+		ccount=ncount;
+	}
+	return found;
+}
+
+
+int emTextRegEx::Matcher::AddThread(
+	Thread * list, int count, int pc, int start,
+	const int * text, int textLen, int index
+)
+{
+	const Instruction * prog, * ins;
+	int * marks, * stack;
+	int sp;
+	bool w1,w2;
+
+	// Follow the jumps and zero-width assertions depth-first, so that
+	// the threads are added in the order of priority.
+	prog=RegEx.Program.Get();
+	marks=Marks.GetWritable();
+	stack=Stack.GetWritable();
+	sp=0;
+	stack[sp++]=pc;
+	while (sp>0) {
+		pc=stack[--sp];
+		if (marks[pc]==Generation) continue;
+		marks[pc]=Generation;
+		ins=prog+pc;
+		switch (ins->Op) {
+		case OP_JMP:
+			stack[sp++]=ins->X;
+			break;
+		case OP_SPLIT:
+			stack[sp++]=ins->Y;
+			stack[sp++]=ins->X;
+			break;
+		case OP_BOL:
+			if (index==0) stack[sp++]=pc+1;
+			break;
+		case OP_EOL:
+			if (index==textLen) stack[sp++]=pc+1;
+			break;
+		case OP_WORD_BOUNDARY:
+		case OP_NOT_WORD_BOUNDARY:
+			w1=(index>0 && IsWordChar(text[index-1]));
+			w2=(index<textLen && IsWordChar(text[index]));
+			if ((w1!=w2)==(ins->Op==OP_WORD_BOUNDARY)) stack[sp++]=pc+1;
+			break;
+		default:
+			list[count].PC=pc;
+			list[count].Start=start;
+			count++;
+			break;
+		}
+	}
+	return count;
+}
+
+
+int emTextRegEx::AddNode(NodeType type, int arg, int child1, int child2)
+{
+	Node n;
+
+	n.Type=type;
+	n.Arg=arg;
+	n.Child1=child1;
+	n.Child2=child2;
+	n.Min=0;
+	n.Max=0;
+	Nodes.Add(n);
+	return Nodes.GetCount()-1;
+}
+
+
+int emTextRegEx::ParseAlternatives(Parser & p)
+{
+	int n,m;
+
+	p.Depth++;
+	if (p.Depth>MAX_DEPTH) throw emException("Too many nested groups.");
+	n=ParseConcatenation(p);
+	while (p.Pos<p.Len && p.P[p.Pos]=='|') {
+		p.Pos++;
+		m=ParseConcatenation(p);
+		n=AddNode(N_ALT,0,n,m);
+	}
+	p.Depth--;
+	return n;
+}
+
+
+int emTextRegEx::ParseConcatenation(Parser & p)
+{
+	int n,m;
+
+	n=-1;
+	while (p.Pos<p.Len && p.P[p.Pos]!='|' && p.P[p.Pos]!=')') {
+		m=ParseRepetition(p);
+		if (n<0) n=m;
+		else n=AddNode(N_CAT,0,n,m);
+	}
+	if (n<0) n=AddNode(N_EMPTY);
+	return n;
+}
+
+
+int emTextRegEx::ParseRepetition(Parser & p)
+{
+	int n,c,min,max,pos;
+
+	n=ParseAtom(p);
+	while (p.Pos<p.Len) {
+		c=p.P[p.Pos];
+		if (c=='*') {
+			min=0;
+			max=-1;
+			p.Pos++;
+		}
+		else if (c=='+') {
+			min=1;
+			max=-1;
+			p.Pos++;
+		}
+		else if (c=='?') {
+			min=0;
+			max=1;
+			p.Pos++;
+		}
+		else if (c=='{') {
+			// Without a valid count, the brace is a plain character.
+			pos=p.Pos;
+			p.Pos++;
+			min=ParseInt(p);
+			if (min<0) {
+				p.Pos=pos;
+				break;
+			}
+			max=min;
+			if (p.Pos<p.Len && p.P[p.Pos]==',') {
+				p.Pos++;
+				max=ParseInt(p);
+			}
+			if (p.Pos>=p.Len || p.P[p.Pos]!='}') {
+				p.Pos=pos;
+				break;
+			}
+			p.Pos++;
+			if (max>=0 && max<min) {
+				throw emException("Invalid repetition count.");
+			}
+			if (min>MAX_REPETITION || max>MAX_REPETITION) {
+				throw emException("Repetition count too large.");
+			}
+		}
+		else {
+			break;
+		}
+		n=AddNode(N_REPEAT,0,n);
+		Nodes.GetWritable(n).Min=min;
+		Nodes.GetWritable(n).Max=max;
+	}
+	return n;
+}
+
+
+int emTextRegEx::ParseAtom(Parser & p)
+{
+	int n,c;
+
+	c=p.P[p.Pos++];
+	switch (c) {
+	case '(':
+		if (p.Pos+1<p.Len && p.P[p.Pos]=='?' && p.P[p.Pos+1]==':') {
+			p.Pos+=2;
+		}
+		n=ParseAlternatives(p);
+		if (p.Pos>=p.Len || p.P[p.Pos]!=')') {
+			throw emException("Missing ')'.");
+		}
+		p.Pos++;
+		return n;
+	case '[':
+		return ParseClass(p);
+	case '.':
+		return AddNode(N_ANY);
+	case '^':
+		return AddNode(N_BOL);
+	case '$':
+		return AddNode(N_EOL);
+	case '*':
+	case '+':
+	case '?':
+		throw emException("Nothing to repeat.");
+	case '\\':
+		if (p.Pos>=p.Len) throw emException("Trailing backslash.");
+		c=p.P[p.Pos++];
+		switch (c) {
+		case 'd': case 'w': case 's':
+		case 'D': case 'W': case 'S':
+			n=Classes.GetCount();
+			Classes.AddNew();
+			Classes.GetWritable(n).FirstRange=ClassRanges.GetCount()/2;
+			Classes.GetWritable(n).Negated=false;
+			AddClassEscape(c);
+			Classes.GetWritable(n).RangeCount=
+				ClassRanges.GetCount()/2-Classes[n].FirstRange;
+			return AddNode(N_CLASS,n);
+		case 'b':
+			return AddNode(N_WORD_BOUNDARY);
+		case 'B':
+			return AddNode(N_NOT_WORD_BOUNDARY);
+		default:
+			return AddNode(N_CHAR,GetEscapedChar(c));
+		}
+	default:
+		return AddNode(N_CHAR,c);
+	}
+}
+
+
+int emTextRegEx::ParseClass(Parser & p)
+{
+	int n,c,c2;
+	bool first;
+
+	n=Classes.GetCount();
+	Classes.AddNew();
+	Classes.GetWritable(n).FirstRange=ClassRanges.GetCount()/2;
+	Classes.GetWritable(n).Negated=false;
+	if (p.Pos<p.Len && p.P[p.Pos]=='^') {
+		Classes.GetWritable(n).Negated=true;
+		p.Pos++;
+	}
+	for (first=true; ; first=false) {
+		if (p.Pos>=p.Len) throw emException("Missing ']'.");
+		c=p.P[p.Pos++];
+		if (c==']' && !first) break;
+		if (c=='\\') {
+			if (p.Pos>=p.Len) throw emException("Trailing backslash.");
+			c=p.P[p.Pos++];
+			if (
+				c=='d' || c=='w' || c=='s' ||
+				c=='D' || c=='W' || c=='S'
+			) {
+				AddClassEscape(c);
+				continue;
+			}
+			c=GetEscapedChar(c);
+		}
+		c2=c;
+		if (p.Pos+1<p.Len && p.P[p.Pos]=='-' && p.P[p.Pos+1]!=']') {
+			p.Pos++;
+			c2=p.P[p.Pos++];
+			if (c2=='\\') {
+				if (p.Pos>=p.Len) throw emException("Trailing backslash.");
+				c2=GetEscapedChar(p.P[p.Pos++]);
+			}
+			if (c2<c) throw emException("Invalid range in character class.");
+		}
+		ClassRanges.Add(c);
+		ClassRanges.Add(c2);
+	}
+	Classes.GetWritable(n).RangeCount=
+		ClassRanges.GetCount()/2-Classes[n].FirstRange;
+	return AddNode(N_CLASS,n);
+}
+
+
+int emTextRegEx::ParseInt(Parser & p)
+{
+	int n;
+
+	if (p.Pos>=p.Len || p.P[p.Pos]<'0' || p.P[p.Pos]>'9') return -1;
+	for (n=0; p.Pos<p.Len && p.P[p.Pos]>='0' && p.P[p.Pos]<='9'; p.Pos++) {
+		if (n<=MAX_REPETITION) n=n*10+(p.P[p.Pos]-'0');
+	}
+	return n;
+}
+
+
+int emTextRegEx::GetEscapedChar(int c)
+{
+	switch (c) {
+	case 't': return 0x09;
+	case 'n': return 0x0a;
+	case 'v': return 0x0b;
+	case 'f': return 0x0c;
+	case 'r': return 0x0d;
+	case 'e': return 0x1b;
+	}
+	if (
+		(c>='0' && c<='9') ||
+		(c>='A' && c<='Z') ||
+		(c>='a' && c<='z')
+	) {
+		throw emException("Unknown escape sequence: \\%c",(char)c);
+	}
+	return c;
+}
+
+
+void emTextRegEx::AddClassEscape(int c)
+{
+	static const int digitRanges[]={ '0','9' };
+	static const int wordRanges[]={
+		'0','9', 'A','Z', '_','_', 'a','z', 128,INT_MAX
+	};
+	static const int spaceRanges[]={ 0x09,0x0d, 0x20,0x20 };
+	const int * r;
+	int i,n,c1;
+
+	switch (c) {
+	case 'd': case 'D':
+		r=digitRanges;
+		n=sizeof(digitRanges)/sizeof(int)/2;
+		break;
+	case 'w': case 'W':
+		r=wordRanges;
+		n=sizeof(wordRanges)/sizeof(int)/2;
+		break;
+	default:
+		r=spaceRanges;
+		n=sizeof(spaceRanges)/sizeof(int)/2;
+		break;
+	}
+	if (c>='a') {
+		for (i=0; i<n; i++) {
+			ClassRanges.Add(r[2*i]);
+			ClassRanges.Add(r[2*i+1]);
+		}
+	}
+	else {
+		// Complement of the sorted ranges.
+		c1=0;
+		for (i=0; i<n; i++) {
+			if (r[2*i]>c1) {
+				ClassRanges.Add(c1);
+				ClassRanges.Add(r[2*i]-1);
+			}
+			if (r[2*i+1]==INT_MAX) return;
+			c1=r[2*i+1]+1;
+		}
+		ClassRanges.Add(c1);
+		ClassRanges.Add(INT_MAX);
+	}
+}
+
+
+void emTextRegEx::Emit(int node)
+{
+	emArray<int> list;
+	const Node * n;
+	int i,k,pc;
+
+	n=&Nodes[node];
+	switch (n->Type) {
+	case N_EMPTY:
+		break;
+	case N_CHAR:
+		AddInstruction(OP_CHAR,CaseSensitive ? n->Arg : FoldCase(n->Arg));
+		break;
+	case N_ANY:
+		AddInstruction(OP_ANY);
+		break;
+	case N_CLASS:
+		AddInstruction(OP_CLASS,n->Arg);
+		break;
+	case N_BOL:
+		AddInstruction(OP_BOL);
+		break;
+	case N_EOL:
+		AddInstruction(OP_EOL);
+		break;
+	case N_WORD_BOUNDARY:
+		AddInstruction(OP_WORD_BOUNDARY);
+		break;
+	case N_NOT_WORD_BOUNDARY:
+		AddInstruction(OP_NOT_WORD_BOUNDARY);
+		break;
+	case N_CAT:
+		// Concatenations are chained to the left. They are flattened
+		// here, so that the recursion is not as deep as the pattern is
+		// long.
+		for (; n->Type==N_CAT; n=&Nodes[n->Child1]) list.Add(n->Child2);
+		Emit(n-Nodes.Get());
+		for (i=list.GetCount()-1; i>=0; i--) Emit(list[i]);
+		break;
+	case N_ALT:
+		pc=AddInstruction(OP_SPLIT);
+		Program.GetWritable(pc).X=Program.GetCount();
+		Emit(n->Child1);
+		k=AddInstruction(OP_JMP);
+		Program.GetWritable(pc).Y=Program.GetCount();
+		Emit(Nodes[node].Child2);
+		Program.GetWritable(k).X=Program.GetCount();
+		break;
+	case N_REPEAT:
+		for (i=0; i<Nodes[node].Min; i++) Emit(Nodes[node].Child1);
+		if (Nodes[node].Max<0) {
+			pc=AddInstruction(OP_SPLIT);
+			Program.GetWritable(pc).X=pc+1;
+			Emit(Nodes[node].Child1);
+			AddInstruction(OP_JMP,0,pc);
+			Program.GetWritable(pc).Y=Program.GetCount();
+		}
+		else {
+			for (i=Nodes[node].Min; i<Nodes[node].Max; i++) {
+				pc=AddInstruction(OP_SPLIT);
+				Program.GetWritable(pc).X=pc+1;
+				list.Add(pc);
+				Emit(Nodes[node].Child1);
+			}
+			for (i=0; i<list.GetCount(); i++) {
+				Program.GetWritable(list[i]).Y=Program.GetCount();
+			}
+		}
+		break;
+	}
+}
+
+
+int emTextRegEx::AddInstruction(OpType op, int arg, int x, int y)
+{
+	Instruction ins;
+
+	if (Program.GetCount()>=MAX_PROGRAM_SIZE) {
+		throw emException("Regular expression too complex.");
+	}
+	ins.Op=op;
+	ins.Arg=arg;
+	ins.X=x;
+	ins.Y=y;
+	Program.Add(ins);
+	return Program.GetCount()-1;
+}
+
+
+void emTextRegEx::CalcRequired(int node, ReqInfo * info) const
+{
+	emArray<int> list;
+	emArray<int> run;
+	ReqInfo sub;
+	const Node * n;
+	bool exact;
+	int i,c;
+
+	info->Exact=false;
+	info->String.Clear();
+	n=&Nodes[node];
+	switch (n->Type) {
+	case N_EMPTY:
+		info->Exact=true;
+		break;
+	case N_CHAR:
+		c=n->Arg;
+		if (!CaseSensitive) {
+			c=FoldCase(c);
+			if (c>=128 && UnfoldCase(c)!=c) break;
+		}
+		info->Exact=true;
+		info->String.Add(c);
+		break;
+	case N_CAT:
+		// Concatenate runs of exact strings, and take the longest one.
+		for (; n->Type==N_CAT; n=&Nodes[n->Child1]) list.Add(n->Child2);
+		list.Add(n-Nodes.Get());
+		exact=true;
+		for (i=list.GetCount()-1; i>=0; i--) {
+			CalcRequired(list[i],&sub);
+			if (sub.Exact && run.GetCount()+sub.String.GetCount()<=MAX_REQUIRED_LEN) {
+				run.Add(sub.String);
+				continue;
+			}
+			exact=false;
+			if (run.GetCount()>info->String.GetCount()) info->String=run;
+			run.Clear();
+			if (sub.String.GetCount()>info->String.GetCount()) {
+				info->String=sub.String;
+			}
+		}
+		if (exact) {
+			info->Exact=true;
+			info->String=run;
+		}
+		else if (run.GetCount()>info->String.GetCount()) {
+			info->String=run;
+		}
+		break;
+	case N_REPEAT:
+		if (n->Min<=0) break;
+		CalcRequired(n->Child1,&sub);
+		if (
+			sub.Exact && n->Min==n->Max &&
+			sub.String.GetCount()*n->Min<=MAX_REQUIRED_LEN
+		) {
+			info->Exact=true;
+			for (i=0; i<n->Min; i++) info->String.Add(sub.String);
+		}
+		else {
+			info->String=sub.String;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+
+bool emTextRegEx::IsInClass(int classIndex, int c) const
+{
+	const CharClass * cc;
+	const int * r;
+	int i,c2,c3;
+
+	cc=&Classes[classIndex];
+	r=ClassRanges.Get()+2*cc->FirstRange;
+	c2=c;
+	c3=c;
+	if (!CaseSensitive) {
+		c2=FoldCase(c);
+		c3=UnfoldCase(c);
+	}
+	for (i=0; i<cc->RangeCount; i++, r+=2) {
+		if (
+			(c>=r[0] && c<=r[1]) ||
+			(c2>=r[0] && c2<=r[1]) ||
+			(c3>=r[0] && c3<=r[1])
+		) {
+			return !cc->Negated;
+		}
+	}
+	return cc->Negated;
+}
+
+
+bool emTextRegEx::IsWordChar(int c)
+{
+	return
+		(c>='0' && c<='9') ||
+		(c>='A' && c<='Z') ||
+		(c>='a' && c<='z') ||
+		c=='_' ||
+		c>127
+	;
+}
+
+
+int emTextRegEx::UnfoldCase(int c)
+{
+	if (c>='a' && c<='z') return c-32;
+	if (c>=0xE0 && c<=0xFE && c!=0xF7) return c-32;
+	return c;
+}
@@ -0,0 +1,607 @@
+//------------------------------------------------------------------------------
+// emTextSearch.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emText/emTextSearch.h>
+
+
+//==============================================================================
+//================================ emTextSearch ================================
+//==============================================================================
+
+emTextSearch::emTextSearch(emContext & context)
+	: emEngine(context.GetScheduler())
+{
+	ThreadPool=emRenderThreadPool::Acquire(context.GetRootContext());
+	FindKernel=FindScalar;
+#	if EM_HAVE_X86_INTRINSICS
+		if (emCanCpuDoAvx2()) FindKernel=FindAvx2;
+#	endif
+	Model=NULL;
+	RegExMode=false;
+	CaseSensitive=false;
+	Searching=false;
+	Prepared=false;
+	Truncated=false;
+	Literal=false;
+	FoldCase=false;
+	EncodedString.SetTuningLevel(4);
+	Encoding=emTextFileModel::CE_BINARY;
+	Pos=0;
+	SearchedSize=0;
+	LastSignalClock=0;
+	MatchStarts.SetTuningLevel(4);
+	MatchEnds.SetTuningLevel(4);
+}
+
+
+emTextSearch::~emTextSearch()
+{
+}
+
+
+void emTextSearch::SetModel(emTextFileModel * model)
+{
+	if (Model==model) return;
+	if (Model) {
+		RemoveWakeUpSignal(Model->GetChangeSignal());
+		RemoveWakeUpSignal(Model->GetLineIndexSignal());
+		RemoveWakeUpSignal(Model->GetFileStateSignal());
+	}
+	Model=model;
+	if (Model) {
+		AddWakeUpSignal(Model->GetChangeSignal());
+		AddWakeUpSignal(Model->GetLineIndexSignal());
+		AddWakeUpSignal(Model->GetFileStateSignal());
+	}
+	Restart();
+}
+
+
+void emTextSearch::Start(
+	const emString & pattern, bool regEx, bool caseSensitive
+)
+{
+	emArray<int> chars;
+	emMBState mbState;
+	const char * p;
+	int c,n,len;
+
+	RegExMode=regEx;
+	CaseSensitive=caseSensitive;
+	if (pattern.IsEmpty()) {
+		Clear();
+		return;
+	}
+
+	Pattern=pattern;
+	ErrorText.Clear();
+
+	p=Pattern.Get();
+	len=Pattern.GetLen();
+	while (len>0) {
+		n=emDecodeChar(&c,p,len,&mbState);
+		if (n<=0) {
+			c=(emByte)*p;
+			n=1;
+		}
+		chars.Add(c);
+		p+=n;
+		len-=n;
+	}
+
+	try {
+		RegEx.Compile(chars.Get(),chars.GetCount(),CaseSensitive,!RegExMode);
+	}
+	catch (const emException & exception) {
+		ErrorText=exception.GetText();
+		RegEx=emTextRegEx();
+	}
+
+	Restart();
+}
+
+
+void emTextSearch::Clear()
+{
+	Pattern.Clear();
+	ErrorText.Clear();
+	RegEx=emTextRegEx();
+	Restart();
+}
+
+
+double emTextSearch::GetProgress() const
+{
+	if (!Searching) return 100.0;
+	if (!Model || Model->GetContentSize()<=0) return 0.0;
+	return 100.0*Pos/Model->GetContentSize();
+}
+
+
+int emTextSearch::FindMatch(emInt64 contentIndex) const
+{
+	int i1,i2,i;
+
+	i1=0;
+	i2=MatchEnds.GetCount();
+	while (i1<i2) {
+		i=(i1+i2)>>1;
+		if (MatchEnds[i]>contentIndex) i2=i;
+		else i1=i+1;
+	}
+	return i1;
+}
+
+
+bool emTextSearch::Cycle()
+{
+	emUInt64 clk;
+
+	if (!Model) return false;
+
+	if (IsSignaled(Model->GetChangeSignal())) {
+		Restart();
+	}
+	else if (
+		IsSignaled(Model->GetLineIndexSignal()) && Prepared &&
+		Model->GetContentSize()!=SearchedSize
+	) {
+		HandleAppendedContent();
+	}
+
+	if (!Searching || Model->GetFileState()!=emFileModel::FS_LOADED) {
+		return false;
+	}
+
+	if (!Prepared) Prepare();
+
+	while (Searching) {
+		ContinueSearching();
+		if (IsTimeSliceAtEnd()) break;
+	}
+
+	clk=emGetClockMS();
+	if (!Searching || clk-LastSignalClock>=SIGNAL_INTERVAL) {
+		LastSignalClock=clk;
+		Signal(ChangeSignal);
+	}
+
+	return Searching;
+}
+
+
+void emTextSearch::Restart()
+{
+	MatchStarts.Clear(true);
+	MatchEnds.Clear(true);
+	Pos=0;
+	SearchedSize=0;
+	Prepared=false;
+	Truncated=false;
+	Searching=(Model && !Pattern.IsEmpty() && ErrorText.IsEmpty());
+	if (Searching) WakeUp();
+	LastSignalClock=emGetClockMS();
+	Signal(ChangeSignal);
+}
+
+
+void emTextSearch::Prepare()
+{
+	Encoding=Model->GetCharEncoding();
+	SearchedSize=Model->GetContentSize();
+	Prepared=true;
+	if (Model->IsContentWindowed() || !EncodeRequiredString()) {
+		Searching=false;
+	}
+}
+
+
+void emTextSearch::ContinueSearching()
+{
+	ThreadData data;
+	Chunk * chunks;
+	emInt64 size,end;
+	int i,j,n;
+
+	size=Model->GetContentSize();
+	if (Pos>=size) {
+		Searching=false;
+		return;
+	}
+
+	// Cut the content into chunks at line starts, so that no line is
+	// searched by two threads.
+	n=ThreadPool->GetThreadCount();
+	if (n>(size-Pos)/STEP_SIZE) n=(int)((size-Pos)/STEP_SIZE);
+	if (n<1) n=1;
+	chunks=new Chunk[n];
+	end=Pos;
+	for (i=0; i<n; i++) {
+		chunks[i].Begin=end;
+		if (i==n-1 && size-end<=STEP_SIZE) end=size;
+		else if (end<size) end=FindLineStart(end+STEP_SIZE-1,size);
+		chunks[i].End=end;
+	}
+
+	data.Search=this;
+	data.Chunks=chunks;
+	if (n>1) ThreadPool->CallParallel(SearchThreadFunc,&data,n);
+	else SearchThreadFunc(&data,0);
+
+	for (i=0; i<n; i++) {
+		j=MAX_MATCH_COUNT-MatchStarts.GetCount();
+		if (chunks[i].Starts.GetCount()>=j) {
+			MatchStarts.Add(chunks[i].Starts.Get(),j);
+			MatchEnds.Add(chunks[i].Ends.Get(),j);
+			Truncated=true;
+			Searching=false;
+			break;
+		}
+		MatchStarts.Add(chunks[i].Starts);
+		MatchEnds.Add(chunks[i].Ends);
+		Pos=chunks[i].End;
+	}
+	delete [] chunks;
+
+	if (Pos>=size) Searching=false;
+}
+
+
+void emTextSearch::HandleAppendedContent()
+{
+	emInt64 size;
+	int i;
+
+	size=Model->GetContentSize();
+	if (size<SearchedSize || Model->GetCharEncoding()!=Encoding) {
+		Restart();
+		return;
+	}
+	if (Pos>=SearchedSize && !Truncated) {
+		// The last line may have been continued by the new data, so
+		// it is searched again.
+		Pos=FindPrevLineStart(SearchedSize,0);
+		i=MatchStarts.GetCount();
+		while (i>0 && MatchStarts[i-1]>=Pos) i--;
+		MatchStarts.SetCount(i);
+		MatchEnds.SetCount(i);
+		Searching=true;
+	}
+	SearchedSize=size;
+}
+
+
+bool emTextSearch::EncodeRequiredString()
+{
+	const emArray<int> & str=RegEx.GetRequiredString();
+	char buf[EM_MB_LEN_MAX+4];
+	emMBState mbState;
+	int i,c,n,u1,u2;
+
+	EncodedString.Clear();
+	Literal=false;
+	FoldCase=!CaseSensitive;
+
+	for (i=0; i<str.GetCount(); i++) {
+		c=str[i];
+		// Matches never contain line breaks.
+		if (c==0x0a || c==0x0d) return false;
+		switch (Encoding) {
+		case emTextFileModel::CE_7BIT:
+		case emTextFileModel::CE_UTF8:
+			n=emEncodeUtf8Char(buf,c);
+			break;
+		case emTextFileModel::CE_UTF16LE:
+		case emTextFileModel::CE_UTF16BE:
+			if (c>=0x10000) {
+				u1=0xD800+((c-0x10000)>>10);
+				u2=0xDC00+((c-0x10000)&0x3FF);
+				n=4;
+			}
+			else {
+				u1=c;
+				u2=0;
+				n=2;
+			}
+			if (Encoding==emTextFileModel::CE_UTF16LE) {
+				buf[0]=(char)u1;
+				buf[1]=(char)(u1>>8);
+				buf[2]=(char)u2;
+				buf[3]=(char)(u2>>8);
+			}
+			else {
+				buf[0]=(char)(u1>>8);
+				buf[1]=(char)u1;
+				buf[2]=(char)(u2>>8);
+				buf[3]=(char)u2;
+			}
+			break;
+		case emTextFileModel::CE_8BIT:
+			if (emIsUtf8System()) {
+				// Like emTextFileModel::DecodeChar(..), but the
+				// special characters of 0x80 to 0x9F are not
+				// supported here.
+				if (c>=0x80 && (c<0xA0 || c>0xFF)) {
+					EncodedString.Clear();
+					return true;
+				}
+				buf[0]=(char)c;
+				n=1;
+				break;
+			}
+		default:
+			n=emEncodeChar(buf,c,&mbState);
+			break;
+		}
+		EncodedString.Add(buf,n);
+	}
+
+	if (FoldCase) {
+		for (i=0; i<EncodedString.GetCount(); i++) {
+			c=(emByte)EncodedString[i];
+			if (c>='A' && c<='Z') EncodedString.GetWritable(i)=(char)(c+32);
+		}
+	}
+
+	if (EncodedString.GetCount()>0 && RegEx.IsRequiredStringExact()) {
+		switch (Encoding) {
+		case emTextFileModel::CE_7BIT:
+		case emTextFileModel::CE_UTF8:
+			Literal=true;
+			break;
+		case emTextFileModel::CE_8BIT:
+			Literal=emIsUtf8System();
+			break;
+		case emTextFileModel::CE_UTF16LE:
+		case emTextFileModel::CE_UTF16BE:
+			// Folding single bytes would be wrong here.
+			Literal=!FoldCase;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+
+int emTextSearch::GetUnitSize() const
+{
+	if (
+		Encoding==emTextFileModel::CE_UTF16LE ||
+		Encoding==emTextFileModel::CE_UTF16BE
+	) return 2;
+	return 1;
+}
+
+
+int emTextSearch::GetUnit(emInt64 index) const
+{
+	const char * p;
+
+	p=Model->GetContent()+index;
+	switch (Encoding) {
+	case emTextFileModel::CE_UTF16LE:
+		return ((emByte)p[0])|(((emByte)p[1])<<8);
+	case emTextFileModel::CE_UTF16BE:
+		return (((emByte)p[0])<<8)|((emByte)p[1]);
+	default:
+		return (emByte)p[0];
+	}
+}
+
+
+emInt64 emTextSearch::FindLineStart(emInt64 index, emInt64 end) const
+{
+	int u,c;
+
+	u=GetUnitSize();
+	if (u==2) index&=~(emInt64)1;
+	for (; index+u<=end; index+=u) {
+		c=GetUnit(index);
+		if (c==0x0a) return index+u;
+		if (c==0x0d) {
+			if (index+2*u<=end && GetUnit(index+u)==0x0a) return index+2*u;
+			return index+u;
+		}
+	}
+	return end;
+}
+
+
+emInt64 emTextSearch::FindPrevLineStart(emInt64 index, emInt64 begin) const
+{
+	int u,c;
+
+	u=GetUnitSize();
+	if (u==2) index&=~(emInt64)1;
+	for (; index-u>=begin; index-=u) {
+		c=GetUnit(index-u);
+		if (c==0x0a || c==0x0d) break;
+	}
+	return index;
+}
+
+
+emInt64 emTextSearch::FindLineEnd(emInt64 index, emInt64 end) const
+{
+	const char * p;
+	int u,c;
+
+	u=GetUnitSize();
+	if (u==1) {
+		p=Model->GetContent();
+		for (; index<end; index++) {
+			c=(emByte)p[index];
+			if (c<=0x0d && (c==0x0a || c==0x0d)) break;
+		}
+		return index;
+	}
+	index&=~(emInt64)1;
+	for (; index+u<=end; index+=u) {
+		c=GetUnit(index);
+		if (c==0x0a || c==0x0d) return index;
+	}
+	return end;
+}
+
+
+void emTextSearch::SearchChunk(Chunk * chunk) const
+{
+	chunk->Starts.SetTuningLevel(4);
+	chunk->Ends.SetTuningLevel(4);
+	if (Literal) SearchLiteral(chunk);
+	else SearchRegEx(chunk);
+}
+
+
+void emTextSearch::SearchLiteral(Chunk * chunk) const
+{
+	const char * content, * str;
+	emInt64 pos,p;
+	int len;
+
+	content=Model->GetContent();
+	str=EncodedString.Get();
+	len=EncodedString.GetCount();
+	pos=chunk->Begin;
+	while (chunk->Starts.GetCount()<MAX_MATCH_COUNT) {
+		p=FindKernel(content,pos,chunk->End,str,len,FoldCase);
+		if (p<0) break;
+		if ((p&1) && GetUnitSize()==2) {
+			pos=p+1;
+			continue;
+		}
+		chunk->Starts.Add(p);
+		chunk->Ends.Add(p+len);
+		pos=p+len;
+	}
+}
+
+
+void emTextSearch::SearchRegEx(Chunk * chunk) const
+{
+	emTextRegEx::Matcher matcher(RegEx);
+	emArray<int> chars;
+	emArray<int> offsets;
+	const char * content, * str;
+	emInt64 pos,p,lineStart,lineEnd;
+	int len,n,i,c,s,e;
+
+	chars.SetTuningLevel(4);
+	offsets.SetTuningLevel(4);
+	content=Model->GetContent();
+	str=EncodedString.Get();
+	len=EncodedString.GetCount();
+	pos=chunk->Begin;
+	while (pos<chunk->End && chunk->Starts.GetCount()<MAX_MATCH_COUNT) {
+		if (len>0) {
+			p=FindKernel(content,pos,chunk->End,str,len,FoldCase);
+			if (p<0) break;
+			lineStart=FindPrevLineStart(p,pos);
+		}
+		else {
+			p=pos;
+			lineStart=pos;
+		}
+		lineEnd=FindLineEnd(p,chunk->End);
+		pos=FindLineStart(lineEnd,chunk->End);
+
+		// Decode the line and match it, in pieces if it is very long.
+		while (lineStart<lineEnd) {
+			emMBState mbState;
+			chars.Clear();
+			offsets.Clear();
+			for (p=lineStart; p<lineEnd && chars.GetCount()<MAX_LINE_CHARS; ) {
+				n=Model->DecodeChar(&c,p,&mbState);
+				if (n<=0) {
+					c=(emByte)content[p];
+					n=1;
+				}
+				chars.Add(c);
+				offsets.Add((int)(p-lineStart));
+				p+=n;
+			}
+			if (p>lineEnd) p=lineEnd;
+			offsets.Add((int)(p-lineStart));
+			for (i=0; ; i=e) {
+				if (!matcher.Search(chars.Get(),chars.GetCount(),i,&s,&e)) break;
+				chunk->Starts.Add(lineStart+offsets[s]);
+				chunk->Ends.Add(lineStart+offsets[e]);
+			}
+			lineStart=p;
+		}
+	}
+}
+
+
+void emTextSearch::SearchThreadFunc(void * data, int index)
+{
+	const ThreadData * d;
+
+	d=(const ThreadData*)data;
+	d->Search->SearchChunk(d->Chunks+index);
+}
+
+
+emInt64 emTextSearch::FindScalar(
+	const char * content, emInt64 begin, emInt64 end,
+	const char * str, int len, bool foldCase
+)
+{
+	const char * p, * pEnd;
+	int c;
+
+	if (end-begin<len) return -1;
+	p=content+begin;
+	pEnd=content+end-len+1;
+	c=(emByte)str[0];
+	if (!foldCase || c<'a' || c>'z') {
+		for (;;) {
+			p=(const char*)memchr(p,c,pEnd-p);
+			if (!p) return -1;
+			if (IsEqual(p,str,len,foldCase)) return p-content;
+			p++;
+		}
+	}
+	for (; p<pEnd; p++) {
+		if ((((emByte)*p)|0x20)==c && IsEqual(p,str,len,true)) {
+			return p-content;
+		}
+	}
+	return -1;
+}
+
+
+bool emTextSearch::IsEqual(
+	const char * p, const char * str, int len, bool foldCase
+)
+{
+	int i,c;
+
+	if (!foldCase) return memcmp(p,str,len)==0;
+	for (i=0; i<len; i++) {
+		c=(emByte)p[i];
+		if (c>='A' && c<='Z') c+=32;
+		if (c!=(emByte)str[i]) return false;
+	}
+	return true;
+}
@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+// emTextSearch_AVX2.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emText/emTextSearch.h>
+
+#if EM_HAVE_X86_INTRINSICS
+#	if defined(_MSC_VER)
+#		include <immintrin.h>
+#		include <intrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+
+
+static inline int emTextSearch_Ctz(unsigned int m)
+{
+#	if defined(_MSC_VER)
+		unsigned long r;
+		_BitScanForward(&r,m);
+		return (int)r;
+#	else
+		return __builtin_ctz(m);
+#	endif
+}
+
+
+#if defined(__GNUC__)
+	__attribute__((target("avx2")))
+#endif
+emInt64 emTextSearch::FindAvx2(
+	const char * content, emInt64 begin, emInt64 end,
+	const char * str, int len, bool foldCase
+)
+{
+	__m256i vFirst,vLast,vFirstOr,vLastOr,a,b;
+	emInt64 i,n;
+	unsigned int m;
+	int c1,c2;
+
+	if (end-begin<len) return -1;
+
+	// Compare the first and the last byte of the string at 32 positions
+	// at once, and verify the candidates. With folding, letters are
+	// compared with bit 5 set, which may give false candidates but
+	// never misses one.
+	c1=(emByte)str[0];
+	c2=(emByte)str[len-1];
+	vFirst=_mm256_set1_epi8((char)c1);
+	vLast=_mm256_set1_epi8((char)c2);
+	vFirstOr=_mm256_setzero_si256();
+	vLastOr=_mm256_setzero_si256();
+	if (foldCase) {
+		if (c1>='a' && c1<='z') vFirstOr=_mm256_set1_epi8(0x20);
+		if (c2>='a' && c2<='z') vLastOr=_mm256_set1_epi8(0x20);
+	}
+
+	i=begin;
+	n=end-len+1;
+	for (; i+32<=n; i+=32) {
+		a=_mm256_loadu_si256((const __m256i*)(content+i));
+		b=_mm256_loadu_si256((const __m256i*)(content+i+len-1));
+		a=_mm256_cmpeq_epi8(_mm256_or_si256(a,vFirstOr),vFirst);
+		b=_mm256_cmpeq_epi8(_mm256_or_si256(b,vLastOr),vLast);
+		m=(unsigned int)_mm256_movemask_epi8(_mm256_and_si256(a,b));
+		while (m) {
+			c1=emTextSearch_Ctz(m);
+			if (IsEqual(content+i+c1,str,len,foldCase)) return i+c1;
+			m&=m-1;
+		}
+	}
+
+	return FindScalar(content,i,end,str,len,foldCase);
+}
+
+
+#endif
@@ -20,6 +20,7 @@
 
 #include <emCore/emFpPlugin.h>
 #include <emTiff/emTiffImageFileModel.h>
+#include <emTiff/emTiffTiledImagePanel.h>
 
 
 extern "C" {
@@ -33,6 +34,14 @@ extern "C" {
 			*errorBuf="emTiffFpPlugin: No properties allowed.";
 			return NULL;
 		}
+		if (emTiffTiledImageFileModel::IsSuitableFile(path)) {
+			return new emTiffTiledImagePanel(
+				parent,name,
+				emTiffTiledImageFileModel::Acquire(
+					parent.GetRootContext(),path
+				)
+			);
+		}
 		return new emImageFilePanel(
 			parent,name,
 			emTiffImageFileModel::Acquire(
@@ -40,4 +49,23 @@ extern "C" {
 			)
 		);
 	}
+
+
+	emRef<emModel> emTiffFpPluginModelFunc(
+		emContext & context, const emString & className,
+		const emString & name, bool common, emFpPlugin * plugin,
+		emString * errorBuf
+	)
+	{
+		if (
+			className!="emImageFileModel" &&
+			className!="emTiffImageFileModel"
+		) {
+			*errorBuf="emTiffFpPlugin: Unsupported model class.";
+			return NULL;
+		}
+		return emRef<emModel>(
+			emTiffImageFileModel::Acquire(context,name,common)
+		);
+	}
 }
@@ -81,7 +81,7 @@ emTiffImageFileModel::~emTiffImageFileModel()
 void emTiffImageFileModel::TryStartLoading()
 {
 	int samplesPerPixel,bitsPerSample,compression,photometric;
-	emString compStr;
+	int reduction,dir,bestDir,bestW,w,h;
 	char * imageDesc;
 	emUInt32 u32;
 	emUInt16 u16;
@@ -99,14 +99,9 @@ void emTiffImageFileModel::TryStartLoading()
 	L->CurrentX=0;
 	L->CurrentY=0;
 	L->CurrentOp=0;
+	L->Sub=1;
 
-	emTiff_ErrorMutex.Lock();
-	if (emTiff_ErrorThread==emThread::GetCurrentThreadId()) {
-		strcpy(emTiff_Error,"unknown TIFF error");
-	}
-	TIFFSetErrorHandler(emTiff_ErrorHandler);
-	TIFFSetWarningHandler(emTiff_WarningHandler);
-	emTiff_ErrorMutex.Unlock();
+	PrepareTiffCall();
 
 	t=TIFFOpen(GetFilePath(),"r");
 	if (!t) ThrowTiffError();
@@ -161,20 +156,10 @@ void emTiffImageFileModel::TryStartLoading()
 		L->Channels=4;
 	}
 
-	switch (compression) {
-	case 1: compStr="uncompressed"; break;
-	case 2: compStr="CCITT RLE compressed"; break;
-	case 3: compStr="CCITT Group 3 compressed"; break;
-	case 4: compStr="CCITT Group 4 compressed"; break;
-	case 5: compStr="LZW compressed"; break;
-	case 7: compStr="JPEG compressed"; break;
-	case 32773: compStr="PackBits compressed"; break;
-	default: compStr=emString::Format("compression=%d",compression); break;
-	}
 	FileFormatInfo=emString::Format(
 		"TIFF %d-bit %s (%d channels extracted)",
 		samplesPerPixel*bitsPerSample,
-		compStr.Get(),
+		GetCompressionName(compression).Get(),
 		L->Channels
 	);
 
@@ -183,6 +168,58 @@ void emTiffImageFileModel::TryStartLoading()
 		Comment=imageDesc;
 	}
 
+	reduction=CalcReduction(L->ImgW,L->ImgH,L->Channels,64);
+	if (reduction>1) {
+		// Prefer a reduced-resolution image of the file (pyramid), if
+		// there is one which is still large enough.
+		bestDir=0;
+		bestW=L->ImgW;
+		for (dir=1; TIFFReadDirectory(t); dir++) {
+			if (
+				!TIFFGetField(t,TIFFTAG_SUBFILETYPE,&u32) ||
+				(u32&FILETYPE_REDUCEDIMAGE)==0
+			) continue;
+			if (!TIFFGetField(t,TIFFTAG_IMAGEWIDTH,&u32)) continue;
+			w=(int)u32;
+			if (w<bestW && ((emInt64)w)*reduction>=L->ImgW) {
+				bestDir=dir;
+				bestW=w;
+			}
+		}
+		if (!TIFFSetDirectory(t,(emUInt16)bestDir)) ThrowTiffError();
+		if (bestDir>0) {
+			TIFFGetField(t,TIFFTAG_IMAGEWIDTH,&u32);
+			w=(int)u32;
+			TIFFGetField(t,TIFFTAG_IMAGELENGTH,&u32);
+			h=(int)u32;
+			L->Sub=(int)(((emInt64)w)*reduction/L->ImgW);
+			L->ImgW=w;
+			L->ImgH=h;
+			L->Tiled=TIFFIsTiled(t)!=0;
+			if (L->Tiled) {
+				TIFFGetFieldDefaulted(t,TIFFTAG_TILEWIDTH,&u32);
+				L->PartW=(int)u32;
+				TIFFGetFieldDefaulted(t,TIFFTAG_TILELENGTH,&u32);
+				L->PartH=(int)u32;
+			}
+			else {
+				L->PartW=L->ImgW;
+				TIFFGetFieldDefaulted(t,TIFFTAG_ROWSPERSTRIP,&u32);
+				L->PartH=(int)u32;
+			}
+			if (
+				L->ImgW<L->PartW || L->ImgH<L->PartH ||
+				L->PartW<1 || L->PartH<1
+			) {
+				throw emException("Unsupported TIFF file format.");
+			}
+		}
+		else {
+			L->Sub=reduction;
+		}
+		if (L->Sub<1) L->Sub=1;
+	}
+
 	Signal(ChangeSignal);
 }
 
@@ -193,7 +230,7 @@ bool emTiffImageFileModel::TryContinueLoading()
 	unsigned char * map, * tgt;
 	emUInt32 * src;
 	emUInt32 pix;
-	int r,x,y,x2,y2;
+	int r,x,y,x1,y1,x2,y2,s,tw;
 
 	//??? PartW*PartH is often not less than ImgW*ImgH!
 
@@ -201,7 +238,11 @@ bool emTiffImageFileModel::TryContinueLoading()
 
 	if (!L->Buffer) {
 		L->Buffer=new emUInt32[L->PartW*(size_t)L->PartH];
-		Image.Setup(L->ImgW,L->ImgH,L->Channels);
+		Image.Setup(
+			(L->ImgW+L->Sub-1)/L->Sub,
+			(L->ImgH+L->Sub-1)/L->Sub,
+			L->Channels
+		);
 		Signal(ChangeSignal);
 		return false;
 	}
@@ -220,50 +261,55 @@ bool emTiffImageFileModel::TryContinueLoading()
 
 	x2=L->CurrentX+L->PartW; if (x2>L->ImgW) x2=L->ImgW;
 	y2=L->CurrentY+L->PartH; if (y2>L->ImgH) y2=L->ImgH;
+	// With L->Sub>1, every L->Sub-th pixel and row is taken.
+	s=L->Sub;
+	x1=(L->CurrentX+s-1)/s*s;
+	y1=(L->CurrentY+s-1)/s*s;
+	tw=Image.GetWidth();
 	map=Image.GetWritableMap();
-	for (y=L->CurrentY; y<y2; y++) {
-		src=((emUInt32*)L->Buffer)+(y2-1-y)*(size_t)L->PartW;
-		tgt=map+(y*(size_t)L->ImgW+L->CurrentX)*L->Channels;
+	for (y=y1; y<y2; y+=s) {
+		src=((emUInt32*)L->Buffer)+(y2-1-y)*(size_t)L->PartW+(x1-L->CurrentX);
+		tgt=map+((y/s)*(size_t)tw+x1/s)*L->Channels;
 		switch (L->Channels) {
 		case 1:
-			for (x=L->CurrentX; x<x2; x++) {
+			for (x=x1; x<x2; x+=s) {
 				pix=src[0];
 				tgt[0]=(unsigned char)(
 					(((int)TIFFGetR(pix))+TIFFGetG(pix)+TIFFGetB(pix))/3
 				);
-				src++;
+				src+=s;
 				tgt++;
 			}
 			break;
 		case 2:
-			for (x=L->CurrentX; x<x2; x++) {
+			for (x=x1; x<x2; x+=s) {
 				pix=src[0];
 				tgt[0]=(unsigned char)(
 					(((int)TIFFGetR(pix))+TIFFGetG(pix)+TIFFGetB(pix))/3
 				);
 				tgt[1]=(unsigned char)TIFFGetA(pix);
-				src++;
+				src+=s;
 				tgt+=2;
 			}
 			break;
 		case 3:
-			for (x=L->CurrentX; x<x2; x++) {
+			for (x=x1; x<x2; x+=s) {
 				pix=src[0];
 				tgt[0]=(unsigned char)TIFFGetR(pix);
 				tgt[1]=(unsigned char)TIFFGetG(pix);
 				tgt[2]=(unsigned char)TIFFGetB(pix);
-				src++;
+				src+=s;
 				tgt+=3;
 			}
 			break;
 		case 4:
-			for (x=L->CurrentX; x<x2; x++) {
+			for (x=x1; x<x2; x+=s) {
 				pix=src[0];
 				tgt[0]=(unsigned char)TIFFGetR(pix);
 				tgt[1]=(unsigned char)TIFFGetG(pix);
 				tgt[2]=(unsigned char)TIFFGetB(pix);
 				tgt[3]=(unsigned char)TIFFGetA(pix);
-				src++;
+				src+=s;
 				tgt+=4;
 			}
 			break;
@@ -316,7 +362,8 @@ emUInt64 emTiffImageFileModel::CalcMemoryNeed()
 	if (L) {
 		return
 			((emUInt64)L->PartW)*L->PartH*4 +
-			((emUInt64)L->ImgW)*L->ImgH*L->Channels
+			((emUInt64)(L->ImgW+L->Sub-1)/L->Sub)*
+			((L->ImgH+L->Sub-1)/L->Sub)*L->Channels
 		;
 	}
 	else {
@@ -345,6 +392,18 @@ double emTiffImageFileModel::CalcFileProgress()
 }
 
 
+void emTiffImageFileModel::PrepareTiffCall()
+{
+	emTiff_ErrorMutex.Lock();
+	if (emTiff_ErrorThread==emThread::GetCurrentThreadId()) {
+		strcpy(emTiff_Error,"unknown TIFF error");
+	}
+	TIFFSetErrorHandler(emTiff_ErrorHandler);
+	TIFFSetWarningHandler(emTiff_WarningHandler);
+	emTiff_ErrorMutex.Unlock();
+}
+
+
 void emTiffImageFileModel::ThrowTiffError()
 {
 	emString str;
@@ -355,3 +414,18 @@ void emTiffImageFileModel::ThrowTiffError()
 	emTiff_ErrorMutex.Unlock();
 	throw emException("%s",str.Get());
 }
+
+
+emString emTiffImageFileModel::GetCompressionName(int compression)
+{
+	switch (compression) {
+	case 1: return "uncompressed";
+	case 2: return "CCITT RLE compressed";
+	case 3: return "CCITT Group 3 compressed";
+	case 4: return "CCITT Group 4 compressed";
+	case 5: return "LZW compressed";
+	case 7: return "JPEG compressed";
+	case 32773: return "PackBits compressed";
+	default: return emString::Format("compression=%d",compression);
+	}
+}
@@ -0,0 +1,748 @@
+//------------------------------------------------------------------------------
+// emTiffTiledImageFileModel.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <tiffio.h>
+#include <emTiff/emTiffTiledImageFileModel.h>
+#include <emTiff/emTiffImageFileModel.h>
+
+
+emRef<emTiffTiledImageFileModel> emTiffTiledImageFileModel::Acquire(
+	emContext & context, const emString & name, bool common
+)
+{
+	EM_IMPL_ACQUIRE(emTiffTiledImageFileModel,context,name,common)
+}
+
+
+bool emTiffTiledImageFileModel::IsSuitableFile(const emString & filePath)
+{
+	Level level;
+
+	return
+		SniffFirstLevel(filePath,&level) &&
+		((emUInt64)level.Width)*level.Height>=MIN_PIXELS &&
+		((emUInt64)level.PartW)*level.PartH<=MAX_PART_PIXELS
+	;
+}
+
+
+int emTiffTiledImageFileModel::GetTileColumns(int level, int reduction) const
+{
+	const Level & l=Levels[level];
+	emInt64 n;
+
+	n=((emInt64)l.PartW)*reduction;
+	return (int)((l.Width+n-1)/n);
+}
+
+
+int emTiffTiledImageFileModel::GetTileRows(int level, int reduction) const
+{
+	const Level & l=Levels[level];
+	emInt64 n;
+
+	n=((emInt64)l.PartH)*reduction;
+	return (int)((l.Height+n-1)/n);
+}
+
+
+void emTiffTiledImageFileModel::GetTileRect(
+	emUInt64 tileKey, int * pX1, int * pY1, int * pX2, int * pY2
+) const
+{
+	const Level & l=Levels[GetTileKeyLevel(tileKey)];
+	emInt64 w,h,x,y;
+	int r;
+
+	r=GetTileKeyReduction(tileKey);
+	w=((emInt64)l.PartW)*r;
+	h=((emInt64)l.PartH)*r;
+	x=GetTileKeyColumn(tileKey)*w;
+	y=GetTileKeyRow(tileKey)*h;
+	*pX1=(int)emMin(x,(emInt64)l.Width);
+	*pY1=(int)emMin(y,(emInt64)l.Height);
+	*pX2=(int)emMin(x+w,(emInt64)l.Width);
+	*pY2=(int)emMin(y+h,(emInt64)l.Height);
+}
+
+
+void emTiffTiledImageFileModel::SetWantedTiles(
+	const void * viewer, const emArray<emUInt64> & tileKeys
+)
+{
+	CacheEntry * e;
+	int i,j;
+
+	for (i=Viewers.GetCount()-1; i>=0; i--) {
+		if (Viewers[i].Ptr==viewer) break;
+	}
+	if (tileKeys.IsEmpty()) {
+		if (i>=0) Viewers.Remove(i);
+	}
+	else {
+		if (i<0) {
+			i=Viewers.GetCount();
+			Viewers.AddNew();
+			Viewers.GetWritable(i).Ptr=viewer;
+		}
+		Viewers.GetWritable(i).TileKeys=tileKeys;
+		for (i=tileKeys.GetCount()-1; i>=0; i--) {
+			e=Cache.GetValueWritable(tileKeys[i],false);
+			if (e) {
+				UnlinkLru(e);
+				LinkLru(tileKeys[i],e);
+			}
+		}
+	}
+
+	WantedSorted.Clear();
+	for (i=0; i<Viewers.GetCount(); i++) {
+		for (j=0; j<Viewers[i].TileKeys.GetCount(); j++) {
+			WantedSorted.Add(Viewers[i].TileKeys[j]);
+		}
+	}
+	WantedSorted.Sort(emStdComparer<emUInt64>::Compare);
+
+	WantedChanged=true;
+	WakeUp();
+}
+
+
+emTiffTiledImageFileModel::emTiffTiledImageFileModel(
+	emContext & context, const emString & name
+)
+	: emFileModel(context,name)
+{
+	CoreConfig=emCoreConfig::Acquire(GetRootContext());
+	Channels=0;
+	CacheSize=0;
+	LruFirst=NO_TILE;
+	LruLast=NO_TILE;
+	WantedSorted.SetTuningLevel(4);
+	WantedChanged=false;
+	L=NULL;
+	TileTif=NULL;
+	TileTifLevel=-1;
+	D=NULL;
+}
+
+
+emTiffTiledImageFileModel::~emTiffTiledImageFileModel()
+{
+	emTiffTiledImageFileModel::QuitLoading();
+	emTiffTiledImageFileModel::QuitSaving();
+	CloseTileTif();
+}
+
+
+bool emTiffTiledImageFileModel::Cycle()
+{
+	bool busy;
+
+	busy=emFileModel::Cycle();
+	if (DecodeTiles()) busy=true;
+	return busy;
+}
+
+
+void emTiffTiledImageFileModel::ResetData()
+{
+	CloseTileTif();
+	FileFormatInfo.Clear();
+	Comment.Clear();
+	Channels=0;
+	Levels.Clear();
+	if (!Cache.IsEmpty()) {
+		Cache.Clear();
+		CacheSize=0;
+		LruFirst=NO_TILE;
+		LruLast=NO_TILE;
+		Signal(TileSignal);
+	}
+}
+
+
+void emTiffTiledImageFileModel::TryStartLoading()
+{
+	int samplesPerPixel,bitsPerSample,compression,photometric;
+	char * imageDesc;
+	emUInt64 * offsets;
+	emUInt16 u16;
+	Level level;
+	TIFF * t;
+	int i;
+
+	L=new LoadingState;
+	L->Tif=NULL;
+	L->NextSubIfd=0;
+	L->NextDir=1;
+
+	emTiffImageFileModel::PrepareTiffCall();
+
+	t=TIFFOpen(GetFilePath(),"r");
+	if (!t) emTiffImageFileModel::ThrowTiffError();
+	L->Tif=t;
+
+	if (!ReadLevel(t,&level)) {
+		throw emException("Unsupported TIFF file format.");
+	}
+	Levels.Add(level);
+
+	TIFFGetFieldDefaulted(t,TIFFTAG_SAMPLESPERPIXEL,&u16);
+	samplesPerPixel=u16;
+	TIFFGetFieldDefaulted(t,TIFFTAG_COMPRESSION,&u16);
+	compression=u16;
+	TIFFGetFieldDefaulted(t,TIFFTAG_PHOTOMETRIC,&u16);
+	photometric=u16;
+	TIFFGetFieldDefaulted(t,TIFFTAG_BITSPERSAMPLE,&u16);
+	bitsPerSample=u16;
+
+	if (samplesPerPixel==1) Channels=(photometric==3 ? 3 : 1);
+	else if (samplesPerPixel==2) Channels=2;
+	else if (samplesPerPixel==3) Channels=3;
+	else Channels=4;
+
+	FileFormatInfo=emString::Format(
+		"TIFF %d-bit %s %s (%d channels extracted)",
+		samplesPerPixel*bitsPerSample,
+		emTiffImageFileModel::GetCompressionName(compression).Get(),
+		level.Tiled ? "tiled" : "stripped",
+		Channels
+	);
+
+	imageDesc=NULL;
+	if (TIFFGetField(t,TIFFTAG_IMAGEDESCRIPTION,&imageDesc)==1 && imageDesc) {
+		Comment=imageDesc;
+	}
+
+	offsets=NULL;
+	if (TIFFGetField(t,TIFFTAG_SUBIFD,&u16,&offsets)==1 && offsets) {
+		for (i=0; i<u16 && i<MAX_DIRS; i++) L->SubIfdOffsets.Add(offsets[i]);
+	}
+}
+
+
+bool emTiffTiledImageFileModel::TryContinueLoading()
+{
+	Level level;
+	emUInt32 u32;
+	TIFF * t;
+	bool ok;
+	int i;
+
+	t=(TIFF*)L->Tif;
+
+	if (L->NextSubIfd<L->SubIfdOffsets.GetCount()) {
+		ok=TIFFSetSubDirectory(t,L->SubIfdOffsets[L->NextSubIfd])!=0;
+		L->NextSubIfd++;
+	}
+	else if (L->NextDir<MAX_DIRS && TIFFSetDirectory(t,L->NextDir)) {
+		ok=
+			TIFFGetField(t,TIFFTAG_SUBFILETYPE,&u32)==1 &&
+			(u32&FILETYPE_REDUCEDIMAGE)!=0
+		;
+		L->NextDir++;
+	}
+	else {
+		Levels.Sort(CmpLevels);
+		for (i=Levels.GetCount()-1; i>0; i--) {
+			if (Levels[i].Width==Levels[i-1].Width) Levels.Remove(i);
+		}
+		return true;
+	}
+
+	if (
+		ok && ReadLevel(t,&level) &&
+		level.Width<Levels[0].Width && level.Height<Levels[0].Height &&
+		fabs(
+			((double)level.Width)/Levels[0].Width-
+			((double)level.Height)/Levels[0].Height
+		)<0.02 &&
+		((emUInt64)level.PartW)*level.PartH<=MAX_PART_PIXELS
+	) {
+		Levels.Add(level);
+	}
+	return false;
+}
+
+
+void emTiffTiledImageFileModel::QuitLoading()
+{
+	if (L) {
+		if (L->Tif) TIFFClose((TIFF*)L->Tif);
+		delete L;
+		L=NULL;
+	}
+}
+
+
+void emTiffTiledImageFileModel::TryStartSaving()
+{
+	throw emException("emTiffTiledImageFileModel: Saving not implemented.");
+}
+
+
+bool emTiffTiledImageFileModel::TryContinueSaving()
+{
+	return true;
+}
+
+
+void emTiffTiledImageFileModel::QuitSaving()
+{
+}
+
+
+emUInt64 emTiffTiledImageFileModel::CalcMemoryNeed()
+{
+	// The tile cache is not counted here, because it is bounded
+	// separately.
+	return
+		sizeof(Level)*(emUInt64)Levels.GetCount()+
+		FileFormatInfo.GetLen()+Comment.GetLen()+1
+	;
+}
+
+
+double emTiffTiledImageFileModel::CalcFileProgress()
+{
+	if (!L) return 0.0;
+	return 100.0*(L->NextSubIfd+L->NextDir)/(L->SubIfdOffsets.GetCount()+8);
+}
+
+
+bool emTiffTiledImageFileModel::ReadLevel(void * tif, Level * level)
+{
+	TIFF * t;
+	emUInt32 u32;
+
+	t=(TIFF*)tif;
+	level->DirOffset=TIFFCurrentDirOffset(t);
+	if (!TIFFGetField(t,TIFFTAG_IMAGEWIDTH,&u32)) return false;
+	level->Width=(int)u32;
+	if (!TIFFGetField(t,TIFFTAG_IMAGELENGTH,&u32)) return false;
+	level->Height=(int)u32;
+	level->Tiled=TIFFIsTiled(t)!=0;
+	if (level->Tiled) {
+		TIFFGetFieldDefaulted(t,TIFFTAG_TILEWIDTH,&u32);
+		level->PartW=(int)u32;
+		TIFFGetFieldDefaulted(t,TIFFTAG_TILELENGTH,&u32);
+		level->PartH=(int)u32;
+	}
+	else {
+		level->PartW=level->Width;
+		TIFFGetFieldDefaulted(t,TIFFTAG_ROWSPERSTRIP,&u32);
+		level->PartH=(int)emMin(u32,(emUInt32)level->Height);
+	}
+	return
+		level->PartW>=1 && level->PartH>=1 &&
+		level->Width>=1 && level->Height>=1 &&
+		level->Width<=0x7fffff && level->Height<=0x7fffff
+	;
+}
+
+
+static emUInt64 GetTiffUInt(const unsigned char * p, int n, bool bigEndian)
+{
+	emUInt64 v;
+	int i;
+
+	v=0;
+	for (i=0; i<n; i++) v=(v<<8)|p[bigEndian ? i : n-1-i];
+	return v;
+}
+
+
+bool emTiffTiledImageFileModel::SniffFirstLevel(
+	const emString & filePath, Level * level
+)
+{
+	// Reads just the fields of the first IFD which are needed here.
+	// Tags with unusual types or counts make the file unsuitable.
+	unsigned char buf[20];
+	emUInt64 ifdOffset,entryCount,i,v;
+	int entrySize,countSize;
+	bool bigEndian,bigTiff;
+	unsigned tag,type;
+	FILE * f;
+
+	memset(level,0,sizeof(Level));
+	level->PartH=0x7fffffff;
+
+	f=fopen(filePath.Get(),"rb");
+	if (!f) return false;
+	if (fread(buf,1,16,f)!=16) goto L_Fail;
+	if (buf[0]=='M' && buf[1]=='M') bigEndian=true;
+	else if (buf[0]=='I' && buf[1]=='I') bigEndian=false;
+	else goto L_Fail;
+	v=GetTiffUInt(buf+2,2,bigEndian);
+	if (v==42) {
+		bigTiff=false;
+		ifdOffset=GetTiffUInt(buf+4,4,bigEndian);
+		countSize=2;
+		entrySize=12;
+	}
+	else if (v==43) {
+		bigTiff=true;
+		ifdOffset=GetTiffUInt(buf+8,8,bigEndian);
+		countSize=8;
+		entrySize=20;
+	}
+	else goto L_Fail;
+
+#if defined(_WIN32)
+	if (_fseeki64(f,(__int64)ifdOffset,SEEK_SET)!=0) goto L_Fail;
+#else
+	if (fseeko(f,(off_t)ifdOffset,SEEK_SET)!=0) goto L_Fail;
+#endif
+	if (fread(buf,1,countSize,f)!=(size_t)countSize) goto L_Fail;
+	entryCount=GetTiffUInt(buf,countSize,bigEndian);
+	if (entryCount>1000) goto L_Fail;
+	for (i=0; i<entryCount; i++) {
+		if (fread(buf,1,entrySize,f)!=(size_t)entrySize) goto L_Fail;
+		tag=(unsigned)GetTiffUInt(buf,2,bigEndian);
+		type=(unsigned)GetTiffUInt(buf+2,2,bigEndian);
+		if (
+			tag!=256 && tag!=257 && tag!=278 && tag!=322 && tag!=323
+		) continue;
+		// SHORT, LONG or LONG8 with the value inline.
+		if (type==3) v=GetTiffUInt(buf+(bigTiff?12:8),2,bigEndian);
+		else if (type==4) v=GetTiffUInt(buf+(bigTiff?12:8),4,bigEndian);
+		else if (type==16 && bigTiff) v=GetTiffUInt(buf+12,8,bigEndian);
+		else goto L_Fail;
+		if (v>0x7fffffff) v=0x7fffffff;
+		switch (tag) {
+		case 256: level->Width=(int)v; break;
+		case 257: level->Height=(int)v; break;
+		case 278: level->PartH=(int)v; break;
+		case 322: level->PartW=(int)v; level->Tiled=true; break;
+		case 323: level->PartH=(int)v; level->Tiled=true; break;
+		}
+	}
+	fclose(f);
+
+	level->DirOffset=ifdOffset;
+	if (!level->Tiled) {
+		level->PartW=level->Width;
+		level->PartH=emMin(level->PartH,level->Height);
+	}
+	return
+		level->PartW>=1 && level->PartH>=1 &&
+		level->Width>=1 && level->Height>=1 &&
+		level->Width<=0x7fffff && level->Height<=0x7fffff
+	;
+
+L_Fail:
+	fclose(f);
+	return false;
+}
+
+
+void emTiffTiledImageFileModel::LinkLru(emUInt64 tileKey, CacheEntry * e)
+{
+	e->Prev=NO_TILE;
+	e->Next=LruFirst;
+	if (LruFirst!=NO_TILE) Cache.GetValueWritable(LruFirst,false)->Prev=tileKey;
+	else LruLast=tileKey;
+	LruFirst=tileKey;
+}
+
+
+void emTiffTiledImageFileModel::UnlinkLru(CacheEntry * e)
+{
+	if (e->Prev!=NO_TILE) Cache.GetValueWritable(e->Prev,false)->Next=e->Next;
+	else LruFirst=e->Next;
+	if (e->Next!=NO_TILE) Cache.GetValueWritable(e->Next,false)->Prev=e->Prev;
+	else LruLast=e->Prev;
+	e->Prev=NO_TILE;
+	e->Next=NO_TILE;
+}
+
+
+bool emTiffTiledImageFileModel::IsTileWanted(emUInt64 tileKey) const
+{
+	return WantedSorted.BinarySearch(
+		tileKey,emStdComparer<emUInt64>::Compare
+	)>=0;
+}
+
+
+bool emTiffTiledImageFileModel::FindWantedTile(emUInt64 * pTileKey) const
+{
+	int i,j;
+
+	for (i=0; i<Viewers.GetCount(); i++) {
+		const emArray<emUInt64> & keys=Viewers[i].TileKeys;
+		for (j=0; j<keys.GetCount(); j++) {
+			if (!Cache.Contains(keys[j])) {
+				*pTileKey=keys[j];
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+bool emTiffTiledImageFileModel::DecodeTiles()
+{
+	emUInt64 tileKey;
+	bool added;
+
+	if (GetFileState()!=FS_LOADED) {
+		CloseTileTif();
+		return false;
+	}
+
+	if (D && WantedChanged && !IsTileWanted(D->TileKey)) {
+		delete D;
+		D=NULL;
+	}
+	WantedChanged=false;
+
+	added=false;
+	for (;;) {
+		if (!D) {
+			if (!FindWantedTile(&tileKey)) break;
+			StartDecoding(tileKey);
+		}
+		try {
+			ContinueDecoding();
+		}
+		catch (const emException &) {
+			AddToCache(D->TileKey,emImage());
+			delete D;
+			D=NULL;
+			added=true;
+		}
+		if (D && D->PartY>=D->Y2) {
+			FinishDecoding();
+			added=true;
+		}
+		if (IsTimeSliceAtEnd()) break;
+	}
+
+	if (added) Signal(TileSignal);
+	return D!=NULL || FindWantedTile(&tileKey);
+}
+
+
+void emTiffTiledImageFileModel::StartDecoding(emUInt64 tileKey)
+{
+	const Level * l;
+
+	D=new DecodingState;
+	D->TileKey=tileKey;
+	D->Level=GetTileKeyLevel(tileKey);
+	D->Reduction=GetTileKeyReduction(tileKey);
+	GetTileRect(tileKey,&D->X1,&D->Y1,&D->X2,&D->Y2);
+	D->OutW=(D->X2-D->X1+D->Reduction-1)/D->Reduction;
+	D->OutH=(D->Y2-D->Y1+D->Reduction-1)/D->Reduction;
+	D->PartX=D->X1;
+	D->PartY=D->Y1;
+	l=&Levels[D->Level];
+	D->Sums.SetTuningLevel(4);
+	D->Sums.SetCount(D->OutW*D->OutH*Channels);
+	memset(D->Sums.GetWritable(),0,D->Sums.GetCount()*sizeof(emUInt32));
+	D->Buffer.SetTuningLevel(4);
+	D->Buffer.SetCount(l->PartW*l->PartH);
+}
+
+
+void emTiffTiledImageFileModel::ContinueDecoding()
+{
+	const Level * l;
+	const emUInt32 * src;
+	emUInt32 * buf, * sums, * tgt;
+	emUInt32 pix;
+	TIFF * t;
+	int x,y,x2,y2,r,rows,ok;
+
+	l=&Levels[D->Level];
+
+	emTiffImageFileModel::PrepareTiffCall();
+
+	if (!TileTif) {
+		TileTif=TIFFOpen(GetFilePath(),"r");
+		if (!TileTif) emTiffImageFileModel::ThrowTiffError();
+		TileTifLevel=-1;
+	}
+	t=(TIFF*)TileTif;
+	if (TileTifLevel!=D->Level) {
+		TileTifLevel=-1;
+		if (!TIFFSetSubDirectory(t,l->DirOffset)) {
+			emTiffImageFileModel::ThrowTiffError();
+		}
+		TileTifLevel=D->Level;
+	}
+
+	buf=D->Buffer.GetWritable();
+	if (l->Tiled) {
+		ok=TIFFReadRGBATile(t,D->PartX,D->PartY,buf);
+	}
+	else {
+		ok=TIFFReadRGBAStrip(t,D->PartY,buf);
+	}
+	if (!ok) emTiffImageFileModel::ThrowTiffError();
+
+	// The buffer has its origin at the lower-left. A tile is always
+	// filled up to the full tile size, a strip has only the rows which
+	// exist in the image.
+	x2=emMin(D->PartX+l->PartW,D->X2);
+	y2=emMin(D->PartY+l->PartH,D->Y2);
+	rows=l->Tiled ? l->PartH : y2-D->PartY;
+	r=D->Reduction;
+	sums=D->Sums.GetWritable();
+	for (y=D->PartY; y<y2; y++) {
+		src=buf+(rows-1-(y-D->PartY))*(size_t)l->PartW;
+		tgt=sums+((y-D->Y1)/r)*(size_t)D->OutW*Channels;
+		for (x=D->PartX; x<x2; x++) {
+			pix=src[x-D->PartX];
+			switch (Channels) {
+			case 1:
+				tgt[(x-D->X1)/r]+=
+					(TIFFGetR(pix)+TIFFGetG(pix)+TIFFGetB(pix))/3;
+				break;
+			case 2:
+				tgt[(x-D->X1)/r*2]+=
+					(TIFFGetR(pix)+TIFFGetG(pix)+TIFFGetB(pix))/3;
+				tgt[(x-D->X1)/r*2+1]+=TIFFGetA(pix);
+				break;
+			case 3:
+				tgt[(x-D->X1)/r*3]+=TIFFGetR(pix);
+				tgt[(x-D->X1)/r*3+1]+=TIFFGetG(pix);
+				tgt[(x-D->X1)/r*3+2]+=TIFFGetB(pix);
+				break;
+			default:
+				tgt[(x-D->X1)/r*4]+=TIFFGetR(pix);
+				tgt[(x-D->X1)/r*4+1]+=TIFFGetG(pix);
+				tgt[(x-D->X1)/r*4+2]+=TIFFGetB(pix);
+				tgt[(x-D->X1)/r*4+3]+=TIFFGetA(pix);
+				break;
+			}
+		}
+	}
+
+	D->PartX+=l->PartW;
+	if (D->PartX>=D->X2) {
+		D->PartX=D->X1;
+		D->PartY+=l->PartH;
+	}
+}
+
+
+void emTiffTiledImageFileModel::FinishDecoding()
+{
+	emImage image;
+	const emUInt32 * sums;
+	emByte * map;
+	emUInt32 cnt;
+	int x,y,c,r,cw,ch;
+
+	r=D->Reduction;
+	image.Setup(D->OutW,D->OutH,Channels);
+	map=image.GetWritableMap();
+	sums=D->Sums.Get();
+	for (y=0; y<D->OutH; y++) {
+		ch=emMin(r,D->Y2-D->Y1-y*r);
+		for (x=0; x<D->OutW; x++) {
+			cw=emMin(r,D->X2-D->X1-x*r);
+			cnt=(emUInt32)(cw*ch);
+			for (c=0; c<Channels; c++) {
+				*map++=(emByte)((*sums++ + cnt/2)/cnt);
+			}
+		}
+	}
+	AddToCache(D->TileKey,image);
+	delete D;
+	D=NULL;
+}
+
+
+void emTiffTiledImageFileModel::AddToCache(
+	emUInt64 tileKey, const emImage & image
+)
+{
+	emUInt64 limit,key,prev;
+	CacheEntry * e;
+
+	e=Cache.GetValueWritable(tileKey,false);
+	if (e) {
+		CacheSize-=CalcImageSize(e->Image);
+		UnlinkLru(e);
+	}
+	else {
+		e=Cache.GetValueWritable(tileKey,true);
+	}
+	e->Image=image;
+	LinkLru(tileKey,e);
+	CacheSize+=CalcImageSize(image);
+
+	// Drop least recently used tiles, but not the wanted ones. These
+	// are near the front of the list, because SetWantedTiles moves
+	// them there.
+	limit=(emUInt64)(CoreConfig->MaxMegabytesPerView*1000000.0);
+	key=LruLast;
+	while (CacheSize>limit && key!=NO_TILE) {
+		e=Cache.GetValueWritable(key,false);
+		prev=e->Prev;
+		if (!IsTileWanted(key)) {
+			CacheSize-=CalcImageSize(e->Image);
+			UnlinkLru(e);
+			Cache.Remove(key);
+		}
+		key=prev;
+	}
+}
+
+
+emUInt64 emTiffTiledImageFileModel::CalcImageSize(const emImage & image)
+{
+	return
+		((emUInt64)image.GetWidth())*image.GetHeight()*
+		image.GetChannelCount()+sizeof(CacheEntry)
+	;
+}
+
+
+void emTiffTiledImageFileModel::CloseTileTif()
+{
+	if (D) {
+		delete D;
+		D=NULL;
+	}
+	if (TileTif) {
+		TIFFClose((TIFF*)TileTif);
+		TileTif=NULL;
+		TileTifLevel=-1;
+	}
+}
+
+
+const emUInt64 emTiffTiledImageFileModel::NO_TILE=~(emUInt64)0;
+
+
+int emTiffTiledImageFileModel::CmpLevels(
+	const Level * l1, const Level * l2, void * context
+)
+{
+	return l2->Width-l1->Width;
+}
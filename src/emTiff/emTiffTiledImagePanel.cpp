@@ -0,0 +1,528 @@
+//------------------------------------------------------------------------------
+// emTiffTiledImagePanel.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emTiff/emTiffTiledImagePanel.h>
+#include <emCore/emLinearLayout.h>
+#include <emCore/emLinearGroup.h>
+#include <emCore/emTextField.h>
+
+
+emTiffTiledImagePanel::emTiffTiledImagePanel(
+	ParentArg parent, const emString & name,
+	emTiffTiledImageFileModel * fileModel, bool updateFileModel
+)
+	: emFilePanel(parent,name)
+{
+	CenterX=0.0;
+	CenterY=0.0;
+	AddWakeUpSignal(GetVirFileStateSignal());
+	SetFileModel(fileModel,updateFileModel);
+}
+
+
+emTiffTiledImagePanel::~emTiffTiledImagePanel()
+{
+	if (GetFileModel()) {
+		((emTiffTiledImageFileModel*)GetFileModel())->SetWantedTiles(
+			this,emArray<emUInt64>()
+		);
+	}
+}
+
+
+void emTiffTiledImagePanel::SetFileModel(
+	emFileModel * fileModel, bool updateFileModel
+)
+{
+	if (fileModel && (dynamic_cast<emTiffTiledImageFileModel*>(fileModel))==NULL) {
+		fileModel=NULL;
+	}
+
+	if (GetFileModel()) {
+		RemoveWakeUpSignal(
+			((const emTiffTiledImageFileModel*)GetFileModel())->GetTileSignal()
+		);
+		((emTiffTiledImageFileModel*)GetFileModel())->SetWantedTiles(
+			this,emArray<emUInt64>()
+		);
+	}
+
+	WantedTiles.Clear();
+	PreviewTiles.Clear();
+	SubstituteLevels.Clear();
+
+	emFilePanel::SetFileModel(fileModel,updateFileModel);
+
+	if (GetFileModel()) {
+		AddWakeUpSignal(
+			((const emTiffTiledImageFileModel*)GetFileModel())->GetTileSignal()
+		);
+		UpdateWantedTiles();
+	}
+}
+
+
+emString emTiffTiledImagePanel::GetIconFileName() const
+{
+	return "picture.tga";
+}
+
+
+void emTiffTiledImagePanel::GetEssenceRect(
+	double * pX, double * pY, double * pW, double * pH
+) const
+{
+	if (!GetImageRect(pX,pY,pW,pH)) {
+		emFilePanel::GetEssenceRect(pX,pY,pW,pH);
+	}
+}
+
+
+bool emTiffTiledImagePanel::Cycle()
+{
+	if (GetFileModel()) {
+		if (IsSignaled(
+			((const emTiffTiledImageFileModel*)GetFileModel())->GetTileSignal()
+		)) {
+			InvalidatePainting();
+		}
+	}
+	if (IsSignaled(GetVirFileStateSignal())) {
+		UpdateWantedTiles();
+		InvalidateControlPanel(); //??? very cheap solution, but okay for now.
+	}
+	return emFilePanel::Cycle();
+}
+
+
+void emTiffTiledImagePanel::Notice(NoticeFlags flags)
+{
+	emFilePanel::Notice(flags);
+	if (flags&(NF_VIEWING_CHANGED|NF_LAYOUT_CHANGED)) {
+		UpdateWantedTiles();
+	}
+}
+
+
+bool emTiffTiledImagePanel::IsOpaque() const
+{
+	if (IsVFSGood()) {
+		return false;
+	}
+	else {
+		return emFilePanel::IsOpaque();
+	}
+}
+
+
+void emTiffTiledImagePanel::Paint(
+	const emPainter & painter, emColor canvasColor
+) const
+{
+	const emTiffTiledImageFileModel * fm;
+	const emImage * img;
+	double x,y,w,h;
+	int i;
+
+	if (!IsVFSGood()) {
+		emFilePanel::Paint(painter,canvasColor);
+		return;
+	}
+
+	if (!GetImageRect(&x,&y,&w,&h)) return;
+
+	fm=(const emTiffTiledImageFileModel*)GetFileModel();
+	for (i=0; i<WantedTiles.GetCount(); i++) {
+		img=fm->GetTile(WantedTiles[i]);
+		if (img) {
+			if (!img->IsEmpty()) {
+				PaintTile(painter,WantedTiles[i],*img,x,y,w,h,canvasColor);
+			}
+		}
+		else {
+			PaintSubstitute(painter,WantedTiles[i],x,y,w,h,canvasColor);
+		}
+	}
+}
+
+
+emPanel * emTiffTiledImagePanel::CreateControlPanel(
+	ParentArg parent, const emString & name
+)
+{
+	emTiffTiledImageFileModel * fm;
+	emLinearLayout * mainLayout;
+	emLinearGroup * grp;
+	emTextField * tf;
+	emString levels;
+	int i;
+
+	if (IsVFSGood()) {
+		fm=(emTiffTiledImageFileModel*)GetFileModel();
+		mainLayout=new emLinearLayout(parent,name);
+		mainLayout->SetMinChildTallness(0.03);
+		mainLayout->SetMaxChildTallness(0.6);
+		mainLayout->SetAlignment(EM_ALIGN_TOP_LEFT);
+		grp=new emLinearGroup(
+			mainLayout,
+			"",
+			"Image File Info"
+		);
+		grp->SetOrientationThresholdTallness(0.07);
+		new emTextField(
+			grp,
+			"format",
+			"File Format",
+			emString(),
+			emImage(),
+			fm->GetFileFormatInfo()
+		);
+		new emTextField(
+			grp,
+			"size",
+			"Size",
+			emString(),
+			emImage(),
+			emString::Format(
+				"%dx%d pixels",
+				fm->GetWidth(),
+				fm->GetHeight()
+			)
+		);
+		for (i=0; i<fm->GetLevelCount(); i++) {
+			if (i>0) levels+=", ";
+			levels+=emString::Format(
+				"%dx%d",
+				fm->GetLevelWidth(i),
+				fm->GetLevelHeight(i)
+			);
+		}
+		new emTextField(
+			grp,
+			"levels",
+			"Resolution Levels",
+			emString(),
+			emImage(),
+			levels
+		);
+		tf=new emTextField(
+			grp,
+			"comment",
+			"Comment",
+			emString(),
+			emImage(),
+			fm->GetComment()
+		);
+		tf->SetMultiLineMode();
+		return mainLayout;
+	}
+	else {
+		return emFilePanel::CreateControlPanel(parent,name);
+	}
+}
+
+
+bool emTiffTiledImagePanel::GetImageRect(
+	double * pX, double * pY, double * pW, double * pH
+) const
+{
+	const emTiffTiledImageFileModel * fm;
+	double x,y,w,h,d;
+	int iw,ih;
+
+	if (!IsVFSGood()) return false;
+	fm=(const emTiffTiledImageFileModel*)GetFileModel();
+	iw=fm->GetWidth();
+	ih=fm->GetHeight();
+	if (iw<=0 || ih<=0) return false;
+	x=0;
+	y=0;
+	w=1;
+	h=GetHeight();
+	if (iw*h>=ih*w) {
+		d=w*ih/iw;
+		y+=(h-d)/2;
+		h=d;
+	}
+	else {
+		d=h*iw/ih;
+		x+=(w-d)/2;
+		w=d;
+	}
+	*pX=x;
+	*pY=y;
+	*pW=w;
+	*pH=h;
+	return true;
+}
+
+
+void emTiffTiledImagePanel::UpdateWantedTiles()
+{
+	emTiffTiledImageFileModel * fm;
+	emArray<emUInt64> tiles;
+	double x,y,w,h,need,x1,y1,x2,y2,tw,th,s,s2,u1,v1,u2,v2;
+	int i,j,level,red,lw,lh,c1,r1,c2,r2,row,col;
+	emUInt64 key;
+
+	fm=(emTiffTiledImageFileModel*)GetFileModel();
+	if (!fm) return;
+
+	WantedTiles.Clear();
+	PreviewTiles.Clear();
+	SubstituteLevels.Clear();
+
+	if (
+		IsViewed() && GetImageRect(&x,&y,&w,&h) &&
+		fm->GetLevelCount()>0
+	) {
+		// Pick the coarsest level and the largest reduction which still
+		// provide at least one image pixel per screen pixel.
+		need=w*GetViewedWidth();
+		level=0;
+		for (i=fm->GetLevelCount()-1; i>0; i--) {
+			if (fm->GetLevelWidth(i)>=need) { level=i; break; }
+		}
+		lw=fm->GetLevelWidth(level);
+		lh=fm->GetLevelHeight(level);
+		red=1;
+		while (
+			red<emTiffTiledImageFileModel::MAX_REDUCTION &&
+			lw/(2.0*red)>=need
+		) red*=2;
+
+		x1=(ViewToPanelX(GetClipX1())-x)/w*lw;
+		y1=(ViewToPanelY(GetClipY1())-y)/h*lh;
+		x2=(ViewToPanelX(GetClipX2())-x)/w*lw;
+		y2=(ViewToPanelY(GetClipY2())-y)/h*lh;
+		CenterX=(x1+x2)*0.5;
+		CenterY=(y1+y2)*0.5;
+		tw=((double)fm->GetLevelPartWidth(level))*red;
+		th=((double)fm->GetLevelPartHeight(level))*red;
+		c1=(int)emMax(0.0,floor(x1/tw));
+		r1=(int)emMax(0.0,floor(y1/th));
+		c2=(int)emMin((double)fm->GetTileColumns(level,red),ceil(x2/tw));
+		r2=(int)emMin((double)fm->GetTileRows(level,red),ceil(y2/th));
+		for (row=r1; row<r2; row++) {
+			for (col=c1; col<c2; col++) {
+				WantedTiles.Add(
+					emTiffTiledImageFileModel::MakeTileKey(level,red,col,row)
+				);
+			}
+		}
+		WantedTiles.Sort(CmpTileDistances,this);
+		u1=c1*tw/lw;
+		v1=r1*th/lh;
+		u2=emMin(1.0,c2*tw/lw);
+		v2=emMin(1.0,r2*th/lh);
+
+		// Collect the coarser combinations, sorted by their scale
+		// (level-0 pixels per tile pixel).
+		s=((double)fm->GetWidth())/lw*red;
+		for (i=level; i<fm->GetLevelCount(); i++) {
+			for (
+				red=1;
+				red<=emTiffTiledImageFileModel::MAX_REDUCTION;
+				red*=2
+			) {
+				s2=((double)fm->GetWidth())/fm->GetLevelWidth(i)*red;
+				if (s2<=s*1.001) continue;
+				key=emTiffTiledImageFileModel::MakeTileKey(i,red,0,0);
+				for (j=SubstituteLevels.GetCount(); j>0; j--) {
+					if (
+						((double)fm->GetWidth())/
+						fm->GetLevelWidth(
+							emTiffTiledImageFileModel::GetTileKeyLevel(
+								SubstituteLevels[j-1]
+							)
+						)*
+						emTiffTiledImageFileModel::GetTileKeyReduction(
+							SubstituteLevels[j-1]
+						)<=s2
+					) break;
+				}
+				SubstituteLevels.Insert(j,key);
+				if (fm->GetLevelWidth(i)<red) break;
+			}
+		}
+
+		// Want the tiles of the first substitute with at least four
+		// times the scale (or of the coarsest one) before the others,
+		// so that there is soon something to be shown everywhere.
+		for (i=0; i<SubstituteLevels.GetCount()-1; i++) {
+			level=emTiffTiledImageFileModel::GetTileKeyLevel(
+				SubstituteLevels[i]
+			);
+			red=emTiffTiledImageFileModel::GetTileKeyReduction(
+				SubstituteLevels[i]
+			);
+			if (((double)fm->GetWidth())/fm->GetLevelWidth(level)*red>=s*4) {
+				break;
+			}
+		}
+		if (i<SubstituteLevels.GetCount()) {
+			level=emTiffTiledImageFileModel::GetTileKeyLevel(
+				SubstituteLevels[i]
+			);
+			red=emTiffTiledImageFileModel::GetTileKeyReduction(
+				SubstituteLevels[i]
+			);
+			lw=fm->GetLevelWidth(level);
+			lh=fm->GetLevelHeight(level);
+			tw=((double)fm->GetLevelPartWidth(level))*red;
+			th=((double)fm->GetLevelPartHeight(level))*red;
+			c1=(int)floor(u1*lw/tw);
+			r1=(int)floor(v1*lh/th);
+			c2=emMin((int)ceil(u2*lw/tw),fm->GetTileColumns(level,red));
+			r2=emMin((int)ceil(v2*lh/th),fm->GetTileRows(level,red));
+			for (row=r1; row<r2; row++) {
+				for (col=c1; col<c2; col++) {
+					PreviewTiles.Add(
+						emTiffTiledImageFileModel::MakeTileKey(
+							level,red,col,row
+						)
+					);
+				}
+			}
+		}
+	}
+
+	tiles=PreviewTiles;
+	tiles.Add(WantedTiles);
+	fm->SetWantedTiles(this,tiles);
+	InvalidatePainting();
+}
+
+
+void emTiffTiledImagePanel::PaintTile(
+	const emPainter & painter, emUInt64 tileKey, const emImage & image,
+	double imgX, double imgY, double imgW, double imgH,
+	emColor canvasColor
+) const
+{
+	const emTiffTiledImageFileModel * fm;
+	int level,x1,y1,x2,y2;
+	double lw,lh;
+
+	fm=(const emTiffTiledImageFileModel*)GetFileModel();
+	level=emTiffTiledImageFileModel::GetTileKeyLevel(tileKey);
+	lw=fm->GetLevelWidth(level);
+	lh=fm->GetLevelHeight(level);
+	fm->GetTileRect(tileKey,&x1,&y1,&x2,&y2);
+	painter.PaintImage(
+		imgX+imgW*x1/lw,
+		imgY+imgH*y1/lh,
+		imgW*(x2-x1)/lw,
+		imgH*(y2-y1)/lh,
+		image,
+		255,
+		canvasColor
+	);
+}
+
+
+bool emTiffTiledImagePanel::PaintSubstitute(
+	const emPainter & painter, emUInt64 tileKey,
+	double imgX, double imgY, double imgW, double imgH,
+	emColor canvasColor
+) const
+{
+	const emTiffTiledImageFileModel * fm;
+	const emImage * img;
+	double u1,v1,u2,v2,lw,lh,tw,th;
+	int i,level,red,x1,y1,x2,y2,c1,r1,c2,r2,col,row;
+
+	fm=(const emTiffTiledImageFileModel*)GetFileModel();
+	level=emTiffTiledImageFileModel::GetTileKeyLevel(tileKey);
+	fm->GetTileRect(tileKey,&x1,&y1,&x2,&y2);
+	u1=((double)x1)/fm->GetLevelWidth(level);
+	v1=((double)y1)/fm->GetLevelHeight(level);
+	u2=((double)x2)/fm->GetLevelWidth(level);
+	v2=((double)y2)/fm->GetLevelHeight(level);
+
+	for (i=0; i<SubstituteLevels.GetCount(); i++) {
+		level=emTiffTiledImageFileModel::GetTileKeyLevel(SubstituteLevels[i]);
+		red=emTiffTiledImageFileModel::GetTileKeyReduction(SubstituteLevels[i]);
+		lw=fm->GetLevelWidth(level);
+		lh=fm->GetLevelHeight(level);
+		tw=((double)fm->GetLevelPartWidth(level))*red;
+		th=((double)fm->GetLevelPartHeight(level))*red;
+		c1=(int)floor(u1*lw/tw);
+		r1=(int)floor(v1*lh/th);
+		c2=emMin((int)ceil(u2*lw/tw),fm->GetTileColumns(level,red));
+		r2=emMin((int)ceil(v2*lh/th),fm->GetTileRows(level,red));
+		for (row=r1; row<r2; row++) {
+			for (col=c1; col<c2; col++) {
+				img=fm->GetTile(
+					emTiffTiledImageFileModel::MakeTileKey(level,red,col,row)
+				);
+				if (!img || img->IsEmpty()) break;
+			}
+			if (col<c2) break;
+		}
+		if (row<r2) continue;
+
+		emPainter clipped(
+			painter,
+			painter.GetOriginX()+(imgX+imgW*u1)*painter.GetScaleX(),
+			painter.GetOriginY()+(imgY+imgH*v1)*painter.GetScaleY(),
+			painter.GetOriginX()+(imgX+imgW*u2)*painter.GetScaleX(),
+			painter.GetOriginY()+(imgY+imgH*v2)*painter.GetScaleY()
+		);
+		for (row=r1; row<r2; row++) {
+			for (col=c1; col<c2; col++) {
+				tileKey=emTiffTiledImageFileModel::MakeTileKey(
+					level,red,col,row
+				);
+				PaintTile(
+					clipped,tileKey,*fm->GetTile(tileKey),
+					imgX,imgY,imgW,imgH,canvasColor
+				);
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+
+int emTiffTiledImagePanel::CmpTileDistances(
+	const emUInt64 * key1, const emUInt64 * key2, void * context
+)
+{
+	const emTiffTiledImagePanel * p;
+	const emTiffTiledImageFileModel * fm;
+	int x1,y1,x2,y2;
+	double dx,dy,d1,d2;
+
+	p=(const emTiffTiledImagePanel*)context;
+	fm=(const emTiffTiledImageFileModel*)p->GetFileModel();
+	fm->GetTileRect(*key1,&x1,&y1,&x2,&y2);
+	dx=(x1+x2)*0.5-p->CenterX;
+	dy=(y1+y2)*0.5-p->CenterY;
+	d1=dx*dx+dy*dy;
+	fm->GetTileRect(*key2,&x1,&y1,&x2,&y2);
+	dx=(x1+x2)*0.5-p->CenterX;
+	dy=(y1+y2)*0.5-p->CenterY;
+	d2=dx*dx+dy*dy;
+	if (d1<d2) return -1;
+	if (d1>d2) return 1;
+	return 0;
+}
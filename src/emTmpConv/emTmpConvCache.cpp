@@ -0,0 +1,346 @@
+//------------------------------------------------------------------------------
+// emTmpConvCache.cpp
+//
+// Copyright (C) 2026 Oliver Hamann.
+//
+// Homepage: http://eaglemode.sourceforge.net/
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License version 3 as published by the
+// Free Software Foundation.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License version 3 for
+// more details.
+//
+// You should have received a copy of the GNU General Public License version 3
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <emTmpConv/emTmpConvCache.h>
+#include <emCore/emInstallInfo.h>
+#include <errno.h>
+#include <stdio.h>
+
+
+emRef<emTmpConvCache> emTmpConvCache::Acquire(emRootContext & rootContext)
+{
+	EM_IMPL_ACQUIRE_COMMON(emTmpConvCache,rootContext,"")
+}
+
+
+emString emTmpConvCache::MakeKey(
+	const emString & inputFilePath, emUInt64 fileSize, time_t fileTime,
+	const emString & command, const emString & outputFileEnding
+)
+{
+	return emString::Format(
+		"%d:%s,%llu,%lld,%d:%s,%d:%s",
+		inputFilePath.GetLen(),
+		inputFilePath.Get(),
+		(unsigned long long)fileSize,
+		(long long)fileTime,
+		command.GetLen(),
+		command.Get(),
+		outputFileEnding.GetLen(),
+		outputFileEnding.Get()
+	);
+}
+
+
+bool emTmpConvCache::TryFetch(const char * key, const char * targetPath)
+{
+	EntryInfo info;
+	emString entryPath;
+
+	entryPath=GetEntryPath(key);
+	if (!TryLoadInfo(entryPath,key,&info)) return false;
+
+	try {
+		emTryCopyFileOrTree(targetPath,emGetChildPath(entryPath,"data"));
+	}
+	catch (const emException &) {
+		// Maybe the entry has just been removed by another process.
+		try {
+			if (emIsExistingPath(targetPath)) {
+				emTryRemoveFileOrTree(targetPath,true);
+			}
+		}
+		catch (const emException &) {
+		}
+		return false;
+	}
+
+	try {
+		TrySaveInfo(entryPath,key,info.Size,time(NULL));
+	}
+	catch (const emException &) {
+	}
+
+	return true;
+}
+
+
+void emTmpConvCache::Store(const char * key, const char * sourcePath)
+{
+	emString entryPath,tmpPath;
+	EntryInfo oldInfo;
+	emUInt64 size,oldSize;
+	bool shrink;
+
+	if (!TryCalcSize(sourcePath,&size)) return;
+
+	entryPath=GetEntryPath(key);
+	tmpPath=emString::Format("%s.%d.tmp",entryPath.Get(),emGetProcessId());
+	oldSize=0;
+	if (TryLoadInfo(entryPath,NULL,&oldInfo)) oldSize=oldInfo.Size;
+
+	// The entry is prepared under a temporary name and renamed at the
+	// end, so that other processes never see a partial entry.
+	try {
+		if (emIsExistingPath(tmpPath)) emTryRemoveFileOrTree(tmpPath,true);
+		emTryMakeDirectories(tmpPath);
+		emTryCopyFileOrTree(emGetChildPath(tmpPath,"data"),sourcePath);
+		TrySaveInfo(tmpPath,key,size,time(NULL));
+		if (emIsExistingPath(entryPath)) emTryRemoveFileOrTree(entryPath,true);
+		if (rename(tmpPath.Get(),entryPath.Get())!=0) {
+			throw emException("%s",emGetErrorText(errno).Get());
+		}
+	}
+	catch (const emException &) {
+		try {
+			if (emIsExistingPath(tmpPath)) emTryRemoveFileOrTree(tmpPath,true);
+		}
+		catch (const emException &) {
+		}
+		return;
+	}
+
+	TotalMutex.Lock();
+	if (TotalKnown) {
+		Total+=size;
+		Total-=emMin(oldSize,Total);
+		shrink=(Total>((emUInt64)MAX_TOTAL_SIZE_MB)<<20);
+	}
+	else {
+		shrink=true;
+	}
+	TotalMutex.Unlock();
+
+	if (shrink) Shrink();
+}
+
+
+emTmpConvCache::Transfer::Transfer(
+	emTmpConvCache & cache, TypeEnum type, const emString & key,
+	const emString & path
+)
+	: Cache(cache),
+	Type(type),
+	Key(key.Get()),
+	Path(path.Get()),
+	Fetched(false)
+{
+	Start(NULL);
+}
+
+
+emTmpConvCache::Transfer::~Transfer()
+{
+	WaitForTermination();
+}
+
+
+int emTmpConvCache::Transfer::Run(void * arg)
+{
+	if (Type==FETCH) {
+		Fetched=Cache.TryFetch(Key,Path);
+	}
+	else {
+		Cache.Store(Key,Path);
+	}
+	return 0;
+}
+
+
+emTmpConvCache::emTmpConvCache(emContext & context, const emString & name)
+	: emModel(context,name)
+{
+	DirPath=emGetInstallPath(EM_IDT_USER_CONFIG,"emTmpConv","cache");
+	Total=0;
+	TotalKnown=false;
+	SetMinCommonLifetime(UINT_MAX);
+}
+
+
+emTmpConvCache::~emTmpConvCache()
+{
+}
+
+
+emString emTmpConvCache::GetEntryPath(const char * key) const
+{
+	return emGetChildPath(DirPath,emCalcHashName(key,strlen(key),32));
+}
+
+
+bool emTmpConvCache::TryLoadInfo(
+	const emString & entryPath, const char * key, EntryInfo * info
+)
+{
+	static const char * const magic="emTmpConvCache\n";
+	emArray<char> buf;
+	unsigned long long size;
+	long long lastUse;
+	const char * p, * e;
+	int magicLen,keyLen;
+
+	try {
+		buf=emTryLoadFile(emGetChildPath(entryPath,"info"));
+	}
+	catch (const emException &) {
+		return false;
+	}
+	buf.Add('\0');
+	p=buf.Get();
+	magicLen=strlen(magic);
+	if (strncmp(p,magic,magicLen)!=0) return false;
+	p+=magicLen;
+	e=strchr(p,'\n');
+	if (!e) return false;
+	if (sscanf(p,"%llu %lld",&size,&lastUse)!=2) return false;
+	p=e+1;
+	if (key) {
+		keyLen=strlen(key);
+		if (
+			buf.GetCount()-1-(p-buf.Get())!=keyLen ||
+			memcmp(p,key,keyLen)!=0
+		) return false;
+	}
+	info->Path=entryPath;
+	info->Size=(emUInt64)size;
+	info->LastUse=(time_t)lastUse;
+	return true;
+}
+
+
+void emTmpConvCache::TrySaveInfo(
+	const emString & entryPath, const char * key, emUInt64 size,
+	time_t lastUse
+)
+{
+	emString str;
+
+	str=emString::Format(
+		"emTmpConvCache\n%llu %lld\n",
+		(unsigned long long)size,
+		(long long)lastUse
+	);
+	str+=key;
+	emTrySaveFile(emGetChildPath(entryPath,"info"),str.Get(),str.GetLen());
+}
+
+
+bool emTmpConvCache::TryCalcSize(const emString & path, emUInt64 * size)
+{
+	emArray<emString> names;
+	emUInt64 s;
+	int i;
+
+	// Symbolic links are not cached, because they could point to
+	// anywhere, and because emTryCopyFileOrTree would follow them.
+	if (emIsSymLinkPath(path)) return false;
+
+	if (!emIsDirectory(path)) {
+		try {
+			*size=emTryGetFileSize(path);
+		}
+		catch (const emException &) {
+			return false;
+		}
+		return *size<=((emUInt64)MAX_ENTRY_SIZE_MB)<<20;
+	}
+
+	try {
+		names=emTryLoadDir(path);
+	}
+	catch (const emException &) {
+		return false;
+	}
+	*size=0;
+	for (i=0; i<names.GetCount(); i++) {
+		if (!TryCalcSize(emGetChildPath(path,names[i]),&s)) return false;
+		*size+=s;
+		if (*size>((emUInt64)MAX_ENTRY_SIZE_MB)<<20) return false;
+	}
+	return true;
+}
+
+
+void emTmpConvCache::Shrink()
+{
+	emArray<EntryInfo> infos;
+	emArray<emString> names;
+	emString path;
+	EntryInfo info;
+	emUInt64 total;
+	time_t t;
+	int i;
+
+	try {
+		names=emTryLoadDir(DirPath);
+	}
+	catch (const emException &) {
+		return;
+	}
+
+	infos.SetTuningLevel(4);
+	total=0;
+	for (i=0; i<names.GetCount(); i++) {
+		path=emGetChildPath(DirPath,names[i]);
+		if (TryLoadInfo(path,NULL,&info)) {
+			infos.Add(info);
+			total+=info.Size;
+			continue;
+		}
+		// Broken entry, or an entry which is being stored by another
+		// process. The latter must not be removed, unless it is a
+		// leftover of a crash.
+		try {
+			t=emTryGetFileTime(path);
+			if (t<=time(NULL)-24*60*60) emTryRemoveFileOrTree(path,true);
+		}
+		catch (const emException &) {
+		}
+	}
+
+	if (total>((emUInt64)MAX_TOTAL_SIZE_MB)<<20) {
+		infos.Sort(CompareLastUse);
+		for (i=0; i<infos.GetCount(); i++) {
+			if (total<=((emUInt64)MAX_TOTAL_SIZE_MB)<<20) break;
+			try {
+				emTryRemoveFileOrTree(infos[i].Path,true);
+			}
+			catch (const emException &) {
+				continue;
+			}
+			total-=infos[i].Size;
+		}
+	}
+
+	TotalMutex.Lock();
+	Total=total;
+	TotalKnown=true;
+	TotalMutex.Unlock();
+}
+
+
+int emTmpConvCache::CompareLastUse(
+	const EntryInfo * info1, const EntryInfo * info2, void * context
+)
+{
+	if (info1->LastUse<info2->LastUse) return -1;
+	if (info1->LastUse>info2->LastUse) return 1;
+	return 0;
+}
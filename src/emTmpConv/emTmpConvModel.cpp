@@ -73,6 +73,7 @@ emTmpConvModel::emTmpConvModel(
 {
 	FileManModel=emFileManModel::Acquire(GetRootContext());
 	UpdateSignalModel=emFileModel::AcquireUpdateSignalModel(GetRootContext());
+	Cache=emTmpConvCache::Acquire(GetRootContext());
 	InputFilePath=inputFilePath;
 	Command=command;
 	OutputFileEnding=outputFileEnding;
@@ -95,6 +96,7 @@ emTmpConvModel::~emTmpConvModel()
 {
 	EndPSAgent();
 	Process.Terminate();
+	CacheTransfer.Reset();
 	TmpFile.Discard();
 }
 
@@ -111,6 +113,7 @@ bool emTmpConvModel::Cycle()
 				FileTime!=st.st_mtime ||
 				FileSize!=(emUInt64)st.st_size
 			) {
+				CacheTransfer.Reset();
 				TmpFile.Discard();
 				TmpSelected=false;
 				State=CS_DOWN;
@@ -127,6 +130,11 @@ bool emTmpConvModel::Cycle()
 		}
 	}
 
+	if (CacheTransfer && State==CS_UP && CacheTransfer->IsDone()) {
+		// The result has been stored in the cache in the background.
+		CacheTransfer.Reset();
+	}
+
 	if (IsSignaled(FileManModel->GetSelectionSignal())) {
 		if (State==CS_UP) {
 			TmpSelected=FileManModel->IsAnySelectionInDirTree(TmpFile.GetPath());
@@ -140,6 +148,7 @@ bool emTmpConvModel::Cycle()
 		EndPSAgent();
 		Process.Terminate();
 		ErrPipeBuf.Clear(true);
+		CacheTransfer.Reset();
 		TmpFile.Discard();
 		TmpSelected=false;
 		State=CS_DOWN;
@@ -166,6 +175,7 @@ bool emTmpConvModel::Cycle()
 			EndPSAgent();
 			Process.Terminate();
 			ErrPipeBuf.Clear(true);
+			CacheTransfer.Reset();
 			TmpFile.Discard();
 			TmpSelected=false;
 			ErrorText=exception.GetText();
@@ -204,6 +214,9 @@ void emTmpConvModel::TryStepConversion()
 		}
 		FileTime=st.st_mtime;
 		FileSize=st.st_size;
+		CacheKey=emTmpConvCache::MakeKey(
+			InputFilePath,FileSize,FileTime,Command,OutputFileEnding
+		);
 		ConversionStage=1;
 		if (IsTimeSliceAtEnd()) break;
 	case 1:
@@ -211,6 +224,24 @@ void emTmpConvModel::TryStepConversion()
 		ConversionStage=2;
 		if (IsTimeSliceAtEnd()) break;
 	case 2:
+		CacheTransfer=new emTmpConvCache::Transfer(
+			*Cache,emTmpConvCache::Transfer::FETCH,CacheKey,TmpFile.GetPath()
+		);
+		ConversionStage=3;
+		break;
+	case 3:
+		if (!CacheTransfer->IsDone()) break;
+		if (CacheTransfer->IsFetched()) {
+			CacheTransfer.Reset();
+			EndPSAgent();
+			State=CS_UP;
+			Signal(ChangeSignal);
+			break;
+		}
+		CacheTransfer.Reset();
+		ConversionStage=4;
+		if (IsTimeSliceAtEnd()) break;
+	case 4:
 		args+=emGetChildPath(
 			emGetInstallPath(EM_IDT_LIB,"emTmpConv","emTmpConv"),
 			"emTmpConvProc"
@@ -227,9 +258,9 @@ void emTmpConvModel::TryStepConversion()
 			emProcess::SF_PIPE_STDERR|
 			emProcess::SF_NO_WINDOW
 		);
-		ConversionStage=3;
+		ConversionStage=5;
 		break;
-	case 3:
+	case 5:
 		do {
 			l=Process.TryReadErr(buf,sizeof(buf)-1);
 			if (l<=0) break;
@@ -249,6 +280,14 @@ void emTmpConvModel::TryStepConversion()
 			EndPSAgent();
 			Process.Terminate();
 			ErrPipeBuf.Clear(true);
+			// The result is usable right now. It is stored in the
+			// cache in the background, and the transfer is kept
+			// until it is done, because the temporary file must not
+			// be discarded while it is being copied.
+			CacheTransfer=new emTmpConvCache::Transfer(
+				*Cache,emTmpConvCache::Transfer::STORE,CacheKey,
+				TmpFile.GetPath()
+			);
 			State=CS_UP;
 			Signal(ChangeSignal);
 		}
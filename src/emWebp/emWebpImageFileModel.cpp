@@ -27,7 +27,9 @@ struct emWebpImageFileModel::LoadingState {
 	emArray<unsigned char> data;
 	bool featuresValid;
 	WebPBitstreamFeatures features;
+	WebPDecoderConfig config;
 	WebPIDecoder * decoder;
+	int reduction;
 	int lastY;
 };
 
@@ -79,6 +81,7 @@ void emWebpImageFileModel::TryStartLoading()
 	L->featuresValid=false;
 	memset(&L->features,0,sizeof(L->features));
 	L->decoder=NULL;
+	L->reduction=1;
 	L->lastY=0;
 
 	L->file=fopen(GetFilePath(),"rb");
@@ -139,19 +142,41 @@ bool emWebpImageFileModel::TryContinueLoading()
 		else if (L->features.format==2) FileFormatInfo+=", lossless format";
 		else FileFormatInfo+=emString::Format(", format %d",L->features.format);
 
-		Image.Setup(
+		L->reduction=CalcReduction(
 			L->features.width,
 			L->features.height,
-			L->features.has_alpha ? 4 : 3
+			L->features.has_alpha ? 4 : 3,
+			16
 		);
 
-		L->decoder=WebPINewRGB(
-			Image.GetChannelCount() > 3 ? MODE_RGBA : MODE_RGB,
-			Image.GetWritableMap(),
-			Image.GetWidth()*(size_t)Image.GetHeight()*Image.GetChannelCount(),
-			Image.GetWidth()*(size_t)Image.GetChannelCount()
+		Image.Setup(
+			(L->features.width+L->reduction-1)/L->reduction,
+			(L->features.height+L->reduction-1)/L->reduction,
+			L->features.has_alpha ? 4 : 3
 		);
 
+		if (!WebPInitDecoderConfig(&L->config)) {
+			throw emException("WebP library version mismatch");
+		}
+		if (L->reduction>1) {
+			// Let libwebp scale down while decoding.
+			L->config.options.use_scaling=1;
+			L->config.options.scaled_width=Image.GetWidth();
+			L->config.options.scaled_height=Image.GetHeight();
+		}
+		L->config.output.colorspace=
+			Image.GetChannelCount() > 3 ? MODE_RGBA : MODE_RGB;
+		L->config.output.is_external_memory=1;
+		L->config.output.u.RGBA.rgba=Image.GetWritableMap();
+		L->config.output.u.RGBA.stride=
+			Image.GetWidth()*Image.GetChannelCount();
+		L->config.output.u.RGBA.size=
+			Image.GetWidth()*(size_t)Image.GetHeight()*Image.GetChannelCount();
+		L->decoder=WebPIDecode(NULL,0,&L->config);
+		if (!L->decoder) {
+			throw emException("Failed to create WebP decoder");
+		}
+
 		Signal(ChangeSignal);
 		return false;
 	}
@@ -224,8 +249,8 @@ emUInt64 emWebpImageFileModel::CalcMemoryNeed()
 	}
 	else if (L->featuresValid) {
 		return
-			((emUInt64)L->features.width)*
-			L->features.height*
+			((emUInt64)(L->features.width+L->reduction-1)/L->reduction)*
+			((L->features.height+L->reduction-1)/L->reduction)*
 			(L->features.has_alpha?4:3)
 		;
 	}
@@ -237,8 +262,8 @@ emUInt64 emWebpImageFileModel::CalcMemoryNeed()
 
 double emWebpImageFileModel::CalcFileProgress()
 {
-	if (L && L->featuresValid && L->features.height>0) {
-		return 100.0*L->lastY/L->features.height;
+	if (L && L->featuresValid && Image.GetHeight()>0) {
+		return 100.0*L->lastY/Image.GetHeight();
 	}
 	else {
 		return 0.0;